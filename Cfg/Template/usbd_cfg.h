@@ -78,6 +78,27 @@
                                                                 /* See Note #1.                                         */
 
 
+/*
+*********************************************************************************************************
+*                                 USB DEVICE CORE EVENT CONFIGURATION
+*
+* Note(s) : (1) Configure USBD_CFG_CORE_EVENT_RING_EN to select how events are passed from the device
+*               controller ISR to the core task.
+*
+*               (a) When DEF_ENABLED,  each device has a ring of core events. Consecutive completions on
+*                   the same endpoint are coalesced into a single queued event. The driver claims a slot
+*                   within a short critical section, from the ISR or from task level, while the core
+*                   task empties the ring without any lock.
+*               (b) When DEF_DISABLED, core events are allocated from a pool shared by all devices
+*                   and protected by critical sections.
+*********************************************************************************************************
+*/
+
+                                                                /* Core Event Ring Support.                             */
+#define  USBD_CFG_CORE_EVENT_RING_EN            DEF_DISABLED
+                                                                /* See Note #1.                                         */
+
+
 /*
 *********************************************************************************************************
 *                          USB DEVICE MICROSOFT OS DESCRIPTOR CONFIGURATION
@@ -100,6 +121,33 @@
 *
 * Note(s) : (1) This configuration should be set to DEF_ENABLED if the USB device controller supports
 *               high-speed, or to DEF_DISABLED if otherwise.
+*
+*           (2) When DEF_ENABLED, USBD_BulkTxVec()/USBD_BulkRxVec() and their asynchronous variants
+*               accept a table of buffer segments. A bounce buffer of one maximum packet is allocated
+*               per opened endpoint to hold packets that straddle two segments.
+*
+*           (3) When DEF_ENABLED, each opened endpoint embeds the URB used by its synchronous transfers.
+*               A synchronous transfer then neither takes an URB from the pool nor queues it on the
+*               endpoint, which saves two critical sections per call, at the cost of one URB of RAM
+*               per opened endpoint.
+*
+*           (4) When DEF_ENABLED, the configuration descriptors of a device are serialized once, when the
+*               device is started, in a cache of USBD_CFG_DESC_CACHE_LEN octets allocated per device.
+*               GET_DESCRIPTOR requests for a configuration are then answered directly from this cache.
+*               A configuration descriptor that does not fit in the remaining cache space is built on
+*               each request. Class-specific descriptors must not change once the device is started.
+*
+*           (5) When DEF_ENABLED, USBD_CfgDescStaticSet() associates a constant configuration descriptor,
+*               declared with the USBD_DESC_STATIC_xxx() macros (see 'usbd_core.h  STATIC DESCRIPTOR
+*               MACROS'), to a configuration. The descriptor is then sent from ROM and the endpoints of
+*               the configuration take the addresses found in it instead of being searched for in the
+*               driver's endpoint information table. Such configurations do not use the descriptor cache.
+*
+*           (6) When DEF_ENABLED, the data and status stages of the standard requests are started
+*               asynchronously and driven by their completion events, so the core task keeps processing
+*               the other endpoint events during a long control transfer. A class request handler may
+*               also call USBD_CtrlReqDefer() and complete the request later, from any task, with
+*               USBD_CtrlReqCmpl(). Each device then reserves one more entry in the core task queue.
 *********************************************************************************************************
 */
 
@@ -112,6 +160,26 @@
                                                                 /* DEF_ENABLED  Isochronous enpoints are     available. */
                                                                 /* DEF_DISABLED Isochronous enpoints are not available. */
 
+                                                                /* Configure Vectored Bulk Transfers in uC/USB-Device.  */
+#define  USBD_CFG_EP_VEC_EN                     DEF_DISABLED
+                                                                /* See Note #2.                                         */
+
+                                                                /* Configure Embedded URB for Synchronous Transfers.    */
+#define  USBD_CFG_EP_SYNC_URB_EN                DEF_ENABLED
+                                                                /* See Note #3.                                         */
+
+                                                                /* Configure Configuration Descriptor Cache.            */
+#define  USBD_CFG_DESC_CACHE_EN                 DEF_DISABLED
+                                                                /* See Note #4.                                         */
+
+                                                                /* Configuration Descriptor Cache Length per Device.    */
+#define  USBD_CFG_DESC_CACHE_LEN                         256u
+                                                                /* Must be between 9u and 65535u.                       */
+
+                                                                /* Configure Static Configuration Descriptors.          */
+#define  USBD_CFG_DESC_STATIC_EN                DEF_DISABLED
+                                                                /* See Note #5.                                         */
+
                                                                 /* Configure High-Speed Support in uC/USB-Device.       */
 #define  USBD_CFG_HS_EN                         DEF_ENABLED
                                                                 /* See Note #1.                                         */
@@ -120,6 +188,10 @@
 #define  USBD_CFG_CTRL_REQ_TIMEOUT_mS                   5000u
                                                                 /* Must be between 1u and 65535u.                       */
 
+                                                                /* Configure Asynchronous Control Transfers.            */
+#define  USBD_CFG_CTRL_ASYNC_EN                 DEF_DISABLED
+                                                                /* See Note #6.                                         */
+
 
 /*
 *********************************************************************************************************
@@ -152,6 +224,12 @@
 #define  USBD_CFG_MAX_NBR_URB_EXTRA                        0u
                                                                 /* Must be between 0u and 255u.                         */
 
+                                                                /* Maximum Number of Reserved URBs.                     */
+                                                                /* These URBs are reserved per EP for async queueing... */
+                                                                /* ...with USBD_EP_URB_RsvdSet().                       */
+#define  USBD_CFG_MAX_NBR_URB_RSVD                         0u
+                                                                /* Must be between 0u and 255u.                         */
+
 
 /*
 *********************************************************************************************************
@@ -167,6 +245,19 @@
 /*
 *********************************************************************************************************
 *                                   USB DEVICE DEBUG CONFIGURATION
+*
+* Note(s) : (1) When USBD_CFG_DBG_TRACE_BIN_EN is enabled, debug events are not formatted by the debug
+*               task. Each event is written as a fixed-size binary record into a ring buffer, overwriting
+*               the oldest records when full. The ring can be dumped from RAM or read with
+*               USBD_DbgTraceRd(), and is decoded on the host with 'Tools/TraceDecoder/usbd_trace_dec.c'.
+*
+*           (2) The number of records in the binary trace ring must be a power of 2.
+*
+*           (3) When USBD_CFG_DBG_STATS_PERF_EN is enabled, the time spent by each transfer in each stage
+*               is accumulated in log2-bucketed histograms of CPU timestamp ticks, per endpoint. Bucket
+*               #0 counts latencies of 0 tick, and bucket #n latencies between 2^(n - 1) and 2^n - 1
+*               ticks. The last bucket also counts all longer latencies. The CPU timestamp timer must
+*               be enabled (see 'cpu_cfg.h  CPU_CFG_TS_32_EN').
 *********************************************************************************************************
 */
 
@@ -179,6 +270,15 @@
 #define  USBD_CFG_DBG_TRACE_NBR_EVENTS                    10u
                                                                 /* Must be between 1u and 255u.                         */
 
+                                                                /* Binary Trace Mode (see Note #1).                     */
+#define  USBD_CFG_DBG_TRACE_BIN_EN              DEF_DISABLED
+                                                                /* DEF_ENABLED  Events are recorded in binary ring.     */
+                                                                /* DEF_DISABLED Events are formatted by debug task.     */
+
+                                                                /* Number of Records in Binary Trace Ring.              */
+#define  USBD_CFG_DBG_TRACE_BIN_NBR_REC                  256u
+                                                                /* Must be a power of 2 (see Note #2).                  */
+
                                                                 /* Debug Module Built-In Statistics Support.            */
 #define  USBD_CFG_DBG_STATS_EN                  DEF_DISABLED
                                                                 /* DEF_ENABLED  Built-in statistics are     available.  */
@@ -188,6 +288,19 @@
 #define  USBD_CFG_DBG_STATS_CNT_TYPE            CPU_INT08U
                                                                 /* CPU_INT08U, CPU_INT16U or CPU_INT32U.                */
 
+                                                                /* Endpoint Latency and Throughput Statistics Support.  */
+#define  USBD_CFG_DBG_STATS_PERF_EN             DEF_DISABLED
+                                                                /* DEF_ENABLED  EP latency hist and byte cntrs en'd.    */
+                                                                /* DEF_DISABLED EP latency hist and byte cntrs dis'd.   */
+
+                                                                /* Number of Buckets per Latency Histogram.             */
+#define  USBD_CFG_DBG_STATS_LAT_NBR_BUCKET               24u
+                                                                /* Must be between 2u and 33u (see Note #3).            */
+
+                                                                /* Throughput Meter Window, in Milliseconds.            */
+#define  USBD_CFG_DBG_STATS_RATE_WIN_MS                1000u
+                                                                /* Must be greater than 0u.                             */
+
 
 /*
 *********************************************************************************************************
@@ -201,6 +314,17 @@
 *           (2) Audio buffers allocated for each AudioStreaming interface requires to be aligned
 *               properly according to DMA requirement. Most of the time, a DMA is used to transfer
 *               audio data between the codec and the USB stack in order to offload the CPU.
+*
+*           (3) When USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN is enabled, the built-in playback stream
+*               correction resamples the whole buffer with cubic interpolation to add or remove an audio
+*               frame, instead of rebuilding the last samples of the buffer by averaging. It costs more
+*               processing per correction but does not produce an audible discontinuity. It is disabled
+*               by default; 'Drivers/Loopback/Bench/usbd_bench_corr.c' measures both algorithms.
+*
+*           (4) When USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN is enabled, a buffer captured with one audio
+*               frame more or less by the built-in record stream correction is resampled back to its
+*               nominal length before being sent, so that the host receives packets of constant length.
+*               Both corrections resample with SSE4.1 or NEON instructions when the compiler targets them.
 *********************************************************************************************************
 */
 
@@ -280,11 +404,21 @@
                                                                 /* DEF_ENABLED  Enable  playback stream correction.     */
                                                                 /* DEF_DISABLED Disable playback stream correction.     */
 
+                                                                /* Playback Stream Correction by Resampling.            */
+#define  USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN DEF_DISABLED
+                                                                /* DEF_ENABLED  Resample buf (see Note #3).             */
+                                                                /* DEF_DISABLED Average last samples of buf.            */
+
                                                                 /* Record Stream Correction Support.                    */
 #define  USBD_AUDIO_CFG_RECORD_CORR_EN            DEF_DISABLED
                                                                 /* DEF_ENABLED  Enable  record stream correction.       */
                                                                 /* DEF_DISABLED Disable record stream correction.       */
 
+                                                                /* Record Stream Correction by Resampling.              */
+#define  USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN   DEF_DISABLED
+                                                                /* DEF_ENABLED  Resample buf (see Note #4).             */
+                                                                /* DEF_DISABLED Send buf as captured.                   */
+
                                                                 /* Audio Statistics Support.                            */
 #define  USBD_AUDIO_CFG_STAT_EN                   DEF_DISABLED
                                                                 /* DEF_ENABLED  Enable  audio class statistics.         */
@@ -324,6 +458,33 @@
 /*
 *********************************************************************************************************
 *                       CDC ETHERNET EMULATION MODEL (EEM) CLASS CONFIGURATION
+*
+* Note(s) : (1) Configure USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN to enable or disable the zero-copy receive path.
+*               When enabled, every Ethernet frame that lies entirely within a received bulk buffer is
+*               handed to the network driver in place, without being copied to a network driver's buffer.
+*               Only frames that straddle two bulk transfers are copied. The network driver MUST give
+*               each received frame back using USBD_CDC_EEM_RxDataPktRelease().
+*
+*           (2) Configure USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV to set the number of receive buffers
+*               of the zero-copy pool. Buffers of the pool are rotated: a buffer still referenced by the
+*               network driver is not re-armed and a free buffer of the pool is armed instead. A pool
+*               larger than USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV lets the endpoint stay armed while the
+*               network stack holds frames.
+*
+*           (3) Configure USBD_CDC_EEM_CFG_TX_AGG_EN to enable or disable transmit aggregation. When
+*               enabled, frames queued while a bulk IN transfer is in progress are concatenated into a
+*               single transfer of at most USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN octets, as allowed by the
+*               CDC-EEM specification. A frame larger than this budget is sent alone.
+*
+*           (4) Configure USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS to hold frames submitted while the bulk IN
+*               endpoint is idle, until either this timeout expires or USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN
+*               octets are queued. A value of 0 sends such frames right away. A non-zero value requires
+*               the timer services of the kernel abstraction layer (KAL).
+*
+*           (5) Configure USBD_CDC_EEM_CFG_RX_CRC_CHK_EN to enable or disable the verification of the CRC
+*               of received frames that carry one. Frames with a bad CRC are dropped. Verification only
+*               takes place on class instances configured with a CRC-32 engine (see 'usbd_cdc_eem.h  CDC
+*               EEM CLASS INSTANCE CONFIGURATION STRUCTURE').
 *********************************************************************************************************
 */
 
@@ -339,10 +500,45 @@
                                                                 /* Length of buffer used for echo response command.     */
 #define  USBD_CDC_EEM_CFG_ECHO_BUF_LEN                    64u
 
+                                                                /* Enable/disable zero-copy receive path.               */
+#define  USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN           DEF_DISABLED
+                                                                /* See Note #1.                                         */
+
+                                                                /* Number of receive buffers in zero-copy pool.         */
+#define  USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV          2u
+                                                                /* See Note #2.                                         */
+
+                                                                /* Enable/disable transmit aggregation.                 */
+#define  USBD_CDC_EEM_CFG_TX_AGG_EN                 DEF_DISABLED
+                                                                /* See Note #3.                                         */
+
+                                                                /* Max length of an aggregated transfer.                */
+#define  USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN                2048u
+                                                                /* See Note #3.                                         */
+
+                                                                /* Aggregation flush timeout, in ms.                    */
+#define  USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS                0u
+                                                                /* See Note #4.                                         */
+
+                                                                /* Enable/disable verification of received CRCs.        */
+#define  USBD_CDC_EEM_CFG_RX_CRC_CHK_EN             DEF_DISABLED
+                                                                /* See Note #5.                                         */
+
 
 /*
 *********************************************************************************************************
 *                                       HID CLASS CONFIGURATION
+*
+* Note(s) : (1) Configure USBD_HID_CFG_INPUT_Q_EN to enable or disable the input report queue. When
+*               enabled, USBD_HID_InputQ_Wr() queues input reports without waiting for the previous
+*               transfer to complete, and the next queued report is sent from the completion of the
+*               previous one, so that a transfer is armed on the interrupt IN endpoint at each polling
+*               interval while reports are pending.
+*
+*           (2) Configure USBD_HID_CFG_INPUT_Q_DEPTH to set the number of input reports each class
+*               instance can queue. When the queue is full, a new report replaces the most recent queued
+*               report with the same report ID, if any, and is dropped otherwise. A depth of 1 always
+*               sends the latest value of each report.
 *********************************************************************************************************
 */
 
@@ -362,6 +558,13 @@
 #define  USBD_HID_CFG_MAX_NBR_REPORT_PUSHPOP               0u
                                                                 /* Must be between 0u and 255u.                         */
 
+                                                                /* Enable/disable input report queue (see Note #1).     */
+#define  USBD_HID_CFG_INPUT_Q_EN                    DEF_DISABLED
+
+                                                                /* Input report queue depth (see Note #2).              */
+#define  USBD_HID_CFG_INPUT_Q_DEPTH                        4u
+                                                                /* Must be between 1u and 255u.                         */
+
 
 /*
 *********************************************************************************************************
@@ -384,6 +587,70 @@
 *               defined with a value other than 0, the RAM disk data area will be set from this base
 *               address directly. Conversely, if it is equal to 0, the RAM disk data area will be
 *               represented as a table from the program's data area.
+*
+*           (4) USBD_MSC_CFG_DATA_NBR_BUF is the number of USBD_MSC_CFG_DATA_LEN buffers allocated to
+*               each MSC class instance for the data stage. With a single buffer, the storage media
+*               access and the bulk transfer are done one after the other. With two or more buffers,
+*               the READ data stage is pipelined: the next chunks are read from the storage media, with
+*               USBD_StorageRdAsync(), while the previous ones are being sent to the host using
+*               asynchronous bulk-IN transfers.
+*               The WRITE data stage can also be pipelined on a per logical unit basis (see
+*               USBD_MSC_LunWrPipelineEn()): bulk-OUT transfers stay armed while the previously
+*               received chunks are written to the storage media.
+*               When more than one buffer is used, USBD_CFG_MAX_NBR_URB_EXTRA should be at least
+*               (USBD_MSC_CFG_DATA_NBR_BUF - 1u) per MSC class instance. Alternatively, as many URBs
+*               can be reserved for each bulk endpoint with USBD_EP_URB_RsvdSet().
+*
+*           (5) Storage units are numbered in the order logical units are added with USBD_MSC_LunAdd(),
+*               across all MSC class instances. USBD_RAMDISK_CFG_NBR_UNITS should thus be the total
+*               number of logical units of all instances.
+*
+*           (6) USBD_MSC_CFG_CACHE_EN enables a block cache between the SCSI layer and the storage
+*               driver, shared by all the logical units (see 'usbd_msc_cache.h'). It holds
+*               (USBD_MSC_CFG_CACHE_NBR_SETS * USBD_MSC_CFG_CACHE_NBR_WAYS) blocks of
+*               USBD_MSC_CFG_CACHE_BLK_SIZE octets. Logical units with another block size are not cached.
+*
+*               (a) When a logical unit is read sequentially, the next USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS
+*                   blocks are read ahead in a single storage access. 0u disables read-ahead. Must not
+*                   be greater than USBD_MSC_CFG_CACHE_NBR_SETS.
+*
+*               (b) With USBD_MSC_CFG_CACHE_WR_BACK_EN set to DEF_ENABLED, written blocks are only
+*                   stored when evicted, on SYNCHRONIZE CACHE, on START STOP UNIT and on disconnect.
+*                   A medium removed without being ejected loses the blocks not yet stored.
+*
+*               (c) Reads through the cache are synchronous : with USBD_MSC_CFG_DATA_NBR_BUF greater than
+*                   1, a chunk missing from the cache is read from the storage driver before the
+*                   previous chunk is sent, so storage and USB transfers no longer overlap. The cache
+*                   suits media with a high access cost and small, repeated or sequential reads, that
+*                   hit the cache or its read-ahead. For large transfers from a fast medium, leaving
+*                   the cache disabled and using several data buffers gives a higher throughput.
+*
+*           (7) USBD_MSC_CFG_UAS_EN adds a USB Attached SCSI (UAS) alternate setting (1) to each MSC
+*               interface, next to the Bulk-Only Transport one (0). A host selecting it can queue up
+*               to USBD_MSC_CFG_UAS_QUEUE_DEPTH tagged commands, which are read from the storage media
+*               concurrently and whose data stages are sent in completion order.
+*
+*               (a) Each MSC class instance then uses 4 bulk endpoints and 2 interface alternate
+*                   settings (see USBD_CFG_MAX_NBR_EP_OPEN and USBD_CFG_MAX_NBR_IF_ALT).
+*
+*               (b) Concurrent reads are bounded by USBD_MSC_CFG_DATA_NBR_BUF, as each command in
+*                   progress holds one data buffer.
+*
+*               (c) USB 3.x streams are not supported: commands are queued on a USB 2.0 connection.
+*
+*           (8) USBD_RAMDISK_CFG_SPARSE_EN makes the RAM disk units thin provisioned. Their blocks are
+*               only given memory when written with non-zero data, from a pool of
+*               USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS blocks shared by all the units, and are returned
+*               to the pool when the host unmaps them (UNMAP, WRITE SAME) or writes them with zeros.
+*               Unmapped blocks read as zeros.
+*
+*               (a) Each run of (USBD_RAMDISK_CFG_BLK_SIZE / 4u) blocks being mapped uses one more pool
+*                   block to hold its block map.
+*
+*               (b) A write failing for lack of pool blocks is reported to the host as a space
+*                   allocation failure.
+*
+*               (c) USBD_RAMDISK_CFG_BASE_ADDR then sets the pool address (see Note #3).
 *********************************************************************************************************
 */
 
@@ -403,6 +670,10 @@
 #define  USBD_MSC_CFG_DATA_LEN                          2048u
                                                                 /* Must be between 1u and DEF_INT_32U_MAX_VAL.          */
 
+                                                                /* Number of Data Buffers per Class Instance.           */
+#define  USBD_MSC_CFG_DATA_NBR_BUF                         1u
+                                                                /* See Note #4.                                         */
+
                                                                 /* Use uC/FS MSC class interface.                       */
 #define  USBD_MSC_CFG_MICRIUM_FS                DEF_DISABLED
                                                                 /* See Note #1.                                         */
@@ -415,9 +686,41 @@
 #define  USBD_MSC_CFG_DEV_POLL_DLY_mS                    100u
                                                                 /* Must be between 1u and DEF_INT_32U_MAX_VAL.          */
 
+                                                                /* Block cache.                                         */
+#define  USBD_MSC_CFG_CACHE_EN                  DEF_DISABLED
+                                                                /* See Note #6.                                         */
+
+                                                                /* Block cache block size, in octets.                   */
+#define  USBD_MSC_CFG_CACHE_BLK_SIZE                     512u
+                                                                /* See Note #6.                                         */
+
+                                                                /* Block cache number of sets.                          */
+#define  USBD_MSC_CFG_CACHE_NBR_SETS                      32u
+                                                                /* Must be between 1u and 65535u.                       */
+
+                                                                /* Block cache number of blocks per set.                */
+#define  USBD_MSC_CFG_CACHE_NBR_WAYS                       4u
+                                                                /* Must be between 1u and 255u.                         */
+
+                                                                /* Block cache read-ahead length, in blocks.            */
+#define  USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS             16u
+                                                                /* See Note #6a.                                        */
+
+                                                                /* Block cache write-back.                              */
+#define  USBD_MSC_CFG_CACHE_WR_BACK_EN          DEF_ENABLED
+                                                                /* See Note #6b.                                        */
+
+                                                                /* USB Attached SCSI (UAS) alternate setting.           */
+#define  USBD_MSC_CFG_UAS_EN                    DEF_DISABLED
+                                                                /* See Note #7.                                         */
+
+                                                                /* UAS command queue depth per class instance.          */
+#define  USBD_MSC_CFG_UAS_QUEUE_DEPTH                      8u
+                                                                /* Must be between 1u and 255u.                         */
+
                                                                 /* Number of RAMDisk units.                             */
 #define  USBD_RAMDISK_CFG_NBR_UNITS                        1u
-                                                                /* Must be at least 1.                                  */
+                                                                /* See Note #5.                                         */
 
                                                                 /* RAMDisk block size.                                  */
 #define  USBD_RAMDISK_CFG_BLK_SIZE                       512u
@@ -431,6 +734,14 @@
 #define  USBD_RAMDISK_CFG_BASE_ADDR                        0u
                                                                 /* See Note #3.                                         */
 
+                                                                /* Enable or disable sparse RAMDisk.                    */
+#define  USBD_RAMDISK_CFG_SPARSE_EN             DEF_DISABLED
+                                                                /* See Note #8.                                         */
+
+                                                                /* Sparse RAMDisk pool number of blocks.                */
+#define  USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS            32u
+                                                                /* Must be at least 1.                                  */
+
 
 /*
 *********************************************************************************************************
@@ -0,0 +1,687 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                USB AUDIO DEVICE OPERATING SYSTEM LAYER
+*                                           POSIX (pthreads)
+*
+* Filename : usbd_audio_os.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This port runs the audio class on a host workstation, together with the core POSIX port
+*                ('OS/POSIX/usbd_os.c') and the loopback device controller driver.
+*
+*            (2) The record and playback tasks are threads. Thread priorities are not set.
+*
+*            (3) Each task queue is a bounded FIFO of 'msg_qty' message pointers protected by a mutex and a
+*                condition variable. The FIFO storage is allocated from the heap by USBD_Audio_OS_Init().
+*
+*            (4) The POSIX.1-2008 feature test macro is defined before the first include so that the port
+*                also builds in a strict ISO C compiler mode (e.g. '-std=c11').
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    _POSIX_C_SOURCE                200809L               /* See Note #4.                                         */
+#include  "../../usbd_audio_internal.h"
+#include  "../../usbd_audio_os.h"
+#include  <pthread.h>
+#include  <errno.h>
+#include  <time.h>
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_AUDIO_OS_NS_PER_SEC                 1000000000L
+#define  USBD_AUDIO_OS_NS_PER_MS                     1000000L
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+typedef  struct  usbd_audio_os_q {                              /* ------------------ TASK MSG QUEUE ------------------ */
+    pthread_mutex_t    Lock;
+    pthread_cond_t     Cond;
+    void             **MsgTbl;                                  /* FIFO storage (see Note #3).                          */
+    CPU_INT16U         MsgQty;                                  /* Nbr of entries in FIFO storage.                      */
+    CPU_INT16U         InIx;                                    /* Ix of next msg to post.                              */
+    CPU_INT16U         OutIx;                                   /* Ix of next msg to pend on.                           */
+    CPU_INT16U         NbrMsg;                                  /* Nbr of msg in FIFO.                                  */
+} USBD_AUDIO_OS_Q;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+static  pthread_t        USBD_Audio_OS_RecordTaskThread;
+
+static  USBD_AUDIO_OS_Q  USBD_Audio_OS_RecordQ;
+#endif
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+static  pthread_t        USBD_Audio_OS_PlaybackTaskThread;
+
+static  USBD_AUDIO_OS_Q  USBD_Audio_OS_PlaybackQ;
+#endif
+
+static  pthread_mutex_t  USBD_Audio_OS_AS_IF_MutexTbl[USBD_AUDIO_MAX_NBR_AS_IF_EP];
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+static  void   *USBD_Audio_OS_RecordTask  (void             *p_arg);
+#endif
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+static  void   *USBD_Audio_OS_PlaybackTask(void             *p_arg);
+#endif
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+static  void    USBD_Audio_OS_Q_Create    (USBD_AUDIO_OS_Q  *p_q,
+                                           CPU_INT16U        msg_qty,
+                                           USBD_ERR         *p_err);
+
+static  void    USBD_Audio_OS_Q_Post      (USBD_AUDIO_OS_Q  *p_q,
+                                           void             *p_msg,
+                                           USBD_ERR         *p_err);
+
+static  void   *USBD_Audio_OS_Q_Pend      (USBD_AUDIO_OS_Q  *p_q,
+                                           USBD_ERR         *p_err);
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         USBD_Audio_OS_Init()
+*
+* Description : Initialize the audio class OS layer.
+*
+* Argument(s) : msg_qty     Maximum quantity of messages for playback and record tasks' queues.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE               OS layer initialization successful.
+*                           USBD_ERR_OS_INIT_FAIL       OS layer initialization failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_Audio_OS_Init (CPU_INT16U   msg_qty,
+                          USBD_ERR    *p_err)
+{
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+    int  os_err;
+#else
+    (void)msg_qty;
+#endif
+
+                                                                /* -------------------- RECORD TASK ------------------- */
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+    USBD_Audio_OS_Q_Create(&USBD_Audio_OS_RecordQ,              /* Record buf queue.                                    */
+                            msg_qty,
+                            p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    os_err = pthread_create(&USBD_Audio_OS_RecordTaskThread,
+                             DEF_NULL,
+                             USBD_Audio_OS_RecordTask,
+                             DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+#endif
+
+                                                                /* ------------------- PLAYBACK TASK ------------------ */
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+    USBD_Audio_OS_Q_Create(&USBD_Audio_OS_PlaybackQ,            /* Playback req queue.                                  */
+                            msg_qty,
+                            p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    os_err = pthread_create(&USBD_Audio_OS_PlaybackTaskThread,
+                             DEF_NULL,
+                             USBD_Audio_OS_PlaybackTask,
+                             DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+#endif
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_Audio_OS_AS_IF_LockCreate()
+*
+* Description : Create an OS resource to use as an AudioStreaming interface lock.
+*
+* Argument(s) : as_if_nbr   AudioStreaming interface index.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               OS lock     successfully created.
+*                               USBD_ERR_OS_SIGNAL_CREATE   OS lock NOT successfully created.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_Audio_OS_AS_IF_LockCreate (CPU_INT08U   as_if_nbr,
+                                       USBD_ERR    *p_err)
+{
+    int  os_err;
+
+
+    os_err = pthread_mutex_init(&USBD_Audio_OS_AS_IF_MutexTbl[as_if_nbr], DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+    } else {
+       *p_err = USBD_ERR_NONE;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_Audio_OS_AS_IF_LockAcquire()
+*
+* Description : Wait for an AudioStreaming interface to become available and acquire its lock.
+*
+* Argument(s) : as_if_nbr   AudioStreaming interface index.
+*
+*               timeout_ms  Lock wait timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           OS lock     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     OS lock NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_FAIL        OS lock not acquired because another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) pthread_mutex_timedlock() only takes a CLOCK_REALTIME expiry time. A wall clock change
+*                   while pending shortens or extends the timeout.
+*********************************************************************************************************
+*/
+
+void   USBD_Audio_OS_AS_IF_LockAcquire (CPU_INT08U   as_if_nbr,
+                                        CPU_INT16U   timeout_ms,
+                                        USBD_ERR    *p_err)
+{
+    pthread_mutex_t  *p_mutex;
+    struct  timespec  ts;
+    int               os_err;
+
+
+    p_mutex = &USBD_Audio_OS_AS_IF_MutexTbl[as_if_nbr];
+
+    if (timeout_ms == 0u) {
+        os_err = pthread_mutex_lock(p_mutex);
+    } else {
+        (void)clock_gettime(CLOCK_REALTIME, &ts);               /* See Note #1.                                         */
+        ts.tv_sec  += (time_t)(timeout_ms / 1000u);
+        ts.tv_nsec += (long  )(timeout_ms % 1000u) * USBD_AUDIO_OS_NS_PER_MS;
+        if (ts.tv_nsec >= USBD_AUDIO_OS_NS_PER_SEC) {
+            ts.tv_sec  += 1;
+            ts.tv_nsec -= USBD_AUDIO_OS_NS_PER_SEC;
+        }
+
+        os_err = pthread_mutex_timedlock(p_mutex, &ts);
+    }
+
+    switch (os_err) {
+        case 0:
+            *p_err = USBD_ERR_NONE;
+             break;
+
+
+        case ETIMEDOUT:
+            *p_err = USBD_ERR_OS_TIMEOUT;
+             break;
+
+
+        default:
+            *p_err = USBD_ERR_OS_FAIL;
+             break;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_Audio_OS_AS_IF_LockRelease()
+*
+* Description : Release an AudioStreaming interface lock.
+*
+* Argument(s) : as_if_nbr   AudioStreaming interface index.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_Audio_OS_AS_IF_LockRelease (CPU_INT08U  as_if_nbr)
+{
+    (void)pthread_mutex_unlock(&USBD_Audio_OS_AS_IF_MutexTbl[as_if_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_Audio_OS_RecordReqPost()
+*
+* Description : Post a request into the record task's queue.
+*
+* Argument(s) : p_msg       Pointer to message.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE       Placing buffer in queue successful.
+*                           USBD_ERR_OS_FAIL    Failed to place item into the Record buffer queue.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+void  USBD_Audio_OS_RecordReqPost (void      *p_msg,
+                                   USBD_ERR  *p_err)
+{
+    USBD_Audio_OS_Q_Post(&USBD_Audio_OS_RecordQ, p_msg, p_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_Audio_OS_RecordReqPend()
+*
+* Description : Pend on a request from the record task's queue.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE           Getting buffer in queue successful.
+*                           USBD_ERR_OS_FAIL        Failed to get item from the record buffer queue.
+*
+* Return(s)   : Pointer to record request, if NO error(s).
+*
+*               Null pointer,              otherwise
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+void  *USBD_Audio_OS_RecordReqPend (USBD_ERR  *p_err)
+{
+    return (USBD_Audio_OS_Q_Pend(&USBD_Audio_OS_RecordQ, p_err));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_Audio_OS_PlaybackReqPost()
+*
+* Description : Post a request to the playback's task queue.
+*
+* Argument(s) : p_msg       Pointer to message.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE       Placing buffer in queue successful.
+*                           USBD_ERR_OS_FAIL    Failed to place item into the playback buffer queue.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+void  USBD_Audio_OS_PlaybackReqPost (void      *p_msg,
+                                     USBD_ERR  *p_err)
+{
+    USBD_Audio_OS_Q_Post(&USBD_Audio_OS_PlaybackQ, p_msg, p_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_Audio_OS_PlaybackReqPend()
+*
+* Description : Pend on a request from the playback's task queue.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE           Getting buffer in queue successful.
+*                           USBD_ERR_OS_FAIL        Failed to get item from the playback buffer queue.
+*
+* Return(s)   : Pointer to playback request, if NO error(s).
+*
+*               Null pointer,                otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+void  *USBD_Audio_OS_PlaybackReqPend (USBD_ERR  *p_err)
+{
+    return (USBD_Audio_OS_Q_Pend(&USBD_Audio_OS_PlaybackQ, p_err));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_Audio_OS_DlyMs()
+*
+* Description : Delay a task for a certain time.
+*
+* Argument(s) : ms          Delay in milliseconds.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_Audio_OS_DlyMs (CPU_INT32U  ms)
+{
+    struct  timespec  ts;
+
+
+    ts.tv_sec  = (time_t)(ms / 1000u);
+    ts.tv_nsec = (long  )(ms % 1000u) * USBD_AUDIO_OS_NS_PER_MS;
+
+    while (nanosleep(&ts, &ts) != 0) {                          /* Resume sleep if interrupted by a signal.             */
+        if (errno != EINTR) {
+            break;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                      USBD_Audio_OS_RecordTask()
+*
+* Description : OS-dependent shell task to process record data streams.
+*
+* Argument(s) : p_arg       Pointer to task initialization argument.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
+static  void  *USBD_Audio_OS_RecordTask (void  *p_arg)
+{
+    (void)p_arg;
+
+    USBD_Audio_RecordTaskHandler();
+
+    return (DEF_NULL);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_Audio_OS_PlaybackTask()
+*
+* Description : OS-dependent shell task to process playback data streams.
+*
+* Argument(s) : p_arg       Pointer to task initialization argument.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+static  void  *USBD_Audio_OS_PlaybackTask (void  *p_arg)
+{
+    (void)p_arg;
+
+    USBD_Audio_PlaybackTaskHandler();
+
+    return (DEF_NULL);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Audio_OS_Q_Create()
+*
+* Description : Create a task message queue.
+*
+* Argument(s) : p_q         Pointer to queue.
+*
+*               msg_qty     Maximum quantity of messages in queue.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE               Queue successfully created.
+*                           USBD_ERR_OS_INIT_FAIL       Queue NOT successfully created.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'usbd_audio_os.c  Note #3'.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+static  void  USBD_Audio_OS_Q_Create (USBD_AUDIO_OS_Q  *p_q,
+                                      CPU_INT16U        msg_qty,
+                                      USBD_ERR         *p_err)
+{
+    LIB_ERR  err_lib;
+    int      os_err;
+
+
+    p_q->MsgTbl = (void **)Mem_HeapAlloc((CPU_SIZE_T)msg_qty * sizeof(void *),
+                                          sizeof(void *),
+                                          DEF_NULL,
+                                         &err_lib);
+    if (err_lib != LIB_MEM_ERR_NONE) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+
+    p_q->MsgQty = msg_qty;
+    p_q->InIx   = 0u;
+    p_q->OutIx  = 0u;
+    p_q->NbrMsg = 0u;
+
+    os_err = pthread_mutex_init(&p_q->Lock, DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+
+    os_err = pthread_cond_init(&p_q->Cond, DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Audio_OS_Q_Post()
+*
+* Description : Post a message at the tail of a task message queue.
+*
+* Argument(s) : p_q         Pointer to queue.
+*
+*               p_msg       Pointer to message.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE       Message successfully posted.
+*                           USBD_ERR_OS_FAIL    Queue is full.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+static  void  USBD_Audio_OS_Q_Post (USBD_AUDIO_OS_Q  *p_q,
+                                    void             *p_msg,
+                                    USBD_ERR         *p_err)
+{
+    (void)pthread_mutex_lock(&p_q->Lock);
+    if (p_q->NbrMsg >= p_q->MsgQty) {
+        (void)pthread_mutex_unlock(&p_q->Lock);
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+    p_q->MsgTbl[p_q->InIx] = p_msg;
+    p_q->InIx++;
+    if (p_q->InIx >= p_q->MsgQty) {
+        p_q->InIx = 0u;
+    }
+    p_q->NbrMsg++;
+
+    (void)pthread_cond_signal(&p_q->Cond);
+    (void)pthread_mutex_unlock(&p_q->Lock);
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Audio_OS_Q_Pend()
+*
+* Description : Wait for a message at the head of a task message queue.
+*
+* Argument(s) : p_q         Pointer to queue.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                           USBD_ERR_NONE       Message successfully received.
+*
+* Return(s)   : Pointer to message.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+static  void  *USBD_Audio_OS_Q_Pend (USBD_AUDIO_OS_Q  *p_q,
+                                     USBD_ERR         *p_err)
+{
+    void  *p_msg;
+
+
+    (void)pthread_mutex_lock(&p_q->Lock);
+    while (p_q->NbrMsg == 0u) {
+        (void)pthread_cond_wait(&p_q->Cond, &p_q->Lock);
+    }
+
+    p_msg = p_q->MsgTbl[p_q->OutIx];
+    p_q->OutIx++;
+    if (p_q->OutIx >= p_q->MsgQty) {
+        p_q->OutIx = 0u;
+    }
+    p_q->NbrMsg--;
+    (void)pthread_mutex_unlock(&p_q->Lock);
+
+   *p_err = USBD_ERR_NONE;
+
+    return (p_msg);
+}
+#endif
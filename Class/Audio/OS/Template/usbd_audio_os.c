@@ -219,89 +219,6 @@ void   USBD_Audio_OS_AS_IF_LockRelease (CPU_INT08U  as_if_nbr)
 }
 
 
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockCreate()
-*
-* Description : Create an OS resource to use as a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE               OS lock     successfully created.
-*                               USBD_ERR_OS_SIGNAL_CREATE   OS lock NOT successfully created.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockCreate (CPU_INT08U   as_if_settings_ix,
-                                         USBD_ERR    *p_err)
-{
-    (void)as_if_settings_ix;
-
-   *p_err = USBD_ERR_NONE;
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockAcquire()
-*
-* Description : Wait for a stream ring buffer queue to become available and acquire its lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               timeout_ms  Lock wait timeout in milliseconds.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE           OS lock     successfully acquired.
-*                               USBD_ERR_OS_TIMEOUT     OS lock NOT successfully acquired in the time
-*                                                       specified by 'timeout_ms'.
-*                               USBD_ERR_OS_ABORT       OS lock aborted.
-*                               USBD_ERR_OS_FAIL        OS lock not acquired because another error.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockAcquire (CPU_INT08U   as_if_settings_ix,
-                                          CPU_INT16U   timeout_ms,
-                                          USBD_ERR    *p_err)
-{
-    (void)as_if_settings_ix;
-    (void)timeout_ms;
-
-   *p_err = USBD_ERR_NONE;
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockRelease()
-*
-* Description : Release a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockRelease (CPU_INT08U  as_if_settings_ix)
-{
-    (void)as_if_settings_ix;
-}
-
-
 /*
 *********************************************************************************************************
 *                                     USBD_Audio_OS_RecordReqPost()
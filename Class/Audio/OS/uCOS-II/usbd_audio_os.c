@@ -115,7 +115,6 @@ static  OS_EVENT  *USBD_Audio_OS_PlaybackMsgQPtr;               /* Ptr to playba
 #endif
 
 static  OS_EVENT  *USBD_Audio_OS_AS_IF_MutexTbl[USBD_AUDIO_MAX_NBR_AS_IF_EP];
-static  OS_EVENT  *USBD_Audio_OS_RingBufQMutexTbl[USBD_AUDIO_MAX_NBR_AS_IF_SETTINGS];
 
 
 /*
@@ -446,133 +445,6 @@ void   USBD_Audio_OS_AS_IF_LockRelease (CPU_INT08U  as_if_nbr)
 }
 
 
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockCreate()
-*
-* Description : Create an OS resource to use as a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE               OS lock     successfully created.
-*                               USBD_ERR_OS_SIGNAL_CREATE   OS lock NOT successfully created.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockCreate (CPU_INT08U   as_if_settings_ix,
-                                         USBD_ERR    *p_err)
-{
-    OS_EVENT  *p_event;
-
-
-    p_event = OSSemCreate(1u);
-    if (p_event == (OS_EVENT *)0) {
-       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
-        return;
-    }
-
-    USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix] = p_event;
-
-   *p_err = USBD_ERR_NONE;
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockAcquire()
-*
-* Description : Wait for a stream ring buffer queue to become available and acquire its lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               timeout_ms  Lock wait timeout in milliseconds.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE           OS lock     successfully acquired.
-*                               USBD_ERR_OS_TIMEOUT     OS lock NOT successfully acquired in the time
-*                                                       specified by 'timeout_ms'.
-*                               USBD_ERR_OS_ABORT       OS lock aborted.
-*                               USBD_ERR_OS_FAIL        OS lock not acquired because another error.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockAcquire (CPU_INT08U   as_if_settings_ix,
-                                          CPU_INT16U   timeout_ms,
-                                          USBD_ERR    *p_err)
-{
-    OS_EVENT  *p_event;
-    INT8U      err_os;
-    INT32U     timeout_ticks;
-
-
-    p_event       = USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix];
-    timeout_ticks = ((((INT32U)timeout_ms * OS_TICKS_PER_SEC)  + 1000u - 1u) / 1000u);
-
-    OSSemPend(p_event,
-              timeout_ticks,
-             &err_os);
-    switch (err_os) {
-        case OS_ERR_NONE:
-            *p_err = USBD_ERR_NONE;
-             break;
-
-
-        case OS_ERR_TIMEOUT:
-            *p_err = USBD_ERR_OS_TIMEOUT;
-             break;
-
-
-        case OS_ERR_PEND_ABORT:
-            *p_err = USBD_ERR_OS_ABORT;
-             break;
-
-
-        case OS_ERR_EVENT_TYPE:
-        case OS_ERR_PEND_ISR:
-        case OS_ERR_PEVENT_NULL:
-        case OS_ERR_PEND_LOCKED:
-        default:
-            *p_err = USBD_ERR_OS_FAIL;
-             break;
-    }
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockRelease()
-*
-* Description : Release a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockRelease (CPU_INT08U  as_if_settings_ix)
-{
-    OS_EVENT  *p_event;
-
-
-    p_event = USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix];
-    (void)OSSemPost(p_event);
-}
-
-
 /*
 *********************************************************************************************************
 *                                     USBD_Audio_OS_RecordReqPost()
@@ -116,7 +116,6 @@ static  CPU_STK   USBD_Audio_OS_PlaybackTaskStk[USBD_AUDIO_CFG_OS_PLAYBACK_TASK_
 #endif
 
 static  OS_MUTEX  USBD_Audio_OS_AS_IF_MutexTbl[USBD_AUDIO_MAX_NBR_AS_IF_EP];
-static  OS_MUTEX  USBD_Audio_OS_RingBufQMutexTbl[USBD_AUDIO_MAX_NBR_AS_IF_SETTINGS];
 
 
 /*
@@ -361,148 +360,6 @@ void   USBD_Audio_OS_AS_IF_LockRelease (CPU_INT08U  as_if_nbr)
 }
 
 
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockCreate()
-*
-* Description : Create an OS resource to use as a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE               OS lock     successfully created.
-*                               USBD_ERR_OS_SIGNAL_CREATE   OS lock NOT successfully created.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockCreate (CPU_INT08U   as_if_settings_ix,
-                                         USBD_ERR    *p_err)
-{
-    OS_MUTEX  *p_mutex;
-    OS_ERR     err_os;
-
-
-    p_mutex = &USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix];
-
-    OSMutexCreate(p_mutex,
-                 "USBD Ring Buf Q Mutex",
-                 &err_os);
-    if (err_os != OS_ERR_NONE) {
-       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
-    } else {
-       *p_err = USBD_ERR_NONE;
-    }
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockAcquire()
-*
-* Description : Wait for a stream ring buffer queue to become available and acquire its lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-*               timeout_ms  Lock wait timeout in milliseconds.
-*
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*
-*                               USBD_ERR_NONE           OS lock     successfully acquired.
-*                               USBD_ERR_OS_TIMEOUT     OS lock NOT successfully acquired in the time
-*                                                       specified by 'timeout_ms'.
-*                               USBD_ERR_OS_ABORT       OS lock aborted.
-*                               USBD_ERR_OS_FAIL        OS lock not acquired because another error.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockAcquire (CPU_INT08U   as_if_settings_ix,
-                                          CPU_INT16U   timeout_ms,
-                                          USBD_ERR    *p_err)
-{
-    OS_MUTEX   *p_mutex;
-    OS_ERR      err_os;
-    OS_TICK     timeout_ticks;
-
-
-    p_mutex       = &USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix];
-    timeout_ticks = ((((OS_TICK)timeout_ms * OSCfg_TickRate_Hz)  + 1000u - 1u) / 1000u);
-
-    (void)OSMutexPend(p_mutex,
-                      timeout_ticks,
-                      OS_OPT_PEND_BLOCKING,
-                      DEF_NULL,
-                     &err_os);
-    switch (err_os) {
-        case OS_ERR_NONE:
-            *p_err = USBD_ERR_NONE;
-             break;
-
-
-        case OS_ERR_TIMEOUT:
-            *p_err = USBD_ERR_OS_TIMEOUT;
-             break;
-
-
-        case OS_ERR_PEND_ABORT:
-            *p_err = USBD_ERR_OS_ABORT;
-             break;
-
-
-        case OS_ERR_MUTEX_OWNER:
-        case OS_ERR_OBJ_DEL:
-        case OS_ERR_OBJ_PTR_NULL:
-        case OS_ERR_OBJ_TYPE:
-        case OS_ERR_OPT_INVALID:
-        case OS_ERR_PEND_ISR:
-        case OS_ERR_PEND_WOULD_BLOCK:
-        case OS_ERR_SCHED_LOCKED:
-        case OS_ERR_STATE_INVALID:
-        case OS_ERR_STATUS_INVALID:
-        default:
-            *p_err = USBD_ERR_OS_FAIL;
-             break;
-    }
-}
-
-
-/*
-*********************************************************************************************************
-*                                  USBD_Audio_OS_RingBufQLockRelease()
-*
-* Description : Release a stream ring buffer queue lock.
-*
-* Argument(s) : as_if_nbr   AudioStreaming interface settings index.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void   USBD_Audio_OS_RingBufQLockRelease (CPU_INT08U  as_if_settings_ix)
-{
-    OS_MUTEX  *p_mutex;
-    OS_ERR     err_os;
-
-
-    p_mutex = &USBD_Audio_OS_RingBufQMutexTbl[as_if_settings_ix];
-
-    OSMutexPost(p_mutex,
-                OS_OPT_POST_NONE,
-               &err_os);
-    (void)err_os;
-}
-
-
 /*
 *********************************************************************************************************
 *                                     USBD_Audio_OS_RecordReqPost()
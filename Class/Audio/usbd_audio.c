@@ -2348,11 +2348,6 @@ USBD_AUDIO_AS_IF_HANDLE  USBD_Audio_AS_IF_Cfg (const  USBD_AUDIO_STREAM_CFG
     p_as_if_settings->StreamPreBufMax   = p_stream_cfg->MaxBufNbr / 2u;
     p_as_if_settings->StreamPrimingDone = DEF_NO;
 
-    USBD_Audio_OS_RingBufQLockCreate(as_if_settings_ix, p_err);
-    if (*p_err != USBD_ERR_NONE) {
-        return ((USBD_AUDIO_AS_IF_HANDLE)0);
-    }
-
 
 #if (USBD_AUDIO_CFG_PLAYBACK_CORR_EN == DEF_ENABLED) || \
     (USBD_AUDIO_CFG_RECORD_CORR_EN   == DEF_ENABLED)
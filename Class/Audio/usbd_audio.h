@@ -1078,6 +1078,17 @@ USBD_AUDIO_STAT  *USBD_Audio_AS_IF_StatGet         (       USBD_AUDIO_AS_HANDLE
 #error  "USBD_AUDIO_CFG_PLAYBACK_CORR_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
 #endif
 
+#if     (USBD_AUDIO_CFG_PLAYBACK_CORR_EN == DEF_ENABLED)
+#ifndef  USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN
+#error  "USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+#if    ((USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN != DEF_ENABLED) && \
+        (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN != DEF_DISABLED))
+#error  "USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+#endif
+
 #ifndef  USBD_AUDIO_CFG_PLAYBACK_FEEDBACK_EN
 #error  "USBD_AUDIO_CFG_PLAYBACK_FEEDBACK_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
 #endif
@@ -1096,6 +1107,17 @@ USBD_AUDIO_STAT  *USBD_Audio_AS_IF_StatGet         (       USBD_AUDIO_AS_HANDLE
 #error  "USBD_AUDIO_CFG_RECORD_CORR_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
 #endif
 
+#if     (USBD_AUDIO_CFG_RECORD_CORR_EN == DEF_ENABLED)
+#ifndef  USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN
+#error  "USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+#if    ((USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN != DEF_ENABLED) && \
+        (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN != DEF_DISABLED))
+#error  "USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -387,16 +387,44 @@ struct  usbd_audio_su {
 *               11.025             | 11 samples          | 12 samples every 40 packets (i.e. ms)
 *               22.050             | 22 samples          | 23 samples every 20 packets (i.e. ms)
 *               44.1               | 44 samples          | 45 samples every 10 packets (i.e. ms)
+*
+*           (4) The ring buffer queue indexes are accessed without critical sections :
+*
+*               (a) Each index has a single writer and is written with a single store. A context advances
+*                   an index only once it is done with the buffer descriptor at that index.
+*
+*                   Playback:   'ProducerStartIx' and 'ProducerEndIx' are written by the Core task,
+*                               'ConsumerStartIx' by the Playback task and 'ConsumerEndIx' by the codec.
+*
+*                   Record:     'ProducerStartIx' is written by the codec, 'ProducerEndIx' by the Record
+*                               task, 'ConsumerStartIx' and 'ConsumerEndIx' by the Core task.
+*
+*                   The Playback or Record task submits an isochronous transfer itself to prime or restart
+*                   the stream, only when 'PlaybackIsocRxOngoingCnt' or 'RecordIsocTxOngoingCnt' is null.
+*                   It submits the buffer at the Start index without advancing it. The Core task advances
+*                   the Start index when this transfer completes, as it then finds the End index equal to
+*                   the Start index. The Core task decrements the ongoing transfer count only after it has
+*                   submitted the next transfers, so the task never restarts the stream while the Core
+*                   task may still advance the Start index.
+*
+*               (b) Before using a buffer descriptor, a context reads the indexes written by the other
+*                   contexts and checks that it does not catch up with them. An acquire fence after these
+*                   reads pairs with a release fence before each index update, so that buffer descriptor
+*                   contents are visible to the next context even if it runs on another core. The fences
+*                   use <stdatomic.h> on a C11 compiler or the GCC atomic built-ins. Otherwise, an empty
+*                   critical section is used, which orders the accesses on a single core only.
+*
+*               (c) A 16-bit index must be read and written atomically by the CPU.
 *********************************************************************************************************
 */
 
                                                                 /* AudioStreaming IF ring buf queue (see Note #1).      */
 typedef struct  usbd_audio_as_if_ring_buf_q {
            USBD_AUDIO_BUF_DESC            *BufDescTblPtr;
-           CPU_INT16U                      ProducerStartIx;
-           CPU_INT16U                      ProducerEndIx;
-           CPU_INT16U                      ConsumerStartIx;
-           CPU_INT16U                      ConsumerEndIx;
+ volatile  CPU_INT16U                      ProducerStartIx;     /* See Note #4.                                         */
+ volatile  CPU_INT16U                      ProducerEndIx;
+ volatile  CPU_INT16U                      ConsumerStartIx;
+ volatile  CPU_INT16U                      ConsumerEndIx;
 } USBD_AUDIO_AS_IF_RING_BUF_Q;
 
                                                                 /* AudioStreaming alt settings (see Note #2).           */
@@ -443,6 +471,9 @@ typedef struct  usbd_audio_as_if_settings {                     /* See Note #1.
 #if (USBD_AUDIO_CFG_PLAYBACK_EN          == DEF_ENABLED) && \
     (USBD_AUDIO_CFG_PLAYBACK_FEEDBACK_EN == DEF_ENABLED)
            USBD_AUDIO_PLAYBACK_SYNCH       PlaybackSynch;       /* Struct containing synch infos.                       */
+#endif
+#if (USBD_AUDIO_CFG_PLAYBACK_EN          == DEF_ENABLED)
+           CPU_INT16S                      PlaybackIsocRxOngoingCnt;/* Nbr of isoc OUT xfer in progress (see Note #4a). */
 #endif
                                                                 /* RECORD STATE:                                        */
 #if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
@@ -487,6 +518,11 @@ struct  usbd_audio_as_if {
 struct  usbd_audio_buf_desc {
            void                           *BufPtr;
            CPU_INT16U                      BufLen;
+#if (USBD_AUDIO_CFG_RECORD_EN               == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_EN          == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+           CPU_INT08S                      RecordCorr;          /* Nbr of frames added by record corr (-1, 0 or 1).     */
+#endif
 };
 
 
@@ -110,15 +110,6 @@ void   USBD_Audio_OS_AS_IF_LockAcquire  (CPU_INT08U   as_if_nbr,
 
 void   USBD_Audio_OS_AS_IF_LockRelease  (CPU_INT08U   as_if_nbr);
 
-void   USBD_Audio_OS_RingBufQLockCreate (CPU_INT08U   as_if_settings_ix,
-                                         USBD_ERR    *p_err);
-
-void   USBD_Audio_OS_RingBufQLockAcquire(CPU_INT08U   as_if_settings_ix,
-                                         CPU_INT16U   timeout_ms,
-                                         USBD_ERR    *p_err);
-
-void   USBD_Audio_OS_RingBufQLockRelease(CPU_INT08U   as_if_settings_ix);
-
 #if (USBD_AUDIO_CFG_RECORD_EN == DEF_ENABLED)
 void   USBD_Audio_OS_RecordReqPost      (void        *p_msg,
                                          USBD_ERR    *p_err);
@@ -43,6 +43,20 @@
 #include  "usbd_audio_internal.h"
 #include  "usbd_audio_os.h"
 
+#if ((defined(__STDC_VERSION__))           && \
+     (__STDC_VERSION__ >= 201112L)         && \
+     (!defined(__STDC_NO_ATOMICS__)))
+#include  <stdatomic.h>
+#define  USBD_AUDIO_RING_BUF_Q_C11_ATOMICS
+#endif
+
+#if   (defined(__ARM_NEON) && defined(__aarch64__) && !defined(__ARM_BIG_ENDIAN))
+#include  <arm_neon.h>
+#elif  defined(__SSE4_1__)
+#include  <emmintrin.h>
+#include  <smmintrin.h>
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -52,9 +66,37 @@
 *********************************************************************************************************
 */
 
-#define  USBD_AUDIO_PLAYBACK_CORR_MIN_NBR_SAMPLES          4u   /* Min nbr of samples in buf to apply playback corr.    */
+#define  USBD_AUDIO_CORR_MIN_NBR_SAMPLES                   4u   /* Min nbr of samples in buf to apply corr.             */
 #define  USBD_AUDIO_OVERRUN_NBR_SAMPLES_FOR_AVERAGING      4u
 #define  USBD_AUDIO_UNDERRUN_NBR_SAMPLES_FOR_AVERAGING     2u
+                                                                /* Resampling corr pos fractional part.                 */
+#define  USBD_AUDIO_CORR_FRAC_NBR_BITS                    16u
+#define  USBD_AUDIO_CORR_FRAC_ONE                      65536
+#define  USBD_AUDIO_CORR_FRAC_MASK                    0xFFFFu
+                                                                /* Nbr of log ch resampled together.                    */
+#define  USBD_AUDIO_CORR_NBR_LANE                          4u
+
+#if (((USBD_AUDIO_CFG_PLAYBACK_CORR_EN          == DEF_ENABLED)  && \
+      (USBD_AUDIO_CFG_PLAYBACK_EN               == DEF_ENABLED)  && \
+      (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN == DEF_ENABLED)) || \
+     ((USBD_AUDIO_CFG_RECORD_CORR_EN            == DEF_ENABLED)  && \
+      (USBD_AUDIO_CFG_RECORD_EN                 == DEF_ENABLED)  && \
+      (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN   == DEF_ENABLED)))
+#define  USBD_AUDIO_CORR_RESAMPLE_EN                DEF_ENABLED
+#else
+#define  USBD_AUDIO_CORR_RESAMPLE_EN                DEF_DISABLED
+#endif
+                                                                /* Resampling kernels (see USBD_Audio_CorrResample()).  */
+#if   (defined(__ARM_NEON) && defined(__aarch64__) && !defined(__ARM_BIG_ENDIAN))
+#define  USBD_AUDIO_CORR_NEON_EN                    DEF_ENABLED
+#define  USBD_AUDIO_CORR_SSE41_EN                   DEF_DISABLED
+#elif  defined(__SSE4_1__)
+#define  USBD_AUDIO_CORR_NEON_EN                    DEF_DISABLED
+#define  USBD_AUDIO_CORR_SSE41_EN                   DEF_ENABLED
+#else
+#define  USBD_AUDIO_CORR_NEON_EN                    DEF_DISABLED
+#define  USBD_AUDIO_CORR_SSE41_EN                   DEF_DISABLED
+#endif
 
 #define  USBD_AUDIO_REQ_CTRL_SELECTOR_MASK            0xFF00u
 #define  USBD_AUDIO_REQ_CH_NBR_MASK                   0x00FFu
@@ -64,6 +106,22 @@
 
 #define  USBD_AUDIO_LOCK_TIMEOUT_mS                     1000u
 
+                                                                /* ------------ RING BUF Q MEMORY ORDERING ------------ */
+#ifdef   USBD_AUDIO_RING_BUF_Q_C11_ATOMICS                      /* See 'usbd_audio_internal.h' AS IF Note #4.           */
+#define  USBD_AUDIO_RING_BUF_Q_ACQUIRE()          atomic_thread_fence(memory_order_acquire)
+#define  USBD_AUDIO_RING_BUF_Q_RELEASE()          atomic_thread_fence(memory_order_release)
+#elif    defined(__GNUC__)
+#define  USBD_AUDIO_RING_BUF_Q_ACQUIRE()          __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define  USBD_AUDIO_RING_BUF_Q_RELEASE()          __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#define  USBD_AUDIO_RING_BUF_Q_ACQUIRE()          do {                          \
+                                                      CPU_SR_ALLOC();           \
+                                                      CPU_CRITICAL_ENTER();     \
+                                                      CPU_CRITICAL_EXIT();      \
+                                                  } while (0)
+#define  USBD_AUDIO_RING_BUF_Q_RELEASE()          USBD_AUDIO_RING_BUF_Q_ACQUIRE()
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -146,6 +204,18 @@
 *********************************************************************************************************
 */
 
+                                                                /* NEON 3-octet subframe unpack and pack.               */
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED) && \
+    (USBD_AUDIO_CORR_NEON_EN     == DEF_ENABLED)
+static  const  CPU_INT08U  USBD_Audio_CorrSample24UnpackTbl[16u] = {
+    0xFFu,  0u,  1u,  2u, 0xFFu,  3u,  4u,  5u, 0xFFu,  6u,  7u,  8u, 0xFFu,  9u, 10u, 11u
+};
+
+static  const  CPU_INT08U  USBD_Audio_CorrSample24PackTbl[16u] = {
+       0u,  1u,  2u,  4u,    5u,  6u,  8u,  9u,   10u, 12u, 13u, 14u, 0xFFu, 0xFFu, 0xFFu, 0xFFu
+};
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -193,6 +263,13 @@ static  CPU_INT16U            USBD_Audio_RecordDataRateAdj               (
 static  void                  USBD_Audio_RecordCorrBuiltIn               (       USBD_AUDIO_AS_IF             *p_as_if,
                                                                                  USBD_AUDIO_BUF_DESC          *p_buf_desc);
 #endif
+
+#if (USBD_AUDIO_CFG_RECORD_EN               == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_EN          == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void                  USBD_Audio_RecordCorrResample              (       USBD_AUDIO_AS_IF             *p_as_if,
+                                                                                 USBD_AUDIO_BUF_DESC          *p_buf_desc);
+#endif
 #endif
 
 #if (USBD_AUDIO_CFG_PLAYBACK_EN  == DEF_ENABLED)
@@ -225,6 +302,32 @@ static  void                  USBD_Audio_PlaybackCorrBuiltIn             (
                                                                                  USBD_ERR                     *p_err);
 #endif
 
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void                  USBD_Audio_CorrResample                    (       CPU_INT08U                   *p_buf,
+                                                                                 CPU_INT16U                    nbr_frame,
+                                                                                 CPU_BOOLEAN                   insert,
+                                                                                 USBD_AUDIO_AS_ALT_CFG        *p_as_cfg);
+
+static  void                  USBD_Audio_CorrInterpolate                 (       CPU_INT32S                    win[][USBD_AUDIO_CORR_NBR_LANE],
+                                                                                 CPU_INT08U                    win_ix,
+                                                                                 CPU_INT08U                    nbr_lane,
+                                                                                 CPU_INT32U                    frac,
+                                                                                 CPU_INT32S                   *p_val,
+                                                                                 CPU_INT32S                    sample_min,
+                                                                                 CPU_INT32S                    sample_max);
+
+static  void                  USBD_Audio_CorrFrameRd                     (const  CPU_INT08U                   *p_subframe,
+                                                                                 CPU_INT08U                    nbr_lane,
+                                                                                 CPU_INT08U                    subframe_len,
+                                                                                 CPU_INT08U                    bit_res,
+                                                                                 CPU_INT32S                   *p_val);
+
+static  void                  USBD_Audio_CorrFrameWr                     (       CPU_INT08U                   *p_subframe,
+                                                                          const  CPU_INT32S                   *p_val,
+                                                                                 CPU_INT08U                    nbr_lane,
+                                                                                 CPU_INT08U                    subframe_len);
+#endif
+
 #if (USBD_AUDIO_CFG_PLAYBACK_FEEDBACK_EN == DEF_ENABLED)
 static  void                  USBD_Audio_PlaybackCorrSynchInit           (       USBD_AUDIO_AS_IF             *p_as_if,
                                                                                  CPU_INT32U                    sampling_freq,
@@ -380,7 +483,10 @@ static  CPU_INT16U            USBD_Audio_AS_IF_RingBufQConsumerStartIxGet(
 static  CPU_INT16U            USBD_Audio_AS_IF_RingBufQConsumerEndIxGet  (       USBD_AUDIO_AS_IF_SETTINGS    *p_as_if_settings);
 
 static  void                  USBD_Audio_AS_IF_RingBufQIxUpdate          (       USBD_AUDIO_AS_IF_SETTINGS    *p_as_if_settings,
-                                                                                 CPU_INT16U                   *p_ix);
+                                                                       volatile  CPU_INT16U                   *p_ix);
+
+static  CPU_INT16U            USBD_Audio_AS_IF_RingBufQIxNext            (       USBD_AUDIO_AS_IF_SETTINGS    *p_as_if_settings,
+                                                                                 CPU_INT16U                    ix);
 
 #if ( (USBD_AUDIO_CFG_PLAYBACK_EN          == DEF_ENABLED) &&   \
      ((USBD_AUDIO_CFG_PLAYBACK_CORR_EN     == DEF_ENABLED) ||   \
@@ -1131,6 +1237,10 @@ void  USBD_Audio_AS_EP_CtrlProcess (       USBD_AUDIO_AS_IF       *p_as_if,
 *                   (b) When there is no more ongoing isochronous transfers in the USB driver during
 *                       an ongoing stream communication, that is the stream loop is broken. In that
 *                       case, the Record task restarts the stream with a new USB transfer.
+*
+*               (2) The buffer is resampled in the Record task rather than in the Core task, which only
+*                   sets the number of frames the codec captures (see USBD_Audio_RecordCorrBuiltIn()
+*                   'Note #3').
 *********************************************************************************************************
 */
 
@@ -1197,6 +1307,10 @@ void  USBD_Audio_RecordTaskHandler (void)
             USBD_DBG_AUDIO_PROC_ERR("RecordTaskHandler(): cannot get ready buf w/ err = %d\r\n", err_usbd);
             goto end_lock_rel;
         }
+#if (USBD_AUDIO_CFG_RECORD_CORR_EN          == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+        USBD_Audio_RecordCorrResample(p_as_if, p_buf_desc);     /* Resample buf to nominal len (see Note #2).           */
+#endif
 
                                                                 /* Update ix only after writing to buf desc.            */
         USBD_Audio_AS_IF_RingBufQIxUpdate(p_as_if_settings, &p_as_if_settings->StreamRingBufQ.ProducerEndIx);
@@ -1368,6 +1482,7 @@ void  USBD_Audio_AS_IF_Start (USBD_AUDIO_AS_IF  *p_as_if,
             USBD_DBG_AUDIO_PROC_ERR("AS_IF_Start(): starting playback priming failed w/ err = %d\r\n", *p_err);
             goto end_lock_clean;
         }
+        USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitCoreTask);
 #endif
     }
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_NbrStreamOpen);
@@ -1452,6 +1567,11 @@ void  USBD_Audio_AS_IF_Stop (USBD_AUDIO_AS_IF  *p_as_if,
         p_as_if_settings->RecordBufLen           = 0u;
         p_as_if_settings->RecordIsocTxOngoingCnt = 0u;
     }
+#endif
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED)
+    if (p_as_if_settings->StreamDir == USBD_AUDIO_STREAM_OUT) {
+        p_as_if_settings->PlaybackIsocRxOngoingCnt = 0;
+    }
 #endif
     USBD_AUDIO_STAT_PROT_INC(p_as_if_settings->StatPtr->AudioProc_NbrStreamClosed);
 
@@ -1777,14 +1897,18 @@ USBD_AUDIO_STAT  *USBD_Audio_StatGet (USBD_AUDIO_AS_HANDLE  as_handle)
 *                   the freed buffer for a new buffer request.
 *
 *               (2) An isochronous IN transfer is aborted (error USBD_ERR_EP_ABORT) if the stream is
-*                   closed by the host or if the device disconnects from the host.
+*                   closed by the host or if the device disconnects from the host. The number of ongoing
+*                   transfers is reset when the stream is closed and is left untouched.
 *
-*               (3) Ring buffer queue lock protects the 'ConsumerStartIx' when the record task must
-*                   restart internally. When restarting a stream, the Record task starts an isochronous
-*                   IN transfer. Record task may be preempted by the Core task because the isochronous
-*                   IN transfer has finished but the Record task must update 'ConsumerStartIx' before
-*                   'ConsumerEndIx' checks it. Stream restart occurs because there is no more ongoing
-*                   isochronous transfer in the USB driver.
+*               (3) USBD_Audio_RecordPrime() submits the buffer at 'ConsumerStartIx' without advancing
+*                   the index. If no other transfer was in progress, 'ConsumerEndIx' equals
+*                   'ConsumerStartIx' when this transfer completes and 'ConsumerStartIx' is advanced
+*                   here instead. The Core task is the only writer of 'ConsumerStartIx' (see
+*                   'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4a').
+*
+*               (4) The number of ongoing transfers is decremented only after the new transfers are
+*                   submitted, so that the Record task does not restart the stream while the Core task
+*                   still owns 'ConsumerStartIx'.
 *********************************************************************************************************
 */
 
@@ -1802,8 +1926,8 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
     USBD_AUDIO_BUF_DESC        *p_buf_desc;
     CPU_INT16U                  nbr_xfer_submitted;
     CPU_INT16U                  ix;
-    USBD_ERR                    err_usbd;
 #if (USBD_AUDIO_CFG_RECORD_CORR_EN == DEF_ENABLED)
+    USBD_ERR                    err_usbd;
     CPU_INT16U                  frame_nbr_cur;
     CPU_INT16U                  frame_nbr_diff;
 #endif
@@ -1821,10 +1945,6 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
 
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxCmpl);
 
-    CPU_CRITICAL_ENTER();
-    p_as_if_settings->RecordIsocTxOngoingCnt--;
-    CPU_CRITICAL_EXIT();
-
                                                                 /* -------- CHECK IF ERR UPON XFER COMPLETION --------- */
     if ((err != USBD_ERR_NONE) &&
         (err != USBD_ERR_EP_ABORT)) {                           /* See Note #1.                                         */
@@ -1836,32 +1956,30 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
         return;
     }
                                                                 /* --------------- PREPARE NXT BUF REQ ---------------- */
-    USBD_Audio_OS_RingBufQLockAcquire(p_as_if_settings->Ix,     /* See Note #3.                                         */
-                                      USBD_AUDIO_LOCK_TIMEOUT_mS,
-                                     &err_usbd);
-    if (err_usbd != USBD_ERR_NONE) {
-        USBD_DBG_AUDIO_PROC_ERR("RecordisocCmpl(): lock acquire failed w/ err = %d\r\n", err_usbd);
-        return;
+    nbr_xfer_submitted = 0u;
+                                                                /* Xfer started by Record task (see Note #3).           */
+    if (p_as_if_settings->StreamRingBufQ.ConsumerEndIx == p_as_if_settings->StreamRingBufQ.ConsumerStartIx) {
+        USBD_Audio_AS_IF_RingBufQIxUpdate(p_as_if_settings, &p_as_if_settings->StreamRingBufQ.ConsumerStartIx);
     }
                                                                 /* Get a buf desc from the Ring Buf Q.                  */
     ix = USBD_Audio_AS_IF_RingBufQConsumerEndIxGet(p_as_if_settings);
     if (ix == USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX) {
-        USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
-        return;
+        goto end_cnt_update;
     }
 
-    USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
-
     p_buf_desc = USBD_Audio_AS_IF_RingBufQGet(&p_as_if_settings->StreamRingBufQ, ix);
     if (p_buf_desc == DEF_NULL) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrErr);
         USBD_DBG_AUDIO_PROC_MSG("RecordisocCmpl(): buf desc retrieved from Ring Buf Q should NOT be a NULL ptr\r\n");
-        return;
+        goto end_cnt_update;
     }
 
     p_buf_desc->BufLen = USBD_Audio_RecordDataRateAdj(p_as_if);
                                                                 /* -------------- EVALUATE BUILT-IN CORR -------------- */
 #if (USBD_AUDIO_CFG_RECORD_CORR_EN == DEF_ENABLED)
+#if (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+    p_buf_desc->RecordCorr = 0;
+#endif
     frame_nbr_cur  = USBD_DevFrameNbrGet(p_as_if->DevNbr, &err_usbd);
     frame_nbr_cur  = USBD_FRAME_NBR_GET(frame_nbr_cur);
     frame_nbr_diff = USBD_FRAME_NBR_DIFF_GET(p_as_if_settings->CorrFrameNbr, frame_nbr_cur);
@@ -1879,6 +1997,11 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
                                                                 /* -------- SUBMIT ISOC XFER(S) TO USB DEV DRV -------- */
     USBD_Audio_RecordUsbBufSubmit(p_as_if, &nbr_xfer_submitted);
     USBD_AUDIO_STAT_ADD(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxSubmitCoreTask, nbr_xfer_submitted);
+
+end_cnt_update:
+    CPU_CRITICAL_ENTER();                                       /* See Note #4.                                         */
+    p_as_if_settings->RecordIsocTxOngoingCnt += (CPU_INT16S)nbr_xfer_submitted - 1;
+    CPU_CRITICAL_EXIT();
 }
 #endif
 
@@ -1896,12 +2019,6 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
 *                           USBD_ERR_NONE               Stream priming successfully started.
 *                           USBD_ERR_FAIL               No buffer descriptor obtained from ring buffer queue.
 *
-*                                                       - RETURNED BY USBD_Audio_OS_RingBufQLockAcquire() : -
-*                           USBD_ERR_OS_TIMEOUT         OS lock NOT successfully acquired in the time
-*                                                       specified by 'timeout_ms'.
-*                           USBD_ERR_OS_ABORT           OS lock aborted.
-*                           USBD_ERR_OS_FAIL            OS lock not acquired because another error.
-*
 *                                                       ------- RETURNED BY USBD_IsocTxAsync() : -------
 *                           USBD_ERR_DEV_INVALID_NBR    Invalid device number.
 *                           USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
@@ -1915,12 +2032,13 @@ static  void  USBD_Audio_RecordIsocCmpl (CPU_INT08U   dev_nbr,
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Ring buffer queue lock protects the 'ConsumerStartIx' when the record task must restart
-*                   internally. When restarting a stream, the Record task starts an isochronous IN
-*                   transfer. Record task may be preempted by the Core task because the isochronous IN
-*                   transfer has finished but the Record task must update 'ConsumerStartIx' before
-*                   'ConsumerEndIx' checks it. Stream restart occurs because there is no more ongoing
-*                   isochronous transfer in the USB driver.
+* Note(s)     : (1) This function is called by the Record task only when no isochronous IN transfer is in
+*                   progress. The Core task then does not access 'ConsumerStartIx'.
+*
+*               (2) The buffer at 'ConsumerStartIx' is submitted without advancing the index. The Core
+*                   task advances it when the transfer completes (see USBD_Audio_RecordIsocCmpl()
+*                   'Note #3'). The transfer is counted before being submitted, as it may complete before
+*                   USBD_IsocTxAsync() returns.
 *********************************************************************************************************
 */
 
@@ -1934,29 +2052,25 @@ static  void  USBD_Audio_RecordPrime (USBD_AUDIO_AS_IF  *p_as_if,
     CPU_INT16U                  ix;
     CPU_SR_ALLOC();
 
-
-    USBD_Audio_OS_RingBufQLockAcquire(p_as_if_settings->Ix,     /* See Note #1.                                         */
-                                      USBD_AUDIO_LOCK_TIMEOUT_mS,
-                                      p_err);
-    if (*p_err != USBD_ERR_NONE) {
-        USBD_DBG_AUDIO_PROC_ERR("RecordPrime(): lock acquire failed w/ err = %d\r\n", *p_err);
-        return;
-    }
-                                                                /* Get a buf desc from the Ring Buf Q.                  */
+                                                                /* Get a buf desc from the Ring Buf Q (see Note #1).    */
     ix = USBD_Audio_AS_IF_RingBufQConsumerStartIxGet(p_as_if_settings);
     if (ix == USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxBufNotAvail);
         USBD_DBG_AUDIO_PROC_MSG("RecordPrime(): no buffer descriptor\r\n");
        *p_err = USBD_ERR_FAIL;
-        goto end_lock_clean;
+        return;
     }
     p_buf_desc = USBD_Audio_AS_IF_RingBufQGet(&p_as_if_settings->StreamRingBufQ, ix);
     if (p_buf_desc == DEF_NULL) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrErr);
         USBD_DBG_AUDIO_PROC_MSG("RecordPrime(): buf desc retrieved from Ring Buf Q should NOT be a NULL ptr\r\n");
        *p_err = USBD_ERR_FAIL;
-        goto end_lock_clean;
+        return;
     }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #2.                                         */
+    p_as_if_settings->RecordIsocTxOngoingCnt++;
+    CPU_CRITICAL_EXIT();
                                                                 /* Submit buf to USB device driver.                     */
     USBD_IsocTxAsync(        p_as_if->DevNbr,
                              p_as_if_alt->DataIsocAddr,
@@ -1968,19 +2082,13 @@ static  void  USBD_Audio_RecordPrime (USBD_AUDIO_AS_IF  *p_as_if,
     if (*p_err != USBD_ERR_NONE) {
         USBD_DBG_AUDIO_PROC_ERR("RecordPrime(): isochronous Tx failed w/ err = %d\r\n", *p_err);
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxSubmitErr);
-        goto end_lock_clean;
+        CPU_CRITICAL_ENTER();
+        p_as_if_settings->RecordIsocTxOngoingCnt--;
+        CPU_CRITICAL_EXIT();
+        return;
     }
 
-    USBD_Audio_AS_IF_RingBufQIxUpdate(p_as_if_settings, &p_as_if_settings->StreamRingBufQ.ConsumerStartIx);
-
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxSubmitSuccess);
-    CPU_CRITICAL_ENTER();
-    p_as_if_settings->RecordIsocTxOngoingCnt++;
-    CPU_CRITICAL_EXIT();
-
-
-end_lock_clean:
-    USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
 }
 #endif
 
@@ -2004,6 +2112,8 @@ end_lock_clean:
 *                   when there is no room left to queue the current isochronous transfer. In that case,
 *                   another isochronous transfer will be submitted next time an isochronous transfer
 *                   completes.
+*
+*               (3) The caller adds the number of submitted transfers to 'RecordIsocTxOngoingCnt'.
 *********************************************************************************************************
 */
 
@@ -2017,7 +2127,9 @@ static  void  USBD_Audio_RecordUsbBufSubmit (USBD_AUDIO_AS_IF  *p_as_if,
     CPU_BOOLEAN                 loop_end         = DEF_NO;
     USBD_ERR                    err_usbd;
     CPU_INT16U                  ix;
+#if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
     CPU_SR_ALLOC();
+#endif
 
 
    *p_xfer_submitted_cnt = 0u;
@@ -2047,10 +2159,6 @@ static  void  USBD_Audio_RecordUsbBufSubmit (USBD_AUDIO_AS_IF  *p_as_if,
 
             USBD_AUDIO_STAT_PROT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxSubmitSuccess);
            *p_xfer_submitted_cnt += 1u;
-
-            CPU_CRITICAL_ENTER();
-            p_as_if_settings->RecordIsocTxOngoingCnt++;
-            CPU_CRITICAL_EXIT();
         } else {                                                /* See Note #2.                                         */
             USBD_AUDIO_STAT_PROT_INC(p_as_if_settings->StatPtr->AudioProc_Record_NbrIsocTxSubmitErr);
             loop_end = DEF_YES;
@@ -2130,6 +2238,12 @@ static  CPU_INT16U  USBD_Audio_RecordDataRateAdj (USBD_AUDIO_AS_IF  *p_as_if)
 *                   indicates an overrun situation, that is the USB consumes too quickly buffers and thus
 *                   a sample is removed so that the codec production speeds up. Conversely, a positive
 *                   buffers' difference indicates an underrun situation.
+*
+*               (3) If USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN is enabled, the codec still captures one
+*                   frame more or less, and the buffer is marked so that the Record task resamples it
+*                   back to its nominal length (see USBD_Audio_RecordCorrResample()). The host then
+*                   receives packets of nominal length, and the one frame difference is spread over the
+*                   whole buffer.
 *********************************************************************************************************
 */
 
@@ -2143,12 +2257,9 @@ static  void  USBD_Audio_RecordCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
     USBD_AUDIO_AS_ALT_CFG      *p_as_cfg;
     CPU_INT08S                  buf_diff;
     CPU_INT08U                  sample_frame;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
     buf_diff = USBD_Audio_BufDiffGet(p_as_if_settings);         /* Get cur buf diff between USB & codec.                */
-    CPU_CRITICAL_EXIT();
 
                                                                 /* If safe zone, no correction applies.                 */
     if ((buf_diff > p_as_if_settings->CorrBoundaryHeavyNeg) &&
@@ -2166,11 +2277,75 @@ static  void  USBD_Audio_RecordCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_CorrNbrOverrun);
         p_buf_desc->BufLen -= sample_frame;
+#if (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+        p_buf_desc->RecordCorr = -1;                            /* See Note #3.                                         */
+#endif
 
     } else {                                                    /* ------------- UNDERRUN: INSERT SAMPLE -------------- */
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_CorrNbrUnderrun);
         p_buf_desc->BufLen += sample_frame;
+#if (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+        p_buf_desc->RecordCorr = 1;                             /* See Note #3.                                         */
+#endif
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_Audio_RecordCorrResample()
+*
+* Description : Resample a captured record buffer back to its nominal length.
+*
+* Argument(s) : p_as_if     Pointer to AudioStreaming interface.
+*
+*               p_buf_desc  Pointer to buffer descriptor, filled by the codec.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) A frame is added to a buffer captured with one frame less, and removed from a buffer
+*                   captured with one frame more (see USBD_Audio_RecordCorrBuiltIn() 'Note #3'). Buffers
+*                   are allocated with room for one frame more than the maximum packet size (see
+*                   USBD_Audio_AS_IF_Cfg()).
+*
+*               (2) A buffer too short to be resampled is sent as captured, as without resampling.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_RECORD_EN               == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_EN          == DEF_ENABLED) && \
+    (USBD_AUDIO_CFG_RECORD_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void  USBD_Audio_RecordCorrResample (USBD_AUDIO_AS_IF     *p_as_if,
+                                             USBD_AUDIO_BUF_DESC  *p_buf_desc)
+{
+    USBD_AUDIO_AS_ALT_CFG  *p_as_cfg;
+    CPU_INT08S              corr;
+    CPU_INT16U              frame_len;
+
+
+    corr                   = p_buf_desc->RecordCorr;
+    p_buf_desc->RecordCorr = 0;
+    if (corr == 0) {
+        return;
+    }
+
+    p_as_cfg  = p_as_if->AS_IF_AltCurPtr->AS_CfgPtr;
+    frame_len = p_as_cfg->NbrCh * p_as_cfg->SubframeSize;
+                                                                /* See Note #2.                                         */
+    if (p_buf_desc->BufLen < (USBD_AUDIO_CORR_MIN_NBR_SAMPLES * frame_len)) {
+        return;
+    }
+                                                                /* See Note #1.                                         */
+    USBD_Audio_CorrResample((CPU_INT08U *)p_buf_desc->BufPtr,
+                            (CPU_INT16U  )(p_buf_desc->BufLen / frame_len),
+                                          (corr < 0) ? DEF_YES : DEF_NO,
+                                          p_as_cfg);
+    if (corr < 0) {
+        p_buf_desc->BufLen += frame_len;
+    } else {
+        p_buf_desc->BufLen -= frame_len;
     }
 }
 #endif
@@ -2200,12 +2375,18 @@ static  void  USBD_Audio_RecordCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
 * Note(s)     : (1) An isochronous OUT transfer is aborted (error USBD_ERR_EP_ABORT) if the stream is
 *                   closed by the host or if the device disconnects from the host.
 *
-*               (2) Ring buffer queue lock protects the 'ProducerStartIx' when the Playback task must
-*                   restart internally. When restarting a stream, the Playback task starts an isochronous
-*                   OUT transfer. Playback task may be preempted by the Core task because the isochronous
-*                   IN transfer has finished but the Playback task must update 'ProducerStartIx' before
-*                   'ProducerEndIx' checks it. Stream restart occurs because there is no more ongoing
-*                   isochronous transfer in the USB driver.
+*                   The number of ongoing transfers is reset when the stream is closed and is left
+*                   untouched.
+*
+*               (2) USBD_Audio_PlaybackPrime() submits the buffer at 'ProducerStartIx' without advancing
+*                   the index. If no other transfer was in progress, 'ProducerEndIx' equals
+*                   'ProducerStartIx' when this transfer completes and 'ProducerStartIx' is advanced
+*                   here instead. The Core task is the only writer of 'ProducerStartIx' (see
+*                   'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4a').
+*
+*               (3) The number of ongoing transfers is decremented only after the new transfers are
+*                   submitted, so that the Playback task does not restart the stream while the Core
+*                   task still owns 'ProducerStartIx'.
 *********************************************************************************************************
 */
 
@@ -2223,15 +2404,13 @@ static  void  USBD_Audio_PlaybackIsocCmpl (CPU_INT08U   dev_nbr,
     USBD_AUDIO_BUF_DESC        *p_buf_desc;
 #if (USBD_AUDIO_CFG_PLAYBACK_CORR_EN == DEF_ENABLED)
     USBD_AUDIO_AS_IF_ALT       *p_as_if_alt;
+    USBD_ERR                    err_usbd;
 #endif
     CPU_INT16U                  ix;
     CPU_BOOLEAN                 valid;
     CPU_INT16U                  nbr_xfer_submitted;
     CPU_BOOLEAN                 pre_buf_compl;
-    USBD_ERR                    err_usbd;
-#if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
     CPU_SR_ALLOC();
-#endif
 
 
     (void)dev_nbr;
@@ -2244,40 +2423,35 @@ static  void  USBD_Audio_PlaybackIsocCmpl (CPU_INT08U   dev_nbr,
     USBD_AUDIO_STAT_PROT_DEC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxOngoingCnt);
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxCmpl);
 
+    nbr_xfer_submitted = 0u;
                                                                 /* -------- CHECK IF ERR UPON XFER COMPLETION --------- */
     if ((err != USBD_ERR_NONE) &&
         (err != USBD_ERR_EP_ABORT)) {
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxCmplErrOther);
-        return;
+        goto end_cnt_update;
 
     } else if (err == USBD_ERR_EP_ABORT) {                      /* See Note #1.                                         */
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxCmplErrAbort);
         return;
     }
                                                                 /* ------------- STORE BUF IN RING BUF Q -------------- */
-    USBD_Audio_OS_RingBufQLockAcquire(p_as_if_settings->Ix,     /* See note #2.                                         */
-                                      USBD_AUDIO_LOCK_TIMEOUT_mS,
-                                     &err_usbd);
-    if (err_usbd != USBD_ERR_NONE) {
-        USBD_DBG_AUDIO_PROC_ERR("IsocPlaybackCmpl(): lock acquire failed w/ err = %d\r\n", err_usbd);
-        return;
+                                                                /* Xfer started by Playback task (see Note #2).         */
+    if (p_as_if_settings->StreamRingBufQ.ProducerEndIx == p_as_if_settings->StreamRingBufQ.ProducerStartIx) {
+        USBD_Audio_AS_IF_RingBufQIxUpdate(p_as_if_settings, &p_as_if_settings->StreamRingBufQ.ProducerStartIx);
     }
                                                                 /* Get a buf desc from the Ring Buf Q.                  */
     ix = USBD_Audio_AS_IF_RingBufQProducerEndIxGet(p_as_if_settings);
     if (ix == USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrErr);
-        USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
-        return;
+        goto end_cnt_update;
     }
 
-    USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
-
     p_buf_desc = USBD_Audio_AS_IF_RingBufQGet(&p_as_if_settings->StreamRingBufQ, ix);
     if (p_buf_desc == DEF_NULL) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrErr);
         USBD_DBG_AUDIO_PROC_MSG("IsocPlaybackCmpl(): buf desc retrieved from Ring Buf Q should NOT be a NULL ptr\r\n");
-        return;
+        goto end_cnt_update;
     }
                                                                 /* Init buf desc.                                       */
     p_buf_desc->BufLen = xfer_len;
@@ -2302,7 +2476,7 @@ static  void  USBD_Audio_PlaybackIsocCmpl (CPU_INT08U   dev_nbr,
             USBD_AUDIO_STAT_PROT_INC(p_as_if_settings->StatPtr->AudioProc_NbrStreamClosed);
 
             USBD_DBG_AUDIO_PROC_MSG("IsocPlaybackCmpl(): playback not started\r\n");
-            return;
+            goto end_cnt_update;
         }
 #if (USBD_AUDIO_CFG_PLAYBACK_CORR_EN == DEF_ENABLED)
                                                                 /* Sample removal/insertion corr is en.                 */
@@ -2316,6 +2490,11 @@ static  void  USBD_Audio_PlaybackIsocCmpl (CPU_INT08U   dev_nbr,
 
         p_as_if_settings->StreamPrimingDone = DEF_YES;
     }
+
+end_cnt_update:
+    CPU_CRITICAL_ENTER();                                       /* See Note #3.                                         */
+    p_as_if_settings->PlaybackIsocRxOngoingCnt += (CPU_INT16S)nbr_xfer_submitted - 1;
+    CPU_CRITICAL_EXIT();
 }
 #endif
 
@@ -2346,7 +2525,14 @@ static  void  USBD_Audio_PlaybackIsocCmpl (CPU_INT08U   dev_nbr,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) This function is called by the Core task when the stream starts and by the Playback
+*                   task to restart the stream, only when no isochronous OUT transfer is in progress. The
+*                   Core task then does not access 'ProducerStartIx' from an isochronous OUT completion.
+*
+*               (2) The buffer at 'ProducerStartIx' is submitted without advancing the index. The Core
+*                   task advances it when the transfer completes (see USBD_Audio_PlaybackIsocCmpl()
+*                   'Note #2'). The transfer is counted before being submitted, as it may complete before
+*                   USBD_IsocRxAsync() returns.
 *********************************************************************************************************
 */
 
@@ -2358,12 +2544,9 @@ static  void  USBD_Audio_PlaybackPrime (USBD_AUDIO_AS_IF  *p_as_if,
     USBD_AUDIO_AS_IF_ALT       *p_as_if_alt      = p_as_if->AS_IF_AltCurPtr;
     USBD_AUDIO_BUF_DESC        *p_buf_desc;
     CPU_INT16U                  ix;
-#if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
     CPU_SR_ALLOC();
-#endif
 
-
-                                                                /* Get a buf desc from the Ring Buf Q.                  */
+                                                                /* Get a buf desc from the Ring Buf Q (see Note #1).    */
     ix = USBD_Audio_AS_IF_RingBufQProducerStartIxGet(p_as_if_settings);
     if (ix == USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX) {
        *p_err = USBD_ERR_FAIL;
@@ -2377,6 +2560,10 @@ static  void  USBD_Audio_PlaybackPrime (USBD_AUDIO_AS_IF  *p_as_if,
         return;
     }
 
+    CPU_CRITICAL_ENTER();                                       /* See Note #2.                                         */
+    p_as_if_settings->PlaybackIsocRxOngoingCnt++;
+    CPU_CRITICAL_EXIT();
+
     USBD_IsocRxAsync(        p_as_if->DevNbr,
                              p_as_if_alt->DataIsocAddr,
                              p_buf_desc->BufPtr,
@@ -2387,13 +2574,13 @@ static  void  USBD_Audio_PlaybackPrime (USBD_AUDIO_AS_IF  *p_as_if,
     if (*p_err != USBD_ERR_NONE) {
         USBD_DBG_AUDIO_PROC_ERR("PlaybackPrime(): isochronous Rx failed w/ err = %d\r\n", *p_err);
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitErr);
+        CPU_CRITICAL_ENTER();
+        p_as_if_settings->PlaybackIsocRxOngoingCnt--;
+        CPU_CRITICAL_EXIT();
         return;
     }
 
-    USBD_Audio_AS_IF_RingBufQIxUpdate(p_as_if_settings, &p_as_if_settings->StreamRingBufQ.ProducerStartIx);
-
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitSuccess);
-    USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitCoreTask);
     USBD_AUDIO_STAT_PROT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxOngoingCnt);
 }
 #endif
@@ -2411,13 +2598,15 @@ static  void  USBD_Audio_PlaybackPrime (USBD_AUDIO_AS_IF  *p_as_if,
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Playback task or Core layer submits buffers as long as there are free buffers available
-*                   and that the transfers can be queued by the USB device driver.
+* Note(s)     : (1) The Core layer submits buffers as long as there are free buffers available and that
+*                   the transfers can be queued by the USB device driver.
 *
 *               (2) The USB device driver can queue isochronous transfers. USBD_ERR_EP_QUEUING is returned
 *                   when there is no room left to queue the current isochronous transfer. In that case,
 *                   another isochronous transfer will be submitted next time an isochronous transfer
-*                   completes or the playback task processes an event.
+*                   completes.
+*
+*               (3) The caller adds the number of submitted transfers to 'PlaybackIsocRxOngoingCnt'.
 *********************************************************************************************************
 */
 
@@ -2484,25 +2673,13 @@ static  void  USBD_Audio_PlaybackUsbBufSubmit (USBD_AUDIO_AS_IF  *p_as_if,
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Ring buffer queue lock protects the index 'ProducerStartIx' from a specific race
-*                   condition which can occur when the Playback task must restart internally.
-*                   The race condition is more likely to happen when priority(core task) > priority
-*                   (playback task). When restarting a stream, the Playback task starts an isochronous
-*                   OUT transfer. Playback task may be preempted by the Core task because the isochronous
-*                   OUT transfer has finished but the Playback task must update 'ProducerStartIx' before
-*                   'ProducerEndIx' checks it. The lock allows the safe update of 'ProducerStartIx' by
-*                   the Playback task.
-*                   When priority(playback task) > priority(core task), the race condition won't happen.
-*                   Stream restart occurs because there are no more ongoing isochronous transfers in the
-*                   USB driver.
-*
-*               (2) USBD_Audio_PlaybackUsbBufSubmit() serves two purposes:
-*
-*                   (a) Restarting the stream if this one was broken because no more isochronous OUT
-*                       transfers stored in the USB device driver
-*
-*                   (b) Simply submitting new USB transfer(s) to the USB driver besides the Core layer
-*                       doing the same in USBD_Audio_PlaybackIsocCmpl().
+* Note(s)     : (1) The stream is broken when no more isochronous OUT transfers are stored in the USB
+*                   device driver, because the ring buffer queue was full when the last transfers
+*                   completed. Once the codec has freed a buffer, the Playback task restarts the stream
+*                   with a single transfer. The Core task submits the following transfers from
+*                   USBD_Audio_PlaybackIsocCmpl(). While transfers are in progress, only the Core task
+*                   submits buffers to the USB device driver (see 'usbd_audio_internal.h  AUDIO
+*                   STREAMING IF  Note #4a').
 *********************************************************************************************************
 */
 
@@ -2512,23 +2689,22 @@ static  void  USBD_Audio_PlaybackBufSubmit (USBD_AUDIO_AS_IF  *p_as_if)
     USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings = p_as_if->AS_IF_SettingsPtr;
     USBD_AUDIO_BUF_DESC        *p_buf_desc;
     CPU_INT16U                  ix;
-    CPU_INT16U                  nbr_xfer_submitted;
+    CPU_INT16S                  isoc_rx_ongoing_cnt;
     USBD_ERR                    err_usbd;
+    CPU_SR_ALLOC();
 
 
                                                                 /* --------------------- USB SIDE --------------------- */
-    USBD_Audio_OS_RingBufQLockAcquire(p_as_if_settings->Ix,     /* See Note #1.                                         */
-                                      USBD_AUDIO_LOCK_TIMEOUT_mS,
-                                     &err_usbd);
-    if (err_usbd != USBD_ERR_NONE) {
-        USBD_DBG_AUDIO_PROC_ERR("PlaybackCodecBufSubmit(): lock acquire failed w/ err = %d\r\n", err_usbd);
-        return;
-    }
-                                                                /* See Note #2.                                         */
-    USBD_Audio_PlaybackUsbBufSubmit(p_as_if, &nbr_xfer_submitted);
-    USBD_AUDIO_STAT_ADD(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitPlaybackTask, nbr_xfer_submitted);
+    CPU_CRITICAL_ENTER();
+    isoc_rx_ongoing_cnt = p_as_if_settings->PlaybackIsocRxOngoingCnt;
+    CPU_CRITICAL_EXIT();
 
-    USBD_Audio_OS_RingBufQLockRelease(p_as_if_settings->Ix);
+    if (isoc_rx_ongoing_cnt == 0) {                             /* Restart stream (see Note #1).                        */
+        USBD_Audio_PlaybackPrime(p_as_if, &err_usbd);
+        if (err_usbd == USBD_ERR_NONE) {
+            USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_Playback_NbrIsocRxSubmitPlaybackTask);
+        }
+    }
                                                                 /* -------------------- CODEC SIDE -------------------- */
                                                                 /* Get a buf desc from the Ring Buf Q.                  */
     ix = USBD_Audio_AS_IF_RingBufQConsumerStartIxGet(p_as_if_settings);
@@ -2735,6 +2911,11 @@ static  void  USBD_Audio_PlaybackCorrExec (USBD_AUDIO_AS_IF     *p_as_if,
 *                       (a) Sample N is moved at N+1
 *                       (b) Sample N is rebuilt and equal to the average of N-1 and N+1
 *                       (c) The packet size is increased of one sample
+*
+*               (7) If USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN is enabled, the sample removal and insertion
+*                   of Notes #4 and #6 are replaced by a resampling of the whole buffer, which spreads the
+*                   one sample difference over all the samples of the buffer instead of concentrating it
+*                   at its end. See USBD_Audio_CorrResample() for more details.
 *********************************************************************************************************
 */
 
@@ -2747,6 +2928,7 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
     USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings = p_as_if->AS_IF_SettingsPtr;
     USBD_AUDIO_AS_IF_ALT       *p_as_if_alt;
     USBD_AUDIO_AS_ALT_CFG      *p_as_cfg;
+#if (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN == DEF_DISABLED)
     CPU_INT08U                 *p_subframe;
     CPU_INT08U                 *p_frame;
     CPU_INT08U                 *p_buf_end;
@@ -2754,22 +2936,20 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
     CPU_INT08U                 *p_frame_n;
     CPU_INT08U                 *p_frame_n_m1;
     CPU_INT08U                 *p_frame_n_m2;
-    CPU_INT32S                  buf_diff;
-    CPU_INT08U                  subframe_len;
-    CPU_INT08U                  frame_len;
-    CPU_INT16U                  buf_len_min;
     CPU_INT08U                  ch_ix;
     CPU_INT08U                  i;
     CPU_INT32S                  sample_val;
     CPU_INT64S                  sum;
     CPU_INT32S                  average;
+#endif
+    CPU_INT32S                  buf_diff;
+    CPU_INT08U                  subframe_len;
+    CPU_INT08U                  frame_len;
+    CPU_INT16U                  buf_len_min;
     CPU_INT16U                  new_buf_len;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
     buf_diff = USBD_Audio_BufDiffGet(p_as_if_settings);         /* Get cur buf diff between USB & codec.                */
-    CPU_CRITICAL_EXIT();
 
                                                                 /* If safe zone, no correction applies (see Note #2).   */
     if ((buf_diff > p_as_if_settings->CorrBoundaryHeavyNeg) &&
@@ -2786,7 +2966,7 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
     subframe_len = p_as_cfg->SubframeSize;
     frame_len    = p_as_cfg->NbrCh * subframe_len;
                                                                 /* Check if enough samples in buf to apply corr.        */
-    buf_len_min  = USBD_AUDIO_PLAYBACK_CORR_MIN_NBR_SAMPLES * frame_len;
+    buf_len_min  = USBD_AUDIO_CORR_MIN_NBR_SAMPLES * frame_len;
     if (p_buf_desc->BufLen < buf_len_min) {
        *p_err = USBD_ERR_FAIL;
         return;
@@ -2808,7 +2988,16 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
             p_buf_desc->BufLen = new_buf_len;                   /* Buf size has been reduced of X samples by app...     */
                                                                 /* ...corr algorithm.                                   */
 
-        } else {                                                /* See Note #4.                                         */
+        } else {
+#if (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN == DEF_ENABLED)
+                                                                /* Resample buf with one less frame (see Note #7).      */
+            USBD_Audio_CorrResample((CPU_INT08U *)p_buf_desc->BufPtr,
+                                    (CPU_INT16U  )(p_buf_desc->BufLen / frame_len),
+                                                  DEF_NO,
+                                                  p_as_cfg);
+
+            p_buf_desc->BufLen -= frame_len;                    /* The packet size is reduced by one sample.            */
+#else                                                           /* See Note #4.                                         */
                                                                 /* Get ptr to different audio frames within buf.        */
             p_buf_end    = ((CPU_INT08U *)p_buf_desc->BufPtr) + p_buf_desc->BufLen;
             p_frame_n    =   p_buf_end    - frame_len;
@@ -2849,6 +3038,7 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
             Mem_Copy(p_frame_n_m1, p_frame_n, frame_len);       /* Sample N is moved at N-1.                            */
 
             p_buf_desc->BufLen -= frame_len;                    /* The packet size is reduced by one sample.            */
+#endif
         }
 
     } else {                                                    /* ------------- UNDERRUN: INSERT SAMPLE -------------- */
@@ -2867,7 +3057,16 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
             p_buf_desc->BufLen = new_buf_len;                   /* Buf size has been increased of X samples by app...   */
                                                                 /* ...corr algorithm.                                   */
 
-        } else {                                                /* See Note #6.                                         */
+        } else {
+#if (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN == DEF_ENABLED)
+                                                                /* Resample buf with one more frame (see Note #7).      */
+            USBD_Audio_CorrResample((CPU_INT08U *)p_buf_desc->BufPtr,
+                                    (CPU_INT16U  )(p_buf_desc->BufLen / frame_len),
+                                                  DEF_YES,
+                                                  p_as_cfg);
+
+            p_buf_desc->BufLen += frame_len;                    /* The packet size is increased by one sample.          */
+#else                                                           /* See Note #6.                                         */
                                                                 /* Get ptr to different frames within playback buf.     */
             p_buf_end    = ((CPU_INT08U *)p_buf_desc->BufPtr) + p_buf_desc->BufLen;
             p_frame_n_p1 =   p_buf_end;
@@ -2911,6 +3110,7 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
             }
 
             p_buf_desc->BufLen += frame_len;                    /* The packet size is increased by one sample.          */
+#endif
         }
     }
 
@@ -2919,6 +3119,578 @@ static  void  USBD_Audio_PlaybackCorrBuiltIn (USBD_AUDIO_AS_IF     *p_as_if,
 #endif
 
 
+/*
+*********************************************************************************************************
+*                                      USBD_Audio_CorrResample()
+*
+* Description : Resample an audio buffer to add or remove one audio frame (see Note #1).
+*
+* Argument(s) : p_buf           Pointer to audio buffer.
+*
+*               nbr_frame       Number of audio frames in buffer.
+*
+*               insert          Indicates whether an audio frame is added or removed :
+*
+*                                   DEF_YES     Add    an audio frame.
+*                                   DEF_NO      Remove an audio frame.
+*
+*               p_as_cfg        Pointer to AudioStreaming interface configuration.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The 'nbr_frame' input frames are replaced by 'nbr_frame' + 1 or 'nbr_frame' - 1 output
+*                   frames spanning the same interval. Output frame j takes the value of the input signal
+*                   at position j * (nbr_frame - 1) / (nbr_out - 1), interpolated with a Catmull-Rom cubic
+*                   spline through the four nearest input frames. The first and last frames are kept, so
+*                   that the buffer joins the previous and next buffers without discontinuity, and the
+*                   one frame difference is spread over the whole buffer as a small, steady pitch change.
+*
+*               (2) The buffer is resampled in place, USBD_AUDIO_CORR_NBR_LANE logical channels at a time.
+*                   Each input frame is read before its location is overwritten :
+*
+*                   (a) When removing a frame, output positions are ahead of or at the input positions, so
+*                       the buffer is processed from the start.
+*
+*                   (b) When adding a frame, output positions are behind or at the input positions, so the
+*                       buffer is processed from the end.
+*
+*                   The four input frames around the current position are kept in a sliding window, as
+*                   the frame preceding (or following) the current position may already be overwritten.
+*                   The window is a ring indexed from 'win_ix', so that sliding it moves no sample.
+*
+*               (3) The position is a fixed-point number with USBD_AUDIO_CORR_FRAC_NBR_BITS fractional bits.
+*                   The spline weights only depend on the position, so they are applied to all the
+*                   logical channels processed together.
+*
+*               (4) The caller ensures the buffer holds at least USBD_AUDIO_CORR_MIN_NBR_SAMPLES frames, and
+*                   can hold one more frame when one is added.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void  USBD_Audio_CorrResample (CPU_INT08U             *p_buf,
+                                       CPU_INT16U              nbr_frame,
+                                       CPU_BOOLEAN             insert,
+                                       USBD_AUDIO_AS_ALT_CFG  *p_as_cfg)
+{
+    CPU_INT08U  *p_ch;
+    CPU_INT08U   subframe_len;
+    CPU_INT08U   bit_res;
+    CPU_INT08U   nbr_lane;
+    CPU_INT08U   win_ix;
+    CPU_INT08U   ch_ix;
+    CPU_INT16U   frame_len;
+    CPU_INT16U   nbr_out;
+    CPU_INT16U   last_in;
+    CPU_INT16U   last_out;
+    CPU_INT16U   ix_out;
+    CPU_INT16U   ix_win;
+    CPU_INT16U   ix_in;
+    CPU_INT32U   step;
+    CPU_INT32U   pos;
+    CPU_INT32S   sample_min;
+    CPU_INT32S   sample_max;
+    CPU_INT32S   val[USBD_AUDIO_CORR_NBR_LANE];
+    CPU_INT32S   win[4u][USBD_AUDIO_CORR_NBR_LANE];
+
+
+    subframe_len = p_as_cfg->SubframeSize;
+    bit_res      = p_as_cfg->BitRes;
+    frame_len    = p_as_cfg->NbrCh * subframe_len;
+    nbr_out      = (insert == DEF_YES) ? (nbr_frame + 1u) : (nbr_frame - 1u);
+    last_in      =  nbr_frame - 1u;
+    last_out     =  nbr_out   - 1u;
+                                                                /* Input frames per output frame (see Note #3).         */
+    step         = ((CPU_INT32U)last_in << USBD_AUDIO_CORR_FRAC_NBR_BITS) / last_out;
+
+    switch (subframe_len) {                                     /* Sample range.                                        */
+        case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_1:             /* Unsigned PCM8.                                       */
+             sample_min = 0;
+             sample_max = DEF_INT_08U_MAX_VAL;
+             break;
+
+        case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+        case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+             sample_max =  (CPU_INT32S)((1uL << (bit_res - 1u)) - 1u);
+             sample_min = -sample_max - 1;
+             break;
+
+        case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+        default:
+             sample_min = DEF_INT_32S_MIN_VAL;
+             sample_max = DEF_INT_32S_MAX_VAL;
+             break;
+    }
+
+    for (ch_ix = 0u; ch_ix < p_as_cfg->NbrCh; ch_ix += nbr_lane) {
+        nbr_lane = (CPU_INT08U)DEF_MIN(p_as_cfg->NbrCh - ch_ix, USBD_AUDIO_CORR_NBR_LANE);
+        p_ch     =  p_buf + (subframe_len * ch_ix);             /* Point to first ch subframe in first frame.           */
+        win_ix   =  0u;
+
+        if (insert == DEF_NO) {                                 /* ------------- REMOVE FRAME (see Note #2a) ---------- */
+                                                                /* Win holds input frames ix_win - 1 to ix_win + 2.     */
+            ix_win = 0u;
+            USBD_Audio_CorrFrameRd(p_ch,                    nbr_lane, subframe_len, bit_res, win[0u]);
+            Mem_Copy(win[1u], win[0u], sizeof(win[0u]));
+            USBD_Audio_CorrFrameRd(p_ch +      frame_len,  nbr_lane, subframe_len, bit_res, win[2u]);
+            USBD_Audio_CorrFrameRd(p_ch + (2u * frame_len), nbr_lane, subframe_len, bit_res, win[3u]);
+
+            for (ix_out = 1u; ix_out < last_out; ix_out++) {    /* First output frame is unchanged.                     */
+                pos   = (CPU_INT32U)ix_out * step;
+                ix_in = (CPU_INT16U)(pos >> USBD_AUDIO_CORR_FRAC_NBR_BITS);
+                while (ix_win < ix_in) {                        /* Slide win forward.                                   */
+                    ix_win++;
+                    win_ix = (win_ix + 1u) % 4u;
+                    if ((ix_win + 2u) <= last_in) {
+                        USBD_Audio_CorrFrameRd(p_ch + ((CPU_SIZE_T)(ix_win + 2u) * frame_len),
+                                               nbr_lane,
+                                               subframe_len,
+                                               bit_res,
+                                               win[(win_ix + 3u) % 4u]);
+                    } else {                                    /* Repeat last input frame past buf end.                */
+                        Mem_Copy(win[(win_ix + 3u) % 4u], win[(win_ix + 2u) % 4u], sizeof(win[0u]));
+                    }
+                }
+
+                USBD_Audio_CorrInterpolate(win,
+                                           win_ix,
+                                           nbr_lane,
+                                           pos & USBD_AUDIO_CORR_FRAC_MASK,
+                                           val,
+                                           sample_min,
+                                           sample_max);
+                USBD_Audio_CorrFrameWr(p_ch + ((CPU_SIZE_T)ix_out * frame_len), val, nbr_lane, subframe_len);
+            }
+                                                                /* Last output frame is last input frame.               */
+            Mem_Copy(p_ch + ((CPU_SIZE_T)last_out * frame_len),
+                     p_ch + ((CPU_SIZE_T)last_in  * frame_len),
+                     subframe_len * nbr_lane);
+
+        } else {                                                /* -------------- ADD FRAME (see Note #2b) ------------ */
+            ix_win = last_in;
+            USBD_Audio_CorrFrameRd(p_ch + ((CPU_SIZE_T)(last_in - 1u) * frame_len),
+                                   nbr_lane,
+                                   subframe_len,
+                                   bit_res,
+                                   win[0u]);
+            USBD_Audio_CorrFrameRd(p_ch + ((CPU_SIZE_T) last_in       * frame_len),
+                                   nbr_lane,
+                                   subframe_len,
+                                   bit_res,
+                                   win[1u]);
+            Mem_Copy(win[2u], win[1u], sizeof(win[0u]));
+            Mem_Copy(win[3u], win[1u], sizeof(win[0u]));
+                                                                /* Last output frame is last input frame.               */
+            Mem_Copy(p_ch + ((CPU_SIZE_T)last_out * frame_len),
+                     p_ch + ((CPU_SIZE_T)last_in  * frame_len),
+                     subframe_len * nbr_lane);
+
+            for (ix_out = last_out - 1u; ix_out > 0u; ix_out--) {
+                pos   = (CPU_INT32U)ix_out * step;
+                ix_in = (CPU_INT16U)(pos >> USBD_AUDIO_CORR_FRAC_NBR_BITS);
+                while (ix_win > ix_in) {                        /* Slide win backward.                                  */
+                    ix_win--;
+                    win_ix = (win_ix + 3u) % 4u;
+                    if (ix_win > 0u) {
+                        USBD_Audio_CorrFrameRd(p_ch + ((CPU_SIZE_T)(ix_win - 1u) * frame_len),
+                                               nbr_lane,
+                                               subframe_len,
+                                               bit_res,
+                                               win[win_ix]);
+                    } else {                                    /* Repeat first input frame before buf start.           */
+                        Mem_Copy(win[win_ix], win[(win_ix + 1u) % 4u], sizeof(win[0u]));
+                    }
+                }
+
+                USBD_Audio_CorrInterpolate(win,
+                                           win_ix,
+                                           nbr_lane,
+                                           pos & USBD_AUDIO_CORR_FRAC_MASK,
+                                           val,
+                                           sample_min,
+                                           sample_max);
+                USBD_Audio_CorrFrameWr(p_ch + ((CPU_SIZE_T)ix_out * frame_len), val, nbr_lane, subframe_len);
+            }                                                   /* First output frame is unchanged.                     */
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_Audio_CorrInterpolate()
+*
+* Description : Interpolate up to USBD_AUDIO_CORR_NBR_LANE logical channels with a Catmull-Rom cubic spline.
+*
+* Argument(s) : win         Window of four consecutive frames, as a ring starting at 'win_ix'.
+*
+*               win_ix      Index of the first frame of the window.
+*
+*               nbr_lane    Number of logical channels to interpolate.
+*
+*               frac        Position between the second and third frames of the window, with
+*                           USBD_AUDIO_CORR_FRAC_NBR_BITS fractional bits.
+*
+*               p_val       Pointer to array that will receive the interpolated samples.
+*
+*               sample_min  Minimum sample value.
+*
+*               sample_max  Maximum sample value.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) With t the position, the weights of the four samples are :
+*
+*                       w0 = (-t^3 + 2 * t^2 - t) / 2       w2 = (-3 * t^3 + 4 * t^2 + t) / 2
+*                       w1 = ( 3 * t^3 - 5 * t^2 + 2) / 2   w3 = (t^3 - t^2) / 2
+*
+*                   The weights have USBD_AUDIO_CORR_FRAC_NBR_BITS fractional bits. w1 is computed as
+*                   1 - w0 - w2 - w3, so that the weights sum to exactly one and a constant signal is
+*                   left unchanged. At t = 0, the result is the second sample.
+*
+*               (2) Each result is the weighted sum of the four samples, rounded to the nearest integer
+*                   and saturated to the sample range, as the cubic spline may overshoot. The weighted
+*                   sum of 32-bit samples needs up to 50 bits. All implementations return the same
+*                   results :
+*
+*                   (a) The portable implementation sums in 64-bit integers, and rounds down explicitly
+*                       as the division of a negative integer rounds toward zero.
+*
+*                   (b) The SSE4.1 implementation sums in double precision floating-point, two logical
+*                       channels per instruction. The sum and all its terms are integers of less than 53
+*                       bits, so they are exact.
+*
+*                   (c) The NEON implementation sums in 64-bit integers, two logical channels per
+*                       instruction, and narrows with saturation.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void  USBD_Audio_CorrInterpolate (CPU_INT32S   win[][USBD_AUDIO_CORR_NBR_LANE],
+                                          CPU_INT08U   win_ix,
+                                          CPU_INT08U   nbr_lane,
+                                          CPU_INT32U   frac,
+                                          CPU_INT32S  *p_val,
+                                          CPU_INT32S   sample_min,
+                                          CPU_INT32S   sample_max)
+{
+    CPU_INT32S  weight[4u];
+    CPU_INT32S  t;
+    CPU_INT32S  t2;
+    CPU_INT32S  t3;
+    CPU_INT08U  lane;
+    CPU_INT08U  tap;
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)
+    __m128d     w[4u];
+    __m128d     acc;
+    __m128d     x;
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)
+    int64x2_t   acc;
+    int32x2_t   res;
+#else
+    CPU_INT64S  acc;
+#endif
+
+                                                                /* ------------- SPLINE WEIGHTS (see Note #1) --------- */
+    t         =  (CPU_INT32S)frac;
+    t2        =  (CPU_INT32S)((frac * frac)           >> USBD_AUDIO_CORR_FRAC_NBR_BITS);
+    t3        =  (CPU_INT32S)(((CPU_INT32U)t2 * frac) >> USBD_AUDIO_CORR_FRAC_NBR_BITS);
+
+    weight[0] = ((2 * t2) - t3 - t)        / 2;
+    weight[2] = ((4 * t2) + t  - (3 * t3)) / 2;
+    weight[3] = (t3 - t2)                  / 2;
+    weight[1] =  USBD_AUDIO_CORR_FRAC_ONE - weight[0] - weight[2] - weight[3];
+
+                                                                /* ------------ WEIGHTED SUM (see Note #2) ------------ */
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)                 /* See Note #2b.                                        */
+    for (tap = 0u; tap < 4u; tap++) {
+        w[tap] = _mm_set1_pd((double)weight[tap]);
+    }
+
+    for (lane = 0u; lane < nbr_lane; lane += 2u) {
+        acc = _mm_set1_pd((double)(USBD_AUDIO_CORR_FRAC_ONE / 2));
+        for (tap = 0u; tap < 4u; tap++) {
+            x   = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)&win[(win_ix + tap) % 4u][lane]));
+            acc = _mm_add_pd(acc, _mm_mul_pd(x, w[tap]));
+        }
+        acc = _mm_floor_pd(_mm_mul_pd(acc, _mm_set1_pd(1.0 / USBD_AUDIO_CORR_FRAC_ONE)));
+        acc = _mm_max_pd(acc, _mm_set1_pd((double)sample_min));
+        acc = _mm_min_pd(acc, _mm_set1_pd((double)sample_max));
+        _mm_storel_epi64((__m128i *)&p_val[lane], _mm_cvtpd_epi32(acc));
+    }
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)                 /* See Note #2c.                                        */
+    for (lane = 0u; lane < nbr_lane; lane += 2u) {
+        acc = vdupq_n_s64(USBD_AUDIO_CORR_FRAC_ONE / 2);
+        for (tap = 0u; tap < 4u; tap++) {
+            acc = vmlal_n_s32(acc, vld1_s32(&win[(win_ix + tap) % 4u][lane]), weight[tap]);
+        }
+        res = vqmovn_s64(vshrq_n_s64(acc, USBD_AUDIO_CORR_FRAC_NBR_BITS));
+        res = vmax_s32(res, vdup_n_s32(sample_min));
+        res = vmin_s32(res, vdup_n_s32(sample_max));
+        vst1_s32(&p_val[lane], res);
+    }
+#else                                                           /* See Note #2a.                                        */
+    for (lane = 0u; lane < nbr_lane; lane++) {
+        acc = USBD_AUDIO_CORR_FRAC_ONE / 2;
+        for (tap = 0u; tap < 4u; tap++) {
+            acc += (CPU_INT64S)weight[tap] * win[(win_ix + tap) % 4u][lane];
+        }
+        if (acc >= 0) {
+            acc =    acc / USBD_AUDIO_CORR_FRAC_ONE;
+        } else {
+            acc = -((-acc + (USBD_AUDIO_CORR_FRAC_ONE - 1)) / USBD_AUDIO_CORR_FRAC_ONE);
+        }
+
+        if (acc < sample_min) {
+            acc = sample_min;
+        } else if (acc > sample_max) {
+            acc = sample_max;
+        } else {
+            ;
+        }
+        p_val[lane] = (CPU_INT32S)acc;
+    }
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Audio_CorrFrameRd()
+*
+* Description : Read the PCM audio samples of up to USBD_AUDIO_CORR_NBR_LANE logical channels of a frame.
+*
+* Argument(s) : p_subframe      Pointer to first subframe.
+*
+*               nbr_lane        Number of consecutive subframes to read.
+*
+*               subframe_len    Subframe length, in octets.
+*
+*               bit_res         Sample resolution, in bits.
+*
+*               p_val           Pointer to array that will receive the samples. Samples past 'nbr_lane' are
+*                               set to zero.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Audio data is little-endian. As in the averaging correction, 2- and 3-octet samples
+*                   are sign-extended from bit 'bit_res' - 1. 1-octet samples (PCM8) are unsigned.
+*
+*               (2) Four 2-, 3- or 4-octet subframes are read and sign-extended by SIMD instructions when
+*                   the samples fill their subframes. No octet past the last subframe is read.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void  USBD_Audio_CorrFrameRd (const  CPU_INT08U  *p_subframe,
+                                             CPU_INT08U   nbr_lane,
+                                             CPU_INT08U   subframe_len,
+                                             CPU_INT08U   bit_res,
+                                             CPU_INT32S  *p_val)
+{
+    CPU_INT32U  val;
+    CPU_INT08U  lane;
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)
+    __m128i     x;
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)
+    uint8x16_t  x;
+#endif
+
+
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)                 /* See Note #2.                                         */
+    if ((nbr_lane == USBD_AUDIO_CORR_NBR_LANE) &&
+        ((subframe_len == USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4) ||
+         (bit_res      == (subframe_len * DEF_OCTET_NBR_BITS)))) {
+        switch (subframe_len) {
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+                 x = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)p_subframe));
+                 _mm_storeu_si128((__m128i *)p_val, x);
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+                 x = _mm_loadl_epi64((const __m128i *)p_subframe);
+                 x = _mm_insert_epi32(x, (int)MEM_VAL_GET_INT32U_LITTLE(p_subframe + 8u), 2);
+                 x = _mm_shuffle_epi8(x, _mm_setr_epi8(-1, 0, 1,  2, -1, 3,  4,  5, -1, 6, 7, 8, -1, 9, 10, 11));
+                 _mm_storeu_si128((__m128i *)p_val, _mm_srai_epi32(x, 8));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+                 _mm_storeu_si128((__m128i *)p_val, _mm_loadu_si128((const __m128i *)p_subframe));
+                 return;
+
+            default:
+                 break;
+        }
+    }
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)                 /* See Note #2.                                         */
+    if ((nbr_lane == USBD_AUDIO_CORR_NBR_LANE) &&
+        ((subframe_len == USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4) ||
+         (bit_res      == (subframe_len * DEF_OCTET_NBR_BITS)))) {
+        switch (subframe_len) {
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+                 vst1q_s32(p_val, vmovl_s16(vreinterpret_s16_u8(vld1_u8(p_subframe))));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+                 x = vcombine_u8(vld1_u8(p_subframe),
+                                 vcreate_u8((CPU_INT64U)MEM_VAL_GET_INT32U_LITTLE(p_subframe + 8u)));
+                 x = vqtbl1q_u8(x, vld1q_u8(USBD_Audio_CorrSample24UnpackTbl));
+                 vst1q_s32(p_val, vshrq_n_s32(vreinterpretq_s32_u8(x), 8));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+                 vst1q_s32(p_val, vreinterpretq_s32_u8(vld1q_u8(p_subframe)));
+                 return;
+
+            default:
+                 break;
+        }
+    }
+#endif
+
+    for (lane = 0u; lane < USBD_AUDIO_CORR_NBR_LANE; lane++) {
+        if (lane >= nbr_lane) {
+            p_val[lane] = 0;
+            continue;
+        }
+
+        switch (subframe_len) {
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_1:
+                 val = (CPU_INT32U)p_subframe[0];
+                 break;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+                 val = (CPU_INT32U) p_subframe[0] |
+                      ((CPU_INT32U)p_subframe[1] << 8u);
+                 break;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+                 val = (CPU_INT32U) p_subframe[0]         |
+                      ((CPU_INT32U)p_subframe[1] <<  8u) |
+                      ((CPU_INT32U)p_subframe[2] << 16u);
+                 break;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+            default:
+                 val = (CPU_INT32U) p_subframe[0]         |
+                      ((CPU_INT32U)p_subframe[1] <<  8u) |
+                      ((CPU_INT32U)p_subframe[2] << 16u) |
+                      ((CPU_INT32U)p_subframe[3] << 24u);
+                 break;
+        }
+                                                                /* See Note #1.                                         */
+        if (((subframe_len == USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2)  ||
+             (subframe_len == USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3)) &&
+            (DEF_BIT_IS_SET(val, DEF_BIT(bit_res - 1u)) == DEF_YES)) {
+            val |= DEF_BIT_FIELD_32((32u - bit_res), bit_res);
+        }
+
+        p_val[lane]  = (CPU_INT32S)val;
+        p_subframe  += subframe_len;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Audio_CorrFrameWr()
+*
+* Description : Write the PCM audio samples of up to USBD_AUDIO_CORR_NBR_LANE logical channels of a frame.
+*
+* Argument(s) : p_subframe      Pointer to first subframe.
+*
+*               p_val           Pointer to samples, already saturated to the sample range.
+*
+*               nbr_lane        Number of consecutive subframes to write.
+*
+*               subframe_len    Subframe length, in octets.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Audio data is little-endian.
+*
+*               (2) Four 2-, 3- or 4-octet subframes are written by SIMD instructions. No octet past the
+*                   last subframe is written.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CORR_RESAMPLE_EN == DEF_ENABLED)
+static  void  USBD_Audio_CorrFrameWr (       CPU_INT08U  *p_subframe,
+                                      const  CPU_INT32S  *p_val,
+                                             CPU_INT08U   nbr_lane,
+                                             CPU_INT08U   subframe_len)
+{
+    CPU_INT32U  sample;
+    CPU_INT08U  lane;
+    CPU_INT08U  i;
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)
+    __m128i     x;
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)
+    uint8x16_t  x;
+#endif
+
+
+#if   (USBD_AUDIO_CORR_SSE41_EN == DEF_ENABLED)                 /* See Note #2.                                         */
+    if (nbr_lane == USBD_AUDIO_CORR_NBR_LANE) {
+        x = _mm_loadu_si128((const __m128i *)p_val);
+        switch (subframe_len) {
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+                 _mm_storel_epi64((__m128i *)p_subframe, _mm_packs_epi32(x, x));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+                 x = _mm_shuffle_epi8(x, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+                 _mm_storel_epi64((__m128i *)p_subframe, x);
+                 MEM_VAL_SET_INT32U_LITTLE(p_subframe + 8u, (CPU_INT32U)_mm_extract_epi32(x, 2));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+                 _mm_storeu_si128((__m128i *)p_subframe, x);
+                 return;
+
+            default:
+                 break;
+        }
+    }
+#elif (USBD_AUDIO_CORR_NEON_EN  == DEF_ENABLED)                 /* See Note #2.                                         */
+    if (nbr_lane == USBD_AUDIO_CORR_NBR_LANE) {
+        x = vreinterpretq_u8_s32(vld1q_s32(p_val));
+        switch (subframe_len) {
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2:
+                 vst1_u8(p_subframe, vreinterpret_u8_s16(vmovn_s32(vreinterpretq_s32_u8(x))));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3:
+                 x = vqtbl1q_u8(x, vld1q_u8(USBD_Audio_CorrSample24PackTbl));
+                 vst1_u8(p_subframe, vget_low_u8(x));
+                 MEM_VAL_SET_INT32U_LITTLE(p_subframe + 8u, vgetq_lane_u32(vreinterpretq_u32_u8(x), 2));
+                 return;
+
+            case USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4:
+                 vst1q_u8(p_subframe, x);
+                 return;
+
+            default:
+                 break;
+        }
+    }
+#endif
+
+    for (lane = 0u; lane < nbr_lane; lane++) {
+        sample = (CPU_INT32U)p_val[lane];
+        for (i = 0u; i < subframe_len; i++) {                   /* See Note #1.                                         */
+            p_subframe[i]   = (CPU_INT08U)sample;
+            sample        >>= 8u;
+        }
+        p_subframe += subframe_len;
+    }
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                 USBD_Audio_PlaybackCorrSynchInit()
@@ -3179,7 +3951,6 @@ static  void  USBD_Audio_PlaybackCorrSynch (USBD_AUDIO_AS_IF  *p_as_if,
     USBD_DEV_SPD                spd;
     CPU_INT08U                  feedback_val_bit_shift;
     CPU_INT08U                  feedback_len;
-    CPU_SR_ALLOC();
 
 
    *p_err = USBD_ERR_NONE;
@@ -3188,9 +3959,7 @@ static  void  USBD_Audio_PlaybackCorrSynch (USBD_AUDIO_AS_IF  *p_as_if,
     p_as_if_alt      = p_as_if->AS_IF_AltCurPtr;
 
 
-    CPU_CRITICAL_ENTER();
     buf_diff = USBD_Audio_BufDiffGet(p_as_if_settings);         /* Get cur buf diff between USB & codec.                */
-    CPU_CRITICAL_EXIT();
     prev_buf_diff  = p_as_if_settings->PlaybackSynch.PrevBufDiff;
     prev_frame_nbr = p_as_if_settings->PlaybackSynch.PrevFrameNbr;
     frame_nbr_diff = USBD_FRAME_NBR_DIFF_GET(prev_frame_nbr, frame_nbr);
@@ -5070,7 +5839,7 @@ static  USBD_AUDIO_BUF_DESC  *USBD_Audio_AS_IF_RingBufQGet (USBD_AUDIO_AS_IF_RIN
 *
 * Return(s)   : Current Producer Start index.
 *
-* Note(s)     : none.
+* Note(s)     : (1) See 'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4'.
 *********************************************************************************************************
 */
 
@@ -5079,28 +5848,24 @@ static  USBD_AUDIO_BUF_DESC  *USBD_Audio_AS_IF_RingBufQGet (USBD_AUDIO_AS_IF_RIN
 static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQProducerStartIxGet (USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings)
 {
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q = &p_as_if_settings->StreamRingBufQ;
+    CPU_INT16U                    cur_ix;
     CPU_INT16U                    nxt_ix;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
-    nxt_ix = p_ring_buf_q->ProducerStartIx + 1;
-    if (nxt_ix == p_as_if_settings->BufTotalNbr) {
-        nxt_ix = 0u;
-    }
+    cur_ix = p_ring_buf_q->ProducerStartIx;
+    nxt_ix = USBD_Audio_AS_IF_RingBufQIxNext(p_as_if_settings, cur_ix);
 
     if ((nxt_ix == p_ring_buf_q->ConsumerEndIx) ||
         (nxt_ix == p_ring_buf_q->ProducerEndIx)) {
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerStartIxCatchUp);
-        CPU_CRITICAL_EXIT();
         return (USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX);
     }
-    CPU_CRITICAL_EXIT();
+    USBD_AUDIO_RING_BUF_Q_ACQUIRE();                            /* Order buf desc accesses after ix rd (see Note #1).   */
 
     USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrBufDescInUse);
 
-    return (p_ring_buf_q->ProducerStartIx);
+    return (cur_ix);
 }
 #endif
 
@@ -5115,7 +5880,7 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQProducerStartIxGet (USBD_AUDIO_AS_I
 *
 * Return(s)   : Current Producer End index.
 *
-* Note(s)     : none.
+* Note(s)     : (1) See 'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4'.
 *********************************************************************************************************
 */
 
@@ -5126,24 +5891,18 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQProducerEndIxGet (USBD_AUDIO_AS_IF_
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q = &p_as_if_settings->StreamRingBufQ;
     CPU_INT16U                    cur_ix;
     CPU_INT16U                    nxt_ix;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
     cur_ix = p_ring_buf_q->ProducerEndIx;
-    nxt_ix = p_ring_buf_q->ProducerEndIx + 1;
-    if (nxt_ix == p_as_if_settings->BufTotalNbr) {
-        nxt_ix = 0u;
-    }
+    nxt_ix = USBD_Audio_AS_IF_RingBufQIxNext(p_as_if_settings, cur_ix);
 
     if ((cur_ix == p_ring_buf_q->ProducerStartIx) ||
         (nxt_ix == p_ring_buf_q->ConsumerStartIx)) {
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerEndIxCatchUp);
-        CPU_CRITICAL_EXIT();
         return (USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX);
     }
-    CPU_CRITICAL_EXIT();
+    USBD_AUDIO_RING_BUF_Q_ACQUIRE();                            /* Order buf desc accesses after ix rd (see Note #1).   */
 
     return (cur_ix);
 }
@@ -5160,7 +5919,7 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQProducerEndIxGet (USBD_AUDIO_AS_IF_
 *
 * Return(s)   : Current Consumer Start index.
 *
-* Note(s)     : none.
+* Note(s)     : (1) See 'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4'.
 *********************************************************************************************************
 */
 
@@ -5171,23 +5930,17 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQConsumerStartIxGet (USBD_AUDIO_AS_I
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q = &p_as_if_settings->StreamRingBufQ;
     CPU_INT16U                    cur_ix;
     CPU_INT16U                    nxt_ix;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
     cur_ix = p_ring_buf_q->ConsumerStartIx;
-    nxt_ix = p_ring_buf_q->ConsumerStartIx + 1;
-    if (nxt_ix == p_as_if_settings->BufTotalNbr) {
-        nxt_ix = 0u;
-    }
+    nxt_ix = USBD_Audio_AS_IF_RingBufQIxNext(p_as_if_settings, cur_ix);
 
     if ((cur_ix == p_ring_buf_q->ProducerEndIx) ||
         (nxt_ix == p_ring_buf_q->ConsumerEndIx)) {
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerStartIxCatchUp);
-        CPU_CRITICAL_EXIT();
         return (USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX);
     }
-    CPU_CRITICAL_EXIT();
+    USBD_AUDIO_RING_BUF_Q_ACQUIRE();                            /* Order buf desc accesses after ix rd (see Note #1).   */
 
     return (cur_ix);
 }
@@ -5204,7 +5957,7 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQConsumerStartIxGet (USBD_AUDIO_AS_I
 *
 * Return(s)   : Current Consumer End index.
 *
-* Note(s)     : none.
+* Note(s)     : (1) See 'usbd_audio_internal.h  AUDIO STREAMING IF  Note #4'.
 *********************************************************************************************************
 */
 
@@ -5215,24 +5968,18 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQConsumerEndIxGet (USBD_AUDIO_AS_IF_
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q     = &p_as_if_settings->StreamRingBufQ;
     CPU_INT16U                    cur_ix;
     CPU_INT16U                    nxt_ix;
-    CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
     cur_ix = p_ring_buf_q->ConsumerEndIx;
-    nxt_ix = p_ring_buf_q->ConsumerEndIx + 1;
-    if (nxt_ix == p_as_if_settings->BufTotalNbr) {
-        nxt_ix = 0u;
-    }
+    nxt_ix = USBD_Audio_AS_IF_RingBufQIxNext(p_as_if_settings, cur_ix);
 
     if ((cur_ix == p_ring_buf_q->ConsumerStartIx) ||
         (nxt_ix == p_ring_buf_q->ProducerStartIx)) {
 
         USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerEndIxCatchUp);
-        CPU_CRITICAL_EXIT();
         return (USBD_AUDIO_AS_IF_RING_BUF_Q_INVALID_IX);
     }
-    CPU_CRITICAL_EXIT();
+    USBD_AUDIO_RING_BUF_Q_ACQUIRE();                            /* Order buf desc accesses after ix rd (see Note #1).   */
 
     USBD_AUDIO_STAT_DEC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrBufDescInUse);
 
@@ -5253,38 +6000,73 @@ static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQConsumerEndIxGet (USBD_AUDIO_AS_IF_
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The buffer descriptor accesses made through the current index are completed before
+*                   the index is published. The new index is written with a single store, so that other
+*                   contexts never see an intermediate value. See 'usbd_audio_internal.h  AUDIO STREAMING
+*                   IF  Note #4'.
 *********************************************************************************************************
 */
 
 #if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
     (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
-static  void  USBD_Audio_AS_IF_RingBufQIxUpdate (USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings,
-                                                 CPU_INT16U                 *p_ix)
+static  void  USBD_Audio_AS_IF_RingBufQIxUpdate (          USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings,
+                                                 volatile  CPU_INT16U                 *p_ix)
 {
 #if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q = &p_as_if_settings->StreamRingBufQ;
 #endif
-    CPU_SR_ALLOC();
+    CPU_INT16U                    nxt_ix;
 
 
-    CPU_CRITICAL_ENTER();
-    (*p_ix)++;                                                  /* Nxt avail ix.                                        */
-    if (*p_ix == p_as_if_settings->BufTotalNbr) {               /* Reset ix if end of ring q reached.                   */
-       *p_ix = 0u;
+    nxt_ix = USBD_Audio_AS_IF_RingBufQIxNext(p_as_if_settings, *p_ix);
+
+    USBD_AUDIO_RING_BUF_Q_RELEASE();                            /* See Note #1.                                         */
+   *p_ix = nxt_ix;                                              /* Nxt avail ix.                                        */
+
 #if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
-       if (p_ix == &p_ring_buf_q->ProducerStartIx) {
-           USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerStartIxWrapAround);
-       } else if (p_ix == &p_ring_buf_q->ProducerEndIx) {
-           USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerEndIxWrapAround);
-       } else if (p_ix == &p_ring_buf_q->ConsumerStartIx) {
-           USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerStartIxWrapAround);
-       } else {
-           USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerEndIxWrapAround);
-       }
+    if (nxt_ix == 0u) {                                         /* End of ring q reached.                               */
+        if (p_ix == &p_ring_buf_q->ProducerStartIx) {
+            USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerStartIxWrapAround);
+        } else if (p_ix == &p_ring_buf_q->ProducerEndIx) {
+            USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrProducerEndIxWrapAround);
+        } else if (p_ix == &p_ring_buf_q->ConsumerStartIx) {
+            USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerStartIxWrapAround);
+        } else {
+            USBD_AUDIO_STAT_INC(p_as_if_settings->StatPtr->AudioProc_RingBufQ_NbrConsumerEndIxWrapAround);
+        }
+    }
+#endif
+}
 #endif
+
+
+/*
+*********************************************************************************************************
+*                                  USBD_Audio_AS_IF_RingBufQIxNext()
+*
+* Description : Get the index following the given index in the ring buffer queue.
+*
+* Argument(s) : p_as_if_settings    Pointer to AudioStreaming interface settings.
+*
+*               ix                  Index.
+*
+* Return(s)   : Next index.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_AUDIO_CFG_PLAYBACK_EN == DEF_ENABLED) || \
+    (USBD_AUDIO_CFG_RECORD_EN   == DEF_ENABLED)
+static  CPU_INT16U  USBD_Audio_AS_IF_RingBufQIxNext (USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_settings,
+                                                     CPU_INT16U                  ix)
+{
+    ix++;
+    if (ix == p_as_if_settings->BufTotalNbr) {                  /* Reset ix if end of ring q reached.                   */
+        ix = 0u;
     }
-    CPU_CRITICAL_EXIT();
+
+    return (ix);
 }
 #endif
 
@@ -5299,7 +6081,9 @@ static  void  USBD_Audio_AS_IF_RingBufQIxUpdate (USBD_AUDIO_AS_IF_SETTINGS  *p_a
 *
 * Return(s)   : Difference of buffers.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Each index is read once, so that the difference is computed from a consistent
+*                   snapshot even if the producer or the consumer updates its index meanwhile. The
+*                   result may be one buffer off, which the correction boundaries absorb.
 *********************************************************************************************************
 */
 
@@ -5313,11 +6097,17 @@ static  CPU_INT08S  USBD_Audio_BufDiffGet (USBD_AUDIO_AS_IF_SETTINGS  *p_as_if_s
     USBD_AUDIO_AS_IF_RING_BUF_Q  *p_ring_buf_q = &p_as_if_settings->StreamRingBufQ;
     CPU_INT08S                    buf_diff;
     CPU_INT16U                    circular_distance;
+    CPU_INT16U                    producer_end_ix;
+    CPU_INT16U                    consumer_end_ix;
+
+
+    producer_end_ix = p_ring_buf_q->ProducerEndIx;              /* See Note #1.                                         */
+    consumer_end_ix = p_ring_buf_q->ConsumerEndIx;
 
-    if (p_ring_buf_q->ProducerEndIx >= p_ring_buf_q->ConsumerEndIx) {
-        circular_distance = p_ring_buf_q->ProducerEndIx - p_ring_buf_q->ConsumerEndIx;
+    if (producer_end_ix >= consumer_end_ix) {
+        circular_distance = producer_end_ix - consumer_end_ix;
     } else {
-        circular_distance = (p_as_if_settings->BufTotalNbr + 1 + p_ring_buf_q->ProducerEndIx) - p_ring_buf_q->ConsumerEndIx;
+        circular_distance = (p_as_if_settings->BufTotalNbr + 1 + producer_end_ix) - consumer_end_ix;
     }
 
     buf_diff = (CPU_INT08S)(circular_distance - p_as_if_settings->StreamPreBufMax);
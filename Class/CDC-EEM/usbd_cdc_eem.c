@@ -56,6 +56,43 @@
                                                                 /* Dflt Rx buffer qty is 1.                             */
 #ifndef  USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV
 #define  USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV              1u
+#endif
+
+                                                                /* Dflt Rx path copies every frame.                     */
+#ifndef  USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN
+#define  USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN       DEF_DISABLED
+#endif
+
+                                                                /* Dflt zero-copy pool has one spare Rx buffer.         */
+#ifndef  USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV
+#define  USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV (USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV + 1u)
+#endif
+
+                                                                /* Dflt Tx path sends one frame per xfer.               */
+#ifndef  USBD_CDC_EEM_CFG_TX_AGG_EN
+#define  USBD_CDC_EEM_CFG_TX_AGG_EN             DEF_DISABLED
+#endif
+
+                                                                /* Dflt aggregated xfer is at most 2048 octets.         */
+#ifndef  USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN
+#define  USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN               2048u
+#endif
+
+                                                                /* Dflt aggregation never delays a frame.               */
+#ifndef  USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS
+#define  USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS               0u
+#endif
+
+                                                                /* Dflt Rx path does not verify CRCs.                   */
+#ifndef  USBD_CDC_EEM_CFG_RX_CRC_CHK_EN
+#define  USBD_CDC_EEM_CFG_RX_CRC_CHK_EN         DEF_DISABLED
+#endif
+
+                                                                /* Nbr of Rx buffers allocated per class instance.      */
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+#define  USBD_CDC_EEM_RX_BUF_NBR                    USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV
+#else
+#define  USBD_CDC_EEM_RX_BUF_NBR                    USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV
 #endif
 
                                                                 /* Max nbr of comm struct.                              */
@@ -272,12 +309,18 @@ struct  usbd_cdc_eem_ctrl {
     CPU_INT08U           RxErrCnt;                              /* Cnt of Rx error.                                     */
 
                                                                 /* Ptr to Rx buffer table.                              */
-    CPU_INT08U          *RxBufPtrTbl[USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV];
+    CPU_INT08U          *RxBufPtrTbl[USBD_CDC_EEM_RX_BUF_NBR];
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+                                                                /* Nbr of refs held on each Rx buffer of the pool.      */
+    CPU_INT16U           RxBufRefCntTbl[USBD_CDC_EEM_RX_BUF_NBR];
+    CPU_INT08U           RxBufArmPendCnt;                       /* Nbr of Rx buffers waiting for a free pool buffer.    */
+#endif
 
     CPU_INT08U          *BufEchoPtr;                            /* Ptr to buffer that contains echo data.               */
 
     USBD_CDC_EEM_DRV    *DrvPtr;                                /* Ptr to network driver.                               */
     void                *DrvArgPtr;                             /* Arg of network driver.                               */
+    USBD_CDC_EEM_CRC_API *CrcAPI_Ptr;                           /* Ptr to CRC-32 engine.                                */
 
                                                                 /* ----------------- RX STATE MACHINE ----------------- */
     CPU_INT16U           CurHdr;                                /* Hdr of current buffer.                               */
@@ -285,11 +328,28 @@ struct  usbd_cdc_eem_ctrl {
     CPU_INT08U          *CurBufPtr;                             /* Pointer to current network buffer.                   */
     CPU_INT16U           CurBufIx;                              /* Index of network buffer to write.                    */
     CPU_BOOLEAN          CurBufCrcComputed;                     /* Flag indicates if CRC is computed on current buf.    */
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+    CPU_BOOLEAN          CurBufCrcChk;                          /* Flag indicates if CRC of current buf is verified.    */
+    CPU_INT32U           CurBufCrc;                             /* CRC-32 register of current buf.                      */
+    CPU_INT08U          *RxBufSparePtr;                         /* Network buf recycled after a bad CRC.                */
+#endif
 
                                                                 /* ---------------- NETWORK BUFFER QS ----------------- */
     USBD_CDC_EEM_BUF_Q   RxBufQ;                                /* Rx buffer Q.                                         */
     USBD_CDC_EEM_BUF_Q   TxBufQ;                                /* Tx buffer Q.                                         */
     CPU_BOOLEAN          TxInProgress;                          /* Flag that indicates if a Tx is in progress.          */
+
+                                                                /* ------------------ TX AGGREGATION ------------------ */
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+    CPU_INT08U          *TxAggBufPtr;                           /* Ptr to buffer in which queued pkts are packed.       */
+    CPU_INT08U           TxAggPktCnt;                           /* Nbr of pkts at head of Tx Q sent by current xfer.    */
+    CPU_INT32U           TxAggQLen;                             /* Nbr of octets queued but not sent yet.               */
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+    KAL_TMR_HANDLE       TxAggTmrHandle;                        /* Handle on aggregation flush timer.                   */
+    CPU_BOOLEAN          TxAggTmrActive;                        /* Flag that indicates if flush timer is running.       */
+#endif
+#endif
+    USBD_CDC_EEM_TX_STAT TxStat;                                /* Tx statistics.                                       */
 };
 
 
@@ -349,9 +409,38 @@ static  void         USBD_CDC_EEM_TxCmpl     (CPU_INT08U           dev_nbr,
 static  void         USBD_CDC_EEM_TxBufSubmit(USBD_CDC_EEM_CTRL   *p_ctrl,
                                               CPU_INT08U          *p_buf,
                                               CPU_INT16U           buf_len,
+                                              CPU_BOOLEAN          crc_computed,
+                                              USBD_ERR            *p_err);
+
+static  void         USBD_CDC_EEM_RxCopy     (USBD_CDC_EEM_CTRL   *p_ctrl,
+                                              CPU_INT08U          *p_dest,
+                                              CPU_INT08U          *p_src,
+                                              CPU_INT16U           len);
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+static  void         USBD_CDC_EEM_TxAggStart (USBD_CDC_EEM_CTRL   *p_ctrl,
+                                              USBD_ERR            *p_err);
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+static  void         USBD_CDC_EEM_TxAggTmrCallback(void           *p_arg);
+#endif
+#endif
+
+static  void         USBD_CDC_EEM_TxStatUpdate(USBD_CDC_EEM_CTRL  *p_ctrl,
+                                               CPU_INT08U          pkt_cnt);
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+static  CPU_INT08U   USBD_CDC_EEM_RxBufIxGet (USBD_CDC_EEM_CTRL   *p_ctrl,
+                                              CPU_INT08U          *p_buf);
+
+static  CPU_INT08U   USBD_CDC_EEM_RxBufFreeGet(USBD_CDC_EEM_CTRL  *p_ctrl);
+
+static  void         USBD_CDC_EEM_RxBufArm   (USBD_CDC_EEM_CTRL   *p_ctrl,
+                                              CPU_INT08U           buf_ix,
                                               USBD_ERR            *p_err);
+#endif
 
-static  void         USBD_CDC_EEM_BufQ_Add   (USBD_CDC_EEM_BUF_Q  *p_buf_q,
+static  CPU_BOOLEAN  USBD_CDC_EEM_BufQ_Add   (USBD_CDC_EEM_BUF_Q  *p_buf_q,
                                               CPU_INT08U          *p_buf,
                                               CPU_INT16U           buf_len,
                                               CPU_BOOLEAN          crc_computed);
@@ -483,6 +572,7 @@ void  USBD_CDC_EEM_Init (USBD_ERR  *p_err)
 *
 *                               USBD_ERR_NONE       Operation was successful.
 *                               USBD_ERR_ALLOC      No more class instance structure available.
+*                               USBD_ERR_OS_FAIL    Failed to create Tx aggregation flush timer.
 *
 *
 * Return(s)   : Class instance number, if NO error(s).
@@ -532,7 +622,7 @@ CPU_INT08U  USBD_CDC_EEM_Add (USBD_ERR  *p_err)
     }
 
                                                                 /* Allocate Rx buffers.                                 */
-    for (buf_cnt = 0u; buf_cnt < USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV; buf_cnt++) {
+    for (buf_cnt = 0u; buf_cnt < USBD_CDC_EEM_RX_BUF_NBR; buf_cnt++) {
         p_ctrl->RxBufPtrTbl[buf_cnt] = (CPU_INT08U *)Mem_HeapAlloc(USBD_CDC_EEM_CFG_RX_BUF_LEN,
                                                                    USBD_CFG_BUF_ALIGN_OCTETS,
                                                                    DEF_NULL,
@@ -541,7 +631,51 @@ CPU_INT08U  USBD_CDC_EEM_Add (USBD_ERR  *p_err)
            *p_err = USBD_ERR_ALLOC;
             return (USBD_CLASS_NBR_NONE);
         }
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+        p_ctrl->RxBufRefCntTbl[buf_cnt] = 0u;
+#endif
+    }
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    p_ctrl->RxBufArmPendCnt = 0u;
+#endif
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+                                                                /* Alloc buffer in which Tx pkts are aggregated.        */
+    p_ctrl->TxAggBufPtr = (CPU_INT08U *)Mem_HeapAlloc(USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN,
+                                                      USBD_CFG_BUF_ALIGN_OCTETS,
+                                                      DEF_NULL,
+                                                     &err_lib);
+    if (err_lib != LIB_MEM_ERR_NONE) {
+       *p_err = USBD_ERR_ALLOC;
+        return (USBD_CLASS_NBR_NONE);
+    }
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+    {
+        KAL_ERR  err_kal;
+
+                                                                /* Create one-shot aggregation flush timer.             */
+        p_ctrl->TxAggTmrHandle = KAL_TmrCreate("USBD - CDC EEM Tx agg tmr",
+                                                USBD_CDC_EEM_TxAggTmrCallback,
+                                       (void *) p_ctrl,
+                                                USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS,
+                                                DEF_NULL,
+                                               &err_kal);
+        if (err_kal != KAL_ERR_NONE) {
+           *p_err = USBD_ERR_OS_FAIL;
+            return (USBD_CLASS_NBR_NONE);
+        }
+        p_ctrl->TxAggTmrActive = DEF_NO;
     }
+#endif
+#endif
+
+    Mem_Clr((void *)&p_ctrl->TxStat,
+                     sizeof(USBD_CDC_EEM_TX_STAT));
+
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+    p_ctrl->RxBufSparePtr = DEF_NULL;
+#endif
 
    *p_err = USBD_ERR_NONE;
 
@@ -833,8 +967,9 @@ void  USBD_CDC_EEM_InstanceInit (CPU_INT08U         class_nbr,
     }
 #endif
 
-    p_ctrl->DrvPtr    = p_cdc_eem_drv;
-    p_ctrl->DrvArgPtr = p_arg;
+    p_ctrl->DrvPtr     = p_cdc_eem_drv;
+    p_ctrl->DrvArgPtr  = p_arg;
+    p_ctrl->CrcAPI_Ptr = p_cfg->CrcAPI_Ptr;
 
                                                                 /* ---------------- ALLOC TX AND RX QS ---------------- */
     p_ctrl->TxBufQ.Size =  p_cfg->TxBufQSize + 1u;              /* Add 1 entry for echo buf.                            */
@@ -1101,7 +1236,10 @@ CPU_INT08U  USBD_CDC_EEM_DevNbrGet (CPU_INT08U   class_nbr,
 *
 *               DEF_NULL,                   otherwise.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When the zero-copy receive path is enabled, the returned pointer may point inside one
+*                   of the class' bulk receive buffers. Such a frame is only preceded by its 2-byte EEM
+*                   header, hence it is NOT aligned on USBD_CFG_BUF_ALIGN_OCTETS. Every buffer returned
+*                   by this function MUST be given back using USBD_CDC_EEM_RxDataPktRelease().
 *********************************************************************************************************
 */
 
@@ -1149,6 +1287,131 @@ CPU_INT08U  *USBD_CDC_EEM_RxDataPktGet (CPU_INT08U    class_nbr,
 }
 
 
+/*
+*********************************************************************************************************
+*                                   USBD_CDC_EEM_RxDataPktRelease()
+*
+* Description : Releases a data packet obtained from USBD_CDC_EEM_RxDataPktGet().
+*
+* Argument(s) : class_nbr       Class instance number.
+*
+*               p_buf           Pointer to buffer returned by USBD_CDC_EEM_RxDataPktGet().
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Operation was successful.
+*                               USBD_ERR_INVALID_ARG        Invalid argument(s) passed to 'class_nbr'.
+*                               USBD_ERR_NULL_PTR           Invalid null pointer passed to 'p_buf'.
+*
+*                               -RETURNED BY USBD_CDC_EEM_StateLock()-
+*                               See USBD_CDC_EEM_StateLock() for additional return error codes.
+*
+*                               -RETURNED BY USBD_BulkRxAsync()-
+*                               See USBD_BulkRxAsync() for additional return error codes.
+*
+* Return(s)   : DEF_YES, if buffer belongs to the class and has been released.
+*
+*               DEF_NO,  if buffer belongs to the network driver, which must then recycle it.
+*
+* Note(s)     : (1) Frames that lie entirely within a bulk receive buffer are delivered in place and
+*                   hold a reference on that buffer. Once the last reference is released, the buffer
+*                   returns to the pool and is armed again if the bulk OUT endpoint was left without
+*                   enough armed buffers.
+*
+*               (2) Frames that straddle two bulk transfers, or all frames when the zero-copy receive
+*                   path is disabled, are copied to a buffer obtained with the RxBufGet() driver
+*                   function. This function then returns DEF_NO.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  USBD_CDC_EEM_RxDataPktRelease (CPU_INT08U   class_nbr,
+                                            CPU_INT08U  *p_buf,
+                                            USBD_ERR    *p_err)
+{
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    CPU_INT08U          buf_ix;
+    CPU_BOOLEAN         arm;
+    USBD_CDC_EEM_CTRL  *p_ctrl;
+    USBD_ERR            err_unlock;
+    CPU_SR_ALLOC();
+#endif
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    {
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN != DEF_ENABLED)
+        CPU_SR_ALLOC();
+#endif
+
+
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(DEF_NO);
+        }
+
+        CPU_CRITICAL_ENTER();
+        if (class_nbr >= USBD_CDC_EEM_CtrlNbrNext) {
+            CPU_CRITICAL_EXIT();
+           *p_err = USBD_ERR_INVALID_ARG;
+
+            return (DEF_NO);
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (p_buf == DEF_NULL) {
+           *p_err = USBD_ERR_NULL_PTR;
+            return (DEF_NO);
+        }
+    }
+#endif
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    p_ctrl = &USBD_CDC_EEM_CtrlTbl[class_nbr];
+    buf_ix =  USBD_CDC_EEM_RxBufIxGet(p_ctrl, p_buf);
+    if (buf_ix >= USBD_CDC_EEM_RX_BUF_NBR) {                    /* Buf copied to a net drv's buf (see Note #2).         */
+       *p_err = USBD_ERR_NONE;
+        return (DEF_NO);
+    }
+
+    USBD_CDC_EEM_StateLock(p_ctrl, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    arm = DEF_NO;
+    CPU_CRITICAL_ENTER();
+    if (p_ctrl->RxBufRefCntTbl[buf_ix] > 0u) {
+        p_ctrl->RxBufRefCntTbl[buf_ix]--;
+    }
+                                                                /* Re-arm buf if EP is waiting for one (see Note #1).   */
+    if ((p_ctrl->RxBufRefCntTbl[buf_ix] == 0u                    ) &&
+        (p_ctrl->RxBufArmPendCnt         >  0u                    ) &&
+        (p_ctrl->StartCnt                >  0u                    ) &&
+        (p_ctrl->State                   == USBD_CDC_EEM_STATE_CFG)) {
+        p_ctrl->RxBufArmPendCnt--;
+        p_ctrl->RxBufRefCntTbl[buf_ix] = 1u;
+        arm                            = DEF_YES;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (arm == DEF_YES) {
+        USBD_CDC_EEM_RxBufArm(p_ctrl, buf_ix, p_err);
+    }
+
+    USBD_CDC_EEM_StateUnlock(p_ctrl, &err_unlock);
+    (void)err_unlock;
+
+    return (DEF_YES);
+#else
+    (void)class_nbr;
+    (void)p_buf;
+
+   *p_err = USBD_ERR_NONE;
+
+    return (DEF_NO);
+#endif
+}
+
+
 /*
 *********************************************************************************************************
 *                                     USBD_CDC_EEM_TxDataPktSubmit()
@@ -1179,6 +1442,17 @@ CPU_INT08U  *USBD_CDC_EEM_RxDataPktGet (CPU_INT08U    class_nbr,
 *
 * Note(s)     : (1) Buffers submitted using this function MUST have a padding of 2 bytes at the
 *                   beginning.
+*
+*               (2) When transmit aggregation is enabled, the buffer is copied into the aggregation buffer
+*                   along with other queued buffers, but is only returned through the driver's TxBufFree()
+*                   callback once the transfer that carries it completes.
+*
+*               (3) Buffers submitted without a CRC MUST have 4 bytes available after the payload. If the
+*                   class instance has a CRC-32 engine, the CRC is computed and stored there; otherwise
+*                   the 0xDEADBEEF sentinel is. When transmit aggregation is enabled, the CRC is computed
+*                   while the buffer is copied into the aggregation buffer.
+*
+*               (4) Buffers submitted with a computed CRC include it in 'buf_len'.
 *********************************************************************************************************
 */
 
@@ -1189,6 +1463,8 @@ void  USBD_CDC_EEM_TxDataPktSubmit (CPU_INT08U    class_nbr,
                                     USBD_ERR     *p_err)
 {
     CPU_INT16U          hdr;
+    CPU_INT32U          xfer_len;
+    CPU_BOOLEAN         crc_calc;
     USBD_CDC_EEM_CTRL  *p_ctrl;
 
 
@@ -1221,30 +1497,124 @@ void  USBD_CDC_EEM_TxDataPktSubmit (CPU_INT08U    class_nbr,
     p_ctrl = &USBD_CDC_EEM_CtrlTbl[class_nbr];
 
                                                                 /* Prepare header.                                      */
-    hdr = DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PKT_TYPE_PAYLOAD, USBD_CDC_EEM_PKT_TYPE_MASK);
+    hdr      = DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PKT_TYPE_PAYLOAD, USBD_CDC_EEM_PKT_TYPE_MASK);
+    crc_calc = DEF_NO;
 
     if (crc_computed == DEF_NO) {
+        if (p_ctrl->CrcAPI_Ptr == DEF_NULL) {
                                                                 /* Set CRC to 0xDEADBEEF as per CDC-EEM specification.  */
-        Mem_Copy((void *)&p_buf[buf_len + USBD_CDC_EEM_HDR_LEN],
-                 (void *) USBD_CDC_EEM_PayloadCRC,
-                          4u);
+            Mem_Copy((void *)&p_buf[buf_len + USBD_CDC_EEM_HDR_LEN],
+                     (void *) USBD_CDC_EEM_PayloadCRC,
+                              USBD_CDC_EEM_CRC_LEN);
+
+            hdr |= DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PAYLOAD_CRC_NOT_CALC, USBD_CDC_EEM_PAYLOAD_CRC_MASK);
+        } else {
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+            crc_calc = DEF_YES;                                 /* Compute CRC while packing xfer (see Note #3).        */
+#else
+            CPU_INT32U  crc;
+
+                                                                /* Compute CRC with class engine (see Note #3).         */
+            crc = p_ctrl->CrcAPI_Ptr->CopyCalc(USBD_CDC_EEM_CRC_INIT,
+                                               DEF_NULL,
+                                              &p_buf[USBD_CDC_EEM_HDR_LEN],
+                                               buf_len);
+            MEM_VAL_SET_INT32U_LITTLE((void *)&p_buf[buf_len + USBD_CDC_EEM_HDR_LEN], ~crc);
+#endif
+
+            hdr |= DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PAYLOAD_CRC_CALC, USBD_CDC_EEM_PAYLOAD_CRC_MASK);
+        }
 
-        hdr |= DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PAYLOAD_CRC_NOT_CALC, USBD_CDC_EEM_PAYLOAD_CRC_MASK) |
-               DEF_BIT_FIELD_ENC(buf_len + 4u,                      USBD_CDC_EEM_PAYLOAD_LEN_MASK);
+        buf_len += USBD_CDC_EEM_CRC_LEN;
     } else {
-        hdr |= DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PAYLOAD_CRC_CALC, USBD_CDC_EEM_PAYLOAD_CRC_MASK) |
-               DEF_BIT_FIELD_ENC(buf_len,                       USBD_CDC_EEM_PAYLOAD_LEN_MASK);
+        hdr |= DEF_BIT_FIELD_ENC(USBD_CDC_EEM_PAYLOAD_CRC_CALC, USBD_CDC_EEM_PAYLOAD_CRC_MASK);
     }
 
+    hdr      |= DEF_BIT_FIELD_ENC(buf_len, USBD_CDC_EEM_PAYLOAD_LEN_MASK);
+    xfer_len  = buf_len + USBD_CDC_EEM_HDR_LEN;                 /* CRC already included in buf len (see Note #4).       */
+
    ((CPU_INT16U *)p_buf)[0u] = MEM_VAL_GET_INT16U_LITTLE(&hdr); /* Copy hdr to buffer.                                  */
 
     USBD_CDC_EEM_TxBufSubmit(p_ctrl,                            /* Send buffer to host.                                 */
                              p_buf,
-                             buf_len + USBD_CDC_EEM_HDR_LEN + 4u,
+                             xfer_len,
+                            (crc_calc == DEF_YES) ? DEF_NO : DEF_YES,
                              p_err);
 }
 
 
+/*
+*********************************************************************************************************
+*                                       USBD_CDC_EEM_TxStatGet()
+*
+* Description : Gets the transmit statistics of a class instance.
+*
+* Argument(s) : class_nbr       Class instance number.
+*
+*               p_stat          Pointer to structure that will receive the statistics.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Operation was successful.
+*                               USBD_ERR_INVALID_ARG        Invalid argument(s) passed to 'class_nbr'.
+*                               USBD_ERR_NULL_PTR           Invalid null pointer passed to 'p_stat'.
+*
+*                                   -RETURNED BY USBD_CDC_EEM_StateLock()-
+*                                   See USBD_CDC_EEM_StateLock() for additional return error codes.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Statistics are accumulated since the class instance was added.
+*********************************************************************************************************
+*/
+
+void  USBD_CDC_EEM_TxStatGet (CPU_INT08U             class_nbr,
+                              USBD_CDC_EEM_TX_STAT  *p_stat,
+                              USBD_ERR              *p_err)
+{
+    USBD_CDC_EEM_CTRL  *p_ctrl;
+    USBD_ERR            err_unlock;
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    {
+        CPU_SR_ALLOC();
+
+
+        if (p_err == DEF_NULL) {
+            CPU_SW_EXCEPTION(;);
+        }
+
+        CPU_CRITICAL_ENTER();
+        if (class_nbr >= USBD_CDC_EEM_CtrlNbrNext) {
+            CPU_CRITICAL_EXIT();
+
+           *p_err = USBD_ERR_INVALID_ARG;
+            return;
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (p_stat == DEF_NULL) {
+           *p_err = USBD_ERR_NULL_PTR;
+            return;
+        }
+    }
+#endif
+
+    p_ctrl = &USBD_CDC_EEM_CtrlTbl[class_nbr];
+
+    USBD_CDC_EEM_StateLock(p_ctrl, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+   *p_stat = p_ctrl->TxStat;
+
+    USBD_CDC_EEM_StateUnlock(p_ctrl, &err_unlock);
+    (void)err_unlock;
+}
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -1353,6 +1723,10 @@ static  void  USBD_CDC_EEM_Disconn (CPU_INT08U   dev_nbr,
 * Return(s)   : None.
 *
 * Note(s)     : (1) State of CDC-EEM must be locked by caller function.
+*
+*               (2) With the zero-copy receive path, buffers of the pool may still be referenced by the
+*                   network driver from a previous session. Only free buffers are armed; the remaining
+*                   ones are armed as soon as a pool buffer is released.
 *********************************************************************************************************
 */
 
@@ -1360,16 +1734,24 @@ static  void  USBD_CDC_EEM_CommStart (USBD_CDC_EEM_CTRL  *p_ctrl,
                                       USBD_ERR           *p_err)
 {
     CPU_INT08U          buf_cnt;
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    CPU_INT08U          buf_ix;
+    CPU_SR_ALLOC();
+#else
     USBD_CDC_EEM_COMM  *p_comm;
 
 
     p_comm = p_ctrl->CommPtr;
+#endif
 
                                                                 /* Init Rx state machine.                               */
     p_ctrl->CurBufLenRem      = 0u;
     p_ctrl->CurBufPtr         = DEF_NULL;
     p_ctrl->CurBufIx          = 0u;
     p_ctrl->CurBufCrcComputed = DEF_NO;
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+    p_ctrl->CurBufCrcChk      = DEF_NO;
+#endif
     p_ctrl->RxErrCnt          = 0u;
 
                                                                 /* Init Tx and Rx Qs.                                   */
@@ -1377,11 +1759,37 @@ static  void  USBD_CDC_EEM_CommStart (USBD_CDC_EEM_CTRL  *p_ctrl,
     p_ctrl->TxBufQ.OutIdx = 0u;
     p_ctrl->TxBufQ.Cnt    = 0u;
     p_ctrl->TxInProgress  = DEF_NO;
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+    p_ctrl->TxAggPktCnt   = 0u;
+    p_ctrl->TxAggQLen     = 0u;
+#endif
 
     p_ctrl->RxBufQ.InIdx  = 0u;
     p_ctrl->RxBufQ.OutIdx = 0u;
     p_ctrl->RxBufQ.Cnt    = 0u;
 
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+   *p_err = USBD_ERR_NONE;
+    p_ctrl->RxBufArmPendCnt = 0u;
+                                                                /* Arm free buffers of the pool (see Note #2).          */
+    for (buf_cnt = 0u; buf_cnt < USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV; buf_cnt++) {
+        CPU_CRITICAL_ENTER();
+        buf_ix = USBD_CDC_EEM_RxBufFreeGet(p_ctrl);
+        if (buf_ix < USBD_CDC_EEM_RX_BUF_NBR) {
+            p_ctrl->RxBufRefCntTbl[buf_ix] = 1u;
+        } else {
+            p_ctrl->RxBufArmPendCnt++;
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (buf_ix < USBD_CDC_EEM_RX_BUF_NBR) {
+            USBD_CDC_EEM_RxBufArm(p_ctrl, buf_ix, p_err);
+            if (*p_err != USBD_ERR_NONE) {
+                break;
+            }
+        }
+    }
+#else
                                                                 /* Submit all avail Rx buffers.                         */
     for (buf_cnt = 0u; buf_cnt < USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV; buf_cnt++) {
         USBD_BulkRxAsync(        p_ctrl->DevNbr,
@@ -1395,6 +1803,7 @@ static  void  USBD_CDC_EEM_CommStart (USBD_CDC_EEM_CTRL  *p_ctrl,
             break;
         }
     }
+#endif
 }
 
 
@@ -1420,7 +1829,18 @@ static  void  USBD_CDC_EEM_CommStart (USBD_CDC_EEM_CTRL  *p_ctrl,
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) With the zero-copy receive path, the class holds one reference on the bulk buffer
+*                   while it is armed and parsed, and each frame delivered in place holds one more. When
+*                   the parsing is done, the class reference is dropped and the first free buffer of the
+*                   pool is armed, which may be the completed buffer itself. If no buffer is free, the
+*                   arm is deferred until the network driver releases one.
+*
+*               (2) When CRC verification is enabled, the CRC of a frame copied to a network buffer is
+*                   computed by the copy itself (see USBD_CDC_EEM_RxCopy()), and the CRC of a frame
+*                   delivered in place is computed in a single pass over the bulk buffer. Running the
+*                   CRC-32 over a frame and its CRC yields USBD_CDC_EEM_CRC_RESIDUE, so the CRC octets do
+*                   not need to be located. A frame with a bad CRC is dropped; as the network driver
+*                   cannot take back a buffer, it is kept and used for the next frame.
 *********************************************************************************************************
 */
 
@@ -1435,6 +1855,9 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
     CPU_INT16U          buf_ix_cur =  0u;
     USBD_CDC_EEM_CTRL  *p_ctrl     = (USBD_CDC_EEM_CTRL *)p_arg;
     USBD_ERR            err_usbd;
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    CPU_INT08U          buf_ix;
+#endif
     CPU_SR_ALLOC();
 
 
@@ -1442,6 +1865,10 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
     (void)ep_addr;
     (void)buf_len;
 
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    buf_ix = USBD_CDC_EEM_RxBufIxGet(p_ctrl, (CPU_INT08U *)p_buf);
+#endif
+
     switch (err) {                                              /* Chk errors.                                          */
         case USBD_ERR_NONE:
              p_ctrl->RxErrCnt = 0u;
@@ -1449,12 +1876,22 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
 
 
         case USBD_ERR_EP_ABORT:
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+             CPU_CRITICAL_ENTER();                              /* Drop class ref on buf (see Note #1).                 */
+             p_ctrl->RxBufRefCntTbl[buf_ix]--;
+             CPU_CRITICAL_EXIT();
+#endif
              return;
 
 
         default:
              p_ctrl->RxErrCnt++;                                /* Retry a few times.                                   */
              if (p_ctrl->RxErrCnt > USBD_CDC_EEM_MAX_RETRY_CNT) {
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+                 CPU_CRITICAL_ENTER();
+                 p_ctrl->RxBufRefCntTbl[buf_ix]--;
+                 CPU_CRITICAL_EXIT();
+#endif
                  return;
              }
 
@@ -1466,9 +1903,10 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
 
 
         if (p_ctrl->CurBufPtr != DEF_NULL) {
-            Mem_Copy((void *)&p_ctrl->CurBufPtr[p_ctrl->CurBufIx],
-                              p_buf,
-                              len_to_copy);
+            USBD_CDC_EEM_RxCopy(              p_ctrl,
+                                             &p_ctrl->CurBufPtr[p_ctrl->CurBufIx],
+                                (CPU_INT08U *)p_buf,
+                                              len_to_copy);
         }
 
         p_ctrl->CurBufIx     += len_to_copy;
@@ -1514,6 +1952,9 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
 
                               buf_ix_cur       += USBD_CDC_EEM_HDR_LEN;
                               p_ctrl->CurBufIx += USBD_CDC_EEM_HDR_LEN;
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+                              p_ctrl->CurBufCrcChk = DEF_NO;
+#endif
 
                                                                 /* Copy echo buffer.                                    */
                               p_ctrl->CurBufPtr    = p_ctrl->BufEchoPtr;
@@ -1542,6 +1983,7 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
                               USBD_CDC_EEM_TxBufSubmit(p_ctrl,
                                                        p_ctrl->CurBufPtr,
                                                        p_ctrl->CurBufIx,
+                                                       DEF_YES,
                                                       &err_usbd);
 
                               p_ctrl->CurBufIx = 0u;
@@ -1567,11 +2009,7 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
                      CPU_INT16U  len_to_copy;
 
 
-                     buf_ix_cur       += USBD_CDC_EEM_HDR_LEN;
-                     p_ctrl->CurBufPtr = p_ctrl->DrvPtr->RxBufGet(p_ctrl->ClassNbr,
-                                                                  p_ctrl->DrvArgPtr,
-                                                                 &net_buf_len);
-
+                     buf_ix_cur          += USBD_CDC_EEM_HDR_LEN;
                      p_ctrl->CurBufLenRem = DEF_BIT_FIELD_RD(p_ctrl->CurHdr, USBD_CDC_EEM_PAYLOAD_LEN_MASK);
 
                      if (DEF_BIT_FIELD_RD(p_ctrl->CurHdr, USBD_CDC_EEM_PAYLOAD_CRC_MASK) == USBD_CDC_EEM_PAYLOAD_CRC_CALC) {
@@ -1580,12 +2018,79 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
                          p_ctrl->CurBufCrcComputed = DEF_NO;
                      }
 
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+                                                                /* Verify CRC if computed by host (see Note #2).        */
+                     if ((p_ctrl->CurBufCrcComputed == DEF_YES) &&
+                         (p_ctrl->CrcAPI_Ptr        != DEF_NULL)) {
+                         p_ctrl->CurBufCrcChk = DEF_YES;
+                     } else {
+                         p_ctrl->CurBufCrcChk = DEF_NO;
+                     }
+                     p_ctrl->CurBufCrc = USBD_CDC_EEM_CRC_INIT;
+#endif
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+                                                                /* Deliver frame in place if entirely in this xfer.     */
+                     if (p_ctrl->CurBufLenRem <= (xfer_len - buf_ix_cur)) {
+                         CPU_BOOLEAN  queued;
+                         CPU_BOOLEAN  crc_ok = DEF_YES;
+
+
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+                         if (p_ctrl->CurBufCrcChk == DEF_YES) {
+                             p_ctrl->CurBufCrc = p_ctrl->CrcAPI_Ptr->CopyCalc(USBD_CDC_EEM_CRC_INIT,
+                                                                              DEF_NULL,
+                                                                             &((CPU_INT08U *)p_buf)[buf_ix_cur],
+                                                                              p_ctrl->CurBufLenRem);
+                             if (p_ctrl->CurBufCrc != USBD_CDC_EEM_CRC_RESIDUE) {
+                                 crc_ok = DEF_NO;               /* Drop frame with bad CRC.                             */
+                             }
+                         }
+#endif
+
+                         CPU_CRITICAL_ENTER();                  /* Frame holds a ref on bulk buf (see Note #1).         */
+                         queued = DEF_NO;
+                         if (crc_ok == DEF_YES) {
+                             queued = USBD_CDC_EEM_BufQ_Add(&p_ctrl->RxBufQ,
+                                                            &((CPU_INT08U *)p_buf)[buf_ix_cur],
+                                                             p_ctrl->CurBufLenRem,
+                                                             p_ctrl->CurBufCrcComputed);
+                         }
+                         if (queued == DEF_YES) {
+                             p_ctrl->RxBufRefCntTbl[buf_ix]++;
+                         }
+                         CPU_CRITICAL_EXIT();
+
+                         if (queued == DEF_YES) {
+                             p_ctrl->DrvPtr->RxBufRdy(p_ctrl->ClassNbr,
+                                                      p_ctrl->DrvArgPtr);
+                         }
+
+                         buf_ix_cur          += p_ctrl->CurBufLenRem;
+                         p_ctrl->CurBufLenRem = 0u;
+                         break;
+                     }
+#endif
+
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+                     if (p_ctrl->RxBufSparePtr != DEF_NULL) {   /* Reuse buf of last dropped frame (see Note #2).       */
+                         p_ctrl->CurBufPtr     = p_ctrl->RxBufSparePtr;
+                         p_ctrl->RxBufSparePtr = DEF_NULL;
+                     } else
+#endif
+                     {
+                         p_ctrl->CurBufPtr = p_ctrl->DrvPtr->RxBufGet(p_ctrl->ClassNbr,
+                                                                      p_ctrl->DrvArgPtr,
+                                                                     &net_buf_len);
+                     }
+
                                                                 /* Copy payload content to network drv's buf.           */
                      len_to_copy = DEF_MIN(p_ctrl->CurBufLenRem, (xfer_len - buf_ix_cur));
                      if (p_ctrl->CurBufPtr != DEF_NULL) {
-                         Mem_Copy((void *)&p_ctrl->CurBufPtr[p_ctrl->CurBufIx],
-                                          &((CPU_INT08U *)p_buf)[buf_ix_cur],
-                                           len_to_copy);
+                         USBD_CDC_EEM_RxCopy( p_ctrl,
+                                             &p_ctrl->CurBufPtr[p_ctrl->CurBufIx],
+                                             &((CPU_INT08U *)p_buf)[buf_ix_cur],
+                                              len_to_copy);
                      }
                      p_ctrl->CurBufIx     += len_to_copy;
                      p_ctrl->CurBufLenRem -= len_to_copy;
@@ -1594,12 +2099,21 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
                  }
 
                  if (p_ctrl->CurBufLenRem == 0u) {              /* If reception complete, submit buf to network drv.    */
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+                     if ((p_ctrl->CurBufPtr    != DEF_NULL) &&
+                         (p_ctrl->CurBufCrcChk == DEF_YES ) &&
+                         (p_ctrl->CurBufCrc    != USBD_CDC_EEM_CRC_RESIDUE)) {
+                                                                /* Drop frame with bad CRC, but keep its buf.           */
+                         p_ctrl->RxBufSparePtr = p_ctrl->CurBufPtr;
+                         p_ctrl->CurBufPtr     = DEF_NULL;
+                     }
+#endif
                      if (p_ctrl->CurBufPtr != DEF_NULL) {
                          CPU_CRITICAL_ENTER();
-                         USBD_CDC_EEM_BufQ_Add(&p_ctrl->RxBufQ,
-                                                p_ctrl->CurBufPtr,
-                                                p_ctrl->CurBufIx,
-                                                p_ctrl->CurBufCrcComputed);
+                         (void)USBD_CDC_EEM_BufQ_Add(&p_ctrl->RxBufQ,
+                                                      p_ctrl->CurBufPtr,
+                                                      p_ctrl->CurBufIx,
+                                                      p_ctrl->CurBufCrcComputed);
                          CPU_CRITICAL_EXIT();
 
                          p_ctrl->DrvPtr->RxBufRdy(p_ctrl->ClassNbr,
@@ -1620,6 +2134,35 @@ static  void  USBD_CDC_EEM_RxCmpl (CPU_INT08U   dev_nbr,
 resubmit:
     USBD_CDC_EEM_StateLock(p_ctrl, &err_usbd);
 
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+    {
+        CPU_INT08U  buf_ix_arm = USBD_CDC_EEM_RX_BUF_NBR;
+
+
+        CPU_CRITICAL_ENTER();
+        p_ctrl->RxBufRefCntTbl[buf_ix]--;                       /* Drop class ref on buf (see Note #1).                 */
+
+        if ((p_ctrl->StartCnt >  0u) &&                         /* Arm a free pool buf if still connected.              */
+            (p_ctrl->State    == USBD_CDC_EEM_STATE_CFG)) {
+            if (p_ctrl->RxBufRefCntTbl[buf_ix] == 0u) {
+                buf_ix_arm = buf_ix;
+            } else {
+                buf_ix_arm = USBD_CDC_EEM_RxBufFreeGet(p_ctrl);
+            }
+
+            if (buf_ix_arm < USBD_CDC_EEM_RX_BUF_NBR) {
+                p_ctrl->RxBufRefCntTbl[buf_ix_arm] = 1u;
+            } else {
+                p_ctrl->RxBufArmPendCnt++;
+            }
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (buf_ix_arm < USBD_CDC_EEM_RX_BUF_NBR) {
+            USBD_CDC_EEM_RxBufArm(p_ctrl, buf_ix_arm, &err_usbd);
+        }
+    }
+#else
     if ((p_ctrl->StartCnt >  0u) &&                             /* Re-submit buf if still connected.                    */
         (p_ctrl->State    == USBD_CDC_EEM_STATE_CFG)) {
         USBD_BulkRxAsync(        p_ctrl->DevNbr,
@@ -1630,6 +2173,7 @@ resubmit:
                          (void *)p_ctrl,
                                 &err_usbd);
     }
+#endif
 
     USBD_CDC_EEM_StateUnlock(p_ctrl, &err_usbd);
 
@@ -1659,7 +2203,9 @@ resubmit:
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When transmit aggregation is enabled, the packets sent by the completed transfer are
+*                   still at the head of the Tx Q (see USBD_CDC_EEM_TxAggStart()). They are removed and
+*                   returned to the network driver before the next transfer is started.
 *********************************************************************************************************
 */
 
@@ -1671,8 +2217,11 @@ static  void  USBD_CDC_EEM_TxCmpl (CPU_INT08U   dev_nbr,
                                    void        *p_arg,
                                    USBD_ERR     err)
 {
-    CPU_INT08U         *p_next_buf;
-    CPU_INT16U          next_buf_len;
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+    CPU_INT08U         *p_pkt_buf;
+    CPU_INT16U          pkt_len;
+    CPU_INT08U          pkt_cnt;
+    CPU_BOOLEAN         tx_start;
     USBD_CDC_EEM_CTRL  *p_ctrl = (USBD_CDC_EEM_CTRL *)p_arg;
     USBD_ERR            err_lock;
     CPU_SR_ALLOC();
@@ -1680,10 +2229,70 @@ static  void  USBD_CDC_EEM_TxCmpl (CPU_INT08U   dev_nbr,
 
     (void)dev_nbr;
     (void)ep_addr;
+    (void)p_buf;
+    (void)buf_len;
     (void)xfer_len;
     (void)err;
 
-    if ((p_buf != p_ctrl->BufEchoPtr) &&
+                                                                /* Free pkts sent by this xfer to network drv (see ...  */
+                                                                /* ... Note #1).                                        */
+    for (pkt_cnt = 0u; pkt_cnt < p_ctrl->TxAggPktCnt; pkt_cnt++) {
+        CPU_CRITICAL_ENTER();
+        p_pkt_buf = USBD_CDC_EEM_BufQ_Get(&p_ctrl->TxBufQ,
+                                          &pkt_len,
+                                           DEF_NULL);
+        CPU_CRITICAL_EXIT();
+
+        if ((p_pkt_buf != p_ctrl->BufEchoPtr) &&
+            (p_pkt_buf != DEF_NULL)) {
+            p_ctrl->DrvPtr->TxBufFree(p_ctrl->ClassNbr,
+                                      p_ctrl->DrvArgPtr,
+                                      p_pkt_buf,
+                                      pkt_len);
+        }
+    }
+    p_ctrl->TxAggPktCnt = 0u;
+
+    USBD_CDC_EEM_StateLock(p_ctrl, &err_lock);
+
+    if ((p_ctrl->State    != USBD_CDC_EEM_STATE_CFG) ||
+        (p_ctrl->StartCnt == 0u)) {
+
+        USBD_CDC_EEM_StateUnlock(p_ctrl, &err_lock);
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* Send pkts queued during xfer, if any.                */
+    tx_start = (p_ctrl->TxBufQ.Cnt > 0u) ? DEF_YES : DEF_NO;
+    if (tx_start == DEF_NO) {
+        p_ctrl->TxInProgress = DEF_NO;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (tx_start == DEF_YES) {
+        USBD_ERR  err_submit;
+
+
+        USBD_CDC_EEM_TxAggStart(p_ctrl, &err_submit);
+        (void)err_submit;
+    }
+
+    USBD_CDC_EEM_StateUnlock(p_ctrl, &err_lock);
+    (void)err_lock;
+#else
+    CPU_INT08U         *p_next_buf;
+    CPU_INT16U          next_buf_len;
+    USBD_CDC_EEM_CTRL  *p_ctrl = (USBD_CDC_EEM_CTRL *)p_arg;
+    USBD_ERR            err_lock;
+    CPU_SR_ALLOC();
+
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)xfer_len;
+    (void)err;
+
+    if ((p_buf != p_ctrl->BufEchoPtr) &&
         (p_buf != DEF_NULL)) {                                  /* Free Tx buf to network drv.                          */
         p_ctrl->DrvPtr->TxBufFree(              p_ctrl->ClassNbr,
                                                 p_ctrl->DrvArgPtr,
@@ -1721,12 +2330,14 @@ static  void  USBD_CDC_EEM_TxCmpl (CPU_INT08U   dev_nbr,
                          (void *)p_ctrl,
                                  DEF_YES,
                                 &err_submit);
-
-        (void)err_submit;
+        if (err_submit == USBD_ERR_NONE) {
+            USBD_CDC_EEM_TxStatUpdate(p_ctrl, 1u);
+        }
     }
 
     USBD_CDC_EEM_StateUnlock(p_ctrl, &err_lock);
     (void)err_lock;
+#endif
 }
 
 
@@ -1742,9 +2353,17 @@ static  void  USBD_CDC_EEM_TxCmpl (CPU_INT08U   dev_nbr,
 *
 *               buf_len     Length of buffer in bytes.
 *
+*               crc_computed    Flag that indicates if the packet CRC is ready to be sent :
+*
+*                                   DEF_YES     Packet is sent as is.
+*                                   DEF_NO      CRC must be computed when the packet is packed into the
+*                                               aggregation buffer (see Note #2).
+*
 *               p_err       Pointer to variable that will receive the return error code from this function :
 *
-*                               USBD_ERR_NONE               Operation was successful.
+*                               USBD_ERR_NONE                   Operation was successful.
+*                               USBD_ERR_INVALID_CLASS_STATE    Class instance not started or configured.
+*                               USBD_ERR_EP_QUEUING             Tx Q full (aggregation enabled only).
 *
 *                               -RETURNED BY USBD_CDC_EEM_StateLock()-
 *                               See USBD_CDC_EEM_StateLock() for additional return error codes.
@@ -1754,20 +2373,36 @@ static  void  USBD_CDC_EEM_TxCmpl (CPU_INT08U   dev_nbr,
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When transmit aggregation is enabled, every buffer goes through the Tx Q. If the bulk
+*                   IN endpoint is idle, the transfer is started right away, unless a flush timeout is
+*                   configured. In that case, the transfer is started when the timer expires or when
+*                   enough octets are queued to fill the aggregation buffer, whichever comes first.
+*
+*               (2) 'crc_computed' can only be DEF_NO when transmit aggregation is enabled.
 *********************************************************************************************************
 */
 
 static  void  USBD_CDC_EEM_TxBufSubmit (USBD_CDC_EEM_CTRL  *p_ctrl,
                                         CPU_INT08U         *p_buf,
                                         CPU_INT16U          buf_len,
+                                        CPU_BOOLEAN         crc_computed,
                                         USBD_ERR           *p_err)
 {
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+    CPU_BOOLEAN  queued;
+    CPU_BOOLEAN  tx_start;
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+    CPU_BOOLEAN  tmr_start;
+#endif
+#else
     CPU_BOOLEAN  tx_in_progress;
+#endif
     USBD_ERR     err_unlock;
     CPU_SR_ALLOC();
 
 
+    (void)crc_computed;
+
     USBD_CDC_EEM_StateLock(p_ctrl, p_err);
     if (*p_err != USBD_ERR_NONE) {
         return;
@@ -1781,16 +2416,74 @@ static  void  USBD_CDC_EEM_TxBufSubmit (USBD_CDC_EEM_CTRL  *p_ctrl,
         return;
     }
 
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+    tx_start  = DEF_NO;
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+    tmr_start = DEF_NO;
+#endif
+
+    CPU_CRITICAL_ENTER();                                       /* Q buffer, even if no xfer in progress (see Note #1). */
+    queued = USBD_CDC_EEM_BufQ_Add(&p_ctrl->TxBufQ,
+                                    p_buf,
+                                    buf_len,
+                                    crc_computed);
+    if (queued == DEF_YES) {
+        p_ctrl->TxAggQLen += buf_len;
+
+        if (p_ctrl->TxInProgress == DEF_NO) {
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+            if (p_ctrl->TxAggQLen < USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN) {
+                tmr_start = (p_ctrl->TxAggTmrActive == DEF_NO) ? DEF_YES : DEF_NO;
+            } else {
+                tx_start  =  DEF_YES;
+            }
+#else
+            tx_start = DEF_YES;
+#endif
+        }
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (queued == DEF_NO) {
+        USBD_CDC_EEM_StateUnlock(p_ctrl, &err_unlock);
+
+       *p_err = USBD_ERR_EP_QUEUING;
+        return;
+    }
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS > 0u)
+    if (tmr_start == DEF_YES) {                                 /* Hold pkt until flush timer expires.                  */
+        KAL_ERR  err_kal;
+
+
+        KAL_TmrStart(p_ctrl->TxAggTmrHandle, &err_kal);
+        if (err_kal == KAL_ERR_NONE) {
+            p_ctrl->TxAggTmrActive = DEF_YES;
+        } else {
+            tx_start = DEF_YES;                                 /* Send pkt right away if timer cannot be started.      */
+        }
+    }
+#endif
+
+    if (tx_start == DEF_YES) {
+        CPU_CRITICAL_ENTER();
+        p_ctrl->TxInProgress = DEF_YES;
+        CPU_CRITICAL_EXIT();
 
+        USBD_CDC_EEM_TxAggStart(p_ctrl, p_err);
+    } else {
+       *p_err = USBD_ERR_NONE;
+    }
+#else
     CPU_CRITICAL_ENTER();
     tx_in_progress = p_ctrl->TxInProgress;
     if (tx_in_progress == DEF_NO) {
         p_ctrl->TxInProgress = DEF_YES;                         /* Submit buffer if no buffer in Q.                     */
     } else {
-        USBD_CDC_EEM_BufQ_Add(&p_ctrl->TxBufQ,                  /* Add buffer to Q.                                     */
-                               p_buf,
-                               buf_len,
-                               DEF_NO);
+        (void)USBD_CDC_EEM_BufQ_Add(&p_ctrl->TxBufQ,            /* Add buffer to Q.                                     */
+                                     p_buf,
+                                     buf_len,
+                                     DEF_NO);
     }
     CPU_CRITICAL_EXIT();
 
@@ -1803,13 +2496,410 @@ static  void  USBD_CDC_EEM_TxBufSubmit (USBD_CDC_EEM_CTRL  *p_ctrl,
                          (void *)p_ctrl,
                                  DEF_YES,
                                  p_err);
+        if (*p_err == USBD_ERR_NONE) {
+            USBD_CDC_EEM_TxStatUpdate(p_ctrl, 1u);
+        }
+    } else {
+       *p_err = USBD_ERR_NONE;
     }
+#endif
 
     USBD_CDC_EEM_StateUnlock(p_ctrl, &err_unlock);
     (void)err_unlock;
 }
 
 
+/*
+*********************************************************************************************************
+*                                      USBD_CDC_EEM_TxAggStart()
+*
+* Description : Packs the packets at the head of the Tx Q into the aggregation buffer and sends them in a
+*               single bulk IN transfer.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Operation was successful.
+*
+*                               -RETURNED BY USBD_BulkTxAsync()-
+*                               See USBD_BulkTxAsync() for additional return error codes.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) This function must be called with the class instance state locked, after setting the
+*                   'TxInProgress' flag, and with at least one packet in the Tx Q.
+*
+*               (2) CDC-EEM packets are self-delimited by their header, so a bulk IN transfer may carry
+*                   several of them back to back ("Universal Serial Bus Communications Class Subclass
+*                   Specification for Ethernet Emulation Model Devices" revision 1.0, section 5.1).
+*
+*               (3) Packets stay in the Tx Q until the transfer completes, so that the network driver
+*                   gets its buffers back only once they have been sent (see USBD_CDC_EEM_TxCmpl()). A
+*                   packet that does not fit in the aggregation buffer is sent alone, from its own buffer.
+*
+*               (4) Packets queued with 'CrcComputed' set to DEF_NO get their CRC computed with the class
+*                   CRC-32 engine in the same pass as the copy into the aggregation buffer. The CRC of a
+*                   packet sent from its own buffer is computed in place.
+*********************************************************************************************************
+*/
+
+#if (USBD_CDC_EEM_CFG_TX_AGG_EN == DEF_ENABLED)
+static  void  USBD_CDC_EEM_TxAggStart (USBD_CDC_EEM_CTRL  *p_ctrl,
+                                       USBD_ERR           *p_err)
+{
+    USBD_CDC_EEM_BUF_Q      *p_buf_q;
+    USBD_CDC_EEM_BUF_ENTRY  *p_entry;
+    CPU_INT08U              *p_xfer_buf;
+    CPU_INT32U               xfer_len;
+    CPU_INT08U               pkt_cnt;
+    CPU_INT08U               pkt_ix;
+    CPU_INT08U               q_ix;
+    CPU_INT32U               crc;
+    CPU_INT16U               payload_len;
+    CPU_SR_ALLOC();
+
+
+    p_buf_q  = &p_ctrl->TxBufQ;
+    xfer_len =  0u;
+    pkt_cnt  =  0u;
+    q_ix     =  p_buf_q->OutIdx;
+
+    CPU_CRITICAL_ENTER();                                       /* Count pkts that fit in aggregation buf.              */
+    while (pkt_cnt < p_buf_q->Cnt) {
+        p_entry = &p_buf_q->Tbl[q_ix];
+        if ((xfer_len + p_entry->BufLen) > USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN) {
+            break;
+        }
+
+        xfer_len += p_entry->BufLen;
+        pkt_cnt++;
+
+        q_ix++;
+        if (q_ix >= p_buf_q->Size) {
+            q_ix = 0u;
+        }
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (pkt_cnt == 0u) {                                        /* Send oversized pkt from its own buf (see Note #3).   */
+        p_entry    = &p_buf_q->Tbl[p_buf_q->OutIdx];
+        p_xfer_buf =  p_entry->BufPtr;
+        xfer_len   =  p_entry->BufLen;
+        pkt_cnt    =  1u;
+
+        if (p_entry->CrcComputed == DEF_NO) {                   /* Compute CRC in place (see Note #4).                  */
+            crc = p_ctrl->CrcAPI_Ptr->CopyCalc(USBD_CDC_EEM_CRC_INIT,
+                                               DEF_NULL,
+                                              &p_xfer_buf[USBD_CDC_EEM_HDR_LEN],
+                                               xfer_len - USBD_CDC_EEM_HDR_LEN - USBD_CDC_EEM_CRC_LEN);
+            MEM_VAL_SET_INT32U_LITTLE((void *)&p_xfer_buf[xfer_len - USBD_CDC_EEM_CRC_LEN], ~crc);
+        }
+    } else {                                                    /* Pack pkts back to back (see Note #2).                */
+        p_xfer_buf = p_ctrl->TxAggBufPtr;
+        xfer_len   = 0u;
+        q_ix       = p_buf_q->OutIdx;
+
+        for (pkt_ix = 0u; pkt_ix < pkt_cnt; pkt_ix++) {
+            p_entry = &p_buf_q->Tbl[q_ix];
+
+            if (p_entry->CrcComputed == DEF_YES) {
+                Mem_Copy((void *)&p_xfer_buf[xfer_len],
+                         (void *) p_entry->BufPtr,
+                                  p_entry->BufLen);
+            } else {                                            /* Compute CRC while copying payload (see Note #4).     */
+                payload_len = p_entry->BufLen - USBD_CDC_EEM_HDR_LEN - USBD_CDC_EEM_CRC_LEN;
+
+                p_xfer_buf[xfer_len     ] = p_entry->BufPtr[0u];
+                p_xfer_buf[xfer_len + 1u] = p_entry->BufPtr[1u];
+
+                crc = p_ctrl->CrcAPI_Ptr->CopyCalc(USBD_CDC_EEM_CRC_INIT,
+                                                  &p_xfer_buf[xfer_len + USBD_CDC_EEM_HDR_LEN],
+                                                  &p_entry->BufPtr[USBD_CDC_EEM_HDR_LEN],
+                                                   payload_len);
+                MEM_VAL_SET_INT32U_LITTLE((void *)&p_xfer_buf[xfer_len + USBD_CDC_EEM_HDR_LEN + payload_len], ~crc);
+            }
+            xfer_len += p_entry->BufLen;
+
+            q_ix++;
+            if (q_ix >= p_buf_q->Size) {
+                q_ix = 0u;
+            }
+        }
+    }
+
+    p_ctrl->TxAggPktCnt  = pkt_cnt;
+    p_ctrl->TxAggQLen   -= xfer_len;
+
+    USBD_BulkTxAsync(        p_ctrl->DevNbr,
+                             p_ctrl->CommPtr->DataInEpAddr,
+                     (void *)p_xfer_buf,
+                             xfer_len,
+                             USBD_CDC_EEM_TxCmpl,
+                     (void *)p_ctrl,
+                             DEF_YES,
+                             p_err);
+    if (*p_err != USBD_ERR_NONE) {                              /* Leave pkts in Q for next attempt.                    */
+        p_ctrl->TxAggPktCnt  = 0u;
+        p_ctrl->TxAggQLen   += xfer_len;
+
+        CPU_CRITICAL_ENTER();
+        p_ctrl->TxInProgress = DEF_NO;
+        CPU_CRITICAL_EXIT();
+        return;
+    }
+
+    USBD_CDC_EEM_TxStatUpdate(p_ctrl, pkt_cnt);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_CDC_EEM_TxAggTmrCallback()
+*
+* Description : Sends the packets held in the Tx Q when the aggregation flush timer expires.
+*
+* Argument(s) : p_arg       Pointer to class instance control structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Nothing is sent if a transfer is already in progress: the packets will be sent by
+*                   USBD_CDC_EEM_TxCmpl() once it completes.
+*********************************************************************************************************
+*/
+
+#if ((USBD_CDC_EEM_CFG_TX_AGG_EN         == DEF_ENABLED) && \
+     (USBD_CDC_EEM_CFG_TX_AGG_TIMEOUT_MS >  0u))
+static  void  USBD_CDC_EEM_TxAggTmrCallback (void  *p_arg)
+{
+    USBD_CDC_EEM_CTRL  *p_ctrl = (USBD_CDC_EEM_CTRL *)p_arg;
+    CPU_BOOLEAN         tx_start;
+    USBD_ERR            err;
+    CPU_SR_ALLOC();
+
+
+    USBD_CDC_EEM_StateLock(p_ctrl, &err);
+    if (err != USBD_ERR_NONE) {
+        return;
+    }
+
+    p_ctrl->TxAggTmrActive = DEF_NO;
+
+    if ((p_ctrl->State    == USBD_CDC_EEM_STATE_CFG) &&
+        (p_ctrl->StartCnt >  0u)) {
+        CPU_CRITICAL_ENTER();                                   /* See Note #1.                                         */
+        tx_start = ((p_ctrl->TxInProgress == DEF_NO) &&
+                    (p_ctrl->TxBufQ.Cnt   >  0u)) ? DEF_YES : DEF_NO;
+        if (tx_start == DEF_YES) {
+            p_ctrl->TxInProgress = DEF_YES;
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (tx_start == DEF_YES) {
+            USBD_CDC_EEM_TxAggStart(p_ctrl, &err);
+        }
+    }
+
+    USBD_CDC_EEM_StateUnlock(p_ctrl, &err);
+    (void)err;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_CDC_EEM_RxCopy()
+*
+* Description : Copies received data to the current network buffer.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+*               p_dest      Pointer to destination in network buffer.
+*
+*               p_src       Pointer to source in bulk buffer.
+*
+*               len         Number of octets to copy.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) If the CRC of the current frame is verified, the copy is performed by the class CRC-32
+*                   engine, which updates the CRC of the frame in the same pass.
+*********************************************************************************************************
+*/
+
+static  void  USBD_CDC_EEM_RxCopy (USBD_CDC_EEM_CTRL  *p_ctrl,
+                                   CPU_INT08U         *p_dest,
+                                   CPU_INT08U         *p_src,
+                                   CPU_INT16U          len)
+{
+#if (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN == DEF_ENABLED)
+    if (p_ctrl->CurBufCrcChk == DEF_YES) {                      /* See Note #1.                                         */
+        p_ctrl->CurBufCrc = p_ctrl->CrcAPI_Ptr->CopyCalc(p_ctrl->CurBufCrc,
+                                                         p_dest,
+                                                         p_src,
+                                                         len);
+        return;
+    }
+#else
+    (void)p_ctrl;
+#endif
+
+    Mem_Copy((void *)p_dest,
+             (void *)p_src,
+                     len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_CDC_EEM_TxStatUpdate()
+*
+* Description : Accounts a bulk IN transfer in the Tx statistics.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+*               pkt_cnt     Number of CDC-EEM packets carried by the transfer.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) This function must be called with the class instance state locked.
+*********************************************************************************************************
+*/
+
+static  void  USBD_CDC_EEM_TxStatUpdate (USBD_CDC_EEM_CTRL  *p_ctrl,
+                                         CPU_INT08U          pkt_cnt)
+{
+    p_ctrl->TxStat.XferCnt++;
+    p_ctrl->TxStat.PktCnt += pkt_cnt;
+    if (pkt_cnt > p_ctrl->TxStat.PktMaxPerXfer) {
+        p_ctrl->TxStat.PktMaxPerXfer = pkt_cnt;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_CDC_EEM_RxBufIxGet()
+*
+* Description : Gets the index of the pool buffer that contains the given address.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+*               p_buf       Pointer to a location within a receive buffer.
+*
+* Return(s)   : Index of receive buffer, if address belongs to the pool.
+*
+*               USBD_CDC_EEM_RX_BUF_NBR,  otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+static  CPU_INT08U  USBD_CDC_EEM_RxBufIxGet (USBD_CDC_EEM_CTRL  *p_ctrl,
+                                             CPU_INT08U         *p_buf)
+{
+    CPU_INT08U   buf_ix;
+    CPU_INT08U  *p_rx_buf;
+
+
+    for (buf_ix = 0u; buf_ix < USBD_CDC_EEM_RX_BUF_NBR; buf_ix++) {
+        p_rx_buf = p_ctrl->RxBufPtrTbl[buf_ix];
+        if ((p_buf >=  p_rx_buf) &&
+            (p_buf <  &p_rx_buf[USBD_CDC_EEM_CFG_RX_BUF_LEN])) {
+            break;
+        }
+    }
+
+    return (buf_ix);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_CDC_EEM_RxBufFreeGet()
+*
+* Description : Gets a pool buffer that is referenced neither by the class nor by the network driver.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+* Return(s)   : Index of free receive buffer, if any.
+*
+*               USBD_CDC_EEM_RX_BUF_NBR,       otherwise.
+*
+* Note(s)     : (1) This function must be called from within a critical section.
+*********************************************************************************************************
+*/
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+static  CPU_INT08U  USBD_CDC_EEM_RxBufFreeGet (USBD_CDC_EEM_CTRL  *p_ctrl)
+{
+    CPU_INT08U  buf_ix;
+
+
+    for (buf_ix = 0u; buf_ix < USBD_CDC_EEM_RX_BUF_NBR; buf_ix++) {
+        if (p_ctrl->RxBufRefCntTbl[buf_ix] == 0u) {
+            break;
+        }
+    }
+
+    return (buf_ix);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_CDC_EEM_RxBufArm()
+*
+* Description : Submits a pool buffer on the bulk OUT endpoint.
+*
+* Argument(s) : p_ctrl      Pointer to class instance control structure.
+*
+*               buf_ix      Index of receive buffer to submit.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Operation was successful.
+*
+*                               -RETURNED BY USBD_BulkRxAsync()-
+*                               See USBD_BulkRxAsync() for additional return error codes.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) State of CDC-EEM must be locked by caller function.
+*
+*               (2) The caller must have set the buffer's reference count to 1 before calling this
+*                   function. The reference is dropped if the submission fails.
+*********************************************************************************************************
+*/
+
+#if (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN == DEF_ENABLED)
+static  void  USBD_CDC_EEM_RxBufArm (USBD_CDC_EEM_CTRL  *p_ctrl,
+                                     CPU_INT08U          buf_ix,
+                                     USBD_ERR           *p_err)
+{
+    CPU_SR_ALLOC();
+
+
+    USBD_BulkRxAsync(        p_ctrl->DevNbr,
+                             p_ctrl->CommPtr->DataOutEpAddr,
+                             p_ctrl->RxBufPtrTbl[buf_ix],
+                             USBD_CDC_EEM_CFG_RX_BUF_LEN,
+                             USBD_CDC_EEM_RxCmpl,
+                     (void *)p_ctrl,
+                             p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        CPU_CRITICAL_ENTER();                                   /* See Note #2.                                         */
+        p_ctrl->RxBufRefCntTbl[buf_ix] = 0u;
+        CPU_CRITICAL_EXIT();
+    }
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                       USBD_CDC_EEM_BufQ_Add()
@@ -1824,19 +2914,21 @@ static  void  USBD_CDC_EEM_TxBufSubmit (USBD_CDC_EEM_CTRL  *p_ctrl,
 *
 *               crc_computed    Flag that indicates if ethernet CRC is computed in submitted buffer.
 *
-* Return(s)   : None.
+* Return(s)   : DEF_YES, if buffer added to Q.
+*
+*               DEF_NO,  if Q is full.
 *
 * Note(s)     : (1) This function must be called from within a critical section.
 *********************************************************************************************************
 */
 
-static  void  USBD_CDC_EEM_BufQ_Add (USBD_CDC_EEM_BUF_Q  *p_buf_q,
-                                     CPU_INT08U          *p_buf,
-                                     CPU_INT16U           buf_len,
-                                     CPU_BOOLEAN          crc_computed)
+static  CPU_BOOLEAN  USBD_CDC_EEM_BufQ_Add (USBD_CDC_EEM_BUF_Q  *p_buf_q,
+                                            CPU_INT08U          *p_buf,
+                                            CPU_INT16U           buf_len,
+                                            CPU_BOOLEAN          crc_computed)
 {
     if (p_buf_q->Cnt >= p_buf_q->Size) {
-        return;
+        return (DEF_NO);
     }
 
     p_buf_q->Tbl[p_buf_q->InIdx].BufPtr      = p_buf;
@@ -1849,6 +2941,8 @@ static  void  USBD_CDC_EEM_BufQ_Add (USBD_CDC_EEM_BUF_Q  *p_buf_q,
     }
 
     p_buf_q->Cnt++;
+
+    return (DEF_YES);
 }
 
 
@@ -65,6 +65,10 @@
 
 #define  USBD_CDC_EEM_HDR_LEN                              2u   /* CDC EEM data header length.                          */
 
+#define  USBD_CDC_EEM_CRC_LEN                              4u   /* Ethernet CRC length.                                 */
+#define  USBD_CDC_EEM_CRC_INIT                    0xFFFFFFFFu   /* CRC-32 register initial value.                       */
+#define  USBD_CDC_EEM_CRC_RESIDUE                 0xDEBB20E3u   /* CRC-32 register after a frame and its CRC.           */
+
 
 /*
 *********************************************************************************************************
@@ -72,15 +76,48 @@
 *********************************************************************************************************
 */
 
+/*
+*********************************************************************************************************
+*                                     CDC EEM CRC-32 ENGINE API
+*
+* Note(s) : (1) CopyCalc() updates the CRC-32 register 'crc' with 'len' octets read from 'p_src' and
+*               returns the new register value. The register is neither inverted on entry nor on exit :
+*               the class seeds it with USBD_CDC_EEM_CRC_INIT and sends its complement.
+*
+*           (2) If 'p_dest' is not DEF_NULL, CopyCalc() also copies the octets to 'p_dest', in the same
+*               pass. The class relies on this to compute the CRC of received frames while copying them
+*               to the network buffers.
+*
+*           (3) A hardware CRC unit can be plugged in by implementing CopyCalc() on top of it. It must
+*               compute the IEEE 802.3 CRC-32 (polynomial 0x04C11DB7, bit-reflected input and output).
+*               CopyCalc() is called from both the core task and the network driver's Tx context, so
+*               access to a shared unit must be serialized.
+*********************************************************************************************************
+*/
+
+typedef  const  struct  usbd_cdc_eem_crc_api {
+    CPU_INT32U  (*CopyCalc)(       CPU_INT32U   crc,        /* Update CRC and copy buf (see Note #1 & #2).          */
+                                   CPU_INT08U  *p_dest,
+                            const  CPU_INT08U  *p_src,
+                                   CPU_INT32U   len);
+} USBD_CDC_EEM_CRC_API;
+
+
 /*
 *********************************************************************************************************
 *                           CDC EEM CLASS INSTANCE CONFIGURATION STRUCTURE
+*
+* Note(s) : (1) When 'CrcAPI_Ptr' is DEF_NULL, frames submitted without a CRC are sent with the 0xDEADBEEF
+*               sentinel, and received CRCs are never verified. Otherwise, the CRC of these frames is
+*               computed with the given engine (see 'usbd_cdc_eem_crc.h' for software engines), and
+*               received CRCs are verified if 'usbd_cfg.h  USBD_CDC_EEM_CFG_RX_CRC_CHK_EN' is enabled.
 *********************************************************************************************************
 */
 
 typedef  struct  usbd_cdc_eem_cfg {
-    CPU_INT08U  RxBufQSize;                                     /* Size of rx buffer Q.                                 */
-    CPU_INT08U  TxBufQSize;                                     /* Size of tx buffer Q.                                 */
+    CPU_INT08U             RxBufQSize;                          /* Size of rx buffer Q.                                 */
+    CPU_INT08U             TxBufQSize;                          /* Size of tx buffer Q.                                 */
+    USBD_CDC_EEM_CRC_API  *CrcAPI_Ptr;                          /* Ptr to CRC-32 engine (see Note #1).                  */
 } USBD_CDC_EEM_CFG;
 
 
@@ -108,6 +145,22 @@ typedef  const  struct  usbd_cdc_eem_drv {
 } USBD_CDC_EEM_DRV;
 
 
+/*
+*********************************************************************************************************
+*                                     CDC EEM TX STATISTICS STRUCTURE
+*
+* Note(s) : (1) The average number of frames per bulk IN transfer is PktCnt / XferCnt. It is 1 unless
+*               transmit aggregation is enabled (see 'usbd_cfg.h  USBD_CDC_EEM_CFG_TX_AGG_EN').
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_cdc_eem_tx_stat {
+    CPU_INT32U  XferCnt;                                        /* Nbr of bulk IN xfers submitted.                      */
+    CPU_INT32U  PktCnt;                                         /* Nbr of EEM pkts sent in these xfers.                 */
+    CPU_INT16U  PktMaxPerXfer;                                  /* Max nbr of EEM pkts sent in a single xfer.           */
+} USBD_CDC_EEM_TX_STAT;
+
+
 /*
 *********************************************************************************************************
 *                                          GLOBAL VARIABLES
@@ -158,12 +211,20 @@ CPU_INT08U   *USBD_CDC_EEM_RxDataPktGet   (       CPU_INT08U         class_nbr,
                                                   CPU_BOOLEAN       *p_crc_computed,
                                                   USBD_ERR          *p_err);
 
+CPU_BOOLEAN   USBD_CDC_EEM_RxDataPktRelease(      CPU_INT08U         class_nbr,
+                                                  CPU_INT08U        *p_buf,
+                                                  USBD_ERR          *p_err);
+
 void          USBD_CDC_EEM_TxDataPktSubmit(       CPU_INT08U         class_nbr,
                                                   CPU_INT08U        *p_buf,
                                                   CPU_INT32U         buf_len,
                                                   CPU_BOOLEAN        crc_computed,
                                                   USBD_ERR          *p_err);
 
+void          USBD_CDC_EEM_TxStatGet      (       CPU_INT08U         class_nbr,
+                                                  USBD_CDC_EEM_TX_STAT  *p_stat,
+                                                  USBD_ERR          *p_err);
+
 
 /*
 *********************************************************************************************************
@@ -198,6 +259,54 @@ void          USBD_CDC_EEM_TxDataPktSubmit(       CPU_INT08U         class_nbr,
 #endif
 #endif
 
+#ifdef   USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN
+#if    ((USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN != DEF_ENABLED ) && \
+        (USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN != DEF_DISABLED))
+#error  "USBD_CDC_EEM_CFG_RX_ZERO_COPY_EN illegally #define'd in 'usbd_cfg.h'"
+#error  "                                [MUST be  DEF_ENABLED ]            "
+#error  "                                [     ||  DEF_DISABLED]            "
+#endif
+#endif
+
+#ifdef   USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV
+#if     (USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV < 1u)
+#error  "USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV    illegally #define'd in 'usbd_cfg.h'"
+#error  "                                            [MUST be  >= 1]                    "
+#endif
+
+#ifdef   USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV
+#if     (USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV < USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV)
+#error  "USBD_CDC_EEM_CFG_RX_BUF_POOL_QTY_PER_DEV    illegally #define'd in 'usbd_cfg.h'"
+#error  "                                            [MUST be  >= USBD_CDC_EEM_CFG_RX_BUF_QTY_PER_DEV]"
+#endif
+#endif
+#endif
+
+#ifdef   USBD_CDC_EEM_CFG_RX_CRC_CHK_EN
+#if    ((USBD_CDC_EEM_CFG_RX_CRC_CHK_EN != DEF_ENABLED ) && \
+        (USBD_CDC_EEM_CFG_RX_CRC_CHK_EN != DEF_DISABLED))
+#error  "USBD_CDC_EEM_CFG_RX_CRC_CHK_EN   illegally #define'd in 'usbd_cfg.h'"
+#error  "                                [MUST be  DEF_ENABLED ]            "
+#error  "                                [     ||  DEF_DISABLED]            "
+#endif
+#endif
+
+#ifdef   USBD_CDC_EEM_CFG_TX_AGG_EN
+#if    ((USBD_CDC_EEM_CFG_TX_AGG_EN != DEF_ENABLED ) && \
+        (USBD_CDC_EEM_CFG_TX_AGG_EN != DEF_DISABLED))
+#error  "USBD_CDC_EEM_CFG_TX_AGG_EN       illegally #define'd in 'usbd_cfg.h'"
+#error  "                                [MUST be  DEF_ENABLED ]            "
+#error  "                                [     ||  DEF_DISABLED]            "
+#endif
+#endif
+
+#ifdef   USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN
+#if     (USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN < 64u)
+#error  "USBD_CDC_EEM_CFG_TX_AGG_BUF_LEN illegally #define'd in 'usbd_cfg.h'"
+#error  "                                [MUST be  >= 64]                   "
+#endif
+#endif
+
 #ifndef  USBD_CDC_EEM_CFG_ECHO_BUF_LEN
 #error  "USBD_CDC_EEM_CFG_ECHO_BUF_LEN         not #define'd in 'usbd_cfg.h'"
 #error  "                                [MUST be  >= 2u]                   "
@@ -0,0 +1,80 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                USB COMMUNICATIONS DEVICE CLASS (CDC)
+*                                   ETHERNET EMULATION MODEL (EEM)
+*
+*                                       SOFTWARE CRC-32 ENGINE
+*
+* Filename : usbd_cdc_eem_crc.h
+* Version  : V4.06.01
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                               MODULE
+*********************************************************************************************************
+*/
+
+#ifndef  USBD_CDC_EEM_CRC_MODULE_PRESENT
+#define  USBD_CDC_EEM_CRC_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  "usbd_cdc_eem.h"
+
+
+/*
+*********************************************************************************************************
+*                                         CRC-32 ENGINE API(s)
+*
+* Note(s) : (1) USBD_CDC_EEM_CRC_API_Sw picks the fastest implementation available for the compiler
+*               target, at compile time :
+*
+*               (a) ARMv8 CRC32 instructions, if '__ARM_FEATURE_CRC32' is defined.
+*
+*               (b) Carry-less multiply folding, if '__PCLMUL__' and '__SSE4_1__' are defined. Buffers
+*                   shorter than 64 octets and trailing octets are handled as in (c).
+*
+*               (c) Table-driven slice-by-8 otherwise.
+*
+*           (2) USBD_CDC_EEM_CRC_API_Tbl always uses the slice-by-8 implementation.
+*
+*           (3) A hardware CRC unit is plugged by providing a USBD_CDC_EEM_CRC_API structure of its own
+*               (see 'usbd_cdc_eem.h  CDC EEM CRC-32 ENGINE API').
+*********************************************************************************************************
+*/
+
+extern  USBD_CDC_EEM_CRC_API  USBD_CDC_EEM_CRC_API_Sw;          /* See Note #1.                                         */
+extern  USBD_CDC_EEM_CRC_API  USBD_CDC_EEM_CRC_API_Tbl;         /* See Note #2.                                         */
+
+
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif
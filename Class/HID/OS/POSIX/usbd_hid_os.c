@@ -0,0 +1,736 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                USB HID CLASS OPERATING SYSTEM LAYER
+*                                           POSIX (pthreads)
+*
+* Filename : usbd_hid_os.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This port runs the HID class on a host workstation, together with the core POSIX port
+*                ('OS/POSIX/usbd_os.c') and the loopback device controller driver.
+*
+*            (2) Locks and signals are counting semaphores built on a mutex and a CLOCK_MONOTONIC
+*                condition variable, as in the core POSIX port, since the class needs to abort pending
+*                waits. The timer task is a thread. Thread priorities are not set.
+*
+*            (3) The POSIX.1-2008 feature test macro is defined before the first include so that the port
+*                also builds in a strict ISO C compiler mode (e.g. '-std=c11').
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    _POSIX_C_SOURCE                200809L               /* See Note #3.                                         */
+#define    MICRIUM_SOURCE
+#include  "../../../../Source/usbd_core.h"
+#include  "../../usbd_hid_report.h"
+#include  "../../usbd_hid_os.h"
+#include  <pthread.h>
+#include  <errno.h>
+#include  <time.h>
+
+
+/*
+*********************************************************************************************************
+*                                        CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_HID_OS_NS_PER_SEC                   1000000000L
+#define  USBD_HID_OS_NS_PER_MS                       1000000L
+
+#define  USBD_HID_OS_TMR_PERIOD_mS                         4u   /* HID report timer task period.                        */
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*
+* Note(s) : (1) Aborting a semaphore only affects the threads pending on it when the abort occurs. Each
+*               waiter records 'AbortCtr' when it starts pending and returns USBD_ERR_OS_ABORT as soon as
+*               the counter changes.
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_hid_os_sem {
+    pthread_mutex_t   Mutex;
+    pthread_cond_t    Cond;
+    CPU_INT32U        Cnt;                                      /* Semaphore count.                                     */
+    CPU_INT32U        AbortCtr;                                 /* Abort counter (see Note #1).                         */
+} USBD_HID_OS_SEM;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+                                                                /* ---------------- USB HID SEM OBJECTS --------------- */
+static  USBD_HID_OS_SEM  USBD_HID_OS_InputDataSem_Tbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  USBD_HID_OS_SEM  USBD_HID_OS_InputLockSem_Tbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  USBD_HID_OS_SEM  USBD_HID_OS_TxSem_Tbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  USBD_HID_OS_SEM  USBD_HID_OS_OutputLockSem_Tbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  USBD_HID_OS_SEM  USBD_HID_OS_OutputDataSem_Tbl[USBD_HID_CFG_MAX_NBR_DEV];
+
+static  pthread_t        USBD_HID_OS_TmrThread;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL MACRO'S
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void         *USBD_HID_OS_TmrTask  (void             *p_arg);
+
+static  CPU_BOOLEAN   USBD_HID_OS_SemCreate(USBD_HID_OS_SEM  *p_sem,
+                                            CPU_INT32U        cnt);
+
+static  void          USBD_HID_OS_SemPend  (USBD_HID_OS_SEM  *p_sem,
+                                            CPU_INT32U        timeout_ms,
+                                            USBD_ERR         *p_err);
+
+static  void          USBD_HID_OS_SemAbort (USBD_HID_OS_SEM  *p_sem);
+
+static  void          USBD_HID_OS_SemPost  (USBD_HID_OS_SEM  *p_sem);
+
+static  void          USBD_HID_OS_TsAdd    (struct  timespec *p_ts,
+                                            CPU_INT32U        ms);
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_HID_OS_Init()
+*
+* Description : Initialize HID OS interface.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               HID OS initialization successful.
+*                               USBD_ERR_OS_SIGNAL_CREATE   HID OS objects NOT successfully initialized.
+*                               USBD_ERR_OS_INIT_FAIL       HID OS task    NOT successfully initialized.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_Init (USBD_ERR  *p_err)
+{
+    CPU_INT08U   class_nbr;
+    CPU_BOOLEAN  ok;
+    int          os_err;
+
+
+    for (class_nbr = 0; class_nbr < USBD_HID_CFG_MAX_NBR_DEV; class_nbr++) {
+        ok = USBD_HID_OS_SemCreate(&USBD_HID_OS_TxSem_Tbl[class_nbr],             1u);
+        if (ok == DEF_OK) {
+            ok = USBD_HID_OS_SemCreate(&USBD_HID_OS_OutputLockSem_Tbl[class_nbr], 1u);
+        }
+        if (ok == DEF_OK) {
+            ok = USBD_HID_OS_SemCreate(&USBD_HID_OS_OutputDataSem_Tbl[class_nbr], 0u);
+        }
+        if (ok == DEF_OK) {
+            ok = USBD_HID_OS_SemCreate(&USBD_HID_OS_InputLockSem_Tbl[class_nbr],  1u);
+        }
+        if (ok == DEF_OK) {
+            ok = USBD_HID_OS_SemCreate(&USBD_HID_OS_InputDataSem_Tbl[class_nbr],  0u);
+        }
+        if (ok != DEF_OK) {
+           *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+            return;
+        }
+    }
+
+    os_err = pthread_create(&USBD_HID_OS_TmrThread,
+                             DEF_NULL,
+                             USBD_HID_OS_TmrTask,
+                             DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_HID_OS_TmrTask()
+*
+* Description : OS-dependent shell task to process periodic HID input reports.
+*
+* Argument(s) : p_arg       Pointer to task initialization argument.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The task is released every 4 milliseconds against an absolute monotonic deadline, so
+*                   the processing time of each tick does not drift the period.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_HID_OS_TmrTask (void  *p_arg)
+{
+    struct  timespec  ts;
+    int               os_err;
+
+
+   (void)p_arg;                                                 /* Prevent 'variable unused' compiler warning.          */
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    while (DEF_ON) {
+        USBD_HID_OS_TsAdd(&ts, USBD_HID_OS_TMR_PERIOD_mS);      /* See Note #1.                                         */
+        do {
+            os_err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, DEF_NULL);
+        } while (os_err == EINTR);
+
+        USBD_HID_Report_TmrTaskHandler();
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_OS_InputLock()
+*
+* Description : Lock class input report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Class input report successfully locked.
+*                               USBD_ERR_OS_ABORT   Class input report aborted.
+*                               USBD_ERR_OS_FAIL    OS signal not acquired because another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_InputLock (CPU_INT08U   class_nbr,
+                             USBD_ERR    *p_err)
+{
+    USBD_HID_OS_SemPend(&USBD_HID_OS_InputLockSem_Tbl[class_nbr], 0u, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_HID_OS_InputUnlock()
+*
+* Description : Unlock class input report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_InputUnlock (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemPost(&USBD_HID_OS_InputLockSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_HID_OS_OutputDataPendAbort()
+*
+* Description : Abort class output report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_OutputDataPendAbort (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemAbort(&USBD_HID_OS_OutputDataSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_OS_OutputDataPend()
+*
+* Description : Wait for output report data transfer to complete.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+*               timeout_ms  Signal wait timeout, in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Class output successfully locked.
+*                               USBD_ERR_OS_ABORT   Class output aborted.
+*                               USBD_ERR_OS_FAIL    OS signal not acquired because another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) As in the uC/OS ports, a timeout is reported as USBD_ERR_OS_FAIL.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_OutputDataPend (CPU_INT08U   class_nbr,
+                                  CPU_INT16U   timeout_ms,
+                                  USBD_ERR    *p_err)
+{
+    USBD_HID_OS_SemPend(&USBD_HID_OS_OutputDataSem_Tbl[class_nbr], timeout_ms, p_err);
+    if (*p_err == USBD_ERR_OS_TIMEOUT) {                        /* See Note #1.                                         */
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_OS_OutputDataPost()
+*
+* Description : Signal that output report data is available.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_OutputDataPost (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemPost(&USBD_HID_OS_OutputDataSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_HID_OS_OutputLock()
+*
+* Description : Lock class output report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Class output successfully locked.
+*                               USBD_ERR_OS_ABORT   Class output aborted.
+*                               USBD_ERR_OS_FAIL    OS signal not acquired because another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_OutputLock (CPU_INT08U   class_nbr,
+                              USBD_ERR    *p_err)
+{
+    USBD_HID_OS_SemPend(&USBD_HID_OS_OutputLockSem_Tbl[class_nbr], 0u, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_OS_OutputUnlock()
+*
+* Description : Unlock class output report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_OutputUnlock (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemPost(&USBD_HID_OS_OutputLockSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_HID_OS_TxLock()
+*
+* Description : Lock class transmit.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Class feature report successfully locked.
+*                               USBD_ERR_OS_ABORT   Class feature report aborted.
+*                               USBD_ERR_OS_FAIL    OS signal not acquired because another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_TxLock (CPU_INT08U   class_nbr,
+                          USBD_ERR    *p_err)
+{
+    USBD_HID_OS_SemPend(&USBD_HID_OS_TxSem_Tbl[class_nbr], 0u, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_OS_TxUnlock()
+*
+* Description : Unlock class transmit.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_TxUnlock (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemPost(&USBD_HID_OS_TxSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_OS_InputDataPend()
+*
+* Description : Wait for input report data transfer to complete.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+*               timeout_ms  Signal wait timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           OS signal     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     OS signal NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_ABORT       OS signal aborted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_InputDataPend (CPU_INT08U   class_nbr,
+                                 CPU_INT16U   timeout_ms,
+                                 USBD_ERR    *p_err)
+{
+    USBD_HID_OS_SemPend(&USBD_HID_OS_InputDataSem_Tbl[class_nbr], timeout_ms, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                  USBD_HID_OS_InputDataPendAbort()
+*
+* Description : Abort any operation on input report.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_InputDataPendAbort (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemAbort(&USBD_HID_OS_InputDataSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_OS_InputDataPost()
+*
+* Description : Signal that input report data transfer has completed.
+*
+* Argument(s) : class_nbr   Class instance number.
+*               ---------   Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_OS_InputDataPost (CPU_INT08U  class_nbr)
+{
+    USBD_HID_OS_SemPost(&USBD_HID_OS_InputDataSem_Tbl[class_nbr]);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_OS_SemCreate()
+*
+* Description : Create a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+*               cnt         Initial count.
+*
+* Return(s)   : DEF_OK,   if NO error(s).
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_HID_OS_SemCreate (USBD_HID_OS_SEM  *p_sem,
+                                            CPU_INT32U        cnt)
+{
+    pthread_condattr_t  attr;
+    int                 os_err;
+
+
+    os_err = pthread_mutex_init(&p_sem->Mutex, DEF_NULL);
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    os_err = pthread_condattr_init(&attr);
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    os_err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (os_err == 0) {
+        os_err = pthread_cond_init(&p_sem->Cond, &attr);
+    }
+    (void)pthread_condattr_destroy(&attr);
+
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    p_sem->Cnt      = cnt;
+    p_sem->AbortCtr = 0u;
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_HID_OS_SemPend()
+*
+* Description : Wait for a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Semaphore     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     Semaphore NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_ABORT       Semaphore aborted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #1'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_OS_SemPend (USBD_HID_OS_SEM  *p_sem,
+                                   CPU_INT32U        timeout_ms,
+                                   USBD_ERR         *p_err)
+{
+    struct  timespec  ts;
+    CPU_INT32U        abort_ctr;
+    int               os_err;
+
+
+    if (timeout_ms != 0u) {
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        USBD_HID_OS_TsAdd(&ts, timeout_ms);
+    }
+
+    os_err = 0;
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    abort_ctr = p_sem->AbortCtr;                                /* See Note #1.                                         */
+    while ((p_sem->Cnt      == 0u)        &&
+           (p_sem->AbortCtr == abort_ctr) &&
+           (os_err          == 0)) {
+        if (timeout_ms == 0u) {
+            os_err = pthread_cond_wait(&p_sem->Cond, &p_sem->Mutex);
+        } else {
+            os_err = pthread_cond_timedwait(&p_sem->Cond, &p_sem->Mutex, &ts);
+        }
+    }
+
+    if (p_sem->AbortCtr != abort_ctr) {
+       *p_err = USBD_ERR_OS_ABORT;
+    } else if (p_sem->Cnt > 0u) {
+        p_sem->Cnt--;
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_TIMEOUT;
+    }
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_OS_SemAbort()
+*
+* Description : Abort any wait operation on a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #1'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_OS_SemAbort (USBD_HID_OS_SEM  *p_sem)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->AbortCtr++;
+    (void)pthread_cond_broadcast(&p_sem->Cond);
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_HID_OS_SemPost()
+*
+* Description : Signal a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_OS_SemPost (USBD_HID_OS_SEM  *p_sem)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->Cnt++;
+    (void)pthread_cond_signal(&p_sem->Cond);
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_HID_OS_TsAdd()
+*
+* Description : Add a number of milliseconds to a time specification.
+*
+* Argument(s) : p_ts        Pointer to time specification.
+*
+*               ms          Number of milliseconds to add.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_OS_TsAdd (struct  timespec  *p_ts,
+                                 CPU_INT32U         ms)
+{
+    p_ts->tv_sec  += (time_t)(ms / 1000u);
+    p_ts->tv_nsec += (long  )(ms % 1000u) * USBD_HID_OS_NS_PER_MS;
+    if (p_ts->tv_nsec >= USBD_HID_OS_NS_PER_SEC) {
+        p_ts->tv_sec  += 1;
+        p_ts->tv_nsec -= USBD_HID_OS_NS_PER_SEC;
+    }
+}
@@ -133,6 +133,24 @@ typedef struct usbd_hid_comm {
 } USBD_HID_COMM;
 
 
+/*
+*********************************************************************************************************
+*                                   HID CLASS CONTROL INFO DATA TYPE
+*
+* Note(s) : (1) The input report queue is a ring of USBD_HID_CFG_INPUT_Q_DEPTH report buffers. While
+*               'InputQ_TxActive' is set, the oldest queued report is being sent and the class holds the
+*               transmit lock. The transfer completion then sends the next queued report, if any, or
+*               releases the lock.
+*
+*               (a) Reports are copied outside of critical sections. Writers are serialized by the input
+*                   lock and append at the tail of the ring, past the reports seen by the completion. The
+*                   completion and the flush move 'InputQ_IxOut' and 'InputQ_Cnt' without moving the tail.
+*
+*               (b) A queued report overwritten by coalescing is marked busy while it is copied. If the
+*                   completion reaches it, 'InputQ_TxDefer' is set and the writer sends it once copied.
+*********************************************************************************************************
+*/
+
 struct usbd_hid_ctrl {                                          /* ----------------- HID CLASS CTRL INFO -------------- */
     CPU_INT08U              DevNbr;                             /* Dev   nbr.                                           */
     CPU_INT08U              ClassNbr;                           /* Class nbr.                                           */
@@ -162,6 +180,18 @@ struct usbd_hid_ctrl {                                          /* -------------
     CPU_BOOLEAN             IsRx;
 
     CPU_INT08U             *CtrlStatusBufPtr;                   /* Buf used for ctrl status xfers.                      */
+
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)                    /* ---------- INPUT REPORT Q (see Note #1) ------------ */
+    CPU_INT08U             *InputQ_BufTbl[USBD_HID_CFG_INPUT_Q_DEPTH];
+    CPU_INT16U              InputQ_LenTbl[USBD_HID_CFG_INPUT_Q_DEPTH];
+    CPU_INT08U              InputQ_IxOut;                       /* Ix of oldest queued report.                          */
+    CPU_INT08U              InputQ_Cnt;                         /* Nbr of queued reports, incl the one being sent.      */
+    CPU_BOOLEAN             InputQ_TxActive;                    /* Oldest queued report being sent.                     */
+    CPU_BOOLEAN             InputQ_WrBusy;                      /* Queued report being overwritten (see Note #1b).      */
+    CPU_INT08U              InputQ_IxWr;                        /* Ix of report being overwritten.                      */
+    CPU_BOOLEAN             InputQ_TxDefer;                     /* Xfer of report being overwritten deferred.           */
+    USBD_HID_INPUT_Q_STAT   InputQ_Stat;
+#endif
 };
 
 
@@ -273,6 +303,21 @@ static  void         USBD_HID_OutputDataCmpl  (       CPU_INT08U       class_nbr
                                                       void            *p_arg,
                                                       USBD_ERR         err);
 
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+static  void         USBD_HID_InputQ_TxStart  (       USBD_HID_CTRL   *p_ctrl,
+                                                      USBD_ERR        *p_err);
+
+static  void         USBD_HID_InputQ_TxCmpl   (       CPU_INT08U       dev_nbr,
+                                                      CPU_INT08U       ep_addr,
+                                                      void            *p_buf,
+                                                      CPU_INT32U       buf_len,
+                                                      CPU_INT32U       xfer_len,
+                                                      void            *p_arg,
+                                                      USBD_ERR         err);
+
+static  void         USBD_HID_InputQ_Flush    (       USBD_HID_CTRL   *p_ctrl);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -378,6 +423,17 @@ void  USBD_HID_Init (USBD_ERR  *p_err)
         p_ctrl->IntrRdAsyncFnct   = (USBD_HID_ASYNC_FNCT)0;
         p_ctrl->IntrRdAsyncArgPtr = (void              *)0;
 
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+        Mem_Clr((void *)p_ctrl->InputQ_BufTbl, sizeof(p_ctrl->InputQ_BufTbl));
+        p_ctrl->InputQ_IxOut      =  0u;
+        p_ctrl->InputQ_Cnt        =  0u;
+        p_ctrl->InputQ_TxActive   =  DEF_NO;
+        p_ctrl->InputQ_WrBusy     =  DEF_NO;
+        p_ctrl->InputQ_IxWr       =  0u;
+        p_ctrl->InputQ_TxDefer    =  DEF_NO;
+        Mem_Clr((void *)&p_ctrl->InputQ_Stat, sizeof(USBD_HID_INPUT_Q_STAT));
+#endif
+
         p_ctrl->CtrlStatusBufPtr  = (CPU_INT08U *)Mem_HeapAlloc(              sizeof(CPU_ADDR),
                                                                               USBD_CFG_BUF_ALIGN_OCTETS,
                                                                 (CPU_SIZE_T *)DEF_NULL,
@@ -544,9 +600,28 @@ CPU_INT08U  USBD_HID_Add (CPU_INT08U              subclass,
                           p_err);
     if (*p_err != USBD_ERR_NONE) {
         return (USBD_CLASS_NBR_NONE);
-    } else {
-        return (class_nbr);
     }
+
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)                    /* ----------- ALLOC INPUT REPORT Q BUFS -------------- */
+    if (p_ctrl->Report.MaxInputReportSize > 0u) {
+        CPU_INT08U  ix;
+        LIB_ERR     err_lib;
+
+
+        for (ix = 0u; ix < USBD_HID_CFG_INPUT_Q_DEPTH; ix++) {
+            p_ctrl->InputQ_BufTbl[ix] = (CPU_INT08U *)Mem_HeapAlloc(              p_ctrl->Report.MaxInputReportSize,
+                                                                                  USBD_CFG_BUF_ALIGN_OCTETS,
+                                                                    (CPU_SIZE_T *)DEF_NULL,
+                                                                                 &err_lib);
+            if (err_lib != LIB_MEM_ERR_NONE) {
+               *p_err = USBD_ERR_ALLOC;
+                return (USBD_CLASS_NBR_NONE);
+            }
+        }
+    }
+#endif
+
+    return (class_nbr);
 }
 
 
@@ -1383,6 +1458,275 @@ void  USBD_HID_WrAsync (CPU_INT08U            class_nbr,
 }
 
 
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                        USBD_HID_InputQ_Wr()
+*
+* Description : Queue an input report to be sent to host through Interrupt IN endpoint. This function
+*               returns without waiting for the report to be sent.
+*
+* Argument(s) : class_nbr       Class instance number.
+*
+*               p_buf           Pointer to report buffer. If more than one input report exists, the first
+*                               byte must represent the Report ID.
+*
+*               buf_len         Report buffer length, in octets.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                   Report successfully queued or coalesced.
+*                               USBD_ERR_NULL_PTR               Argument 'p_buf' passed a NULL pointer.
+*                               USBD_ERR_INVALID_ARG            Invalid argument(s) passed to 'buf_len'.
+*                               USBD_ERR_CLASS_INVALID_NBR      Invalid argument(s) passed to 'class_nbr'.
+*                               USBD_ERR_INVALID_CLASS_STATE    Invalid class state.
+*                               USBD_ERR_HID_INPUT_Q_FULL       Report dropped (see Note #2).
+*
+*                                                               ------ RETURNED BY USBD_IntrTxAsync() : -----
+*                               USBD_ERR_DEV_INVALID_STATE      Transfer type only available if device is in
+*                                                                   configured state.
+*                               USBD_ERR_EP_INVALID_STATE       Endpoint not opened.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The report is copied, so the buffer can be reused as soon as this function returns. If
+*                   no report is being sent, the transfer of the oldest queued report is started, after
+*                   waiting for a transfer started by USBD_HID_Wr() or USBD_HID_WrAsync() to complete.
+*
+*               (2) When the queue is full, the report replaces the most recent queued report with the
+*                   same report ID that is not being sent. Otherwise, it is dropped. See 'usbd_cfg.h  HID
+*                   CLASS CONFIGURATION  Note #2'.
+*
+*               (3) The input lock is held while the report is queued, and the report is copied outside
+*                   of critical sections. The transfer completion never starts sending a partially copied
+*                   report (see 'HID CLASS CONTROL INFO DATA TYPE  Note #1').
+*********************************************************************************************************
+*/
+
+void  USBD_HID_InputQ_Wr (CPU_INT08U   class_nbr,
+                          void        *p_buf,
+                          CPU_INT32U   buf_len,
+                          USBD_ERR    *p_err)
+{
+    USBD_HID_CTRL  *p_ctrl;
+    CPU_INT08U     *p_buf_data;
+    CPU_INT08U     *p_buf_report;
+    CPU_INT08U     *p_buf_q;
+    CPU_INT08U      report_id;
+    CPU_INT16U      report_len;
+    CPU_INT08U      ix;
+    CPU_INT08U      ix_first;
+    CPU_INT08U      cnt;
+    CPU_BOOLEAN     is_largest;
+    CPU_BOOLEAN     conn;
+    CPU_BOOLEAN     tx_start;
+    CPU_BOOLEAN     tx_defer;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (p_buf == (void *)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    if (class_nbr >= USBD_HID_CtrlNbrNext) {
+       *p_err = USBD_ERR_CLASS_INVALID_NBR;
+        return;
+    }
+
+    p_ctrl = &USBD_HID_CtrlTbl[class_nbr];
+
+    conn = USBD_HID_IsConn(class_nbr);
+    if (conn != DEF_YES) {                                      /* Chk class state.                                     */
+       *p_err = USBD_ERR_INVALID_CLASS_STATE;
+        return;
+    }
+
+    if (buf_len == 0u) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_buf_data = (CPU_INT08U *)p_buf;
+    if (p_ctrl->Report.HasReports == DEF_YES) {
+        report_id = p_buf_data[0];
+    } else {
+        report_id = 0u;
+    }
+
+    report_len = USBD_HID_ReportID_InfoGet(&p_ctrl->Report,
+                                            USBD_HID_REPORT_TYPE_INPUT,
+                                            report_id,
+                                           &p_buf_report,
+                                           &is_largest,
+                                            p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if (report_len > buf_len) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    USBD_HID_OS_InputLock(class_nbr, p_err);                    /* See Note #3.                                         */
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+                                                                /* Update report returned by GET_REPORT req.            */
+    Mem_Copy(&p_buf_report[0], &p_buf_data[0], report_len);
+
+                                                                /* ------------------ QUEUE REPORT -------------------- */
+    tx_start = DEF_NO;
+    tx_defer = DEF_NO;
+   *p_err    = USBD_ERR_NONE;
+
+    CPU_CRITICAL_ENTER();
+    p_ctrl->InputQ_Stat.ReportCnt++;
+
+    cnt = p_ctrl->InputQ_Cnt;
+    if (cnt < USBD_HID_CFG_INPUT_Q_DEPTH) {                     /* Append report to q.                                  */
+        ix = (CPU_INT08U)(((CPU_INT16U)p_ctrl->InputQ_IxOut + cnt) % USBD_HID_CFG_INPUT_Q_DEPTH);
+        CPU_CRITICAL_EXIT();
+                                                                /* Tail not moved by xfer cmpl (see Note #3).           */
+        Mem_Copy(p_ctrl->InputQ_BufTbl[ix], &p_buf_data[0], report_len);
+
+        CPU_CRITICAL_ENTER();
+        p_ctrl->InputQ_LenTbl[ix] = report_len;
+        cnt                       = p_ctrl->InputQ_Cnt + 1u;
+        p_ctrl->InputQ_Cnt        = cnt;
+        if (cnt > p_ctrl->InputQ_Stat.LvlMax) {
+            p_ctrl->InputQ_Stat.LvlMax = cnt;
+        }
+
+        if (p_ctrl->InputQ_TxActive == DEF_NO) {
+            p_ctrl->InputQ_TxActive = DEF_YES;
+            tx_start                = DEF_YES;
+        }
+        CPU_CRITICAL_EXIT();
+    } else {                                                    /* Coalesce with queued report (see Note #2).           */
+        ix_first = (p_ctrl->InputQ_TxActive == DEF_YES) ? 1u : 0u;
+        p_buf_q  = (CPU_INT08U *)0;
+        while (cnt > ix_first) {
+            cnt--;
+            ix = (CPU_INT08U)(((CPU_INT16U)p_ctrl->InputQ_IxOut + cnt) % USBD_HID_CFG_INPUT_Q_DEPTH);
+            if ((p_ctrl->Report.HasReports  == DEF_NO) ||
+                (p_ctrl->InputQ_BufTbl[ix][0] == report_id)) {
+                p_buf_q = p_ctrl->InputQ_BufTbl[ix];
+                break;
+            }
+        }
+
+        if (p_buf_q != (CPU_INT08U *)0) {
+            p_ctrl->InputQ_WrBusy = DEF_YES;                    /* Mark report busy while copied.                       */
+            p_ctrl->InputQ_IxWr   = ix;
+            CPU_CRITICAL_EXIT();
+
+            Mem_Copy(p_buf_q, &p_buf_data[0], report_len);
+
+            CPU_CRITICAL_ENTER();
+            p_ctrl->InputQ_LenTbl[ix] = report_len;
+            p_ctrl->InputQ_WrBusy     = DEF_NO;
+            p_ctrl->InputQ_Stat.CoalescedCnt++;
+            if (p_ctrl->InputQ_TxDefer == DEF_YES) {            /* Send report the xfer cmpl skipped.                   */
+                p_ctrl->InputQ_TxDefer = DEF_NO;
+                tx_start               = DEF_YES;
+                tx_defer               = DEF_YES;
+            }
+            CPU_CRITICAL_EXIT();
+        } else {
+            p_ctrl->InputQ_Stat.DroppedCnt++;
+            CPU_CRITICAL_EXIT();
+           *p_err = USBD_ERR_HID_INPUT_Q_FULL;
+        }
+    }
+    USBD_HID_OS_InputUnlock(class_nbr);
+
+    if (tx_start == DEF_NO) {
+        return;
+    }
+                                                                /* ---------------- START REPORT XFER ----------------- */
+    if (tx_defer == DEF_NO) {                                   /* Tx lock already held by a deferred xfer.             */
+        USBD_HID_OS_TxLock(class_nbr, p_err);                   /* See Note #1.                                         */
+        if (*p_err != USBD_ERR_NONE) {
+            CPU_CRITICAL_ENTER();
+            p_ctrl->InputQ_TxActive = DEF_NO;
+            CPU_CRITICAL_EXIT();
+            return;
+        }
+    }
+
+    USBD_HID_InputQ_TxStart(p_ctrl, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        USBD_HID_InputQ_Flush(p_ctrl);
+        USBD_HID_OS_TxUnlock(class_nbr);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_HID_InputQ_StatGet()
+*
+* Description : Get the input report queue statistics of a class instance.
+*
+* Argument(s) : class_nbr       Class instance number.
+*
+*               p_stat          Pointer to structure that will receive the statistics.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                   Statistics successfully retrieved.
+*                               USBD_ERR_NULL_PTR               Argument 'p_stat' passed a NULL pointer.
+*                               USBD_ERR_CLASS_INVALID_NBR      Invalid argument(s) passed to 'class_nbr'.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Statistics are accumulated since the class instance was added.
+*********************************************************************************************************
+*/
+
+void  USBD_HID_InputQ_StatGet (CPU_INT08U              class_nbr,
+                               USBD_HID_INPUT_Q_STAT  *p_stat,
+                               USBD_ERR               *p_err)
+{
+    USBD_HID_CTRL  *p_ctrl;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (p_stat == (USBD_HID_INPUT_Q_STAT *)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    if (class_nbr >= USBD_HID_CtrlNbrNext) {
+       *p_err = USBD_ERR_CLASS_INVALID_NBR;
+        return;
+    }
+
+    p_ctrl = &USBD_HID_CtrlTbl[class_nbr];
+
+    CPU_CRITICAL_ENTER();
+   *p_stat = p_ctrl->InputQ_Stat;
+    CPU_CRITICAL_EXIT();
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -2484,3 +2828,193 @@ static  void  USBD_HID_WrSyncCmpl (CPU_INT08U   dev_nbr,
         USBD_HID_OS_InputDataPendAbort(class_nbr);
     }
 }
+
+
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                      USBD_HID_InputQ_TxStart()
+*
+* Description : Start the transfer of the oldest queued input report.
+*
+* Argument(s) : p_ctrl      Pointer to HID class control info.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                   Transfer successfully started.
+*                               USBD_ERR_INVALID_CLASS_STATE    Class instance disconnected.
+*
+*                                                               ----- RETURNED BY USBD_IntrTxAsync() : -----
+*                               See USBD_IntrTxAsync() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The caller holds the transmit lock and has set 'InputQ_TxActive'.
+*
+*               (2) As in USBD_HID_WrAsync(), the transfer is ended by a zero-length packet only when
+*                   the report is shorter than the largest input report.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_InputQ_TxStart (USBD_HID_CTRL  *p_ctrl,
+                                       USBD_ERR       *p_err)
+{
+    USBD_HID_COMM  *p_comm;
+    CPU_INT08U     *p_buf;
+    CPU_INT16U      len;
+    CPU_BOOLEAN     eot;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_comm = p_ctrl->CommPtr;
+    p_buf  = p_ctrl->InputQ_BufTbl[p_ctrl->InputQ_IxOut];
+    len    = p_ctrl->InputQ_LenTbl[p_ctrl->InputQ_IxOut];
+    CPU_CRITICAL_EXIT();
+
+    if (p_comm == (USBD_HID_COMM *)0) {
+       *p_err = USBD_ERR_INVALID_CLASS_STATE;
+        return;
+    }
+                                                                /* See Note #2.                                         */
+    eot = (len == p_ctrl->Report.MaxInputReportSize) ? DEF_NO : DEF_YES;
+
+    USBD_IntrTxAsync(        p_ctrl->DevNbr,
+                             p_comm->DataIntrInEpAddr,
+                             p_buf,
+                             len,
+                             USBD_HID_InputQ_TxCmpl,
+                     (void *)p_comm,
+                             eot,
+                             p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_HID_InputQ_TxCmpl()
+*
+* Description : Inform the class about the completion of an input report transfer.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to the transmit buffer.
+*
+*               buf_len     Transmit buffer length.
+*
+*               xfer_len    Number of octets sent.
+*
+*               p_arg       Pointer to HID class communication info.
+*
+*               err         Transfer status: success or error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The next queued report, if any, is sent right away, so that a transfer is armed for
+*                   the next polling interval. The transmit lock is kept until the queue is empty.
+*
+*               (2) On a transfer error, e.g. when the endpoint is aborted on disconnection, the queued
+*                   reports are dropped.
+*
+*               (3) The next queued report is being overwritten by USBD_HID_InputQ_Wr(), which sends it
+*                   once copied. The transmit lock is kept for that transfer.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_InputQ_TxCmpl (CPU_INT08U   dev_nbr,
+                                      CPU_INT08U   ep_addr,
+                                      void        *p_buf,
+                                      CPU_INT32U   buf_len,
+                                      CPU_INT32U   xfer_len,
+                                      void        *p_arg,
+                                      USBD_ERR     err)
+{
+    USBD_HID_COMM  *p_comm;
+    USBD_HID_CTRL  *p_ctrl;
+    CPU_BOOLEAN     tx_next;
+    USBD_ERR        err_tx;
+    CPU_SR_ALLOC();
+
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)p_buf;
+    (void)buf_len;
+    (void)xfer_len;
+
+    p_comm = (USBD_HID_COMM *)p_arg;
+    p_ctrl = (USBD_HID_CTRL *)p_comm->CtrlPtr;
+
+    CPU_CRITICAL_ENTER();                                       /* Remove sent report from q.                           */
+    p_ctrl->InputQ_IxOut = (CPU_INT08U)(((CPU_INT16U)p_ctrl->InputQ_IxOut + 1u) % USBD_HID_CFG_INPUT_Q_DEPTH);
+    p_ctrl->InputQ_Cnt--;
+    if (err == USBD_ERR_NONE) {
+        p_ctrl->InputQ_Stat.XferCnt++;
+    } else {
+        p_ctrl->InputQ_Stat.DroppedCnt++;
+    }
+    tx_next = DEF_NO;
+    if (err == USBD_ERR_NONE) {
+        if (p_ctrl->InputQ_Cnt == 0u) {
+            p_ctrl->InputQ_TxActive = DEF_NO;                   /* Next report queued starts a new xfer.                */
+        } else if ((p_ctrl->InputQ_WrBusy == DEF_YES) &&
+                   (p_ctrl->InputQ_IxWr   == p_ctrl->InputQ_IxOut)) {
+            p_ctrl->InputQ_TxDefer = DEF_YES;                   /* See Note #3.                                         */
+            CPU_CRITICAL_EXIT();
+            return;
+        } else {
+            tx_next = DEF_YES;
+        }
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (tx_next == DEF_YES) {                                   /* See Note #1.                                         */
+        USBD_HID_InputQ_TxStart(p_ctrl, &err_tx);
+        if (err_tx == USBD_ERR_NONE) {
+            return;
+        }
+        USBD_HID_InputQ_Flush(p_ctrl);
+    } else if (err != USBD_ERR_NONE) {
+        USBD_HID_InputQ_Flush(p_ctrl);                          /* See Note #2.                                         */
+    } else {
+        ;
+    }
+
+    USBD_HID_OS_TxUnlock(p_ctrl->ClassNbr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_InputQ_Flush()
+*
+* Description : Drop all queued input reports and end the input report transfers.
+*
+* Argument(s) : p_ctrl      Pointer to HID class control info.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The caller holds the transmit lock and releases it afterwards.
+*
+*               (2) A report being appended by USBD_HID_InputQ_Wr() is copied at the tail of the queue
+*                   (see 'HID CLASS CONTROL INFO DATA TYPE  Note #1a').
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_InputQ_Flush (USBD_HID_CTRL  *p_ctrl)
+{
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_ctrl->InputQ_Stat.DroppedCnt += p_ctrl->InputQ_Cnt;       /* Drop reports without moving q tail (see Note #2).    */
+    p_ctrl->InputQ_IxOut            = (CPU_INT08U)(((CPU_INT16U)p_ctrl->InputQ_IxOut + p_ctrl->InputQ_Cnt) %
+                                                   USBD_HID_CFG_INPUT_Q_DEPTH);
+    p_ctrl->InputQ_Cnt              = 0u;
+    p_ctrl->InputQ_TxActive         = DEF_NO;
+    p_ctrl->InputQ_TxDefer          = DEF_NO;
+    CPU_CRITICAL_EXIT();
+}
+#endif
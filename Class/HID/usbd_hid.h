@@ -178,6 +178,26 @@ typedef  const  struct  usbd_hid_callback {
 } USBD_HID_CALLBACK;
 
 
+/*
+*********************************************************************************************************
+*                                   HID INPUT QUEUE STATISTICS STRUCTURE
+*
+* Note(s) : (1) Every report accepted by USBD_HID_InputQ_Wr() is counted in ReportCnt, and is either sent,
+*               coalesced with a later report of the same report ID, or dropped (see 'usbd_cfg.h  HID CLASS
+*               CONFIGURATION  Note #2'). Reports still queued when the class is disconnected or when a
+*               transfer fails are counted as dropped.
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_hid_input_q_stat {
+    CPU_INT32U  ReportCnt;                                      /* Nbr of reports accepted by input q.                  */
+    CPU_INT32U  XferCnt;                                        /* Nbr of reports sent to host.                         */
+    CPU_INT32U  CoalescedCnt;                                   /* Nbr of reports replaced by a more recent one.        */
+    CPU_INT32U  DroppedCnt;                                     /* Nbr of reports dropped.                              */
+    CPU_INT08U  LvlMax;                                         /* Max nbr of reports queued at once.                   */
+} USBD_HID_INPUT_Q_STAT;
+
+
 /*
 *********************************************************************************************************
 *                                          GLOBAL VARIABLES
@@ -248,6 +268,17 @@ void         USBD_HID_RdAsync(CPU_INT08U              class_nbr,
                               void                   *p_async_arg,
                               USBD_ERR               *p_err);
 
+#if (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+void         USBD_HID_InputQ_Wr     (CPU_INT08U              class_nbr,
+                                     void                   *p_buf,
+                                     CPU_INT32U              buf_len,
+                                     USBD_ERR               *p_err);
+
+void         USBD_HID_InputQ_StatGet(CPU_INT08U              class_nbr,
+                                     USBD_HID_INPUT_Q_STAT  *p_stat,
+                                     USBD_ERR               *p_err);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -255,6 +286,24 @@ void         USBD_HID_RdAsync(CPU_INT08U              class_nbr,
 *********************************************************************************************************
 */
 
+#ifndef  USBD_HID_CFG_INPUT_Q_EN
+#error  "USBD_HID_CFG_INPUT_Q_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+
+#elif  ((USBD_HID_CFG_INPUT_Q_EN != DEF_ENABLED ) && \
+        (USBD_HID_CFG_INPUT_Q_EN != DEF_DISABLED))
+#error  "USBD_HID_CFG_INPUT_Q_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+
+#elif   (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED)
+#ifndef  USBD_HID_CFG_INPUT_Q_DEPTH
+#error  "USBD_HID_CFG_INPUT_Q_DEPTH not #define'd in 'usbd_cfg.h' [MUST be >= 1 and <= 255]"
+
+#elif  ((USBD_HID_CFG_INPUT_Q_DEPTH < 1u) || \
+        (USBD_HID_CFG_INPUT_Q_DEPTH > 255u))
+#error  "USBD_HID_CFG_INPUT_Q_DEPTH illegally #define'd in 'usbd_cfg.h' [MUST be >= 1 and <= 255]"
+#endif
+#endif
+
+
 
 /*
 *********************************************************************************************************
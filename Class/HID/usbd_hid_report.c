@@ -40,6 +40,17 @@
 /*
 *********************************************************************************************************
 *                                            LOCAL DEFINES
+*
+* Note(s) : (1) Input reports with an idle rate are kept in a two-level timer wheel. The lower level holds
+*               the reports due within the next USBD_HID_REPORT_TMR_NBR_SLOTS ticks, one slot per tick. The
+*               upper level holds the later ones, one slot per USBD_HID_REPORT_TMR_NBR_SLOTS ticks, and each
+*               of its slots is moved down to the lower level when the wheel reaches it. As the idle rate
+*               is at most 255 ticks, two levels of 16 slots cover all the rates.
+*
+*           (2) Each HID report structure has a table giving, for each report type and report ID up to the
+*               highest ID of the report descriptor, the index plus one of the report ID structure in
+*               USBD_HID_ReportID_Tbl[], or 0 if the report does not exist. Report ID structures are thus
+*               found in constant time when parsing the report descriptor and handling class requests.
 *********************************************************************************************************
 */
 
@@ -50,6 +61,12 @@
 #define  USBD_HID_IDLE_INFINITE                         0x00u
 #define  USBD_HID_IDLE_ALL_REPORT                       0x00u
 
+                                                                /* Idle report timer wheel (see Note #1).               */
+#define  USBD_HID_REPORT_TMR_NBR_LVL                       2u
+#define  USBD_HID_REPORT_TMR_SLOT_NBR_BITS                 4u
+#define  USBD_HID_REPORT_TMR_NBR_SLOTS                  (1u << USBD_HID_REPORT_TMR_SLOT_NBR_BITS)
+#define  USBD_HID_REPORT_TMR_SLOT_MASK                  (USBD_HID_REPORT_TMR_NBR_SLOTS - 1u)
+
 
 /*
 *********************************************************************************************************
@@ -94,7 +111,15 @@ static  USBD_HID_REPORT_ID   USBD_HID_ReportID_Tbl[USBD_HID_CFG_MAX_NBR_REPORT_I
 */
 
 static  CPU_INT16U           USBD_HID_ReportID_Tbl_Ix;
-static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_TmrList;
+                                                                /* Idle report timer wheel and current tick.            */
+static  USBD_HID_REPORT_ID  *USBD_HID_Report_TmrWheel[USBD_HID_REPORT_TMR_NBR_LVL][USBD_HID_REPORT_TMR_NBR_SLOTS];
+static  CPU_INT32U           USBD_HID_Report_TmrTick;
+                                                                /* Due idle reports queued per class instance.          */
+static  USBD_HID_REPORT_ID  *USBD_HID_Report_IdlePendHeadTbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  USBD_HID_REPORT_ID  *USBD_HID_Report_IdlePendTailTbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  CPU_INT16U           USBD_HID_Report_IdlePendCnt;
+                                                                /* Idle report xfer in progress per class instance.     */
+static  CPU_BOOLEAN          USBD_HID_Report_IdleTxBusyTbl[USBD_HID_CFG_MAX_NBR_DEV];
 
 
 /*
@@ -103,13 +128,31 @@ static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_TmrList;
 *********************************************************************************************************
 */
 
-static  void                  USBD_HID_ReportClr     (USBD_HID_REPORT       *p_report);
+static  void                  USBD_HID_ReportClr        (USBD_HID_REPORT       *p_report);
+
+static  USBD_HID_REPORT_ID   *USBD_HID_ReportID_Alloc   (void);
+
+static  USBD_HID_REPORT_ID   *USBD_HID_ReportID_Get     (USBD_HID_REPORT       *p_report,
+                                                         USBD_HID_REPORT_TYPE     report_type,
+                                                         CPU_INT08U               report_id);
+
+static  USBD_HID_REPORT_ID   *USBD_HID_ReportID_Find    (const  USBD_HID_REPORT  *p_report,
+                                                                CPU_INT08U        type_ix,
+                                                                CPU_INT08U        report_id);
+
+static  CPU_INT08U            USBD_HID_ReportID_MaxGet  (const  CPU_INT08U       *p_report_data,
+                                                                CPU_INT16U        report_data_len);
 
-static  USBD_HID_REPORT_ID   *USBD_HID_ReportID_Alloc(void);
+static  void                  USBD_HID_Report_TmrInsert (USBD_HID_REPORT_ID    *p_report_id);
 
-static  USBD_HID_REPORT_ID   *USBD_HID_ReportID_Get  (USBD_HID_REPORT       *p_report,
-                                                      USBD_HID_REPORT_TYPE     report_type,
-                                                      CPU_INT08U               report_id);
+static  void                  USBD_HID_Report_TmrRemove (USBD_HID_REPORT_ID    *p_report_id);
+
+static  void                  USBD_HID_Report_IdleTxCmpl(CPU_INT08U               class_nbr,
+                                                         void                    *p_buf,
+                                                         CPU_INT32U               buf_len,
+                                                         CPU_INT32U               xfer_len,
+                                                         void                    *p_arg,
+                                                         USBD_ERR                 err);
 
 
 /*
@@ -157,15 +200,28 @@ void  USBD_HID_Report_Init (USBD_ERR  *p_err)
         p_report_id->DataPtr = (CPU_INT08U         *)0;
         p_report_id->NextPtr = (USBD_HID_REPORT_ID *)0;
 
-        p_report_id->ClassNbr   =  USBD_CLASS_NBR_NONE;
-        p_report_id->IdleCnt    =  0;
-        p_report_id->IdleRate   =  USBD_HID_IDLE_INFINITE;
-        p_report_id->Update     =  DEF_NO;
-        p_report_id->TmrNextPtr = (USBD_HID_REPORT_ID *)0;
+        p_report_id->ClassNbr        =  USBD_CLASS_NBR_NONE;
+        p_report_id->IdleRate        =  USBD_HID_IDLE_INFINITE;
+        p_report_id->TmrExpire       =  0u;
+        p_report_id->TmrSlotPtr      = (USBD_HID_REPORT_ID **)0;
+        p_report_id->TmrPrevPtr      = (USBD_HID_REPORT_ID  *)0;
+        p_report_id->TmrNextPtr      = (USBD_HID_REPORT_ID  *)0;
+        p_report_id->IdlePend        =  DEF_NO;
+        p_report_id->IdlePendNextPtr = (USBD_HID_REPORT_ID  *)0;
     }
 
-    USBD_HID_ReportID_Tbl_Ix  = 0;
-    USBD_HID_ReportID_TmrList = (USBD_HID_REPORT_ID *)0;
+    USBD_HID_ReportID_Tbl_Ix = 0;
+
+    Mem_Clr((void     *)&USBD_HID_Report_TmrWheel[0u][0u],
+            (CPU_SIZE_T) sizeof(USBD_HID_Report_TmrWheel));
+    USBD_HID_Report_TmrTick = 0u;
+
+    for (ix = 0; ix < USBD_HID_CFG_MAX_NBR_DEV; ix++) {
+        USBD_HID_Report_IdlePendHeadTbl[ix] = (USBD_HID_REPORT_ID *)0;
+        USBD_HID_Report_IdlePendTailTbl[ix] = (USBD_HID_REPORT_ID *)0;
+        USBD_HID_Report_IdleTxBusyTbl[ix]   =  DEF_NO;
+    }
+    USBD_HID_Report_IdlePendCnt = 0u;
 
    *p_err = USBD_ERR_NONE;
 }
@@ -199,7 +255,8 @@ void  USBD_HID_Report_Init (USBD_ERR  *p_err)
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The report ID table (see 'LOCAL DEFINES  Note #2') is allocated before parsing, once the
+*                   highest report ID is known.
 *********************************************************************************************************
 */
 
@@ -217,6 +274,7 @@ void  USBD_HID_Report_Parse (       CPU_INT08U        class_nbr,
     CPU_INT32U             data;
     CPU_INT08U             tag;
     CPU_INT08U             report_type;
+    CPU_SIZE_T             tbl_size;
     LIB_ERR                err_lib;
 
 
@@ -230,6 +288,19 @@ void  USBD_HID_Report_Parse (       CPU_INT08U        class_nbr,
     p_item->Cnt      =  0;
 
     USBD_HID_ReportClr(p_report);
+                                                                /* ------------- ALLOC REPORT ID TABLE ---------------- */
+    p_report->MaxReportID = USBD_HID_ReportID_MaxGet(p_report_data, report_data_len);
+
+    tbl_size                 = 3u * ((CPU_SIZE_T)p_report->MaxReportID + 1u) * sizeof(CPU_INT16U);
+    p_report->ReportIDTblPtr = (CPU_INT16U *)Mem_HeapAlloc(              tbl_size,
+                                                                         sizeof(CPU_INT16U),
+                                                           (CPU_SIZE_T *)DEF_NULL,
+                                                                        &err_lib);
+    if (err_lib != LIB_MEM_ERR_NONE) {                          /* See Note #1.                                         */
+       *p_err = USBD_ERR_ALLOC;
+        return;
+    }
+    Mem_Clr((void *)p_report->ReportIDTblPtr, tbl_size);
 
     while (report_data_len > 0) {
         data = 0;
@@ -544,17 +615,17 @@ CPU_INT16U  USBD_HID_ReportID_InfoGet (const  USBD_HID_REPORT        *p_report,
     USBD_HID_REPORT_ID  *p_report_id;
 
 
-    switch (report_type) {
+    switch (report_type) {                                      /* See 'LOCAL DEFINES  Note #2'.                        */
         case USBD_HID_REPORT_TYPE_INPUT:
-             p_report_id = p_report->Reports[0];
+             p_report_id = USBD_HID_ReportID_Find(p_report, 0u, report_id);
              break;
 
         case USBD_HID_REPORT_TYPE_OUTPUT:
-             p_report_id = p_report->Reports[1];
+             p_report_id = USBD_HID_ReportID_Find(p_report, 1u, report_id);
              break;
 
         case USBD_HID_REPORT_TYPE_FEATURE:
-             p_report_id = p_report->Reports[2];
+             p_report_id = USBD_HID_ReportID_Find(p_report, 2u, report_id);
              break;
 
         case USBD_HID_REPORT_TYPE_NONE:
@@ -563,40 +634,37 @@ CPU_INT16U  USBD_HID_ReportID_InfoGet (const  USBD_HID_REPORT        *p_report,
              return (0);
     }
 
-    while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-        if (p_report_id->ID == report_id) {
-            switch (report_type) {
-                case USBD_HID_REPORT_TYPE_INPUT:
-                    if (p_buf != (CPU_INT08U **)0) {
-                       *p_buf  =  p_report_id->DataPtr;
-                    }
-                    *p_is_largest = (p_report_id->Size == p_report->MaxInputReportSize) ? DEF_YES : DEF_NO;
-                     break;
+    if (p_report_id == (USBD_HID_REPORT_ID *)0) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return (0);
+    }
 
-                case USBD_HID_REPORT_TYPE_OUTPUT:
-                    if (p_buf != (CPU_INT08U **)0) {
-                       *p_buf  = p_report->MaxOutputReportPtr;
-                    }
-                    *p_is_largest = DEF_NO;
-                     break;
+    switch (report_type) {
+        case USBD_HID_REPORT_TYPE_INPUT:
+            if (p_buf != (CPU_INT08U **)0) {
+               *p_buf  =  p_report_id->DataPtr;
+            }
+            *p_is_largest = (p_report_id->Size == p_report->MaxInputReportSize) ? DEF_YES : DEF_NO;
+             break;
 
-                case USBD_HID_REPORT_TYPE_FEATURE:
-                default:
-                    if (p_buf != (CPU_INT08U **)0) {
-                       *p_buf  =  p_report->MaxFeatureReportPtr;
-                    }
-                    *p_is_largest = (p_report_id->Size == p_report->MaxFeatureReportSize) ? DEF_YES : DEF_NO;
-                     break;
+        case USBD_HID_REPORT_TYPE_OUTPUT:
+            if (p_buf != (CPU_INT08U **)0) {
+               *p_buf  = p_report->MaxOutputReportPtr;
             }
-           *p_err = USBD_ERR_NONE;
-            return (p_report_id->Size);
-        }
+            *p_is_largest = DEF_NO;
+             break;
 
-        p_report_id = p_report_id->NextPtr;
+        case USBD_HID_REPORT_TYPE_FEATURE:
+        default:
+            if (p_buf != (CPU_INT08U **)0) {
+               *p_buf  =  p_report->MaxFeatureReportPtr;
+            }
+            *p_is_largest = (p_report_id->Size == p_report->MaxFeatureReportSize) ? DEF_YES : DEF_NO;
+             break;
     }
 
-   *p_err = USBD_ERR_INVALID_ARG;
-    return (0);
+   *p_err = USBD_ERR_NONE;
+    return (p_report_id->Size);
 }
 
 
@@ -610,68 +678,119 @@ CPU_INT16U  USBD_HID_ReportID_InfoGet (const  USBD_HID_REPORT        *p_report,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Called every 4 milliseconds. Only the reports due on the current tick, and the ones moved
+*                   down the timer wheel (see 'LOCAL DEFINES  Note #1'), are processed.
+*
+*               (2) Due reports are queued per class instance and sent with USBD_HID_WrAsync(), one
+*                   transfer at a time per class instance. While the idle report transfer of an instance is
+*                   not completed, e.g. because the host stopped polling its interrupt IN endpoint, its due
+*                   reports stay queued until a later tick and the other instances are not delayed. A report
+*                   due again while still queued is only sent once.
+*
+*               (3) USBD_HID_WrAsync() still waits for a transfer started by the application on the same
+*                   class instance to complete.
 *********************************************************************************************************
 */
 
 void  USBD_HID_Report_TmrTaskHandler (void)
 {
     USBD_HID_REPORT_ID  *p_report_id;
-    USBD_HID_REPORT_ID  *p_report_id_prev;
-    CPU_BOOLEAN          service;
+    USBD_HID_REPORT_ID  *p_report_id_next;
+    CPU_INT32U           tick;
+    CPU_INT08U           class_nbr;
+    CPU_INT08U           slot_ix;
     USBD_ERR             err;
     CPU_SR_ALLOC();
 
 
-    p_report_id_prev = (USBD_HID_REPORT_ID *)0;
     CPU_CRITICAL_ENTER();
-    p_report_id      =  USBD_HID_ReportID_TmrList;
-    CPU_CRITICAL_EXIT();
+    USBD_HID_Report_TmrTick++;
+    tick    = USBD_HID_Report_TmrTick;
+    slot_ix = (CPU_INT08U)(tick & USBD_HID_REPORT_TMR_SLOT_MASK);
+    if (slot_ix == 0u) {                                        /* Move upper level slot down (see Note #1).            */
+        slot_ix     = (CPU_INT08U)((tick >> USBD_HID_REPORT_TMR_SLOT_NBR_BITS) & USBD_HID_REPORT_TMR_SLOT_MASK);
+        p_report_id =  USBD_HID_Report_TmrWheel[1u][slot_ix];
+        USBD_HID_Report_TmrWheel[1u][slot_ix] = (USBD_HID_REPORT_ID *)0;
 
-    while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-        service = DEF_NO;
+        while (p_report_id != (USBD_HID_REPORT_ID *)0) {
+            p_report_id_next = p_report_id->TmrNextPtr;
+            USBD_HID_Report_TmrInsert(p_report_id);
+            p_report_id      = p_report_id_next;
+        }
+        slot_ix = 0u;
+    }
+    CPU_CRITICAL_EXIT();
 
+                                                                /* ---------------- QUEUE DUE REPORTS ----------------- */
+    do {
         CPU_CRITICAL_ENTER();
-        if (p_report_id->IdleRate == USBD_HID_IDLE_INFINITE) {
-            p_report_id->IdleCnt  = 0u;
-            p_report_id->Update   = DEF_NO;
-
-            if (p_report_id_prev == (USBD_HID_REPORT_ID *)0) {
-                USBD_HID_ReportID_TmrList    = p_report_id->TmrNextPtr;
-            } else {
-                p_report_id_prev->TmrNextPtr = p_report_id->TmrNextPtr;
-            }
-
-            p_report_id->TmrNextPtr = (USBD_HID_REPORT_ID *)0;
-
-        } else {
-            if (p_report_id->Update == DEF_YES) {
-                p_report_id->Update  = DEF_NO;
-
-                if (p_report_id->IdleCnt > 1) {
-                    p_report_id->IdleCnt = p_report_id->IdleRate;
+        p_report_id = USBD_HID_Report_TmrWheel[0u][slot_ix];
+        if (p_report_id != (USBD_HID_REPORT_ID *)0) {
+            USBD_HID_Report_TmrRemove(p_report_id);
+                                                                /* Re-arm for next idle period.                         */
+            p_report_id->TmrExpire = tick + p_report_id->IdleRate;
+            USBD_HID_Report_TmrInsert(p_report_id);
+
+            if (p_report_id->IdlePend == DEF_NO) {              /* See Note #2.                                         */
+                class_nbr = p_report_id->ClassNbr;
+
+                p_report_id->IdlePend        =  DEF_YES;
+                p_report_id->IdlePendNextPtr = (USBD_HID_REPORT_ID *)0;
+                if (USBD_HID_Report_IdlePendTailTbl[class_nbr] == (USBD_HID_REPORT_ID *)0) {
+                    USBD_HID_Report_IdlePendHeadTbl[class_nbr]                  = p_report_id;
+                } else {
+                    USBD_HID_Report_IdlePendTailTbl[class_nbr]->IdlePendNextPtr = p_report_id;
                 }
-            }
-
-            if (p_report_id->IdleCnt > 1) {
-                p_report_id->IdleCnt--;
-            } else {
-                p_report_id->IdleCnt = p_report_id->IdleRate;
-                service = DEF_YES;
+                USBD_HID_Report_IdlePendTailTbl[class_nbr] = p_report_id;
+                USBD_HID_Report_IdlePendCnt++;
             }
         }
         CPU_CRITICAL_EXIT();
+    } while (p_report_id != (USBD_HID_REPORT_ID *)0);
 
-        if (service == DEF_YES) {
-            USBD_HID_Wr(p_report_id->ClassNbr,
-                        p_report_id->DataPtr,
-                        p_report_id->Size,
-                        100,
-                       &err);
-        }
+    if (USBD_HID_Report_IdlePendCnt == 0u) {
+        return;
+    }
+                                                                /* ----------------- SEND DUE REPORTS ----------------- */
+    for (class_nbr = 0u; class_nbr < USBD_HID_CFG_MAX_NBR_DEV; class_nbr++) {
+        do {
+            p_report_id = (USBD_HID_REPORT_ID *)0;
+
+            CPU_CRITICAL_ENTER();
+            if (USBD_HID_Report_IdleTxBusyTbl[class_nbr] == DEF_NO) {
+                do {                                            /* Dequeue first report still having an idle rate.      */
+                    p_report_id = USBD_HID_Report_IdlePendHeadTbl[class_nbr];
+                    if (p_report_id != (USBD_HID_REPORT_ID *)0) {
+                        USBD_HID_Report_IdlePendHeadTbl[class_nbr] = p_report_id->IdlePendNextPtr;
+                        if (p_report_id->IdlePendNextPtr == (USBD_HID_REPORT_ID *)0) {
+                            USBD_HID_Report_IdlePendTailTbl[class_nbr] = (USBD_HID_REPORT_ID *)0;
+                        }
+                        p_report_id->IdlePend = DEF_NO;
+                        USBD_HID_Report_IdlePendCnt--;
+                    }
+                } while ((p_report_id           != (USBD_HID_REPORT_ID *)0) &&
+                         (p_report_id->IdleRate == USBD_HID_IDLE_INFINITE));
 
-        p_report_id_prev = p_report_id;
-        p_report_id      = p_report_id->TmrNextPtr;
+                if (p_report_id != (USBD_HID_REPORT_ID *)0) {
+                    USBD_HID_Report_IdleTxBusyTbl[class_nbr] = DEF_YES;
+                }
+            }
+            CPU_CRITICAL_EXIT();
+
+            if (p_report_id != (USBD_HID_REPORT_ID *)0) {       /* Send until xfer is pending (see Note #2).            */
+                USBD_HID_WrAsync(        class_nbr,
+                                         p_report_id->DataPtr,
+                                         p_report_id->Size,
+                                         USBD_HID_Report_IdleTxCmpl,
+                                 (void *)0,
+                                        &err);
+                if (err != USBD_ERR_NONE) {
+                    CPU_CRITICAL_ENTER();
+                    USBD_HID_Report_IdleTxBusyTbl[class_nbr] = DEF_NO;
+                    CPU_CRITICAL_EXIT();
+                }
+            }
+        } while (p_report_id != (USBD_HID_REPORT_ID *)0);
     }
 }
 
@@ -705,19 +824,14 @@ CPU_INT08U  USBD_HID_ReportID_IdleGet (const  USBD_HID_REPORT  *p_report,
     USBD_HID_REPORT_ID  *p_report_id;
 
 
-    p_report_id = p_report->Reports[0];
-
-    while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-        if (p_report_id->ID == report_id) {
-           *p_err = USBD_ERR_NONE;
-            return (p_report_id->IdleRate);
-        }
-
-        p_report_id = p_report_id->NextPtr;
+    p_report_id = USBD_HID_ReportID_Find(p_report, 0u, report_id);
+    if (p_report_id == (USBD_HID_REPORT_ID *)0) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return (0);
     }
 
-   *p_err = USBD_ERR_INVALID_ARG;
-    return (0);
+   *p_err = USBD_ERR_NONE;
+    return (p_report_id->IdleRate);
 }
 
 
@@ -742,6 +856,11 @@ CPU_INT08U  USBD_HID_ReportID_IdleGet (const  USBD_HID_REPORT  *p_report,
 * Return(s)   : none.
 *
 * Note(s)     : (1) Idle rate is in 4 millisecond units.
+*
+*               (2) The idle period restarts from the current tick, even if the report was already armed.
+*
+*               (3) A single report is found through the report ID table (see 'LOCAL DEFINES  Note #2').
+*                   Report ID 0 addresses all the input reports of the class.
 *********************************************************************************************************
 */
 
@@ -754,40 +873,41 @@ void  USBD_HID_ReportID_IdleSet (const  USBD_HID_REPORT  *p_report,
     CPU_SR_ALLOC();
 
 
-    p_report_id = p_report->Reports[0];
-
-   *p_err = USBD_ERR_INVALID_ARG;
+    if (report_id != USBD_HID_IDLE_ALL_REPORT) {               /* Set idle rate of a single report (see Note #3).      */
+        p_report_id = USBD_HID_ReportID_Find(p_report, 0u, report_id);
+        if (p_report_id == (USBD_HID_REPORT_ID *)0) {
+           *p_err = USBD_ERR_INVALID_ARG;
+            return;
+        }
+    } else {
+        p_report_id = p_report->Reports[0];
+        if (p_report_id == (USBD_HID_REPORT_ID *)0) {
+           *p_err = USBD_ERR_INVALID_ARG;
+            return;
+        }
+    }
 
     while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-         if ((p_report_id->ID == report_id) ||
-             (  report_id     == USBD_HID_IDLE_ALL_REPORT)) {
-             if (idle_rate != USBD_HID_IDLE_INFINITE) {
-                 CPU_CRITICAL_ENTER();
-                                                         /* Add report ID into timer list.                       */
-                 if (p_report_id->IdleRate == USBD_HID_IDLE_INFINITE) {
-                     p_report_id->TmrNextPtr   = USBD_HID_ReportID_TmrList;
-                     USBD_HID_ReportID_TmrList = p_report_id;
-                 }
-
-                 p_report_id->IdleRate = idle_rate;
-                 p_report_id->Update   = DEF_YES;
+        CPU_CRITICAL_ENTER();
+        if (p_report_id->TmrSlotPtr != (USBD_HID_REPORT_ID **)0) {
+            USBD_HID_Report_TmrRemove(p_report_id);
+        }
 
-                 CPU_CRITICAL_EXIT();
-             } else {
-                 CPU_CRITICAL_ENTER();
-                 p_report_id->IdleRate = USBD_HID_IDLE_INFINITE;
-                 CPU_CRITICAL_EXIT();
-             }
+        p_report_id->IdleRate = idle_rate;
+        if (idle_rate != USBD_HID_IDLE_INFINITE) {              /* (Re)start idle period (see Note #2).                 */
+            p_report_id->TmrExpire = USBD_HID_Report_TmrTick + idle_rate;
+            USBD_HID_Report_TmrInsert(p_report_id);
+        }
+        CPU_CRITICAL_EXIT();
 
-            *p_err = USBD_ERR_NONE;
+        if (report_id != USBD_HID_IDLE_ALL_REPORT) {
+            break;
+        }
 
-             if (report_id != USBD_HID_IDLE_ALL_REPORT) {
-                 return;
-             }
-         }
+        p_report_id = p_report_id->NextPtr;
+    }
 
-         p_report_id = p_report_id->NextPtr;
-     }
+   *p_err = USBD_ERR_NONE;
 }
 
 
@@ -820,8 +940,9 @@ void  USBD_HID_Report_RemoveAllIdle (const  USBD_HID_REPORT  *p_report)
     p_report_id = p_report->Reports[0];
 
     while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-        CPU_CRITICAL_ENTER();                                   /* Remove only reports present on timer list.           */
-        if (p_report_id->TmrNextPtr != (USBD_HID_REPORT_ID *)0) {
+        CPU_CRITICAL_ENTER();                                   /* Remove only reports present on timer wheel.          */
+        if (p_report_id->TmrSlotPtr != (USBD_HID_REPORT_ID **)0) {
+            USBD_HID_Report_TmrRemove(p_report_id);
             p_report_id->IdleRate = USBD_HID_IDLE_INFINITE;
         }
         CPU_CRITICAL_EXIT();
@@ -866,6 +987,9 @@ static  void  USBD_HID_ReportClr (USBD_HID_REPORT  *p_report)
     p_report->Reports[0] = (USBD_HID_REPORT_ID  *)0;
     p_report->Reports[1] = (USBD_HID_REPORT_ID  *)0;
     p_report->Reports[2] = (USBD_HID_REPORT_ID  *)0;
+
+    p_report->MaxReportID    =  0;
+    p_report->ReportIDTblPtr = (CPU_INT16U *)0;
 }
 
 
@@ -925,6 +1049,10 @@ static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_Alloc (void)
 * Note(s)     : (1) If HID report ID structure is not available for the specific report type and ID, an
 *                   instance of HID report ID structure is allocated and linked into the HID report
 *                   structure.
+*
+*               (2) Report IDs are looked up through the report ID table (see 'LOCAL DEFINES  Note #2'),
+*                   so the order of the report list does not matter and a new report is linked at its
+*                   head.
 *********************************************************************************************************
 */
 
@@ -933,7 +1061,7 @@ static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_Get (USBD_HID_REPORT       *p_rep
                                                     CPU_INT08U               report_id)
 {
     USBD_HID_REPORT_ID  *p_report_id;
-    USBD_HID_REPORT_ID  *p_report_id_prev;
+    CPU_SIZE_T           tbl_ix;
     CPU_INT08U           type;
 
 
@@ -974,15 +1102,13 @@ static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_Get (USBD_HID_REPORT       *p_rep
     }
 
 
-    p_report_id      = p_report->Reports[type];
-    p_report_id_prev = (USBD_HID_REPORT_ID *)0;
-    while (p_report_id != (USBD_HID_REPORT_ID *)0) {
-        if (p_report_id->ID == report_id) {
-            return (p_report_id);
-        }
+    p_report_id = USBD_HID_ReportID_Find(p_report, type, report_id);
+    if (p_report_id != (USBD_HID_REPORT_ID *)0) {
+        return (p_report_id);
+    }
 
-        p_report_id_prev = p_report_id;
-        p_report_id      = p_report_id->NextPtr;
+    if (report_id > p_report->MaxReportID) {
+        return ((USBD_HID_REPORT_ID *)0);
     }
 
     p_report_id = USBD_HID_ReportID_Alloc();
@@ -990,13 +1116,236 @@ static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_Get (USBD_HID_REPORT       *p_rep
         return ((USBD_HID_REPORT_ID *)0);
     }
 
-    p_report_id->ID = report_id;
+    p_report_id->ID          = report_id;
+    p_report_id->NextPtr     = p_report->Reports[type];         /* Link at head of report list (see Note #2).           */
+    p_report->Reports[type]  = p_report_id;
+                                                                /* Store ix + 1 in report ID tbl.                       */
+    tbl_ix                           = (CPU_SIZE_T)type * ((CPU_SIZE_T)p_report->MaxReportID + 1u) + report_id;
+    p_report->ReportIDTblPtr[tbl_ix] = (CPU_INT16U)((p_report_id - &USBD_HID_ReportID_Tbl[0]) + 1);
+
+    return (p_report_id);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_HID_ReportID_Find()
+*
+* Description : Find HID report ID structure in report ID table.
+*
+* Argument(s) : p_report        Pointer to HID report structure.
+*
+*               type_ix         HID report type index :
+*
+*                                   0       Input   report.
+*                                   1       Output  report.
+*                                   2       Feature report.
+*
+*               report_id       HID report ID.
+*
+* Return(s)   : Pointer to HID report ID structure, if found.
+*
+*               Pointer to NULL,                    otherwise.
+*
+* Note(s)     : (1) See 'LOCAL DEFINES  Note #2'.
+*********************************************************************************************************
+*/
+
+static  USBD_HID_REPORT_ID  *USBD_HID_ReportID_Find (const  USBD_HID_REPORT  *p_report,
+                                                            CPU_INT08U        type_ix,
+                                                            CPU_INT08U        report_id)
+{
+    CPU_INT16U  tbl_entry;
+
+
+    if ((p_report->ReportIDTblPtr == (CPU_INT16U *)0) ||
+        (report_id                 > p_report->MaxReportID)) {
+        return ((USBD_HID_REPORT_ID *)0);
+    }
+
+    tbl_entry = p_report->ReportIDTblPtr[(CPU_SIZE_T)type_ix * ((CPU_SIZE_T)p_report->MaxReportID + 1u) + report_id];
+    if (tbl_entry == 0u) {
+        return ((USBD_HID_REPORT_ID *)0);
+    }
+
+    return (&USBD_HID_ReportID_Tbl[tbl_entry - 1u]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_HID_ReportID_MaxGet()
+*
+* Description : Get highest report ID declared in HID report descriptor.
+*
+* Argument(s) : p_report_data       Pointer to HID report descriptor.
+*
+*               report_data_len     Length of HID report descriptor.
+*
+* Return(s)   : Highest report ID, or 0 if the descriptor declares no report ID.
+*
+* Note(s)     : (1) The scan stops at a truncated item, which USBD_HID_Report_Parse() then reports as an
+*                   error.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  USBD_HID_ReportID_MaxGet (const  CPU_INT08U  *p_report_data,
+                                                     CPU_INT16U   report_data_len)
+{
+    CPU_INT08U  tag;
+    CPU_INT08U  data_len;
+    CPU_INT08U  report_id;
+    CPU_INT08U  max_report_id;
+
+
+    max_report_id = 0u;
+
+    while (report_data_len > 0u) {
+        tag = *p_report_data;
+        p_report_data++;
+          report_data_len--;
+
+        data_len = tag & USBD_HID_REPORT_ITEM_SIZE_MASK;
+        if (data_len == 3u) {                                   /* Item size: 4 bytes.                                  */
+            data_len = 4u;
+        }
+
+        if (report_data_len < data_len) {                       /* See Note #1.                                         */
+            break;
+        }
+
+        if (((tag & (USBD_HID_REPORT_ITEM_TYPE_MASK |
+                     USBD_HID_REPORT_ITEM_TAG_MASK)) == USBD_HID_GLOBAL_REPORT_ID) &&
+             (data_len                              >  0u)) {
+            report_id = *p_report_data;                         /* Report ID is the low byte of item data.              */
+            if (report_id > max_report_id) {
+                max_report_id = report_id;
+            }
+        }
+
+        p_report_data     += data_len;
+          report_data_len -= data_len;
+    }
+
+    return (max_report_id);
+}
+
 
-    if (p_report->Reports[type] == (USBD_HID_REPORT_ID *)0) {
-        p_report->Reports[type]  =  p_report_id;
+/*
+*********************************************************************************************************
+*                                     USBD_HID_Report_TmrInsert()
+*
+* Description : Insert HID input report ID in timer wheel.
+*
+* Argument(s) : p_report_id     Pointer to HID report ID structure.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Must be called within a critical section, with 'TmrExpire' at most 255 ticks ahead.
+*
+*               (2) Reports due within the next USBD_HID_REPORT_TMR_NBR_SLOTS ticks go to the lower level
+*                   slot of their due tick. Later ones go to the upper level slot of their due tick group
+*                   (see 'LOCAL DEFINES  Note #1').
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_Report_TmrInsert (USBD_HID_REPORT_ID  *p_report_id)
+{
+    USBD_HID_REPORT_ID  **p_slot;
+    CPU_INT32U            expire;
+
+
+    expire = p_report_id->TmrExpire;
+                                                                /* See Note #2.                                         */
+    if ((expire - USBD_HID_Report_TmrTick) < USBD_HID_REPORT_TMR_NBR_SLOTS) {
+        p_slot = &USBD_HID_Report_TmrWheel[0u][expire & USBD_HID_REPORT_TMR_SLOT_MASK];
     } else {
-        p_report_id_prev->NextPtr = p_report_id;
+        p_slot = &USBD_HID_Report_TmrWheel[1u][(expire >> USBD_HID_REPORT_TMR_SLOT_NBR_BITS) & USBD_HID_REPORT_TMR_SLOT_MASK];
     }
 
-    return (p_report_id);
+    p_report_id->TmrSlotPtr =  p_slot;
+    p_report_id->TmrPrevPtr = (USBD_HID_REPORT_ID *)0;
+    p_report_id->TmrNextPtr = *p_slot;
+    if (*p_slot != (USBD_HID_REPORT_ID *)0) {
+        (*p_slot)->TmrPrevPtr = p_report_id;
+    }
+   *p_slot = p_report_id;
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_Report_TmrRemove()
+*
+* Description : Remove HID input report ID from timer wheel.
+*
+* Argument(s) : p_report_id     Pointer to HID report ID structure.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Must be called within a critical section.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_Report_TmrRemove (USBD_HID_REPORT_ID  *p_report_id)
+{
+    if (p_report_id->TmrPrevPtr == (USBD_HID_REPORT_ID *)0) {
+       *p_report_id->TmrSlotPtr             = p_report_id->TmrNextPtr;
+    } else {
+        p_report_id->TmrPrevPtr->TmrNextPtr = p_report_id->TmrNextPtr;
+    }
+
+    if (p_report_id->TmrNextPtr != (USBD_HID_REPORT_ID *)0) {
+        p_report_id->TmrNextPtr->TmrPrevPtr = p_report_id->TmrPrevPtr;
+    }
+
+    p_report_id->TmrSlotPtr = (USBD_HID_REPORT_ID **)0;
+    p_report_id->TmrPrevPtr = (USBD_HID_REPORT_ID  *)0;
+    p_report_id->TmrNextPtr = (USBD_HID_REPORT_ID  *)0;
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_HID_Report_IdleTxCmpl()
+*
+* Description : Inform the report module about the completion of an idle report transfer.
+*
+* Argument(s) : class_nbr   Class instance number.
+*
+*               p_buf       Pointer to the transmit buffer.
+*
+*               buf_len     Transmit buffer length.
+*
+*               xfer_len    Number of octets sent.
+*
+*               p_arg       Additional argument provided to USBD_HID_WrAsync().
+*
+*               err         Transfer status: success or error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The next idle report due on the class instance is sent on the next tick.
+*********************************************************************************************************
+*/
+
+static  void  USBD_HID_Report_IdleTxCmpl (CPU_INT08U   class_nbr,
+                                          void        *p_buf,
+                                          CPU_INT32U   buf_len,
+                                          CPU_INT32U   xfer_len,
+                                          void        *p_arg,
+                                          USBD_ERR     err)
+{
+    CPU_SR_ALLOC();
+
+
+    (void)p_buf;
+    (void)buf_len;
+    (void)xfer_len;
+    (void)p_arg;
+    (void)err;
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    USBD_HID_Report_IdleTxBusyTbl[class_nbr] = DEF_NO;
+    CPU_CRITICAL_EXIT();
 }
@@ -289,10 +289,13 @@ struct  usbd_hid_report_id {
     USBD_HID_REPORT_ID    *NextPtr;
 
     CPU_INT08U             ClassNbr;
-    CPU_INT08U             IdleCnt;
     CPU_INT08U             IdleRate;
-    CPU_BOOLEAN            Update;
+    CPU_INT32U             TmrExpire;                           /* Tick at which idle report is due.                    */
+    USBD_HID_REPORT_ID   **TmrSlotPtr;                          /* Timer wheel slot holding report ID, if armed.        */
+    USBD_HID_REPORT_ID    *TmrPrevPtr;
     USBD_HID_REPORT_ID    *TmrNextPtr;
+    CPU_BOOLEAN            IdlePend;                            /* Idle report queued for xfer.                         */
+    USBD_HID_REPORT_ID    *IdlePendNextPtr;
 };
 
 
@@ -304,6 +307,8 @@ typedef  struct  usbd_hid_report {
     CPU_INT16U             MaxOutputReportSize;
     CPU_INT08U            *MaxOutputReportPtr;
     USBD_HID_REPORT_ID    *Reports[3];                          /* Index 0: Input Reports; 1: Output; 2: Feature.       */
+    CPU_INT08U             MaxReportID;                         /* Highest report ID of the report desc.                */
+    CPU_INT16U            *ReportIDTblPtr;                      /* Report ID structs indexed by type and ID.            */
 } USBD_HID_REPORT;
 
 /*
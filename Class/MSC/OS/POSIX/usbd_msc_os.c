@@ -0,0 +1,614 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                   USB DEVICE OPERATING SYSTEM LAYER
+*                                           POSIX (pthreads)
+*
+* Filename : usbd_msc_os.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This port runs the MSC class on a host workstation, together with the core POSIX port
+*                ('OS/POSIX/usbd_os.c') and the loopback device controller driver.
+*
+*            (2) One MSC task (thread) is created per class instance, so that the instances process
+*                their commands concurrently. Thread priorities are not set.
+*
+*            (3) Signals are POSIX unnamed semaphores and the cache lock is a mutex. The storage refresh
+*                task of the uC/FS storage layer is not supported.
+*
+*            (4) The POSIX.1-2008 feature test macro is defined before the first include so that the port
+*                also builds in a strict ISO C compiler mode (e.g. '-std=c11').
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    _POSIX_C_SOURCE                200809L               /* See Note #4.                                         */
+#define    MICRIUM_SOURCE
+#include  "../../usbd_msc.h"
+#include  "../../usbd_msc_os.h"
+#include  <pthread.h>
+#include  <semaphore.h>
+#include  <errno.h>
+#include  <time.h>
+
+
+/*
+*********************************************************************************************************
+*                                        CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_FS_REFRESH_TASK_EN == DEF_ENABLED)
+#error  "USBD_MSC_CFG_FS_REFRESH_TASK_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED with POSIX port]"
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_MSC_OS_NS_PER_SEC                   1000000000L
+#define  USBD_MSC_OS_NS_PER_MS                       1000000L
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  pthread_t        USBD_MSC_OS_TaskTbl[USBD_MSC_CFG_MAX_NBR_DEV];
+
+static  sem_t            USBD_MSC_OS_TASK_SemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
+
+static  sem_t            USBD_MSC_OS_EnumSignal;
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+static  sem_t            USBD_MSC_OS_DataSemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+static  pthread_mutex_t  USBD_MSC_OS_CacheLock;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL MACRO'S
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void  *USBD_MSC_OS_Task   (void        *p_arg);
+
+static  void   USBD_MSC_OS_SemPend(sem_t       *p_sem,
+                                   CPU_INT32U   timeout_ms,
+                                   USBD_ERR    *p_err);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           USBD_MSC_OS_Init()
+*
+* Description : Initialize MSC OS interface.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               OS initialization successful.
+*                               USBD_ERR_OS_SIGNAL_CREATE   OS objects NOT successfully initialized.
+*                               USBD_ERR_OS_INIT_FAIL       OS task    NOT successfully created.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'usbd_msc_os.c  Note #2'.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
+{
+    CPU_INT08U  class_nbr;
+    int         os_err;
+
+
+                                                                /* Create sem for signal used for MSC comm.             */
+    for (class_nbr = 0u; class_nbr < USBD_MSC_CFG_MAX_NBR_DEV; class_nbr++) {
+        os_err = sem_init(&USBD_MSC_OS_TASK_SemTbl[class_nbr], 0, 0u);
+        if (os_err != 0) {
+           *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+            return;
+        }
+    }
+                                                                /* Create sem for signal used for MSC enum.             */
+    os_err = sem_init(&USBD_MSC_OS_EnumSignal, 0, 0u);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+        return;
+    }
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+                                                                /* Create sem for signal used for MSC data stage.       */
+    for (class_nbr = 0u; class_nbr < USBD_MSC_CFG_MAX_NBR_DEV; class_nbr++) {
+        os_err = sem_init(&USBD_MSC_OS_DataSemTbl[class_nbr], 0, 0u);
+        if (os_err != 0) {
+           *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+            return;
+        }
+    }
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    os_err = pthread_mutex_init(&USBD_MSC_OS_CacheLock, DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+        return;
+    }
+#endif
+                                                                /* Create one MSC task per class instance (see Note #1).*/
+    for (class_nbr = 0u; class_nbr < USBD_MSC_CFG_MAX_NBR_DEV; class_nbr++) {
+        os_err = pthread_create(&USBD_MSC_OS_TaskTbl[class_nbr],
+                                 DEF_NULL,
+                                 USBD_MSC_OS_Task,
+                       (void *)(CPU_ADDR)class_nbr);
+        if (os_err != 0) {
+           *p_err = USBD_ERR_OS_INIT_FAIL;
+            return;
+        }
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_MSC_OS_Task()
+*
+* Description : OS-dependent shell task to process MSC task
+*
+* Argument(s) : p_arg       Class instance number.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_MSC_OS_Task (void  *p_arg)
+{
+    CPU_INT08U  class_nbr;
+
+
+    class_nbr = (CPU_INT08U)(CPU_ADDR)p_arg;
+
+    USBD_MSC_TaskHandler(class_nbr);
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_CommSignalPost()
+*
+* Description : Post a semaphore used for MSC communication.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_CommSignalPost (CPU_INT08U   class_nbr,
+                                  USBD_ERR    *p_err)
+{
+    int  os_err;
+
+
+    os_err = sem_post(&USBD_MSC_OS_TASK_SemTbl[class_nbr]);
+    if (os_err == 0) {
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_CommSignalPend()
+*
+* Description : Wait on a semaphore to become available for MSC communication.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_CommSignalPend (CPU_INT08U   class_nbr,
+                                  CPU_INT32U   timeout,
+                                  USBD_ERR    *p_err)
+{
+    USBD_MSC_OS_SemPend(&USBD_MSC_OS_TASK_SemTbl[class_nbr],
+                         timeout,
+                         p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_MSC_OS_CommSignalDel()
+*
+* Description : Delete a semaphore if no tasks are waiting on it for MSC communication.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and the semaphore was destroyed
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_CommSignalDel (CPU_INT08U   class_nbr,
+                                 USBD_ERR    *p_err)
+{
+    int  os_err;
+
+
+    os_err = sem_destroy(&USBD_MSC_OS_TASK_SemTbl[class_nbr]);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_FAIL;
+    } else {
+       *p_err = USBD_ERR_NONE;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_EnumSignalPost()
+*
+* Description : Post a semaphore for MSC enumeration process.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_EnumSignalPost (USBD_ERR  *p_err)
+{
+    int  os_err;
+
+
+    os_err = sem_post(&USBD_MSC_OS_EnumSignal);
+    if (os_err == 0) {
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_OS_EnumSignalPend()
+*
+* Description : Wait on a semaphore to become available for MSC enumeration process.
+*
+* Argument(s) : timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_OS_EnumSignalPend (CPU_INT32U  timeout,
+                                  USBD_ERR   *p_err)
+{
+    USBD_MSC_OS_SemPend(&USBD_MSC_OS_EnumSignal,
+                         timeout,
+                         p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPost()
+*
+* Description : Post a semaphore used to signal the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPost (CPU_INT08U   class_nbr,
+                                  USBD_ERR    *p_err)
+{
+    int  os_err;
+
+
+    os_err = sem_post(&USBD_MSC_OS_DataSemTbl[class_nbr]);
+    if (os_err == 0) {
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPend()
+*
+* Description : Wait for the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPend (CPU_INT08U   class_nbr,
+                                  CPU_INT32U   timeout,
+                                  USBD_ERR    *p_err)
+{
+    USBD_MSC_OS_SemPend(&USBD_MSC_OS_DataSemTbl[class_nbr],
+                         timeout,
+                         p_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockAcquire()
+*
+* Description : Acquire the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock acquired.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockAcquire (USBD_ERR  *p_err)
+{
+    int  os_err;
+
+
+    os_err = pthread_mutex_lock(&USBD_MSC_OS_CacheLock);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockRelease()
+*
+* Description : Release the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock released.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockRelease (USBD_ERR  *p_err)
+{
+    int  os_err;
+
+
+    os_err = pthread_mutex_unlock(&USBD_MSC_OS_CacheLock);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_OS_SemPend()
+*
+* Description : Wait for a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Semaphore     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     Semaphore NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_FAIL        Semaphore NOT successfully acquired because of
+*                                                           another error.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) sem_timedwait() only takes a CLOCK_REALTIME expiry time. A wall clock change while
+*                   pending shortens or extends the timeout.
+*********************************************************************************************************
+*/
+
+static  void  USBD_MSC_OS_SemPend (sem_t       *p_sem,
+                                   CPU_INT32U   timeout_ms,
+                                   USBD_ERR    *p_err)
+{
+    struct  timespec  ts;
+    int               os_err;
+
+
+    if (timeout_ms == 0u) {
+        do {
+            os_err = sem_wait(p_sem);
+        } while ((os_err != 0) &&
+                 (errno  == EINTR));
+    } else {
+        (void)clock_gettime(CLOCK_REALTIME, &ts);               /* See Note #1.                                         */
+        ts.tv_sec  += (time_t)(timeout_ms / 1000u);
+        ts.tv_nsec += (long  )(timeout_ms % 1000u) * USBD_MSC_OS_NS_PER_MS;
+        if (ts.tv_nsec >= USBD_MSC_OS_NS_PER_SEC) {
+            ts.tv_sec  += 1;
+            ts.tv_nsec -= USBD_MSC_OS_NS_PER_SEC;
+        }
+
+        do {
+            os_err = sem_timedwait(p_sem, &ts);
+        } while ((os_err != 0) &&
+                 (errno  == EINTR));
+    }
+
+    if (os_err == 0) {
+       *p_err = USBD_ERR_NONE;
+    } else if (errno == ETIMEDOUT) {
+       *p_err = USBD_ERR_OS_TIMEOUT;
+    } else {
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
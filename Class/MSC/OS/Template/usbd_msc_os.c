@@ -140,6 +140,8 @@ void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
 {
     /* $$$$ Insert code to create all the required semaphores. */
 
+    /* $$$$ Insert code to create the MSC block cache mutex, if USBD_MSC_CFG_CACHE_EN is enabled. */
+
     /* $$$$ Insert code to create the MSC task, USBD_MSC_OS_Task(). */
 
    *p_err = USBD_ERR_NONE;
@@ -308,3 +310,121 @@ void  USBD_MSC_OS_EnumSignalPend (CPU_INT32U  timeout,
     /* $$$$ Insert code to wait on a semaphore to become available for MSC enumeration process. */
    *p_err = USBD_ERR_NONE;
 }
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPost()
+*
+* Description : Post a semaphore used to signal the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPost (CPU_INT08U   class_nbr,
+                                  USBD_ERR    *p_err)
+{
+    /* $$$$ Insert code to post a semaphore used for MSC data stage completion. */
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPend()
+*
+* Description : Wait for the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPend (CPU_INT08U   class_nbr,
+                                  CPU_INT32U   timeout,
+                                  USBD_ERR    *p_err)
+{
+    /* $$$$ Insert code to wait on a semaphore used for MSC data stage completion.        */
+    /* A timeout parameter is available to implement a wait forever or with a timeout.    */
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockAcquire()
+*
+* Description : Acquire the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock acquired.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockAcquire (USBD_ERR  *p_err)
+{
+    /* $$$$ Insert code to acquire the mutex protecting the MSC block cache.              */
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockRelease()
+*
+* Description : Release the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock released.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockRelease (USBD_ERR  *p_err)
+{
+    /* $$$$ Insert code to release the mutex protecting the MSC block cache.              */
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
@@ -116,6 +116,15 @@ static  OS_STK     USBD_MSC_OS_RefreshTaskStk[USBD_MSC_OS_CFG_REFRESH_TASK_STK_S
 static  OS_EVENT  *USBD_MSC_OS_TaskSemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
 static  OS_EVENT  *USBD_MSC_OS_EnumSignal;
 
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+static  OS_EVENT  *USBD_MSC_OS_DataSemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+static  OS_EVENT  *USBD_MSC_OS_CacheLock;
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -165,6 +174,10 @@ void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
 {
     OS_EVENT    **p_comm_sem;
     OS_EVENT    **p_enum_sem;
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+    OS_EVENT    **p_data_sem;
+#endif
     INT8U         os_err;
     CPU_INT08U    class_nbr;
 
@@ -186,6 +199,27 @@ void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
         return;
     }
 
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+                                                                /* Create sem for signal used for MSC data stage.       */
+    for (class_nbr = 0; class_nbr < USBD_MSC_CFG_MAX_NBR_DEV; class_nbr++) {
+        p_data_sem = &USBD_MSC_OS_DataSemTbl[class_nbr];
+       *p_data_sem = OSSemCreate(0u);
+        if (*p_data_sem == (OS_EVENT *)0) {
+           *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+            return;
+        }
+    }
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    USBD_MSC_OS_CacheLock = OSSemCreate(1u);                    /* Create lock for MSC blk cache.                       */
+    if (USBD_MSC_OS_CacheLock == (OS_EVENT *)0) {
+       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+        return;
+    }
+#endif
+
 #if (OS_TASK_CREATE_EXT_EN == 1u)
 #if (OS_STK_GROWTH == 1u)
     os_err = OSTaskCreateExt(        USBD_MSC_OS_Task,
@@ -561,4 +595,166 @@ void  USBD_MSC_OS_EnumSignalPend (CPU_INT32U  timeout,
 }
 
 
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPost()
+*
+* Description : Post a semaphore used to signal the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPost (CPU_INT08U   class_nbr,
+                                  USBD_ERR    *p_err)
+{
+    OS_EVENT  *p_data_sem;
+
+
+    p_data_sem = USBD_MSC_OS_DataSemTbl[class_nbr];
 
+    OSSemPost(p_data_sem);
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPend()
+*
+* Description : Wait for the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPend (CPU_INT08U   class_nbr,
+                                  CPU_INT32U   timeout,
+                                  USBD_ERR    *p_err)
+{
+    OS_EVENT  *p_data_sem;
+    INT8U      os_err;
+    INT32U     timeout_ticks;
+
+
+    p_data_sem    = USBD_MSC_OS_DataSemTbl[class_nbr];
+    timeout_ticks = ((((INT32U)timeout * OS_TICKS_PER_SEC) + 1000u - 1u) / 1000u);
+
+    OSSemPend(p_data_sem, timeout_ticks, &os_err);
+
+    switch (os_err) {
+        case OS_ERR_NONE:
+            *p_err = USBD_ERR_NONE;
+             break;
+
+        case OS_ERR_TIMEOUT:
+            *p_err = USBD_ERR_OS_TIMEOUT;
+             break;
+
+        case OS_ERR_PEND_ABORT:
+            *p_err = USBD_ERR_OS_ABORT;
+             break;
+
+        case OS_ERR_EVENT_TYPE:
+        case OS_ERR_PEND_ISR:
+        case OS_ERR_PEVENT_NULL:
+        case OS_ERR_PEND_LOCKED:
+        default:
+            *p_err = USBD_ERR_OS_FAIL;
+             break;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockAcquire()
+*
+* Description : Acquire the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock acquired.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockAcquire (USBD_ERR  *p_err)
+{
+    INT8U  os_err;
+
+
+    OSSemPend(USBD_MSC_OS_CacheLock, 0u, &os_err);
+    if (os_err != OS_ERR_NONE) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockRelease()
+*
+* Description : Release the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock released.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockRelease (USBD_ERR  *p_err)
+{
+    INT8U  os_err;
+
+
+    os_err = OSSemPost(USBD_MSC_OS_CacheLock);
+    if (os_err != OS_ERR_NONE) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
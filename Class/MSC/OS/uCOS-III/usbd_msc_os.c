@@ -118,6 +118,15 @@ static  OS_SEM   USBD_MSC_OS_TASK_SemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
 
 static  OS_SEM   USBD_MSC_OS_EnumSignal;
 
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+static  OS_SEM   USBD_MSC_OS_DataSemTbl[USBD_MSC_CFG_MAX_NBR_DEV];
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+static  OS_MUTEX USBD_MSC_OS_CacheLock;
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -170,6 +179,10 @@ void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
     CPU_INT08U    class_nbr;
     OS_SEM       *p_comm_sem;
     OS_SEM       *p_enum_sem;
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+    OS_SEM       *p_data_sem;
+#endif
 
 
                                                                 /* Create sem for signal used for MSC comm.             */
@@ -195,6 +208,32 @@ void  USBD_MSC_OS_Init (USBD_ERR  *p_err)
         return;
     }
 
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+                                                                /* Create sem for signal used for MSC data stage.       */
+    for (class_nbr = 0u; class_nbr < USBD_MSC_CFG_MAX_NBR_DEV; class_nbr++) {
+        p_data_sem = &USBD_MSC_OS_DataSemTbl[class_nbr];
+        OSSemCreate(p_data_sem,
+                   "USB-Device MSC Data Sem",
+                    0u,
+                   &kernel_err);
+        if (kernel_err != OS_ERR_NONE) {
+           *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+            return;
+        }
+    }
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    OSMutexCreate(&USBD_MSC_OS_CacheLock,                       /* Create lock for MSC blk cache.                       */
+                  "USB-Device MSC Cache Lock",
+                  &kernel_err);
+    if (kernel_err != OS_ERR_NONE) {
+       *p_err = USBD_ERR_OS_SIGNAL_CREATE;
+        return;
+    }
+#endif
+
     OSTaskCreate(        &USBD_MSC_OS_TaskTCB,
                          "USB MSC Task",
                           USBD_MSC_OS_Task,
@@ -535,5 +574,181 @@ void  USBD_MSC_OS_EnumSignalPend (CPU_INT32U  timeout,
 }
 
 
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPost()
+*
+* Description : Post a semaphore used to signal the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal     successfully posted.
+*                               USBD_ERR_OS_FAIL    OS signal NOT successfully posted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPost (CPU_INT08U   class_nbr,
+                                  USBD_ERR    *p_err)
+{
+    OS_SEM  *p_data_sem;
+    OS_ERR   kernel_err;
+
+
+    p_data_sem = &USBD_MSC_OS_DataSemTbl[class_nbr];
+
+    OSSemPost(p_data_sem,
+              OS_OPT_POST_1,
+             &kernel_err);
+    if (kernel_err == OS_ERR_NONE) {
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_FAIL;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_OS_DataSignalPend()
+*
+* Description : Wait for the completion of an asynchronous data stage transfer.
+*
+* Argument(s) : class_nbr   MSC instance class number
+*
+*               timeout     Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          The call was successful and your task owns the resource
+*                                                       or, the event you are waiting for occurred.
+*                               USBD_ERR_OS_TIMEOUT    The semaphore was not received within the specified timeout.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPend (CPU_INT08U   class_nbr,
+                                  CPU_INT32U   timeout,
+                                  USBD_ERR    *p_err)
+{
+    OS_SEM  *p_data_sem;
+    OS_ERR   kernel_err;
+    OS_TICK  timeout_ticks;
+
+
+    p_data_sem    = &USBD_MSC_OS_DataSemTbl[class_nbr];
+    timeout_ticks = ((((OS_TICK)timeout * OSCfg_TickRate_Hz) + 1000u - 1u) / 1000u);
+
+    OSSemPend(          p_data_sem,
+                        timeout_ticks,
+                        OS_OPT_PEND_BLOCKING,
+              (CPU_TS *)0,
+                       &kernel_err);
+
+    switch (kernel_err) {
+        case OS_ERR_NONE:
+            *p_err = USBD_ERR_NONE;
+             break;
+
+
+        case OS_ERR_TIMEOUT:
+            *p_err = USBD_ERR_OS_TIMEOUT;
+             break;
+
+
+        case OS_ERR_PEND_ABORT:
+            *p_err = USBD_ERR_OS_ABORT;
+             break;
+
+
+        default:
+            *p_err = USBD_ERR_OS_FAIL;
+             break;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockAcquire()
+*
+* Description : Acquire the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock acquired.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockAcquire (USBD_ERR  *p_err)
+{
+    OS_ERR  os_err;
+
+
+    OSMutexPend(&USBD_MSC_OS_CacheLock,
+                 0u,
+                 OS_OPT_PEND_BLOCKING,
+                 (CPU_TS *)0,
+                &os_err);
+    if (os_err != OS_ERR_NONE) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
 
 
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_OS_CacheLockRelease()
+*
+* Description : Release the block cache lock.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE          Lock released.
+*                               USBD_ERR_OS_FAIL       otherwise.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockRelease (USBD_ERR  *p_err)
+{
+    OS_ERR  os_err;
+
+
+    OSMutexPost(&USBD_MSC_OS_CacheLock,
+                 OS_OPT_POST_NONE,
+                &os_err);
+    if (os_err != OS_ERR_NONE) {
+       *p_err = USBD_ERR_OS_FAIL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
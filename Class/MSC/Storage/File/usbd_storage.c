@@ -0,0 +1,980 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*
+*                                 USB DEVICE MSC CLASS STORAGE DRIVER
+*
+*                                           HOST IMAGE FILE
+*
+* Filename : usbd_storage.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) See 'usbd_storage.h  Note(s)'.
+*
+*            (2) Asynchronous requests are queued to a worker thread, which carries them out in
+*                submission order and calls their completion callback. The MSC task thus keeps
+*                moving data on the bus while the host file system serves the previous request.
+*
+*            (3) A latency can be added to every access with USBD_StorageLatencySet(), to behave like a
+*                slower medium such as an SD card: a fixed cost per command plus a cost per block.
+*
+*            (4) The driver uses POSIX.1-2008 interfaces (pread(), pwrite(), nanosleep()), which a strict
+*                ISO C compiler mode (e.g. '-std=c11') hides unless the feature test macro is defined
+*                before the first system header is included.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    _POSIX_C_SOURCE                200809L               /* See Note #4.                                         */
+#define    MICRIUM_SOURCE
+#include   "usbd_storage.h"
+#include   <errno.h>
+#include   <fcntl.h>
+#include   <pthread.h>
+#include   <sys/stat.h>
+#include   <time.h>
+#include   <unistd.h>
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_FILE_BLK_SIZE                              512u
+
+#define  USBD_FILE_NBR_UNITS                      USBD_SCSI_STORAGE_LUN_QTY
+
+                                                                /* Max nbr of async req in flight.                      */
+#define  USBD_FILE_REQ_QTY                       (USBD_SCSI_STORAGE_LUN_QTY * USBD_MSC_CFG_DATA_NBR_BUF)
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_file_req  USBD_FILE_REQ;
+
+struct  usbd_file_req {
+    USBD_STORAGE_LUN         *StorageLunPtr;                    /* Logical unit addressed by req.                       */
+    CPU_INT64U                BlkAddr;                          /* Starting blk.                                        */
+    CPU_INT32U                NbrBlks;                          /* Nbr of blks.                                         */
+    CPU_INT08U               *DataBufPtr;                       /* Ptr to data buf.                                     */
+    CPU_BOOLEAN               Wr;                               /* DEF_YES if wr req, DEF_NO if rd req.                 */
+    USBD_STORAGE_ASYNC_FNCT   AsyncFnct;                        /* Completion callback.                                 */
+    void                     *AsyncArgPtr;                      /* Arg passed to completion callback.                   */
+    USBD_FILE_REQ            *NextPtr;                          /* Ptr to next req in free list or in Q.                */
+};
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  int              USBD_FILE_Fd[USBD_FILE_NBR_UNITS];     /* Image file desc of each unit.                        */
+static  CPU_INT64U       USBD_FILE_NbrBlks[USBD_FILE_NBR_UNITS];/* Nbr of blks of each unit.                            */
+
+static  USBD_FILE_REQ    USBD_FILE_ReqTbl[USBD_FILE_REQ_QTY];   /* Async req pool.                                      */
+static  USBD_FILE_REQ   *USBD_FILE_ReqFreePtr;                  /* Head of free req list.                               */
+static  USBD_FILE_REQ   *USBD_FILE_ReqHeadPtr;                  /* Head of pending req Q.                               */
+static  USBD_FILE_REQ   *USBD_FILE_ReqTailPtr;                  /* Tail of pending req Q.                               */
+
+static  pthread_mutex_t  USBD_FILE_ReqMutex;                    /* Protects req pool & Q.                               */
+static  pthread_cond_t   USBD_FILE_ReqCond;                     /* Signals a req was queued.                            */
+static  pthread_t        USBD_FILE_Thread;                      /* Worker thread (see 'usbd_storage.c  Note #2').       */
+
+static  CPU_INT32U       USBD_FILE_LatRdCmd_us;                 /* Latency per rd cmd (see 'usbd_storage.c  Note #3').  */
+static  CPU_INT32U       USBD_FILE_LatWrCmd_us;                 /* Latency per wr cmd.                                  */
+static  CPU_INT32U       USBD_FILE_LatBlk_us;                   /* Latency per blk.                                     */
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void   USBD_FILE_Xfer       (USBD_STORAGE_LUN         *p_storage_lun,
+                                     CPU_INT64U                blk_addr,
+                                     CPU_INT32U                nbr_blks,
+                                     CPU_INT08U               *p_data_buf,
+                                     CPU_BOOLEAN               wr,
+                                     USBD_ERR                 *p_err);
+
+static  void   USBD_FILE_ReqSubmit  (USBD_STORAGE_LUN         *p_storage_lun,
+                                     CPU_INT64U                blk_addr,
+                                     CPU_INT32U                nbr_blks,
+                                     CPU_INT08U               *p_data_buf,
+                                     CPU_BOOLEAN               wr,
+                                     USBD_STORAGE_ASYNC_FNCT   async_fnct,
+                                     void                     *p_async_arg,
+                                     USBD_ERR                 *p_err);
+
+static  void  *USBD_FILE_Task       (void                     *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                     LOCAL CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           USBD_StorageInit()
+*
+* Description : Initialize the storage driver and start its worker thread.
+*
+* Argument(s) : p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Storage successfully initialized.
+*                               USBD_ERR_SCSI_LU_NOTRDY                 Worker thread creation failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageInit (USBD_ERR  *p_err)
+{
+    CPU_INT32U  ix;
+    int         res;
+
+
+    for (ix = 0u; ix < USBD_FILE_NBR_UNITS; ix++) {
+        USBD_FILE_Fd[ix]      = -1;
+        USBD_FILE_NbrBlks[ix] =  0u;
+    }
+
+    USBD_FILE_ReqFreePtr = DEF_NULL;
+    for (ix = USBD_FILE_REQ_QTY; ix > 0u; ix--) {               /* Build free req list.                                 */
+        USBD_FILE_ReqTbl[ix - 1u].NextPtr = USBD_FILE_ReqFreePtr;
+        USBD_FILE_ReqFreePtr              = &USBD_FILE_ReqTbl[ix - 1u];
+    }
+    USBD_FILE_ReqHeadPtr =  DEF_NULL;
+    USBD_FILE_ReqTailPtr =  DEF_NULL;
+
+    (void)pthread_mutex_init(&USBD_FILE_ReqMutex, DEF_NULL);
+    (void)pthread_cond_init(&USBD_FILE_ReqCond, DEF_NULL);
+
+    res = pthread_create(&USBD_FILE_Thread,
+                          DEF_NULL,
+                          USBD_FILE_Task,
+                          DEF_NULL);
+    if (res != 0) {
+       *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_StorageAdd()
+*
+* Description : Open the image file of a logical unit.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Image file successfully opened.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LU_NOTRDY                 Image file cannot be opened or is empty.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The capacity of the unit is the size of the image file, in whole blocks.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageAdd (USBD_STORAGE_LUN  *p_storage_lun,
+                       USBD_ERR          *p_err)
+{
+    CPU_INT08U   lun;
+    int          fd;
+    struct stat  file_stat;
+
+
+    lun = p_storage_lun->LunNbr;
+
+    if (lun >= USBD_FILE_NBR_UNITS) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return;
+    }
+
+    fd = open((const char *)p_storage_lun->VolStrPtr, O_RDWR);
+    if (fd < 0) {
+       *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+        return;
+    }
+                                                                /* See Note #1.                                         */
+    if ((fstat(fd, &file_stat)                  != 0) ||
+        (file_stat.st_size / USBD_FILE_BLK_SIZE == 0)) {
+        (void)close(fd);
+       *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+        return;
+    }
+
+    USBD_FILE_Fd[lun]            =  fd;
+    USBD_FILE_NbrBlks[lun]       = (CPU_INT64U)file_stat.st_size / USBD_FILE_BLK_SIZE;
+    p_storage_lun->MediumPresent =  DEF_TRUE;
+   *p_err                        =  USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageCapacityGet()
+*
+* Description : Get the capacity of the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               p_nbr_blks       Pointer to variable that will receive the number of logical blocks.
+*
+*               p_blk_size       Pointer to variable that will receive the size of each block, in bytes.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium capacity successfully gotten.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageCapacityGet (USBD_STORAGE_LUN  *p_storage_lun,
+                               CPU_INT64U        *p_nbr_blks,
+                               CPU_INT32U        *p_blk_size,
+                               USBD_ERR          *p_err)
+{
+   *p_nbr_blks = USBD_FILE_NbrBlks[p_storage_lun->LunNbr];
+   *p_blk_size = USBD_FILE_BLK_SIZE;
+   *p_err      = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_StorageRd()
+*
+* Description : Read data from the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium successfully read.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LU_NOTRDY                 Logical unit cannot perform operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRd (USBD_STORAGE_LUN  *p_storage_lun,
+                      CPU_INT64U         blk_addr,
+                      CPU_INT32U         nbr_blks,
+                      CPU_INT08U        *p_data_buf,
+                      USBD_ERR          *p_err)
+{
+    USBD_FILE_Xfer(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   DEF_NO ,
+                   p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_StorageWr()
+*
+* Description : Write data to the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium successfully written.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LU_NOTRDY                 Logical unit cannot perform operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWr (USBD_STORAGE_LUN  *p_storage_lun,
+                      CPU_INT64U         blk_addr,
+                      CPU_INT32U         nbr_blks,
+                      CPU_INT08U        *p_data_buf,
+                      USBD_ERR          *p_err)
+{
+    USBD_FILE_Xfer(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   DEF_YES,
+                   p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageRdAsync()
+*
+* Description : Read data from the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request queued.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Blocks out of range.
+*                               USBD_ERR_SCSI_LU_BUSY                   No request available.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'usbd_storage.c  Note #2'.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRdAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_FILE_ReqSubmit(p_storage_lun,                          /* See Note #1.                                         */
+                        blk_addr,
+                        nbr_blks,
+                        p_data_buf,
+                        DEF_NO ,
+                        async_fnct,
+                        p_async_arg,
+                        p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageWrAsync()
+*
+* Description : Write data to the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request queued.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Blocks out of range.
+*                               USBD_ERR_SCSI_LU_BUSY                   No request available.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'usbd_storage.c  Note #2'.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWrAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_FILE_ReqSubmit(p_storage_lun,                          /* See Note #1.                                         */
+                        blk_addr,
+                        nbr_blks,
+                        p_data_buf,
+                        DEF_YES,
+                        async_fnct,
+                        p_async_arg,
+                        p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_StorageUnmap()
+*
+* Description : Unmap a range of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block to unmap.
+*
+*               nbr_blks         Number of logical blocks to unmap.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           Blocks cannot be unmapped.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The file backed medium is not thin provisioned ('UnmapEn' is not set), so the SCSI layer
+*                   never calls this function.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageUnmap (USBD_STORAGE_LUN  *p_storage_lun,
+                         CPU_INT64U         blk_addr,
+                         CPU_INT32U         nbr_blks,
+                         USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;                      /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageMapStatusGet()
+*
+* Description : Get the provisioning status of a run of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block of the run.
+*
+*               nbr_blks         Maximum number of logical blocks of the run.
+*
+*               p_mapped         Pointer to variable that will receive the status of the run :
+*
+*                                    DEF_YES    Blocks are mapped.
+*                                    DEF_NO     Blocks are deallocated.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           Medium not thin provisioned.
+*
+* Return(s)   : 0.
+*
+* Note(s)     : (1) The file backed medium is not thin provisioned ('UnmapEn' is not set), so the SCSI layer
+*                   never calls this function.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_StorageMapStatusGet (USBD_STORAGE_LUN  *p_storage_lun,
+                                      CPU_INT64U         blk_addr,
+                                      CPU_INT32U         nbr_blks,
+                                      CPU_BOOLEAN       *p_mapped,
+                                      USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_mapped = DEF_YES;
+   *p_err    = USBD_ERR_SCSI_UNSUPPORTED_CMD;                   /* See Note #1.                                         */
+
+    return (0u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_StorageStatusGet()
+*
+* Description : Get storage medium's status.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium present.
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT         Medium not present.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageStatusGet (USBD_STORAGE_LUN  *p_storage_lun,
+                             USBD_ERR          *p_err)
+{
+    if (p_storage_lun->LunNbr >= USBD_FILE_NBR_UNITS) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return;
+    }
+
+    if (p_storage_lun->MediumPresent == DEF_FALSE) {
+       *p_err = USBD_ERR_SCSI_MEDIUM_NOTPRESENT;
+    } else {
+       *p_err = USBD_ERR_NONE;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_StorageLock()
+*
+* Description : Lock the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               timeout_ms       Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium successfully locked.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The image file is not shared with an embedded file system: locking always succeeds.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageLock (USBD_STORAGE_LUN  *p_storage_lun,
+                        CPU_INT32U         timeout_ms,
+                        USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;                                        /* See Note #1.                                         */
+    (void)timeout_ms;
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_StorageUnlock()
+*
+* Description : Unlock the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Medium successfully unlocked.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageUnlock (USBD_STORAGE_LUN  *p_storage_lun,
+                          USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageLatencySet()
+*
+* Description : Set the latency added to every access of the storage medium.
+*
+* Argument(s) : rd_cmd_us        Latency added to every read, in microseconds.
+*
+*               wr_cmd_us        Latency added to every write, in microseconds.
+*
+*               blk_us           Latency added per block transferred, in microseconds.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'usbd_storage.c  Note #3'. All latencies are 0 by default. They should be set
+*                   before the device is connected.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageLatencySet (CPU_INT32U  rd_cmd_us,
+                              CPU_INT32U  wr_cmd_us,
+                              CPU_INT32U  blk_us)
+{
+    USBD_FILE_LatRdCmd_us = rd_cmd_us;
+    USBD_FILE_LatWrCmd_us = wr_cmd_us;
+    USBD_FILE_LatBlk_us   = blk_us;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            USBD_FILE_Xfer()
+*
+* Description : Read or write blocks of an image file.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting block.
+*
+*               nbr_blks         Number of logical blocks to transfer.
+*
+*               p_data_buf       Pointer to data buffer.
+*
+*               wr               DEF_YES to write the blocks, DEF_NO to read them.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Blocks successfully transferred.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LU_NOTRDY                 Logical unit cannot perform operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) pread() and pwrite() may transfer less than requested; the transfer is resumed until
+*                   done. Since they do not move the file offset, concurrent requests need no locking.
+*
+*               (2) See 'usbd_storage.c  Note #3'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_FILE_Xfer (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U         blk_addr,
+                              CPU_INT32U         nbr_blks,
+                              CPU_INT08U        *p_data_buf,
+                              CPU_BOOLEAN        wr,
+                              USBD_ERR          *p_err)
+{
+    CPU_INT08U        lun;
+    int               fd;
+    size_t            rem_len;
+    off_t             offset;
+    ssize_t           xfer_len;
+    CPU_INT64U        lat_us;
+    struct  timespec  lat;
+
+
+    lun = p_storage_lun->LunNbr;
+
+    if ((lun               >= USBD_FILE_NBR_UNITS) ||
+        (USBD_FILE_Fd[lun] <  0)) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return;
+    }
+
+    if ((blk_addr + nbr_blks) > USBD_FILE_NbrBlks[lun]) {
+       *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+        return;
+    }
+
+    if (wr == DEF_YES) {
+        lat_us = USBD_FILE_LatWrCmd_us;
+    } else {
+        lat_us = USBD_FILE_LatRdCmd_us;
+    }
+    lat_us += (CPU_INT64U)nbr_blks * USBD_FILE_LatBlk_us;
+    if (lat_us > 0u) {                                          /* See Note #2.                                         */
+        lat.tv_sec  = (time_t)(lat_us / 1000000u);
+        lat.tv_nsec = (long  )(lat_us % 1000000u) * 1000L;
+        while ((nanosleep(&lat, &lat) != 0) &&
+               (errno == EINTR)) {
+            ;
+        }
+    }
+
+    fd      =  USBD_FILE_Fd[lun];
+    rem_len = (size_t)nbr_blks * USBD_FILE_BLK_SIZE;
+    offset  = (off_t)(blk_addr * USBD_FILE_BLK_SIZE);
+
+    while (rem_len > 0u) {                                      /* See Note #1.                                         */
+        if (wr == DEF_YES) {
+            xfer_len = pwrite(fd, p_data_buf, rem_len, offset);
+        } else {
+            xfer_len = pread(fd, p_data_buf, rem_len, offset);
+        }
+
+        if (xfer_len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+           *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+            return;
+        }
+        if (xfer_len == 0) {                                    /* Image file truncated by another process.             */
+           *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+            return;
+        }
+
+        p_data_buf += xfer_len;
+        rem_len    -= (size_t)xfer_len;
+        offset     += xfer_len;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_FILE_ReqSubmit()
+*
+* Description : Queue an asynchronous request to the worker thread.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting block.
+*
+*               nbr_blks         Number of logical blocks to transfer.
+*
+*               p_data_buf       Pointer to data buffer.
+*
+*               wr               DEF_YES to write the blocks, DEF_NO to read them.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request queued.
+*                               USBD_ERR_SCSI_LU_NOTSUPPORTED           Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Blocks out of range.
+*                               USBD_ERR_SCSI_LU_BUSY                   No request available.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Requests that can be rejected upfront are, so that the completion callback only reports
+*                   errors returned by the host file system.
+*********************************************************************************************************
+*/
+
+static  void  USBD_FILE_ReqSubmit (USBD_STORAGE_LUN         *p_storage_lun,
+                                   CPU_INT64U                blk_addr,
+                                   CPU_INT32U                nbr_blks,
+                                   CPU_INT08U               *p_data_buf,
+                                   CPU_BOOLEAN               wr,
+                                   USBD_STORAGE_ASYNC_FNCT   async_fnct,
+                                   void                     *p_async_arg,
+                                   USBD_ERR                 *p_err)
+{
+    CPU_INT08U      lun;
+    USBD_FILE_REQ  *p_req;
+
+
+    lun = p_storage_lun->LunNbr;
+                                                                /* See Note #1.                                         */
+    if ((lun               >= USBD_FILE_NBR_UNITS) ||
+        (USBD_FILE_Fd[lun] <  0)) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return;
+    }
+
+    if ((blk_addr + nbr_blks) > USBD_FILE_NbrBlks[lun]) {
+       *p_err = USBD_ERR_SCSI_LOG_BLOCK_ADDR;
+        return;
+    }
+
+    (void)pthread_mutex_lock(&USBD_FILE_ReqMutex);
+
+    p_req = USBD_FILE_ReqFreePtr;
+    if (p_req == DEF_NULL) {
+        (void)pthread_mutex_unlock(&USBD_FILE_ReqMutex);
+       *p_err = USBD_ERR_SCSI_LU_BUSY;
+        return;
+    }
+    USBD_FILE_ReqFreePtr = p_req->NextPtr;
+
+    p_req->StorageLunPtr = p_storage_lun;
+    p_req->BlkAddr       = blk_addr;
+    p_req->NbrBlks       = nbr_blks;
+    p_req->DataBufPtr    = p_data_buf;
+    p_req->Wr            = wr;
+    p_req->AsyncFnct     = async_fnct;
+    p_req->AsyncArgPtr   = p_async_arg;
+    p_req->NextPtr       = DEF_NULL;
+
+    if (USBD_FILE_ReqTailPtr == DEF_NULL) {                     /* Append req to Q.                                     */
+        USBD_FILE_ReqHeadPtr = p_req;
+    } else {
+        USBD_FILE_ReqTailPtr->NextPtr = p_req;
+    }
+    USBD_FILE_ReqTailPtr = p_req;
+
+    (void)pthread_cond_signal(&USBD_FILE_ReqCond);
+    (void)pthread_mutex_unlock(&USBD_FILE_ReqMutex);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_FILE_Task()
+*
+* Description : Carry out the queued asynchronous requests.
+*
+* Argument(s) : p_arg            Pointer to task initialization argument (not used).
+*
+* Return(s)   : None (task never returns).
+*
+* Note(s)     : (1) The request is returned to the pool before its completion callback is called, so that
+*                   the callback can submit the next request.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_FILE_Task (void  *p_arg)
+{
+    USBD_FILE_REQ            *p_req;
+    USBD_STORAGE_LUN         *p_storage_lun;
+    CPU_INT32U                nbr_blks;
+    CPU_INT08U               *p_data_buf;
+    USBD_STORAGE_ASYNC_FNCT   async_fnct;
+    void                     *p_async_arg;
+    USBD_ERR                  err;
+
+
+    (void)p_arg;
+
+    while (DEF_TRUE) {
+        (void)pthread_mutex_lock(&USBD_FILE_ReqMutex);
+        while (USBD_FILE_ReqHeadPtr == DEF_NULL) {
+            (void)pthread_cond_wait(&USBD_FILE_ReqCond, &USBD_FILE_ReqMutex);
+        }
+        p_req                = USBD_FILE_ReqHeadPtr;
+        USBD_FILE_ReqHeadPtr = p_req->NextPtr;
+        if (USBD_FILE_ReqHeadPtr == DEF_NULL) {
+            USBD_FILE_ReqTailPtr = DEF_NULL;
+        }
+        (void)pthread_mutex_unlock(&USBD_FILE_ReqMutex);
+
+        p_storage_lun = p_req->StorageLunPtr;
+        nbr_blks      = p_req->NbrBlks;
+        p_data_buf    = p_req->DataBufPtr;
+        async_fnct    = p_req->AsyncFnct;
+        p_async_arg   = p_req->AsyncArgPtr;
+
+        USBD_FILE_Xfer(p_storage_lun,
+                       p_req->BlkAddr,
+                       nbr_blks,
+                       p_data_buf,
+                       p_req->Wr,
+                      &err);
+
+        (void)pthread_mutex_lock(&USBD_FILE_ReqMutex);          /* See Note #1.                                         */
+        p_req->NextPtr       = USBD_FILE_ReqFreePtr;
+        USBD_FILE_ReqFreePtr = p_req;
+        (void)pthread_mutex_unlock(&USBD_FILE_ReqMutex);
+
+        async_fnct(p_storage_lun,
+                   p_data_buf,
+                   nbr_blks,
+                   p_async_arg,
+                   err);
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                                 END
+*********************************************************************************************************
+*/
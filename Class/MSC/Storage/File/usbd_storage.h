@@ -0,0 +1,176 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                 USB DEVICE MSC CLASS STORAGE DRIVER
+*
+*                                           HOST IMAGE FILE
+*
+* Filename : usbd_storage.h
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This storage driver backs each logical unit with an image file of the host file system
+*                and is meant to run the MSC class on a POSIX host (e.g. with the POSIX OS port and a
+*                simulated device controller). The volume string given to USBD_MSC_LunAdd() is the path
+*                of the image file, which must exist and whose size sets the capacity of the unit.
+*
+*            (2) The driver is built in place of the RAM disk driver 'usbd_storage.c', with which it shares
+*                its API: the MSC class, which includes the RAM disk driver header when
+*                USBD_MSC_CFG_MICRIUM_FS is DEF_DISABLED, is built unchanged.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                               MODULE
+*********************************************************************************************************
+*/
+
+#ifndef  USBF_STORAGE_H
+#define  USBF_STORAGE_H
+
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  "../../../../Source/usbd_core.h"
+#include  "../../usbd_scsi.h"
+
+
+/*
+*********************************************************************************************************
+*                                               EXTERNS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                               MACRO'S
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void  USBD_StorageInit       (USBD_ERR          *p_err);
+
+void  USBD_StorageAdd        (USBD_STORAGE_LUN  *p_storage_lun,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageCapacityGet(USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U        *p_nbr_blks,
+                              CPU_INT32U        *p_blk_size,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageRd         (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U         blk_addr,
+                              CPU_INT32U         nbr_blks,
+                              CPU_INT08U        *p_data_buf,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageWr         (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U         blk_addr,
+                              CPU_INT32U         nbr_blks,
+                              CPU_INT08U        *p_data_buf,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageRdAsync    (USBD_STORAGE_LUN        *p_storage_lun,
+                              CPU_INT64U               blk_addr,
+                              CPU_INT32U               nbr_blks,
+                              CPU_INT08U              *p_data_buf,
+                              USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                              void                    *p_async_arg,
+                              USBD_ERR                *p_err);
+
+void  USBD_StorageWrAsync    (USBD_STORAGE_LUN        *p_storage_lun,
+                              CPU_INT64U               blk_addr,
+                              CPU_INT32U               nbr_blks,
+                              CPU_INT08U              *p_data_buf,
+                              USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                              void                    *p_async_arg,
+                              USBD_ERR                *p_err);
+
+void  USBD_StorageUnmap      (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U         blk_addr,
+                              CPU_INT32U         nbr_blks,
+                              USBD_ERR          *p_err);
+
+CPU_INT32U  USBD_StorageMapStatusGet(USBD_STORAGE_LUN  *p_storage_lun,
+                                     CPU_INT64U         blk_addr,
+                                     CPU_INT32U         nbr_blks,
+                                     CPU_BOOLEAN       *p_mapped,
+                                     USBD_ERR          *p_err);
+
+void  USBD_StorageStatusGet  (USBD_STORAGE_LUN  *p_storage_lun,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageLock       (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT32U         timeout_ms,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageUnlock     (USBD_STORAGE_LUN  *p_storage_lun,
+                              USBD_ERR          *p_err);
+
+void  USBD_StorageLatencySet (CPU_INT32U         rd_cmd_us,
+                              CPU_INT32U         wr_cmd_us,
+                              CPU_INT32U         blk_us);
+
+
+/*
+*********************************************************************************************************
+*                                        CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif
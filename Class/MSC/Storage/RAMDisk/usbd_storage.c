@@ -39,11 +39,34 @@
 /*
 *********************************************************************************************************
 *                                            LOCAL DEFINES
+*
+* Note(s) : (1) When the RAM disk is sparse (see 'usbd_cfg.h  MSC CONFIGURATION  Note #8'), the blocks of
+*               a unit are mapped to pool blocks by a two-level table. A directory entry gives the map
+*               block of a range of USBD_RAMDISK_MAP_NBR_ENTRIES blocks, and a map block entry gives the
+*               pool block holding a block. Map blocks are taken from the pool, and are only allocated for
+*               ranges holding written blocks.
+*
+*           (2) Pool blocks are numbered from 1, so that cleared directory and map entries are unmapped.
+*               The free pool blocks are linked together by their first 4 octets.
 *********************************************************************************************************
 */
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+#define  USBD_RAMDISK_POOL_SIZE         (USBD_RAMDISK_CFG_BLK_SIZE * \
+                                         USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS)
+                                                                /* Nbr of entries of a map blk (see Note #1).           */
+#define  USBD_RAMDISK_MAP_NBR_ENTRIES   (USBD_RAMDISK_CFG_BLK_SIZE / sizeof(CPU_INT32U))
+                                                                /* Nbr of map blks needed to map a whole unit.          */
+#define  USBD_RAMDISK_DIR_NBR_ENTRIES  ((USBD_RAMDISK_CFG_NBR_BLKS + USBD_RAMDISK_MAP_NBR_ENTRIES - 1u) / \
+                                         USBD_RAMDISK_MAP_NBR_ENTRIES)
+
+#define  USBD_RAMDISK_POOL_BLK_NONE                        0u   /* Pool blks are numbered from 1 (see Note #2).         */
+
+#define  USBD_RAMDISK_POOL_BLK_PTR(pool_blk)   (&USBD_RAMDISK_PoolArea[((pool_blk) - 1u) * USBD_RAMDISK_CFG_BLK_SIZE])
+#else
 #define  USBD_RAMDISK_SIZE       (USBD_RAMDISK_CFG_BLK_SIZE * \
                                   USBD_RAMDISK_CFG_NBR_BLKS)
+#endif
 
 
 /*
@@ -59,11 +82,21 @@
 *********************************************************************************************************
 */
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+#if (USBD_RAMDISK_CFG_BASE_ADDR == 0)
+static  CPU_INT08U  USBD_RAMDISK_PoolArea[USBD_RAMDISK_POOL_SIZE];
+#else
+static  CPU_INT08U *USBD_RAMDISK_PoolArea;
+#endif
+                                                                /* Map blk of each range of blks of each unit.          */
+static  CPU_INT32U  USBD_RAMDISK_DirTbl[USBD_RAMDISK_CFG_NBR_UNITS][USBD_RAMDISK_DIR_NBR_ENTRIES];
+#else
 #if (USBD_RAMDISK_CFG_BASE_ADDR == 0)
 static  CPU_INT08U  USBD_RAMDISK_DataArea[USBD_RAMDISK_CFG_NBR_UNITS][USBD_RAMDISK_SIZE];
 #else
 static  CPU_INT08U *USBD_RAMDISK_DataArea[USBD_RAMDISK_CFG_NBR_UNITS];
 #endif
+#endif
 
 
 /*
@@ -79,6 +112,11 @@ static  CPU_INT08U *USBD_RAMDISK_DataArea[USBD_RAMDISK_CFG_NBR_UNITS];
 *********************************************************************************************************
 */
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+static  CPU_INT32U  USBD_RAMDISK_PoolFreeHead;                  /* First free pool blk (see Note #2).                   */
+static  CPU_INT32U  USBD_RAMDISK_PoolNbrFree;                   /* Nbr of free pool blks.                               */
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -86,6 +124,27 @@ static  CPU_INT08U *USBD_RAMDISK_DataArea[USBD_RAMDISK_CFG_NBR_UNITS];
 *********************************************************************************************************
 */
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+static  CPU_INT32U   USBD_RAMDISK_PoolBlkAlloc(void);
+
+static  void         USBD_RAMDISK_PoolBlkFree (CPU_INT32U   pool_blk);
+
+static  CPU_INT32U   USBD_RAMDISK_BlkLookup   (CPU_INT08U   lun,
+                                               CPU_INT64U   blk_addr);
+
+static  void         USBD_RAMDISK_BlkWr       (CPU_INT08U   lun,
+                                               CPU_INT64U   blk_addr,
+                                               CPU_INT08U  *p_data,
+                                               USBD_ERR    *p_err);
+
+static  void         USBD_RAMDISK_RangeUnmap  (CPU_INT08U   lun,
+                                               CPU_INT64U   blk_addr,
+                                               CPU_INT64U   nbr_blks);
+
+static  CPU_BOOLEAN  USBD_RAMDISK_IsZero      (CPU_INT08U  *p_data,
+                                               CPU_INT32U   len);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -114,12 +173,33 @@ static  CPU_INT08U *USBD_RAMDISK_DataArea[USBD_RAMDISK_CFG_NBR_UNITS];
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When the RAM disk is sparse, all the pool blocks are linked in the free list and all the
+*                   blocks of all the units are unmapped.
 *********************************************************************************************************
 */
 
 void  USBD_StorageInit (USBD_ERR  *p_err)
 {
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT32U  pool_blk;
+
+
+#if (USBD_RAMDISK_CFG_BASE_ADDR != 0)
+    USBD_RAMDISK_PoolArea = (CPU_INT08U *)USBD_RAMDISK_CFG_BASE_ADDR;
+#endif
+                                                                /* See Note #1.                                         */
+    for (pool_blk = 1u; pool_blk < USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS; pool_blk++) {
+        MEM_VAL_SET_INT32U(USBD_RAMDISK_POOL_BLK_PTR(pool_blk), pool_blk + 1u);
+    }
+    MEM_VAL_SET_INT32U(USBD_RAMDISK_POOL_BLK_PTR(pool_blk), USBD_RAMDISK_POOL_BLK_NONE);
+
+    USBD_RAMDISK_PoolFreeHead = 1u;
+    USBD_RAMDISK_PoolNbrFree  = USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS;
+
+    Mem_Clr((void     *)&USBD_RAMDISK_DirTbl[0][0],
+            (CPU_SIZE_T) sizeof(USBD_RAMDISK_DirTbl));
+#endif
+
    *p_err = USBD_ERR_NONE;
 }
 
@@ -139,13 +219,30 @@ void  USBD_StorageInit (USBD_ERR  *p_err)
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) A sparse unit is thin provisioned. The blocks it may still map, if it was added before,
+*                   are returned to the pool.
 *********************************************************************************************************
 */
 
 void  USBD_StorageAdd (USBD_STORAGE_LUN  *p_storage_lun,
                        USBD_ERR          *p_err)
 {
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT08U  lun_nbr;
+
+
+    lun_nbr = p_storage_lun->LunNbr;
+    if (lun_nbr >= USBD_RAMDISK_CFG_NBR_UNITS) {
+       *p_err = USBD_ERR_SCSI_LU_NOTRDY;
+        return;
+    }
+                                                                /* See Note #1.                                         */
+    USBD_RAMDISK_RangeUnmap(lun_nbr, 0u, USBD_RAMDISK_CFG_NBR_BLKS);
+
+    p_storage_lun->UnmapEn       = DEF_TRUE;
+    p_storage_lun->MediumPresent = DEF_TRUE;                    /* RAMDisk medium is initially always present.          */
+   *p_err                        = USBD_ERR_NONE;
+#else
     CPU_INT32U  ix;
     CPU_INT08U  lun_nbr;
 
@@ -167,6 +264,7 @@ void  USBD_StorageAdd (USBD_STORAGE_LUN  *p_storage_lun,
 
     p_storage_lun->MediumPresent = DEF_TRUE;                    /* RAMDisk medium is initially always present.          */
    *p_err                        = USBD_ERR_NONE;
+#endif
 }
 
 
@@ -228,7 +326,7 @@ void  USBD_StorageCapacityGet (USBD_STORAGE_LUN  *p_storage_lun,
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When the RAM disk is sparse, unmapped blocks are read as zeros.
 *********************************************************************************************************
 */
 
@@ -239,8 +337,12 @@ void  USBD_StorageRd (USBD_STORAGE_LUN  *p_storage_lun,
                       USBD_ERR          *p_err)
 {
     CPU_INT08U  lun;
-    CPU_INT64U  mem_area_size;
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT32U  pool_blk;
+    CPU_INT32U  blk_ix;
+#else
     CPU_INT32U  mem_size_copy;
+#endif
 
 
     lun = (*p_storage_lun).LunNbr;
@@ -250,16 +352,30 @@ void  USBD_StorageRd (USBD_STORAGE_LUN  *p_storage_lun,
         return;
     }
 
-    mem_area_size = ((blk_addr + nbr_blks) * USBD_RAMDISK_CFG_BLK_SIZE);
-    if (mem_area_size > USBD_RAMDISK_SIZE) {
+    if ((blk_addr + nbr_blks) > USBD_RAMDISK_CFG_NBR_BLKS) {
        *p_err = USBD_ERR_SCSI_LU_NOTRDY;
         return;
     }
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    for (blk_ix = 0u; blk_ix < nbr_blks; blk_ix++) {            /* See Note #1.                                         */
+        pool_blk = USBD_RAMDISK_BlkLookup(lun, blk_addr + blk_ix);
+        if (pool_blk == USBD_RAMDISK_POOL_BLK_NONE) {
+            Mem_Clr((void     *)p_data_buf,
+                    (CPU_SIZE_T)USBD_RAMDISK_CFG_BLK_SIZE);
+        } else {
+            Mem_Copy((void     *)p_data_buf,
+                     (void     *)USBD_RAMDISK_POOL_BLK_PTR(pool_blk),
+                     (CPU_SIZE_T)USBD_RAMDISK_CFG_BLK_SIZE);
+        }
+        p_data_buf += USBD_RAMDISK_CFG_BLK_SIZE;
+    }
+#else
     mem_size_copy = nbr_blks * USBD_RAMDISK_CFG_BLK_SIZE;
     Mem_Copy((void *) p_data_buf,
              (void *)&USBD_RAMDISK_DataArea[lun][blk_addr * USBD_RAMDISK_CFG_BLK_SIZE],
                       mem_size_copy);
+#endif
 
    *p_err = USBD_ERR_NONE;
 }
@@ -285,10 +401,13 @@ void  USBD_StorageRd (USBD_STORAGE_LUN  *p_storage_lun,
 *                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
 *                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
 *                                                                           operations.
+*                               USBD_ERR_SCSI_SPACE_ALLOC               No pool block left to map a block.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When the RAM disk is sparse, pool blocks are only allocated to blocks written with
+*                   non-zero data. A block written with zeros is unmapped instead. When the pool runs out,
+*                   the blocks preceding the failed one are written.
 *********************************************************************************************************
 */
 
@@ -299,8 +418,11 @@ void  USBD_StorageWr (USBD_STORAGE_LUN  *p_storage_lun,
                       USBD_ERR          *p_err)
 {
     CPU_INT08U  lun;
-    CPU_INT64U  mem_area_size;
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT32U  blk_ix;
+#else
     CPU_INT32U  mem_size_copy;
+#endif
 
 
     lun = (*p_storage_lun).LunNbr;
@@ -310,18 +432,299 @@ void  USBD_StorageWr (USBD_STORAGE_LUN  *p_storage_lun,
         return;
     }
 
-    mem_area_size = ((blk_addr + nbr_blks) * USBD_RAMDISK_CFG_BLK_SIZE);
-    if (mem_area_size > USBD_RAMDISK_SIZE) {
+    if ((blk_addr + nbr_blks) > USBD_RAMDISK_CFG_NBR_BLKS) {
        *p_err = USBD_ERR_SCSI_LU_NOTRDY;
         return;
     }
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    for (blk_ix = 0u; blk_ix < nbr_blks; blk_ix++) {            /* See Note #1.                                         */
+        USBD_RAMDISK_BlkWr(lun, blk_addr + blk_ix, p_data_buf, p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return;
+        }
+        p_data_buf += USBD_RAMDISK_CFG_BLK_SIZE;
+    }
+#else
     mem_size_copy = nbr_blks * USBD_RAMDISK_CFG_BLK_SIZE;
     Mem_Copy((void *)&USBD_RAMDISK_DataArea[lun][blk_addr * USBD_RAMDISK_CFG_BLK_SIZE],
              (void *) p_data_buf,
                       mem_size_copy);
+#endif
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageRdAsync()
+*
+* Description : Read data from the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The RAM disk has no transfer latency to overlap: the copy is done in the caller's
+*                   context and 'async_fnct' is called before returning.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRdAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageRd(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,                                   /* See Note #1.                                         */
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageWrAsync()
+*
+* Description : Write data to the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The RAM disk has no transfer latency to overlap: the copy is done in the caller's
+*                   context and 'async_fnct' is called before returning.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWrAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageWr(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,                                   /* See Note #1.                                         */
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_StorageUnmap()
+*
+* Description : Unmap a range of blocks of the storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block to unmap.
+*
+*               nbr_blks         Number of logical blocks to unmap.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Blocks successfully unmapped.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Logical block address out of range.
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           RAM disk not sparse.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The pool blocks of the range, and the map blocks left without any mapped block, are
+*                   returned to the pool. Nothing is unmapped if the range is out of the medium.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageUnmap (USBD_STORAGE_LUN  *p_storage_lun,
+                         CPU_INT64U         blk_addr,
+                         CPU_INT32U         nbr_blks,
+                         USBD_ERR          *p_err)
+{
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT08U  lun;
+
+
+    lun = p_storage_lun->LunNbr;
+
+    if (lun >= USBD_RAMDISK_CFG_NBR_UNITS) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return;
+    }
+
+    if ((blk_addr            >= USBD_RAMDISK_CFG_NBR_BLKS) ||
+        (blk_addr + nbr_blks >  USBD_RAMDISK_CFG_NBR_BLKS)) {
+       *p_err = USBD_ERR_SCSI_LOG_BLOCK_ADDR;                   /* See Note #1.                                         */
+        return;
+    }
+
+    USBD_RAMDISK_RangeUnmap(lun, blk_addr, nbr_blks);
+
+   *p_err = USBD_ERR_NONE;
+#else
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageMapStatusGet()
+*
+* Description : Get the provisioning status of a run of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block of the run.
+*
+*               nbr_blks         Maximum number of logical blocks of the run.
+*
+*               p_mapped         Pointer to variable that will receive the status of the run :
+*
+*                                    DEF_YES    Blocks are mapped.
+*                                    DEF_NO     Blocks are deallocated.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Status successfully returned.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Logical block address out of range.
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           RAM disk not sparse.
+*
+* Return(s)   : Number of blocks, starting at 'blk_addr', that share the status of the first block, at most
+*               'nbr_blks'.
+*
+* Note(s)     : (1) The run stops at the end of the medium.
+*
+*               (2) The ranges without a map block are deallocated as a whole and skipped at once.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_StorageMapStatusGet (USBD_STORAGE_LUN  *p_storage_lun,
+                                      CPU_INT64U         blk_addr,
+                                      CPU_INT32U         nbr_blks,
+                                      CPU_BOOLEAN       *p_mapped,
+                                      USBD_ERR          *p_err)
+{
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+    CPU_INT08U   lun;
+    CPU_INT64U   blk_end;
+    CPU_INT64U   run_end;
+    CPU_INT32U   dir_ix;
+    CPU_BOOLEAN  mapped;
+
+
+    lun = p_storage_lun->LunNbr;
+
+    if (lun >= USBD_RAMDISK_CFG_NBR_UNITS) {
+       *p_err = USBD_ERR_SCSI_LU_NOTSUPPORTED;
+        return (0u);
+    }
+
+    if (blk_addr >= USBD_RAMDISK_CFG_NBR_BLKS) {
+       *p_err = USBD_ERR_SCSI_LOG_BLOCK_ADDR;
+        return (0u);
+    }
+
+    blk_end   = DEF_MIN(blk_addr + nbr_blks, USBD_RAMDISK_CFG_NBR_BLKS);
+   *p_mapped  = (USBD_RAMDISK_BlkLookup(lun, blk_addr) != USBD_RAMDISK_POOL_BLK_NONE) ? DEF_YES : DEF_NO;
+    run_end   = blk_addr + 1u;
+
+    while (run_end < blk_end) {
+        dir_ix = (CPU_INT32U)(run_end / USBD_RAMDISK_MAP_NBR_ENTRIES);
+        if ((*p_mapped                        == DEF_NO) &&     /* See Note #2.                                         */
+            (USBD_RAMDISK_DirTbl[lun][dir_ix] == USBD_RAMDISK_POOL_BLK_NONE)) {
+            run_end = ((CPU_INT64U)dir_ix + 1u) * USBD_RAMDISK_MAP_NBR_ENTRIES;
+            continue;
+        }
+
+        mapped = (USBD_RAMDISK_BlkLookup(lun, run_end) != USBD_RAMDISK_POOL_BLK_NONE) ? DEF_YES : DEF_NO;
+        if (mapped != *p_mapped) {
+            break;
+        }
+        run_end++;
+    }
+    run_end = DEF_MIN(run_end, blk_end);
 
    *p_err = USBD_ERR_NONE;
+
+    return ((CPU_INT32U)(run_end - blk_addr));
+#else
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_mapped = DEF_YES;
+   *p_err    = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+
+    return (0u);
+#endif
 }
 
 
@@ -419,3 +822,313 @@ void  USBD_StorageUnlock (USBD_STORAGE_LUN  *p_storage_lun,
 {
    *p_err = USBD_ERR_NONE;
 }
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_StoragePoolNbrFreeGet()
+*
+* Description : Get the number of free blocks of the sparse RAM disk pool.
+*
+* Argument(s) : None.
+*
+* Return(s)   : Number of pool blocks neither holding data nor block maps.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+CPU_INT32U  USBD_StoragePoolNbrFreeGet (void)
+{
+    CPU_INT32U  nbr_free;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    nbr_free = USBD_RAMDISK_PoolNbrFree;
+    CPU_CRITICAL_EXIT();
+
+    return (nbr_free);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                      USBD_RAMDISK_PoolBlkAlloc()
+*
+* Description : Take a block from the pool.
+*
+* Argument(s) : None.
+*
+* Return(s)   : Pool block number,          if a block is free.
+*
+*               USBD_RAMDISK_POOL_BLK_NONE, otherwise.
+*
+* Note(s)     : (1) The pool is shared by the units of all the MSC class instances, whose tasks may
+*                   allocate blocks concurrently.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_RAMDISK_PoolBlkAlloc (void)
+{
+    CPU_INT32U  pool_blk;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    pool_blk = USBD_RAMDISK_PoolFreeHead;
+    if (pool_blk != USBD_RAMDISK_POOL_BLK_NONE) {
+        USBD_RAMDISK_PoolFreeHead = MEM_VAL_GET_INT32U(USBD_RAMDISK_POOL_BLK_PTR(pool_blk));
+        USBD_RAMDISK_PoolNbrFree--;
+    }
+    CPU_CRITICAL_EXIT();
+
+    return (pool_blk);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_RAMDISK_PoolBlkFree()
+*
+* Description : Return a block to the pool.
+*
+* Argument(s) : pool_blk    Pool block number.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  void  USBD_RAMDISK_PoolBlkFree (CPU_INT32U  pool_blk)
+{
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    MEM_VAL_SET_INT32U(USBD_RAMDISK_POOL_BLK_PTR(pool_blk), USBD_RAMDISK_PoolFreeHead);
+    USBD_RAMDISK_PoolFreeHead = pool_blk;
+    USBD_RAMDISK_PoolNbrFree++;
+    CPU_CRITICAL_EXIT();
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_RAMDISK_BlkLookup()
+*
+* Description : Get the pool block holding a block of a unit.
+*
+* Argument(s) : lun         Storage unit number.
+*
+*               blk_addr    Logical block address.
+*
+* Return(s)   : Pool block number,          if the block is mapped.
+*
+*               USBD_RAMDISK_POOL_BLK_NONE, otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_RAMDISK_BlkLookup (CPU_INT08U  lun,
+                                            CPU_INT64U  blk_addr)
+{
+    CPU_INT32U   map_blk;
+    CPU_INT08U  *p_entry;
+
+
+    map_blk = USBD_RAMDISK_DirTbl[lun][blk_addr / USBD_RAMDISK_MAP_NBR_ENTRIES];
+    if (map_blk == USBD_RAMDISK_POOL_BLK_NONE) {
+        return (USBD_RAMDISK_POOL_BLK_NONE);
+    }
+
+    p_entry = USBD_RAMDISK_POOL_BLK_PTR(map_blk) + (blk_addr % USBD_RAMDISK_MAP_NBR_ENTRIES) * sizeof(CPU_INT32U);
+
+    return (MEM_VAL_GET_INT32U(p_entry));
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_RAMDISK_BlkWr()
+*
+* Description : Write a block of a unit, mapping it if needed.
+*
+* Argument(s) : lun         Storage unit number.
+*
+*               blk_addr    Logical block address.
+*
+*               p_data      Pointer to block data.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                   Block successfully written.
+*                               USBD_ERR_SCSI_SPACE_ALLOC       No pool block left to map the block.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) A block written with zeros is unmapped rather than stored, since unmapped blocks read
+*                   as zeros. It does not allocate a map block either.
+*
+*               (2) A map block allocated for a block that could not be mapped is returned to the pool.
+*********************************************************************************************************
+*/
+
+static  void  USBD_RAMDISK_BlkWr (CPU_INT08U   lun,
+                                  CPU_INT64U   blk_addr,
+                                  CPU_INT08U  *p_data,
+                                  USBD_ERR    *p_err)
+{
+    CPU_INT32U   dir_ix;
+    CPU_INT32U   map_blk;
+    CPU_INT32U   data_blk;
+    CPU_INT08U  *p_entry;
+
+
+   *p_err = USBD_ERR_NONE;
+
+    if (USBD_RAMDISK_IsZero(p_data, USBD_RAMDISK_CFG_BLK_SIZE) == DEF_YES) {
+        USBD_RAMDISK_RangeUnmap(lun, blk_addr, 1u);             /* See Note #1.                                         */
+        return;
+    }
+
+    dir_ix  = (CPU_INT32U)(blk_addr / USBD_RAMDISK_MAP_NBR_ENTRIES);
+    map_blk =  USBD_RAMDISK_DirTbl[lun][dir_ix];
+    if (map_blk == USBD_RAMDISK_POOL_BLK_NONE) {                /* Alloc map blk of range.                              */
+        map_blk = USBD_RAMDISK_PoolBlkAlloc();
+        if (map_blk == USBD_RAMDISK_POOL_BLK_NONE) {
+           *p_err = USBD_ERR_SCSI_SPACE_ALLOC;
+            return;
+        }
+        Mem_Clr((void     *)USBD_RAMDISK_POOL_BLK_PTR(map_blk),
+                (CPU_SIZE_T)USBD_RAMDISK_CFG_BLK_SIZE);
+        USBD_RAMDISK_DirTbl[lun][dir_ix] = map_blk;
+    }
+
+    p_entry  = USBD_RAMDISK_POOL_BLK_PTR(map_blk) + (blk_addr % USBD_RAMDISK_MAP_NBR_ENTRIES) * sizeof(CPU_INT32U);
+    data_blk = MEM_VAL_GET_INT32U(p_entry);
+    if (data_blk == USBD_RAMDISK_POOL_BLK_NONE) {               /* Map blk.                                             */
+        data_blk = USBD_RAMDISK_PoolBlkAlloc();
+        if (data_blk == USBD_RAMDISK_POOL_BLK_NONE) {
+            USBD_RAMDISK_RangeUnmap(lun, blk_addr, 1u);         /* See Note #2.                                         */
+           *p_err = USBD_ERR_SCSI_SPACE_ALLOC;
+            return;
+        }
+        MEM_VAL_SET_INT32U(p_entry, data_blk);
+    }
+
+    Mem_Copy((void     *)USBD_RAMDISK_POOL_BLK_PTR(data_blk),
+             (void     *)p_data,
+             (CPU_SIZE_T)USBD_RAMDISK_CFG_BLK_SIZE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_RAMDISK_RangeUnmap()
+*
+* Description : Unmap a range of blocks of a unit.
+*
+* Argument(s) : lun         Storage unit number.
+*
+*               blk_addr    Logical block address of first block to unmap.
+*
+*               nbr_blks    Number of blocks to unmap.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Ranges without a map block hold no mapped block and are skipped as a whole. A map
+*                   block is returned to the pool once none of its entries is mapped.
+*********************************************************************************************************
+*/
+
+static  void  USBD_RAMDISK_RangeUnmap (CPU_INT08U  lun,
+                                       CPU_INT64U  blk_addr,
+                                       CPU_INT64U  nbr_blks)
+{
+    CPU_INT64U   blk_end;
+    CPU_INT64U   run_end;
+    CPU_INT32U   dir_ix;
+    CPU_INT32U   map_blk;
+    CPU_INT32U   data_blk;
+    CPU_INT08U  *p_map;
+
+
+    blk_end = blk_addr + nbr_blks;
+
+    while (blk_addr < blk_end) {
+        dir_ix  = (CPU_INT32U)(blk_addr / USBD_RAMDISK_MAP_NBR_ENTRIES);
+        run_end = ((CPU_INT64U)dir_ix + 1u) * USBD_RAMDISK_MAP_NBR_ENTRIES;
+        run_end = DEF_MIN(run_end, blk_end);
+
+        map_blk = USBD_RAMDISK_DirTbl[lun][dir_ix];
+        if (map_blk == USBD_RAMDISK_POOL_BLK_NONE) {            /* See Note #1.                                         */
+            blk_addr = run_end;
+            continue;
+        }
+
+        p_map = USBD_RAMDISK_POOL_BLK_PTR(map_blk);
+        while (blk_addr < run_end) {                            /* Free data blks of the range.                         */
+            data_blk = MEM_VAL_GET_INT32U(&p_map[(blk_addr % USBD_RAMDISK_MAP_NBR_ENTRIES) * sizeof(CPU_INT32U)]);
+            if (data_blk != USBD_RAMDISK_POOL_BLK_NONE) {
+                USBD_RAMDISK_PoolBlkFree(data_blk);
+                MEM_VAL_SET_INT32U(&p_map[(blk_addr % USBD_RAMDISK_MAP_NBR_ENTRIES) * sizeof(CPU_INT32U)],
+                                   USBD_RAMDISK_POOL_BLK_NONE);
+            }
+            blk_addr++;
+        }
+                                                                /* Free map blk if no blk left mapped.                  */
+        if (USBD_RAMDISK_IsZero(p_map, USBD_RAMDISK_CFG_BLK_SIZE) == DEF_YES) {
+            USBD_RAMDISK_DirTbl[lun][dir_ix] = USBD_RAMDISK_POOL_BLK_NONE;
+            USBD_RAMDISK_PoolBlkFree(map_blk);
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_RAMDISK_IsZero()
+*
+* Description : Check if a buffer only holds zeros.
+*
+* Argument(s) : p_data      Pointer to buffer.
+*
+*               len         Buffer length, in octets.
+*
+* Return(s)   : DEF_YES, if all the octets of the buffer are zero.
+*
+*               DEF_NO,  otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_RAMDISK_IsZero (CPU_INT08U  *p_data,
+                                          CPU_INT32U   len)
+{
+    CPU_INT32U  ix;
+
+
+    for (ix = 0u; ix < len; ix++) {
+        if (p_data[ix] != 0u) {
+            return (DEF_NO);
+        }
+    }
+
+    return (DEF_YES);
+}
+#endif
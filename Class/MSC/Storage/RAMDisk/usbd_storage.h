@@ -109,6 +109,33 @@ void  USBD_StorageWr         (USBD_STORAGE_LUN  *p_storage_lun,
                               CPU_INT08U        *p_data_buf,
                               USBD_ERR          *p_err);
 
+void  USBD_StorageRdAsync    (USBD_STORAGE_LUN        *p_storage_lun,
+                              CPU_INT64U               blk_addr,
+                              CPU_INT32U               nbr_blks,
+                              CPU_INT08U              *p_data_buf,
+                              USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                              void                    *p_async_arg,
+                              USBD_ERR                *p_err);
+
+void  USBD_StorageWrAsync    (USBD_STORAGE_LUN        *p_storage_lun,
+                              CPU_INT64U               blk_addr,
+                              CPU_INT32U               nbr_blks,
+                              CPU_INT08U              *p_data_buf,
+                              USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                              void                    *p_async_arg,
+                              USBD_ERR                *p_err);
+
+void  USBD_StorageUnmap      (USBD_STORAGE_LUN  *p_storage_lun,
+                              CPU_INT64U         blk_addr,
+                              CPU_INT32U         nbr_blks,
+                              USBD_ERR          *p_err);
+
+CPU_INT32U  USBD_StorageMapStatusGet(USBD_STORAGE_LUN  *p_storage_lun,
+                                     CPU_INT64U         blk_addr,
+                                     CPU_INT32U         nbr_blks,
+                                     CPU_BOOLEAN       *p_mapped,
+                                     USBD_ERR          *p_err);
+
 void  USBD_StorageStatusGet  (USBD_STORAGE_LUN  *p_storage_lun,
                               USBD_ERR          *p_err);
 
@@ -119,6 +146,10 @@ void  USBD_StorageLock       (USBD_STORAGE_LUN  *p_storage_lun,
 void  USBD_StorageUnlock     (USBD_STORAGE_LUN  *p_storage_lun,
                               USBD_ERR          *p_err);
 
+#if (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+CPU_INT32U  USBD_StoragePoolNbrFreeGet(void);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -150,6 +181,24 @@ void  USBD_StorageUnlock     (USBD_STORAGE_LUN  *p_storage_lun,
 #error  "USBD_RAMDISK_CFG_BASE_ADDR illegally #define'd in 'usbd_cfg.h' [MUST be >= 0]"
 #endif
 
+#ifndef  USBD_RAMDISK_CFG_SPARSE_EN
+#error  "USBD_RAMDISK_CFG_SPARSE_EN not #defined'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#elif  ((USBD_RAMDISK_CFG_SPARSE_EN != DEF_ENABLED) && \
+        (USBD_RAMDISK_CFG_SPARSE_EN != DEF_DISABLED))
+#error  "USBD_RAMDISK_CFG_SPARSE_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#elif   (USBD_RAMDISK_CFG_SPARSE_EN == DEF_ENABLED)
+
+#ifndef  USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS
+#error  "USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS not #defined'd in 'usbd_cfg.h' [MUST be > 0]"
+#elif   (USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS < 1u)
+#error  "USBD_RAMDISK_CFG_SPARSE_POOL_NBR_BLKS illegally #define'd in 'usbd_cfg.h' [MUST be > 0]"
+#endif
+
+#if     (USBD_RAMDISK_CFG_BLK_SIZE < 4u)
+#error  "USBD_RAMDISK_CFG_BLK_SIZE illegally #define'd in 'usbd_cfg.h' [MUST be >= 4 when sparse]"
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -0,0 +1,231 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*
+*                                 USB DEVICE MSC CLASS STORAGE DRIVER
+*
+*                                   SYNCHRONOUS DRIVER COMPATIBILITY
+*
+* Filename : usbd_storage_shim.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This file provides USBD_StorageRdAsync() and USBD_StorageWrAsync() on top of
+*                USBD_StorageRd() and USBD_StorageWr(), for storage drivers written before the
+*                asynchronous API was introduced. It is built along with such a driver, which is left
+*                unchanged.
+*
+*            (2) Each request is carried out in the caller's context, and the completion callback is
+*                called before USBD_StorageRdAsync() or USBD_StorageWrAsync() returns. The MSC task is
+*                thus blocked for the duration of each storage access, as with the synchronous API.
+*
+*            (3) Storage drivers that implement the asynchronous API natively (RAM disk, uC/FS V4, file)
+*                must not be built with this file.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#include   "../Template/usbd_storage.h"
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                     LOCAL CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageRdAsync()
+*
+* Description : Read data from the storage medium with the synchronous storage driver API and
+*               report the outcome through a completion callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*
+*                                                                       --- RETURNED BY USBD_StorageRd() : ---
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRdAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageRd(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageWrAsync()
+*
+* Description : Write data to the storage medium with the synchronous storage driver API and
+*               report the outcome through a completion callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*
+*                                                                       --- RETURNED BY USBD_StorageWr() : ---
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTSUPPORTED     Logical unit not supported.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWrAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageWr(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                                 END
+*********************************************************************************************************
+*/
@@ -229,6 +229,175 @@ void  USBD_StorageWr (USBD_STORAGE_LUN  *p_storage_lun,
 }
 
 
+/*
+*********************************************************************************************************
+*                                         USBD_StorageRdAsync()
+*
+* Description : Read data from the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request accepted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) 'async_fnct' must be called exactly once for each accepted request, from any context
+*                   (see 'usbd_scsi.h  STORAGE COMPLETION CALLBACK').
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRdAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    /* $$$$ Insert code to start reading from the storage medium, e.g. a DMA transfer. When the transfer is done, call 'async_fnct' with the transfer status. */
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageWrAsync()
+*
+* Description : Write data to the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request accepted.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) 'async_fnct' must be called exactly once for each accepted request, from any context
+*                   (see 'usbd_scsi.h  STORAGE COMPLETION CALLBACK').
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWrAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    /* $$$$ Insert code to start writing to the storage medium, e.g. a DMA transfer. When the transfer is done, call 'async_fnct' with the transfer status. */
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_StorageUnmap()
+*
+* Description : Unmap a range of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block to unmap.
+*
+*               nbr_blks         Number of logical blocks to unmap.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Blocks successfully unmapped.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Logical block address out of range.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Only called for a logical unit whose 'UnmapEn' flag was set when it was added (see
+*                   'usbd_scsi.h  STORAGE UNIT CONTROL  Note #1'). Unmapped blocks must read as zeros.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageUnmap (USBD_STORAGE_LUN  *p_storage_lun,
+                         CPU_INT64U         blk_addr,
+                         CPU_INT32U         nbr_blks,
+                         USBD_ERR          *p_err)
+{
+    /* $$$$ Insert code to deallocate the blocks, e.g. erase or trim the flash pages holding them. */
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageMapStatusGet()
+*
+* Description : Get the provisioning status of a run of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block of the run.
+*
+*               nbr_blks         Maximum number of logical blocks of the run.
+*
+*               p_mapped         Pointer to variable that will receive the status of the run :
+*
+*                                    DEF_YES    Blocks are mapped.
+*                                    DEF_NO     Blocks are deallocated.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Status successfully returned.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR            Logical block address out of range.
+*
+* Return(s)   : Number of blocks, starting at 'blk_addr', that share the status of the first block, at most
+*               'nbr_blks'.
+*
+* Note(s)     : (1) Only called for a logical unit whose 'UnmapEn' flag was set when it was added (see
+*                   'usbd_scsi.h  STORAGE UNIT CONTROL  Note #1'), to answer GET LBA STATUS. The status
+*                   must match what USBD_StorageUnmap() and USBD_StorageWr() did to the blocks.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_StorageMapStatusGet (USBD_STORAGE_LUN  *p_storage_lun,
+                                      CPU_INT64U         blk_addr,
+                                      CPU_INT32U         nbr_blks,
+                                      CPU_BOOLEAN       *p_mapped,
+                                      USBD_ERR          *p_err)
+{
+    /* $$$$ Insert code to look up the blocks, e.g. in the flash translation layer.             */
+
+   *p_mapped = DEF_YES;
+   *p_err    = USBD_ERR_NONE;
+
+    return (nbr_blks);
+}
+
+
 /*
 *********************************************************************************************************
 *                                       USBD_StorageStatusGet()
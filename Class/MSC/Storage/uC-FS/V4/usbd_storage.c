@@ -75,10 +75,10 @@
 
 #if (USBD_MSC_CFG_FS_REFRESH_TASK_EN == DEF_ENABLED)
                                                                 /* Tbl of dev to be polled.                             */
-static  USBD_STORAGE_LUN  *USBD_FS_StorageDevPollList[USBD_MSC_CFG_MAX_LUN];
+static  USBD_STORAGE_LUN  *USBD_FS_StorageDevPollList[USBD_SCSI_STORAGE_LUN_QTY];
 #endif
                                                                 /* Cached luns state.                                   */
-static  CPU_BOOLEAN        USBD_FS_LunStatePresent[USBD_MSC_CFG_MAX_LUN];
+static  CPU_BOOLEAN        USBD_FS_LunStatePresent[USBD_SCSI_STORAGE_LUN_QTY];
 
 
 /*
@@ -128,7 +128,7 @@ void  USBD_StorageInit (USBD_ERR  *p_err)
     CPU_INT08U  ix;
 
 
-    for (ix = 0; ix < USBD_MSC_CFG_MAX_LUN; ix++) {
+    for (ix = 0; ix < USBD_SCSI_STORAGE_LUN_QTY; ix++) {
 #if (USBD_MSC_CFG_FS_REFRESH_TASK_EN == DEF_ENABLED)
         USBD_FS_StorageDevPollList[ix] = (USBD_STORAGE_LUN *)0u;
 #endif
@@ -369,6 +369,201 @@ void  USBD_StorageWr (USBD_STORAGE_LUN  *p_storage_lun,
 }
 
 
+/*
+*********************************************************************************************************
+*                                         USBD_StorageRdAsync()
+*
+* Description : Read data from the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting read block.
+*
+*               nbr_blks         Number of logical blocks to read.
+*
+*               p_data_buf       Pointer to buffer in which data will be stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) uC/FS V4 device accesses block until the operation is done: the request is carried out
+*                   in the caller's context and 'async_fnct' is called before returning.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageRdAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageRd(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,                                   /* See Note #1.                                         */
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_StorageWrAsync()
+*
+* Description : Write data to the storage medium and report the outcome through a completion
+*               callback.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of starting write block.
+*
+*               nbr_blks         Number of logical blocks to write.
+*
+*               p_data_buf       Pointer to buffer in which data is stored.
+*
+*               async_fnct       Function called when the request completes.
+*
+*               p_async_arg      Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_NONE                           Request completed.
+*                               USBD_ERR_SCSI_LOG_UNIT_NOTRDY           Logical unit cannot perform
+*                                                                           operations.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) uC/FS V4 device accesses block until the operation is done: the request is carried out
+*                   in the caller's context and 'async_fnct' is called before returning.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageWrAsync (USBD_STORAGE_LUN        *p_storage_lun,
+                           CPU_INT64U               blk_addr,
+                           CPU_INT32U               nbr_blks,
+                           CPU_INT08U              *p_data_buf,
+                           USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                           void                    *p_async_arg,
+                           USBD_ERR                *p_err)
+{
+    USBD_StorageWr(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    async_fnct(p_storage_lun,                                   /* See Note #1.                                         */
+               p_data_buf,
+               nbr_blks,
+               p_async_arg,
+               USBD_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_StorageUnmap()
+*
+* Description : Unmap a range of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block to unmap.
+*
+*               nbr_blks         Number of logical blocks to unmap.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           Blocks cannot be unmapped.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) uC/FS volumes are not reported as thin provisioned ('UnmapEn' is not set), so the SCSI
+*                   layer never calls this function.
+*********************************************************************************************************
+*/
+
+void  USBD_StorageUnmap (USBD_STORAGE_LUN  *p_storage_lun,
+                         CPU_INT64U         blk_addr,
+                         CPU_INT32U         nbr_blks,
+                         USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;                      /* See Note #1.                                         */
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_StorageMapStatusGet()
+*
+* Description : Get the provisioning status of a run of blocks of a thin provisioned storage medium.
+*
+* Argument(s) : p_storage_lun    Pointer to the logical unit storage structure.
+*
+*               blk_addr         Logical Block Address (LBA) of first block of the run.
+*
+*               nbr_blks         Maximum number of logical blocks of the run.
+*
+*               p_mapped         Pointer to variable that will receive the status of the run :
+*
+*                                    DEF_YES    Blocks are mapped.
+*                                    DEF_NO     Blocks are deallocated.
+*
+*               p_err       Pointer to variable that will receive error code from this function.
+*
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD           Medium not thin provisioned.
+*
+* Return(s)   : 0.
+*
+* Note(s)     : (1) uC/FS volumes are not reported as thin provisioned ('UnmapEn' is not set), so the SCSI
+*                   layer never calls this function.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_StorageMapStatusGet (USBD_STORAGE_LUN  *p_storage_lun,
+                                      CPU_INT64U         blk_addr,
+                                      CPU_INT32U         nbr_blks,
+                                      CPU_BOOLEAN       *p_mapped,
+                                      USBD_ERR          *p_err)
+{
+    (void)p_storage_lun;
+    (void)blk_addr;
+    (void)nbr_blks;
+
+   *p_mapped = DEF_YES;
+   *p_err    = USBD_ERR_SCSI_UNSUPPORTED_CMD;                   /* See Note #1.                                         */
+
+    return (0u);
+}
+
+
 /*
 *********************************************************************************************************
 *                                            USBD_StorageStatusGet()
@@ -555,7 +750,7 @@ void  USBD_StorageRefreshTaskHandler (void *p_arg)
 
     (void)p_arg;
                                                                 /* ------ POLLING LIST PROCESSING (see Note #1) ------- */
-    for (i = 0u; i < USBD_MSC_CFG_MAX_LUN; i++) {
+    for (i = 0u; i < USBD_SCSI_STORAGE_LUN_QTY; i++) {
 
         if (USBD_FS_StorageDevPollList[i] != (USBD_STORAGE_LUN *)0u) {
                                                                 /* Get status of removable media.                       */
@@ -113,6 +113,33 @@ void  USBD_StorageWr                (USBD_STORAGE_LUN  *p_storage_lun,
                                      CPU_INT08U        *p_data_buf,
                                      USBD_ERR          *p_err);
 
+void  USBD_StorageRdAsync           (USBD_STORAGE_LUN        *p_storage_lun,
+                                     CPU_INT64U               blk_addr,
+                                     CPU_INT32U               nbr_blks,
+                                     CPU_INT08U              *p_data_buf,
+                                     USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                                     void                    *p_async_arg,
+                                     USBD_ERR                *p_err);
+
+void  USBD_StorageWrAsync           (USBD_STORAGE_LUN        *p_storage_lun,
+                                     CPU_INT64U               blk_addr,
+                                     CPU_INT32U               nbr_blks,
+                                     CPU_INT08U              *p_data_buf,
+                                     USBD_STORAGE_ASYNC_FNCT  async_fnct,
+                                     void                    *p_async_arg,
+                                     USBD_ERR                *p_err);
+
+void  USBD_StorageUnmap             (USBD_STORAGE_LUN  *p_storage_lun,
+                                     CPU_INT64U         blk_addr,
+                                     CPU_INT32U         nbr_blks,
+                                     USBD_ERR          *p_err);
+
+CPU_INT32U  USBD_StorageMapStatusGet(USBD_STORAGE_LUN  *p_storage_lun,
+                                     CPU_INT64U         blk_addr,
+                                     CPU_INT32U         nbr_blks,
+                                     CPU_BOOLEAN       *p_mapped,
+                                     USBD_ERR          *p_err);
+
 void  USBD_StorageStatusGet         (USBD_STORAGE_LUN  *p_storage_lun,
                                      USBD_ERR          *p_err);
 
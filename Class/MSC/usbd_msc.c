@@ -102,6 +102,7 @@
 #define  USBD_MSC_PROTOCOL_CODE_CTRL_BULK_INTR_CMD_INTR  0x00
 #define  USBD_MSC_PROTOCOL_CODE_CTRL_BULK_INTR           0x01
 #define  USBD_MSC_PROTOCOL_CODE_BULK_ONLY                0x50
+#define  USBD_MSC_PROTOCOL_CODE_UAS                      0x62
 
 /*
 *********************************************************************************************************
@@ -161,6 +162,107 @@
 #define  USBD_MSC_BCSWSTATUS_CMD_FAILED                  0x01
 #define  USBD_MSC_BCSWSTATUS_PHASE_ERROR                 0x02
 
+/*
+*********************************************************************************************************
+*                                       USB ATTACHED SCSI DEFINES
+*
+* Note(s) : (1) See 'Universal Serial Bus Mass Storage Class - USB Attached SCSI Protocol (UASP)',
+*               Revision 1.0 and 'USB Attached SCSI - 2' (UAS-2), Revision 4.
+*
+*           (2) Each endpoint descriptor of the UAS alternate setting is followed by a Pipe Usage
+*               descriptor identifying the role of the pipe (see UASP Section 5.3.3.1).
+*
+*           (3) Information units (IU) are exchanged on the command and status pipes. Multi-octet
+*               fields are big-endian. Tags are 16-bit and the logical unit number is given on 8 octets,
+*               of which only the single level format (octet 1) is supported.
+*********************************************************************************************************
+*/
+
+#define  USBD_MSC_UAS_IF_ALT_NBR                           1u
+
+#define  USBD_MSC_UAS_DESC_TYPE_PIPE_USAGE              0x24   /* See Note #2.                                         */
+#define  USBD_MSC_UAS_DESC_LEN_PIPE_USAGE                  4u
+
+#define  USBD_MSC_UAS_PIPE_ID_NONE                         0u
+#define  USBD_MSC_UAS_PIPE_ID_CMD                          1u
+#define  USBD_MSC_UAS_PIPE_ID_STATUS                       2u
+#define  USBD_MSC_UAS_PIPE_ID_DATA_IN                      3u
+#define  USBD_MSC_UAS_PIPE_ID_DATA_OUT                     4u
+
+                                                                /* ------------- IU IDs (see Note #3) ----------------- */
+#define  USBD_MSC_UAS_IU_ID_CMD                         0x01
+#define  USBD_MSC_UAS_IU_ID_SENSE                       0x03
+#define  USBD_MSC_UAS_IU_ID_RESP                        0x04
+#define  USBD_MSC_UAS_IU_ID_TASK_MGMT                   0x05
+#define  USBD_MSC_UAS_IU_ID_RD_RDY                      0x06
+#define  USBD_MSC_UAS_IU_ID_WR_RDY                      0x07
+
+#define  USBD_MSC_UAS_IU_LEN_HDR                           4u   /* IU ID, rsvd and tag.                                 */
+#define  USBD_MSC_UAS_IU_LEN_RDY                           4u
+#define  USBD_MSC_UAS_IU_LEN_RESP                          8u
+#define  USBD_MSC_UAS_IU_LEN_TASK_MGMT                    16u
+#define  USBD_MSC_UAS_IU_LEN_SENSE                        16u   /* Without sense data.                                  */
+#define  USBD_MSC_UAS_IU_LEN_CMD                          32u   /* Without additional CDB octets.                       */
+
+#define  USBD_MSC_UAS_SENSE_DATA_LEN                      18u   /* Fixed format sense data.                             */
+#define  USBD_MSC_UAS_SENSE_RESP_CODE_CUR               0x70
+#define  USBD_MSC_UAS_SENSE_ADDL_LEN                      10u
+#define  USBD_MSC_UAS_SENSE_KEY_ABORTED_CMD             0x0B   /* Sense key of a cmd whose USB xfer failed.            */
+#define  USBD_MSC_UAS_IU_LEN_SENSE_MAX                  (USBD_MSC_UAS_IU_LEN_SENSE + USBD_MSC_UAS_SENSE_DATA_LEN)
+
+                                                                /* ------------ TASK MANAGEMENT FUNCTIONS ------------- */
+#define  USBD_MSC_UAS_TMF_ABORT_TASK                    0x01
+#define  USBD_MSC_UAS_TMF_ABORT_TASK_SET                0x02
+#define  USBD_MSC_UAS_TMF_CLR_TASK_SET                  0x04
+#define  USBD_MSC_UAS_TMF_LU_RESET                      0x08
+#define  USBD_MSC_UAS_TMF_IT_NEXUS_RESET                0x10
+#define  USBD_MSC_UAS_TMF_QUERY_TASK                    0x80
+
+                                                                /* ------------------ RESPONSE CODES ------------------ */
+#define  USBD_MSC_UAS_RESP_TMF_COMPLETE                 0x00
+#define  USBD_MSC_UAS_RESP_INVALID_IU                   0x02
+#define  USBD_MSC_UAS_RESP_TMF_NOT_SUPPORTED            0x04
+#define  USBD_MSC_UAS_RESP_TMF_SUCCEEDED                0x08
+#define  USBD_MSC_UAS_RESP_INCORRECT_LUN                0x09
+#define  USBD_MSC_UAS_RESP_OVERLAPPED_TAG               0x0A
+
+                                                                /* ---------------- SCSI STATUS CODES ----------------- */
+#define  USBD_MSC_UAS_STATUS_GOOD                       0x00
+#define  USBD_MSC_UAS_STATUS_CHECK_CONDITION            0x02
+#define  USBD_MSC_UAS_STATUS_TASK_SET_FULL              0x28
+
+                                                                /* ------------ COMMAND PIPE RX STATES ---------------- */
+#define  USBD_MSC_UAS_IU_RX_STATE_IDLE                     0u   /* No rx armed.                                         */
+#define  USBD_MSC_UAS_IU_RX_STATE_PEND                     1u   /* Async rx armed.                                      */
+#define  USBD_MSC_UAS_IU_RX_STATE_CMPL                     2u   /* IU rx'd, waiting to be processed.                    */
+
+                                                                /* ------------------- TASK STATES -------------------- */
+#define  USBD_MSC_UAS_TASK_STATE_FREE                      0u   /* Task not in use.                                     */
+#define  USBD_MSC_UAS_TASK_STATE_DATA_IN                   1u   /* Data-in stage: storage rd and bulk-IN xfers.         */
+#define  USBD_MSC_UAS_TASK_STATE_DATA_OUT                  2u   /* Waiting for a data buf to start data-out stage.      */
+#define  USBD_MSC_UAS_TASK_STATE_STATUS                    3u   /* Waiting for sense IU to be tx'd.                     */
+
+#define  USBD_MSC_UAS_TASK_IX_NONE           DEF_INT_08U_MAX_VAL
+                                                                /* Bufs kept for the data-in pipe owner.                */
+#define  USBD_MSC_UAS_BUF_NBR_RSVD          (USBD_MSC_CFG_DATA_NBR_BUF / 2u)
+#define  USBD_MSC_UAS_CBW_ABORT_RETRY_MAX                100u   /* Max nbr of CBW rx abort retries, 1 ms apart.         */
+
+
+/*
+*********************************************************************************************************
+*                                        DATA BUFFER STATES
+*
+* Note(s) : (1) When more than one data buffer is configured, each buffer of a pipelined READ data stage
+*               goes through these states, in order (see 'USBD_MSC_SCSI_RdAsync()  Note #1'). The UAS
+*               transport uses the FREE, RD and RDY states for the data-in stages of all its tasks.
+*********************************************************************************************************
+*/
+
+#define  USBD_MSC_DATA_BUF_STATE_FREE                      0u   /* Buf not in use.                                      */
+#define  USBD_MSC_DATA_BUF_STATE_RD                        1u   /* Storage rd in progress into buf.                     */
+#define  USBD_MSC_DATA_BUF_STATE_RDY                       2u   /* Buf filled, waiting to be tx'd.                      */
+#define  USBD_MSC_DATA_BUF_STATE_TX                        3u   /* Bulk-IN xfer of buf in progress.                     */
+
 
 /*
 *********************************************************************************************************
@@ -226,6 +328,7 @@ typedef  struct  usbd_msc_csw {
 */
 
 typedef struct usbd_msc_ctrl  USBD_MSC_CTRL;
+typedef struct usbd_msc_comm  USBD_MSC_COMM;
 
 
 /*
@@ -253,13 +356,48 @@ typedef  enum  usbd_msc_comm_state {
 } USBD_MSC_COMM_STATE;
 
 
+/*
+*********************************************************************************************************
+*                                          UAS TASK DATA TYPE
+*
+* Note(s) : (1) Each command queued by the host on the UAS command pipe is held by a task until its
+*               Sense IU is sent. Until its READ READY IU is sent, a task holds at most one data buffer,
+*               so that the first blocks of several commands are read from the storage media concurrently
+*               and the command whose read completes first is transferred first. The task that owns the
+*               data-in pipe then pipelines the rest of its data stage in all the free buffers.
+*
+*           (2) 'BufIxTbl' is a circular queue of the data buffers held by the task, in data stage
+*               order.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+typedef  struct  usbd_msc_uas_task {
+    CPU_INT08U          State;                                  /* Task state.                                          */
+    CPU_BOOLEAN         Abort;                                  /* Task aborted, waiting for storage rd in flight.      */
+    CPU_INT16U          Tag;                                    /* Tag given by host in cmd IU.                         */
+    CPU_INT08U          Lun;                                    /* Logical unit addressed by cmd.                       */
+    CPU_INT08U          CDB[16];                                /* Cmd desc blk.                                        */
+    CPU_INT32U          DataRemLen;                             /* Data stage len not yet rd from storage or rx'd.      */
+    CPU_INT08U          RdPendCnt;                              /* Nbr of storage rd in flight.                         */
+                                                                /* Data bufs held by task (see Note #2).                */
+    CPU_INT08U          BufIxTbl[USBD_MSC_CFG_DATA_NBR_BUF];
+    CPU_INT08U          BufIxHead;
+    CPU_INT08U          BufCnt;
+    USBD_ERR            Err;                                    /* First err rpt'd for the cmd.                         */
+    USBD_MSC_COMM      *CommPtr;                                /* Ptr to MSC comm.                                     */
+    USBD_SCSI_CMD_CTX   Cmd;                                    /* SCSI cmd ctx.                                        */
+} USBD_MSC_UAS_TASK;
+#endif
+
+
 /*
 **********************************************************************************************************
 *                                       MSC EP REQUIREMENTS DATA TYPE
 **********************************************************************************************************
 */
 
-typedef struct usbd_msc_comm {                                  /* ---------- MSC COMMUNICATION INFORMATION ----------- */
+struct usbd_msc_comm {                                          /* ---------- MSC COMMUNICATION INFORMATION ----------- */
     USBD_MSC_CTRL       *CtrlPtr;                               /* Ptr to ctrl information.                             */
     CPU_INT08U           DataBulkInEpAddr;
     CPU_INT08U           DataBulkOutEpAddr;
@@ -270,10 +408,37 @@ typedef struct usbd_msc_comm {                                  /* ---------- MS
     CPU_INT32U           BytesToXfer;                           /* Current bytes to xfer during data xfer stage.        */
     void                *SCSIWrBufPtr;                          /* Ptr to the SCSI buf used to wr to SCSI.              */
     CPU_INT32U           SCSIWrBuflen;                          /* SCSI buf len used to wr to SCSI.                     */
-} USBD_MSC_COMM;
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+    USBD_ERR             DataXferErr;                           /* First err rpt'd by an async data stage xfer.         */
+                                                                /* Len rd or rx'd in each data buf by async xfers.      */
+    CPU_INT32U           DataXferLenTbl[USBD_MSC_CFG_DATA_NBR_BUF];
+                                                                /* State of each data buf during pipelined rd.          */
+    CPU_INT08U           DataBufStateTbl[USBD_MSC_CFG_DATA_NBR_BUF];
+#endif
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    CPU_INT08U           UAS_CmdEpAddr;                         /* UAS cmd      pipe (bulk-OUT).                        */
+    CPU_INT08U           UAS_StatusEpAddr;                      /* UAS status   pipe (bulk-IN).                         */
+    CPU_INT08U           UAS_DataInEpAddr;                      /* UAS data-in  pipe (bulk-IN).                         */
+    CPU_INT08U           UAS_DataOutEpAddr;                     /* UAS data-out pipe (bulk-OUT).                        */
+    CPU_BOOLEAN          UAS_En;                                /* UAS alt setting selected by host.                    */
+    CPU_INT32U           UAS_SignalCnt;                         /* Data signal posts not yet pended.                    */
+    CPU_INT08U           UAS_IU_RxState;                        /* Cmd pipe rx state.                                   */
+    CPU_INT32U           UAS_IU_RxLen;                          /* Len of IU rx'd on cmd pipe.                          */
+    USBD_ERR             UAS_IU_RxErr;                          /* Status of cmd pipe rx.                               */
+    CPU_INT08U           UAS_RespLen;                           /* Len of IU waiting to be tx'd by itself, 0 if none.   */
+    CPU_INT08U           UAS_DataInTaskIx;                      /* Task owning the data-in pipe.                        */
+    CPU_INT08U           UAS_TaskIxNext;                        /* Next task to serve on status pipe.                   */
+    USBD_MSC_UAS_TASK   *UAS_XferTaskPtr;                       /* Task whose data pipe xfer is in progress.            */
+    CPU_BOOLEAN          CBW_RxPend;                            /* MSC task rx'ing a CBW (see USBD_MSC_RxCBW()).        */
+                                                                /* Tasks (see 'UAS TASK DATA TYPE  Note #1').           */
+    USBD_MSC_UAS_TASK    UAS_TaskTbl[USBD_MSC_CFG_UAS_QUEUE_DEPTH];
+#endif
+};
 
 
 struct usbd_msc_ctrl {                                          /* ------------- MSC CONTROL INFORMATION -------------- */
+    CPU_INT08U         ClassNbr;                                /* MSC class instance nbr.                              */
     CPU_INT08U         DevNbr;                                  /* MSC dev nbr.                                         */
     USBD_MSC_STATE     State;                                   /* MSC dev state.                                       */
     CPU_INT08U         MaxLun;                                  /* Max logical unit number (LUN).                       */
@@ -281,8 +446,14 @@ struct usbd_msc_ctrl {                                          /* -------------
     USBD_MSC_COMM     *CommPtr;                                 /* MSC comm info ptr.                                   */
     CPU_INT08U        *CBW_BufPtr;                              /* Buf to rx Cmd Blk  Wrapper.                          */
     CPU_INT08U        *CSW_BufPtr;                              /* Buf to send Cmd Status Wrapper.                      */
-    CPU_INT08U        *DataBufPtr;                              /* Buf to handle data stage.                            */
+                                                                /* Bufs to handle data stage.                           */
+    CPU_INT08U        *DataBufPtrTbl[USBD_MSC_CFG_DATA_NBR_BUF];
     CPU_INT08U        *CtrlStatusBufPtr;                        /* Buf used for ctrl status xfers.                      */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    CPU_INT08U        *UAS_IU_BufPtr;                           /* Buf to rx IUs on UAS cmd pipe.                       */
+    CPU_INT08U        *UAS_StatusBufPtr;                        /* Buf to tx IUs on UAS status pipe.                    */
+    CPU_INT08U        *UAS_RespBufPtr;                          /* Buf holding an IU waiting to be tx'd by itself.      */
+#endif
     CPU_INT32U         USBD_MSC_SCSI_Data_Len;
     CPU_INT08U         USBD_MSC_SCSI_Data_Dir;
 };
@@ -361,10 +532,29 @@ static  void                 USBD_MSC_RespVerify    (      USBD_MSC_COMM      *p
 static  void                 USBD_MSC_SCSI_TxData   (      USBD_MSC_CTRL      *p_ctrl,
                                                            USBD_MSC_COMM      *p_comm);
 
-static  void                 USBD_MSC_SCSI_Rd       (      USBD_MSC_CTRL      *p_ctrl,
+#if (USBD_MSC_CFG_DATA_NBR_BUF == 1u)
+static  CPU_BOOLEAN          USBD_MSC_SCSI_Rd       (      USBD_MSC_CTRL      *p_ctrl,
                                                            USBD_MSC_COMM      *p_comm);
+#else
+static  void                 USBD_MSC_SCSI_RdAsync  (      USBD_MSC_CTRL      *p_ctrl,
+                                                           USBD_MSC_COMM      *p_comm,
+                                                           USBD_ERR           *p_err);
+
+static  void                 USBD_MSC_SCSI_RdCmpl   (      CPU_INT08U         *p_buf,
+                                                           CPU_INT32U          data_len,
+                                                           void               *p_arg,
+                                                           USBD_ERR            err);
+
+static  void                 USBD_MSC_SCSI_TxCmpl   (      CPU_INT08U          dev_nbr,
+                                                           CPU_INT08U          ep_addr,
+                                                           void               *p_buf,
+                                                           CPU_INT32U          buf_len,
+                                                           CPU_INT32U          xfer_len,
+                                                           void               *p_arg,
+                                                           USBD_ERR            err);
+#endif
 
-static  void                 USBD_MSC_SCSI_Wr       (const USBD_MSC_CTRL      *p_ctrl,
+static  void                 USBD_MSC_SCSI_Wr       (      USBD_MSC_CTRL      *p_ctrl,
                                                            USBD_MSC_COMM      *p_comm,
                                                            void               *p_buf,
                                                            CPU_INT32U          xfer_len);
@@ -372,6 +562,20 @@ static  void                 USBD_MSC_SCSI_Wr       (const USBD_MSC_CTRL      *p
 static  void                 USBD_MSC_SCSI_RxData   (      USBD_MSC_CTRL      *p_ctrl,
                                                            USBD_MSC_COMM      *p_comm);
 
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void                 USBD_MSC_SCSI_WrAsync  (      USBD_MSC_CTRL      *p_ctrl,
+                                                           USBD_MSC_COMM      *p_comm,
+                                                           USBD_ERR           *p_err);
+
+static  void                 USBD_MSC_SCSI_RxCmpl   (      CPU_INT08U          dev_nbr,
+                                                           CPU_INT08U          ep_addr,
+                                                           void               *p_buf,
+                                                           CPU_INT32U          buf_len,
+                                                           CPU_INT32U          xfer_len,
+                                                           void               *p_arg,
+                                                           USBD_ERR            err);
+#endif
+
 static  void                 USBD_MSC_LunClr        (      USBD_MSC_LUN_CTRL  *p_lun);
 
 static  void                 USBD_MSC_CBW_Parse     (      USBD_MSC_CBW       *p_cbw,
@@ -380,6 +584,114 @@ static  void                 USBD_MSC_CBW_Parse     (      USBD_MSC_CBW       *p
 static  void                 USBD_MSC_CSW_Fmt       (const USBD_MSC_CSW       *p_csw,
                                                            void               *p_buf_dest);
 
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void                 USBD_MSC_AltSettingUpdate     (      CPU_INT08U          dev_nbr,
+                                                                  CPU_INT08U          cfg_nbr,
+                                                                  CPU_INT08U          if_nbr,
+                                                                  CPU_INT08U          if_alt_nbr,
+                                                                  void               *p_if_class_arg,
+                                                                  void               *p_if_alt_class_arg);
+
+static  void                 USBD_MSC_UAS_EP_Desc          (      CPU_INT08U          dev_nbr,
+                                                                  CPU_INT08U          cfg_nbr,
+                                                                  CPU_INT08U          if_nbr,
+                                                                  CPU_INT08U          if_alt_nbr,
+                                                                  CPU_INT08U          ep_addr,
+                                                                  void               *p_if_class_arg,
+                                                                  void               *p_if_alt_class_arg);
+
+static  CPU_INT16U           USBD_MSC_UAS_EP_DescSizeGet   (      CPU_INT08U          dev_nbr,
+                                                                  CPU_INT08U          cfg_nbr,
+                                                                  CPU_INT08U          if_nbr,
+                                                                  CPU_INT08U          if_alt_nbr,
+                                                                  CPU_INT08U          ep_addr,
+                                                                  void               *p_if_class_arg,
+                                                                  void               *p_if_alt_class_arg);
+
+static  CPU_INT08U           USBD_MSC_UAS_PipeID_Get       (const USBD_MSC_COMM      *p_comm,
+                                                                  CPU_INT08U          if_alt_nbr,
+                                                                  CPU_INT08U          ep_addr);
+
+static  void                 USBD_MSC_UAS_Process          (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_Reset            (      USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_SignalPost       (      USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_SignalPend       (      USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_IU_RxStart       (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_IU_RxCmpl        (      CPU_INT08U          dev_nbr,
+                                                                  CPU_INT08U          ep_addr,
+                                                                  void               *p_buf,
+                                                                  CPU_INT32U          buf_len,
+                                                                  CPU_INT32U          xfer_len,
+                                                                  void               *p_arg,
+                                                                  USBD_ERR            err);
+
+static  void                 USBD_MSC_UAS_IU_Process       (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_CmdIU_Process    (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                           const  CPU_INT08U         *p_iu);
+
+static  void                 USBD_MSC_UAS_TMF_IU_Process   (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                           const  CPU_INT08U         *p_iu);
+
+static  void                 USBD_MSC_UAS_RespSet          (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  CPU_INT08U          iu_id,
+                                                                  CPU_INT16U          tag,
+                                                                  CPU_INT08U          code);
+
+static  CPU_BOOLEAN          USBD_MSC_UAS_RdStart          (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm);
+
+static  void                 USBD_MSC_UAS_TaskRd           (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task,
+                                                                  CPU_INT08U          buf_ix);
+
+static  void                 USBD_MSC_UAS_RdCmpl           (      CPU_INT08U         *p_buf,
+                                                                  CPU_INT32U          data_len,
+                                                                  void               *p_arg,
+                                                                  USBD_ERR            err);
+
+static  CPU_BOOLEAN          USBD_MSC_UAS_PipeProcess      (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm);
+
+static  CPU_BOOLEAN          USBD_MSC_UAS_DataTx           (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task);
+
+static  void                 USBD_MSC_UAS_DataRx           (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task);
+
+static  void                 USBD_MSC_UAS_RdyTx            (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task,
+                                                                  CPU_INT08U          iu_id);
+
+static  void                 USBD_MSC_UAS_SenseTx          (      USBD_MSC_CTRL      *p_ctrl,
+                                                                  USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task);
+
+static  void                 USBD_MSC_UAS_TaskAbort        (      USBD_MSC_COMM      *p_comm,
+                                                                  CPU_INT08U          task_ix);
+
+static  void                 USBD_MSC_UAS_TaskBufRelease   (      USBD_MSC_COMM      *p_comm,
+                                                                  USBD_MSC_UAS_TASK  *p_task);
+
+static  CPU_INT08U           USBD_MSC_UAS_BufFreeGet       (      USBD_MSC_COMM      *p_comm,
+                                                                  CPU_INT08U          nbr_rsvd);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -390,12 +702,21 @@ static  void                 USBD_MSC_CSW_Fmt       (const USBD_MSC_CSW       *p
 USBD_CLASS_DRV USBD_MSC_Drv = {
     USBD_MSC_Conn,
     USBD_MSC_Disconn,
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    USBD_MSC_AltSettingUpdate,                                  /* Select Bulk-Only or UAS transport.                   */
+#else
     DEF_NULL,                                                   /* MSC does NOT use alternate IF(s).                    */
+#endif
     USBD_MSC_EP_StateUpdate,
     DEF_NULL,                                                   /* MSC does NOT use IF functional desc.                 */
     DEF_NULL,
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    USBD_MSC_UAS_EP_Desc,                                       /* UAS pipe usage desc.                                 */
+    USBD_MSC_UAS_EP_DescSizeGet,
+#else
     DEF_NULL,                                                   /* MSC does NOT use EP functional desc.                 */
     DEF_NULL,
+#endif
     DEF_NULL,                                                   /* MSC does NOT handle std req with IF recipient.       */
     USBD_MSC_ClassReq,
     DEF_NULL,
@@ -442,6 +763,7 @@ USBD_CLASS_DRV USBD_MSC_Drv = {
 void  USBD_MSC_Init (USBD_ERR  *p_err)
 {
     CPU_INT08U      ix;
+    CPU_INT08U      buf_ix;
     USBD_MSC_CTRL  *p_ctrl;
     USBD_MSC_COMM  *p_comm;
     LIB_ERR         err_lib;
@@ -455,6 +777,7 @@ void  USBD_MSC_Init (USBD_ERR  *p_err)
 
     for (ix = 0u; ix < USBD_MSC_CFG_MAX_NBR_DEV; ix++) {        /* Init MSC class struct.                               */
         p_ctrl                         = &USBD_MSCCtrlTbl[ix];
+        p_ctrl->ClassNbr               =  ix;
         p_ctrl->State                  =  USBD_MSC_STATE_NONE;
         p_ctrl->CommPtr                = (USBD_MSC_COMM *)0;
         p_ctrl->MaxLun                 = (CPU_INT08U     )0;
@@ -485,17 +808,19 @@ void  USBD_MSC_Init (USBD_ERR  *p_err)
         Mem_Clr((void *)p_ctrl->CSW_BufPtr,
                         USBD_MSC_LEN_CSW);
 
-        p_ctrl->DataBufPtr = (CPU_INT08U *)Mem_HeapAlloc(              USBD_MSC_CFG_DATA_LEN,
-                                                                       USBD_CFG_BUF_ALIGN_OCTETS,
-                                                         (CPU_SIZE_T *)DEF_NULL,
-                                                                      &err_lib);
-        if (err_lib != LIB_MEM_ERR_NONE) {
-           *p_err = USBD_ERR_ALLOC;
-            return;
-        }
+        for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+            p_ctrl->DataBufPtrTbl[buf_ix] = (CPU_INT08U *)Mem_HeapAlloc(              USBD_MSC_CFG_DATA_LEN,
+                                                                                      USBD_CFG_BUF_ALIGN_OCTETS,
+                                                                        (CPU_SIZE_T *)DEF_NULL,
+                                                                                     &err_lib);
+            if (err_lib != LIB_MEM_ERR_NONE) {
+               *p_err = USBD_ERR_ALLOC;
+                return;
+            }
 
-        Mem_Clr((void *)p_ctrl->DataBufPtr,
-                        USBD_MSC_CFG_DATA_LEN);
+            Mem_Clr((void *)p_ctrl->DataBufPtrTbl[buf_ix],
+                            USBD_MSC_CFG_DATA_LEN);
+        }
 
         p_ctrl->CtrlStatusBufPtr = (CPU_INT08U *)Mem_HeapAlloc(               sizeof(CPU_ADDR),
                                                                               USBD_CFG_BUF_ALIGN_OCTETS,
@@ -505,6 +830,35 @@ void  USBD_MSC_Init (USBD_ERR  *p_err)
            *p_err = USBD_ERR_ALLOC;
             return;
         }
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+        p_ctrl->UAS_IU_BufPtr = (CPU_INT08U *)Mem_HeapAlloc(              USBD_MSC_UAS_IU_LEN_CMD,
+                                                                          USBD_CFG_BUF_ALIGN_OCTETS,
+                                                            (CPU_SIZE_T *)DEF_NULL,
+                                                                         &err_lib);
+        if (err_lib != LIB_MEM_ERR_NONE) {
+           *p_err = USBD_ERR_ALLOC;
+            return;
+        }
+
+        p_ctrl->UAS_StatusBufPtr = (CPU_INT08U *)Mem_HeapAlloc(              USBD_MSC_UAS_IU_LEN_SENSE_MAX,
+                                                                             USBD_CFG_BUF_ALIGN_OCTETS,
+                                                               (CPU_SIZE_T *)DEF_NULL,
+                                                                            &err_lib);
+        if (err_lib != LIB_MEM_ERR_NONE) {
+           *p_err = USBD_ERR_ALLOC;
+            return;
+        }
+
+        p_ctrl->UAS_RespBufPtr = (CPU_INT08U *)Mem_HeapAlloc(              USBD_MSC_UAS_IU_LEN_SENSE_MAX,
+                                                                           USBD_CFG_BUF_ALIGN_OCTETS,
+                                                             (CPU_SIZE_T *)DEF_NULL,
+                                                                          &err_lib);
+        if (err_lib != LIB_MEM_ERR_NONE) {
+           *p_err = USBD_ERR_ALLOC;
+            return;
+        }
+#endif
     }
 
     for (ix = 0u; ix < USBD_MSC_COM_NBR_MAX; ix++) {            /* Init test class EP tbl.                              */
@@ -532,6 +886,24 @@ void  USBD_MSC_Init (USBD_ERR  *p_err)
         p_comm->BytesToXfer                = (CPU_INT32U )0;
         p_comm->SCSIWrBufPtr               = (void      *)0;
         p_comm->SCSIWrBuflen               = (CPU_INT32U )0;
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+        p_comm->DataXferErr                =  USBD_ERR_NONE;
+        Mem_Clr((void     *)&p_comm->DataXferLenTbl[0],
+                (CPU_SIZE_T) sizeof(p_comm->DataXferLenTbl));
+        Mem_Clr((void     *)&p_comm->DataBufStateTbl[0],        /* All bufs FREE.                                       */
+                (CPU_SIZE_T) sizeof(p_comm->DataBufStateTbl));
+#endif
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+        p_comm->UAS_CmdEpAddr              =  USBD_EP_ADDR_NONE;
+        p_comm->UAS_StatusEpAddr           =  USBD_EP_ADDR_NONE;
+        p_comm->UAS_DataInEpAddr           =  USBD_EP_ADDR_NONE;
+        p_comm->UAS_DataOutEpAddr          =  USBD_EP_ADDR_NONE;
+        p_comm->UAS_En                     =  DEF_NO;
+        p_comm->UAS_SignalCnt              =  0u;
+        p_comm->CBW_RxPend                 =  DEF_NO;
+        USBD_MSC_UAS_Reset(p_comm);
+#endif
     }
 
     USBD_MSCCtrlNbrNext = 0u;
@@ -651,6 +1023,9 @@ CPU_INT08U  USBD_MSC_Add (USBD_ERR  *p_err)
 *                   |-- Endpoint Descriptor (Bulk OUT)
 *                   |-- Endpoint Descriptor (Bulk IN)
 *
+*                   When USBD_MSC_CFG_UAS_EN is enabled, the interface has a second alternate setting, that
+*                   uses the USB Attached SCSI protocol (see Note #2).
+*
 *                   If USBD_MSC_CfgAdd() is called several times from the application, it allows to create
 *                   multiple instances and multiple configurations. For instance, the following architecture
 *                   could be created for an high-speed device:
@@ -667,6 +1042,15 @@ CPU_INT08U  USBD_MSC_Add (USBD_ERR  *p_err)
 *                   is composed of two interfaces. Each class instance has an association with one of the
 *                   interfaces. If 'Configuration 1' is activated by the host, it allows the host to access
 *                   two different functionalities offered by the device.
+*
+*               (2) The UAS alternate setting has 4 bulk endpoints, each followed by a Pipe Usage descriptor.
+*                   They may use the same physical endpoints as the Bulk-Only alternate setting:
+*
+*                   |-- Interface Descriptor (MSC, alternate setting 1, UAS protocol)
+*                   |-- Endpoint Descriptor (Bulk IN,  data-in  pipe)
+*                   |-- Endpoint Descriptor (Bulk OUT, data-out pipe)
+*                   |-- Endpoint Descriptor (Bulk IN,  status   pipe)
+*                   |-- Endpoint Descriptor (Bulk OUT, command  pipe)
 *********************************************************************************************************
 */
 
@@ -683,6 +1067,9 @@ CPU_BOOLEAN  USBD_MSC_CfgAdd (CPU_INT08U   class_nbr,
            CPU_INT08U      if_nbr;
            CPU_INT08U      ep_addr;
            CPU_INT16U      comm_nbr;
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+           CPU_INT08U      if_alt_nbr;
+#endif
            CPU_SR_ALLOC();
 
 
@@ -784,6 +1171,72 @@ CPU_BOOLEAN  USBD_MSC_CfgAdd (CPU_INT08U   class_nbr,
 
     p_comm->DataBulkOutEpAddr = ep_addr;                        /* Store bulk-OUT EP address.                           */
 
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)                        /* ---------- UAS ALTERNATE SETTING (see Note #2) ----- */
+    if_alt_nbr = USBD_IF_AltAdd(        dev_nbr,
+                                        cfg_nbr,
+                                        if_nbr,
+                                (void *)0,
+                                        "USB Attached SCSI Interface",
+                                        p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    USBD_IF_AltProtocolSet(dev_nbr,
+                           cfg_nbr,
+                           if_nbr,
+                           if_alt_nbr,
+                           USBD_MSC_PROTOCOL_CODE_UAS,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    p_comm->UAS_DataInEpAddr = USBD_BulkAdd(dev_nbr,            /* Add data-in pipe.                                    */
+                                            cfg_nbr,
+                                            if_nbr,
+                                            if_alt_nbr,
+                                            DEF_YES,
+                                            0u,
+                                            p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    p_comm->UAS_DataOutEpAddr = USBD_BulkAdd(dev_nbr,           /* Add data-out pipe.                                   */
+                                             cfg_nbr,
+                                             if_nbr,
+                                             if_alt_nbr,
+                                             DEF_NO,
+                                             0u,
+                                             p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    p_comm->UAS_StatusEpAddr = USBD_BulkAdd(dev_nbr,            /* Add status pipe.                                     */
+                                            cfg_nbr,
+                                            if_nbr,
+                                            if_alt_nbr,
+                                            DEF_YES,
+                                            0u,
+                                            p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+
+    p_comm->UAS_CmdEpAddr = USBD_BulkAdd(dev_nbr,               /* Add cmd pipe.                                        */
+                                         cfg_nbr,
+                                         if_nbr,
+                                         if_alt_nbr,
+                                         DEF_NO,
+                                         0u,
+                                         p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+#endif
+
     CPU_CRITICAL_ENTER();
     p_ctrl->State   =  USBD_MSC_STATE_INIT;                     /* Set class instance to init state.                    */
     p_ctrl->DevNbr  =  dev_nbr;
@@ -896,8 +1349,8 @@ void  USBD_MSC_LunAdd (const  CPU_CHAR    *p_store_name,
     p_ctrl->Lun[max_lun].LunInfo.ProdRevisionLevel = prod_rev_level;
     p_ctrl->Lun[max_lun].LunInfo.ReadOnly          = rd_only;
 
-    USBD_SCSI_LunAdd(p_ctrl->Lun[max_lun].LunNbr,
-                     p_ctrl->Lun[max_lun].LunArgPtr,
+    USBD_SCSI_LunAdd(&p_ctrl->Lun[max_lun],
+                      p_ctrl->Lun[max_lun].LunArgPtr,
                      p_err);
 
     if (*p_err == USBD_ERR_NONE) {
@@ -906,6 +1359,76 @@ void  USBD_MSC_LunAdd (const  CPU_CHAR    *p_store_name,
 }
 
 
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_LunWrPipelineEn()
+*
+* Description : Enable or disable the pipelined WRITE data stage of a logical unit.
+*
+* Argument(s) : class_nbr       MSC instance number.
+*
+*               lun_nbr         Logical unit number.
+*
+*               en              Pipelined WRITE data stage state :
+*
+*                                   DEF_ENABLED     Bulk-OUT transfers are kept armed while data is
+*                                                       written to the storage media.
+*                                   DEF_DISABLED    Each chunk is written to the storage media before
+*                                                       the next one is received.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function:
+*
+*                               USBD_ERR_NONE                   Pipelined WRITE state successfully set.
+*                               USBD_ERR_CLASS_INVALID_NBR      Invalid class number.
+*                               USBD_ERR_INVALID_ARG            Invalid logical unit number.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The pipelined WRITE data stage is enabled by default on each logical unit added with
+*                   USBD_MSC_LunAdd(). It should be disabled for storage media that must acknowledge a
+*                   write before the host is allowed to send the next chunk of data.
+*
+*               (2) The new state takes effect with the next WRITE command received.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+void  USBD_MSC_LunWrPipelineEn (CPU_INT08U   class_nbr,
+                                CPU_INT08U   lun_nbr,
+                                CPU_BOOLEAN  en,
+                                USBD_ERR    *p_err)
+{
+    USBD_MSC_CTRL  *p_ctrl;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+#endif
+
+    if (class_nbr >= USBD_MSCCtrlNbrNext) {
+       *p_err = USBD_ERR_CLASS_INVALID_NBR;
+        return;
+    }
+
+    p_ctrl = &USBD_MSCCtrlTbl[class_nbr];
+
+    if (lun_nbr >= p_ctrl->MaxLun) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    p_ctrl->Lun[lun_nbr].WrPipelineEn = en;                     /* See Note #2.                                         */
+    CPU_CRITICAL_EXIT();
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                          USBD_MSC_IsConn()
@@ -963,7 +1486,10 @@ CPU_BOOLEAN  USBD_MSC_IsConn (CPU_INT08U  class_nbr)
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the host selects the UAS alternate setting, the bulk-OUT transfer waiting for the
+*                   next CBW is aborted and the task serves the UAS pipes until the Bulk-Only alternate
+*                   setting is selected again, or the device is disconnected (see also
+*                   'USBD_MSC_AltSettingUpdate()  Note #4').
 **********************************************************************************************************
 */
 
@@ -992,6 +1518,12 @@ void  USBD_MSC_TaskHandler (CPU_INT08U  class_nbr)
         p_comm     = p_ctrl->CommPtr;
 
         if (p_comm != (USBD_MSC_COMM *)0) {
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+            if (p_comm->UAS_En == DEF_YES) {                    /* ------------- UAS TRANSPORT (see Note #1) ---------- */
+                USBD_MSC_UAS_Process(p_ctrl, p_comm);
+                continue;
+            }
+#endif
             switch(comm_state) {
                 case USBD_MSC_COMM_STATE_CBW:                   /* ---------------- RECEIVE CBW STATE ----------------- */
                      USBD_MSC_RxCBW(p_ctrl,
@@ -1097,6 +1629,9 @@ static  void  USBD_MSC_Conn (CPU_INT08U   dev_nbr,
     p_comm->CtrlPtr->CommPtr = p_comm;
     p_comm->CtrlPtr->State   = USBD_MSC_STATE_CFG;              /* Set initial MSC state to cfg.                        */
     p_comm->NextCommState    = USBD_MSC_COMM_STATE_CBW;         /* Set initial MSC comm state to rx CBW.                */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    p_comm->UAS_En           = DEF_NO;                          /* Bulk-Only alt setting is selected by dflt.           */
+#endif
     CPU_CRITICAL_EXIT();
 
     for (lun = 0 ; lun < p_comm->CtrlPtr->MaxLun; lun++){       /* Perform some SCSI operations on each logical unit.   */
@@ -1137,6 +1672,9 @@ static  void  USBD_MSC_Disconn (CPU_INT08U   dev_nbr,
     USBD_ERR              os_err;
     CPU_INT08U            lun_ix;
     USBD_ERR              err;
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    CPU_BOOLEAN           uas_en;
+#endif
     CPU_SR_ALLOC();
 
 
@@ -1167,12 +1705,21 @@ static  void  USBD_MSC_Disconn (CPU_INT08U   dev_nbr,
     p_comm->CtrlPtr->CommPtr = (USBD_MSC_COMM *)0;
     p_comm->CtrlPtr->State   =  USBD_MSC_STATE_INIT;            /* Set MSC state to init.                               */
     p_comm->NextCommState    =  USBD_MSC_COMM_STATE_NONE;       /* Set MSC comm state to none.                          */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    uas_en                   =  p_comm->UAS_En;
+    p_comm->UAS_En           =  DEF_NO;
+#endif
     CPU_CRITICAL_EXIT();
 
     if (post_signal == DEF_TRUE) {
          USBD_MSC_OS_CommSignalPost(dev_nbr, &os_err);          /* Post sem to notify waiting task if comm ...          */
     }                                                           /* ... is in reset recovery and bulk-IN or bulk-OUT ... */
                                                                 /* ... stall states.                                    */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    if (uas_en == DEF_YES) {
+        USBD_MSC_UAS_SignalPost(p_comm);                        /* Wake task serving the UAS pipes.                     */
+    }
+#endif
                                                                 /* Unlock each logical unit added to configuration      */
     for (lun_ix = 0 ; lun_ix < p_comm->CtrlPtr->MaxLun; lun_ix++){
         USBD_SCSI_Unlock(&p_comm->CtrlPtr->Lun[lun_ix], &err);
@@ -1236,6 +1783,11 @@ static  void  USBD_MSC_EP_StateUpdate (CPU_INT08U   dev_nbr,
     p_comm     = (USBD_MSC_COMM *)p_if_class_arg;
     err        = USBD_ERR_NONE;
 
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    if (p_comm->UAS_En == DEF_YES) {                            /* UAS pipes are never stalled by the class.            */
+        return;
+    }
+#endif
 
     switch (p_comm->NextCommState) {
 
@@ -1368,6 +1920,9 @@ static  void  USBD_MSC_EP_StateUpdate (CPU_INT08U   dev_nbr,
 *               (2) The Get Max LUN class request is used to determine the number of logical units supported
 *                   by the device. The device shall return one byte of data that contains the maximum LUN
 *                   supported by the device.
+*
+*               (3) The Mass Storage Reset request is specific to the Bulk-Only Transport. When the UAS
+*                   alternate setting is selected, the host uses task management functions instead.
 *********************************************************************************************************
 */
 
@@ -1376,6 +1931,7 @@ static  CPU_BOOLEAN  USBD_MSC_ClassReq (       CPU_INT08U       dev_nbr,
                                                void            *p_if_class_arg)
 {
     CPU_INT08U      request;
+    CPU_INT08U      lun;
     CPU_BOOLEAN     valid;
     USBD_MSC_CTRL  *p_ctrl;
     USBD_MSC_COMM  *p_comm;
@@ -1390,6 +1946,11 @@ static  CPU_BOOLEAN  USBD_MSC_ClassReq (       CPU_INT08U       dev_nbr,
     switch(request) {
 
         case USBD_MSC_REQ_MASS_STORAGE_RESET:                   /* -------- MASS STORAGE RESET (see Notes #1) --------- */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+             if (p_comm->UAS_En == DEF_YES) {                   /* See Note #3.                                         */
+                 break;
+             }
+#endif
              if ((p_setup_req->wValue  == 0) &&
                  (p_setup_req->wLength == 0)) {
 
@@ -1402,7 +1963,9 @@ static  CPU_BOOLEAN  USBD_MSC_ClassReq (       CPU_INT08U       dev_nbr,
                  if (err != USBD_ERR_NONE) {
                      USBD_DBG_MSC_MSG("MSC: Class Mass Storage Reset, EP OUT Abort failed");
                  }
-                 USBD_SCSI_Reset();                             /* Reset the SCSI.                                      */
+                 for (lun = 0u; lun < p_ctrl->MaxLun; lun++) {  /* Reset the SCSI.                                      */
+                     USBD_SCSI_Reset(&p_ctrl->Lun[lun]);
+                 }
 
                  if (err == USBD_ERR_NONE){
                      valid = DEF_YES;
@@ -1673,6 +2236,7 @@ static  void  USBD_MSC_CMD_Process (USBD_MSC_CTRL  *p_ctrl,
     lun = p_comm->CBW.bCBWLUN;
 
     USBD_SCSI_CmdProcess(&p_ctrl->Lun[lun],                     /* Send the CBWCB to SCSI dev.                          */
+                         &p_ctrl->Lun[lun].Cmd,
                           p_comm->CBW.CBWCB,
                          &(p_ctrl->USBD_MSC_SCSI_Data_Len),
                          &(p_ctrl->USBD_MSC_SCSI_Data_Dir),
@@ -1751,27 +2315,48 @@ static  void  USBD_MSC_CMD_Process (USBD_MSC_CTRL  *p_ctrl,
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When more than one data buffer is configured, the data stage is pipelined by
+*                   USBD_MSC_SCSI_RdAsync(). Otherwise, each chunk is read from the SCSI and then
+*                   transmitted synchronously by USBD_MSC_SCSI_Rd().
+*
+*               (2) USBD_MSC_SCSI_Rd() may send the CSW along with the last chunk, and then sets the next
+*                   state itself.
 **********************************************************************************************************
 */
 
 static  void  USBD_MSC_SCSI_TxData (USBD_MSC_CTRL  *p_ctrl,
                                     USBD_MSC_COMM  *p_comm)
 {
-    CPU_INT32U  scsi_buf_len;
+#if (USBD_MSC_CFG_DATA_NBR_BUF == 1u)
+    CPU_INT32U   scsi_buf_len;
+    CPU_BOOLEAN  csw_sent;
+#else
+    USBD_ERR    err;
+#endif
     USBD_ERR    stall_err;
     CPU_SR_ALLOC();
 
 
+#if (USBD_MSC_CFG_DATA_NBR_BUF == 1u)
     scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
+    csw_sent     = DEF_NO;
 
     while (scsi_buf_len > 0) {
 
-        USBD_MSC_SCSI_Rd(p_ctrl, p_comm);
+        csw_sent = USBD_MSC_SCSI_Rd(p_ctrl, p_comm);
         p_comm->BytesToXfer         -= scsi_buf_len;            /* Update remaining bytes to transmit.                  */
         p_comm->CSW.dCSWDataResidue -= scsi_buf_len;            /* Update CSW data residue field.                       */
         scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
     }
+    if (csw_sent == DEF_YES) {                                  /* See Note #2.                                         */
+        return;
+    }
+#else
+    USBD_MSC_SCSI_RdAsync(p_ctrl, p_comm, &err);                /* See Note #1.                                         */
+    if (err != USBD_ERR_NONE) {                                 /* Bulk-IN stall state already entered.                 */
+        return;
+    }
+#endif
     if (p_comm->Stall == DEF_TRUE) {
         p_comm->Stall = DEF_FALSE;
 
@@ -1798,20 +2383,31 @@ static  void  USBD_MSC_SCSI_TxData (USBD_MSC_CTRL  *p_ctrl,
 *
 * Argument(s) : class_nbr   MSC instance number.
 *
-* Return(s)   : None.
+* Return(s)   : DEF_YES, if the CSW was transmitted along with the data (see Note #1).
 *
-* Note(s)     : None.
+*               DEF_NO,  otherwise.
+*
+* Note(s)     : (1) When vectored transfers are enabled, the last chunk of a command that passed and whose
+*                   length matches the host's is sent together with the CSW, in a single transfer of two
+*                   segments, which saves the CSW transfer round trip. The chunk must be a multiple of the
+*                   bulk-IN maximum packet size, so that the CSW stays in its own packet.
 **********************************************************************************************************
 */
 
-static  void  USBD_MSC_SCSI_Rd (USBD_MSC_CTRL  *p_ctrl,
-                                USBD_MSC_COMM  *p_comm)
+#if (USBD_MSC_CFG_DATA_NBR_BUF == 1u)
+static  CPU_BOOLEAN  USBD_MSC_SCSI_Rd (USBD_MSC_CTRL  *p_ctrl,
+                                       USBD_MSC_COMM  *p_comm)
 {
-    CPU_INT32U  scsi_ret_len;
-    CPU_INT32U  scsi_buf_len;
-    CPU_INT08U  lun;
-    USBD_ERR    err;
-    USBD_ERR    stall_err;
+    CPU_INT32U    scsi_ret_len;
+    CPU_INT32U    scsi_buf_len;
+    CPU_INT08U    lun;
+    USBD_ERR      err;
+    USBD_ERR      stall_err;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    CPU_INT16U    max_pkt_size;
+    USBD_MSC_CSW  csw;
+    USBD_BUF_SEG  seg_tbl[2u];
+#endif
     CPU_SR_ALLOC();
 
 
@@ -1820,8 +2416,9 @@ static  void  USBD_MSC_SCSI_Rd (USBD_MSC_CTRL  *p_ctrl,
     lun = p_comm->CBW.bCBWLUN;
     CPU_CRITICAL_EXIT();
     USBD_SCSI_DataRd(&p_ctrl->Lun[lun],                         /* Rd data from the SCSI.                               */
+                     &p_ctrl->Lun[lun].Cmd,
                       p_comm->CBW.CBWCB[0],
-                      p_ctrl->DataBufPtr,
+                      p_ctrl->DataBufPtrTbl[0],
                       scsi_buf_len,
                      &scsi_ret_len,
                      &err);
@@ -1834,80 +2431,458 @@ static  void  USBD_MSC_SCSI_Rd (USBD_MSC_CTRL  *p_ctrl,
 
         USBD_EP_Stall( p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &err);
 
-    } else {
-        (void)USBD_BulkTx(p_ctrl->DevNbr,                       /* Tx data to the host.                                 */
-                          p_comm->DataBulkInEpAddr,
-                          p_ctrl->DataBufPtr,
-                          scsi_ret_len,
-                          0,
-                          DEF_NO,
-                         &err);
+        return (DEF_NO);
+    }
 
-        if (err != USBD_ERR_NONE) {
-            CPU_CRITICAL_ENTER();                               /* Enter reset recovery state if tx err.                */
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    max_pkt_size = USBD_EP_MaxPktSizeGet(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, &err);
+    if ((err                    == USBD_ERR_NONE)                  &&
+        (max_pkt_size           != 0u)                             &&
+        (scsi_ret_len           == p_comm->BytesToXfer)            &&
+        (scsi_ret_len           == p_comm->CSW.dCSWDataResidue)    &&
+        (p_comm->Stall          == DEF_FALSE)                      &&
+        (p_comm->CSW.bCSWStatus == USBD_MSC_BCSWSTATUS_CMD_PASSED) &&
+       ((scsi_ret_len % max_pkt_size) == 0u)) {                 /* See Note #1.                                         */
+
+        CPU_CRITICAL_ENTER();
+        p_comm->CSW.dCSWSignature = USBD_MSC_SIG_CSW;           /* Set CSW signature and rcvd tag from CBW.             */
+        p_comm->CSW.dCSWTag       = p_comm->CBW.dCBWTag;
+        csw                       = p_comm->CSW;
+        CPU_CRITICAL_EXIT();
+        csw.dCSWDataResidue       = 0u;                         /* Residue once this chunk is sent.                     */
+        USBD_MSC_CSW_Fmt(        &csw,
+                         (void *) p_ctrl->CSW_BufPtr);
+
+        seg_tbl[0u].BufPtr = p_ctrl->DataBufPtrTbl[0];
+        seg_tbl[0u].BufLen = scsi_ret_len;
+        seg_tbl[1u].BufPtr = p_ctrl->CSW_BufPtr;
+        seg_tbl[1u].BufLen = USBD_MSC_LEN_CSW;
+
+        (void)USBD_BulkTxVec(p_ctrl->DevNbr,                    /* Tx data and CSW to the host.                         */
+                             p_comm->DataBulkInEpAddr,
+                             seg_tbl,
+                             2u,
+                             0,
+                             DEF_NO,
+                            &err);
+
+        CPU_CRITICAL_ENTER();
+        if (err != USBD_ERR_NONE) {                             /* Enter reset recovery state if tx err.                */
             p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_IN_STALL;
-            CPU_CRITICAL_EXIT();
-            USBD_EP_Stall (p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+        } else {
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (err != USBD_ERR_NONE) {
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
         }
+
+        return (DEF_YES);
+    }
+#endif
+
+    (void)USBD_BulkTx(p_ctrl->DevNbr,                           /* Tx data to the host.                                 */
+                      p_comm->DataBulkInEpAddr,
+                      p_ctrl->DataBufPtrTbl[0],
+                      scsi_ret_len,
+                      0,
+                      DEF_NO,
+                     &err);
+
+    if (err != USBD_ERR_NONE) {
+        CPU_CRITICAL_ENTER();                                   /* Enter reset recovery state if tx err.                */
+        p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_IN_STALL;
+        CPU_CRITICAL_EXIT();
+        USBD_EP_Stall (p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
     }
+
+    return (DEF_NO);
 }
+#endif
 
 
 /*
 **********************************************************************************************************
-*                                            USBD_MSC_SCSI_Wr()
+*                                          USBD_MSC_SCSI_RdAsync()
 *
-* Description : Save the buffer and buffer length and write data to the SCSI.
+* Description : Reads data from the SCSI and transmits it to the host, overlapping the storage media
+*               accesses with asynchronous bulk-IN transfers.
 *
-* Argument(s) : class_nbr         MSC instance number.
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
 *
-*               p_buf            Pointer to the data buffer.
+*               p_comm      Pointer to MSC communication structure.
 *
-*               xfer_len         Length of the data buffer.
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Data stage successfully completed.
+*
+*                                                   - RETURNED BY USBD_SCSI_DataRdAsync() : -
+*                                                   -- RETURNED BY USBD_MSC_SCSI_RdCmpl() : --
+*                                                   ---- RETURNED BY USBD_BulkTxAsync() : ----
+*                                                   -- RETURNED BY USBD_MSC_SCSI_TxCmpl() : --
+*                               Any other error code, in which case the bulk-IN stall state is entered.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) Each data buffer goes through the following states :
+*
+*                   (a) FREE -> RD   The buffer is handed to USBD_SCSI_DataRdAsync().
+*                   (b) RD   -> RDY  USBD_MSC_SCSI_RdCmpl() reports the data is in the buffer.
+*                   (c) RDY  -> TX   The buffer is submitted with USBD_BulkTxAsync().
+*                   (d) TX   -> FREE USBD_MSC_SCSI_TxCmpl() reports the buffer was transmitted.
+*
+*                   Storage reads are started as soon as a buffer is free, so several of them may be in
+*                   progress while the previous buffers are transmitted. Buffers are used and transmitted
+*                   in ring order, whatever the order the storage reads complete in.
+*
+*               (2) Each storage read and each bulk-IN transfer posts the data signal once when it
+*                   completes. The task pends once per operation started and rescans the buffers after
+*                   each completion; it is done when no operation is left in progress.
+*
+*               (3) If no URB is available to queue the transfer, wait for an operation in progress to
+*                   complete and retry. See USBD_CFG_MAX_NBR_URB_EXTRA and USBD_CFG_MAX_NBR_URB_RSVD in
+*                   'usbd_cfg.h'.
+*
+*               (4) Once an error occurs, no new operation is started but all the operations in progress
+*                   are waited on before returning. No buffer is then owned by the storage layer or by the
+*                   core when the next command is processed.
 **********************************************************************************************************
 */
 
-static  void  USBD_MSC_SCSI_Wr (const USBD_MSC_CTRL  *p_ctrl,
-                                      USBD_MSC_COMM  *p_comm,
-                                      void           *p_buf,
-                                      CPU_INT32U      xfer_len)
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void  USBD_MSC_SCSI_RdAsync (USBD_MSC_CTRL  *p_ctrl,
+                                     USBD_MSC_COMM  *p_comm,
+                                     USBD_ERR       *p_err)
 {
-    USBD_ERR       err;
-    USBD_ERR       stall_err;
-    CPU_INT08U     lun;
+    CPU_INT08U   rd_ix;
+    CPU_INT08U   tx_ix;
+    CPU_INT08U   op_pend_cnt;
+    CPU_INT08U   buf_state;
+    CPU_INT32U   scsi_buf_len;
+    CPU_INT08U   lun;
+    USBD_ERR     err;
+    USBD_ERR     os_err;
+    USBD_ERR     stall_err;
     CPU_SR_ALLOC();
 
 
     CPU_CRITICAL_ENTER();
-    p_comm->SCSIWrBufPtr = p_buf;
-    p_comm->SCSIWrBuflen = xfer_len;
+    p_comm->DataXferErr = USBD_ERR_NONE;
+    lun                 = p_comm->CBW.bCBWLUN;
     CPU_CRITICAL_EXIT();
 
-    lun = p_comm->CBW.bCBWLUN;
-    USBD_SCSI_DataWr(&p_ctrl->Lun[lun],                         /* Wr data to SCSI sto.                                 */
-                      p_comm->CBW.CBWCB[0],
-                      p_comm->SCSIWrBufPtr,
-                      p_comm->SCSIWrBuflen,
-                     &err);
-    if ((err != USBD_ERR_NONE) &&
-        (err != USBD_ERR_SCSI_MORE_DATA)) {
-        CPU_CRITICAL_ENTER();                                   /* Enter bulk-OUT stall state.                          */
-        p_comm->CSW.bCSWStatus = USBD_MSC_BCSWSTATUS_CMD_FAILED;
-        p_comm->NextCommState  = USBD_MSC_COMM_STATE_BULK_OUT_STALL;
-        CPU_CRITICAL_EXIT();
-        USBD_DBG_MSC_MSG("MSC: SCSI Wr, Stall OUT");
-
-        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
-    }
-}
-
+    rd_ix       = 0u;
+    tx_ix       = 0u;
+    op_pend_cnt = 0u;
+    err         = USBD_ERR_NONE;
 
-/*
-**********************************************************************************************************
+    while (DEF_TRUE) {
+        if (err == USBD_ERR_NONE) {                             /* Chk err rpt'd by completed ops.                      */
+            CPU_CRITICAL_ENTER();
+            err = p_comm->DataXferErr;
+            CPU_CRITICAL_EXIT();
+        }
+                                                                /* ------------- START STORAGE RD (FREE) -------------- */
+        while ((err                              == USBD_ERR_NONE) &&
+               (p_comm->BytesToXfer              >  0u)            &&
+               (p_comm->DataBufStateTbl[rd_ix]   == USBD_MSC_DATA_BUF_STATE_FREE)) {
+            scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
+
+            p_comm->DataBufStateTbl[rd_ix] = USBD_MSC_DATA_BUF_STATE_RD;
+            op_pend_cnt++;
+                                                                /* Rd data from the SCSI (see Note #1a).                */
+            USBD_SCSI_DataRdAsync(&p_ctrl->Lun[lun],
+                                  &p_ctrl->Lun[lun].Cmd,
+                                   p_comm->CBW.CBWCB[0],
+                                   p_ctrl->DataBufPtrTbl[rd_ix],
+                                   scsi_buf_len,
+                                   USBD_MSC_SCSI_RdCmpl,
+                           (void *)p_comm,
+                                  &err);
+            if ((err != USBD_ERR_NONE) &&
+                (err != USBD_ERR_SCSI_MORE_DATA)) {
+                CPU_CRITICAL_ENTER();
+                p_comm->DataBufStateTbl[rd_ix] = USBD_MSC_DATA_BUF_STATE_FREE;
+                p_comm->CSW.bCSWStatus         = (CPU_INT08U)USBD_MSC_BCSWSTATUS_CMD_FAILED;
+                CPU_CRITICAL_EXIT();
+                op_pend_cnt--;
+                break;
+            }
+
+            err                  = USBD_ERR_NONE;
+            p_comm->BytesToXfer -= scsi_buf_len;                /* Update remaining bytes to rd.                        */
+
+            rd_ix++;
+            if (rd_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+                rd_ix = 0u;
+            }
+        }
+                                                                /* ----------------- START TX (RDY) ------------------- */
+        while (err == USBD_ERR_NONE) {
+            CPU_CRITICAL_ENTER();
+            buf_state = p_comm->DataBufStateTbl[tx_ix];
+            if (buf_state == USBD_MSC_DATA_BUF_STATE_RDY) {
+                p_comm->DataBufStateTbl[tx_ix] = USBD_MSC_DATA_BUF_STATE_TX;
+            }
+            CPU_CRITICAL_EXIT();
+            if (buf_state != USBD_MSC_DATA_BUF_STATE_RDY) {     /* Bufs are tx'd in ring order (see Note #1).           */
+                break;
+            }
+
+            op_pend_cnt++;
+            USBD_BulkTxAsync(        p_ctrl->DevNbr,            /* Tx data to the host (see Note #1c).                  */
+                                     p_comm->DataBulkInEpAddr,
+                                     p_ctrl->DataBufPtrTbl[tx_ix],
+                                     p_comm->DataXferLenTbl[tx_ix],
+                                     USBD_MSC_SCSI_TxCmpl,
+                             (void *)p_comm,
+                                     DEF_NO,
+                                    &err);
+            if (err != USBD_ERR_NONE) {
+                op_pend_cnt--;
+                CPU_CRITICAL_ENTER();
+                p_comm->DataBufStateTbl[tx_ix] = USBD_MSC_DATA_BUF_STATE_RDY;
+                CPU_CRITICAL_EXIT();
+                if ((err         == USBD_ERR_EP_QUEUING) &&     /* See Note #3.                                         */
+                    (op_pend_cnt >  0u)) {
+                    err = USBD_ERR_NONE;
+                }
+                break;
+            }
+
+            tx_ix++;
+            if (tx_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+                tx_ix = 0u;
+            }
+        }
+
+        if (op_pend_cnt == 0u) {                                /* All data tx'd or err (see Notes #2 & #4).            */
+            break;
+        }
+                                                                /* Wait for next completion (see Note #2).              */
+        USBD_MSC_OS_DataSignalPend(p_ctrl->ClassNbr, 0u, &os_err);
+        op_pend_cnt--;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* Release bufs that were rd but not tx'd.              */
+    Mem_Clr((void     *)&p_comm->DataBufStateTbl[0],
+            (CPU_SIZE_T) sizeof(p_comm->DataBufStateTbl));
+    if (err == USBD_ERR_NONE) {                                 /* Chk err of last ops.                                 */
+        err = p_comm->DataXferErr;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (err != USBD_ERR_NONE) {
+        CPU_CRITICAL_ENTER();                                   /* Enter bulk-IN stall state.                           */
+        p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_IN_STALL;
+        CPU_CRITICAL_EXIT();
+
+        USBD_DBG_MSC_ARG("MSC: SCSI Rd, Stall IN", err);
+        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+    }
+
+   *p_err = err;
+}
+#endif
+
+
+/*
+**********************************************************************************************************
+*                                          USBD_MSC_SCSI_RdCmpl()
+*
+* Description : Inform the MSC task about the completion of an asynchronous storage read.
+*
+* Argument(s) : p_buf       Pointer to the data buffer.
+*
+*               data_len    Number of octets read.
+*
+*               p_arg       Pointer to MSC communication structure.
+*
+*               err         Read status.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) This function may be called from USBD_SCSI_DataRdAsync(), from a storage task or from
+*                   an interrupt service routine (see 'usbd_scsi.h  STORAGE COMPLETION CALLBACK').
+*
+*               (2) A buffer that could not be read is released: it is never transmitted since the data
+*                   stage is aborted by USBD_MSC_SCSI_RdAsync() as soon as the error is detected.
+**********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void  USBD_MSC_SCSI_RdCmpl (CPU_INT08U  *p_buf,
+                                    CPU_INT32U   data_len,
+                                    void        *p_arg,
+                                    USBD_ERR     err)
+{
+    USBD_MSC_COMM  *p_comm;
+    USBD_MSC_CTRL  *p_ctrl;
+    CPU_INT08U      buf_ix;
+    USBD_ERR        os_err;
+    CPU_SR_ALLOC();
+
+
+    p_comm = (USBD_MSC_COMM *)p_arg;
+    p_ctrl =  p_comm->CtrlPtr;
+
+    for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+        if (p_ctrl->DataBufPtrTbl[buf_ix] == p_buf) {
+            break;
+        }
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (buf_ix < USBD_MSC_CFG_DATA_NBR_BUF) {
+        p_comm->DataXferLenTbl[buf_ix] = data_len;
+        if (err == USBD_ERR_NONE) {
+            p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_RDY;
+        } else {                                                /* See Note #2.                                         */
+            p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_FREE;
+        }
+    }
+    if ((err                 != USBD_ERR_NONE) &&
+        (p_comm->DataXferErr == USBD_ERR_NONE)) {
+        p_comm->DataXferErr    = err;
+        p_comm->CSW.bCSWStatus = (CPU_INT08U)USBD_MSC_BCSWSTATUS_CMD_FAILED;
+    }
+    CPU_CRITICAL_EXIT();
+                                                                /* Wake MSC task.                                       */
+    USBD_MSC_OS_DataSignalPost(p_ctrl->ClassNbr, &os_err);
+}
+#endif
+
+
+/*
+**********************************************************************************************************
+*                                          USBD_MSC_SCSI_TxCmpl()
+*
+* Description : Inform the MSC task about the completion of an asynchronous bulk-IN data transfer.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to the transmit buffer.
+*
+*               buf_len     Transmit buffer length.
+*
+*               xfer_len    Number of octets transmitted.
+*
+*               p_arg       Pointer to MSC communication structure.
+*
+*               err         Transfer status.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The CSW data residue is updated with the number of octets actually transmitted.
+*                   Only the first error reported is kept, the data stage being aborted by
+*                   USBD_MSC_SCSI_RdAsync() as soon as it is detected.
+**********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void  USBD_MSC_SCSI_TxCmpl (CPU_INT08U   dev_nbr,
+                                    CPU_INT08U   ep_addr,
+                                    void        *p_buf,
+                                    CPU_INT32U   buf_len,
+                                    CPU_INT32U   xfer_len,
+                                    void        *p_arg,
+                                    USBD_ERR     err)
+{
+    USBD_MSC_COMM  *p_comm;
+    USBD_MSC_CTRL  *p_ctrl;
+    CPU_INT08U      buf_ix;
+    USBD_ERR        os_err;
+    CPU_SR_ALLOC();
+
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)buf_len;
+
+    p_comm = (USBD_MSC_COMM *)p_arg;
+    p_ctrl =  p_comm->CtrlPtr;
+
+    for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+        if (p_ctrl->DataBufPtrTbl[buf_ix] == p_buf) {
+            break;
+        }
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    if (buf_ix < USBD_MSC_CFG_DATA_NBR_BUF) {
+        p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_FREE;
+    }
+    p_comm->CSW.dCSWDataResidue -= xfer_len;
+    if ((err                 != USBD_ERR_NONE) &&
+        (p_comm->DataXferErr == USBD_ERR_NONE)) {
+        p_comm->DataXferErr = err;
+    }
+    CPU_CRITICAL_EXIT();
+                                                                /* Release buf to MSC task.                             */
+    USBD_MSC_OS_DataSignalPost(p_ctrl->ClassNbr, &os_err);
+}
+#endif
+
+
+/*
+**********************************************************************************************************
+*                                            USBD_MSC_SCSI_Wr()
+*
+* Description : Save the buffer and buffer length and write data to the SCSI.
+*
+* Argument(s) : class_nbr         MSC instance number.
+*
+*               p_buf            Pointer to the data buffer.
+*
+*               xfer_len         Length of the data buffer.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+**********************************************************************************************************
+*/
+
+static  void  USBD_MSC_SCSI_Wr (USBD_MSC_CTRL  *p_ctrl,
+                                USBD_MSC_COMM  *p_comm,
+                                void           *p_buf,
+                                CPU_INT32U      xfer_len)
+{
+    USBD_ERR       err;
+    USBD_ERR       stall_err;
+    CPU_INT08U     lun;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_comm->SCSIWrBufPtr = p_buf;
+    p_comm->SCSIWrBuflen = xfer_len;
+    CPU_CRITICAL_EXIT();
+
+    lun = p_comm->CBW.bCBWLUN;
+    USBD_SCSI_DataWr(&p_ctrl->Lun[lun],                         /* Wr data to SCSI sto.                                 */
+                     &p_ctrl->Lun[lun].Cmd,
+                      p_comm->CBW.CBWCB[0],
+                      p_comm->SCSIWrBufPtr,
+                      p_comm->SCSIWrBuflen,
+                     &err);
+    if ((err != USBD_ERR_NONE) &&
+        (err != USBD_ERR_SCSI_MORE_DATA)) {
+        CPU_CRITICAL_ENTER();                                   /* Enter bulk-OUT stall state.                          */
+        p_comm->CSW.bCSWStatus = USBD_MSC_BCSWSTATUS_CMD_FAILED;
+        p_comm->NextCommState  = USBD_MSC_COMM_STATE_BULK_OUT_STALL;
+        CPU_CRITICAL_EXIT();
+        USBD_DBG_MSC_MSG("MSC: SCSI Wr, Stall OUT");
+
+        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
+    }
+}
+
+
+/*
+**********************************************************************************************************
 *                                             USBD_MSC_SCSI_RxData()
 *
 * Description : It receives data from the host. After the data stage is complete, CSW is sent.
@@ -1916,7 +2891,9 @@ static  void  USBD_MSC_SCSI_Wr (const USBD_MSC_CTRL  *p_ctrl,
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When more than one data buffer is configured and the pipelined WRITE data stage is
+*                   enabled for the logical unit, the whole data stage is done by USBD_MSC_SCSI_WrAsync().
+*                   Otherwise, each chunk is received from the host and then written to the SCSI.
 **********************************************************************************************************
 */
 
@@ -1925,11 +2902,27 @@ static  void  USBD_MSC_SCSI_RxData (USBD_MSC_CTRL  *p_ctrl,
 {
     CPU_INT32U      scsi_buf_len;
     CPU_INT32U      xfer_len;
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+    CPU_BOOLEAN     wr_pipeline_en;
+#endif
     USBD_ERR        err;
     USBD_ERR        stall_err;
     CPU_SR_ALLOC();
 
 
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+    CPU_CRITICAL_ENTER();
+    wr_pipeline_en = p_ctrl->Lun[p_comm->CBW.bCBWLUN].WrPipelineEn;
+    CPU_CRITICAL_EXIT();
+
+    if (wr_pipeline_en == DEF_ENABLED) {                        /* See Note #1.                                         */
+        USBD_MSC_SCSI_WrAsync(p_ctrl, p_comm, &err);
+        if (err != USBD_ERR_NONE) {                             /* Bulk-OUT stall state already entered.                */
+            return;
+        }
+    }
+#endif
+
     CPU_CRITICAL_ENTER();
     scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
     CPU_CRITICAL_EXIT();
@@ -1938,7 +2931,7 @@ static  void  USBD_MSC_SCSI_RxData (USBD_MSC_CTRL  *p_ctrl,
         USBD_DBG_MSC_ARG("MSC: Rx Data Len:", scsi_buf_len);
         xfer_len = USBD_BulkRx(p_ctrl->DevNbr,                  /* Rx data from host on bulk-OUT pipe                   */
                                p_comm->DataBulkOutEpAddr,
-                               p_ctrl->DataBufPtr,
+                               p_ctrl->DataBufPtrTbl[0],
                                scsi_buf_len,
                                0,
                               &err);
@@ -1954,7 +2947,7 @@ static  void  USBD_MSC_SCSI_RxData (USBD_MSC_CTRL  *p_ctrl,
 
         } else {
                                                                 /* Process rx data if no err.                           */
-            USBD_MSC_SCSI_Wr(p_ctrl, p_comm, p_ctrl->DataBufPtr, xfer_len);
+            USBD_MSC_SCSI_Wr(p_ctrl, p_comm, p_ctrl->DataBufPtrTbl[0], xfer_len);
             p_comm->BytesToXfer         -= xfer_len;
             p_comm->CSW.dCSWDataResidue -= xfer_len;
             scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
@@ -1979,291 +2972,2333 @@ static  void  USBD_MSC_SCSI_RxData (USBD_MSC_CTRL  *p_ctrl,
 
 
 /*
-**********************************************************************************************************
-*                                             USBD_MSC_TxCSW()
-*
-* Description : Send status CSW to the host.
+**********************************************************************************************************
+*                                          USBD_MSC_SCSI_WrAsync()
+*
+* Description : Receives data from the host and writes it to the SCSI, keeping asynchronous bulk-OUT
+*               transfers armed while the storage media is written.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC communication structure.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Data stage successfully completed.
+*                               USBD_ERR_RX         Short packet received before the end of the data stage.
+*
+*                                                   ---- RETURNED BY USBD_SCSI_DataWr() : ----
+*                                                   ---- RETURNED BY USBD_BulkRxAsync() : ----
+*                                                   -- RETURNED BY USBD_MSC_SCSI_RxCmpl() : --
+*                               Any other error code, in which case the bulk-OUT stall state is entered.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Every free data buffer is armed with USBD_BulkRxAsync(). Each time the oldest transfer
+*                   completes, its data is written to the SCSI with USBD_SCSI_DataWr() and the buffer
+*                   is armed again, if more data is expected from the host.
+*
+*               (2) Transfers on an endpoint complete in the order they were submitted. Pending once on
+*                   the data signal always releases the oldest buffer of the ring.
+*
+*               (3) If no URB is available to queue the transfer, stop arming buffers until the oldest
+*                   transfer completes. See USBD_CFG_MAX_NBR_URB_EXTRA and USBD_CFG_MAX_NBR_URB_RSVD in
+*                   'usbd_cfg.h'.
+*
+*               (4) The CSW data residue is only updated with the data actually written to the storage
+*                   media. Data received after a failed write is discarded.
+*
+*               (5) Each transfer but the last one is armed with USBD_MSC_CFG_DATA_LEN octets. A short
+*                   packet before the end of the data stage would shift the data received in the
+*                   buffers already armed and is handled as an error.
+*
+*               (6) Stalling the bulk-OUT endpoint aborts the transfers in flight. Their completion is
+*                   waited on before returning, so that no buffer is owned by the core when the next
+*                   command is processed.
+**********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void  USBD_MSC_SCSI_WrAsync (USBD_MSC_CTRL  *p_ctrl,
+                                     USBD_MSC_COMM  *p_comm,
+                                     USBD_ERR       *p_err)
+{
+    CPU_INT08U   arm_ix;
+    CPU_INT08U   cmpl_ix;
+    CPU_INT08U   xfer_pend_cnt;
+    CPU_INT32U   arm_rem_len;
+    CPU_INT32U   scsi_buf_len;
+    CPU_INT32U   xfer_len;
+    CPU_INT08U   lun;
+    USBD_ERR     err;
+    USBD_ERR     os_err;
+    USBD_ERR     stall_err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_comm->DataXferErr = USBD_ERR_NONE;
+    lun                 = p_comm->CBW.bCBWLUN;
+    arm_rem_len         = p_comm->BytesToXfer;
+    CPU_CRITICAL_EXIT();
+
+    arm_ix        = 0u;
+    cmpl_ix       = 0u;
+    xfer_pend_cnt = 0u;
+    err           = USBD_ERR_NONE;
+
+    while (p_comm->BytesToXfer > 0u) {
+                                                                /* Arm free bufs (see Note #1).                         */
+        while ((arm_rem_len   >  0u) &&
+               (xfer_pend_cnt <  USBD_MSC_CFG_DATA_NBR_BUF)) {
+            scsi_buf_len = DEF_MIN(arm_rem_len, USBD_MSC_CFG_DATA_LEN);
+
+            USBD_BulkRxAsync(        p_ctrl->DevNbr,
+                                     p_comm->DataBulkOutEpAddr,
+                                     p_ctrl->DataBufPtrTbl[arm_ix],
+                                     scsi_buf_len,
+                                     USBD_MSC_SCSI_RxCmpl,
+                             (void *)p_comm,
+                                    &err);
+            if ((err           == USBD_ERR_EP_QUEUING) &&       /* See Note #3.                                         */
+                (xfer_pend_cnt >  0u)) {
+                err = USBD_ERR_NONE;
+                break;
+            }
+            if (err != USBD_ERR_NONE) {
+                break;
+            }
+
+            xfer_pend_cnt++;
+            arm_rem_len -= scsi_buf_len;
+
+            arm_ix++;
+            if (arm_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+                arm_ix = 0u;
+            }
+        }
+        if (err != USBD_ERR_NONE) {
+            break;
+        }
+                                                                /* Wait for oldest xfer (see Note #2).                  */
+        USBD_MSC_OS_DataSignalPend(p_ctrl->ClassNbr, 0u, &os_err);
+        xfer_pend_cnt--;
+
+        CPU_CRITICAL_ENTER();
+        err      = p_comm->DataXferErr;
+        xfer_len = p_comm->DataXferLenTbl[cmpl_ix];
+        CPU_CRITICAL_EXIT();
+        if (err != USBD_ERR_NONE) {
+            break;
+        }
+
+        scsi_buf_len = DEF_MIN(p_comm->BytesToXfer, USBD_MSC_CFG_DATA_LEN);
+
+        USBD_DBG_MSC_ARG("MSC: Rx Data Len:", xfer_len);
+        USBD_SCSI_DataWr(&p_ctrl->Lun[lun],                     /* Wr data to SCSI sto.                                 */
+                         &p_ctrl->Lun[lun].Cmd,
+                          p_comm->CBW.CBWCB[0],
+                          p_ctrl->DataBufPtrTbl[cmpl_ix],
+                          xfer_len,
+                         &err);
+        if ((err != USBD_ERR_NONE) &&
+            (err != USBD_ERR_SCSI_MORE_DATA)) {
+            CPU_CRITICAL_ENTER();
+            p_comm->CSW.bCSWStatus = USBD_MSC_BCSWSTATUS_CMD_FAILED;
+            CPU_CRITICAL_EXIT();
+            break;
+        }
+        err = USBD_ERR_NONE;
+
+        p_comm->BytesToXfer         -= xfer_len;                /* See Note #4.                                         */
+        p_comm->CSW.dCSWDataResidue -= xfer_len;
+
+        if ((xfer_len            < scsi_buf_len) &&             /* See Note #5.                                         */
+            (p_comm->BytesToXfer > 0u)) {
+            err = USBD_ERR_RX;
+            break;
+        }
+
+        cmpl_ix++;
+        if (cmpl_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+            cmpl_ix = 0u;
+        }
+    }
+
+    if (err != USBD_ERR_NONE) {
+        CPU_CRITICAL_ENTER();                                   /* Enter bulk-OUT stall state.                          */
+        p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_OUT_STALL;
+        CPU_CRITICAL_EXIT();
+
+        USBD_DBG_MSC_ARG("MSC: SCSI Wr, Stall OUT", err);
+        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
+    }
+
+    while (xfer_pend_cnt > 0u) {                                /* Wait for all xfers in flight (see Note #6).          */
+        USBD_MSC_OS_DataSignalPend(p_ctrl->ClassNbr, 0u, &os_err);
+        xfer_pend_cnt--;
+    }
+
+   *p_err = err;
+}
+#endif
+
+
+/*
+**********************************************************************************************************
+*                                          USBD_MSC_SCSI_RxCmpl()
+*
+* Description : Inform the MSC task about the completion of an asynchronous bulk-OUT data transfer.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to the receive buffer.
+*
+*               buf_len     Receive buffer length.
+*
+*               xfer_len    Number of octets received.
+*
+*               p_arg       Pointer to MSC communication structure.
+*
+*               err         Transfer status.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Only the first error reported is kept, the data stage being aborted by
+*                   USBD_MSC_SCSI_WrAsync() as soon as it is detected.
+**********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+static  void  USBD_MSC_SCSI_RxCmpl (CPU_INT08U   dev_nbr,
+                                    CPU_INT08U   ep_addr,
+                                    void        *p_buf,
+                                    CPU_INT32U   buf_len,
+                                    CPU_INT32U   xfer_len,
+                                    void        *p_arg,
+                                    USBD_ERR     err)
+{
+    USBD_MSC_COMM  *p_comm;
+    USBD_MSC_CTRL  *p_ctrl;
+    CPU_INT08U      buf_ix;
+    USBD_ERR        os_err;
+    CPU_SR_ALLOC();
+
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)buf_len;
+
+    p_comm = (USBD_MSC_COMM *)p_arg;
+    p_ctrl =  p_comm->CtrlPtr;
+
+    for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+        if (p_ctrl->DataBufPtrTbl[buf_ix] == (CPU_INT08U *)p_buf) {
+            break;
+        }
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (buf_ix < USBD_MSC_CFG_DATA_NBR_BUF) {
+        p_comm->DataXferLenTbl[buf_ix] = xfer_len;
+    }
+    if ((err                 != USBD_ERR_NONE) &&               /* See Note #1.                                         */
+        (p_comm->DataXferErr == USBD_ERR_NONE)) {
+        p_comm->DataXferErr = err;
+    }
+    CPU_CRITICAL_EXIT();
+                                                                /* Release buf to MSC task.                             */
+    USBD_MSC_OS_DataSignalPost(p_ctrl->ClassNbr, &os_err);
+}
+#endif
+
+
+/*
+**********************************************************************************************************
+*                                             USBD_MSC_TxCSW()
+*
+* Description : Send status CSW to the host.
+*
+* Argument(s) : class_nbr   MSC instance number.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE, if device sends status successfully.
+*
+*                                                               ------ RETURNED BY USBD_BulkTx() : ------
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
+*                               USBD_ERR_EP_INVALID_NBR         Invalid endpoint number.
+*                               USBD_ERR_DEV_INVALID_STATE      Bulk transfer can ONLY be used after the
+*                                                                   device is in configured state.
+*                               USBD_ERR_EP_INVALID_TYPE        Invalid endpoint type.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The endpoints are closed when the host selects another alternate setting, which may
+*                   occur right after the host received the CSW but before the transfer returns. The aborted
+*                   transfer is then not followed by a stall of the bulk-IN endpoint, which may already be
+*                   reopened as the UAS data-in pipe.
+**********************************************************************************************************
+*/
+
+static  void  USBD_MSC_TxCSW  (USBD_MSC_CTRL  *p_ctrl,
+                               USBD_MSC_COMM  *p_comm,
+                               USBD_ERR       *p_err)
+{
+    USBD_ERR  stall_err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_comm->CSW.dCSWSignature = USBD_MSC_SIG_CSW;               /* Set CSW signature and rcvd tag from CBW.             */
+    p_comm->CSW.dCSWTag       = p_comm->CBW.dCBWTag;
+
+    USBD_MSC_CSW_Fmt(        &p_comm->CSW,                      /* Wr CSW to raw buf.                                   */
+                     (void *) p_ctrl->CSW_BufPtr);
+    CPU_CRITICAL_EXIT();
+                                                                /* Tx CSW to host through bulk-IN pipe.                 */
+    (void)USBD_BulkTx(p_ctrl->DevNbr,
+                      p_comm->DataBulkInEpAddr,
+                      p_ctrl->CSW_BufPtr,
+                      USBD_MSC_LEN_CSW,
+                      0,
+                      DEF_NO,
+                      p_err);
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    if ((*p_err == USBD_ERR_OS_ABORT) ||                        /* See Note #1.                                         */
+        (*p_err == USBD_ERR_EP_INVALID_ADDR)) {
+        CPU_CRITICAL_ENTER();
+        if (p_comm->NextCommState == USBD_MSC_COMM_STATE_CSW) {
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
+        }
+        CPU_CRITICAL_EXIT();
+        USBD_DBG_MSC_MSG("MSC: TxCSW, OS Abort");
+        return;
+    }
+#endif
+    if (*p_err != USBD_ERR_NONE){                               /* Enter reset recovery state.                          */
+        CPU_CRITICAL_ENTER();
+        p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_IN_STALL;
+        CPU_CRITICAL_EXIT();
+
+        USBD_DBG_MSC_MSG("MSC: TxCSW, Stall IN");
+        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+
+    } else {
+        if (p_comm->CSW.bCSWStatus == USBD_MSC_BCSWSTATUS_PHASE_ERROR){
+            CPU_CRITICAL_ENTER();
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY;
+            CPU_CRITICAL_EXIT();
+        } else {
+            CPU_CRITICAL_ENTER();                               /* Enter rx CBW state.                                  */
+            p_comm->NextCommState =  USBD_MSC_COMM_STATE_CBW;
+            CPU_CRITICAL_EXIT();
+        }
+    }
+}
+
+
+/*
+**********************************************************************************************************
+*                                             USBD_MSC_RxCBW()
+*
+* Description : Receive CBW from the host.
+*
+* Argument(s) : class_nbr   MSC instance number.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*                               USBD_ERR_NONE                   CBW successfully received from host
+
+*                                                               ------ RETURNED BY USBD_BulkRx() : ------
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
+*                               USBD_ERR_EP_INVALID_NBR         Invalid endpoint number.
+*                               USBD_ERR_DEV_INVALID_STATE      Bulk transfer can ONLY be used after the
+*                                                                   device is in configured state.
+*                               USBD_ERR_EP_INVALID_TYPE        Invalid endpoint type.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The CBW is not received if the UAS alternate setting was selected since the MSC task
+*                   checked the transport. Otherwise, 'CBW_RxPend' is set until the transfer returns, so
+*                   that an alternate setting update can abort it (see 'USBD_MSC_AltSettingUpdate()
+*                   Note #4').
+**********************************************************************************************************
+*/
+
+static  void  USBD_MSC_RxCBW (USBD_MSC_CTRL  *p_ctrl,
+                              USBD_MSC_COMM  *p_comm,
+                              USBD_ERR       *p_err)
+{
+    USBD_ERR    err;
+    USBD_ERR    stall_err;
+    CPU_INT32U  xfer_len;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    if (p_comm->UAS_En == DEF_YES) {
+        CPU_CRITICAL_EXIT();
+       *p_err = USBD_ERR_OS_ABORT;
+        return;
+    }
+    p_comm->CBW_RxPend = DEF_YES;
+    CPU_CRITICAL_EXIT();
+#endif
+
+    xfer_len = USBD_BulkRx (p_ctrl->DevNbr,                     /*Rx CBW and returns xfer_len upon success.             */
+                            p_comm->DataBulkOutEpAddr,
+                            p_ctrl->CBW_BufPtr,
+                            USBD_MSC_LEN_CBW,
+                            0,
+                            p_err);
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    CPU_CRITICAL_ENTER();
+    p_comm->CBW_RxPend = DEF_NO;
+    CPU_CRITICAL_EXIT();
+#endif
+
+    USBD_DBG_MSC_ARG("MSC: RxCBW", xfer_len);
+
+    switch (*p_err) {
+        case USBD_ERR_NONE:
+             break;
+
+        case USBD_ERR_DEV_INVALID_NBR:
+        case USBD_ERR_DEV_INVALID_STATE:
+        case USBD_ERR_OS_ABORT:
+        case USBD_ERR_EP_INVALID_ADDR:
+        case USBD_ERR_EP_INVALID_STATE:
+        case USBD_ERR_EP_INVALID_TYPE:
+             CPU_CRITICAL_ENTER();
+             if (p_ctrl->State == USBD_MSC_STATE_CFG){
+                p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
+             }
+             CPU_CRITICAL_EXIT();
+             USBD_DBG_MSC_MSG("MSC: RxCBW, OS Abort");
+             break;
+
+        case USBD_ERR_OS_TIMEOUT:
+             CPU_CRITICAL_ENTER();
+             if (p_ctrl->State == USBD_MSC_STATE_CFG){
+                p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
+             }
+             CPU_CRITICAL_EXIT();
+             USBD_DBG_MSC_MSG("MSC: RxCBW, OS Timeout");
+             break;
+
+        case USBD_ERR_EP_ABORT:
+        case USBD_ERR_RX:
+        case USBD_ERR_DRV_BUF_OVERFLOW:
+            CPU_CRITICAL_ENTER();
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_IN_STALL;
+            CPU_CRITICAL_EXIT();
+            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall IN/OUT");
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
+            break;
+
+        case USBD_ERR_OS_FAIL:
+        case USBD_ERR_NULL_PTR:
+        case USBD_ERR_EP_IO_PENDING:
+        case USBD_ERR_EP_QUEUING:
+        case USBD_ERR_DRV_INVALID_PKT:
+        default:
+            CPU_CRITICAL_ENTER();
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_OUT_STALL;
+            CPU_CRITICAL_EXIT();
+            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall OUT");
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
+            break;
+    }
+
+    if (*p_err == USBD_ERR_NONE) {
+                                                                /* Verify that CBW is valid and meaningful.             */
+        USBD_MSC_CBW_Verify(p_ctrl, p_comm, p_ctrl->CBW_BufPtr, xfer_len, &err);
+        if (err != USBD_ERR_NONE) {                             /* Enter reset recovery state.                          */
+            CPU_CRITICAL_ENTER();
+            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_IN_STALL;
+            CPU_CRITICAL_EXIT();
+
+            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall IN/OUT");
+
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
+            return;
+
+        }
+        CPU_CRITICAL_ENTER();
+                                                                /* Host expected transfer length.                       */
+        p_comm->CSW.dCSWDataResidue = p_comm->CBW.dCBWDataTransferLength;
+        p_comm->BytesToXfer         = 0;
+        p_comm->NextCommState       = USBD_MSC_COMM_STATE_DATA; /* Enter data transport state.                          */
+        CPU_CRITICAL_EXIT();
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_LunClr()
+*
+* Description : Initialize all logical unit fields.
+*
+* Argument(s) : p_lun       Pointer to Logical Unit information.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  void  USBD_MSC_LunClr  (USBD_MSC_LUN_CTRL  *p_lun)
+{
+    p_lun->LunNbr                    = 0;
+    p_lun->LunInfo.ProdRevisionLevel = 0;
+    p_lun->LunInfo.ReadOnly          = DEF_FALSE;
+    p_lun->NbrBlocks                 = 0;
+    p_lun->BlockSize                 = 0;
+
+    Mem_Clr((void     *)p_lun->LunInfo.VendorId,
+            (CPU_SIZE_T)8);
+    Mem_Clr((void     *)p_lun->LunInfo.ProdId,
+            (CPU_SIZE_T)16);
+
+    p_lun->LunArgPtr = (void *)0;
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+    p_lun->WrPipelineEn = DEF_ENABLED;
+#endif
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_CBW_Parse()
+*
+* Description : Parse CBW into CBW structure.
+*
+* Argument(s) : p_cbw       Variable that will hold the CBW parsed in this function.
+*
+*               p_buf_src   Pointer to buffer that holds CBW.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  void  USBD_MSC_CBW_Parse (USBD_MSC_CBW  *p_cbw,
+                                  void          *p_buf_src)
+{
+    CPU_INT08U  *p_buf_src_08;
+
+
+    p_buf_src_08 = (CPU_INT08U *)p_buf_src;
+
+    p_cbw->dCBWSignature          = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  0u));
+    p_cbw->dCBWTag                = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  4u));
+    p_cbw->dCBWDataTransferLength = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  8u));
+    p_cbw->bmCBWFlags             = p_buf_src_08[12];
+    p_cbw->bCBWLUN                = p_buf_src_08[13];
+    p_cbw->bCBWCBLength           = p_buf_src_08[14];
+
+    Mem_Copy((void     *)&p_cbw->CBWCB[0],
+             (void     *)&p_buf_src_08[15],
+             (CPU_SIZE_T) 16);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_MSC_CSW_Fmt()
+*
+* Description : Format CSW from CSW structure.
+*
+* Argument(s) : p_csw       Variable holds the CSW information.
+*
+*               p_buf_dest  Pointer to buffer that will hold CSW.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  void  USBD_MSC_CSW_Fmt (const  USBD_MSC_CSW  *p_csw,
+                                       void          *p_buf_dest)
+{
+    CPU_INT08U  *p_buf_dest_08;
+
+
+    p_buf_dest_08 = (CPU_INT08U *)p_buf_dest;
+
+    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 0u), p_csw->dCSWSignature);
+    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 4u), p_csw->dCSWTag);
+    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 8u), p_csw->dCSWDataResidue);
+
+    p_buf_dest_08[12] = p_csw->bCSWStatus;
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_AltSettingUpdate()
+*
+* Description : Select the Bulk-Only or the USB Attached SCSI transport, following a SET_INTERFACE request.
+*
+* Argument(s) : dev_nbr             Device number.
+*
+*               cfg_nbr             Configuration number.
+*
+*               if_nbr              Interface number.
+*
+*               if_alt_nbr          Interface alternate setting number.
+*
+*               p_if_class_arg      Pointer to class argument specific to interface.
+*
+*               p_if_alt_class_arg  Pointer to class argument specific to alternate interface.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The endpoints of the previous alternate setting are closed before this function is
+*                   called, which aborts the transfers in progress in the MSC task. The MSC task serving the
+*                   UAS pipes is also woken up, in case it waits for a storage read completion.
+*
+*               (2) A MSC task waiting for a Bulk-Only reset recovery or for the host to clear a stalled
+*                   endpoint is released: it then serves the UAS pipes (see 'USBD_MSC_TaskHandler()').
+*
+*               (3) Both alternate settings use the same bulk data endpoints. If the MSC task ran between
+*                   the closing of the previous alternate setting and this function, it may have started a
+*                   transfer of the previous transport on one of them: the transfer is aborted.
+*
+*               (4) The MSC task may be about to receive a CBW when the UAS alternate setting is selected,
+*                   in which case the first abort finds no transfer in progress. The abort is retried until
+*                   the MSC task leaves USBD_MSC_RxCBW(), or USBD_MSC_UAS_CBW_ABORT_RETRY_MAX times.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_AltSettingUpdate (CPU_INT08U   dev_nbr,
+                                         CPU_INT08U   cfg_nbr,
+                                         CPU_INT08U   if_nbr,
+                                         CPU_INT08U   if_alt_nbr,
+                                         void        *p_if_class_arg,
+                                         void        *p_if_alt_class_arg)
+{
+    USBD_MSC_COMM        *p_comm;
+    USBD_MSC_COMM_STATE   comm_state;
+    CPU_BOOLEAN           uas_en;
+    CPU_BOOLEAN           uas_en_prev;
+    CPU_INT08U            retry_cnt;
+    USBD_ERR              err;
+    USBD_ERR              os_err;
+    CPU_SR_ALLOC();
+
+
+    (void)cfg_nbr;
+    (void)if_nbr;
+    (void)p_if_alt_class_arg;
+
+    p_comm = (USBD_MSC_COMM *)p_if_class_arg;
+
+    if (if_alt_nbr == USBD_MSC_UAS_IF_ALT_NBR) {
+        uas_en = DEF_YES;
+    } else {
+        uas_en = DEF_NO;
+    }
+
+    CPU_CRITICAL_ENTER();
+    uas_en_prev    = p_comm->UAS_En;
+    comm_state     = p_comm->NextCommState;
+    p_comm->UAS_En = uas_en;
+    CPU_CRITICAL_EXIT();
+
+    if (uas_en == uas_en_prev) {
+        return;
+    }
+                                                                /* See Note #3.                                         */
+    USBD_EP_Abort(dev_nbr, p_comm->DataBulkInEpAddr,  &err);
+    USBD_EP_Abort(dev_nbr, p_comm->DataBulkOutEpAddr, &err);
+
+    if (uas_en == DEF_NO) {
+        USBD_DBG_MSC_MSG("MSC: Alt Setting, Bulk-Only");
+        USBD_MSC_UAS_SignalPost(p_comm);                        /* See Note #1.                                         */
+    } else {
+        USBD_DBG_MSC_MSG("MSC: Alt Setting, UAS");
+        retry_cnt = 0u;                                         /* See Note #4.                                         */
+        while ((p_comm->CBW_RxPend == DEF_YES) &&
+               (retry_cnt          <  USBD_MSC_UAS_CBW_ABORT_RETRY_MAX)) {
+            USBD_OS_DlyMs(1u);
+            USBD_EP_Abort(dev_nbr, p_comm->DataBulkOutEpAddr, &err);
+            retry_cnt++;
+        }
+
+        switch (comm_state) {                                   /* See Note #2.                                         */
+            case USBD_MSC_COMM_STATE_RESET_RECOVERY:
+            case USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_IN_STALL:
+            case USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_OUT_STALL:
+            case USBD_MSC_COMM_STATE_BULK_IN_STALL:
+            case USBD_MSC_COMM_STATE_BULK_OUT_STALL:
+                 USBD_MSC_OS_CommSignalPost(p_comm->CtrlPtr->ClassNbr, &os_err);
+                 break;
+
+            default:
+                 break;
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_UAS_EP_Desc()
+*
+* Description : Add the Pipe Usage descriptor following an endpoint descriptor of the UAS alternate setting.
+*
+* Argument(s) : dev_nbr             Device number.
+*
+*               cfg_nbr             Configuration number.
+*
+*               if_nbr              Interface number.
+*
+*               if_alt_nbr          Interface alternate setting number.
+*
+*               ep_addr             Endpoint address.
+*
+*               p_if_class_arg      Pointer to class argument specific to interface.
+*
+*               p_if_alt_class_arg  Pointer to class argument specific to alternate interface.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'USB ATTACHED SCSI DEFINES  Note #2'.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_EP_Desc (CPU_INT08U   dev_nbr,
+                                    CPU_INT08U   cfg_nbr,
+                                    CPU_INT08U   if_nbr,
+                                    CPU_INT08U   if_alt_nbr,
+                                    CPU_INT08U   ep_addr,
+                                    void        *p_if_class_arg,
+                                    void        *p_if_alt_class_arg)
+{
+    CPU_INT08U  pipe_id;
+
+
+    (void)cfg_nbr;
+    (void)if_nbr;
+    (void)p_if_alt_class_arg;
+
+    pipe_id = USBD_MSC_UAS_PipeID_Get((USBD_MSC_COMM *)p_if_class_arg,
+                                                       if_alt_nbr,
+                                                       ep_addr);
+    if (pipe_id == USBD_MSC_UAS_PIPE_ID_NONE) {
+        return;
+    }
+                                                                /* ------------- PIPE USAGE DESCRIPTOR ---------------- */
+    USBD_DescWr08(dev_nbr, USBD_MSC_UAS_DESC_LEN_PIPE_USAGE);   /* bLength.                                             */
+    USBD_DescWr08(dev_nbr, USBD_MSC_UAS_DESC_TYPE_PIPE_USAGE);  /* bDescriptorType.                                     */
+    USBD_DescWr08(dev_nbr, pipe_id);                            /* bPipeID.                                             */
+    USBD_DescWr08(dev_nbr, 0u);                                 /* Reserved.                                            */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_MSC_UAS_EP_DescSizeGet()
+*
+* Description : Retrieve the size of the Pipe Usage descriptor following an endpoint descriptor.
+*
+* Argument(s) : dev_nbr             Device number.
+*
+*               cfg_nbr             Configuration number.
+*
+*               if_nbr              Interface number.
+*
+*               if_alt_nbr          Interface alternate setting number.
+*
+*               ep_addr             Endpoint address.
+*
+*               p_if_class_arg      Pointer to class argument specific to interface.
+*
+*               p_if_alt_class_arg  Pointer to class argument specific to alternate interface.
+*
+* Return(s)   : Size of the Pipe Usage descriptor, if the endpoint belongs to the UAS alternate setting,
+*
+*               0,                                 otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_INT16U  USBD_MSC_UAS_EP_DescSizeGet (CPU_INT08U   dev_nbr,
+                                                 CPU_INT08U   cfg_nbr,
+                                                 CPU_INT08U   if_nbr,
+                                                 CPU_INT08U   if_alt_nbr,
+                                                 CPU_INT08U   ep_addr,
+                                                 void        *p_if_class_arg,
+                                                 void        *p_if_alt_class_arg)
+{
+    CPU_INT08U  pipe_id;
+
+
+    (void)dev_nbr;
+    (void)cfg_nbr;
+    (void)if_nbr;
+    (void)p_if_alt_class_arg;
+
+    pipe_id = USBD_MSC_UAS_PipeID_Get((USBD_MSC_COMM *)p_if_class_arg,
+                                                       if_alt_nbr,
+                                                       ep_addr);
+    if (pipe_id == USBD_MSC_UAS_PIPE_ID_NONE) {
+        return (0u);
+    }
+
+    return (USBD_MSC_UAS_DESC_LEN_PIPE_USAGE);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_PipeID_Get()
+*
+* Description : Retrieve the UAS pipe identifier of an endpoint.
+*
+* Argument(s) : p_comm      Pointer to MSC comm structure.
+*
+*               if_alt_nbr  Interface alternate setting number.
+*
+*               ep_addr     Endpoint address.
+*
+* Return(s)   : Pipe identifier,           if the endpoint belongs to the UAS alternate setting,
+*
+*               USBD_MSC_UAS_PIPE_ID_NONE, otherwise.
+*
+* Note(s)     : (1) The endpoints of the UAS alternate setting reuse the addresses of the Bulk-Only
+*                   endpoints, so the alternate setting number is checked first.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_INT08U  USBD_MSC_UAS_PipeID_Get (const  USBD_MSC_COMM  *p_comm,
+                                                    CPU_INT08U      if_alt_nbr,
+                                                    CPU_INT08U      ep_addr)
+{
+    CPU_INT08U  pipe_id;
+
+
+    if (if_alt_nbr != USBD_MSC_UAS_IF_ALT_NBR) {                /* See Note #1.                                         */
+        return (USBD_MSC_UAS_PIPE_ID_NONE);
+    }
+
+    if (ep_addr == p_comm->UAS_CmdEpAddr) {
+        pipe_id = USBD_MSC_UAS_PIPE_ID_CMD;
+    } else if (ep_addr == p_comm->UAS_StatusEpAddr) {
+        pipe_id = USBD_MSC_UAS_PIPE_ID_STATUS;
+    } else if (ep_addr == p_comm->UAS_DataInEpAddr) {
+        pipe_id = USBD_MSC_UAS_PIPE_ID_DATA_IN;
+    } else if (ep_addr == p_comm->UAS_DataOutEpAddr) {
+        pipe_id = USBD_MSC_UAS_PIPE_ID_DATA_OUT;
+    } else {
+        pipe_id = USBD_MSC_UAS_PIPE_ID_NONE;
+    }
+
+    return (pipe_id);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_UAS_Process()
+*
+* Description : Serve the UAS pipes for as long as the UAS alternate setting is selected.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Each pass of the loop :
+*
+*                   (a) Processes the IU received on the command pipe, if any, and re-arms the reception
+*                       of the next IU (see 'USBD_MSC_UAS_RespSet()  Note #1').
+*
+*                   (b) Starts storage reads in the free data buffers (see 'UAS TASK DATA TYPE  Note #1').
+*
+*                   (c) Performs at most one transfer on the status and data pipes.
+*
+*                   When there is nothing to do, the MSC task waits for a completion callback.
+*
+*               (2) Once the UAS alternate setting is deselected, the command pipe reception and the
+*                   storage reads in flight are waited for, so that no callback refers to the tasks anymore
+*                   and the data signal is balanced before the Bulk-Only Transport resumes.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_Process (USBD_MSC_CTRL  *p_ctrl,
+                                    USBD_MSC_COMM  *p_comm)
+{
+    CPU_BOOLEAN  active;
+    CPU_BOOLEAN  busy;
+    CPU_INT08U   task_ix;
+    CPU_SR_ALLOC();
+
+
+    USBD_DBG_MSC_MSG("MSC: UAS, Start");
+    USBD_MSC_UAS_Reset(p_comm);
+
+    while (p_comm->UAS_En == DEF_YES) {                         /* See Note #1.                                         */
+        active = DEF_NO;
+
+        if (p_comm->UAS_IU_RxState == USBD_MSC_UAS_IU_RX_STATE_CMPL) {
+            USBD_MSC_UAS_IU_Process(p_ctrl, p_comm);
+            active = DEF_YES;
+        }
+
+        if ((p_comm->UAS_IU_RxState == USBD_MSC_UAS_IU_RX_STATE_IDLE) &&
+            (p_comm->UAS_RespLen    == 0u)) {
+            USBD_MSC_UAS_IU_RxStart(p_ctrl, p_comm);
+        }
+
+        if (USBD_MSC_UAS_RdStart(p_ctrl, p_comm) == DEF_YES) {
+            active = DEF_YES;
+        }
+
+        if (USBD_MSC_UAS_PipeProcess(p_ctrl, p_comm) == DEF_YES) {
+            active = DEF_YES;
+        }
+
+        if (active == DEF_NO) {
+            USBD_MSC_UAS_SignalPend(p_comm);
+        }
+    }
+
+    while (DEF_TRUE) {                                          /* See Note #2.                                         */
+        CPU_CRITICAL_ENTER();
+        busy = DEF_NO;
+        if ((p_comm->UAS_IU_RxState == USBD_MSC_UAS_IU_RX_STATE_PEND) ||
+            (p_comm->UAS_SignalCnt  >  0u)) {
+            busy = DEF_YES;
+        }
+        for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+            if (p_comm->UAS_TaskTbl[task_ix].RdPendCnt > 0u) {
+                busy = DEF_YES;
+            }
+        }
+        CPU_CRITICAL_EXIT();
+
+        if (busy == DEF_NO) {
+            break;
+        }
+        USBD_MSC_UAS_SignalPend(p_comm);
+    }
+
+    USBD_MSC_UAS_Reset(p_comm);
+
+    CPU_CRITICAL_ENTER();
+    if (p_ctrl->State == USBD_MSC_STATE_CFG) {                  /* Bulk-Only alt setting selected: rx next CBW.         */
+        p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
+    }
+    CPU_CRITICAL_EXIT();
+    USBD_DBG_MSC_MSG("MSC: UAS, Stop");
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_Reset()
+*
+* Description : Release all the UAS tasks and the data buffers.
+*
+* Argument(s) : p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) No storage read or command pipe reception may be in flight when this function is
+*                   called (see 'USBD_MSC_UAS_Process()  Note #2').
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_Reset (USBD_MSC_COMM  *p_comm)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_INT08U          task_ix;
+
+
+    p_comm->UAS_IU_RxState   = USBD_MSC_UAS_IU_RX_STATE_IDLE;
+    p_comm->UAS_IU_RxLen     = 0u;
+    p_comm->UAS_IU_RxErr     = USBD_ERR_NONE;
+    p_comm->UAS_RespLen      = 0u;
+    p_comm->UAS_DataInTaskIx = USBD_MSC_UAS_TASK_IX_NONE;
+    p_comm->UAS_TaskIxNext   = 0u;
+    p_comm->UAS_XferTaskPtr  = (USBD_MSC_UAS_TASK *)0;
+
+    Mem_Clr((void     *)&p_comm->DataBufStateTbl[0],            /* All bufs FREE.                                       */
+            (CPU_SIZE_T) sizeof(p_comm->DataBufStateTbl));
+
+    for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+        p_task             = &p_comm->UAS_TaskTbl[task_ix];
+        p_task->State      =  USBD_MSC_UAS_TASK_STATE_FREE;
+        p_task->Abort      =  DEF_NO;
+        p_task->DataRemLen =  0u;
+        p_task->RdPendCnt  =  0u;
+        p_task->BufIxHead  =  0u;
+        p_task->BufCnt     =  0u;
+        p_task->Err        =  USBD_ERR_NONE;
+        p_task->CommPtr    =  p_comm;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_SignalPost()
+*
+* Description : Wake the MSC task serving the UAS pipes.
+*
+* Argument(s) : p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The data signal is shared with the pipelined Bulk-Only data stages, which expect one
+*                   post per buffer. The posts are counted so that they are all pended before the Bulk-Only
+*                   Transport resumes (see 'USBD_MSC_UAS_Process()  Note #2').
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_SignalPost (USBD_MSC_COMM  *p_comm)
+{
+    USBD_ERR  os_err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    p_comm->UAS_SignalCnt++;
+    CPU_CRITICAL_EXIT();
+
+    USBD_MSC_OS_DataSignalPost(p_comm->CtrlPtr->ClassNbr, &os_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_SignalPend()
+*
+* Description : Wait for a completion callback or for an alternate setting change.
+*
+* Argument(s) : p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_SignalPend (USBD_MSC_COMM  *p_comm)
+{
+    USBD_ERR  os_err;
+    CPU_SR_ALLOC();
+
+
+    USBD_MSC_OS_DataSignalPend(p_comm->CtrlPtr->ClassNbr, 0u, &os_err);
+    if (os_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (p_comm->UAS_SignalCnt > 0u) {
+        p_comm->UAS_SignalCnt--;
+    }
+    CPU_CRITICAL_EXIT();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_IU_RxStart()
+*
+* Description : Start the reception of an IU on the command pipe.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) If the reception cannot be started, it is retried on the next pass of the MSC task.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_IU_RxStart (USBD_MSC_CTRL  *p_ctrl,
+                                       USBD_MSC_COMM  *p_comm)
+{
+    USBD_ERR  err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    p_comm->UAS_IU_RxState = USBD_MSC_UAS_IU_RX_STATE_PEND;
+    CPU_CRITICAL_EXIT();
+
+    USBD_BulkRxAsync(        p_ctrl->DevNbr,
+                             p_comm->UAS_CmdEpAddr,
+                     (void *)p_ctrl->UAS_IU_BufPtr,
+                             USBD_MSC_UAS_IU_LEN_CMD,
+                             USBD_MSC_UAS_IU_RxCmpl,
+                     (void *)p_comm,
+                            &err);
+    if (err != USBD_ERR_NONE) {                                 /* See Note #1.                                         */
+        CPU_CRITICAL_ENTER();
+        p_comm->UAS_IU_RxState = USBD_MSC_UAS_IU_RX_STATE_IDLE;
+        CPU_CRITICAL_EXIT();
+        USBD_DBG_MSC_ARG("MSC: UAS IU Rx, Err", err);
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_IU_RxCmpl()
+*
+* Description : Inform the MSC task about the reception of an IU on the command pipe.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to the receive buffer.
+*
+*               buf_len     Receive buffer length.
+*
+*               xfer_len    Number of octets received.
+*
+*               p_arg       Pointer to MSC communication structure.
+*
+*               err         Transfer status.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The MSC task cannot process a task management function while it is blocked in a data
+*                   pipe transfer that the host cancelled. If the function applies to the task whose data
+*                   is being transferred, the data pipes are aborted: the MSC task then processes the IU
+*                   before anything else.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_IU_RxCmpl (CPU_INT08U   dev_nbr,
+                                      CPU_INT08U   ep_addr,
+                                      void        *p_buf,
+                                      CPU_INT32U   buf_len,
+                                      CPU_INT32U   xfer_len,
+                                      void        *p_arg,
+                                      USBD_ERR     err)
+{
+    USBD_MSC_COMM      *p_comm;
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_INT08U         *p_iu;
+    CPU_BOOLEAN         xfer_abort;
+    USBD_ERR            abort_err;
+    CPU_SR_ALLOC();
+
+
+    (void)ep_addr;
+    (void)buf_len;
+
+    p_comm = (USBD_MSC_COMM *)p_arg;
+    p_iu   = (CPU_INT08U    *)p_buf;
+
+    CPU_CRITICAL_ENTER();
+    p_comm->UAS_IU_RxLen   = xfer_len;
+    p_comm->UAS_IU_RxErr   = err;
+    p_comm->UAS_IU_RxState = USBD_MSC_UAS_IU_RX_STATE_CMPL;
+    p_task                 = p_comm->UAS_XferTaskPtr;
+    CPU_CRITICAL_EXIT();
+
+    xfer_abort = DEF_NO;                                        /* See Note #1.                                         */
+    if ((p_task   != (USBD_MSC_UAS_TASK *)0)              &&
+        (err      ==  USBD_ERR_NONE)                      &&
+        (xfer_len >=  USBD_MSC_UAS_IU_LEN_TASK_MGMT)      &&
+        (p_iu[0]  ==  USBD_MSC_UAS_IU_ID_TASK_MGMT)) {
+        switch (p_iu[4]) {
+            case USBD_MSC_UAS_TMF_ABORT_TASK:
+                 if ((MEM_VAL_GET_INT16U_BIG(&p_iu[6]) == p_task->Tag) &&
+                     (p_iu[9]                          == p_task->Lun)) {
+                     xfer_abort = DEF_YES;
+                 }
+                 break;
+
+            case USBD_MSC_UAS_TMF_ABORT_TASK_SET:
+            case USBD_MSC_UAS_TMF_CLR_TASK_SET:
+            case USBD_MSC_UAS_TMF_LU_RESET:
+                 if (p_iu[9] == p_task->Lun) {
+                     xfer_abort = DEF_YES;
+                 }
+                 break;
+
+            case USBD_MSC_UAS_TMF_IT_NEXUS_RESET:
+                 xfer_abort = DEF_YES;
+                 break;
+
+            default:
+                 break;
+        }
+    }
+
+    if (xfer_abort == DEF_YES) {
+        USBD_EP_Abort(dev_nbr, p_comm->UAS_DataInEpAddr,  &abort_err);
+        USBD_EP_Abort(dev_nbr, p_comm->UAS_DataOutEpAddr, &abort_err);
+    }
+
+    USBD_MSC_UAS_SignalPost(p_comm);                            /* Wake MSC task.                                       */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_UAS_IU_Process()
+*
+* Description : Process the IU received on the command pipe.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) An IU whose reception failed, or too short to hold a tag, is discarded. Other unknown or
+*                   malformed IUs are answered with an INVALID INFORMATION UNIT Response IU.
+*
+*               (2) Additional CDB octets are not supported: no command of the SCSI subset uses them.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_IU_Process (USBD_MSC_CTRL  *p_ctrl,
+                                       USBD_MSC_COMM  *p_comm)
+{
+    CPU_INT08U  *p_iu;
+    CPU_INT32U   iu_len;
+    CPU_INT16U   tag;
+    USBD_ERR     err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    iu_len                 = p_comm->UAS_IU_RxLen;
+    err                    = p_comm->UAS_IU_RxErr;
+    p_comm->UAS_IU_RxState = USBD_MSC_UAS_IU_RX_STATE_IDLE;
+    CPU_CRITICAL_EXIT();
+
+    if ((err    != USBD_ERR_NONE) ||                            /* See Note #1.                                         */
+        (iu_len <  USBD_MSC_UAS_IU_LEN_HDR)) {
+        USBD_DBG_MSC_ARG("MSC: UAS IU, Discarded", err);
+        return;
+    }
+
+    p_iu = p_ctrl->UAS_IU_BufPtr;
+    tag  = MEM_VAL_GET_INT16U_BIG(&p_iu[2]);
+
+    switch (p_iu[0]) {
+        case USBD_MSC_UAS_IU_ID_CMD:
+             if ((iu_len           <  USBD_MSC_UAS_IU_LEN_CMD) ||
+                 ((p_iu[6] & 0xFCu) != 0u)) {                   /* See Note #2.                                         */
+                 USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_INVALID_IU);
+             } else {
+                 USBD_MSC_UAS_CmdIU_Process(p_ctrl, p_comm, p_iu);
+             }
+             break;
+
+        case USBD_MSC_UAS_IU_ID_TASK_MGMT:
+             if (iu_len < USBD_MSC_UAS_IU_LEN_TASK_MGMT) {
+                 USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_INVALID_IU);
+             } else {
+                 USBD_MSC_UAS_TMF_IU_Process(p_ctrl, p_comm, p_iu);
+             }
+             break;
+
+        default:
+             USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_INVALID_IU);
+             break;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_UAS_CmdIU_Process()
+*
+* Description : Queue the command of a Command IU in a free task.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_iu        Pointer to the Command IU.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The command is parsed by USBD_SCSI_CmdProcess() as soon as it is queued, so that the
+*                   storage reads of its data stage can start (see 'USBD_MSC_UAS_RdStart()').
+*
+*               (2) A command whose tag is already used by a task that is not aborted is rejected with an
+*                   OVERLAPPED TAG ATTEMPTED Response IU (see UAS-2 Section 6.2.2).
+*
+*               (3) When all the tasks are in use, the command is completed with a TASK SET FULL status,
+*                   which makes the host retry it later.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_CmdIU_Process (       USBD_MSC_CTRL  *p_ctrl,
+                                                 USBD_MSC_COMM  *p_comm,
+                                          const  CPU_INT08U     *p_iu)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    USBD_MSC_UAS_TASK  *p_task_free;
+    CPU_INT08U          task_ix;
+    CPU_INT16U          tag;
+    CPU_INT08U          lun;
+    CPU_INT32U          resp_len;
+    CPU_INT08U          data_dir;
+    USBD_ERR            err;
+
+
+    tag         =  MEM_VAL_GET_INT16U_BIG(&p_iu[2]);
+    lun         =  p_iu[9];
+    p_task_free = (USBD_MSC_UAS_TASK *)0;
+
+    for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+        p_task = &p_comm->UAS_TaskTbl[task_ix];
+        if (p_task->State == USBD_MSC_UAS_TASK_STATE_FREE) {
+            if (p_task_free == (USBD_MSC_UAS_TASK *)0) {
+                p_task_free = p_task;
+            }
+        } else if ((p_task->Tag   == tag) &&                    /* See Note #2.                                         */
+                   (p_task->Abort == DEF_NO)) {
+            USBD_DBG_MSC_ARG("MSC: UAS Cmd, Overlapped Tag", tag);
+            USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_OVERLAPPED_TAG);
+            return;
+        }
+    }
+
+    if ((p_iu[8] != 0u) ||                                      /* Single level LUN only.                               */
+        (lun     >= p_ctrl->MaxLun)) {
+        USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_INCORRECT_LUN);
+        return;
+    }
+
+    if (p_task_free == (USBD_MSC_UAS_TASK *)0) {                /* See Note #3.                                         */
+        USBD_DBG_MSC_ARG("MSC: UAS Cmd, Task Set Full", tag);
+        USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_SENSE, tag, USBD_MSC_UAS_STATUS_TASK_SET_FULL);
+        return;
+    }
+
+    p_task             = p_task_free;
+    p_task->Tag        = tag;
+    p_task->Lun        = lun;
+    p_task->Abort      = DEF_NO;
+    p_task->DataRemLen = 0u;
+    p_task->Err        = USBD_ERR_NONE;
+
+    Mem_Copy((void     *)&p_task->CDB[0],
+             (void     *)&p_iu[16],
+             (CPU_SIZE_T) sizeof(p_task->CDB));
+    Mem_Clr((void     *)&p_task->Cmd,                           /* Sense data of this cmd only.                         */
+            (CPU_SIZE_T) sizeof(p_task->Cmd));
+
+    resp_len = 0u;
+    data_dir = USBD_MSC_BMCBWFLAGS_DIR_HOST_TO_DEVICE;
+    USBD_SCSI_CmdProcess(&p_ctrl->Lun[lun],                     /* See Note #1.                                         */
+                         &p_task->Cmd,
+                         &p_task->CDB[0],
+                         &resp_len,
+                         &data_dir,
+                         &err);
+    if (err != USBD_ERR_NONE) {
+        p_task->Err   = err;
+        p_task->State = USBD_MSC_UAS_TASK_STATE_STATUS;
+    } else if (resp_len == 0u) {
+        p_task->State = USBD_MSC_UAS_TASK_STATE_STATUS;
+    } else if (data_dir == USBD_MSC_BMCBWFLAGS_DIR_DEVICE_TO_HOST) {
+        p_task->DataRemLen = resp_len;
+        p_task->State      = USBD_MSC_UAS_TASK_STATE_DATA_IN;
+    } else {
+        p_task->DataRemLen = resp_len;
+        p_task->State      = USBD_MSC_UAS_TASK_STATE_DATA_OUT;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_MSC_UAS_TMF_IU_Process()
+*
+* Description : Perform the task management function of a Task Management IU.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_iu        Pointer to the Task Management IU.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Aborted tasks complete without a Sense IU (see UAS-2 Section 6.3).
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_TMF_IU_Process (       USBD_MSC_CTRL  *p_ctrl,
+                                                  USBD_MSC_COMM  *p_comm,
+                                           const  CPU_INT08U     *p_iu)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_INT08U          task_ix;
+    CPU_INT08U          tmf;
+    CPU_INT16U          tag;
+    CPU_INT16U          tag_mgd;
+    CPU_INT08U          lun;
+    CPU_INT08U          resp_code;
+
+
+    tag       = MEM_VAL_GET_INT16U_BIG(&p_iu[2]);
+    tmf       = p_iu[4];
+    tag_mgd   = MEM_VAL_GET_INT16U_BIG(&p_iu[6]);
+    lun       = p_iu[9];
+    resp_code = USBD_MSC_UAS_RESP_TMF_COMPLETE;
+
+    if ((tmf     != USBD_MSC_UAS_TMF_IT_NEXUS_RESET) &&
+        ((p_iu[8] != 0u) ||
+         (lun     >= p_ctrl->MaxLun))) {
+        USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, USBD_MSC_UAS_RESP_INCORRECT_LUN);
+        return;
+    }
+
+    switch (tmf) {
+        case USBD_MSC_UAS_TMF_ABORT_TASK:
+        case USBD_MSC_UAS_TMF_QUERY_TASK:
+             for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+                 p_task = &p_comm->UAS_TaskTbl[task_ix];
+                 if ((p_task->State != USBD_MSC_UAS_TASK_STATE_FREE) &&
+                     (p_task->Abort == DEF_NO)                       &&
+                     (p_task->Tag   == tag_mgd)                      &&
+                     (p_task->Lun   == lun)) {
+                     if (tmf == USBD_MSC_UAS_TMF_ABORT_TASK) {
+                         USBD_MSC_UAS_TaskAbort(p_comm, task_ix);
+                     } else {
+                         resp_code = USBD_MSC_UAS_RESP_TMF_SUCCEEDED;
+                     }
+                 }
+             }
+             break;
+
+        case USBD_MSC_UAS_TMF_ABORT_TASK_SET:
+        case USBD_MSC_UAS_TMF_CLR_TASK_SET:
+        case USBD_MSC_UAS_TMF_LU_RESET:
+             for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+                 p_task = &p_comm->UAS_TaskTbl[task_ix];
+                 if ((p_task->State != USBD_MSC_UAS_TASK_STATE_FREE) &&
+                     (p_task->Lun   == lun)) {
+                     USBD_MSC_UAS_TaskAbort(p_comm, task_ix);
+                 }
+             }
+             if (tmf == USBD_MSC_UAS_TMF_LU_RESET) {
+                 USBD_SCSI_Reset(&p_ctrl->Lun[lun]);
+             }
+             break;
+
+        case USBD_MSC_UAS_TMF_IT_NEXUS_RESET:
+             for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+                 if (p_comm->UAS_TaskTbl[task_ix].State != USBD_MSC_UAS_TASK_STATE_FREE) {
+                     USBD_MSC_UAS_TaskAbort(p_comm, task_ix);
+                 }
+             }
+             break;
+
+        default:
+             resp_code = USBD_MSC_UAS_RESP_TMF_NOT_SUPPORTED;
+             break;
+    }
+
+    USBD_DBG_MSC_ARG("MSC: UAS TMF", tmf);
+    USBD_MSC_UAS_RespSet(p_ctrl, p_comm, USBD_MSC_UAS_IU_ID_RESP, tag, resp_code);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_UAS_RespSet()
+*
+* Description : Prepare an IU that is not tied to a task for transmission on the status pipe.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               iu_id       IU identifier :
+*
+*                               USBD_MSC_UAS_IU_ID_RESP     Response IU.
+*                               USBD_MSC_UAS_IU_ID_SENSE    Sense IU, without sense data.
+*
+*               tag         Tag of the IU.
+*
+*               code        Response code of a Response IU, or status of a Sense IU.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) A single such IU is held at a time: the next IU is not received on the command pipe
+*                   until it is sent (see 'USBD_MSC_UAS_Process()  Note #1a').
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_RespSet (USBD_MSC_CTRL  *p_ctrl,
+                                    USBD_MSC_COMM  *p_comm,
+                                    CPU_INT08U      iu_id,
+                                    CPU_INT16U      tag,
+                                    CPU_INT08U      code)
+{
+    CPU_INT08U  *p_iu;
+
+
+    p_iu = p_ctrl->UAS_RespBufPtr;
+    Mem_Clr((void     *)p_iu,
+            (CPU_SIZE_T)USBD_MSC_UAS_IU_LEN_SENSE);
+
+    p_iu[0] = iu_id;
+    MEM_VAL_SET_INT16U_BIG(&p_iu[2], tag);
+
+    if (iu_id == USBD_MSC_UAS_IU_ID_SENSE) {
+        p_iu[6]             = code;                             /* Status.                                              */
+        p_comm->UAS_RespLen = USBD_MSC_UAS_IU_LEN_SENSE;
+    } else {
+        p_iu[7]             = code;                             /* Resp code.                                           */
+        p_comm->UAS_RespLen = USBD_MSC_UAS_IU_LEN_RESP;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_UAS_RdStart()
+*
+* Description : Start storage reads for the data-in stages in the free data buffers.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : DEF_YES, if at least one storage read was started,
+*
+*               DEF_NO,  otherwise.
+*
+* Note(s)     : (1) The task owning the data-in pipe is served first and may fill all the free buffers.
+*                   The other tasks read their first buffer only (see 'UAS TASK DATA TYPE  Note #1'), and
+*                   leave USBD_MSC_UAS_BUF_NBR_RSVD buffers free so that the next owner can still pipeline
+*                   its data stage.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_MSC_UAS_RdStart (USBD_MSC_CTRL  *p_ctrl,
+                                           USBD_MSC_COMM  *p_comm)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_INT08U          task_ix;
+    CPU_INT08U          buf_ix;
+    CPU_INT08U          buf_max;
+    CPU_INT08U          buf_rsvd;
+    CPU_INT08U          cnt;
+    CPU_BOOLEAN         started;
+
+
+    started = DEF_NO;
+    for (cnt = 0u; cnt <= USBD_MSC_CFG_UAS_QUEUE_DEPTH; cnt++) {
+        if (cnt == 0u) {                                        /* See Note #1.                                         */
+            task_ix  = p_comm->UAS_DataInTaskIx;
+            buf_max  = USBD_MSC_CFG_DATA_NBR_BUF;
+            buf_rsvd = 0u;
+            if (task_ix == USBD_MSC_UAS_TASK_IX_NONE) {
+                continue;
+            }
+        } else {
+            task_ix  = cnt - 1u;
+            buf_max  = 1u;
+            buf_rsvd = USBD_MSC_UAS_BUF_NBR_RSVD;
+            if (task_ix == p_comm->UAS_DataInTaskIx) {
+                continue;
+            }
+        }
+
+        p_task = &p_comm->UAS_TaskTbl[task_ix];
+        while ((p_task->State      == USBD_MSC_UAS_TASK_STATE_DATA_IN) &&
+               (p_task->Abort      == DEF_NO)                          &&
+               (p_task->Err        == USBD_ERR_NONE)                   &&
+               (p_task->DataRemLen >  0u)                              &&
+               (p_task->BufCnt     <  buf_max)) {
+            buf_ix = USBD_MSC_UAS_BufFreeGet(p_comm, buf_rsvd);
+            if (buf_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+                break;
+            }
+
+            USBD_MSC_UAS_TaskRd(p_ctrl, p_comm, p_task, buf_ix);
+            started = DEF_YES;
+        }
+    }
+
+    return (started);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_TaskRd()
+*
+* Description : Start the storage read of the next part of a task's data-in stage.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_task      Pointer to UAS task.
+*
+*               buf_ix      Index of the free data buffer to read into.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The buffer is queued in the task before the read is started, since the completion
+*                   callback may be called before USBD_SCSI_DataRdAsync() returns.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_TaskRd (USBD_MSC_CTRL      *p_ctrl,
+                                   USBD_MSC_COMM      *p_comm,
+                                   USBD_MSC_UAS_TASK  *p_task,
+                                   CPU_INT08U          buf_ix)
+{
+    CPU_INT32U  rd_len;
+    CPU_INT08U  tail_ix;
+    USBD_ERR    err;
+    CPU_SR_ALLOC();
+
+
+    rd_len  = DEF_MIN(p_task->DataRemLen, USBD_MSC_CFG_DATA_LEN);
+    tail_ix = p_task->BufIxHead + p_task->BufCnt;
+    if (tail_ix >= USBD_MSC_CFG_DATA_NBR_BUF) {
+        tail_ix -= USBD_MSC_CFG_DATA_NBR_BUF;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_RD;
+    p_comm->DataXferLenTbl[buf_ix]  = 0u;
+    p_task->BufIxTbl[tail_ix]       = buf_ix;
+    p_task->BufCnt++;
+    p_task->RdPendCnt++;
+    CPU_CRITICAL_EXIT();
+
+    p_task->DataRemLen -= rd_len;
+
+    USBD_SCSI_DataRdAsync(&p_ctrl->Lun[p_task->Lun],
+                          &p_task->Cmd,
+                           p_task->CDB[0],
+                           p_ctrl->DataBufPtrTbl[buf_ix],
+                           rd_len,
+                           USBD_MSC_UAS_RdCmpl,
+                  (void *) p_task,
+                          &err);
+    if ((err != USBD_ERR_NONE) &&
+        (err != USBD_ERR_SCSI_MORE_DATA)) {                     /* Rd not started: no callback.                         */
+        CPU_CRITICAL_ENTER();
+        p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_FREE;
+        p_task->BufCnt--;
+        p_task->RdPendCnt--;
+        if (p_task->Err == USBD_ERR_NONE) {
+            p_task->Err = err;
+        }
+        CPU_CRITICAL_EXIT();
+
+        p_task->DataRemLen = 0u;
+        USBD_DBG_MSC_ARG("MSC: UAS Rd, Err", err);
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_RdCmpl()
+*
+* Description : Inform the MSC task about the completion of a storage read of a UAS task.
+*
+* Argument(s) : p_buf       Pointer to the data buffer.
+*
+*               data_len    Number of octets read.
+*
+*               p_arg       Pointer to UAS task.
+*
+*               err         Read status.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) This function may be called from USBD_SCSI_DataRdAsync(), from a storage task or from
+*                   an interrupt service routine (see 'usbd_scsi.h  STORAGE COMPLETION CALLBACK').
+*
+*               (2) A buffer that could not be read is never transmitted: the data-in stage of the task
+*                   ends at the first error, and the buffer is released with the others held by the task.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_RdCmpl (CPU_INT08U  *p_buf,
+                                   CPU_INT32U   data_len,
+                                   void        *p_arg,
+                                   USBD_ERR     err)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    USBD_MSC_COMM      *p_comm;
+    USBD_MSC_CTRL      *p_ctrl;
+    CPU_INT08U          buf_ix;
+    CPU_SR_ALLOC();
+
+
+    p_task = (USBD_MSC_UAS_TASK *)p_arg;
+    p_comm =  p_task->CommPtr;
+    p_ctrl =  p_comm->CtrlPtr;
+
+    for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+        if (p_ctrl->DataBufPtrTbl[buf_ix] == p_buf) {
+            break;
+        }
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (buf_ix < USBD_MSC_CFG_DATA_NBR_BUF) {                   /* See Note #2.                                         */
+        p_comm->DataXferLenTbl[buf_ix]  = data_len;
+        p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_RDY;
+    }
+    if ((err         != USBD_ERR_NONE) &&
+        (p_task->Err == USBD_ERR_NONE)) {
+        p_task->Err = err;
+    }
+    p_task->RdPendCnt--;
+    CPU_CRITICAL_EXIT();
+
+    USBD_MSC_UAS_SignalPost(p_comm);                            /* Wake MSC task.                                       */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_MSC_UAS_PipeProcess()
+*
+* Description : Perform the next transfer on the status and data pipes.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+* Return(s)   : DEF_YES, if a task progressed,
+*
+*               DEF_NO,  if all the tasks wait for a storage read or a data buffer.
+*
+* Note(s)     : (1) The data-in pipe is owned by a task from its READ READY IU to the end of its data
+*                   stage. Until then, the status pipe only carries the IUs of that task, so that the host
+*                   receives the data of a single command at a time.
+*
+*               (2) The other tasks are served in turn. A data-in task is served when its first buffer is
+*                   read, so the command whose read completes first is transferred first.
+*
+*               (3) A task that was aborted, or whose data-in stage failed, is completed once its storage
+*                   reads in flight complete.
+*
+*               (4) The response to a task management function is sent once the tasks it aborted are
+*                   freed, so that the host may reuse their slots as soon as it receives the response.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_MSC_UAS_PipeProcess (USBD_MSC_CTRL  *p_ctrl,
+                                               USBD_MSC_COMM  *p_comm)
+{
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_INT08U          task_ix;
+    CPU_INT08U          cnt;
+    CPU_INT08U          rd_pend_cnt;
+    CPU_INT08U          buf_state;
+    CPU_BOOLEAN         abort_pend;
+    CPU_BOOLEAN         done;
+    USBD_ERR            err;
+    CPU_SR_ALLOC();
+
+
+                                                                /* See Note #1.                                         */
+    if (p_comm->UAS_DataInTaskIx != USBD_MSC_UAS_TASK_IX_NONE) {
+        p_task = &p_comm->UAS_TaskTbl[p_comm->UAS_DataInTaskIx];
+        return (USBD_MSC_UAS_DataTx(p_ctrl, p_comm, p_task));
+    }
+
+    abort_pend = DEF_NO;
+    for (task_ix = 0u; task_ix < USBD_MSC_CFG_UAS_QUEUE_DEPTH; task_ix++) {
+        p_task = &p_comm->UAS_TaskTbl[task_ix];
+        if ((p_task->State != USBD_MSC_UAS_TASK_STATE_FREE) &&
+            (p_task->Abort == DEF_YES)) {
+            abort_pend = DEF_YES;
+        }
+    }
+                                                                /* Tx IU not tied to a task (see Note #4).              */
+    if ((p_comm->UAS_RespLen >  0u) &&
+        (abort_pend          == DEF_NO)) {
+        (void)USBD_BulkTx(        p_ctrl->DevNbr,
+                                  p_comm->UAS_StatusEpAddr,
+                          (void *)p_ctrl->UAS_RespBufPtr,
+                                  p_comm->UAS_RespLen,
+                                  0u,
+                                  DEF_NO,
+                                 &err);
+        p_comm->UAS_RespLen = 0u;
+        return (DEF_YES);
+    }
+
+    task_ix = p_comm->UAS_TaskIxNext;                           /* See Note #2.                                         */
+    for (cnt = 0u; cnt < USBD_MSC_CFG_UAS_QUEUE_DEPTH; cnt++) {
+        if (task_ix >= USBD_MSC_CFG_UAS_QUEUE_DEPTH) {
+            task_ix = 0u;
+        }
+        p_task = &p_comm->UAS_TaskTbl[task_ix];
+        done   =  DEF_YES;
+
+        switch (p_task->State) {
+            case USBD_MSC_UAS_TASK_STATE_DATA_IN:
+                 CPU_CRITICAL_ENTER();
+                 rd_pend_cnt = p_task->RdPendCnt;
+                 buf_state   = USBD_MSC_DATA_BUF_STATE_FREE;
+                 if (p_task->BufCnt > 0u) {
+                     buf_state = p_comm->DataBufStateTbl[p_task->BufIxTbl[p_task->BufIxHead]];
+                 }
+                 CPU_CRITICAL_EXIT();
+
+                 if ((p_task->Abort == DEF_YES) ||              /* See Note #3.                                         */
+                     (p_task->Err   != USBD_ERR_NONE)) {
+                     if (rd_pend_cnt > 0u) {
+                         done = DEF_NO;
+                     } else {
+                         USBD_MSC_UAS_TaskBufRelease(p_comm, p_task);
+                         p_task->DataRemLen = 0u;
+                         if (p_task->Abort == DEF_YES) {
+                             p_task->State = USBD_MSC_UAS_TASK_STATE_FREE;
+                         } else {
+                             p_task->State = USBD_MSC_UAS_TASK_STATE_STATUS;
+                         }
+                     }
+                 } else if (buf_state == USBD_MSC_DATA_BUF_STATE_RDY) {
+                     p_comm->UAS_DataInTaskIx = task_ix;
+                     USBD_MSC_UAS_RdyTx(p_ctrl, p_comm, p_task, USBD_MSC_UAS_IU_ID_RD_RDY);
+                     (void)USBD_MSC_UAS_DataTx(p_ctrl, p_comm, p_task);
+                 } else {
+                     done = DEF_NO;
+                 }
+                 break;
+
+            case USBD_MSC_UAS_TASK_STATE_DATA_OUT:
+                 if (USBD_MSC_UAS_BufFreeGet(p_comm, 0u) < USBD_MSC_CFG_DATA_NBR_BUF) {
+                     USBD_MSC_UAS_DataRx(p_ctrl, p_comm, p_task);
+                 } else {
+                     done = DEF_NO;
+                 }
+                 break;
+
+            case USBD_MSC_UAS_TASK_STATE_STATUS:
+                 USBD_MSC_UAS_SenseTx(p_ctrl, p_comm, p_task);
+                 p_task->State = USBD_MSC_UAS_TASK_STATE_FREE;
+                 break;
+
+            case USBD_MSC_UAS_TASK_STATE_FREE:
+            default:
+                 done = DEF_NO;
+                 break;
+        }
+
+        task_ix++;
+        if (done == DEF_YES) {
+            p_comm->UAS_TaskIxNext = task_ix;
+            return (DEF_YES);
+        }
+    }
+
+    return (DEF_NO);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_DataTx()
+*
+* Description : Transmit the next buffer of the data-in stage of the task owning the data-in pipe.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_task      Pointer to UAS task.
+*
+* Return(s)   : DEF_YES, if a buffer was transmitted or the data-in stage ended,
+*
+*               DEF_NO,  if the next buffer is not read yet.
+*
+* Note(s)     : (1) When the data-in stage ends, the data-in pipe is released and the task waits for its
+*                   Sense IU to be sent. If the data-in stage failed, the storage reads in flight are waited
+*                   for first.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_MSC_UAS_DataTx (USBD_MSC_CTRL      *p_ctrl,
+                                          USBD_MSC_COMM      *p_comm,
+                                          USBD_MSC_UAS_TASK  *p_task)
+{
+    CPU_INT08U  buf_ix;
+    CPU_INT08U  buf_state;
+    CPU_INT08U  rd_pend_cnt;
+    USBD_ERR    err;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();
+    err         = p_task->Err;
+    rd_pend_cnt = p_task->RdPendCnt;
+    buf_ix      = p_task->BufIxTbl[p_task->BufIxHead];
+    buf_state   = USBD_MSC_DATA_BUF_STATE_FREE;
+    if (p_task->BufCnt > 0u) {
+        buf_state = p_comm->DataBufStateTbl[buf_ix];
+    }
+    CPU_CRITICAL_EXIT();
+
+    if (err == USBD_ERR_NONE) {
+        if (buf_state == USBD_MSC_DATA_BUF_STATE_RDY) {
+            CPU_CRITICAL_ENTER();
+            p_comm->UAS_XferTaskPtr = p_task;
+            CPU_CRITICAL_EXIT();
+
+            (void)USBD_BulkTx(        p_ctrl->DevNbr,
+                                      p_comm->UAS_DataInEpAddr,
+                              (void *)p_ctrl->DataBufPtrTbl[buf_ix],
+                                      p_comm->DataXferLenTbl[buf_ix],
+                                      0u,
+                                      DEF_NO,
+                                     &err);
+
+            CPU_CRITICAL_ENTER();
+            p_comm->UAS_XferTaskPtr         = (USBD_MSC_UAS_TASK *)0;
+            p_comm->DataBufStateTbl[buf_ix] =  USBD_MSC_DATA_BUF_STATE_FREE;
+            p_task->BufIxHead++;
+            if (p_task->BufIxHead >= USBD_MSC_CFG_DATA_NBR_BUF) {
+                p_task->BufIxHead = 0u;
+            }
+            p_task->BufCnt--;
+            if ((err         != USBD_ERR_NONE) &&
+                (p_task->Err == USBD_ERR_NONE)) {
+                p_task->Err = err;
+            }
+            CPU_CRITICAL_EXIT();
+            return (DEF_YES);
+        }
+
+        if ((p_task->BufCnt     > 0u) ||                        /* Wait for storage rd.                                 */
+            (p_task->DataRemLen > 0u)) {
+            return (DEF_NO);
+        }
+    } else if (rd_pend_cnt > 0u) {                              /* See Note #1.                                         */
+        p_task->DataRemLen = 0u;
+        return (DEF_NO);
+    }
+
+    USBD_MSC_UAS_TaskBufRelease(p_comm, p_task);
+    p_task->DataRemLen       = 0u;
+    p_task->State            = USBD_MSC_UAS_TASK_STATE_STATUS;
+    p_comm->UAS_DataInTaskIx = USBD_MSC_UAS_TASK_IX_NONE;
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_DataRx()
 *
-* Argument(s) : class_nbr   MSC instance number.
+* Description : Receive the data-out stage of a task and write it to the storage media.
 *
-*               p_err       Pointer to variable that will receive the return error code from this function :
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
 *
-*                               USBD_ERR_NONE, if device sends status successfully.
+*               p_comm      Pointer to MSC comm structure.
 *
-*                                                               ------ RETURNED BY USBD_BulkTx() : ------
-*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
-*                               USBD_ERR_EP_INVALID_NBR         Invalid endpoint number.
-*                               USBD_ERR_DEV_INVALID_STATE      Bulk transfer can ONLY be used after the
-*                                                                   device is in configured state.
-*                               USBD_ERR_EP_INVALID_TYPE        Invalid endpoint type.
+*               p_task      Pointer to UAS task.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
-**********************************************************************************************************
+* Note(s)     : (1) The data-out stage is received in a single free data buffer, each part being written
+*                   to the storage media before the next one is received. The buffer is not marked as used
+*                   since only the MSC task allocates buffers.
+*
+*               (2) A short data-out stage fails the command.
+*********************************************************************************************************
 */
 
-static  void  USBD_MSC_TxCSW  (USBD_MSC_CTRL  *p_ctrl,
-                               USBD_MSC_COMM  *p_comm,
-                               USBD_ERR       *p_err)
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_DataRx (USBD_MSC_CTRL      *p_ctrl,
+                                   USBD_MSC_COMM      *p_comm,
+                                   USBD_MSC_UAS_TASK  *p_task)
 {
-    USBD_ERR  stall_err;
+    CPU_INT08U  *p_buf;
+    CPU_INT08U   buf_ix;
+    CPU_INT32U   rx_len;
+    CPU_INT32U   xfer_len;
+    USBD_ERR     err;
     CPU_SR_ALLOC();
 
 
-    CPU_CRITICAL_ENTER();
-    p_comm->CSW.dCSWSignature = USBD_MSC_SIG_CSW;               /* Set CSW signature and rcvd tag from CBW.             */
-    p_comm->CSW.dCSWTag       = p_comm->CBW.dCBWTag;
+    buf_ix = USBD_MSC_UAS_BufFreeGet(p_comm, 0u);               /* See Note #1.                                         */
+    p_buf  = p_ctrl->DataBufPtrTbl[buf_ix];
+
+    USBD_MSC_UAS_RdyTx(p_ctrl, p_comm, p_task, USBD_MSC_UAS_IU_ID_WR_RDY);
+
+    while ((p_task->Err        == USBD_ERR_NONE) &&
+           (p_task->DataRemLen >  0u)) {
+        rx_len = DEF_MIN(p_task->DataRemLen, USBD_MSC_CFG_DATA_LEN);
 
-    USBD_MSC_CSW_Fmt(        &p_comm->CSW,                      /* Wr CSW to raw buf.                                   */
-                     (void *) p_ctrl->CSW_BufPtr);
-    CPU_CRITICAL_EXIT();
-                                                                /* Tx CSW to host through bulk-IN pipe.                 */
-    (void)USBD_BulkTx(p_ctrl->DevNbr,
-                      p_comm->DataBulkInEpAddr,
-                      p_ctrl->CSW_BufPtr,
-                      USBD_MSC_LEN_CSW,
-                      0,
-                      DEF_NO,
-                      p_err);
-    if (*p_err != USBD_ERR_NONE){                               /* Enter reset recovery state.                          */
         CPU_CRITICAL_ENTER();
-        p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_IN_STALL;
+        p_comm->UAS_XferTaskPtr = p_task;
         CPU_CRITICAL_EXIT();
 
-        USBD_DBG_MSC_MSG("MSC: TxCSW, Stall IN");
-        USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
+        xfer_len = USBD_BulkRx(        p_ctrl->DevNbr,
+                                       p_comm->UAS_DataOutEpAddr,
+                               (void *)p_buf,
+                                       rx_len,
+                                       0u,
+                                      &err);
 
-    } else {
-        if (p_comm->CSW.bCSWStatus == USBD_MSC_BCSWSTATUS_PHASE_ERROR){
-            CPU_CRITICAL_ENTER();
-            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY;
-            CPU_CRITICAL_EXIT();
-        } else {
-            CPU_CRITICAL_ENTER();                               /* Enter rx CBW state.                                  */
-            p_comm->NextCommState =  USBD_MSC_COMM_STATE_CBW;
-            CPU_CRITICAL_EXIT();
+        CPU_CRITICAL_ENTER();
+        p_comm->UAS_XferTaskPtr = (USBD_MSC_UAS_TASK *)0;
+        CPU_CRITICAL_EXIT();
+
+        if ((err      == USBD_ERR_NONE) &&                      /* See Note #2.                                         */
+            (xfer_len != rx_len)) {
+            err = USBD_ERR_RX;
+        }
+
+        if (err == USBD_ERR_NONE) {
+            p_task->DataRemLen -= rx_len;
+            USBD_SCSI_DataWr(&p_ctrl->Lun[p_task->Lun],         /* Wr data to SCSI sto.                                 */
+                             &p_task->Cmd,
+                              p_task->CDB[0],
+                      (void *)p_buf,
+                              rx_len,
+                             &err);
+            if (err == USBD_ERR_SCSI_MORE_DATA) {
+                err = USBD_ERR_NONE;
+            }
+        }
+
+        if (err != USBD_ERR_NONE) {
+            p_task->Err = err;
+            USBD_DBG_MSC_ARG("MSC: UAS Rx, Err", err);
         }
     }
+
+    p_task->DataRemLen = 0u;
+    p_task->State      = USBD_MSC_UAS_TASK_STATE_STATUS;
 }
+#endif
 
 
 /*
-**********************************************************************************************************
-*                                             USBD_MSC_RxCBW()
+*********************************************************************************************************
+*                                        USBD_MSC_UAS_RdyTx()
 *
-* Description : Receive CBW from the host.
+* Description : Send a READ READY or WRITE READY IU on the status pipe.
 *
-* Argument(s) : class_nbr   MSC instance number.
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
 *
-*               p_err       Pointer to variable that will receive the return error code from this function :
-*                               USBD_ERR_NONE                   CBW successfully received from host
-
-*                                                               ------ RETURNED BY USBD_BulkRx() : ------
-*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
-*                               USBD_ERR_EP_INVALID_NBR         Invalid endpoint number.
-*                               USBD_ERR_DEV_INVALID_STATE      Bulk transfer can ONLY be used after the
-*                                                                   device is in configured state.
-*                               USBD_ERR_EP_INVALID_TYPE        Invalid endpoint type.
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_task      Pointer to UAS task.
+*
+*               iu_id       IU identifier :
+*
+*                               USBD_MSC_UAS_IU_ID_RD_RDY   READ  READY IU.
+*                               USBD_MSC_UAS_IU_ID_WR_RDY   WRITE READY IU.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
-**********************************************************************************************************
+* Note(s)     : (1) If the IU cannot be sent, the data stage of the task fails.
+*********************************************************************************************************
 */
 
-static  void  USBD_MSC_RxCBW (USBD_MSC_CTRL  *p_ctrl,
-                              USBD_MSC_COMM  *p_comm,
-                              USBD_ERR       *p_err)
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_RdyTx (USBD_MSC_CTRL      *p_ctrl,
+                                  USBD_MSC_COMM      *p_comm,
+                                  USBD_MSC_UAS_TASK  *p_task,
+                                  CPU_INT08U          iu_id)
 {
-    USBD_ERR    err;
-    USBD_ERR    stall_err;
-    CPU_INT32U  xfer_len;
+    CPU_INT08U  *p_iu;
+    USBD_ERR     err;
     CPU_SR_ALLOC();
 
 
-    xfer_len = USBD_BulkRx (p_ctrl->DevNbr,                     /*Rx CBW and returns xfer_len upon success.             */
-                            p_comm->DataBulkOutEpAddr,
-                            p_ctrl->CBW_BufPtr,
-                            USBD_MSC_LEN_CBW,
-                            0,
-                            p_err);
-
-    USBD_DBG_MSC_ARG("MSC: RxCBW", xfer_len);
-
-    switch (*p_err) {
-        case USBD_ERR_NONE:
-             break;
-
-        case USBD_ERR_DEV_INVALID_NBR:
-        case USBD_ERR_DEV_INVALID_STATE:
-        case USBD_ERR_OS_ABORT:
-        case USBD_ERR_EP_INVALID_ADDR:
-        case USBD_ERR_EP_INVALID_STATE:
-        case USBD_ERR_EP_INVALID_TYPE:
-             CPU_CRITICAL_ENTER();
-             if (p_ctrl->State == USBD_MSC_STATE_CFG){
-                p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
-             }
-             CPU_CRITICAL_EXIT();
-             USBD_DBG_MSC_MSG("MSC: RxCBW, OS Abort");
-             break;
-
-        case USBD_ERR_OS_TIMEOUT:
-             CPU_CRITICAL_ENTER();
-             if (p_ctrl->State == USBD_MSC_STATE_CFG){
-                p_comm->NextCommState = USBD_MSC_COMM_STATE_CBW;
-             }
-             CPU_CRITICAL_EXIT();
-             USBD_DBG_MSC_MSG("MSC: RxCBW, OS Timeout");
-             break;
-
-        case USBD_ERR_EP_ABORT:
-        case USBD_ERR_RX:
-        case USBD_ERR_DRV_BUF_OVERFLOW:
-            CPU_CRITICAL_ENTER();
-            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_IN_STALL;
-            CPU_CRITICAL_EXIT();
-            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall IN/OUT");
-            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
-            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
-            break;
+    p_iu    = p_ctrl->UAS_StatusBufPtr;
+    p_iu[0] = iu_id;
+    p_iu[1] = 0u;
+    MEM_VAL_SET_INT16U_BIG(&p_iu[2], p_task->Tag);
 
-        case USBD_ERR_OS_FAIL:
-        case USBD_ERR_NULL_PTR:
-        case USBD_ERR_EP_IO_PENDING:
-        case USBD_ERR_EP_QUEUING:
-        case USBD_ERR_DRV_INVALID_PKT:
-        default:
-            CPU_CRITICAL_ENTER();
-            p_comm->NextCommState = USBD_MSC_COMM_STATE_BULK_OUT_STALL;
-            CPU_CRITICAL_EXIT();
-            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall OUT");
-            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
-            break;
+    (void)USBD_BulkTx(        p_ctrl->DevNbr,
+                              p_comm->UAS_StatusEpAddr,
+                      (void *)p_iu,
+                              USBD_MSC_UAS_IU_LEN_RDY,
+                              0u,
+                              DEF_NO,
+                             &err);
+    if (err != USBD_ERR_NONE) {                                 /* See Note #1.                                         */
+        CPU_CRITICAL_ENTER();
+        if (p_task->Err == USBD_ERR_NONE) {
+            p_task->Err = err;
+        }
+        CPU_CRITICAL_EXIT();
     }
+}
+#endif
 
-    if (*p_err == USBD_ERR_NONE) {
-                                                                /* Verify that CBW is valid and meaningful.             */
-        USBD_MSC_CBW_Verify(p_ctrl, p_comm, p_ctrl->CBW_BufPtr, xfer_len, &err);
-        if (err != USBD_ERR_NONE) {                             /* Enter reset recovery state.                          */
-            CPU_CRITICAL_ENTER();
-            p_comm->NextCommState = USBD_MSC_COMM_STATE_RESET_RECOVERY_BULK_IN_STALL;
-            CPU_CRITICAL_EXIT();
-
-            USBD_DBG_MSC_MSG("MSC: RxCBW, Stall IN/OUT");
 
-            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkInEpAddr, DEF_SET, &stall_err);
-            USBD_EP_Stall(p_ctrl->DevNbr, p_comm->DataBulkOutEpAddr, DEF_SET, &stall_err);
-            return;
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_UAS_SenseTx()
+*
+* Description : Send the Sense IU completing a task on the status pipe.
+*
+* Argument(s) : p_ctrl      Pointer to MSC instance control structure.
+*
+*               p_comm      Pointer to MSC comm structure.
+*
+*               p_task      Pointer to UAS task.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) A failed command is completed with a CHECK CONDITION status followed by fixed format
+*                   sense data taken from the task's command context, so that the host does not need to
+*                   send a REQUEST SENSE command (see 'usbd_scsi.h  SCSI COMMAND CONTEXT  Note #1b').
+*                   A command that failed without sense data, e.g. on a USB transfer error, is reported as
+*                   aborted.
+*********************************************************************************************************
+*/
 
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_SenseTx (USBD_MSC_CTRL      *p_ctrl,
+                                    USBD_MSC_COMM      *p_comm,
+                                    USBD_MSC_UAS_TASK  *p_task)
+{
+    CPU_INT08U  *p_iu;
+    CPU_INT32U   iu_len;
+    USBD_ERR     err;
+
+
+    p_iu = p_ctrl->UAS_StatusBufPtr;
+    Mem_Clr((void     *)p_iu,
+            (CPU_SIZE_T)USBD_MSC_UAS_IU_LEN_SENSE_MAX);
+
+    p_iu[0] = USBD_MSC_UAS_IU_ID_SENSE;
+    MEM_VAL_SET_INT16U_BIG(&p_iu[2], p_task->Tag);
+
+    if (p_task->Err == USBD_ERR_NONE) {
+        p_iu[6] = USBD_MSC_UAS_STATUS_GOOD;
+        iu_len  = USBD_MSC_UAS_IU_LEN_SENSE;
+    } else {                                                    /* See Note #1.                                         */
+        p_iu[6] = USBD_MSC_UAS_STATUS_CHECK_CONDITION;
+        MEM_VAL_SET_INT16U_BIG(&p_iu[14], USBD_MSC_UAS_SENSE_DATA_LEN);
+        p_iu[16] = USBD_MSC_UAS_SENSE_RESP_CODE_CUR;
+        p_iu[18] = p_task->Cmd.SenseKey;
+        if (p_iu[18] == 0u) {
+            p_iu[18] = USBD_MSC_UAS_SENSE_KEY_ABORTED_CMD;
         }
-        CPU_CRITICAL_ENTER();
-                                                                /* Host expected transfer length.                       */
-        p_comm->CSW.dCSWDataResidue = p_comm->CBW.dCBWDataTransferLength;
-        p_comm->BytesToXfer         = 0;
-        p_comm->NextCommState       = USBD_MSC_COMM_STATE_DATA; /* Enter data transport state.                          */
-        CPU_CRITICAL_EXIT();
+        p_iu[23] = USBD_MSC_UAS_SENSE_ADDL_LEN;
+        p_iu[28] = p_task->Cmd.ASC;
+        p_iu[29] = p_task->Cmd.ASCQ;
+        iu_len   = USBD_MSC_UAS_IU_LEN_SENSE_MAX;
+    }
+
+    (void)USBD_BulkTx(        p_ctrl->DevNbr,
+                              p_comm->UAS_StatusEpAddr,
+                      (void *)p_iu,
+                              iu_len,
+                              0u,
+                              DEF_NO,
+                             &err);
+    if (err != USBD_ERR_NONE) {
+        USBD_DBG_MSC_ARG("MSC: UAS Sense Tx, Err", err);
     }
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          USBD_MSC_LunClr()
+*                                      USBD_MSC_UAS_TaskAbort()
 *
-* Description : Initialize all logical unit fields.
+* Description : Abort a task, without sending its Sense IU.
 *
-* Argument(s) : p_lun       Pointer to Logical Unit information.
+* Argument(s) : p_comm      Pointer to MSC comm structure.
+*
+*               task_ix     Index of the task to abort.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) A task with storage reads in flight keeps its buffers until they complete (see
+*                   'USBD_MSC_UAS_PipeProcess()  Note #3').
 *********************************************************************************************************
 */
 
-static  void  USBD_MSC_LunClr  (USBD_MSC_LUN_CTRL  *p_lun)
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_TaskAbort (USBD_MSC_COMM  *p_comm,
+                                      CPU_INT08U      task_ix)
 {
-    p_lun->LunNbr                    = 0;
-    p_lun->LunInfo.ProdRevisionLevel = 0;
-    p_lun->LunInfo.ReadOnly          = DEF_FALSE;
-    p_lun->NbrBlocks                 = 0;
-    p_lun->BlockSize                 = 0;
+    USBD_MSC_UAS_TASK  *p_task;
+    CPU_BOOLEAN         rd_pend;
+    CPU_SR_ALLOC();
 
-    Mem_Clr((void     *)p_lun->LunInfo.VendorId,
-            (CPU_SIZE_T)8);
-    Mem_Clr((void     *)p_lun->LunInfo.ProdId,
-            (CPU_SIZE_T)16);
 
-    p_lun->LunArgPtr = (void *)0;
-}
+    p_task = &p_comm->UAS_TaskTbl[task_ix];
+    if (p_comm->UAS_DataInTaskIx == task_ix) {
+        p_comm->UAS_DataInTaskIx = USBD_MSC_UAS_TASK_IX_NONE;
+    }
+    p_task->DataRemLen = 0u;
+
+    CPU_CRITICAL_ENTER();
+    if (p_task->RdPendCnt > 0u) {                               /* See Note #1.                                         */
+        p_task->Abort = DEF_YES;
+        rd_pend       = DEF_YES;
+    } else {
+        rd_pend       = DEF_NO;
+    }
+    CPU_CRITICAL_EXIT();
 
+    if (rd_pend == DEF_NO) {
+        USBD_MSC_UAS_TaskBufRelease(p_comm, p_task);
+        p_task->State = USBD_MSC_UAS_TASK_STATE_FREE;
+    }
+}
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                        USBD_MSC_CBW_Parse()
+*                                    USBD_MSC_UAS_TaskBufRelease()
 *
-* Description : Parse CBW into CBW structure.
+* Description : Release the data buffers held by a task.
 *
-* Argument(s) : p_cbw       Variable that will hold the CBW parsed in this function.
+* Argument(s) : p_comm      Pointer to MSC comm structure.
 *
-*               p_buf_src   Pointer to buffer that holds CBW.
+*               p_task      Pointer to UAS task.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) The task must not have storage reads in flight.
 *********************************************************************************************************
 */
 
-static  void  USBD_MSC_CBW_Parse (USBD_MSC_CBW  *p_cbw,
-                                  void          *p_buf_src)
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_MSC_UAS_TaskBufRelease (USBD_MSC_COMM      *p_comm,
+                                           USBD_MSC_UAS_TASK  *p_task)
 {
-    CPU_INT08U  *p_buf_src_08;
-
-
-    p_buf_src_08 = (CPU_INT08U *)p_buf_src;
+    CPU_INT08U  buf_ix;
+    CPU_SR_ALLOC();
 
-    p_cbw->dCBWSignature          = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  0u));
-    p_cbw->dCBWTag                = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  4u));
-    p_cbw->dCBWDataTransferLength = MEM_VAL_GET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_src_08 +  8u));
-    p_cbw->bmCBWFlags             = p_buf_src_08[12];
-    p_cbw->bCBWLUN                = p_buf_src_08[13];
-    p_cbw->bCBWCBLength           = p_buf_src_08[14];
 
-    Mem_Copy((void     *)&p_cbw->CBWCB[0],
-             (void     *)&p_buf_src_08[15],
-             (CPU_SIZE_T) 16);
+    CPU_CRITICAL_ENTER();
+    while (p_task->BufCnt > 0u) {
+        buf_ix                          = p_task->BufIxTbl[p_task->BufIxHead];
+        p_comm->DataBufStateTbl[buf_ix] = USBD_MSC_DATA_BUF_STATE_FREE;
+        p_task->BufIxHead++;
+        if (p_task->BufIxHead >= USBD_MSC_CFG_DATA_NBR_BUF) {
+            p_task->BufIxHead = 0u;
+        }
+        p_task->BufCnt--;
+    }
+    p_task->BufIxHead = 0u;
+    CPU_CRITICAL_EXIT();
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_MSC_CSW_Fmt()
+*                                      USBD_MSC_UAS_BufFreeGet()
 *
-* Description : Format CSW from CSW structure.
+* Description : Find a free data buffer.
 *
-* Argument(s) : p_csw       Variable holds the CSW information.
+* Argument(s) : p_comm      Pointer to MSC comm structure.
 *
-*               p_buf_dest  Pointer to buffer that will hold CSW.
+*               nbr_rsvd    Number of free data buffers that must be left free.
 *
-* Return(s)   : None.
+* Return(s)   : Index of a free data buffer, if more than 'nbr_rsvd' buffers are free,
+*
+*               USBD_MSC_CFG_DATA_NBR_BUF,                                     otherwise.
 *
 * Note(s)     : None.
 *********************************************************************************************************
 */
 
-static  void  USBD_MSC_CSW_Fmt (const  USBD_MSC_CSW  *p_csw,
-                                       void          *p_buf_dest)
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_INT08U  USBD_MSC_UAS_BufFreeGet (USBD_MSC_COMM  *p_comm,
+                                             CPU_INT08U      nbr_rsvd)
 {
-    CPU_INT08U  *p_buf_dest_08;
+    CPU_INT08U  buf_ix;
+    CPU_INT08U  buf_ix_free;
+    CPU_INT08U  nbr_free;
 
 
-    p_buf_dest_08 = (CPU_INT08U *)p_buf_dest;
+    buf_ix_free = USBD_MSC_CFG_DATA_NBR_BUF;
+    nbr_free    = 0u;
+    for (buf_ix = 0u; buf_ix < USBD_MSC_CFG_DATA_NBR_BUF; buf_ix++) {
+        if (p_comm->DataBufStateTbl[buf_ix] == USBD_MSC_DATA_BUF_STATE_FREE) {
+            buf_ix_free = buf_ix;
+            nbr_free++;
+        }
+    }
 
-    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 0u), p_csw->dCSWSignature);
-    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 4u), p_csw->dCSWTag);
-    MEM_VAL_SET_INT32U_LITTLE((void *)((CPU_INT08U *)p_buf_dest_08 + 8u), p_csw->dCSWDataResidue);
+    if (nbr_free <= nbr_rsvd) {
+        return (USBD_MSC_CFG_DATA_NBR_BUF);
+    }
 
-    p_buf_dest_08[12] = p_csw->bCSWStatus;
+    return (buf_ix_free);
 }
+#endif
@@ -103,26 +103,33 @@
 */
 
 
-void         USBD_MSC_Init       (       USBD_ERR    *p_err);
-
-CPU_INT08U   USBD_MSC_Add        (       USBD_ERR    *p_err);
-
-CPU_BOOLEAN  USBD_MSC_CfgAdd     (       CPU_INT08U   class_nbr,
-                                         CPU_INT08U   dev_nbr,
-                                         CPU_INT08U   cfg_nbr,
-                                         USBD_ERR    *p_err);
-
-void         USBD_MSC_LunAdd     (const  CPU_CHAR    *p_store_name,
-                                         CPU_INT08U   class_nbr,
-                                         CPU_CHAR    *p_vend_id,
-                                         CPU_CHAR    *p_prod_id,
-                                         CPU_INT32U   prod_rev_level,
-                                         CPU_BOOLEAN  rd_only,
-                                         USBD_ERR    *p_err);
+void         USBD_MSC_Init           (       USBD_ERR    *p_err);
+
+CPU_INT08U   USBD_MSC_Add            (       USBD_ERR    *p_err);
+
+CPU_BOOLEAN  USBD_MSC_CfgAdd         (       CPU_INT08U   class_nbr,
+                                             CPU_INT08U   dev_nbr,
+                                             CPU_INT08U   cfg_nbr,
+                                             USBD_ERR    *p_err);
+
+void         USBD_MSC_LunAdd         (const  CPU_CHAR    *p_store_name,
+                                             CPU_INT08U   class_nbr,
+                                             CPU_CHAR    *p_vend_id,
+                                             CPU_CHAR    *p_prod_id,
+                                             CPU_INT32U   prod_rev_level,
+                                             CPU_BOOLEAN  rd_only,
+                                             USBD_ERR    *p_err);
+
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+void         USBD_MSC_LunWrPipelineEn(       CPU_INT08U   class_nbr,
+                                             CPU_INT08U   lun_nbr,
+                                             CPU_BOOLEAN  en,
+                                             USBD_ERR    *p_err);
+#endif
 
-CPU_BOOLEAN  USBD_MSC_IsConn     (       CPU_INT08U   class_nbr);
+CPU_BOOLEAN  USBD_MSC_IsConn         (       CPU_INT08U   class_nbr);
 
-void         USBD_MSC_TaskHandler(       CPU_INT08U   class_nbr);
+void         USBD_MSC_TaskHandler    (       CPU_INT08U   class_nbr);
 
 
 /*
@@ -163,10 +170,38 @@ void         USBD_MSC_TaskHandler(       CPU_INT08U   class_nbr);
 #error  "USBD_MSC_CFG_DATA_LEN illegally #define'd in 'usbd_cfg.h' [MUST be >= 1]"
 #endif
 
+#ifndef  USBD_MSC_CFG_DATA_NBR_BUF
+#error  "USBD_MSC_CFG_DATA_NBR_BUF not #define'd in 'usbd_cfg.h' [MUST be >= 1]"
+#endif
+
+#if     (USBD_MSC_CFG_DATA_NBR_BUF < 1u)
+#error  "USBD_MSC_CFG_DATA_NBR_BUF illegally #define'd in 'usbd_cfg.h' [MUST be >= 1]"
+#endif
+
 #ifndef  USBD_MSC_CFG_MICRIUM_FS
 #error  "USBD_MSC_CFG_MICRIUM_FS not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
 #endif
 
+#ifndef  USBD_MSC_CFG_UAS_EN
+#error  "USBD_MSC_CFG_UAS_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+#if     ((USBD_MSC_CFG_UAS_EN != DEF_ENABLED) && \
+         (USBD_MSC_CFG_UAS_EN != DEF_DISABLED))
+#error  "USBD_MSC_CFG_UAS_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+#if     (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+#ifndef  USBD_MSC_CFG_UAS_QUEUE_DEPTH
+#error  "USBD_MSC_CFG_UAS_QUEUE_DEPTH not #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 255]"
+#endif
+
+#if    ((USBD_MSC_CFG_UAS_QUEUE_DEPTH < 1u) || \
+        (USBD_MSC_CFG_UAS_QUEUE_DEPTH > 255u))
+#error  "USBD_MSC_CFG_UAS_QUEUE_DEPTH illegally #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 255]"
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -0,0 +1,1028 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                       USB DEVICE MSC BLOCK CACHE
+*
+* Filename : usbd_msc_cache.c
+* Version  : V4.06.01
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    MICRIUM_SOURCE
+#define    USBD_MSC_CACHE_MODULE
+#include  "usbd_msc_cache.h"
+#include  "usbd_msc_os.h"
+#if (USBD_MSC_CFG_MICRIUM_FS == DEF_ENABLED)
+#include  "Storage/uC-FS/V4/usbd_storage.h"
+#else
+#include  "Storage/RAMDisk/usbd_storage.h"
+#endif
+
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*
+* Note(s) : (1) The staging buffer receives the blocks read ahead, and the runs of dirty blocks written
+*               back. A run of consecutive blocks longer than the number of sets would hold several
+*               blocks of the same set; the staging buffer is sized accordingly.
+*********************************************************************************************************
+*/
+
+#define  USBD_MSC_CACHE_NBR_LINES          (USBD_MSC_CFG_CACHE_NBR_SETS * USBD_MSC_CFG_CACHE_NBR_WAYS)
+
+#define  USBD_MSC_CACHE_STAGE_NBR_BLKS      USBD_MSC_CFG_CACHE_NBR_SETS /* See Note #1.                                 */
+
+#define  USBD_MSC_CACHE_LINE_FLAG_VALID     DEF_BIT_00          /* Line holds a blk.                                    */
+#define  USBD_MSC_CACHE_LINE_FLAG_DIRTY     DEF_BIT_01          /* Blk modified since rd from storage.                  */
+#define  USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD  DEF_BIT_02          /* Blk rd ahead & not yet rd by host.                   */
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_msc_cache_line {
+    USBD_STORAGE_LUN  *StorageLunPtr;                           /* Storage unit of cached blk.                          */
+    CPU_INT64U         BlkAddr;                                 /* Logical blk addr of cached blk.                      */
+    CPU_INT32U         UseCtr;                                  /* Value of use ctr at last access (for LRU).           */
+    CPU_INT08U         Flags;                                   /* Line flags.                                          */
+} USBD_MSC_CACHE_LINE;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  USBD_MSC_CACHE_LINE  USBD_MSC_CacheLineTbl[USBD_MSC_CACHE_NBR_LINES];
+static  CPU_INT08U           USBD_MSC_CacheDataTbl[USBD_MSC_CACHE_NBR_LINES][USBD_MSC_CFG_CACHE_BLK_SIZE];
+static  CPU_INT08U           USBD_MSC_CacheStageBuf[USBD_MSC_CACHE_STAGE_NBR_BLKS * USBD_MSC_CFG_CACHE_BLK_SIZE];
+static  CPU_INT32U           USBD_MSC_CacheUseCtr;
+static  USBD_MSC_CACHE_STAT  USBD_MSC_CacheStat;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL MACRO'S
+*********************************************************************************************************
+*/
+
+#define  USBD_MSC_CACHE_LINE_DATA(p_line)   (&USBD_MSC_CacheDataTbl[(p_line) - &USBD_MSC_CacheLineTbl[0]][0])
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  USBD_MSC_CACHE_LINE  *USBD_MSC_CacheLineFind  (USBD_STORAGE_LUN   *p_storage_lun,
+                                                       CPU_INT64U          blk_addr);
+
+static  USBD_MSC_CACHE_LINE  *USBD_MSC_CacheLineAlloc (USBD_STORAGE_LUN   *p_storage_lun,
+                                                       CPU_INT64U          blk_addr,
+                                                       CPU_BOOLEAN         evict_dirty,
+                                                       USBD_ERR           *p_err);
+
+static  void                  USBD_MSC_CacheLineInsert(USBD_STORAGE_LUN   *p_storage_lun,
+                                                       CPU_INT64U          blk_addr,
+                                                       CPU_INT08U         *p_data_buf,
+                                                       CPU_INT08U          flags);
+
+static  CPU_INT32U            USBD_MSC_CacheRdAheadLen(USBD_MSC_LUN_CTRL  *p_lun,
+                                                       CPU_INT64U          blk_addr,
+                                                       CPU_INT32U          nbr_blks_max);
+
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)
+static  void                  USBD_MSC_CacheRunFlush  (USBD_STORAGE_LUN   *p_storage_lun,
+                                                       CPU_INT64U          blk_addr,
+                                                       USBD_ERR           *p_err);
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         USBD_MSC_CacheInit()
+*
+* Description : Initialize the block cache.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Block cache successfully initialized.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The cache lock is created by the MSC OS layer (see USBD_MSC_OS_Init()).
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheInit (USBD_ERR  *p_err)
+{
+    Mem_Clr((void     *)&USBD_MSC_CacheLineTbl[0],
+            (CPU_SIZE_T) sizeof(USBD_MSC_CacheLineTbl));
+    Mem_Clr((void     *)&USBD_MSC_CacheStat,
+            (CPU_SIZE_T) sizeof(USBD_MSC_CacheStat));
+
+    USBD_MSC_CacheUseCtr = 0u;
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_CacheRd()
+*
+* Description : Read blocks from a logical unit, through the block cache.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               blk_addr        Logical block address of the first block to read.
+*
+*               nbr_blks        Number of blocks to read.
+*
+*               p_data_buf      Pointer to buffer that will receive the data.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       Blocks successfully read.
+*                               USBD_ERR_OS_FAIL                    Cache lock could not be acquired.
+*
+*                                                                   --- RETURNED BY USBD_StorageRd() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Reading logical unit failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Logical units whose block size differs from the cache block size are read directly.
+*
+*               (2) Cached blocks are copied from the cache. Each run of consecutive missing blocks is
+*                   read from the storage media with a single access, directly into 'p_data_buf', then
+*                   inserted in the cache.
+*
+*               (3) For a sequential stream, the blocks that follow the request are read ahead (see
+*                   'usbd_msc_cache.h  Note #2'). When the request ends with missing blocks, these are read
+*                   together with the blocks read ahead if both fit in the staging buffer. Otherwise, the
+*                   blocks are read ahead with a separate access only if the request was fully served from
+*                   the cache: a stream of large requests gains nothing from reading ahead.
+*
+*               (4) Read-ahead errors are ignored; the host gets them when it reads the blocks.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheRd (USBD_MSC_LUN_CTRL  *p_lun,
+                        CPU_INT64U          blk_addr,
+                        CPU_INT32U          nbr_blks,
+                        CPU_INT08U         *p_data_buf,
+                        USBD_ERR           *p_err)
+{
+    USBD_STORAGE_LUN     *p_storage_lun;
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_BOOLEAN           seq;
+    CPU_BOOLEAN           rd_ahead_done;
+    CPU_INT32U            blk_ix;
+    CPU_INT32U            miss_cnt;
+    CPU_INT32U            rd_ahead_cnt;
+    CPU_INT32U            ix;
+    USBD_ERR              err;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    if (p_lun->BlockSize != USBD_MSC_CFG_CACHE_BLK_SIZE) {      /* See Note #1.                                         */
+        USBD_StorageRd(p_storage_lun,
+                       blk_addr,
+                       nbr_blks,
+                       p_data_buf,
+                       p_err);
+        return;
+    }
+
+    USBD_MSC_OS_CacheLockAcquire(p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if (blk_addr == p_lun->CacheRdNextBlkAddr) {               /* Rd follows previous one (see Note #3).               */
+        seq = DEF_YES;
+    } else {
+        seq = DEF_NO;
+    }
+    rd_ahead_done = DEF_NO;
+    blk_ix        = 0u;
+
+    while (blk_ix < nbr_blks) {
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr + blk_ix);
+        if (p_line != (USBD_MSC_CACHE_LINE *)0) {               /* ------------------- CACHE HIT ---------------------- */
+            Mem_Copy((void     *)&p_data_buf[blk_ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                     (void     *) USBD_MSC_CACHE_LINE_DATA(p_line),
+                     (CPU_SIZE_T) USBD_MSC_CFG_CACHE_BLK_SIZE);
+
+            USBD_MSC_CacheUseCtr++;
+            p_line->UseCtr = USBD_MSC_CacheUseCtr;
+            USBD_MSC_CacheStat.RdHitCnt++;
+            if (DEF_BIT_IS_SET(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD) == DEF_YES) {
+                DEF_BIT_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD);
+                USBD_MSC_CacheStat.RdAheadHitCnt++;
+            }
+            blk_ix++;
+            continue;
+        }
+                                                                /* ------------------- CACHE MISS --------------------- */
+        miss_cnt = 1u;                                          /* Find run of missing blks (see Note #2).              */
+        while ((blk_ix + miss_cnt < nbr_blks) &&
+               (USBD_MSC_CacheLineFind(p_storage_lun, blk_addr + blk_ix + miss_cnt) == (USBD_MSC_CACHE_LINE *)0)) {
+            miss_cnt++;
+        }
+
+        rd_ahead_cnt = 0u;
+        if ((seq                 == DEF_YES ) &&                /* Rd trailing missing blks with rd-ahead blks ...      */
+            (blk_ix + miss_cnt   == nbr_blks) &&                /* ... if they fit in staging buf (see Note #3).        */
+            (miss_cnt            <  USBD_MSC_CACHE_STAGE_NBR_BLKS)) {
+            rd_ahead_cnt = USBD_MSC_CacheRdAheadLen(p_lun,
+                                                    blk_addr + nbr_blks,
+                                                    USBD_MSC_CACHE_STAGE_NBR_BLKS - miss_cnt);
+        }
+
+        err = USBD_ERR_NONE;
+        if (rd_ahead_cnt > 0u) {
+            rd_ahead_done = DEF_YES;
+            USBD_StorageRd(p_storage_lun,
+                           blk_addr + blk_ix,
+                           miss_cnt + rd_ahead_cnt,
+                           USBD_MSC_CacheStageBuf,
+                          &err);
+            USBD_MSC_CacheStat.StorageRdCnt++;
+            if (err == USBD_ERR_NONE) {
+                Mem_Copy((void     *)&p_data_buf[blk_ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                         (void     *)&USBD_MSC_CacheStageBuf[0],
+                         (CPU_SIZE_T)(miss_cnt * USBD_MSC_CFG_CACHE_BLK_SIZE));
+
+                for (ix = 0u; ix < rd_ahead_cnt; ix++) {
+                    USBD_MSC_CacheLineInsert(p_storage_lun,
+                                             blk_addr + nbr_blks + ix,
+                                            &USBD_MSC_CacheStageBuf[(miss_cnt + ix) * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                                             USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD);
+                }
+                USBD_MSC_CacheStat.RdAheadCnt += rd_ahead_cnt;
+            }
+        }
+
+        if ((rd_ahead_cnt == 0u) ||                             /* Rd missing blks alone, or again if rd-ahead failed.  */
+            (err          != USBD_ERR_NONE)) {
+            USBD_StorageRd(p_storage_lun,
+                           blk_addr + blk_ix,
+                           miss_cnt,
+                          &p_data_buf[blk_ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                           p_err);
+            USBD_MSC_CacheStat.StorageRdCnt++;
+            if (*p_err != USBD_ERR_NONE) {
+                USBD_MSC_OS_CacheLockRelease(&err);
+                return;
+            }
+        }
+
+        for (ix = 0u; ix < miss_cnt; ix++) {
+            USBD_MSC_CacheLineInsert(p_storage_lun,
+                                     blk_addr + blk_ix + ix,
+                                    &p_data_buf[(blk_ix + ix) * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                                     0u);
+        }
+        USBD_MSC_CacheStat.RdMissCnt += miss_cnt;
+        blk_ix                       += miss_cnt;
+
+        if (blk_ix == nbr_blks) {                               /* Request did not end with cached blks.                */
+            rd_ahead_done = DEF_YES;
+        }
+    }
+
+    p_lun->CacheRdNextBlkAddr = blk_addr + nbr_blks;
+
+    if ((seq           == DEF_YES) &&                           /* Rd ahead with separate access (see Note #3).         */
+        (rd_ahead_done == DEF_NO )) {
+        rd_ahead_cnt = USBD_MSC_CacheRdAheadLen(p_lun,
+                                                blk_addr + nbr_blks,
+                                                USBD_MSC_CACHE_STAGE_NBR_BLKS);
+        if (rd_ahead_cnt > 0u) {
+            USBD_StorageRd(p_storage_lun,
+                           blk_addr + nbr_blks,
+                           rd_ahead_cnt,
+                           USBD_MSC_CacheStageBuf,
+                          &err);
+            USBD_MSC_CacheStat.StorageRdCnt++;
+            if (err == USBD_ERR_NONE) {                         /* See Note #4.                                         */
+                for (ix = 0u; ix < rd_ahead_cnt; ix++) {
+                    USBD_MSC_CacheLineInsert(p_storage_lun,
+                                             blk_addr + nbr_blks + ix,
+                                            &USBD_MSC_CacheStageBuf[ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                                             USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD);
+                }
+                USBD_MSC_CacheStat.RdAheadCnt += rd_ahead_cnt;
+            }
+        }
+    }
+
+    USBD_MSC_OS_CacheLockRelease(&err);
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_MSC_CacheWr()
+*
+* Description : Write blocks to a logical unit, through the block cache.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               blk_addr        Logical block address of the first block to write.
+*
+*               nbr_blks        Number of blocks to write.
+*
+*               p_data_buf      Pointer to buffer that contains the data.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       Blocks successfully written.
+*                               USBD_ERR_OS_FAIL                    Cache lock could not be acquired.
+*
+*                                                                   --- RETURNED BY USBD_StorageWr() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Writing logical unit failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Logical units whose block size differs from the cache block size are written directly.
+*
+*               (2) With write-back, the blocks are only stored in the cache. Evicting a dirty block to
+*                   make room writes back the run of dirty blocks it belongs to; a failure to do so is
+*                   returned and the remaining blocks are not written.
+*
+*               (3) With write-through, the blocks are written to the storage media, then the cached
+*                   copies are updated. On failure, the cached copies are invalidated since the content
+*                   of the media is unknown.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheWr (USBD_MSC_LUN_CTRL  *p_lun,
+                        CPU_INT64U          blk_addr,
+                        CPU_INT32U          nbr_blks,
+                        CPU_INT08U         *p_data_buf,
+                        USBD_ERR           *p_err)
+{
+    USBD_STORAGE_LUN     *p_storage_lun;
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT32U            blk_ix;
+    USBD_ERR              err;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    if (p_lun->BlockSize != USBD_MSC_CFG_CACHE_BLK_SIZE) {      /* See Note #1.                                         */
+        USBD_StorageWr(p_storage_lun,
+                       blk_addr,
+                       nbr_blks,
+                       p_data_buf,
+                       p_err);
+        return;
+    }
+
+    USBD_MSC_OS_CacheLockAcquire(p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    USBD_MSC_CacheStat.WrCnt += nbr_blks;
+
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)              /* See Note #2.                                         */
+    for (blk_ix = 0u; blk_ix < nbr_blks; blk_ix++) {
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr + blk_ix);
+        if (p_line == (USBD_MSC_CACHE_LINE *)0) {
+            p_line = USBD_MSC_CacheLineAlloc(p_storage_lun,
+                                             blk_addr + blk_ix,
+                                             DEF_YES,
+                                             p_err);
+            if (*p_err != USBD_ERR_NONE) {
+                USBD_MSC_OS_CacheLockRelease(&err);
+                return;
+            }
+            p_line->StorageLunPtr = p_storage_lun;
+            p_line->BlkAddr       = blk_addr + blk_ix;
+        }
+
+        Mem_Copy((void     *) USBD_MSC_CACHE_LINE_DATA(p_line),
+                 (void     *)&p_data_buf[blk_ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                 (CPU_SIZE_T) USBD_MSC_CFG_CACHE_BLK_SIZE);
+
+        USBD_MSC_CacheUseCtr++;
+        p_line->UseCtr = USBD_MSC_CacheUseCtr;
+        p_line->Flags  = (USBD_MSC_CACHE_LINE_FLAG_VALID | USBD_MSC_CACHE_LINE_FLAG_DIRTY);
+    }
+#else                                                           /* See Note #3.                                         */
+    USBD_StorageWr(p_storage_lun,
+                   blk_addr,
+                   nbr_blks,
+                   p_data_buf,
+                   p_err);
+    USBD_MSC_CacheStat.StorageWrCnt++;
+
+    for (blk_ix = 0u; blk_ix < nbr_blks; blk_ix++) {
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr + blk_ix);
+        if (p_line == (USBD_MSC_CACHE_LINE *)0) {
+            continue;
+        }
+        if (*p_err != USBD_ERR_NONE) {
+            p_line->Flags = 0u;
+            continue;
+        }
+
+        Mem_Copy((void     *) USBD_MSC_CACHE_LINE_DATA(p_line),
+                 (void     *)&p_data_buf[blk_ix * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                 (CPU_SIZE_T) USBD_MSC_CFG_CACHE_BLK_SIZE);
+
+        USBD_MSC_CacheUseCtr++;
+        p_line->UseCtr = USBD_MSC_CacheUseCtr;
+        DEF_BIT_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_RD_AHEAD);
+    }
+
+    if (*p_err != USBD_ERR_NONE) {
+        USBD_MSC_OS_CacheLockRelease(&err);
+        return;
+    }
+#endif
+
+    USBD_MSC_OS_CacheLockRelease(&err);
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_MSC_CacheFlush()
+*
+* Description : Write back the dirty blocks of a logical unit.
+*
+* Argument(s) : p_lun       Pointer to Logical Unit information.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       All dirty blocks written back.
+*                               USBD_ERR_OS_FAIL                    Cache lock could not be acquired.
+*
+*                                                                   --- RETURNED BY USBD_StorageWr() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Writing logical unit failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Every run of dirty blocks is attempted; the error of the last failed run is returned
+*                   and its blocks are kept dirty.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheFlush (USBD_MSC_LUN_CTRL  *p_lun,
+                           USBD_ERR           *p_err)
+{
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)
+    USBD_STORAGE_LUN     *p_storage_lun;
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT32U            line_ix;
+    USBD_ERR              err;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    USBD_MSC_OS_CacheLockAcquire(p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    for (line_ix = 0u; line_ix < USBD_MSC_CACHE_NBR_LINES; line_ix++) {
+        p_line = &USBD_MSC_CacheLineTbl[line_ix];
+        if ((p_line->StorageLunPtr == p_storage_lun) &&
+            (DEF_BIT_IS_SET(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_VALID) == DEF_YES) &&
+            (DEF_BIT_IS_SET(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY) == DEF_YES)) {
+            USBD_MSC_CacheRunFlush(p_storage_lun,
+                                   p_line->BlkAddr,
+                                  &err);
+            if (err != USBD_ERR_NONE) {                         /* See Note #1.                                         */
+               *p_err = err;
+            }
+        }
+    }
+
+    USBD_MSC_OS_CacheLockRelease(&err);
+#else
+    (void)p_lun;
+
+   *p_err = USBD_ERR_NONE;
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_CacheInvalidate()
+*
+* Description : Discard all the cached blocks of a logical unit.
+*
+* Argument(s) : p_lun       Pointer to Logical Unit information.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Dirty blocks are discarded too. USBD_MSC_CacheFlush() must be called first to keep them.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheInvalidate (USBD_MSC_LUN_CTRL  *p_lun)
+{
+    USBD_STORAGE_LUN     *p_storage_lun;
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT32U            line_ix;
+    USBD_ERR              err;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    USBD_MSC_OS_CacheLockAcquire(&err);
+
+    for (line_ix = 0u; line_ix < USBD_MSC_CACHE_NBR_LINES; line_ix++) {
+        p_line = &USBD_MSC_CacheLineTbl[line_ix];
+        if (p_line->StorageLunPtr == p_storage_lun) {
+            p_line->StorageLunPtr = (USBD_STORAGE_LUN *)0;
+            p_line->Flags         = 0u;
+        }
+    }
+    p_lun->CacheRdNextBlkAddr = 0u;
+
+    if (err == USBD_ERR_NONE) {
+        USBD_MSC_OS_CacheLockRelease(&err);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_CacheDiscard()
+*
+* Description : Discard the cached blocks of a range of a logical unit.
+*
+* Argument(s) : p_lun       Pointer to Logical Unit information.
+*
+*               blk_addr    Logical block address of first block of the range.
+*
+*               nbr_blks    Number of blocks of the range.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) Called before the range is unmapped from the storage media. Dirty blocks of the range
+*                   are discarded without being written back, since their content is deallocated.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheDiscard (USBD_MSC_LUN_CTRL  *p_lun,
+                             CPU_INT64U          blk_addr,
+                             CPU_INT32U          nbr_blks)
+{
+    USBD_STORAGE_LUN     *p_storage_lun;
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT32U            line_ix;
+    USBD_ERR              err;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    USBD_MSC_OS_CacheLockAcquire(&err);
+
+    for (line_ix = 0u; line_ix < USBD_MSC_CACHE_NBR_LINES; line_ix++) {
+        p_line = &USBD_MSC_CacheLineTbl[line_ix];
+        if ((p_line->StorageLunPtr == p_storage_lun) &&
+            (p_line->BlkAddr       >= blk_addr)      &&
+            (p_line->BlkAddr       <  blk_addr + nbr_blks)) {
+            p_line->StorageLunPtr = (USBD_STORAGE_LUN *)0;
+            p_line->Flags         = 0u;
+        }
+    }
+
+    if (err == USBD_ERR_NONE) {
+        USBD_MSC_OS_CacheLockRelease(&err);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_CacheStatGet()
+*
+* Description : Get the block cache statistics.
+*
+* Argument(s) : p_stat      Pointer to structure that will receive the statistics.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheStatGet (USBD_MSC_CACHE_STAT  *p_stat)
+{
+    USBD_ERR  err;
+
+
+    USBD_MSC_OS_CacheLockAcquire(&err);
+
+    Mem_Copy((void     *) p_stat,
+             (void     *)&USBD_MSC_CacheStat,
+             (CPU_SIZE_T) sizeof(USBD_MSC_CACHE_STAT));
+
+    if (err == USBD_ERR_NONE) {
+        USBD_MSC_OS_CacheLockRelease(&err);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_MSC_CacheStatClr()
+*
+* Description : Clear the block cache statistics.
+*
+* Argument(s) : None.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheStatClr (void)
+{
+    USBD_ERR  err;
+
+
+    USBD_MSC_OS_CacheLockAcquire(&err);
+
+    Mem_Clr((void     *)&USBD_MSC_CacheStat,
+            (CPU_SIZE_T) sizeof(USBD_MSC_CACHE_STAT));
+
+    if (err == USBD_ERR_NONE) {
+        USBD_MSC_OS_CacheLockRelease(&err);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_CacheLineFind()
+*
+* Description : Find the cache line holding a block.
+*
+* Argument(s) : p_storage_lun   Pointer to storage unit.
+*
+*               blk_addr        Logical block address.
+*
+* Return(s)   : Pointer to cache line, if block is cached.
+*
+*               Null pointer,          otherwise.
+*
+* Note(s)     : (1) The storage unit number offsets the set index so that the first blocks of all the units,
+*                   which are the most used by file systems, do not compete for the same set.
+*********************************************************************************************************
+*/
+
+static  USBD_MSC_CACHE_LINE  *USBD_MSC_CacheLineFind (USBD_STORAGE_LUN  *p_storage_lun,
+                                                      CPU_INT64U         blk_addr)
+{
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT32U            set_ix;
+    CPU_INT08U            way_ix;
+
+                                                                /* See Note #1.                                         */
+    set_ix = (CPU_INT32U)((blk_addr + p_storage_lun->LunNbr) % USBD_MSC_CFG_CACHE_NBR_SETS);
+    p_line = &USBD_MSC_CacheLineTbl[set_ix * USBD_MSC_CFG_CACHE_NBR_WAYS];
+
+    for (way_ix = 0u; way_ix < USBD_MSC_CFG_CACHE_NBR_WAYS; way_ix++) {
+        if ((p_line->StorageLunPtr == p_storage_lun) &&
+            (p_line->BlkAddr       == blk_addr     ) &&
+            (DEF_BIT_IS_SET(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_VALID) == DEF_YES)) {
+            return (p_line);
+        }
+        p_line++;
+    }
+
+    return ((USBD_MSC_CACHE_LINE *)0);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_CacheLineAlloc()
+*
+* Description : Get a cache line for a block not in the cache.
+*
+* Argument(s) : p_storage_lun   Pointer to storage unit.
+*
+*               blk_addr        Logical block address.
+*
+*               evict_dirty     Flag indicating if a dirty line may be evicted (see Note #2) :
+*
+*                                   DEF_YES     Dirty lines may be written back and evicted.
+*                                   DEF_NO      Only clean lines may be evicted.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Line allocated, or no clean line available.
+*
+*                                               --- RETURNED BY USBD_MSC_CacheRunFlush() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Writing back victim failed.
+*
+* Return(s)   : Pointer to cache line, if one could be allocated. Line flags are cleared.
+*
+*               Null pointer,          otherwise.
+*
+* Note(s)     : (1) A free line is taken first; otherwise the least recently used line of the set is evicted.
+*
+*               (2) Blocks read from the storage media only evict clean lines: writing back a run of dirty
+*                   blocks would overwrite the staging buffer, which may hold the blocks being inserted.
+*********************************************************************************************************
+*/
+
+static  USBD_MSC_CACHE_LINE  *USBD_MSC_CacheLineAlloc (USBD_STORAGE_LUN  *p_storage_lun,
+                                                       CPU_INT64U         blk_addr,
+                                                       CPU_BOOLEAN        evict_dirty,
+                                                       USBD_ERR          *p_err)
+{
+    USBD_MSC_CACHE_LINE  *p_line;
+    USBD_MSC_CACHE_LINE  *p_line_victim;
+    CPU_INT32U            set_ix;
+    CPU_INT08U            way_ix;
+
+
+   *p_err         = USBD_ERR_NONE;
+    set_ix        = (CPU_INT32U)((blk_addr + p_storage_lun->LunNbr) % USBD_MSC_CFG_CACHE_NBR_SETS);
+    p_line        = &USBD_MSC_CacheLineTbl[set_ix * USBD_MSC_CFG_CACHE_NBR_WAYS];
+    p_line_victim = (USBD_MSC_CACHE_LINE *)0;
+
+    for (way_ix = 0u; way_ix < USBD_MSC_CFG_CACHE_NBR_WAYS; way_ix++) {
+        if (DEF_BIT_IS_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_VALID) == DEF_YES) {
+            p_line->Flags = 0u;                                 /* See Note #1.                                         */
+            return (p_line);
+        }
+        if ((evict_dirty == DEF_YES) ||
+            (DEF_BIT_IS_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY) == DEF_YES)) {
+            if ((p_line_victim  == (USBD_MSC_CACHE_LINE *)0) ||
+                (p_line->UseCtr <  p_line_victim->UseCtr)) {
+                p_line_victim = p_line;
+            }
+        }
+        p_line++;
+    }
+
+    if (p_line_victim == (USBD_MSC_CACHE_LINE *)0) {
+        return ((USBD_MSC_CACHE_LINE *)0);
+    }
+
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)
+    if (DEF_BIT_IS_SET(p_line_victim->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY) == DEF_YES) {
+        USBD_MSC_CacheRunFlush(p_line_victim->StorageLunPtr,
+                               p_line_victim->BlkAddr,
+                               p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return ((USBD_MSC_CACHE_LINE *)0);
+        }
+    }
+#endif
+
+    p_line_victim->Flags = 0u;
+
+    return (p_line_victim);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_CacheLineInsert()
+*
+* Description : Insert a block read from the storage media in the cache.
+*
+* Argument(s) : p_storage_lun   Pointer to storage unit.
+*
+*               blk_addr        Logical block address.
+*
+*               p_data_buf      Pointer to block data.
+*
+*               flags           Line flags to set in addition to valid.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) A block already cached is left untouched: its copy is the same or, if dirty, newer.
+*
+*               (2) The block is not inserted if its set only holds dirty lines.
+*********************************************************************************************************
+*/
+
+static  void  USBD_MSC_CacheLineInsert (USBD_STORAGE_LUN  *p_storage_lun,
+                                        CPU_INT64U         blk_addr,
+                                        CPU_INT08U        *p_data_buf,
+                                        CPU_INT08U         flags)
+{
+    USBD_MSC_CACHE_LINE  *p_line;
+    USBD_ERR              err;
+
+
+    p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr);
+    if (p_line != (USBD_MSC_CACHE_LINE *)0) {                   /* See Note #1.                                         */
+        return;
+    }
+
+    p_line = USBD_MSC_CacheLineAlloc(p_storage_lun,
+                                     blk_addr,
+                                     DEF_NO,
+                                    &err);
+    if (p_line == (USBD_MSC_CACHE_LINE *)0) {                   /* See Note #2.                                         */
+        return;
+    }
+
+    Mem_Copy((void     *)USBD_MSC_CACHE_LINE_DATA(p_line),
+             (void     *)p_data_buf,
+             (CPU_SIZE_T)USBD_MSC_CFG_CACHE_BLK_SIZE);
+
+    USBD_MSC_CacheUseCtr++;
+    p_line->StorageLunPtr = p_storage_lun;
+    p_line->BlkAddr       = blk_addr;
+    p_line->UseCtr        = USBD_MSC_CacheUseCtr;
+    p_line->Flags         = (USBD_MSC_CACHE_LINE_FLAG_VALID | flags);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_MSC_CacheRdAheadLen()
+*
+* Description : Get the number of blocks to read ahead.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               blk_addr        Logical block address of the first block to read ahead.
+*
+*               nbr_blks_max    Maximum number of blocks.
+*
+* Return(s)   : Number of consecutive blocks not in the cache, from 'blk_addr' and up to the read-ahead
+*               length, 'nbr_blks_max' or the end of the logical unit.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_MSC_CacheRdAheadLen (USBD_MSC_LUN_CTRL  *p_lun,
+                                              CPU_INT64U          blk_addr,
+                                              CPU_INT32U          nbr_blks_max)
+{
+    CPU_INT32U  nbr_blks;
+
+
+    if (nbr_blks_max > USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS) {
+        nbr_blks_max = USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS;
+    }
+
+    nbr_blks = 0u;
+    while ((nbr_blks            <  nbr_blks_max    ) &&
+           (blk_addr + nbr_blks <  p_lun->NbrBlocks) &&
+           (USBD_MSC_CacheLineFind(&p_lun->StorageLun, blk_addr + nbr_blks) == (USBD_MSC_CACHE_LINE *)0)) {
+        nbr_blks++;
+    }
+
+    return (nbr_blks);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_MSC_CacheRunFlush()
+*
+* Description : Write back the run of consecutive dirty blocks that contains a block.
+*
+* Argument(s) : p_storage_lun   Pointer to storage unit.
+*
+*               blk_addr        Logical block address of a dirty block.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       Run successfully written back.
+*
+*                                                                   --- RETURNED BY USBD_StorageWr() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Writing logical unit failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The run is limited to the size of the staging buffer, and always includes 'blk_addr'.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)
+static  void  USBD_MSC_CacheRunFlush (USBD_STORAGE_LUN  *p_storage_lun,
+                                      CPU_INT64U         blk_addr,
+                                      USBD_ERR          *p_err)
+{
+    USBD_MSC_CACHE_LINE  *p_line;
+    CPU_INT64U            blk_addr_start;
+    CPU_INT32U            nbr_blks;
+    CPU_INT32U            ix;
+
+
+    blk_addr_start = blk_addr;                                  /* Find start of run (see Note #1).                     */
+    while ((blk_addr_start           >  0u) &&
+           (blk_addr - blk_addr_start < (USBD_MSC_CACHE_STAGE_NBR_BLKS - 1u))) {
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr_start - 1u);
+        if ((p_line == (USBD_MSC_CACHE_LINE *)0) ||
+            (DEF_BIT_IS_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY) == DEF_YES)) {
+            break;
+        }
+        blk_addr_start--;
+    }
+
+    nbr_blks = 0u;                                              /* Gather run in staging buf.                           */
+    while (nbr_blks < USBD_MSC_CACHE_STAGE_NBR_BLKS) {
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr_start + nbr_blks);
+        if ((p_line == (USBD_MSC_CACHE_LINE *)0) ||
+            (DEF_BIT_IS_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY) == DEF_YES)) {
+            break;
+        }
+        Mem_Copy((void     *)&USBD_MSC_CacheStageBuf[nbr_blks * USBD_MSC_CFG_CACHE_BLK_SIZE],
+                 (void     *) USBD_MSC_CACHE_LINE_DATA(p_line),
+                 (CPU_SIZE_T) USBD_MSC_CFG_CACHE_BLK_SIZE);
+        nbr_blks++;
+    }
+
+    USBD_StorageWr(p_storage_lun,
+                   blk_addr_start,
+                   nbr_blks,
+                   USBD_MSC_CacheStageBuf,
+                   p_err);
+    USBD_MSC_CacheStat.StorageWrCnt++;
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    for (ix = 0u; ix < nbr_blks; ix++) {                        /* Mark run clean.                                      */
+        p_line = USBD_MSC_CacheLineFind(p_storage_lun, blk_addr_start + ix);
+        DEF_BIT_CLR(p_line->Flags, USBD_MSC_CACHE_LINE_FLAG_DIRTY);
+    }
+    USBD_MSC_CacheStat.WrBackCnt += nbr_blks;
+}
+#endif
+#endif
@@ -0,0 +1,177 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                       USB DEVICE MSC BLOCK CACHE
+*
+* Filename : usbd_msc_cache.h
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) The block cache sits between the SCSI layer and the storage driver. It is a set-
+*                associative cache of single blocks, keyed by storage unit and logical block address,
+*                and shared by all the logical units of all the MSC class instances. Consecutive blocks
+*                of a unit fall in consecutive sets; within a set, the least recently used block is
+*                evicted.
+*
+*            (2) A read that directly follows the previous read of the same logical unit is part of a
+*                sequential stream. When the block that follows such a read is not in the cache, the
+*                next USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS blocks are read ahead with a single storage
+*                access.
+*
+*            (3) With write-back, dirty blocks are written to the storage media when evicted or when
+*                the cache is flushed. Runs of consecutive dirty blocks are written with a single
+*                storage access.
+*
+*            (4) Cache accesses are serialized with a lock provided by the MSC OS layer; the storage
+*                accesses done on a miss, a read-ahead or a write-back are made with the lock held.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                               MODULE
+*********************************************************************************************************
+*/
+
+#ifndef  USBD_MSC_CACHE_MODULE_PRESENT
+#define  USBD_MSC_CACHE_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  "../../Source/usbd_core.h"
+#include  "usbd_scsi.h"
+
+
+/*
+*********************************************************************************************************
+*                                        CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+#ifndef  USBD_MSC_CFG_CACHE_EN
+#error  "USBD_MSC_CFG_CACHE_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#elif  ((USBD_MSC_CFG_CACHE_EN != DEF_ENABLED) && \
+        (USBD_MSC_CFG_CACHE_EN != DEF_DISABLED))
+#error  "USBD_MSC_CFG_CACHE_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+
+#ifndef  USBD_MSC_CFG_CACHE_BLK_SIZE
+#error  "USBD_MSC_CFG_CACHE_BLK_SIZE not #define'd in 'usbd_cfg.h' [MUST be >= 1]"
+#elif   (USBD_MSC_CFG_CACHE_BLK_SIZE < 1u)
+#error  "USBD_MSC_CFG_CACHE_BLK_SIZE illegally #define'd in 'usbd_cfg.h' [MUST be >= 1]"
+#endif
+
+#ifndef  USBD_MSC_CFG_CACHE_NBR_SETS
+#error  "USBD_MSC_CFG_CACHE_NBR_SETS not #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 65535]"
+#elif  ((USBD_MSC_CFG_CACHE_NBR_SETS < 1u) || \
+        (USBD_MSC_CFG_CACHE_NBR_SETS > 65535u))
+#error  "USBD_MSC_CFG_CACHE_NBR_SETS illegally #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 65535]"
+#endif
+
+#ifndef  USBD_MSC_CFG_CACHE_NBR_WAYS
+#error  "USBD_MSC_CFG_CACHE_NBR_WAYS not #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 255]"
+#elif  ((USBD_MSC_CFG_CACHE_NBR_WAYS < 1u) || \
+        (USBD_MSC_CFG_CACHE_NBR_WAYS > 255u))
+#error  "USBD_MSC_CFG_CACHE_NBR_WAYS illegally #define'd in 'usbd_cfg.h' [MUST be >= 1 && <= 255]"
+#endif
+
+#ifndef  USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS
+#error  "USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS not #define'd in 'usbd_cfg.h' [MUST be <= USBD_MSC_CFG_CACHE_NBR_SETS]"
+#elif   (USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS > USBD_MSC_CFG_CACHE_NBR_SETS)
+#error  "USBD_MSC_CFG_CACHE_RD_AHEAD_NBR_BLKS illegally #define'd in 'usbd_cfg.h' [MUST be <= USBD_MSC_CFG_CACHE_NBR_SETS]"
+#endif
+
+#ifndef  USBD_MSC_CFG_CACHE_WR_BACK_EN
+#error  "USBD_MSC_CFG_CACHE_WR_BACK_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#elif  ((USBD_MSC_CFG_CACHE_WR_BACK_EN != DEF_ENABLED) && \
+        (USBD_MSC_CFG_CACHE_WR_BACK_EN != DEF_DISABLED))
+#error  "USBD_MSC_CFG_CACHE_WR_BACK_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             DATA TYPES
+*
+* Note(s) : (1) Counters are in blocks. A block counted in 'RdAheadCnt' is also counted in 'RdAheadHitCnt'
+*               when the host reads it from the cache, and in 'RdHitCnt'.
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_msc_cache_stat {                          /* ------------ CACHE STATS (see Note #1) ------------- */
+    CPU_INT32U  RdHitCnt;                                       /* Blks rd from cache.                                  */
+    CPU_INT32U  RdMissCnt;                                      /* Blks rd from storage on demand.                      */
+    CPU_INT32U  RdAheadCnt;                                     /* Blks rd ahead from storage.                          */
+    CPU_INT32U  RdAheadHitCnt;                                  /* Blks rd ahead later rd by host.                      */
+    CPU_INT32U  WrCnt;                                          /* Blks wr by host.                                     */
+    CPU_INT32U  WrBackCnt;                                      /* Dirty blks wr to storage.                            */
+    CPU_INT32U  StorageRdCnt;                                   /* Storage rd accesses.                                 */
+    CPU_INT32U  StorageWrCnt;                                   /* Storage wr accesses.                                 */
+} USBD_MSC_CACHE_STAT;
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void  USBD_MSC_CacheInit      (USBD_ERR             *p_err);
+
+void  USBD_MSC_CacheRd        (USBD_MSC_LUN_CTRL    *p_lun,
+                               CPU_INT64U            blk_addr,
+                               CPU_INT32U            nbr_blks,
+                               CPU_INT08U           *p_data_buf,
+                               USBD_ERR             *p_err);
+
+void  USBD_MSC_CacheWr        (USBD_MSC_LUN_CTRL    *p_lun,
+                               CPU_INT64U            blk_addr,
+                               CPU_INT32U            nbr_blks,
+                               CPU_INT08U           *p_data_buf,
+                               USBD_ERR             *p_err);
+
+void  USBD_MSC_CacheFlush     (USBD_MSC_LUN_CTRL    *p_lun,
+                               USBD_ERR             *p_err);
+
+void  USBD_MSC_CacheInvalidate(USBD_MSC_LUN_CTRL    *p_lun);
+
+void  USBD_MSC_CacheDiscard   (USBD_MSC_LUN_CTRL    *p_lun,
+                               CPU_INT64U            blk_addr,
+                               CPU_INT32U            nbr_blks);
+
+void  USBD_MSC_CacheStatGet   (USBD_MSC_CACHE_STAT  *p_stat);
+
+void  USBD_MSC_CacheStatClr   (void);
+
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif
@@ -100,6 +100,22 @@ void  USBD_MSC_OS_EnumSignalPost(USBD_ERR     *p_err);
 void  USBD_MSC_OS_EnumSignalPend(CPU_INT32U    timeout,
                                  USBD_ERR     *p_err);
 
+#if ((USBD_MSC_CFG_DATA_NBR_BUF > 1u) || \
+     (USBD_MSC_CFG_UAS_EN       == DEF_ENABLED))
+void  USBD_MSC_OS_DataSignalPost(CPU_INT08U    class_nbr,
+                                 USBD_ERR     *p_err);
+
+void  USBD_MSC_OS_DataSignalPend(CPU_INT08U    class_nbr,
+                                 CPU_INT32U    timeout,
+                                 USBD_ERR     *p_err);
+#endif
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+void  USBD_MSC_OS_CacheLockAcquire(USBD_ERR  *p_err);
+
+void  USBD_MSC_OS_CacheLockRelease(USBD_ERR  *p_err);
+#endif
+
 
 /*
 *********************************************************************************************************
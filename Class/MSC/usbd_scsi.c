@@ -33,6 +33,7 @@
 #define    MICRIUM_SOURCE
 #define    USBD_SCSI_MODULE
 #include  "usbd_scsi.h"
+#include  "usbd_msc_cache.h"
 #if (USBD_MSC_CFG_MICRIUM_FS == DEF_ENABLED)
 #include  "Storage/uC-FS/V4/usbd_storage.h"
 #else
@@ -51,10 +52,13 @@
 #define  USBD_SCSI_BLOCK_DESC_LEN                          0u
 
 #define  USBD_SCSI_INQUIRY_DATA_LEN                       36u
-#define  USBD_SCSI_MODE_SENSE_DATA_LEN                   256u
+#define  USBD_SCSI_MODE_SENSE_DATA_LEN                    52u   /* Mode param hdr(10) and all supported pages.          */
 #define  USBD_SCSI_RD_CAPACITY_10_PARAM_DATA_LEN           8u
 #define  USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN          16u
 #define  USBD_SCSI_REQ_SENSE_DATA_LEN                     18u
+#define  USBD_SCSI_VPD_SUPPORTED_PAGES_MAX_LEN             7u
+#define  USBD_SCSI_VPD_BLK_LIMITS_LEN                     64u
+#define  USBD_SCSI_VPD_LBP_LEN                             8u
                                                                 /* ------------------ DATA XFER DIR ------------------- */
 #define  USBD_SCSI_CBW_HOST_TO_DEVICE                   0x00
 #define  USBD_SCSI_CBW_DEVICE_TO_HOST                   0x80
@@ -65,8 +69,41 @@
 #define  USBD_SCSI_INQUIRY_VERS_OBSOLETE                0x02
 #define  USBD_SCSI_INQUIRY_VERS_SPC_3                   0x05
 #define  USBD_SCSI_INQUIRY_RESP_DATA_FMT_DEFAULT        0x02
+#define  USBD_SCSI_VPD_INQUIRY_DATA                     0x01
+                                                                /* -------------- VITAL PRODUCT DATA PAGES ------------ */
+#define  USBD_SCSI_VPD_PAGE_SUPPORTED_PAGES             0x00
+#define  USBD_SCSI_VPD_PAGE_BLK_LIMITS                  0xB0
+#define  USBD_SCSI_VPD_PAGE_LBP                         0xB2
+#define  USBD_SCSI_VPD_BLK_LIMITS_WSNZ                  DEF_BIT_00
+#define  USBD_SCSI_VPD_LBP_LBPU                         DEF_BIT_07
+#define  USBD_SCSI_VPD_LBP_LBPWS                        DEF_BIT_06
+#define  USBD_SCSI_VPD_LBP_LBPRZ                        DEF_BIT_02
+#define  USBD_SCSI_VPD_LBP_PROVISIONING_TYPE_THIN       0x02
+                                                                /* ------------- LOGICAL BLK PROVISIONING ------------- */
+#define  USBD_SCSI_RD_CAPACITY_16_LBPME                 DEF_BIT_07
+#define  USBD_SCSI_RD_CAPACITY_16_LBPRZ                 DEF_BIT_06
+#define  USBD_SCSI_WR_SAME_UNMAP                        DEF_BIT_03
+#define  USBD_SCSI_WR_SAME_NDOB                         DEF_BIT_00
+#define  USBD_SCSI_UNMAP_PARAM_HDR_LEN                     8u
+#define  USBD_SCSI_UNMAP_BLK_DESC_LEN                     16u
+                                                                /* Max nbr of UNMAP blk desc rx'd in one data buf.      */
+#define  USBD_SCSI_UNMAP_BLK_DESC_MAX_NBR                ((DEF_MAX(USBD_MSC_CFG_DATA_LEN, USBD_SCSI_UNMAP_PARAM_HDR_LEN) - \
+                                                           USBD_SCSI_UNMAP_PARAM_HDR_LEN) / USBD_SCSI_UNMAP_BLK_DESC_LEN)
+                                                                /* ----------- SERVICE ACTION IN(16) ACTIONS ---------- */
+#define  USBD_SCSI_SERVICE_ACTION_MASK                  0x1F
+#define  USBD_SCSI_SERVICE_ACTION_RD_CAPACITY_16        0x10
+#define  USBD_SCSI_SERVICE_ACTION_GET_LBA_STATUS        0x12
+                                                                /* ------------------ GET LBA STATUS ------------------ */
+#define  USBD_SCSI_LBA_STATUS_PARAM_HDR_LEN                8u
+#define  USBD_SCSI_LBA_STATUS_DESC_LEN                    16u
+                                                                /* Max nbr of LBA status desc tx'd in one resp.         */
+#define  USBD_SCSI_LBA_STATUS_DESC_MAX_NBR               ((USBD_SCSI_RESP_BUF_LEN - USBD_SCSI_LBA_STATUS_PARAM_HDR_LEN) \
+                                                          / USBD_SCSI_LBA_STATUS_DESC_LEN)
+#define  USBD_SCSI_LBA_STATUS_MAPPED                    0x00
+#define  USBD_SCSI_LBA_STATUS_DEALLOCATED               0x01
                                                                 /* ------------------ REQ SENSE DATA ------------------ */
 #define  USBD_SCSI_REQ_SENSE_RESP_CODE_CUR_ERR          0x70
+#define  USBD_SCSI_ASCQ_SPACE_ALLOC_FAILED_WR_PROTECT   0x07
 
 
 /*
@@ -180,6 +217,7 @@
 #define  USBD_SCSI_CMD_CHANGE_DEFINITION                 0x40
 #define  USBD_SCSI_CMD_WRITE_SAME_10                     0x41
 #define  USBD_SCSI_CMD_READ_SUBCHANNEL                   0x42
+#define  USBD_SCSI_CMD_UNMAP                             0x42
 #define  USBD_SCSI_CMD_READ_TOC_PMA_ATIP                 0x43
 #define  USBD_SCSI_CMD_REPORT_DENSITY_SUPPORT            0x44
 #define  USBD_SCSI_CMD_READ_HEADER                       0x44
@@ -440,6 +478,7 @@
 #define USBD_SCSI_PAGE_CODE_READ_WRITE_ERROR_RECOVERY    0x01
 #define USBD_SCSI_PAGE_CODE_FORMAT_DEVICE                0x03
 #define USBD_SCSI_PAGE_CODE_FLEXIBLE_DISK                0x05
+#define USBD_SCSI_PAGE_CODE_CACHING                      0x08
 #define USBD_SCSI_PAGE_CODE_INFORMATIONAL_EXCEPTIONS     0x1C
 #define USBD_SCSI_PAGE_CODE_ALL                          0x3F
 
@@ -447,6 +486,7 @@
 #define USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY  0x0A
 #define USBD_SCSI_PAGE_LENGTH_FLEXIBLE_DISK              0x1E
 #define USBD_SCSI_PAGE_LENGTH_FORMAT_DEVICE              0x16
+#define USBD_SCSI_PAGE_LENGTH_CACHING                    0x12
 
 
 /*
@@ -519,6 +559,9 @@
 #define  USBD_SCSI_MODE_SENSE_DATA_HEAD_OFFSET_CNT      0x00
 #define  USBD_SCSI_MODE_SENSE_DATA_DATA_STROBE_OFFSET   0x00
 #define  USBD_SCSI_MODE_SENSE_DATA_RECOVERY_LIMIT       0x00
+                                                                /* --------------- CACHING PAGE PARAM ----------------- */
+#define  USBD_SCSI_MODE_SENSE_DATA_WCE              DEF_BIT_02  /* Wr cache en.                                         */
+#define  USBD_SCSI_MODE_SENSE_DATA_RCD              DEF_BIT_00  /* Rd cache dis.                                        */
 
 
 /*
@@ -557,12 +600,6 @@
 **********************************************************************************************************
 */
 
-static  USBD_STORAGE_LUN  USBD_SCSI_LunTbl[USBD_MSC_CFG_MAX_LUN];
-static  CPU_INT08U        USBD_SCSI_InquiryData[USBD_SCSI_INQUIRY_DATA_LEN];
-static  CPU_INT08U        USBD_SCSI_ModeSenseData[USBD_SCSI_MODE_SENSE_DATA_LEN];
-static  CPU_INT08U        USBD_SCSI_ReadCapacityData[USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN];
-static  CPU_INT08U        USBD_SCSI_ReqSenseData[USBD_SCSI_REQ_SENSE_DATA_LEN];
-
 
 /*
 **********************************************************************************************************
@@ -570,13 +607,7 @@ static  CPU_INT08U        USBD_SCSI_ReqSenseData[USBD_SCSI_REQ_SENSE_DATA_LEN];
 **********************************************************************************************************
 */
 
-static  CPU_INT08U  *USBD_SCSI_RespBufPtr;                      /* Ptr to data buf for Data IN phase.                   */
-static  CPU_INT32U   USBD_SCSI_RespLen;                         /* Buf len.                                             */
-static  CPU_INT64U   USBD_SCSI_LBAddr;                          /* 64-bit Logical Blk Addr.                             */
-static  CPU_INT32U   USBD_SCSI_LBCnt;                           /* Nbr of mem blks.                                     */
-static  CPU_INT08U   USBD_SCSI_SenseKey;                        /* Sense key describing an err or exception cond.       */
-static  CPU_INT08U   USBD_SCSI_ASC;                             /* Additional Sense Code describing sense key in detail.*/
-static  CPU_INT08U   USBD_SCSI_ASCQ;                            /* Additional Sense Code Qualifier.                     */
+static  CPU_INT08U  USBD_SCSI_StorageLunNbrNext;                /* Storage unit nbr given to next logical unit.         */
 
 
 /*
@@ -585,26 +616,54 @@ static  CPU_INT08U   USBD_SCSI_ASCQ;                            /* Additional Se
 **********************************************************************************************************
 */
 
-static  void   USBD_SCSI_ModeSenseDataPrepare(const USBD_MSC_LUN_CTRL  *p_lun,
+static  void   USBD_SCSI_ModeSenseDataPrepare(      USBD_MSC_LUN_CTRL  *p_lun,
+                                                    USBD_SCSI_CMD_CTX  *p_cmd,
                                                     CPU_INT08U          scsi_cmd,
                                                     CPU_INT08U          page_code,
                                                     USBD_ERR           *p_err);
 
-static  void   USBD_SCSI_ReqSenseDataUpdate  (      CPU_INT08U          sense_key,
+static  void   USBD_SCSI_ReqSenseDataUpdate  (      USBD_SCSI_CMD_CTX  *p_cmd,
+                                                    CPU_INT08U          sense_key,
                                                     CPU_INT08U          sense_code,
                                                     CPU_INT08U          sense_code_qual);
 
-static  void   USBD_SCSI_InquiryDataPrepare  (const USBD_MSC_LUN_CTRL  *p_lun,
+static  void   USBD_SCSI_InquiryDataPrepare  (      USBD_MSC_LUN_CTRL  *p_lun,
+                                                    USBD_SCSI_CMD_CTX  *p_cmd,
                                                     CPU_INT08U          cmdt_evpd,
                                                     CPU_INT08U          page_code,
                                                     USBD_ERR           *p_err);
 
-static  void   USBD_SCSI_LunStatusAnalyze    (      USBD_ERR            err);
+static  void   USBD_SCSI_LunStatusAnalyze    (      USBD_SCSI_CMD_CTX  *p_cmd,
+                                                    USBD_ERR            err);
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_DISABLED)
+static  void   USBD_SCSI_StorageRdCmpl       (      USBD_STORAGE_LUN   *p_storage_lun,
+                                                    CPU_INT08U         *p_data_buf,
+                                                    CPU_INT32U          nbr_blks,
+                                                    void               *p_arg,
+                                                    USBD_ERR            err);
+#endif
+
+static  void   USBD_SCSI_Unmap               (      USBD_MSC_LUN_CTRL  *p_lun,
+                                                    USBD_SCSI_CMD_CTX  *p_cmd,
+                                                    CPU_INT64U          blk_addr,
+                                                    CPU_INT32U          nbr_blks,
+                                                    USBD_ERR           *p_err);
+
+static  void   USBD_SCSI_LBA_StatusPrepare   (      USBD_MSC_LUN_CTRL  *p_lun,
+                                                    USBD_SCSI_CMD_CTX  *p_cmd,
+                                              const CPU_INT08U         *p_cbwcb,
+                                                    USBD_ERR           *p_err);
+
+static  CPU_BOOLEAN  USBD_SCSI_BlkIsZero     (const CPU_INT08U         *p_blk,
+                                                    CPU_INT32U          blk_size);
 
 static  void   USBD_SCSI_PageRdWrErrRecovery (      void               *p_buf_dest);
 
 static  void   USBD_SCSI_PageInfoExcept      (      void               *p_buf_dest);
 
+static  void   USBD_SCSI_PageCaching         (      void               *p_buf_dest);
+
 
 /*
 **********************************************************************************************************
@@ -612,6 +671,16 @@ static  void   USBD_SCSI_PageInfoExcept      (      void               *p_buf_de
 **********************************************************************************************************
 */
 
+#if ((USBD_SCSI_INQUIRY_DATA_LEN              > USBD_SCSI_RESP_BUF_LEN) || \
+     (USBD_SCSI_MODE_SENSE_DATA_LEN           > USBD_SCSI_RESP_BUF_LEN) || \
+     (USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN > USBD_SCSI_RESP_BUF_LEN) || \
+     (USBD_SCSI_REQ_SENSE_DATA_LEN            > USBD_SCSI_RESP_BUF_LEN) || \
+     (USBD_SCSI_VPD_BLK_LIMITS_LEN            > USBD_SCSI_RESP_BUF_LEN) || \
+     (USBD_SCSI_LBA_STATUS_PARAM_HDR_LEN + \
+      USBD_SCSI_LBA_STATUS_DESC_LEN           > USBD_SCSI_RESP_BUF_LEN))
+#error  "USBD_SCSI_RESP_BUF_LEN illegally #define'd in 'usbd_scsi.h' [MUST be >= longest SCSI response data]"
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -625,7 +694,7 @@ static  void   USBD_SCSI_PageInfoExcept      (      void               *p_buf_de
 *********************************************************************************************************
 *                                            USBD_SCSI_Init()
 *
-* Description : Initialize internal tables, variables and the storage layer.
+* Description : Initialize internal variables and the storage layer.
 *
 * Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
 *
@@ -634,71 +703,20 @@ static  void   USBD_SCSI_PageInfoExcept      (      void               *p_buf_de
 *
 * Return(s)   : None.
 *
-* Note(s)     : (1) The format of standard INQUIRY data is specified in 'SCSI Primary Commands - 3' (SPC-3),
-*                   Revision 23, Section 6.4.2.
-*
-*                   (a) Byte 2: VERSION field indicates the implemented version of this standard.
-*
-*                   (b) Byte 3: RESPONSE DATA FORMAT field value of two indicates that the data shall be
-*                       in the format defined in this standard
-*
-*                   (c) Byte 4: ADDITIONAL LENGTH field indicates the length in bytes of the remaining
-*                       standard INQUIRY data.
-*
-*               (2) The format of MODE SENSE data is specified in 'SCSI Primary Commands - 3' (SPC-3),
-*                   Revision 23, Section 7.4.1.
-*
-*               (3) The format of READ CAPACITY(10) parameter data is specified in 'SCSI Block Commands - 3'
-*                   (SPC-3), Section 5.12.2.
-*                   The format of READ CAPACITY(16) parameter data is specified in 'SCSI Block Commands - 3'
-*                   (SPC-3), Section 5.12.3.
-*
-*               (4) The format of standard fixed-format sense data is specified in 'SCSI Primary Commands - 3'
-*                   (SPC-3), Revision 23, Section 4.5.3.
-*
-*                   (a) Byte 0: RESPONSE CODE field indicates the error type and format of the sense data.
-*
-*                   (b) Byte 7: ADDITIONAL SENSE LENGTH field indicates the number of additional sense
-*                       bytes that follow.
+* Note(s)     : None.
 *********************************************************************************************************
 */
 
 void  USBD_SCSI_Init (USBD_ERR  *p_err)
 {
-    CPU_INT08U  ix;
+    USBD_SCSI_StorageLunNbrNext = 0u;
 
-
-    for (ix = 0; ix < USBD_MSC_CFG_MAX_LUN; ix++) {
-        Mem_Clr((void     *)&USBD_SCSI_LunTbl[ix],
-                (CPU_SIZE_T) sizeof(USBD_STORAGE_LUN));
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    USBD_MSC_CacheInit(p_err);                                  /* Init blk cache.                                      */
+    if (*p_err != USBD_ERR_NONE) {
+        return;
     }
-                                                                /* See Note #1.                                         */
-    Mem_Clr((void     *)USBD_SCSI_InquiryData,
-            (CPU_SIZE_T)USBD_SCSI_INQUIRY_DATA_LEN);
-                                                                /* See Note #2.                                         */
-    Mem_Clr((void     *)USBD_SCSI_ModeSenseData,
-            (CPU_SIZE_T)USBD_SCSI_MODE_SENSE_DATA_LEN);
-                                                                /* See Note #3.                                         */
-    Mem_Clr((void     *)USBD_SCSI_ReadCapacityData,
-            (CPU_SIZE_T)USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN);
-                                                                /* See Note #4.                                         */
-    Mem_Clr((void     *)USBD_SCSI_ReqSenseData,
-            (CPU_SIZE_T)USBD_SCSI_REQ_SENSE_DATA_LEN);
-                                                                /* See Note #1a to 1c.                                  */
-    USBD_SCSI_InquiryData[2] =  USBD_SCSI_INQUIRY_VERS_SPC_3;
-    USBD_SCSI_InquiryData[3] =  USBD_SCSI_INQUIRY_RESP_DATA_FMT_DEFAULT;
-    USBD_SCSI_InquiryData[4] = (USBD_SCSI_INQUIRY_DATA_LEN - 5);
-                                                                /* See Note #4a to 4b.                                  */
-    USBD_SCSI_ReqSenseData[0] =  USBD_SCSI_REQ_SENSE_RESP_CODE_CUR_ERR;
-    USBD_SCSI_ReqSenseData[7] = (USBD_SCSI_REQ_SENSE_DATA_LEN - 8);
-
-    USBD_SCSI_RespBufPtr = (CPU_INT08U *)0u;
-    USBD_SCSI_RespLen    =  0u;
-    USBD_SCSI_LBAddr     =  0u;
-    USBD_SCSI_LBCnt      =  0u;
-    USBD_SCSI_SenseKey   =  0u;
-    USBD_SCSI_ASC        =  0u;
-    USBD_SCSI_ASCQ       =  0u;
+#endif
 
     USBD_StorageInit(p_err);                                    /* Init storage layer.                                  */
 }
@@ -710,7 +728,7 @@ void  USBD_SCSI_Init (USBD_ERR  *p_err)
 *
 * Description : Initialize the specified logical unit.
 *
-* Argument(s) : lun_nbr         Logical unit number.
+* Argument(s) : p_lun           Pointer to Logical Unit information.
 *
 *               p_vol_str       Pointer to string uniquely identifying the logical unit.
 *
@@ -721,18 +739,36 @@ void  USBD_SCSI_Init (USBD_ERR  *p_err)
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) The storage unit number is only consumed once the storage layer accepted the logical
+*                   unit (see 'usbd_scsi.h  DEFINES  Note #1').
 *********************************************************************************************************
 */
 
-void  USBD_SCSI_LunAdd (CPU_INT08U   lun_nbr,
-                        CPU_CHAR    *p_vol_str,
-                        USBD_ERR    *p_err)
+void  USBD_SCSI_LunAdd (USBD_MSC_LUN_CTRL  *p_lun,
+                        CPU_CHAR           *p_vol_str,
+                        USBD_ERR           *p_err)
 {
-    USBD_SCSI_LunTbl[lun_nbr].LunNbr    = lun_nbr;
-    USBD_SCSI_LunTbl[lun_nbr].VolStrPtr = p_vol_str;
+    USBD_STORAGE_LUN  *p_storage_lun;
+
+
+    p_storage_lun = &p_lun->StorageLun;
+
+    Mem_Clr((void     *)p_storage_lun,
+            (CPU_SIZE_T)sizeof(USBD_STORAGE_LUN));
 
-    USBD_StorageAdd(&USBD_SCSI_LunTbl[lun_nbr], p_err);         /* Init logical unit.                                   */
+    p_storage_lun->LunNbr    = USBD_SCSI_StorageLunNbrNext;
+    p_storage_lun->VolStrPtr = p_vol_str;
+
+    USBD_SCSI_Reset(p_lun);                                     /* Clr cmd ctx.                                         */
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    USBD_MSC_CacheInvalidate(p_lun);                            /* Init blk cache state of logical unit.                */
+#endif
+
+    USBD_StorageAdd(p_storage_lun, p_err);                      /* Init logical unit.                                   */
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_SCSI_StorageLunNbrNext++;                          /* See Note #1.                                         */
+    }
 }
 
 
@@ -744,6 +780,8 @@ void  USBD_SCSI_LunAdd (CPU_INT08U   lun_nbr,
 *
 * Argument(s) : p_lun            Pointer to Logical Unit information.
 *
+*               p_cmd            Pointer to the command context (see 'usbd_scsi.h  SCSI COMMAND CONTEXT').
+*
 *               p_cbwcb          Pointer to the Command Block Wrapper that contains the SCSI command.
 *
 *               p_resp_len       Pointer to variable that will receive the length of the SCSI response
@@ -795,6 +833,9 @@ void  USBD_SCSI_LunAdd (CPU_INT08U   lun_nbr,
 *               (4) The format of READ CAPACITY (16) command is specified in 'SCSI Blocks Commands - 3'
 *                   (SBC-3), Revision 16, Section 5.13.
 *
+*                   (a) A thin provisioned logical unit is reported with the LBPME bit set, and with the
+*                       LBPRZ bit set since its unmapped blocks read as zeros.
+*
 *               (5) The format of READ(10) command is specified in 'SCSI Block Commands - 3'
 *                   (SBC), Revision 16, Section 5.8.
 *
@@ -831,15 +872,49 @@ void  USBD_SCSI_LunAdd (CPU_INT08U   lun_nbr,
 *               (16)    The format of REQUEST SENSE command is specified in 'SCSI Primary Commands - 3'
 *                       (SPC-3), Revision 23, Section 6.25.
 *
+*                       (a) The sense data is returned in the standard fixed format specified in 'SCSI
+*                           Primary Commands - 3' (SPC-3), Revision 23, Section 4.5.3. Byte 0 RESPONSE CODE
+*                           field indicates the error type and byte 7 ADDITIONAL SENSE LENGTH field the
+*                           number of additional sense bytes that follow.
+*
 *               (17)    The format of PREVENT ALLOW MEDIUM REMOVAL command is specified in 'SCSI Primary
 *                       Commands - 3' (SPC-3), Revision 23, Section 6.13.
 *
 *               (18)    The format of START STOP UNIT command is specified in 'SCSI Primary
 *                       Commands - 3' (SPC-3), Revision 23, Section 5.19.
+*
+*                       (a) Stopping or ejecting the medium first writes back the blocks held by the block
+*                           cache. Starting the medium is not supported.
+*
+*               (19)    The format of SYNCHRONIZE CACHE(10) and SYNCHRONIZE CACHE(16) commands is specified
+*                       in 'SCSI Block Commands - 3' (SBC), Revision 16. The whole logical unit is
+*                       synchronized, whatever the range given.
+*
+*               (20)    The format of UNMAP command is specified in 'SCSI Block Commands - 3' (SBC-3),
+*                       Revision 25, Section 5.28. It is only supported by thin provisioned logical units
+*                       (see 'usbd_scsi.h  STORAGE UNIT CONTROL  Note #1'). The parameter list must fit in
+*                       one data buffer: the maximum number of block descriptors reported in the Block
+*                       Limits page is computed from USBD_MSC_CFG_DATA_LEN.
+*
+*               (21)    The format of WRITE SAME(16) command is specified in 'SCSI Block Commands - 3'
+*                       (SBC-3), Revision 25, Section 5.42. The block received in the data stage is
+*                       written to every block of the range (see 'USBD_SCSI_DataWr()  Note #2').
+*
+*                       (a) With the NDOB bit set, no data is transferred and the range is unmapped. This
+*                           requires the UNMAP bit and a thin provisioned logical unit.
+*
+*                       (b) A NUMBER OF LOGICAL BLOCKS field set to 0 is rejected, as reported by the WSNZ
+*                           bit of the Block Limits page.
+*
+*               (22)    The format of GET LBA STATUS command is specified in 'SCSI Block Commands - 3'
+*                       (SBC-3), Revision 25, Section 5.4. It shares the SERVICE ACTION IN(16) operation
+*                       code with READ CAPACITY(16) and is only supported by thin provisioned logical units,
+*                       which report the LBPME bit (see Note #4a and 'USBD_SCSI_LBA_StatusPrepare()').
 **********************************************************************************************************
 */
 
 void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
+                                  USBD_SCSI_CMD_CTX  *p_cmd,
                             const CPU_INT08U         *p_cbwcb,
                                   CPU_INT32U         *p_resp_len,
                                   CPU_INT08U         *p_data_dir,
@@ -854,13 +929,13 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
     CPU_INT64U         nbr_blks;
     CPU_INT32U         total_area_size_verifd;
     CPU_INT32U         total_lu_size;
-    USBD_STORAGE_LUN  *p_storage_lun;
+    USBD_STORAGE_LUN   *p_storage_lun;
 
 
     scsi_cmd      =  p_cbwcb[0];                                /* Get the SCSI cmd blk opcode.                         */
    *p_err         =  USBD_ERR_NONE;
    *p_resp_len    =  0;
-    p_storage_lun = &USBD_SCSI_LunTbl[p_lun->LunNbr];
+    p_storage_lun = &p_lun->StorageLun;
 
     switch (scsi_cmd) {
         case USBD_SCSI_CMD_INQUIRY:                             /* --------------  INQUIRY(see Notes #1) -------------- */
@@ -869,23 +944,26 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
              cmdt_evpd = p_cbwcb[1] & 0x03;                     /* Get the enable vital prod data bit.                  */
              page_code = p_cbwcb[2];                            /* Page code for vital prod data info.                  */
 
-             USBD_SCSI_InquiryDataPrepare(p_lun, cmdt_evpd, page_code, p_err);
+             USBD_SCSI_InquiryDataPrepare(p_lun, p_cmd, cmdt_evpd, page_code, p_err);
 
              if (*p_err  == USBD_ERR_NONE) {
-                 len = DEF_MIN(USBD_SCSI_INQUIRY_DATA_LEN, p_cbwcb[4]);
+                                                                /* Limit data len to alloc len.                         */
+                 len = DEF_MIN(p_cmd->RespLen, MEM_VAL_GET_INT16U_BIG(&p_cbwcb[3]));
                                                                 /* Copy the Inquiry data.                               */
-                 USBD_SCSI_RespBufPtr = &USBD_SCSI_InquiryData[0];
-                 USBD_SCSI_RespLen    = len;
-                *p_data_dir           = USBD_SCSI_CBW_DEVICE_TO_HOST;
+                 p_cmd->RespBufPtr = &p_cmd->RespBuf[0];
+                 p_cmd->RespLen    = len;
+                *p_data_dir        = USBD_SCSI_CBW_DEVICE_TO_HOST;
                                                                 /* Build req sense data with no err cond.               */
-                 USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_NO_SENSE,
                                               USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                               0x00);
              } else {
-                 USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-                 USBD_SCSI_RespLen    =  0;
+                 p_cmd->RespBufPtr = (CPU_INT08U *)0;
+                 p_cmd->RespLen    =  0;
                                                                 /* Build req sense data with an err cond.               */
-                 USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                               USBD_SCSI_ASC_INVALID_FIELD_IN_CDB,
                                               0x00);
              }
@@ -915,14 +993,26 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
                  p_storage_lun->EjectFlag = DEF_FALSE;
              }
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
-             USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-             USBD_SCSI_RespLen    = 0;
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
              break;
 
 
         case USBD_SCSI_CMD_READ_CAPACITY_10:                    /* --------- READ CAPACITY(10)(see Notes #3) ---------- */
         case USBD_SCSI_CMD_SERVICE_ACTION_IN_16:                /* --------- READ CAPACITY(16)(see Notes #4) ---------- */
+             if ((scsi_cmd                                 == USBD_SCSI_CMD_SERVICE_ACTION_IN_16) &&
+                 ((p_cbwcb[1] & USBD_SCSI_SERVICE_ACTION_MASK) == USBD_SCSI_SERVICE_ACTION_GET_LBA_STATUS)) {
+                                                                /* ---------- GET LBA STATUS (see Notes #22) ---------- */
+                 USBD_DBG_MSC_SCSI_MSG("SCSI: GET LBA STATUS Command");
+
+                 USBD_SCSI_LBA_StatusPrepare(p_lun, p_cmd, p_cbwcb, p_err);
+                 if (*p_err == USBD_ERR_NONE) {
+                    *p_data_dir = USBD_SCSI_CBW_DEVICE_TO_HOST;
+                 }
+                 break;
+             }
+
              USBD_DBG_MSC_SCSI_MSG("SCSI: READ CAPACITY 10 / 16 Command");
 
              if ((p_storage_lun->LockFlag  == DEF_FALSE) ||     /* Logical unit not locked...                           */
@@ -932,7 +1022,7 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
                  USBD_StorageStatusGet(p_storage_lun, p_err);
              }
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
              if (*p_err == USBD_ERR_NONE){
                                                                 /* Get the capacity, nbr of blks and blk size.          */
                  USBD_StorageCapacityGet(p_storage_lun,
@@ -940,26 +1030,33 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
                                         &p_lun->BlockSize,
                                          p_err);
 
-                 USBD_SCSI_LunStatusAnalyze(*p_err);            /* Check err code & build req sense data.               */
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);     /* Check err code & build req sense data.               */
                  if (*p_err != USBD_ERR_NONE ) {
                      break;
                  }
 
+                 Mem_Clr((void     *)&p_cmd->RespBuf[0],
+                         (CPU_SIZE_T) USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN);
+
                  if (scsi_cmd == USBD_SCSI_CMD_READ_CAPACITY_10) {
 
-                     MEM_VAL_SET_INT32U_BIG(&USBD_SCSI_ReadCapacityData[0], p_lun->NbrBlocks - 1);
-                     MEM_VAL_SET_INT32U_BIG(&USBD_SCSI_ReadCapacityData[4], p_lun->BlockSize);
-                     USBD_SCSI_RespBufPtr = &USBD_SCSI_ReadCapacityData[0];
-                     USBD_SCSI_RespLen    =  USBD_SCSI_RD_CAPACITY_10_PARAM_DATA_LEN;
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[0], p_lun->NbrBlocks - 1);
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[4], p_lun->BlockSize);
+                     p_cmd->RespBufPtr = &p_cmd->RespBuf[0];
+                     p_cmd->RespLen    =  USBD_SCSI_RD_CAPACITY_10_PARAM_DATA_LEN;
 
                  } else {
                      nbr_blks = p_lun->NbrBlocks - 1;
-                     MEM_VAL_COPY_SET_INTU_BIG(&USBD_SCSI_ReadCapacityData[0], &nbr_blks, 8u);
-                     MEM_VAL_SET_INT32U_BIG(&USBD_SCSI_ReadCapacityData[8], p_lun->BlockSize);
-                     USBD_SCSI_RespBufPtr = &USBD_SCSI_ReadCapacityData[0];
-                     USBD_SCSI_RespLen    =  USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN;
+                     MEM_VAL_COPY_SET_INTU_BIG(&p_cmd->RespBuf[0], &nbr_blks, 8u);
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[8], p_lun->BlockSize);
+                     if (p_storage_lun->UnmapEn == DEF_TRUE) {  /* See Note #4a.                                        */
+                         p_cmd->RespBuf[14] = USBD_SCSI_RD_CAPACITY_16_LBPME |
+                                              USBD_SCSI_RD_CAPACITY_16_LBPRZ;
+                     }
+                     p_cmd->RespBufPtr = &p_cmd->RespBuf[0];
+                     p_cmd->RespLen    =  USBD_SCSI_RD_CAPACITY_16_PARAM_DATA_LEN;
                  }
-                *p_data_dir = USBD_SCSI_CBW_DEVICE_TO_HOST;
+                *p_data_dir        = USBD_SCSI_CBW_DEVICE_TO_HOST;
              }
 
              break;
@@ -977,32 +1074,33 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
                 USBD_StorageStatusGet(p_storage_lun, p_err);
              }
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
              if (*p_err == USBD_ERR_NONE){
 
                  if (scsi_cmd == USBD_SCSI_CMD_READ_10){
                                                                 /* Get the LBA from where data has to be rd.            */
-                     USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                     p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall be rd.                    */
-                     USBD_SCSI_LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
+                     p_cmd->LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
 
                  } else if (scsi_cmd == USBD_SCSI_CMD_READ_12){
                                                                 /* Get the LBA from where data has to be rd.            */
-                     USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                     p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall be rd.                    */
-                     USBD_SCSI_LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
+                     p_cmd->LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
 
                  } else {
                                                                 /* Get the LBA from where data has to be rd.            */
-                     MEM_VAL_COPY_GET_INTU_BIG(&USBD_SCSI_LBAddr, &p_cbwcb[2], 8u);
+                     MEM_VAL_COPY_GET_INTU_BIG(&p_cmd->LBAddr, &p_cbwcb[2], 8u);
                                                                 /* Nbr of log blks that shall be rd.                    */
-                     USBD_SCSI_LBCnt = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
+                     p_cmd->LBCnt = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
                  }
-                 USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-                 USBD_SCSI_RespLen    =  USBD_SCSI_LBCnt * (p_lun->BlockSize);
-                *p_data_dir           =  USBD_SCSI_CBW_DEVICE_TO_HOST;
+                 p_cmd->RespBufPtr = (CPU_INT08U *)0;
+                 p_cmd->RespLen    =  p_cmd->LBCnt * (p_lun->BlockSize);
+                *p_data_dir        =  USBD_SCSI_CBW_DEVICE_TO_HOST;
                                                                 /* Build req sense data with no err cond.               */
-                 USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_NO_SENSE,
                                               USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                               0x00);
              }
@@ -1017,15 +1115,17 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
              if ((p_storage_lun->LockFlag  == DEF_FALSE) ||     /* Logical unit not locked...                           */
                  (p_storage_lun->EjectFlag == DEF_TRUE )) {     /* Logical unit has been ejected by host...             */
                                                                 /* ...medium is considered not present.                 */
-                     USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-                     USBD_SCSI_RespLen    =  0;
-                     USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NOT_RDY,
+                     p_cmd->RespBufPtr = (CPU_INT08U *)0;
+                     p_cmd->RespLen    =  0;
+                     USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                                  USBD_SCSI_SENSE_KEY_NOT_RDY,
                                                   USBD_SCSI_ASC_MEDIUM_NOT_PRESENT,
                                                   0x00);
              }
 
              if (p_lun->LunInfo.ReadOnly == DEF_TRUE) {         /* Check medium is wr protected or not.                 */
-                 USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_DATA_PROTECT,
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_DATA_PROTECT,
                                               USBD_SCSI_ASC_WR_PROTECTED,
                                               0x00);
                 *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
@@ -1034,27 +1134,28 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
 
              if (scsi_cmd == USBD_SCSI_CMD_WRITE_10) {
                                                                 /* Get the LBA from where data has to be written.       */
-                 USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                 p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall be written.               */
-                 USBD_SCSI_LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
+                 p_cmd->LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
 
              } else if (scsi_cmd == USBD_SCSI_CMD_WRITE_12) {
                                                                 /* Get the LBA from where data has to be written.       */
-                 USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                 p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall be written.               */
-                 USBD_SCSI_LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
+                 p_cmd->LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
 
              } else {
                                                                 /* Get the LBA from where data has to be written.       */
-                 MEM_VAL_COPY_GET_INTU_BIG(&USBD_SCSI_LBAddr, &p_cbwcb[2], 8u);
+                 MEM_VAL_COPY_GET_INTU_BIG(&p_cmd->LBAddr, &p_cbwcb[2], 8u);
                                                                 /* Nbr of log blks that shall be written.               */
-                 USBD_SCSI_LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
+                 p_cmd->LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
              }
-             USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-             USBD_SCSI_RespLen    =  USBD_SCSI_LBCnt * (p_lun->BlockSize);
-            *p_data_dir           =  USBD_SCSI_CBW_HOST_TO_DEVICE;
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    =  p_cmd->LBCnt * (p_lun->BlockSize);
+            *p_data_dir        =  USBD_SCSI_CBW_HOST_TO_DEVICE;
                                                                 /* Build req sense data with no err cond.               */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NO_SENSE,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
@@ -1067,31 +1168,31 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
 
              if (scsi_cmd == USBD_SCSI_CMD_VERIFY_10){
                                                                 /* Get the LBA of where data has to be verified.        */
-                 USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                 p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall  be verified.             */
-                 USBD_SCSI_LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
+                 p_cmd->LBCnt  = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
 
              } else if (scsi_cmd == USBD_SCSI_CMD_VERIFY_12) {
                                                                 /* Get the LBA of where data has to be verified.        */
-                 USBD_SCSI_LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
+                 p_cmd->LBAddr = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[2]);
                                                                 /* Nbr of log blks that shall  be verified.             */
-                 USBD_SCSI_LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
+                 p_cmd->LBCnt  = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[6]);
 
              } else {
                                                                 /* Get the LBA of where data has to be verified.        */
-                 MEM_VAL_COPY_GET_INTU_BIG(&USBD_SCSI_LBAddr, &p_cbwcb[2], 8u);
+                 MEM_VAL_COPY_GET_INTU_BIG(&p_cmd->LBAddr, &p_cbwcb[2], 8u);
                                                                 /* Nbr of log blks that shall  be verified.             */
-                 USBD_SCSI_LBCnt = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
+                 p_cmd->LBCnt = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
              }
 
-             total_area_size_verifd = USBD_SCSI_LBAddr * USBD_SCSI_LBCnt;
+             total_area_size_verifd = p_cmd->LBAddr * p_cmd->LBCnt;
              total_lu_size          = p_lun->NbrBlocks * p_lun->BlockSize;
              if (total_area_size_verifd > total_lu_size) {
                 *p_err = USBD_ERR_SCSI_LOG_BLOCK_ADDR;
              }
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
-             USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-             USBD_SCSI_RespLen    = 0;
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
              break;
 
 
@@ -1106,31 +1207,33 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
                  USBD_StorageStatusGet(p_storage_lun, p_err);
              }
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
              if (*p_err == USBD_ERR_NONE){
                                                                 /* Get page code.                                       */
                  page_code = p_cbwcb[2] & USBD_SCSI_MSK_PAGE_CODE;
-                 USBD_SCSI_ModeSenseDataPrepare(p_lun, scsi_cmd, page_code, p_err);
+                 USBD_SCSI_ModeSenseDataPrepare(p_lun, p_cmd, scsi_cmd, page_code, p_err);
                  if (*p_err == USBD_ERR_NONE) {
 
                      if (scsi_cmd == USBD_SCSI_CMD_MODE_SENSE_06) {
-                         len = DEF_MIN(USBD_SCSI_ModeSenseData[0] + 1, p_cbwcb[4]);
+                         len = DEF_MIN(p_cmd->RespBuf[0] + 1, p_cbwcb[4]);
 
                      } else {
                          len = (p_cbwcb[7] << 8u) |
                                 p_cbwcb[8];
-                         len = DEF_MIN(((CPU_INT32U)USBD_SCSI_ModeSenseData[0] + 1), len);
+                         len = DEF_MIN(((CPU_INT32U)p_cmd->RespBuf[0] + 1), len);
 
                      }
-                     USBD_SCSI_RespBufPtr = &USBD_SCSI_ModeSenseData[0];
-                     USBD_SCSI_RespLen    =  len;               /* Nbr of bytes of data that shall be xfered.           */
-                    *p_data_dir           =  USBD_SCSI_CBW_DEVICE_TO_HOST;
-                     USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+                     p_cmd->RespBufPtr = &p_cmd->RespBuf[0];
+                     p_cmd->RespLen    =  len;                  /* Nbr of bytes of data that shall be xfered.           */
+                    *p_data_dir        =  USBD_SCSI_CBW_DEVICE_TO_HOST;
+                     USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                                  USBD_SCSI_SENSE_KEY_NO_SENSE,
                                                   USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                                   0x00);
 
                  } else {
-                     USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                     USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                                  USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                                   USBD_SCSI_ASC_INVALID_FIELD_IN_CDB,
                                                   0x00);
                  }
@@ -1140,14 +1243,21 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
 
         case USBD_SCSI_CMD_REQUEST_SENSE:                       /* ----------- REQUEST SENSE(see Notes #16) ----------- */
              USBD_DBG_MSC_SCSI_MSG("SCSI: REQUEST SENSE Command");
-             len                        =  DEF_MIN(USBD_SCSI_REQ_SENSE_DATA_LEN, p_cbwcb[4]);
-             USBD_SCSI_ReqSenseData[2]  =  USBD_SCSI_SenseKey;
-             USBD_SCSI_ReqSenseData[12] =  USBD_SCSI_ASC;
-             USBD_SCSI_ReqSenseData[13] =  USBD_SCSI_ASCQ;
-             USBD_SCSI_RespBufPtr       = &USBD_SCSI_ReqSenseData[0];
-             USBD_SCSI_RespLen          =  len;                 /* Nbr of bytes of data that shall be xferred.          */
-            *p_data_dir                 =  USBD_SCSI_CBW_DEVICE_TO_HOST;
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+             len = DEF_MIN(USBD_SCSI_REQ_SENSE_DATA_LEN, p_cbwcb[4]);
+
+             Mem_Clr((void     *)&p_cmd->RespBuf[0],          /* Build fixed fmt sense data (see Note #16a).          */
+                     (CPU_SIZE_T) USBD_SCSI_REQ_SENSE_DATA_LEN);
+             p_cmd->RespBuf[0]  = USBD_SCSI_REQ_SENSE_RESP_CODE_CUR_ERR;
+             p_cmd->RespBuf[2]  = p_cmd->SenseKey;
+             p_cmd->RespBuf[7]  = USBD_SCSI_REQ_SENSE_DATA_LEN - 8u;
+             p_cmd->RespBuf[12] = p_cmd->ASC;
+             p_cmd->RespBuf[13] = p_cmd->ASCQ;
+
+             p_cmd->RespBufPtr  = &p_cmd->RespBuf[0];
+             p_cmd->RespLen     =  len;                         /* Nbr of bytes of data that shall be xferred.          */
+            *p_data_dir         =  USBD_SCSI_CBW_DEVICE_TO_HOST;
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NO_SENSE,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
@@ -1156,9 +1266,10 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
         case USBD_SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:        /* --- PREVENT ALLOW MEDIUM REMOVAL (see Notes #17) --- */
              USBD_DBG_MSC_SCSI_MSG("SCSI: PREVENT ALLOW MEDIUM REMOVAL Command");
 
-             USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-             USBD_SCSI_RespLen    = 0;
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NO_SENSE,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
@@ -1170,24 +1281,35 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
              loej       = p_cbwcb[4] & USBD_SCSI_START_STOP_UNIT_LOEJ;
              start_flag = p_cbwcb[4] & USBD_SCSI_START_STOP_UNIT_START;
 
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+                                                                /* Stop the medium (see Note #18a).                     */
+             if (DEF_BIT_IS_CLR(start_flag, USBD_SCSI_START_STOP_UNIT_START) == DEF_YES) {
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+                 USBD_MSC_CacheFlush(p_lun, p_err);
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);     /* Check err code & build req sense data.               */
+                 if (*p_err != USBD_ERR_NONE) {
+                     break;
+                 }
+#endif
                                                                 /* Eject the medium.                                    */
-             if ((DEF_BIT_IS_SET(loej,       USBD_SCSI_START_STOP_UNIT_LOEJ)  == DEF_YES) &&
-                 (DEF_BIT_IS_CLR(start_flag, USBD_SCSI_START_STOP_UNIT_START) == DEF_YES)) {
+                 if (DEF_BIT_IS_SET(loej, USBD_SCSI_START_STOP_UNIT_LOEJ) == DEF_YES) {
 
-                 p_storage_lun->EjectFlag = DEF_TRUE;           /* Flag logical unit as ejected.                        */
-
-                 USBD_StorageUnlock(p_storage_lun, p_err);
-                 p_storage_lun->LockFlag = DEF_FALSE;
-                 USBD_SCSI_LunStatusAnalyze(*p_err);            /* Check err code & build req sense data.               */
+                     p_storage_lun->EjectFlag = DEF_TRUE;       /* Flag logical unit as ejected.                        */
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+                     USBD_MSC_CacheInvalidate(p_lun);
+#endif
+                     USBD_StorageUnlock(p_storage_lun, p_err);
+                     p_storage_lun->LockFlag = DEF_FALSE;
+                 }
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);     /* Check err code & build req sense data.               */
                  if (*p_err != USBD_ERR_NONE ) {
                      break;
                  }
              } else {
-
-                 USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-                 USBD_SCSI_RespLen    = 0;
                 *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
-                 USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                               USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                               0x00);
              }
@@ -1195,19 +1317,148 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
              break;
 
 
+        case USBD_SCSI_CMD_SYNCHRONIZE_CACHE_10:                /* ------- SYNCHRONIZE CACHE 10 (see Notes #19) ------- */
+        case USBD_SCSI_CMD_SYNCHRONIZE_CACHE_16:                /* ------- SYNCHRONIZE CACHE 16 (see Notes #19) ------- */
+             USBD_DBG_MSC_SCSI_MSG("SCSI: SYNCHRONIZE CACHE Command");
+
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+             USBD_MSC_CacheFlush(p_lun, p_err);
+#endif
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
+             break;
+
+
+        case USBD_SCSI_CMD_UNMAP:                               /* ---------------- UNMAP (see Notes #20) ------------- */
+             USBD_DBG_MSC_SCSI_MSG("SCSI: UNMAP Command");
+
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+
+             if ((p_storage_lun->LockFlag  == DEF_FALSE) ||     /* Logical unit not locked...                           */
+                 (p_storage_lun->EjectFlag == DEF_TRUE )) {     /* Logical unit has been ejected by host...             */
+                *p_err = USBD_ERR_SCSI_MEDIUM_NOTPRESENT;       /* ...medium is considered not present.                 */
+             } else {                                           /* Get logical unit status.                             */
+                 USBD_StorageStatusGet(p_storage_lun, p_err);
+             }
+
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
+             if (*p_err != USBD_ERR_NONE) {
+                 break;
+             }
+
+             if (p_storage_lun->UnmapEn == DEF_FALSE) {         /* Logical unit not thin provisioned.                   */
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                              USBD_SCSI_ASC_INVALID_CMD_OP_CODE,
+                                              0x00);
+                 break;
+             }
+
+             if (p_lun->LunInfo.ReadOnly == DEF_TRUE) {         /* Check medium is wr protected or not.                 */
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_DATA_PROTECT,
+                                              USBD_SCSI_ASC_WR_PROTECTED,
+                                              0x00);
+                 break;
+             }
+                                                                /* Get param list len.                                  */
+             len = MEM_VAL_GET_INT16U_BIG(&p_cbwcb[7]);
+             if (len > (USBD_SCSI_UNMAP_PARAM_HDR_LEN + USBD_SCSI_UNMAP_BLK_DESC_MAX_NBR * USBD_SCSI_UNMAP_BLK_DESC_LEN)) {
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                              USBD_SCSI_ASC_INVALID_FIELD_IN_CDB,
+                                              0x00);
+                 break;
+             }
+
+             p_cmd->RespLen = len;
+            *p_data_dir     = USBD_SCSI_CBW_HOST_TO_DEVICE;
+             break;
+
+
+        case USBD_SCSI_CMD_WRITE_SAME_16:                       /* ----------- WRITE SAME(16) (see Notes #21) --------- */
+             USBD_DBG_MSC_SCSI_MSG("SCSI: WRITE SAME 16 Command");
+
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+
+             if ((p_storage_lun->LockFlag  == DEF_FALSE) ||     /* Logical unit not locked...                           */
+                 (p_storage_lun->EjectFlag == DEF_TRUE )) {     /* Logical unit has been ejected by host...             */
+                *p_err = USBD_ERR_SCSI_MEDIUM_NOTPRESENT;       /* ...medium is considered not present.                 */
+             } else {                                           /* Get logical unit status.                             */
+                 USBD_StorageStatusGet(p_storage_lun, p_err);
+             }
+
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
+             if (*p_err != USBD_ERR_NONE) {
+                 break;
+             }
+
+             if (p_lun->LunInfo.ReadOnly == DEF_TRUE) {         /* Check medium is wr protected or not.                 */
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_DATA_PROTECT,
+                                              USBD_SCSI_ASC_WR_PROTECTED,
+                                              0x00);
+                 break;
+             }
+                                                                /* Get the LBA of first blk to be written.              */
+             MEM_VAL_COPY_GET_INTU_BIG(&p_cmd->LBAddr, &p_cbwcb[2], 8u);
+                                                                /* Nbr of log blks that shall be written.               */
+             p_cmd->LBCnt = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
+
+             if ((DEF_BIT_IS_SET(p_cbwcb[1], USBD_SCSI_WR_SAME_UNMAP) == DEF_YES) &&
+                 (p_storage_lun->UnmapEn                              == DEF_TRUE)) {
+                 p_cmd->WrSameUnmap = DEF_TRUE;
+             } else {
+                 p_cmd->WrSameUnmap = DEF_FALSE;
+             }
+
+             if ((p_cmd->LBCnt == 0u) ||                        /* See Note #21b.                                       */
+                ((DEF_BIT_IS_SET(p_cbwcb[1], USBD_SCSI_WR_SAME_NDOB) == DEF_YES) &&
+                 (p_cmd->WrSameUnmap                                 == DEF_FALSE))) {
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                              USBD_SCSI_ASC_INVALID_FIELD_IN_CDB,
+                                              0x00);
+                 break;
+             }
+
+             if (DEF_BIT_IS_SET(p_cbwcb[1], USBD_SCSI_WR_SAME_NDOB) == DEF_YES) {
+                 USBD_SCSI_Unmap(p_lun,                         /* See Note #21a.                                       */
+                                 p_cmd,
+                                 p_cmd->LBAddr,
+                                 p_cmd->LBCnt,
+                                 p_err);
+                 p_cmd->LBCnt = 0u;
+                 break;
+             }
+
+             p_cmd->RespLen = p_lun->BlockSize;                 /* Rx one blk to replicate.                             */
+            *p_data_dir     = USBD_SCSI_CBW_HOST_TO_DEVICE;
+             break;
+
+
         default :                                               /* Cmd not supported.                                   */
              USBD_DBG_MSC_SCSI_MSG("SCSI: UNSUPPORTED Command");
-             USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-             USBD_SCSI_RespLen    = 0;
-            *p_err                = USBD_ERR_SCSI_UNSUPPORTED_CMD;
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+             p_cmd->RespBufPtr = (CPU_INT08U *)0;
+             p_cmd->RespLen    = 0;
+            *p_err             = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
     }
 
     if (*p_err == USBD_ERR_NONE) {
-       *p_resp_len = USBD_SCSI_RespLen;                         /* SCSI supported len.                                  */
+       *p_resp_len = p_cmd->RespLen;                            /* SCSI supported len.                                  */
     }
 }
 
@@ -1220,6 +1471,8 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
 *
 * Argument(s) : p_lun           Pointer to Logical Unit information.
 *
+*               p_cmd           Pointer to the command context given to USBD_SCSI_CmdProcess().
+*
 *               scsi_cmd        SCSI command operation code.
 *
 *               p_data_buf      Pointer to receive buffer.
@@ -1242,17 +1495,20 @@ void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL  *p_lun,
 *                   REQUEST SENSE and READ. For all these SCSI commands except READ, the buffer containing
 *                   data for the host is prepared upfront during the CBW processing done in
 *                   USBD_SCSI_CmdProcess().
+*
+*               (2) When the block cache is enabled, blocks are read through it (see 'usbd_msc_cache.h').
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_DataRd (const USBD_MSC_LUN_CTRL  *p_lun,
-                              CPU_INT08U          scsi_cmd,
-                              CPU_INT08U         *p_data_buf,
-                              CPU_INT32U          data_len,
-                              CPU_INT32U         *p_ret_len,
-                              USBD_ERR           *p_err)
+void  USBD_SCSI_DataRd (USBD_MSC_LUN_CTRL  *p_lun,
+                        USBD_SCSI_CMD_CTX  *p_cmd,
+                        CPU_INT08U          scsi_cmd,
+                        CPU_INT08U         *p_data_buf,
+                        CPU_INT32U          data_len,
+                        CPU_INT32U         *p_ret_len,
+                        USBD_ERR           *p_err)
 {
-    CPU_INT32U  lb_cnt;
+    CPU_INT32U          lb_cnt;
 
 
     switch (scsi_cmd) {
@@ -1262,19 +1518,27 @@ void  USBD_SCSI_DataRd (const USBD_MSC_LUN_CTRL  *p_lun,
              USBD_DBG_MSC_SCSI_MSG("SCSI Read data from Disk.");
              lb_cnt = data_len / p_lun->BlockSize;              /* Nbr of blks that can fit in scsi_data_buf.           */
 
-             USBD_StorageRd(&USBD_SCSI_LunTbl[p_lun->LunNbr],
-                             USBD_SCSI_LBAddr,
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+             USBD_MSC_CacheRd( p_lun,                           /* See Note #2.                                         */
+                               p_cmd->LBAddr,
+                               lb_cnt,
+                               p_data_buf,
+                               p_err);
+#else
+             USBD_StorageRd(&p_lun->StorageLun,
+                             p_cmd->LBAddr,
                              lb_cnt,
                              p_data_buf,
                              p_err);
+#endif
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
              if (*p_err != USBD_ERR_NONE) {
                  return;
              }
-             USBD_SCSI_LBAddr += lb_cnt;
-             USBD_SCSI_LBCnt  -= lb_cnt;
-             if (USBD_SCSI_LBCnt > 0) {                         /* More data has to be transferred.                     */
+             p_cmd->LBAddr += lb_cnt;
+             p_cmd->LBCnt  -= lb_cnt;
+             if (p_cmd->LBCnt > 0) {                            /* More data has to be transferred.                     */
                 *p_err = USBD_ERR_SCSI_MORE_DATA;
              } else {
                 *p_err = USBD_ERR_NONE;
@@ -1284,21 +1548,148 @@ void  USBD_SCSI_DataRd (const USBD_MSC_LUN_CTRL  *p_lun,
 
 
         default:                                                /* See Note #1.                                         */
-             if (data_len < USBD_SCSI_RespLen) {                /* More data than mass sto req'd.                       */
+             if (data_len < p_cmd->RespLen) {                   /* More data than mass sto req'd.                       */
                 *p_ret_len = data_len;
                 *p_err     = USBD_ERR_SCSI_MORE_DATA;
              } else {
-                *p_ret_len = USBD_SCSI_RespLen;
+                *p_ret_len = p_cmd->RespLen;
                 *p_err     = USBD_ERR_NONE;
              }
              Mem_Copy((void *)p_data_buf,                       /* Retrieve resp buf answering SCSI cmd.                */
-                      (void *)USBD_SCSI_RespBufPtr,
+                      (void *)p_cmd->RespBufPtr,
                              *p_ret_len);
              break;
     }
 }
 
 
+/*
+**********************************************************************************************************
+*                                           USBD_SCSI_DataRdAsync()
+*
+* Description : Start reading data from the SCSI device OR copy response data to buffer, and report the
+*               outcome through a completion callback.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               p_cmd           Pointer to the command context given to USBD_SCSI_CmdProcess().
+*
+*               scsi_cmd        SCSI command operation code.
+*
+*               p_data_buf      Pointer to receive buffer.
+*
+*               data_len        Number of bytes to read.
+*
+*               async_fnct      Function called when the buffer is filled (see Note #2).
+*
+*               p_async_arg     Argument passed to 'async_fnct'.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       Read started & no more data to be read.
+*                               USBD_ERR_SCSI_MORE_DATA             Read started & more data to be read.
+*
+*                                                                   --- RETURNED BY USBD_StorageRdAsync() : ---
+*                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Reading logical unit failed.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) For the READ commands, the logical block address is advanced when the storage layer
+*                   accepts the request, so that the next part of the transfer can be started before this
+*                   one completes. Other commands are answered from the response buffer, as in
+*                   USBD_SCSI_DataRd(), and 'async_fnct' is called before returning.
+*
+*               (2) 'async_fnct' is called once if no error is returned, with the number of bytes read and
+*                   the read status (see 'usbd_scsi.h  SCSI COMPLETION CALLBACK'). The request sense data is
+*                   only updated on failure, since successful reads of a pipelined transfer may complete
+*                   out of step with the command processing.
+*
+*               (3) The completion callback is kept in the command context: all the reads in flight for a
+*                   command must be given the same callback and argument.
+*
+*               (4) When the block cache is enabled, blocks are read synchronously through it, and
+*                   'async_fnct' is called before returning (see 'usbd_cfg.h  MASS STORAGE CLASS (MSC)
+*                   CONFIGURATION  Note #6c').
+**********************************************************************************************************
+*/
+
+void  USBD_SCSI_DataRdAsync (USBD_MSC_LUN_CTRL     *p_lun,
+                             USBD_SCSI_CMD_CTX     *p_cmd,
+                             CPU_INT08U             scsi_cmd,
+                             CPU_INT08U            *p_data_buf,
+                             CPU_INT32U             data_len,
+                             USBD_SCSI_ASYNC_FNCT   async_fnct,
+                             void                  *p_async_arg,
+                             USBD_ERR              *p_err)
+{
+    CPU_INT32U          lb_cnt;
+    CPU_INT32U          ret_len;
+
+
+    switch (scsi_cmd) {
+        case USBD_SCSI_CMD_READ_10:
+        case USBD_SCSI_CMD_READ_12:
+        case USBD_SCSI_CMD_READ_16:
+             USBD_DBG_MSC_SCSI_MSG("SCSI Read data from Disk (async).");
+             lb_cnt = data_len / p_lun->BlockSize;              /* Nbr of blks that can fit in scsi_data_buf.           */
+
+             p_cmd->AsyncFnct   = async_fnct;                   /* See Note #3.                                         */
+             p_cmd->AsyncArgPtr = p_async_arg;
+             p_cmd->LunPtr      = p_lun;
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+             USBD_MSC_CacheRd(p_lun,                            /* See Note #4.                                         */
+                              p_cmd->LBAddr,
+                              lb_cnt,
+                              p_data_buf,
+                              p_err);
+             if (*p_err != USBD_ERR_NONE) {
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);
+                 return;
+             }
+             p_cmd->LBAddr += lb_cnt;
+             p_cmd->LBCnt  -= lb_cnt;
+             async_fnct(p_data_buf, data_len, p_async_arg, USBD_ERR_NONE);
+#else
+             USBD_StorageRdAsync(&p_lun->StorageLun,
+                                  p_cmd->LBAddr,
+                                  lb_cnt,
+                                  p_data_buf,
+                                  USBD_SCSI_StorageRdCmpl,
+                                  (void *)p_cmd,
+                                  p_err);
+             if (*p_err != USBD_ERR_NONE) {
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);
+                 return;
+             }
+             p_cmd->LBAddr += lb_cnt;                           /* See Note #1.                                         */
+             p_cmd->LBCnt  -= lb_cnt;
+#endif
+             if (p_cmd->LBCnt > 0) {                            /* More data has to be transferred.                     */
+                *p_err = USBD_ERR_SCSI_MORE_DATA;
+             } else {
+                *p_err = USBD_ERR_NONE;
+             }
+             break;
+
+
+        default:                                                /* See Note #1.                                         */
+             USBD_SCSI_DataRd(p_lun,
+                              p_cmd,
+                              scsi_cmd,
+                              p_data_buf,
+                              data_len,
+                             &ret_len,
+                              p_err);
+             if ((*p_err == USBD_ERR_NONE) ||
+                 (*p_err == USBD_ERR_SCSI_MORE_DATA)) {
+                 async_fnct(p_data_buf, ret_len, p_async_arg, USBD_ERR_NONE);
+             }
+             break;
+    }
+}
+
+
 /*
 **********************************************************************************************************
 *                                              USBD_SCSI_DataWr()
@@ -1307,6 +1698,8 @@ void  USBD_SCSI_DataRd (const USBD_MSC_LUN_CTRL  *p_lun,
 *
 * Argument(s) : p_lun           Pointer to Logical Unit information.
 *
+*               p_cmd           Pointer to the command context given to USBD_SCSI_CmdProcess().
+*
 *               scsi_cmd        SCSI command operation code.
 *
 *               p_data_buf      Pointer to transmit buffer.
@@ -1323,19 +1716,35 @@ void  USBD_SCSI_DataRd (const USBD_MSC_LUN_CTRL  *p_lun,
                                                                     ---- RETURNED BY USBD_StorageWr() : ---
 *                               USBD_ERR_SCSI_MEDIUM_NOTPRESENT     Writing to logical unit failed.
 *
+*                                                                   --- RETURNED BY USBD_StorageUnmap() : ---
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR        Logical block address out of range.
+*
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) When the block cache is enabled, blocks are written through it (see 'usbd_msc_cache.h').
+*
+*               (2) For WRITE SAME(16), the buffer holds the block to replicate. When the UNMAP bit was set
+*                   and the block only holds zeros, the range is unmapped instead of written, as unmapped
+*                   blocks read as zeros.
+*
+*               (3) For UNMAP, the buffer holds the whole parameter list (see 'USBD_SCSI_CmdProcess()
+*                   Note #20'). Each block descriptor is unmapped in turn; a parameter list shorter than
+*                   its header unmaps nothing.
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_DataWr (const USBD_MSC_LUN_CTRL  *p_lun,
-                              CPU_INT08U          scsi_cmd,
-                              void               *p_data_buf,
-                              CPU_INT32U          data_len,
-                              USBD_ERR           *p_err)
+void  USBD_SCSI_DataWr (USBD_MSC_LUN_CTRL  *p_lun,
+                        USBD_SCSI_CMD_CTX  *p_cmd,
+                        CPU_INT08U          scsi_cmd,
+                        void               *p_data_buf,
+                        CPU_INT32U          data_len,
+                        USBD_ERR           *p_err)
 {
-    CPU_INT32U  lb_cnt;
+    CPU_INT08U         *p_param;
+    CPU_INT64U          blk_addr;
+    CPU_INT32U          lb_cnt;
+    CPU_INT32U          desc_len;
+    CPU_INT32U          desc_off;
 
 
     switch (scsi_cmd) {
@@ -1345,19 +1754,27 @@ void  USBD_SCSI_DataWr (const USBD_MSC_LUN_CTRL  *p_lun,
              USBD_DBG_MSC_SCSI_MSG("SCSI Write data to Disk.");
              lb_cnt = data_len / (p_lun->BlockSize);            /* Nbr of blks present in scsi_data_buf.                */
 
-             USBD_StorageWr(&USBD_SCSI_LunTbl[p_lun->LunNbr],
-                             USBD_SCSI_LBAddr,
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+             USBD_MSC_CacheWr( p_lun,                           /* See Note #1.                                         */
+                               p_cmd->LBAddr,
+                               lb_cnt,
+                               p_data_buf,
+                               p_err);
+#else
+             USBD_StorageWr(&p_lun->StorageLun,
+                             p_cmd->LBAddr,
                              lb_cnt,
                              p_data_buf,
                              p_err);
+#endif
 
-             USBD_SCSI_LunStatusAnalyze(*p_err);                /* Check err code & build req sense data.               */
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);         /* Check err code & build req sense data.               */
              if (*p_err != USBD_ERR_NONE) {
                  return;
              }
-             USBD_SCSI_LBAddr += lb_cnt;
-             USBD_SCSI_LBCnt  -= lb_cnt;
-             if (USBD_SCSI_LBCnt > 0) {                         /* More data has to be xferred.                         */
+             p_cmd->LBAddr += lb_cnt;
+             p_cmd->LBCnt  -= lb_cnt;
+             if (p_cmd->LBCnt > 0) {                            /* More data has to be xferred.                         */
                 *p_err = USBD_ERR_SCSI_MORE_DATA;
              } else {
                 *p_err = USBD_ERR_NONE;
@@ -1365,9 +1782,85 @@ void  USBD_SCSI_DataWr (const USBD_MSC_LUN_CTRL  *p_lun,
              break;
 
 
+        case USBD_SCSI_CMD_UNMAP:                               /* See Note #3.                                         */
+             USBD_DBG_MSC_SCSI_MSG("SCSI Unmap blocks.");
+             p_param = (CPU_INT08U *)p_data_buf;
+
+             if (data_len >= USBD_SCSI_UNMAP_PARAM_HDR_LEN) {
+                 desc_len = MEM_VAL_GET_INT16U_BIG(&p_param[2]);
+                 desc_len = DEF_MIN(desc_len, data_len - USBD_SCSI_UNMAP_PARAM_HDR_LEN);
+             } else {
+                 desc_len = 0u;
+             }
+
+            *p_err = USBD_ERR_NONE;
+             for (desc_off  = USBD_SCSI_UNMAP_PARAM_HDR_LEN;
+                  desc_off + USBD_SCSI_UNMAP_BLK_DESC_LEN <= USBD_SCSI_UNMAP_PARAM_HDR_LEN + desc_len;
+                  desc_off += USBD_SCSI_UNMAP_BLK_DESC_LEN) {
+                 MEM_VAL_COPY_GET_INTU_BIG(&blk_addr, &p_param[desc_off], 8u);
+                 lb_cnt = MEM_VAL_GET_INT32U_BIG(&p_param[desc_off + 8u]);
+                 if (lb_cnt > 0u) {
+                     USBD_SCSI_Unmap(p_lun, p_cmd, blk_addr, lb_cnt, p_err);
+                     if (*p_err != USBD_ERR_NONE) {
+                         return;
+                     }
+                 }
+             }
+             USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);
+             break;
+
+
+        case USBD_SCSI_CMD_WRITE_SAME_16:                       /* See Note #2.                                         */
+             USBD_DBG_MSC_SCSI_MSG("SCSI Write same block to Disk.");
+             p_param = (CPU_INT08U *)p_data_buf;
+
+             if (data_len < p_lun->BlockSize) {
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                              USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                              USBD_SCSI_ASC_PARAMETER_LIST_LENGTH_ERR,
+                                              0x00);
+                 return;
+             }
+
+             if ((p_cmd->WrSameUnmap                               == DEF_TRUE) &&
+                 (USBD_SCSI_BlkIsZero(p_param, p_lun->BlockSize) == DEF_YES)) {
+                 USBD_SCSI_Unmap(p_lun, p_cmd, p_cmd->LBAddr, p_cmd->LBCnt, p_err);
+                 if (*p_err != USBD_ERR_NONE) {
+                     return;
+                 }
+                 p_cmd->LBCnt = 0u;
+             }
+
+             while (p_cmd->LBCnt > 0u) {
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+                 USBD_MSC_CacheWr( p_lun,
+                                   p_cmd->LBAddr,
+                                   1u,
+                                   p_param,
+                                   p_err);
+#else
+                 USBD_StorageWr(&p_lun->StorageLun,
+                                 p_cmd->LBAddr,
+                                 1u,
+                                 p_param,
+                                 p_err);
+#endif
+                 USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);     /* Check err code & build req sense data.               */
+                 if (*p_err != USBD_ERR_NONE) {
+                     return;
+                 }
+                 p_cmd->LBAddr++;
+                 p_cmd->LBCnt--;
+             }
+            *p_err = USBD_ERR_NONE;
+             break;
+
+
          default:
             *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
@@ -1379,10 +1872,10 @@ void  USBD_SCSI_DataWr (const USBD_MSC_LUN_CTRL  *p_lun,
 **********************************************************************************************************
 *                                              USBD_SCSI_Reset()
 *
-* Description : Reset the SCSI global variables when Bulk-Only Mass Storage Reset request is sent by the
-*               host.
+* Description : Reset the logical unit's SCSI command context when Bulk-Only Mass Storage Reset request is
+*               sent by the host.
 *
-* Argument(s) : None.
+* Argument(s) : p_lun       Pointer to Logical Unit information.
 *
 * Return(s)   : None.
 *
@@ -1390,15 +1883,21 @@ void  USBD_SCSI_DataWr (const USBD_MSC_LUN_CTRL  *p_lun,
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_Reset (void)
+void  USBD_SCSI_Reset (USBD_MSC_LUN_CTRL  *p_lun)
 {
-    USBD_SCSI_LBAddr     = 0;
-    USBD_SCSI_LBCnt      = 0;
-    USBD_SCSI_RespLen    = 0;
-    USBD_SCSI_RespBufPtr = (CPU_INT08U *)0;
-    USBD_SCSI_SenseKey   = 0;
-    USBD_SCSI_ASC        = 0;
-    USBD_SCSI_ASCQ       = 0;
+    USBD_SCSI_CMD_CTX  *p_cmd;
+
+
+    p_cmd = &p_lun->Cmd;
+
+    p_cmd->LBAddr     = 0;
+    p_cmd->LBCnt      = 0;
+    p_cmd->RespLen    = 0;
+    p_cmd->RespBufPtr = (CPU_INT08U *)0;
+    p_cmd->SenseKey   = 0;
+    p_cmd->ASC        = 0;
+    p_cmd->ASCQ       = 0;
+    p_cmd->WrSameUnmap = DEF_FALSE;
 
     USBD_DBG_MSC_SCSI_MSG("SCSI Reset");
 }
@@ -1418,10 +1917,10 @@ void  USBD_SCSI_Reset (void)
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_Conn (const USBD_MSC_LUN_CTRL  *p_lun)
+void  USBD_SCSI_Conn (USBD_MSC_LUN_CTRL  *p_lun)
 {
-    USBD_SCSI_LunTbl[p_lun->LunNbr].LockFlag  = DEF_FALSE;
-    USBD_SCSI_LunTbl[p_lun->LunNbr].EjectFlag = DEF_FALSE;
+    p_lun->StorageLun.LockFlag  = DEF_FALSE;
+    p_lun->StorageLun.EjectFlag = DEF_FALSE;
 }
 
 
@@ -1443,18 +1942,25 @@ void  USBD_SCSI_Conn (const USBD_MSC_LUN_CTRL  *p_lun)
 *                   right's click eject). In that case, the unlock operation must not be executed another
 *                   time. If a software eject has occurred, the unlock operation done upon physical
 *                   disconnection of the device must be discarded.
+*
+*               (2) The blocks held by the block cache are written back, if possible, then discarded: the
+*                   medium may be changed while the device is disconnected.
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_Unlock (const USBD_MSC_LUN_CTRL  *p_lun,
-                              USBD_ERR           *p_err)
+void  USBD_SCSI_Unlock (USBD_MSC_LUN_CTRL  *p_lun,
+                        USBD_ERR           *p_err)
 {
     USBD_STORAGE_LUN  *p_storage_lun;
 
 
-    p_storage_lun = &USBD_SCSI_LunTbl[p_lun->LunNbr];
+    p_storage_lun = &p_lun->StorageLun;
 
     if (p_storage_lun->EjectFlag == DEF_FALSE) {                /* See Note #1.                                         */
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+        USBD_MSC_CacheFlush(p_lun, p_err);                      /* See Note #2.                                         */
+        USBD_MSC_CacheInvalidate(p_lun);
+#endif
         USBD_StorageUnlock(p_storage_lun, p_err);               /* Unlock logical unit upon physical disconnect.        */
         p_storage_lun->LockFlag = DEF_FALSE;
     } else {
@@ -1479,6 +1985,8 @@ void  USBD_SCSI_Unlock (const USBD_MSC_LUN_CTRL  *p_lun,
 *
 * Argument(s) : p_lun           Pointer to Logical Unit information.
 *
+*               p_cmd           Pointer to the command context.
+*
 *               scsi_cmd        SCSI command operation code.
 *
 *               page_code       Page code.
@@ -1519,20 +2027,27 @@ void  USBD_SCSI_Unlock (const USBD_MSC_LUN_CTRL  *p_lun,
 *                   medium.
 *                   The format of Read/Write Error Recovery mode Page is specified in
 *                   'SCSI Blocks Commands - 3' (SBC-3), Revision 16, Section 6.3.5.
+*
+*               (4) The Caching mode page reports whether the device caches reads and writes. Hosts that
+*                   find the write cache enabled send SYNCHRONIZE CACHE before the medium is removed.
+*                   The format of Caching mode page is specified in 'SCSI Blocks Commands - 3' (SBC-3),
+*                   Revision 16, Section 6.3.3.
 **********************************************************************************************************
 */
 
-static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
-                                                    CPU_INT08U          scsi_cmd,
-                                                    CPU_INT08U          page_code,
-                                                    USBD_ERR           *p_err)
+static  void  USBD_SCSI_ModeSenseDataPrepare (USBD_MSC_LUN_CTRL  *p_lun,
+                                              USBD_SCSI_CMD_CTX  *p_cmd,
+                                              CPU_INT08U          scsi_cmd,
+                                              CPU_INT08U          page_code,
+                                              USBD_ERR           *p_err)
 {
-    CPU_INT08U  ix_mode_data_len;
-    CPU_INT08U  ix_medium_type;
-    CPU_INT08U  ix_dev_spec_param;
-    CPU_INT08U  ix_mode_page;
-    CPU_INT08U  ix_nxt_page;
-    CPU_INT08U  mode_param_hdr_len;
+    CPU_INT08U          ix_mode_data_len;
+    CPU_INT08U          ix_medium_type;
+    CPU_INT08U          ix_dev_spec_param;
+    CPU_INT08U          ix_mode_page;
+    CPU_INT08U          ix_nxt_page;
+    CPU_INT08U          mode_param_hdr_len;
+
 
                                                                 /* Index preparation according to MODE SENSE cmd type.  */
     if(scsi_cmd == USBD_SCSI_CMD_MODE_SENSE_06) {
@@ -1549,27 +2064,27 @@ static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
         mode_param_hdr_len = USBD_SCSI_MODE_SENSE_DATA_MODE_PARAM_HDR_10_LEN;
     }
                                                                  /* Ensure Mode Sense buf properly reset.               */
-    Mem_Clr((void     *)USBD_SCSI_ModeSenseData,
+    Mem_Clr((void     *)p_cmd->RespBuf,
             (CPU_SIZE_T)USBD_SCSI_MODE_SENSE_DATA_LEN);
 
                                                                 /* ------------------ MODE PARAM HDR ------------------ */
                                                                 /* Medium type supported by LUN.                        */
-    USBD_SCSI_ModeSenseData[ix_medium_type] = USBD_DISK_MEMORY_MEDIA;
+    p_cmd->RespBuf[ix_medium_type] = USBD_DISK_MEMORY_MEDIA;
                                                                 /* Indicate if medium is write-protected.               */
     if (p_lun->LunInfo.ReadOnly) {
-        USBD_SCSI_ModeSenseData[ix_dev_spec_param] = USBD_SCSI_MODE_SENSE_DATA_SPEC_PARAM_WR_PROT;
+        p_cmd->RespBuf[ix_dev_spec_param] = USBD_SCSI_MODE_SENSE_DATA_SPEC_PARAM_WR_PROT;
     } else {
-        USBD_SCSI_ModeSenseData[ix_dev_spec_param] = USBD_SCSI_MODE_SENSE_DATA_SPEC_PARAM_WR_EN;
+        p_cmd->RespBuf[ix_dev_spec_param] = USBD_SCSI_MODE_SENSE_DATA_SPEC_PARAM_WR_EN;
     }
 
     switch (page_code) {
         case USBD_SCSI_PAGE_CODE_INFORMATIONAL_EXCEPTIONS:      /* See Note #1.                                         */
                                                                 /* Mode Data Len.                                       */
-             USBD_SCSI_ModeSenseData[ix_mode_data_len] = mode_param_hdr_len                          +
-                                                         USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
-                                                         USBD_SCSI_PAGE_LENGTH_INFORMATIONAL_EXCEPTIONS;
+             p_cmd->RespBuf[ix_mode_data_len] = mode_param_hdr_len                          +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
+                                                USBD_SCSI_PAGE_LENGTH_INFORMATIONAL_EXCEPTIONS;
                                                                 /* --------------- BLK DESC & MODE PAGE --------------- */
-             USBD_SCSI_PageInfoExcept((void *)&USBD_SCSI_ModeSenseData[ix_mode_page]);
+             USBD_SCSI_PageInfoExcept((void *)&p_cmd->RespBuf[ix_mode_page]);
 
             *p_err = USBD_ERR_NONE;
              break;
@@ -1577,11 +2092,23 @@ static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
 
         case USBD_SCSI_PAGE_CODE_READ_WRITE_ERROR_RECOVERY:     /* See Note #2.                                         */
                                                                 /* Mode Data Len.                                       */
-             USBD_SCSI_ModeSenseData[ix_mode_data_len] = mode_param_hdr_len                          +
-                                                         USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
-                                                         USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY;
+             p_cmd->RespBuf[ix_mode_data_len] = mode_param_hdr_len                          +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
+                                                USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY;
+                                                                /* --------------- BLK DESC & MODE PAGE --------------- */
+             USBD_SCSI_PageRdWrErrRecovery((void *)&p_cmd->RespBuf[ix_mode_page]);
+
+            *p_err = USBD_ERR_NONE;
+             break;
+
+
+        case USBD_SCSI_PAGE_CODE_CACHING:                       /* See Note #4.                                         */
+                                                                /* Mode Data Len.                                       */
+             p_cmd->RespBuf[ix_mode_data_len] = mode_param_hdr_len                          +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
+                                                USBD_SCSI_PAGE_LENGTH_CACHING;
                                                                 /* --------------- BLK DESC & MODE PAGE --------------- */
-             USBD_SCSI_PageRdWrErrRecovery((void *)&USBD_SCSI_ModeSenseData[ix_mode_page]);
+             USBD_SCSI_PageCaching((void *)&p_cmd->RespBuf[ix_mode_page]);
 
             *p_err = USBD_ERR_NONE;
              break;
@@ -1589,18 +2116,24 @@ static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
 
         case USBD_SCSI_PAGE_CODE_ALL:                           /* Page Code: all pages supported by target.            */
                                                                 /* Mode Data Len.                                       */
-             USBD_SCSI_ModeSenseData[ix_mode_data_len] = mode_param_hdr_len                              +
-                                                         USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN     +
-                                                         USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY +
-                                                         USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN     +
-                                                         USBD_SCSI_PAGE_LENGTH_INFORMATIONAL_EXCEPTIONS;
+             p_cmd->RespBuf[ix_mode_data_len] = mode_param_hdr_len                              +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN     +
+                                                USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN     +
+                                                USBD_SCSI_PAGE_LENGTH_CACHING                   +
+                                                USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN     +
+                                                USBD_SCSI_PAGE_LENGTH_INFORMATIONAL_EXCEPTIONS;
                                                                 /* --------------- BLK DESC & MODE PAGE --------------- */
-             USBD_SCSI_PageRdWrErrRecovery((void *)&USBD_SCSI_ModeSenseData[ix_mode_page]);
+             USBD_SCSI_PageRdWrErrRecovery((void *)&p_cmd->RespBuf[ix_mode_page]);
 
              ix_nxt_page = ix_mode_page                                +
                            USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
                            USBD_SCSI_PAGE_LENGTH_READ_WRITE_ERROR_RECOVERY;
-             USBD_SCSI_PageInfoExcept((void *)&USBD_SCSI_ModeSenseData[ix_nxt_page]);
+             USBD_SCSI_PageCaching((void *)&p_cmd->RespBuf[ix_nxt_page]);
+
+             ix_nxt_page += USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN +
+                            USBD_SCSI_PAGE_LENGTH_CACHING;
+             USBD_SCSI_PageInfoExcept((void *)&p_cmd->RespBuf[ix_nxt_page]);
 
             *p_err = USBD_ERR_NONE;
              break;
@@ -1619,7 +2152,9 @@ static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
 *
 * Description : Update Request Sense data parameters.
 *
-* Argument(s) : sense_key           Sense key describing an error or exception condition.
+* Argument(s) : p_cmd               Pointer to the command context.
+*
+*               sense_key           Sense key describing an error or exception condition.
 *
 *               sense_code          Additional Sense Code describing sense key in detail.
 *
@@ -1631,13 +2166,14 @@ static  void  USBD_SCSI_ModeSenseDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
 **********************************************************************************************************
 */
 
-static  void  USBD_SCSI_ReqSenseDataUpdate (CPU_INT08U  sense_key,
-                                            CPU_INT08U  sense_code,
-                                            CPU_INT08U  sense_code_qual)
+static  void  USBD_SCSI_ReqSenseDataUpdate (USBD_SCSI_CMD_CTX  *p_cmd,
+                                            CPU_INT08U          sense_key,
+                                            CPU_INT08U          sense_code,
+                                            CPU_INT08U          sense_code_qual)
 {
-    USBD_SCSI_SenseKey = sense_key;
-    USBD_SCSI_ASC      = sense_code;
-    USBD_SCSI_ASCQ     = sense_code_qual;
+    p_cmd->SenseKey = sense_key;
+    p_cmd->ASC      = sense_code;
+    p_cmd->ASCQ     = sense_code_qual;
 }
 
 
@@ -1649,6 +2185,8 @@ static  void  USBD_SCSI_ReqSenseDataUpdate (CPU_INT08U  sense_key,
 *
 * Argument(s) : p_lun           Pointer to Logical Unit information.
 *
+*               p_cmd           Pointer to the command context.
+*
 *               cmdt_evpd       Inform about which type of data to prepare (Command support data or vital
 *                               product data or both or standard inquiry data).
 *
@@ -1680,46 +2218,402 @@ static  void  USBD_SCSI_ReqSenseDataUpdate (CPU_INT08U  sense_key,
 *
 *                    See 'SCSI Primary Commands - 3' (SPC-3), Revision 23, Section 6.4.2, fore more
 *                    details.
+*
+*               (2) The data is built in the response buffer of the command context :
+*
+*                   (a) Byte 2: VERSION field indicates the implemented version of this standard.
+*
+*                   (b) Byte 3: RESPONSE DATA FORMAT field value of two indicates that the data shall be
+*                       in the format defined in this standard
+*
+*                   (c) Byte 4: ADDITIONAL LENGTH field indicates the length in bytes of the remaining
+*                       standard INQUIRY data.
+*
+*               (3) The vital product data pages are specified in 'SCSI Block Commands - 3' (SBC-3),
+*                   Revision 25, Section 6.5 :
+*
+*                   (a) The Block Limits page (B0h) reports the UNMAP limits of a thin provisioned logical
+*                       unit, and that WRITE SAME must not be given a number of blocks of 0 (WSNZ bit).
+*                       The other limits are reported as not specified.
+*
+*                   (b) The Logical Block Provisioning page (B2h) is only supported by thin provisioned
+*                       logical units. It reports support for UNMAP (LBPU bit) and for WRITE SAME(16) with
+*                       the UNMAP bit (LBPWS bit), and that unmapped blocks read as zeros (LBPRZ bit).
 **********************************************************************************************************
 */
 
-static  void  USBD_SCSI_InquiryDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
-                                                  CPU_INT08U          cmdt_evpd,
-                                                  CPU_INT08U          page_code,
-                                                  USBD_ERR           *p_err)
+static  void  USBD_SCSI_InquiryDataPrepare (USBD_MSC_LUN_CTRL  *p_lun,
+                                            USBD_SCSI_CMD_CTX  *p_cmd,
+                                            CPU_INT08U          cmdt_evpd,
+                                            CPU_INT08U          page_code,
+                                            USBD_ERR           *p_err)
 {
+    USBD_STORAGE_LUN  *p_storage_lun;
+    CPU_INT32U         len;
+
+
     if (cmdt_evpd == USBD_SCSI_STD_INQUIRY_DATA) {
 
         if (page_code == 0) {                                   /* Get target info.                                     */
-            USBD_SCSI_InquiryData[0] =  USBD_SCSI_PER_DEV_TYPE_DIRECT_ACCESS_BLOCK_DEV |
-                                       (USBD_SCSI_PER_QUAL_CONN << 5);
+            Mem_Clr((void     *)&p_cmd->RespBuf[0],
+                    (CPU_SIZE_T) USBD_SCSI_INQUIRY_DATA_LEN);
+
+            p_cmd->RespBuf[0] =  USBD_SCSI_PER_DEV_TYPE_DIRECT_ACCESS_BLOCK_DEV |
+                                (USBD_SCSI_PER_QUAL_CONN << 5);
+                                                                /* See Note #2a to 2c.                                  */
+            p_cmd->RespBuf[2] =  USBD_SCSI_INQUIRY_VERS_SPC_3;
+            p_cmd->RespBuf[3] =  USBD_SCSI_INQUIRY_RESP_DATA_FMT_DEFAULT;
+            p_cmd->RespBuf[4] = (USBD_SCSI_INQUIRY_DATA_LEN - 5);
                                                                 /* Indicate medium as removable.                        */
-            DEF_BIT_SET(USBD_SCSI_InquiryData[1], USBD_SCSI_INQUIRY_RMB);
+            DEF_BIT_SET(p_cmd->RespBuf[1], USBD_SCSI_INQUIRY_RMB);
                                                                 /* Vendor ID info.                                      */
-            Mem_Copy((void *)&USBD_SCSI_InquiryData[8],
+            Mem_Copy((void *)&p_cmd->RespBuf[8],
                      (void *)&p_lun->LunInfo.VendorId[0],
                               sizeof(p_lun->LunInfo.VendorId));
 
                                                                 /* Product ID info.                                     */
-            Mem_Copy((void *)&USBD_SCSI_InquiryData[16],
+            Mem_Copy((void *)&p_cmd->RespBuf[16],
                      (void *)&p_lun->LunInfo.ProdId[0],
                               sizeof(p_lun->LunInfo.ProdId));
 
                                                                 /* Product revision level.                              */
-            Mem_Copy((void *)&USBD_SCSI_InquiryData[32],
+            Mem_Copy((void *)&p_cmd->RespBuf[32],
                      (void *)&p_lun->LunInfo.ProdRevisionLevel,
                               4u);
 
-           *p_err = USBD_ERR_NONE;
+            p_cmd->RespLen = USBD_SCSI_INQUIRY_DATA_LEN;
+           *p_err          = USBD_ERR_NONE;
         } else {
            *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;              /* Page code is not supported.                          */
         }
+    } else if (cmdt_evpd == USBD_SCSI_VPD_INQUIRY_DATA) {
+        p_storage_lun = &p_lun->StorageLun;
+        len           =  USBD_SCSI_VPD_SUPPORTED_PAGES_MAX_LEN;
+
+        Mem_Clr((void     *)&p_cmd->RespBuf[0],
+                (CPU_SIZE_T) USBD_SCSI_VPD_BLK_LIMITS_LEN);
+
+        p_cmd->RespBuf[0] =  USBD_SCSI_PER_DEV_TYPE_DIRECT_ACCESS_BLOCK_DEV |
+                            (USBD_SCSI_PER_QUAL_CONN << 5);
+        p_cmd->RespBuf[1] =  page_code;
+
+        switch (page_code) {
+            case USBD_SCSI_VPD_PAGE_SUPPORTED_PAGES:            /* List supported pages in ascending order.             */
+                 p_cmd->RespBuf[4] = USBD_SCSI_VPD_PAGE_SUPPORTED_PAGES;
+                 p_cmd->RespBuf[5] = USBD_SCSI_VPD_PAGE_BLK_LIMITS;
+                 if (p_storage_lun->UnmapEn == DEF_TRUE) {
+                     p_cmd->RespBuf[6] = USBD_SCSI_VPD_PAGE_LBP;
+                 } else {
+                     len--;
+                 }
+                *p_err = USBD_ERR_NONE;
+                 break;
+
+
+            case USBD_SCSI_VPD_PAGE_BLK_LIMITS:                 /* See Note #3a.                                        */
+                 len               = USBD_SCSI_VPD_BLK_LIMITS_LEN;
+                 p_cmd->RespBuf[4] = USBD_SCSI_VPD_BLK_LIMITS_WSNZ;
+                 if (p_storage_lun->UnmapEn == DEF_TRUE) {
+                                                                /* Max UNMAP LBA cnt: no limit.                         */
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[20], DEF_INT_32U_MAX_VAL);
+                                                                /* Max UNMAP blk desc cnt.                              */
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[24], USBD_SCSI_UNMAP_BLK_DESC_MAX_NBR);
+                                                                /* Optimal UNMAP granularity.                           */
+                     MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[28], 1u);
+                 }
+                *p_err = USBD_ERR_NONE;
+                 break;
+
+
+            case USBD_SCSI_VPD_PAGE_LBP:                        /* See Note #3b.                                        */
+                 if (p_storage_lun->UnmapEn == DEF_TRUE) {
+                     len               = USBD_SCSI_VPD_LBP_LEN;
+                     p_cmd->RespBuf[5] = USBD_SCSI_VPD_LBP_LBPU  |
+                                         USBD_SCSI_VPD_LBP_LBPWS |
+                                         USBD_SCSI_VPD_LBP_LBPRZ;
+                     p_cmd->RespBuf[6] = USBD_SCSI_VPD_LBP_PROVISIONING_TYPE_THIN;
+                    *p_err = USBD_ERR_NONE;
+                 } else {
+                    *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+                 }
+                 break;
+
+
+            default:
+                *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;         /* Page code is not supported.                          */
+                 break;
+        }
+                                                                /* Page len excludes 4-octet hdr.                       */
+        MEM_VAL_SET_INT16U_BIG(&p_cmd->RespBuf[2], len - 4u);
+        p_cmd->RespLen = len;
     } else {
        *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
     }
 }
 
 
+/*
+**********************************************************************************************************
+*                                       USBD_SCSI_StorageRdCmpl()
+*
+* Description : Storage layer completion callback of an asynchronous read started by
+*               USBD_SCSI_DataRdAsync().
+*
+* Argument(s) : p_storage_lun   Pointer to the logical unit storage structure.
+*
+*               p_data_buf      Pointer to the buffer filled by the storage layer.
+*
+*               nbr_blks        Number of blocks requested.
+*
+*               p_arg           Pointer to the command context.
+*
+*               err             Status of the read.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) See 'USBD_SCSI_DataRdAsync()  Note #2'.
+**********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_CACHE_EN == DEF_DISABLED)
+static  void  USBD_SCSI_StorageRdCmpl (USBD_STORAGE_LUN  *p_storage_lun,
+                                       CPU_INT08U        *p_data_buf,
+                                       CPU_INT32U         nbr_blks,
+                                       void              *p_arg,
+                                       USBD_ERR           err)
+{
+    USBD_SCSI_CMD_CTX  *p_cmd;
+
+
+    (void)p_storage_lun;
+
+    p_cmd = (USBD_SCSI_CMD_CTX *)p_arg;
+
+    if (err != USBD_ERR_NONE) {                                 /* See Note #1.                                         */
+        USBD_SCSI_LunStatusAnalyze(p_cmd, err);
+    }
+
+    p_cmd->AsyncFnct(p_data_buf,
+                     nbr_blks * p_cmd->LunPtr->BlockSize,
+                     p_cmd->AsyncArgPtr,
+                     err);
+}
+#endif
+
+
+
+/*
+**********************************************************************************************************
+*                                           USBD_SCSI_Unmap()
+*
+* Description : Unmap a range of blocks of a thin provisioned logical unit.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               p_cmd           Pointer to the command context.
+*
+*               blk_addr        Logical block address of first block to unmap.
+*
+*               nbr_blks        Number of blocks to unmap.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                                                                   --- RETURNED BY USBD_StorageUnmap() : ---
+*                               USBD_ERR_NONE                       Blocks successfully unmapped.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR        Logical block address out of range.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The cached blocks of the range are only discarded once the storage layer unmapped the
+*                   range, so that a rejected range leaves the dirty blocks of the cache untouched.
+**********************************************************************************************************
+*/
+
+static  void  USBD_SCSI_Unmap (USBD_MSC_LUN_CTRL  *p_lun,
+                               USBD_SCSI_CMD_CTX  *p_cmd,
+                               CPU_INT64U          blk_addr,
+                               CPU_INT32U          nbr_blks,
+                               USBD_ERR           *p_err)
+{
+    USBD_StorageUnmap(&p_lun->StorageLun,
+                       blk_addr,
+                       nbr_blks,
+                       p_err);
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    if (*p_err == USBD_ERR_NONE) {                              /* See Note #1.                                         */
+        USBD_MSC_CacheDiscard(p_lun, blk_addr, nbr_blks);
+    }
+#endif
+
+    USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);                  /* Check err code & build req sense data.               */
+}
+
+
+/*
+**********************************************************************************************************
+*                                     USBD_SCSI_LBA_StatusPrepare()
+*
+* Description : Prepare the response to a GET LBA STATUS command.
+*
+* Argument(s) : p_lun           Pointer to Logical Unit information.
+*
+*               p_cmd           Pointer to the command context.
+*
+*               p_cbwcb         Pointer to the command descriptor block.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                       Response successfully prepared.
+*                               USBD_ERR_SCSI_UNSUPPORTED_CMD       Logical unit not thin provisioned.
+*                               USBD_ERR_SCSI_LOG_BLOCK_ADDR        Logical block address out of range.
+*
+*                               See specific storage driver(s) for more error codes.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The response starts at the STARTING LOGICAL BLOCK ADDRESS of the CDB and holds one LBA
+*                   status descriptor per run of blocks sharing the same provisioning status, up to
+*                   USBD_SCSI_LBA_STATUS_DESC_MAX_NBR descriptors or the end of the medium. It is truncated
+*                   to the ALLOCATION LENGTH of the CDB, which the host uses to request the header alone.
+*
+*               (2) The blocks written through the cache are only mapped in the storage medium once
+*                   flushed, so that the cache is flushed before the storage layer is queried.
+*
+*               (3) A run of blocks longer than the NUMBER OF LOGICAL BLOCKS field is reported in several
+*                   descriptors.
+**********************************************************************************************************
+*/
+
+static  void  USBD_SCSI_LBA_StatusPrepare (      USBD_MSC_LUN_CTRL  *p_lun,
+                                                 USBD_SCSI_CMD_CTX  *p_cmd,
+                                           const CPU_INT08U         *p_cbwcb,
+                                                 USBD_ERR           *p_err)
+{
+    USBD_STORAGE_LUN  *p_storage_lun;
+    CPU_INT08U        *p_desc;
+    CPU_INT64U         blk_addr;
+    CPU_INT64U         nbr_blks_rem;
+    CPU_INT32U         nbr_blks;
+    CPU_INT32U         alloc_len;
+    CPU_INT32U         desc_nbr;
+    CPU_BOOLEAN        mapped;
+
+
+    p_storage_lun     = &p_lun->StorageLun;
+    p_cmd->RespBufPtr = (CPU_INT08U *)0;
+    p_cmd->RespLen    = 0;
+
+    if ((p_storage_lun->LockFlag  == DEF_FALSE) ||              /* Logical unit not locked...                           */
+        (p_storage_lun->EjectFlag == DEF_TRUE )) {              /* Logical unit has been ejected by host...             */
+       *p_err = USBD_ERR_SCSI_MEDIUM_NOTPRESENT;                /* ...medium is considered not present.                 */
+    } else {                                                    /* Get logical unit status.                             */
+        USBD_StorageStatusGet(p_storage_lun, p_err);
+    }
+
+    USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);                  /* Check err code & build req sense data.               */
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if (p_storage_lun->UnmapEn == DEF_FALSE) {                  /* Logical unit not thin provisioned.                   */
+       *p_err = USBD_ERR_SCSI_UNSUPPORTED_CMD;
+        USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                     USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                     USBD_SCSI_ASC_INVALID_FIELD_IN_CDB,
+                                     0x00);
+        return;
+    }
+
+    USBD_StorageCapacityGet(p_storage_lun,                      /* Get the nbr of blks and blk size.                    */
+                           &p_lun->NbrBlocks,
+                           &p_lun->BlockSize,
+                            p_err);
+    if (*p_err == USBD_ERR_NONE) {
+        MEM_VAL_COPY_GET_INTU_BIG(&blk_addr, &p_cbwcb[2], 8u);  /* Get the starting LBA.                                */
+        if (blk_addr >= p_lun->NbrBlocks) {
+           *p_err = USBD_ERR_SCSI_LOG_BLOCK_ADDR;
+        }
+    }
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    if (*p_err == USBD_ERR_NONE) {                              /* See Note #2.                                         */
+        USBD_MSC_CacheFlush(p_lun, p_err);
+    }
+#endif
+
+    USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);                  /* Check err code & build req sense data.               */
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    Mem_Clr((void     *)&p_cmd->RespBuf[0],
+            (CPU_SIZE_T) USBD_SCSI_RESP_BUF_LEN);
+
+    desc_nbr = 0u;
+    while ((desc_nbr <  USBD_SCSI_LBA_STATUS_DESC_MAX_NBR) &&   /* See Note #1.                                         */
+           (blk_addr <  p_lun->NbrBlocks)) {
+        nbr_blks_rem = p_lun->NbrBlocks - blk_addr;
+        nbr_blks     = (CPU_INT32U)DEF_MIN(nbr_blks_rem, DEF_INT_32U_MAX_VAL);
+        nbr_blks     =  USBD_StorageMapStatusGet(p_storage_lun, /* See Note #3.                                         */
+                                                 blk_addr,
+                                                 nbr_blks,
+                                                &mapped,
+                                                 p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            USBD_SCSI_LunStatusAnalyze(p_cmd, *p_err);          /* Check err code & build req sense data.               */
+            return;
+        }
+
+        p_desc = &p_cmd->RespBuf[USBD_SCSI_LBA_STATUS_PARAM_HDR_LEN + desc_nbr * USBD_SCSI_LBA_STATUS_DESC_LEN];
+        MEM_VAL_COPY_SET_INTU_BIG(&p_desc[0], &blk_addr, 8u);   /* LBA of first blk of the run.                         */
+        MEM_VAL_SET_INT32U_BIG(&p_desc[8], nbr_blks);           /* Nbr of blks of the run.                              */
+        p_desc[12] = (mapped == DEF_YES) ? USBD_SCSI_LBA_STATUS_MAPPED
+                                         : USBD_SCSI_LBA_STATUS_DEALLOCATED;
+        blk_addr  += nbr_blks;
+        desc_nbr++;
+    }
+                                                                /* Param data len, excluding the field itself.          */
+    MEM_VAL_SET_INT32U_BIG(&p_cmd->RespBuf[0], 4u + desc_nbr * USBD_SCSI_LBA_STATUS_DESC_LEN);
+
+    alloc_len         = MEM_VAL_GET_INT32U_BIG(&p_cbwcb[10]);
+    p_cmd->RespBufPtr = &p_cmd->RespBuf[0];
+    p_cmd->RespLen    = DEF_MIN(alloc_len,
+                                USBD_SCSI_LBA_STATUS_PARAM_HDR_LEN + desc_nbr * USBD_SCSI_LBA_STATUS_DESC_LEN);
+}
+
+
+/*
+**********************************************************************************************************
+*                                         USBD_SCSI_BlkIsZero()
+*
+* Description : Check if a block only holds zeros.
+*
+* Argument(s) : p_blk           Pointer to block data.
+*
+*               blk_size        Block size, in octets.
+*
+* Return(s)   : DEF_YES, if all the octets of the block are zero.
+*
+*               DEF_NO,  otherwise.
+*
+* Note(s)     : None.
+**********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_SCSI_BlkIsZero (const  CPU_INT08U  *p_blk,
+                                                 CPU_INT32U   blk_size)
+{
+    CPU_INT32U  ix;
+
+
+    for (ix = 0u; ix < blk_size; ix++) {
+        if (p_blk[ix] != 0u) {
+            return (DEF_NO);
+        }
+    }
+
+    return (DEF_YES);
+}
+
 /*
 **********************************************************************************************************
 *                                    USBD_SCSI_LunStatusAnalyze()
@@ -1727,61 +2621,88 @@ static  void  USBD_SCSI_InquiryDataPrepare (const USBD_MSC_LUN_CTRL  *p_lun,
 * Description : Update Request Sense data parameters corresponding to the error code gotten from logical
 *               unit.
 *
-* Argument(s) : err             Error code from logical unit.
+* Argument(s) : p_cmd           Pointer to the command context.
+*
+*               err             Error code from logical unit.
 *
 * Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) A write to a thin provisioned logical unit that has no space left to map the blocks is
+*                   reported as SPACE ALLOCATION FAILED WRITE PROTECT, as specified in 'SCSI Block
+*                   Commands - 3' (SBC-3), Revision 25, Section 4.7.3.6.
 **********************************************************************************************************
 */
 
-static  void  USBD_SCSI_LunStatusAnalyze (USBD_ERR  err)
+static  void  USBD_SCSI_LunStatusAnalyze (USBD_SCSI_CMD_CTX  *p_cmd,
+                                          USBD_ERR            err)
 {
     switch (err) {
         case USBD_ERR_NONE:
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NO_SENSE,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NO_SENSE,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_MEDIUM_NOTPRESENT:                   /* Target is not present.                               */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NOT_RDY,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NOT_RDY,
                                           USBD_SCSI_ASC_MEDIUM_NOT_PRESENT,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_MEDIUM_NOT_RDY_TO_RDY:               /* Target in not rdy to rdy transition.                 */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_UNIT_ATTENTION,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_UNIT_ATTENTION,
                                           USBD_SCSI_ASC_NOT_RDY_TO_RDY_CHANGE,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_MEDIUM_RDY_TO_NOT_RDY:               /* Target in rdy to not rdy transition.                 */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NOT_RDY,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NOT_RDY,
                                           USBD_SCSI_ASC_MEDIUM_NOT_PRESENT,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_LU_NOTRDY:                           /* LUN is not rdy to perform any operation.             */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_NOT_RDY,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_NOT_RDY,
                                           USBD_SCSI_ASC_LOG_UNIT_NOT_RDY,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_LU_NOTSUPPORTED:                     /* LUN is not supported.                                */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                                           USBD_SCSI_ASC_LOG_UNIT_NOT_SUPPORTED,
                                           0x00);
              break;
 
         case USBD_ERR_SCSI_LU_BUSY:                             /* LUN is busy.                                         */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_UNIT_ATTENTION,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_UNIT_ATTENTION,
                                           USBD_SCSI_ASC_NOT_RDY_TO_RDY_CHANGE,
                                           0x00);
              break;
 
+        case USBD_ERR_SCSI_LOG_BLOCK_ADDR:                      /* LBA out of range.                                    */
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                                          USBD_SCSI_ASC_LOG_BLOCK_ADDR_OUT_OF_RANGE,
+                                          0x00);
+             break;
+
+        case USBD_ERR_SCSI_SPACE_ALLOC:                         /* Thin provisioned LUN out of space (see Note #1).     */
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_DATA_PROTECT,
+                                          USBD_SCSI_ASC_WR_PROTECTED,
+                                          USBD_SCSI_ASCQ_SPACE_ALLOC_FAILED_WR_PROTECT);
+             break;
+
         default:                                                /* Err is not supported considered as hw err.           */
-             USBD_SCSI_ReqSenseDataUpdate(USBD_SCSI_SENSE_KEY_HARDWARE_ERROR,
+             USBD_SCSI_ReqSenseDataUpdate(p_cmd,
+                                          USBD_SCSI_SENSE_KEY_HARDWARE_ERROR,
                                           USBD_SCSI_ASC_NO_ADDITIONAL_SENSE_INFO,
                                           0x00);
              break;
@@ -1856,4 +2777,46 @@ static  void  USBD_SCSI_PageInfoExcept (void  *p_buf_dest)
 }
 
 
+/*
+**********************************************************************************************************
+*                                      USBD_SCSI_PageCaching()
+*
+* Description : Prepare Mode Sense Data with Caching page parameters.
+*
+* Argument(s) : p_buf_dest      Pointer to buffer that will hold Mode sense data.
+*
+* Return(s)   : None.
+*
+* Note(s)     : (1) The format of Caching mode page is specified in 'SCSI Blocks Commands - 3' (SBC-3),
+*                   Revision 16, Section 6.3.3.
+*
+*               (2) The write cache is reported enabled only with write-back (see 'usbd_cfg.h  MASS STORAGE
+*                   CLASS (MSC) CONFIGURATION  Note #6b'). The read cache is reported disabled when the
+*                   block cache is disabled.
+**********************************************************************************************************
+*/
+
+static  void  USBD_SCSI_PageCaching (void  *p_buf_dest)
+{
+    CPU_INT08U  *p_buf_dest_08;
+
+
+    p_buf_dest_08    = (CPU_INT08U *)p_buf_dest;
+
+    Mem_Clr((void     *)p_buf_dest_08,
+            (CPU_SIZE_T)(USBD_SCSI_MODE_SENSE_DATA_MODE_PAGE_HDR_LEN + USBD_SCSI_PAGE_LENGTH_CACHING));
+
+    p_buf_dest_08[0] =  USBD_SCSI_PAGE_CODE_CACHING;
+    p_buf_dest_08[1] =  USBD_SCSI_PAGE_LENGTH_CACHING;
+                                                                /* See Note #2.                                         */
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+#if (USBD_MSC_CFG_CACHE_WR_BACK_EN == DEF_ENABLED)
+    p_buf_dest_08[2] =  USBD_SCSI_MODE_SENSE_DATA_WCE;
+#endif
+#else
+    p_buf_dest_08[2] =  USBD_SCSI_MODE_SENSE_DATA_RCD;
+#endif
+}
+
+
 
@@ -60,9 +60,22 @@
 /*
 **********************************************************************************************************
 *                                                 DEFINES
+*
+* Note(s) : (1) Each logical unit of each MSC class instance is given its own storage unit number, in the
+*               order the logical units are added. The storage layer indexes its units with that number.
+*
+*           (2) The response buffer of a command context holds the data of the INQUIRY, READ CAPACITY,
+*               MODE SENSE and REQUEST SENSE commands, whichever is the longest. The Block Limits vital
+*               product data page returned by INQUIRY is 64 octets long. It also bounds the number of LBA
+*               status descriptors returned by one GET LBA STATUS command.
 **********************************************************************************************************
 */
 
+                                                                /* Nbr of storage units (see Note #1).                  */
+#define  USBD_SCSI_STORAGE_LUN_QTY               (USBD_MSC_CFG_MAX_NBR_DEV * USBD_MSC_CFG_MAX_LUN)
+
+#define  USBD_SCSI_RESP_BUF_LEN                           64u   /* See Note #2.                                         */
+
 
 /*
 **********************************************************************************************************
@@ -73,18 +86,45 @@
 /*
 **********************************************************************************************************
 *                                          STORAGE UNIT CONTROL
+*
+* Note(s) : (1) A storage driver supporting thin provisioning sets 'UnmapEn' in USBD_StorageAdd(). The
+*               SCSI layer then reports the logical unit as thin provisioned and passes the UNMAP and
+*               WRITE SAME requests to USBD_StorageUnmap(), and the GET LBA STATUS requests to
+*               USBD_StorageMapStatusGet(). Unmapped blocks must read as zeros.
 **********************************************************************************************************
 */
 
 typedef  struct  usbd_storage_lun {
-    CPU_INT08U    LunNbr;                                       /* Logical Unit Number.                                 */
+    CPU_INT08U    LunNbr;                                       /* Storage unit nbr (see 'DEFINES  Note #1').           */
     CPU_CHAR     *VolStrPtr;                                    /* String uniquely identifying a logical unit.          */
     CPU_BOOLEAN   MediumPresent;                                /* Flag indicating presence of logical unit.            */
     CPU_BOOLEAN   LockFlag;                                     /* Flag indicating logical unit locked or not.          */
     CPU_BOOLEAN   EjectFlag;                                    /* Flag indicating logical unit ejected by host or not. */
+    CPU_BOOLEAN   UnmapEn;                                      /* Flag indicating blks can be unmapped (see Note #1).  */
 } USBD_STORAGE_LUN;
 
 
+/*
+**********************************************************************************************************
+*                                     STORAGE COMPLETION CALLBACK
+*
+* Note(s) : (1) A storage completion callback is called exactly once for each request accepted by
+*               USBD_StorageRdAsync() or USBD_StorageWrAsync(), with the data buffer, the number of blocks
+*               and the argument given at submission, and the request status. It is not called when the
+*               submission itself returns an error.
+*
+*           (2) The callback may be called before the submitting function returns, or later from a storage
+*               task or from an interrupt service routine. It must not block.
+**********************************************************************************************************
+*/
+
+typedef  void  (*USBD_STORAGE_ASYNC_FNCT)(USBD_STORAGE_LUN  *p_storage_lun,
+                                          CPU_INT08U        *p_data_buf,
+                                          CPU_INT32U         nbr_blks,
+                                          void              *p_arg,
+                                          USBD_ERR           err);
+
+
 /*
 **********************************************************************************************************
 *                                        LOGICAL UNIT CHARACTERISTICS
@@ -101,70 +141,141 @@ typedef  struct  usbd_lun_info {
 
 /*
 **********************************************************************************************************
-*                                            LOGICAL UNIT CONTROL
+*                                       SCSI COMPLETION CALLBACK
+*
+* Note(s) : (1) Called by USBD_SCSI_DataRdAsync() with the number of bytes made available in the data buffer
+*               and the status of the read, under the same rules as the storage completion callback (see
+*               'STORAGE COMPLETION CALLBACK  Note(s)').
 **********************************************************************************************************
 */
 
-typedef  struct  usbd_msc_lun_ctrl {
-    CPU_INT08U       LunNbr;                                    /* LUN given by MSC IF.                                 */
-    USBD_LUN_INFO    LunInfo;                                   /* Logical unit info.                                   */
-    CPU_INT64U       NbrBlocks;                                 /* Nbr of blks supported by logical unit.               */
-    CPU_INT32U       BlockSize;                                 /* Blk size supported by logical unit.                  */
-    void            *LunArgPtr;                                 /* Ptr to the LUN specific argument.                    */
-} USBD_MSC_LUN_CTRL;
+typedef  void  (*USBD_SCSI_ASYNC_FNCT)(CPU_INT08U  *p_data_buf,
+                                       CPU_INT32U   data_len,
+                                       void        *p_arg,
+                                       USBD_ERR     err);
 
 
 /*
 **********************************************************************************************************
-*                                            GLOBAL VARIABLES
+*                                          SCSI COMMAND CONTEXT
+*
+* Note(s) : (1) The context holds the state of a command, from USBD_SCSI_CmdProcess() to its last
+*               USBD_SCSI_DataRd() or USBD_SCSI_DataWr() call, and the sense data reported by the next
+*               REQUEST SENSE command. It is provided by the caller :
+*
+*               (a) The Bulk-Only Transport uses the context embedded in each logical unit, so commands can
+*                   be in flight on all the logical units of all the MSC class instances concurrently.
+*
+*               (b) The USB Attached SCSI transport uses one context per command tag, so several commands
+*                   can be in flight on the same logical unit. The sense data of a failed command is
+*                   returned with its status rather than by a later REQUEST SENSE command.
 **********************************************************************************************************
 */
 
+typedef  struct  usbd_msc_lun_ctrl  USBD_MSC_LUN_CTRL;
+
+typedef  struct  usbd_scsi_cmd_ctx {
+    CPU_INT08U           *RespBufPtr;                           /* Ptr to data buf for Data IN phase.                   */
+    CPU_INT32U            RespLen;                              /* Buf len.                                             */
+    CPU_INT64U            LBAddr;                               /* 64-bit Logical Blk Addr.                             */
+    CPU_INT32U            LBCnt;                                /* Nbr of mem blks.                                     */
+    CPU_INT08U            SenseKey;                             /* Sense key describing an err or exception cond.       */
+    CPU_INT08U            ASC;                                  /* Additional Sense Code describing sense key in detail.*/
+    CPU_INT08U            ASCQ;                                 /* Additional Sense Code Qualifier.                     */
+    CPU_INT08U            RespBuf[USBD_SCSI_RESP_BUF_LEN];      /* Resp data buf (see 'DEFINES  Note #2').              */
+    USBD_SCSI_ASYNC_FNCT  AsyncFnct;                            /* Completion callback of async rd.                     */
+    void                 *AsyncArgPtr;                          /* Arg passed to completion callback.                   */
+    USBD_MSC_LUN_CTRL    *LunPtr;                               /* Logical unit addressed by async rd.                  */
+    CPU_BOOLEAN           WrSameUnmap;                          /* WRITE SAME may unmap blks instead of wr them.        */
+} USBD_SCSI_CMD_CTX;
+
 
 /*
 **********************************************************************************************************
-*                                                 MACRO'S
+*                                            LOGICAL UNIT CONTROL
 **********************************************************************************************************
 */
 
+struct  usbd_msc_lun_ctrl {
+    CPU_INT08U         LunNbr;                                  /* LUN given by MSC IF.                                 */
+    USBD_LUN_INFO      LunInfo;                                 /* Logical unit info.                                   */
+    CPU_INT64U         NbrBlocks;                               /* Nbr of blks supported by logical unit.               */
+    CPU_INT32U         BlockSize;                               /* Blk size supported by logical unit.                  */
+    void              *LunArgPtr;                               /* Ptr to the LUN specific argument.                    */
+#if (USBD_MSC_CFG_DATA_NBR_BUF > 1u)
+    CPU_BOOLEAN        WrPipelineEn;                            /* Pipelined WRITE data stage en'd or not.              */
+#endif
+    USBD_STORAGE_LUN   StorageLun;                              /* Storage layer logical unit.                          */
+#if (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED)
+    CPU_INT64U         CacheRdNextBlkAddr;                      /* Blk addr following last rd through blk cache.        */
+#endif
+    USBD_SCSI_CMD_CTX  Cmd;                                     /* SCSI cmd ctx (see 'SCSI COMMAND CONTEXT  Note #1a'). */
+};
+
 
 /*
 **********************************************************************************************************
-*                                           FUNCTION PROTOTYPES
+*                                            GLOBAL VARIABLES
 **********************************************************************************************************
 */
 
-void  USBD_SCSI_Init      (      USBD_ERR          *p_err);
-
-void  USBD_SCSI_LunAdd    (      CPU_INT08U         lun_nbr,
-                                 CPU_CHAR          *p_vol_str,
-                                 USBD_ERR          *p_err);
-
-void  USBD_SCSI_CmdProcess(      USBD_MSC_LUN_CTRL  *p_lun,
-                           const CPU_INT08U         *p_cbwcb,
-                                 CPU_INT32U         *p_resp_len,
-                                 CPU_INT08U         *p_data_dir,
-                                 USBD_ERR           *p_err);
-
-void  USBD_SCSI_DataRd    (const USBD_MSC_LUN_CTRL  *p_lun,
-                                 CPU_INT08U          scsi_cmd,
-                                 CPU_INT08U         *p_data_buf,
-                                 CPU_INT32U          data_len,
-                                 CPU_INT32U         *p_ret_len,
-                                 USBD_ERR           *p_err);
 
-void  USBD_SCSI_DataWr    (const USBD_MSC_LUN_CTRL  *p_lun,
-                                 CPU_INT08U          scsi_cmd,
-                                 void               *p_data_buf,
-                                 CPU_INT32U          data_len,
-                                 USBD_ERR           *p_err);
+/*
+**********************************************************************************************************
+*                                                 MACRO'S
+**********************************************************************************************************
+*/
 
-void  USBD_SCSI_Reset     (      void);
 
-void  USBD_SCSI_Conn      (const USBD_MSC_LUN_CTRL  *p_lun);
+/*
+**********************************************************************************************************
+*                                           FUNCTION PROTOTYPES
+**********************************************************************************************************
+*/
 
-void  USBD_SCSI_Unlock    (const USBD_MSC_LUN_CTRL  *p_lun,
-                                 USBD_ERR           *p_err);
+void  USBD_SCSI_Init       (      USBD_ERR              *p_err);
+
+void  USBD_SCSI_LunAdd     (      USBD_MSC_LUN_CTRL     *p_lun,
+                                  CPU_CHAR              *p_vol_str,
+                                  USBD_ERR              *p_err);
+
+void  USBD_SCSI_CmdProcess (      USBD_MSC_LUN_CTRL     *p_lun,
+                                  USBD_SCSI_CMD_CTX     *p_cmd,
+                            const CPU_INT08U            *p_cbwcb,
+                                  CPU_INT32U            *p_resp_len,
+                                  CPU_INT08U            *p_data_dir,
+                                  USBD_ERR              *p_err);
+
+void  USBD_SCSI_DataRd     (      USBD_MSC_LUN_CTRL     *p_lun,
+                                  USBD_SCSI_CMD_CTX     *p_cmd,
+                                  CPU_INT08U             scsi_cmd,
+                                  CPU_INT08U            *p_data_buf,
+                                  CPU_INT32U             data_len,
+                                  CPU_INT32U            *p_ret_len,
+                                  USBD_ERR              *p_err);
+
+void  USBD_SCSI_DataRdAsync(      USBD_MSC_LUN_CTRL     *p_lun,
+                                  USBD_SCSI_CMD_CTX     *p_cmd,
+                                  CPU_INT08U             scsi_cmd,
+                                  CPU_INT08U            *p_data_buf,
+                                  CPU_INT32U             data_len,
+                                  USBD_SCSI_ASYNC_FNCT   async_fnct,
+                                  void                  *p_async_arg,
+                                  USBD_ERR              *p_err);
+
+void  USBD_SCSI_DataWr     (      USBD_MSC_LUN_CTRL     *p_lun,
+                                  USBD_SCSI_CMD_CTX     *p_cmd,
+                                  CPU_INT08U             scsi_cmd,
+                                  void                  *p_data_buf,
+                                  CPU_INT32U             data_len,
+                                  USBD_ERR              *p_err);
+
+void  USBD_SCSI_Reset      (      USBD_MSC_LUN_CTRL     *p_lun);
+
+void  USBD_SCSI_Conn       (      USBD_MSC_LUN_CTRL     *p_lun);
+
+void  USBD_SCSI_Unlock     (      USBD_MSC_LUN_CTRL     *p_lun,
+                                  USBD_ERR              *p_err);
 
 
 /*
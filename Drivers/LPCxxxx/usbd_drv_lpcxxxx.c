@@ -646,6 +646,11 @@ USBD_DRV_API  USBD_DrvAPI_LPCXXXX_FIFO = { USBD_DrvInitFIFO,
                                            USBD_DrvEP_AbortFIFO,
                                            USBD_DrvEP_StallFIFO,
                                            USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                           DEF_NULL,
+                                           DEF_NULL,
+                                           DEF_NULL,
+#endif
                                          };
 
 
@@ -668,6 +673,11 @@ USBD_DRV_API  USBD_DrvAPI_LPCXXXX_DMA = { USBD_DrvInitDMA,
                                           USBD_DrvEP_AbortDMA,
                                           USBD_DrvEP_StallDMA,
                                           USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                          DEF_NULL,
+                                          DEF_NULL,
+                                          DEF_NULL,
+#endif
                                          };
 
 
@@ -0,0 +1,4054 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                       USB DEVICE LOOPBACK BENCHMARK
+*
+* Filename : usbd_bench.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This program runs the stack on a host workstation with the POSIX OS ports and the loopback
+*                device controller driver, and plays the USB host from its own threads. Each mode measures
+*                one path of the stack :
+*
+*                    enum  [n]                       Attach, enumeration and detach cycles.
+*                    desc  [n]                       GET_DESCRIPTOR(CONFIGURATION) round trips on a composite
+*                                                    device (3 vendor interfaces, IAD, HS + FS other-speed).
+*                    ctrl  [n] [hold_ms]             Bulk OUT completion delay while the host holds the data
+*                                                    stage of a GET_DESCRIPTOR request for 'hold_ms'.
+*                    bulk  [n] [len] [timing]        Vendor class echo of 'len'-octet transfers. 'timing' is a
+*                                                    USBD_DRV_LOOPBACK_TIMING_xxx mode.
+*                    sync  [n] [len]                 CPU cost of synchronous USBD_BulkRx() and USBD_BulkTx()
+*                                                    calls of 'len' octets on an idle endpoint.
+*                    event [n] [depth]               Delay and rate of bulk OUT completions from the driver to
+*                                                    the core task, with 'depth' reads queued.
+*                    msc   [n] [nbr_blk]             WRITE(10)/READ(10)/compare of 'nbr_blk' blocks on two MSC
+*                                                    instances (RAMDisk), one host thread per instance.
+*                    msc_rd [n] [nbr_blk]            Same as 'msc', timing READ(10) only, after the RAMDisk was
+*                                                    written once.
+*                    msc_wr [n] [nbr_blk]            Same as 'msc', timing WRITE(10) only. The last write is
+*                                                    read back and compared after the run.
+*                    uas   [n] [qd] [nbr_blk]        READ(10) of 'nbr_blk' blocks at random LBAs with the USB
+*                                                    Attached SCSI protocol, at queue depth 1 then 'qd'
+*                                                    (USBD_BENCH_CFG_MSC_UAS_EN only).
+*                    hid   [ticks] [nbr_class] [nbr_id]
+*                                                    Report descriptor parsing, SET_IDLE/GET_IDLE requests and
+*                                                    idle report timer ticks for 'nbr_class' HID instances with
+*                                                    'nbr_id' input report IDs each.
+*                    audio [ms] [pkt_per_ms]         8-channel isochronous playback stream into a simulated
+*                                                    codec, 'pkt_per_ms' 48 kHz packets per millisecond
+*                                                    (USBD_BENCH_CFG_AUDIO_EN only).
+*                    trace [n]                       USBD_DbgArg() cost (USBD_CFG_DBG_TRACE_EN only).
+*
+*            (2) The program is built from the sources below, with this directory first in the include path
+*                so that its 'usbd_cfg.h' is used. uC/CPU (POSIX port) and uC/LIB, with their configuration
+*                files, are also needed; they are not part of this source tree :
+*
+*                    cc -O2 -IDrivers/Loopback/Bench -I. -ISource <uC/CPU & uC/LIB include paths>
+*                       Drivers/Loopback/Bench/usbd_bench.c Source/usbd_*.c OS/POSIX/usbd_os.c
+*                       Drivers/Loopback/usbd_drv_loopback.c Class/Vendor/usbd_vendor.c
+*                       Class/MSC/usbd_msc.c Class/MSC/usbd_scsi.c Class/MSC/usbd_msc_cache.c
+*                       Class/MSC/Storage/RAMDisk/usbd_storage.c Class/MSC/OS/POSIX/usbd_msc_os.c
+*                       Class/HID/usbd_hid.c Class/HID/usbd_hid_report.c Class/HID/OS/POSIX/usbd_hid_os.c
+*                       <uC/CPU & uC/LIB sources> -lpthread -Wl,--wrap=USBD_HID_Report_TmrTaskHandler
+*
+*                The 'audio' mode also needs Class/Audio/usbd_audio.c, Class/Audio/usbd_audio_processing.c
+*                and Class/Audio/OS/POSIX/usbd_audio_os.c, with -DUSBD_BENCH_CFG_AUDIO_EN=DEF_ENABLED.
+*
+*                The options being compared are selected with the USBD_BENCH_CFG_xxx macros (see
+*                'usbd_cfg.h  Note #2').
+*
+*            (3) The HID timer tick is measured by wrapping USBD_HID_Report_TmrTaskHandler() at link time
+*                ('--wrap' linker option), so that the tick sent by the HID OS port is timed in place, in
+*                the CPU time of the timer thread.
+*
+*            (4) Times are read with POSIX.1-2008 clock_gettime(). The feature test macro is defined before
+*                the first include so that the program also builds in a strict ISO C compiler mode.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define  _POSIX_C_SOURCE                  200809L               /* See Note #4.                                         */
+#include  "../../../Source/usbd_core.h"
+#include  "../../../Class/Vendor/usbd_vendor.h"
+#include  "../../../Class/MSC/usbd_msc.h"
+#include  "../../../Class/HID/usbd_hid.h"
+#include  "../../../Class/HID/usbd_hid_report.h"
+#include  "../usbd_drv_loopback.h"
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+#include  "../../../Class/Audio/usbd_audio.h"
+#include  "../../../Class/Audio/usbd_audio_processing.h"
+#endif
+#include  <pthread.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <time.h>
+#if (defined(__x86_64__) || defined(__i386__))
+#include  <x86intrin.h>
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_BENCH_NS_PER_SEC                    1000000000uLL
+#define  USBD_BENCH_NS_PER_mS                        1000000uLL
+#define  USBD_BENCH_NS_PER_uS                           1000uLL
+
+#define  USBD_BENCH_CTRL_TIMEOUT_mS                     1000u
+#define  USBD_BENCH_XFER_TIMEOUT_mS                     3000u
+
+#define  USBD_BENCH_DEV_ADDR                               7u
+#define  USBD_BENCH_DESC_BUF_LEN                        1024u
+#define  USBD_BENCH_EP_MAX_PKT_SIZE_HS                   512u
+
+#define  USBD_BENCH_DESC_NBR_VENDOR                        3u   /* Nbr of vendor IFs of the 'desc' composite dev.      */
+
+#define  USBD_BENCH_CTRL_OUT_DLY_mS                        5u   /* Delay of the bulk OUT xfer after the setup pkt.     */
+
+#define  USBD_BENCH_BULK_XFER_LEN_MAX            (64u * 1024u)
+
+#if (defined(__x86_64__) || defined(__i386__))                  /* See USBD_Bench_Sync() Note #2.                       */
+#define  USBD_BENCH_TSC_EN                      DEF_ENABLED
+#else
+#define  USBD_BENCH_TSC_EN                      DEF_DISABLED
+#endif
+
+#define  USBD_BENCH_EVENT_DEPTH_MAX                        8u   /* Max nbr of reads queued by the 'event' mode.        */
+#define  USBD_BENCH_EVENT_PKT_LEN                          64u
+
+#define  USBD_BENCH_MSC_NBR_CLASS                          2u
+#define  USBD_BENCH_MSC_BLK_SIZE                         512u
+#define  USBD_BENCH_MSC_CBW_LEN                           31u
+#define  USBD_BENCH_MSC_CSW_LEN                           13u
+#define  USBD_BENCH_MSC_SCSI_TEST_UNIT_READY            0x00u
+#define  USBD_BENCH_MSC_SCSI_READ_CAPACITY_10           0x25u
+#define  USBD_BENCH_MSC_SCSI_READ_CAP_LEN                  8u
+#define  USBD_BENCH_MSC_SCSI_READ_10                    0x28u
+#define  USBD_BENCH_MSC_SCSI_WRITE_10                   0x2Au
+
+#define  USBD_BENCH_MSC_OP_WR_RD                           0u   /* WRITE(10) then READ(10) and compare.                 */
+#define  USBD_BENCH_MSC_OP_RD                              1u   /* READ(10) and compare, on a prefilled RAMDisk.        */
+#define  USBD_BENCH_MSC_OP_WR                              2u   /* WRITE(10) only, last write compared after the run.   */
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+#define  USBD_BENCH_UAS_IF_ALT_NBR                         1u
+#define  USBD_BENCH_UAS_CMD_TIMEOUT_mS                     1u   /* See 'USBD_Bench_UAS_Run()  Note #1'.                 */
+#define  USBD_BENCH_UAS_DESC_TYPE_PIPE_USAGE            0x24u
+#define  USBD_BENCH_UAS_PIPE_ID_CMD                        1u
+#define  USBD_BENCH_UAS_PIPE_ID_STATUS                     2u
+#define  USBD_BENCH_UAS_PIPE_ID_DATA_IN                    3u
+#define  USBD_BENCH_UAS_IU_ID_CMD                       0x01u
+#define  USBD_BENCH_UAS_IU_ID_SENSE                     0x03u
+#define  USBD_BENCH_UAS_IU_ID_RD_RDY                    0x06u
+#define  USBD_BENCH_UAS_IU_LEN_HDR                         4u   /* IU ID, rsvd and tag.                                 */
+#define  USBD_BENCH_UAS_IU_LEN_CMD                        32u
+#define  USBD_BENCH_UAS_IU_LEN_STATUS_MAX                 64u   /* Largest IU rx'd on the status pipe.                  */
+#define  USBD_BENCH_UAS_STATUS_GOOD                     0x00u
+#endif
+
+#define  USBD_BENCH_HID_REQ_GET_IDLE                    0x02u
+#define  USBD_BENCH_HID_REQ_SET_IDLE                    0x0Au
+#define  USBD_BENCH_HID_TICK_mS                            4u   /* Idle rate unit, and HID OS port tick period.        */
+#define  USBD_BENCH_HID_REPORT_LEN                         4u   /* Input report len, without the report ID.            */
+#define  USBD_BENCH_HID_NBR_ID_MAX                       255u
+#define  USBD_BENCH_HID_POLL_TIMEOUT_mS                  100u
+
+#define  USBD_BENCH_AUDIO_IF_NBR                           1u   /* AS IF, after the AC IF.                             */
+#define  USBD_BENCH_AUDIO_NBR_CH                           8u
+#define  USBD_BENCH_AUDIO_PKT_LEN                        768u   /* 1 ms of 48 kHz, 8 ch, 16-bit samples.               */
+#define  USBD_BENCH_AUDIO_PKT_PER_mS_MAX                   8u
+#define  USBD_BENCH_AUDIO_CODEC_BUF_NBR                    2u   /* Bufs queued to the codec DMA.                       */
+#define  USBD_BENCH_AUDIO_Q_LEN                           20u   /* Audio task queue len.                               */
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)                      /* Text mode events between waits for the dbg task.     */
+#define  USBD_BENCH_TRACE_BATCH_NBR_EVENTS     ((USBD_CFG_DBG_TRACE_NBR_EVENTS + 1u) / 2u)
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  CPU_BOOLEAN  (*USBD_BENCH_MODE_FNCT)(int     argc,
+                                              char  **argv);
+
+typedef  struct  usbd_bench_mode {
+    const  CPU_CHAR              *NamePtr;
+           USBD_BENCH_MODE_FNCT   Fnct;
+} USBD_BENCH_MODE;
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  USBD_DEV_CFG  USBD_Bench_DevCfg = {
+    0xFFFEu,                                                    /* Vendor  ID.                                          */
+    0x1234u,                                                    /* Product ID.                                          */
+    0x0100u,                                                    /* Device release number.                               */
+   "Micrium",                                                   /* Manufacturer  string.                                */
+   "Loopback Bench",                                            /* Product       string.                                */
+   "0123456789AB",                                              /* Serial number string.                                */
+    USBD_LANG_ID_ENGLISH_US
+};
+
+static  USBD_DRV_EP_INFO  USBD_Bench_EP_InfoTbl[] = {
+    {USBD_EP_INFO_TYPE_CTRL                                               | USBD_EP_INFO_DIR_OUT, 0u,  64u},
+    {USBD_EP_INFO_TYPE_CTRL                                               | USBD_EP_INFO_DIR_IN,  0u,  64u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 1u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  1u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 2u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  2u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 3u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  3u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 4u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  4u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 5u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  5u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 6u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  6u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 7u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  7u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 8u, 512u},
+    {USBD_EP_INFO_TYPE_BULK | USBD_EP_INFO_TYPE_INTR | USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  8u, 512u},
+    {                                                   USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_OUT, 9u, 1024u},
+    {                                                   USBD_EP_INFO_TYPE_ISOC | USBD_EP_INFO_DIR_IN,  9u, 1024u},
+    {DEF_BIT_NONE, 0u, 0u}
+};
+
+static  USBD_DRV_CFG  USBD_Bench_DrvCfg = {
+    0x00000000u,                                                /* Base addr, not used by the loopback drv.             */
+    0x00000000u,                                                /* Dedicated mem addr, not used.                        */
+    0u,                                                         /* Dedicated mem size, not used.                        */
+    USBD_DEV_SPD_HIGH,
+    USBD_Bench_EP_InfoTbl
+};
+
+static  USBD_BUS_FNCTS  USBD_Bench_BusFncts = {
+    DEF_NULL,                                                   /* Reset.                                               */
+    DEF_NULL,                                                   /* Suspend.                                             */
+    DEF_NULL,                                                   /* Resume.                                              */
+    DEF_NULL,                                                   /* CfgSet.                                              */
+    DEF_NULL,                                                   /* CfgClr.                                              */
+    DEF_NULL,                                                   /* Conn.                                                */
+    DEF_NULL                                                    /* Disconn.                                             */
+};
+
+static  CPU_INT08U   USBD_Bench_DevNbr;
+static  CPU_INT08U   USBD_Bench_CfgNbrHS;
+static  CPU_INT08U   USBD_Bench_CfgNbrFS;
+static  CPU_INT08U   USBD_Bench_DescBuf[USBD_BENCH_DESC_BUF_LEN];
+static  CPU_INT32U   USBD_Bench_DescLen;
+
+                                                                /* ------------------- CTRL MODE ---------------------- */
+static  CPU_INT08U   USBD_Bench_CtrlClassNbr;
+static  CPU_INT08U   USBD_Bench_CtrlEP_Out;
+static  CPU_INT64U   USBD_Bench_CtrlTxTs;
+static  CPU_INT64U   USBD_Bench_CtrlCmplTs;
+static  CPU_BOOLEAN  USBD_Bench_CtrlCmpl;
+static  pthread_mutex_t  USBD_Bench_CtrlMutex = PTHREAD_MUTEX_INITIALIZER;
+
+                                                                /* ------------------- BULK MODE ---------------------- */
+static  CPU_INT08U   USBD_Bench_BulkClassNbr;
+static  CPU_INT32U   USBD_Bench_BulkLen;
+static  CPU_INT08U   USBD_Bench_BulkDevBuf[USBD_BENCH_BULK_XFER_LEN_MAX];
+
+                                                                /* ------------------- SYNC MODE ---------------------- */
+static  CPU_INT08U   USBD_Bench_SyncEP_Out;
+static  CPU_INT08U   USBD_Bench_SyncEP_In;
+static  CPU_INT32U   USBD_Bench_SyncIterNbr;
+static  CPU_INT64U   USBD_Bench_SyncRxTime;
+static  CPU_INT64U   USBD_Bench_SyncTxTime;
+static  CPU_BOOLEAN  USBD_Bench_SyncOk;
+
+                                                                /* ------------------- EVENT MODE --------------------- */
+static  CPU_INT08U   USBD_Bench_EventDevBuf[USBD_BENCH_EVENT_DEPTH_MAX][USBD_BENCH_EP_MAX_PKT_SIZE_HS];
+static  CPU_INT32U   USBD_Bench_EventCmplNbr;
+static  CPU_INT64U   USBD_Bench_EventCmplTs;
+static  pthread_mutex_t  USBD_Bench_EventMutex = PTHREAD_MUTEX_INITIALIZER;
+static  pthread_cond_t   USBD_Bench_EventCond  = PTHREAD_COND_INITIALIZER;
+
+                                                                /* -------------------- MSC MODE ---------------------- */
+static  CPU_INT08U   USBD_Bench_MSC_EP_OutTbl[USBD_BENCH_MSC_NBR_CLASS];
+static  CPU_INT08U   USBD_Bench_MSC_EP_InTbl[USBD_BENCH_MSC_NBR_CLASS];
+static  CPU_INT32U   USBD_Bench_MSC_TagTbl[USBD_BENCH_MSC_NBR_CLASS];
+static  CPU_BOOLEAN  USBD_Bench_MSC_OkTbl[USBD_BENCH_MSC_NBR_CLASS];
+static  CPU_INT64U   USBD_Bench_MSC_TimeTbl[USBD_BENCH_MSC_NBR_CLASS];
+static  CPU_INT32U   USBD_Bench_MSC_IterNbr;
+static  CPU_INT32U   USBD_Bench_MSC_BlkNbr;
+static  CPU_INT08U   USBD_Bench_MSC_Op;
+
+                                                                /* -------------------- UAS MODE ---------------------- */
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_INT08U   USBD_Bench_UAS_EP_Cmd;
+static  CPU_INT08U   USBD_Bench_UAS_EP_Status;
+static  CPU_INT08U   USBD_Bench_UAS_EP_DataIn;
+static  CPU_INT32U   USBD_Bench_UAS_IterNbr;
+static  CPU_INT32U   USBD_Bench_UAS_BlkNbr;
+#endif
+
+                                                                /* -------------------- HID MODE ---------------------- */
+static  CPU_INT08U   USBD_Bench_HID_EP_InTbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  CPU_INT32U   USBD_Bench_HID_RxCntTbl[USBD_HID_CFG_MAX_NBR_DEV];
+static  volatile  CPU_BOOLEAN  USBD_Bench_HID_PollEn;
+static  pthread_mutex_t  USBD_Bench_HID_TickMutex = PTHREAD_MUTEX_INITIALIZER;
+static  CPU_BOOLEAN  USBD_Bench_HID_TickEn;
+static  CPU_INT64U  *USBD_Bench_HID_TickTbl;
+static  CPU_INT32U   USBD_Bench_HID_TickNbr;
+static  CPU_INT32U   USBD_Bench_HID_TickNbrMax;
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)                    /* ------------------- AUDIO MODE --------------------- */
+static  pthread_mutex_t       USBD_Bench_AudioMutex = PTHREAD_MUTEX_INITIALIZER;
+static  USBD_AUDIO_AS_HANDLE  USBD_Bench_AudioAsHandle;
+static  CPU_BOOLEAN           USBD_Bench_AudioStarted;
+static  CPU_INT08U           *USBD_Bench_AudioBufTbl[USBD_BENCH_AUDIO_CODEC_BUF_NBR];
+static  CPU_INT16U            USBD_Bench_AudioBufLenTbl[USBD_BENCH_AUDIO_CODEC_BUF_NBR];
+static  CPU_INT08U            USBD_Bench_AudioBufIxIn;
+static  CPU_INT08U            USBD_Bench_AudioBufIxOut;
+static  CPU_INT08U            USBD_Bench_AudioBufNbr;
+static  CPU_INT08U            USBD_Bench_AudioDAC_Buf[USBD_BENCH_AUDIO_PKT_LEN];
+static  CPU_BOOLEAN           USBD_Bench_AudioMuteCur;
+static  CPU_INT16U            USBD_Bench_AudioVolCur;
+static  CPU_INT32U            USBD_Bench_AudioSamplingFreq;
+static  CPU_INT32U            USBD_Bench_AudioPlayNbr;
+static  CPU_INT32U            USBD_Bench_AudioSilenceNbr;
+static  CPU_INT32U            USBD_Bench_AudioSeqErrNbr;
+static  CPU_INT32U            USBD_Bench_AudioSeqNext;
+static  CPU_INT32U            USBD_Bench_AudioTickNbr;
+static  CPU_INT32U            USBD_Bench_AudioTickPeriod_ns;
+static  CPU_INT64U           *USBD_Bench_AudioTickTbl;
+#endif
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)                      /* ------------------- TRACE MODE --------------------- */
+static  pthread_mutex_t  USBD_Bench_TraceMutex = PTHREAD_MUTEX_INITIALIZER;
+static  CPU_INT32U   USBD_Bench_TraceLineCnt;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN   USBD_Bench_Enum        (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_Desc        (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_Ctrl        (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_Bulk        (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_Sync        (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_Event       (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_MSC         (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_MSC_Rd      (int                argc,
+                                              char             **argv);
+
+static  CPU_BOOLEAN   USBD_Bench_MSC_Wr      (int                argc,
+                                              char             **argv);
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   USBD_Bench_UAS         (int                argc,
+                                              char             **argv);
+#endif
+
+static  CPU_BOOLEAN   USBD_Bench_HID         (int                argc,
+                                              char             **argv);
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   USBD_Bench_Audio       (int                argc,
+                                              char             **argv);
+#endif
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   USBD_Bench_Trace       (int                argc,
+                                              char             **argv);
+#endif
+
+static  void          USBD_Bench_CtrlRxCmpl  (CPU_INT08U         class_nbr,
+                                              void              *p_buf,
+                                              CPU_INT32U         buf_len,
+                                              CPU_INT32U         xfer_len,
+                                              void              *p_callback_arg,
+                                              USBD_ERR           err);
+
+static  void         *USBD_Bench_CtrlHostOut (void              *p_arg);
+
+static  void         *USBD_Bench_BulkDevTask (void              *p_arg);
+
+static  void         *USBD_Bench_SyncDevTask (void              *p_arg);
+
+static  void          USBD_Bench_EventRxCmpl (CPU_INT08U         dev_nbr,
+                                              CPU_INT08U         ep_addr,
+                                              void              *p_buf,
+                                              CPU_INT32U         buf_len,
+                                              CPU_INT32U         xfer_len,
+                                              void              *p_arg,
+                                              USBD_ERR           err);
+
+static  CPU_BOOLEAN   USBD_Bench_EventWait   (CPU_INT32U         cmpl_nbr,
+                                              CPU_INT64U        *p_ts);
+
+static  void         *USBD_Bench_MSC_Host    (void              *p_arg);
+
+static  CPU_BOOLEAN   USBD_Bench_MSC_Cmd     (CPU_INT08U         ix,
+                                              CPU_INT08U         op_code,
+                                              CPU_INT32U         lba,
+                                              CPU_INT08U        *p_buf,
+                                              CPU_INT32U         len);
+
+static  void          USBD_Bench_MSC_Fill    (CPU_INT08U        *p_buf,
+                                              CPU_INT32U         lba,
+                                              CPU_INT32U         len);
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN   USBD_Bench_UAS_Run     (CPU_INT32U         qd,
+                                              CPU_INT08U        *p_buf,
+                                              CPU_INT64U        *p_time,
+                                              CPU_INT32U        *p_retry_nbr);
+
+static  void          USBD_Bench_UAS_CmdTx   (CPU_INT16U         tag,
+                                              CPU_INT32U         lba,
+                                              CPU_INT32U         timeout_ms,
+                                              USBD_ERR          *p_err);
+
+static  CPU_INT08U    USBD_Bench_UAS_EP_Get  (CPU_INT08U         if_nbr,
+                                              CPU_INT08U         pipe_id);
+#endif
+
+static  void         *USBD_Bench_HID_Host    (void              *p_arg);
+
+static  CPU_INT08U    USBD_Bench_HID_RateGet (CPU_INT08U         class_ix,
+                                              CPU_INT08U         report_id);
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  void         *USBD_Bench_AudioCodec  (void                  *p_arg);
+
+static  void          USBD_Bench_AudioInit   (USBD_AUDIO_DRV        *p_audio_drv,
+                                              USBD_ERR              *p_err);
+
+static  CPU_BOOLEAN   USBD_Bench_AudioMute   (USBD_AUDIO_DRV        *p_audio_drv,
+                                              CPU_INT08U             unit_id,
+                                              CPU_INT08U             log_ch_nbr,
+                                              CPU_BOOLEAN            set_en,
+                                              CPU_BOOLEAN           *p_mute);
+
+static  CPU_BOOLEAN   USBD_Bench_AudioVol    (USBD_AUDIO_DRV        *p_audio_drv,
+                                              CPU_INT08U             req,
+                                              CPU_INT08U             unit_id,
+                                              CPU_INT08U             log_ch_nbr,
+                                              CPU_INT16U            *p_vol);
+
+static  CPU_BOOLEAN   USBD_Bench_AudioFreq   (USBD_AUDIO_DRV        *p_audio_drv,
+                                              CPU_INT08U             terminal_id_link,
+                                              CPU_BOOLEAN            set_en,
+                                              CPU_INT32U            *p_sampling_freq);
+
+static  CPU_BOOLEAN   USBD_Bench_AudioStart  (USBD_AUDIO_DRV        *p_audio_drv,
+                                              USBD_AUDIO_AS_HANDLE   as_handle,
+                                              CPU_INT08U             terminal_id_link);
+
+static  CPU_BOOLEAN   USBD_Bench_AudioStop   (USBD_AUDIO_DRV        *p_audio_drv,
+                                              CPU_INT08U             terminal_id_link);
+
+static  void          USBD_Bench_AudioTx     (USBD_AUDIO_DRV        *p_audio_drv,
+                                              CPU_INT08U             terminal_id_link,
+                                              void                  *p_buf,
+                                              CPU_INT16U             buf_len,
+                                              USBD_ERR              *p_err);
+#endif
+
+static  CPU_BOOLEAN   USBD_Bench_DevInit     (CPU_BOOLEAN        fs_en);
+
+static  CPU_BOOLEAN   USBD_Bench_DevStart    (CPU_BOOLEAN        enum_en);
+
+static  CPU_BOOLEAN   USBD_Bench_HostEnum    (void);
+
+static  CPU_INT32U    USBD_Bench_HostCtrl    (CPU_INT08U         req_type,
+                                              CPU_INT08U         req,
+                                              CPU_INT16U         val,
+                                              CPU_INT16U         ix,
+                                              CPU_INT16U         len,
+                                              CPU_INT08U        *p_buf,
+                                              USBD_ERR          *p_err);
+
+static  CPU_INT08U    USBD_Bench_EP_AddrGet  (CPU_INT08U         if_nbr,
+                                              CPU_INT08U         alt_nbr,
+                                              CPU_BOOLEAN        dir_in);
+
+static  CPU_INT32U    USBD_Bench_ArgGet      (int                argc,
+                                              char             **argv,
+                                              int                ix,
+                                              CPU_INT32U         dflt);
+
+static  CPU_INT64U    USBD_Bench_TsGet       (clockid_t          clk_id);
+
+static  void          USBD_Bench_StatPrint   (const  CPU_CHAR   *p_name,
+                                              CPU_INT64U        *p_tbl,
+                                              CPU_INT32U         nbr);
+
+static  int           USBD_Bench_StatCmp     (const  void       *p_a,
+                                              const  void       *p_b);
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+static  const  USBD_BENCH_MODE  USBD_Bench_ModeTbl[] = {
+    {"enum",   USBD_Bench_Enum  },
+    {"desc",   USBD_Bench_Desc  },
+    {"ctrl",   USBD_Bench_Ctrl  },
+    {"bulk",   USBD_Bench_Bulk  },
+    {"sync",   USBD_Bench_Sync  },
+    {"event",  USBD_Bench_Event },
+    {"msc",    USBD_Bench_MSC   },
+    {"msc_rd", USBD_Bench_MSC_Rd},
+    {"msc_wr", USBD_Bench_MSC_Wr},
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+    {"uas",    USBD_Bench_UAS   },
+#endif
+    {"hid",    USBD_Bench_HID   },
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+    {"audio",  USBD_Bench_Audio },
+#endif
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+    {"trace",  USBD_Bench_Trace },
+#endif
+};
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)                    /* Speaker: IT (USB OUT) -> FU -> OT (speaker).         */
+static  const  USBD_AUDIO_IT_CFG  USBD_Bench_AudioIT_Cfg = {
+    USBD_AUDIO_TERMINAL_TYPE_USB_STREAMING,
+    USBD_BENCH_AUDIO_NBR_CH,
+    0x00FFu,                                                    /* 7.1 ch: front, LFE, surround, center.                */
+    DEF_DISABLED,
+    USBD_AUDIO_CPL_NONE,
+   "IT USB OUT"
+};
+
+static  const  USBD_AUDIO_OT_CFG  USBD_Bench_AudioOT_Cfg = {
+    USBD_AUDIO_TERMINAL_TYPE_SPEAKER,
+    DEF_DISABLED,
+   "OT Speaker"
+};
+
+static  CPU_INT16U  USBD_Bench_AudioFU_CtrlTbl[USBD_BENCH_AUDIO_NBR_CH + 1u] = {
+   (USBD_AUDIO_FU_CTRL_MUTE | USBD_AUDIO_FU_CTRL_VOL)           /* Master ch only.                                      */
+};
+
+static  const  USBD_AUDIO_FU_CFG  USBD_Bench_AudioFU_Cfg = {
+    USBD_BENCH_AUDIO_NBR_CH,
+   &USBD_Bench_AudioFU_CtrlTbl[0u],
+   "FU Speaker"
+};
+
+static  const  USBD_AUDIO_STREAM_CFG  USBD_Bench_AudioStreamCfg = {
+    USBD_AUDIO_STREAM_NBR_BUF_18,
+    0u                                                          /* No stream correction.                                */
+};
+
+static  CPU_INT32U  USBD_Bench_AudioFreqTbl[] = {
+    USBD_AUDIO_FMT_TYPE_I_SAMFREQ_48KHZ
+};
+
+static  const  USBD_AUDIO_AS_ALT_CFG  USBD_Bench_AudioAltCfg = {
+    1u,                                                         /* Delay, in ms.                                        */
+    USBD_AUDIO_DATA_FMT_TYPE_I_PCM,
+    USBD_BENCH_AUDIO_NBR_CH,
+    USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2,
+    USBD_AUDIO_FMT_TYPE_I_BIT_RESOLUTION_16,
+    1u,
+    0u,
+    0u,
+   &USBD_Bench_AudioFreqTbl[0u],
+    DEF_NO,                                                     /* OUT EP.                                              */
+    USBD_EP_TYPE_SYNC_ADAPTIVE,
+    USBD_AUDIO_AS_EP_CTRL_SAMPLING_FREQ,
+    USBD_AUDIO_AS_EP_LOCK_DLY_UND,
+    0u,
+    0u
+};
+
+static  USBD_AUDIO_AS_ALT_CFG  *USBD_Bench_AudioAltCfgTbl[] = {
+   &USBD_Bench_AudioAltCfg
+};
+
+static  const  USBD_AUDIO_AS_IF_CFG  USBD_Bench_AudioAS_IF_Cfg = {
+   &USBD_Bench_AudioAltCfgTbl[0u],
+    1u
+};
+
+static  const  USBD_AUDIO_EVENT_FNCTS  USBD_Bench_AudioEventFncts = {
+    DEF_NULL,                                                   /* Conn.                                                */
+    DEF_NULL                                                    /* Disconn.                                             */
+};
+
+static  const  USBD_AUDIO_DRV_COMMON_API  USBD_Bench_AudioCommonAPI = {
+    USBD_Bench_AudioInit
+};
+
+static  const  USBD_AUDIO_DRV_AC_FU_API  USBD_Bench_AudioFU_API = {
+    USBD_Bench_AudioMute,
+    USBD_Bench_AudioVol,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL,
+    DEF_NULL
+};
+
+static  const  USBD_AUDIO_DRV_AS_API  USBD_Bench_AudioAS_API = {
+    USBD_Bench_AudioFreq,
+    DEF_NULL,
+    USBD_Bench_AudioStart,
+    USBD_Bench_AudioStop,
+    DEF_NULL,                                                   /* No record stream.                                    */
+    USBD_Bench_AudioTx
+};
+#endif
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+                                                                /* Vendor IF with one bulk OUT and one bulk IN EP.      */
+#define  USBD_BENCH_DESC_VENDOR_IF(if_nbr, ep_out, ep_in, max_pkt_size)                                              \
+                     USBD_DESC_STATIC_IF((if_nbr), 0u, 2u, 0xFFu, 0xFFu, 0xFFu, 0u),                                 \
+                     USBD_DESC_STATIC_EP((ep_out), USBD_EP_TYPE_BULK, (max_pkt_size), 0u),                           \
+                     USBD_DESC_STATIC_EP((ep_in),  USBD_EP_TYPE_BULK, (max_pkt_size), 0u)
+
+#define  USBD_BENCH_DESC_STATIC_LEN             (USBD_DESC_LEN_CFG            +                                      \
+                                                 USBD_DESC_LEN_IF_ASSOCIATION +                                      \
+                                                (USBD_BENCH_DESC_NBR_VENDOR * (USBD_DESC_LEN_IF + 2u * USBD_DESC_LEN_EP)))
+
+static  const  CPU_INT08U  USBD_Bench_DescStaticHS[] = {
+    USBD_DESC_STATIC_CFG(USBD_BENCH_DESC_STATIC_LEN, USBD_BENCH_DESC_NBR_VENDOR, 0u,
+                         USBD_DEV_ATTRIB_SELF_POWERED, 100u, 0u),
+    USBD_DESC_STATIC_IAD(0u, 2u, 0xFFu, 0u, 0u, 0u),
+    USBD_BENCH_DESC_VENDOR_IF(0u, 0x01u, 0x81u, 512u),
+    USBD_BENCH_DESC_VENDOR_IF(1u, 0x02u, 0x82u, 512u),
+    USBD_BENCH_DESC_VENDOR_IF(2u, 0x03u, 0x83u, 512u)
+};
+
+static  const  CPU_INT08U  USBD_Bench_DescStaticFS[] = {
+    USBD_DESC_STATIC_CFG(USBD_BENCH_DESC_STATIC_LEN, USBD_BENCH_DESC_NBR_VENDOR, 1u,
+                         USBD_DEV_ATTRIB_SELF_POWERED, 100u, 0u),
+    USBD_DESC_STATIC_IAD(0u, 2u, 0xFFu, 0u, 0u, 0u),
+    USBD_BENCH_DESC_VENDOR_IF(0u, 0x01u, 0x81u, 64u),
+    USBD_BENCH_DESC_VENDOR_IF(1u, 0x02u, 0x82u, 64u),
+    USBD_BENCH_DESC_VENDOR_IF(2u, 0x03u, 0x83u, 64u)
+};
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                               main()
+*
+* Description : Run the benchmark mode given on the command line (see Note #1).
+*
+* Argument(s) : argc        Number of command line arguments.
+*
+*               argv        Command line arguments: mode name, followed by the mode's arguments.
+*
+* Return(s)   : EXIT_SUCCESS, if the mode ran to completion and its checks passed.
+*
+*               EXIT_FAILURE, otherwise.
+*
+* Note(s)     : (1) Each run measures a single mode, since the stack can only be initialized once per
+*                   process.
+*********************************************************************************************************
+*/
+
+int  main (int     argc,
+           char  **argv)
+{
+    CPU_SIZE_T   ix;
+    CPU_BOOLEAN  ok;
+
+
+    if (argc > 1) {
+        for (ix = 0u; ix < (sizeof(USBD_Bench_ModeTbl) / sizeof(USBD_Bench_ModeTbl[0])); ix++) {
+            if (strcmp(argv[1], USBD_Bench_ModeTbl[ix].NamePtr) == 0) {
+                ok = USBD_Bench_ModeTbl[ix].Fnct(argc - 2, argv + 2);
+                return ((ok == DEF_OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+        }
+    }
+
+    printf("usage: %s <mode> [args]\nmodes:", argv[0]);
+    for (ix = 0u; ix < (sizeof(USBD_Bench_ModeTbl) / sizeof(USBD_Bench_ModeTbl[0])); ix++) {
+        printf(" %s", USBD_Bench_ModeTbl[ix].NamePtr);
+    }
+    printf("\n");
+
+    return (EXIT_FAILURE);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Enum()
+*
+* Description : Measure attach, enumeration and detach cycles of a single vendor interface device.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of cycles.
+*
+* Return(s)   : DEF_OK,   if every enumeration succeeded.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Enum (int     argc,
+                                      char  **argv)
+{
+    CPU_INT32U    iter_nbr;
+    CPU_INT32U    iter;
+    CPU_INT64U   *p_time_tbl;
+    CPU_INT64U    ts;
+    CPU_BOOLEAN   ok;
+    USBD_ERR      err;
+
+
+    iter_nbr = USBD_Bench_ArgGet(argc, argv, 0, 200u);
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    (void)USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Vendor_CfgAdd(0u, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("vendor add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    p_time_tbl = (CPU_INT64U *)malloc(iter_nbr * sizeof(CPU_INT64U));
+    if (p_time_tbl == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        USBD_DrvLoopback_HostAttach(USBD_Bench_DevNbr, &err);
+        if (err == USBD_ERR_NONE) {
+            ok = USBD_Bench_HostEnum();
+        }
+        p_time_tbl[iter] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+
+        if ((err != USBD_ERR_NONE) ||
+            (ok  != DEF_OK)) {
+            printf("enumeration %u failed\n", (unsigned)iter);
+            free(p_time_tbl);
+            return (DEF_FAIL);
+        }
+
+        USBD_DrvLoopback_HostDetach(USBD_Bench_DevNbr, &err);
+        USBD_OS_DlyMs(1u);                                      /* Let the core task process the disconnect.            */
+    }
+
+    printf("enum: %u cycles, cfg desc %u octets\n", (unsigned)iter_nbr, (unsigned)USBD_Bench_DescLen);
+    USBD_Bench_StatPrint("attach + enumeration", p_time_tbl, iter_nbr);
+    free(p_time_tbl);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Desc()
+*
+* Description : Measure GET_DESCRIPTOR(CONFIGURATION) round trips on a composite device.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of requests.
+*
+* Return(s)   : DEF_OK,   if every request returned the same descriptor.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The device has 3 vendor interfaces, the first two grouped by an IAD, in a high-speed
+*                   configuration and its full-speed other-speed configuration. With USBD_CFG_DESC_STATIC_EN,
+*                   both configurations are given a constant descriptor with the same layout.
+*
+*               (2) Both the wall clock time and the process CPU time (host and device threads) are
+*                   reported per request.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Desc (int     argc,
+                                      char  **argv)
+{
+    CPU_INT32U   iter_nbr;
+    CPU_INT32U   iter;
+    CPU_INT32U   xfer_len;
+    CPU_INT08U   class_nbr;
+    CPU_INT08U   ix;
+    CPU_INT64U   ts_wall;
+    CPU_INT64U   ts_cpu;
+    CPU_BOOLEAN  ok;
+    USBD_ERR     err;
+
+
+    iter_nbr = USBD_Bench_ArgGet(argc, argv, 0, 20000u);
+
+    ok = USBD_Bench_DevInit(DEF_YES);                           /* See Note #1.                                         */
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    USBD_CfgDescStaticSet(USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, USBD_Bench_DescStaticHS, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_CfgDescStaticSet(USBD_Bench_DevNbr, USBD_Bench_CfgNbrFS, USBD_Bench_DescStaticFS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("static descriptor set failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+#endif
+
+    for (ix = 0u; ix < USBD_BENCH_DESC_NBR_VENDOR; ix++) {
+        class_nbr = USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+        if (err == USBD_ERR_NONE) {
+            USBD_Vendor_CfgAdd(class_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+        }
+        if (err == USBD_ERR_NONE) {
+            USBD_Vendor_CfgAdd(class_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrFS, &err);
+        }
+        if (err != USBD_ERR_NONE) {
+            printf("vendor add failed (err %d)\n", (int)err);
+            return (DEF_FAIL);
+        }
+    }
+
+    (void)USBD_IF_Grp(USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, 0xFFu, 0u, 0u, 0u, 2u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_IF_Grp(USBD_Bench_DevNbr, USBD_Bench_CfgNbrFS, 0xFFu, 0u, 0u, 0u, 2u, DEF_NULL, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("IF group failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+                                                                /* See Note #2.                                         */
+    ts_wall = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    ts_cpu  = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID);
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        xfer_len = USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST,
+                                       USBD_REQ_GET_DESCRIPTOR,
+                                      (USBD_DESC_TYPE_CONFIGURATION << 8u),
+                                       0u,
+                                       USBD_BENCH_DESC_BUF_LEN - 1u,
+                                       USBD_Bench_DescBuf,
+                                      &err);
+        if ((err      != USBD_ERR_NONE) ||
+            (xfer_len != USBD_Bench_DescLen)) {
+            printf("GET_DESCRIPTOR %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_FAIL);
+        }
+    }
+    ts_cpu  = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID) - ts_cpu;
+    ts_wall = USBD_Bench_TsGet(CLOCK_MONOTONIC)          - ts_wall;
+
+    printf("desc: %u x GET_DESCRIPTOR(cfg), %u octets: wall %.2f us/req, cpu %.2f us/req\n",
+           (unsigned)iter_nbr,
+           (unsigned)USBD_Bench_DescLen,
+           (double)ts_wall / iter_nbr / USBD_BENCH_NS_PER_uS,
+           (double)ts_cpu  / iter_nbr / USBD_BENCH_NS_PER_uS);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Ctrl()
+*
+* Description : Measure the completion delay of a bulk OUT transfer while the host is slow to run the data
+*               stage of a standard request.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of iterations, [hold_ms] data stage delay.
+*
+* Return(s)   : DEF_OK,   if every bulk transfer completed.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The host sends a GET_DESCRIPTOR(CONFIGURATION) setup packet and only reads its data stage
+*                   'hold_ms' later. A second host thread sends a bulk OUT transfer to a vendor interface
+*                   USBD_BENCH_CTRL_OUT_DLY_mS after the setup packet. The delay is measured from the start
+*                   of that transfer to the device completion callback.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Ctrl (int     argc,
+                                      char  **argv)
+{
+    CPU_INT32U   iter_nbr;
+    CPU_INT32U   hold_ms;
+    CPU_INT32U   iter;
+    CPU_INT32U   cmpl_nbr;
+    CPU_INT32U   dly_ms;
+    CPU_INT64U  *p_time_tbl;
+    CPU_INT08U   setup[8u];
+    CPU_BOOLEAN  cmpl;
+    CPU_BOOLEAN  ok;
+    pthread_t    thread;
+    USBD_ERR     err;
+
+
+    iter_nbr = USBD_Bench_ArgGet(argc, argv, 0, 20u);
+    hold_ms  = USBD_Bench_ArgGet(argc, argv, 1, 50u);
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    USBD_Bench_CtrlClassNbr = USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Vendor_CfgAdd(USBD_Bench_CtrlClassNbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("vendor add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    USBD_Bench_CtrlEP_Out = USBD_Bench_EP_AddrGet(0u, 0u, DEF_NO);
+
+    p_time_tbl = (CPU_INT64U *)malloc(iter_nbr * sizeof(CPU_INT64U));
+    if (p_time_tbl == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    cmpl_nbr = 0u;
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        (void)pthread_mutex_lock(&USBD_Bench_CtrlMutex);
+        USBD_Bench_CtrlCmpl = DEF_NO;
+        (void)pthread_mutex_unlock(&USBD_Bench_CtrlMutex);
+
+        USBD_Vendor_RdAsync(USBD_Bench_CtrlClassNbr,
+                            USBD_Bench_BulkDevBuf,
+                            USBD_BENCH_EP_MAX_PKT_SIZE_HS,
+                            USBD_Bench_CtrlRxCmpl,
+                            DEF_NULL,
+                           &err);
+        if (err != USBD_ERR_NONE) {
+            printf("vendor read failed (err %d)\n", (int)err);
+            break;
+        }
+
+        setup[0] = USBD_REQ_DIR_DEVICE_TO_HOST;                 /* See Note #1.                                         */
+        setup[1] = USBD_REQ_GET_DESCRIPTOR;
+        setup[2] = 0u;
+        setup[3] = USBD_DESC_TYPE_CONFIGURATION;
+        setup[4] = 0u;
+        setup[5] = 0u;
+        setup[6] = 0xFFu;
+        setup[7] = 0u;
+
+        (void)pthread_create(&thread, DEF_NULL, USBD_Bench_CtrlHostOut, DEF_NULL);
+        USBD_DrvLoopback_HostSetup(USBD_Bench_DevNbr, setup, &err);
+        USBD_OS_DlyMs(hold_ms);
+        (void)USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, 0x80u, USBD_Bench_DescBuf, 0xFFu,
+                                      USBD_BENCH_CTRL_TIMEOUT_mS, &err);
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, 0x00u, DEF_NULL, 0u, DEF_YES,
+                                           USBD_BENCH_CTRL_TIMEOUT_mS, &err);
+        }
+        (void)pthread_join(thread, DEF_NULL);
+        if (err != USBD_ERR_NONE) {
+            printf("control read failed (err %d)\n", (int)err);
+            break;
+        }
+
+        cmpl = DEF_NO;
+        for (dly_ms = 0u; (dly_ms < USBD_BENCH_XFER_TIMEOUT_mS) && (cmpl == DEF_NO); dly_ms++) {
+            (void)pthread_mutex_lock(&USBD_Bench_CtrlMutex);
+            cmpl = USBD_Bench_CtrlCmpl;
+            (void)pthread_mutex_unlock(&USBD_Bench_CtrlMutex);
+            if (cmpl == DEF_NO) {
+                USBD_OS_DlyMs(1u);
+            }
+        }
+        if (cmpl == DEF_NO) {
+            printf("bulk OUT %u did not complete\n", (unsigned)iter);
+            break;
+        }
+
+        p_time_tbl[cmpl_nbr] = USBD_Bench_CtrlCmplTs - USBD_Bench_CtrlTxTs;
+        cmpl_nbr++;
+    }
+
+    printf("ctrl: bulk OUT completion delay during a %u ms control read, async %s\n",
+           (unsigned)hold_ms,
+           (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED) ? "enabled" : "disabled");
+    USBD_Bench_StatPrint("bulk OUT completion", p_time_tbl, cmpl_nbr);
+    free(p_time_tbl);
+
+    return ((cmpl_nbr == iter_nbr) ? DEF_OK : DEF_FAIL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_CtrlRxCmpl()
+*
+* Description : Record the completion time of the 'ctrl' mode bulk OUT transfer.
+*
+* Argument(s) : class_nbr       Class instance number.
+*
+*               p_buf           Pointer to receive buffer.
+*
+*               buf_len         Buffer length, in octets.
+*
+*               xfer_len        Number of octets received.
+*
+*               p_callback_arg  Callback argument (not used).
+*
+*               err             Transfer result.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_Bench_CtrlRxCmpl (CPU_INT08U   class_nbr,
+                                     void        *p_buf,
+                                     CPU_INT32U   buf_len,
+                                     CPU_INT32U   xfer_len,
+                                     void        *p_callback_arg,
+                                     USBD_ERR     err)
+{
+    (void)class_nbr;
+    (void)p_buf;
+    (void)buf_len;
+    (void)xfer_len;
+    (void)p_callback_arg;
+    (void)err;
+
+    (void)pthread_mutex_lock(&USBD_Bench_CtrlMutex);
+    USBD_Bench_CtrlCmplTs = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    USBD_Bench_CtrlCmpl   = DEF_YES;
+    (void)pthread_mutex_unlock(&USBD_Bench_CtrlMutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Bench_CtrlHostOut()
+*
+* Description : Host thread sending the 'ctrl' mode bulk OUT transfer.
+*
+* Argument(s) : p_arg       Thread argument (not used).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_Bench_CtrlHostOut (void  *p_arg)
+{
+    CPU_INT08U  buf[64u];
+    USBD_ERR    err;
+
+
+    (void)p_arg;
+
+    Mem_Clr(buf, sizeof(buf));
+    USBD_OS_DlyMs(USBD_BENCH_CTRL_OUT_DLY_mS);
+
+    USBD_Bench_CtrlTxTs = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr,
+                                   USBD_Bench_CtrlEP_Out,
+                                   buf,
+                                   sizeof(buf),
+                                   DEF_YES,
+                                   USBD_BENCH_XFER_TIMEOUT_mS,
+                                  &err);
+    if (err != USBD_ERR_NONE) {
+        printf("bulk OUT failed (err %d)\n", (int)err);
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Bulk()
+*
+* Description : Measure vendor class bulk echo throughput.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of transfers, [len] transfer length, [timing] bus
+*                           timing mode.
+*
+* Return(s)   : DEF_OK,   if every transfer was echoed unchanged.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) A device thread reads each OUT transfer with USBD_Vendor_Rd() and writes it back with
+*                   USBD_Vendor_Wr(). The throughput counts the octets moved in both directions.
+*
+*               (2) With USBD_CFG_DBG_STATS_PERF_EN, the per-stage latency percentiles and the throughput
+*                   meter of both bulk endpoints are printed after the run.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Bulk (int     argc,
+                                      char  **argv)
+{
+    CPU_INT32U    iter_nbr;
+    CPU_INT32U    iter;
+    CPU_INT32U    xfer_len;
+    CPU_INT32U    ix;
+    CPU_INT08U    timing;
+    CPU_INT08U    ep_out;
+    CPU_INT08U    ep_in;
+    CPU_INT08U   *p_tx_buf;
+    CPU_INT08U   *p_rx_buf;
+    CPU_INT64U    ts;
+    CPU_BOOLEAN   ok;
+    pthread_t     thread;
+    USBD_ERR      err;
+
+
+    iter_nbr          = USBD_Bench_ArgGet(argc, argv, 0, 2000u);
+    USBD_Bench_BulkLen = USBD_Bench_ArgGet(argc, argv, 1, 16u * 1024u);
+    timing            = (CPU_INT08U)USBD_Bench_ArgGet(argc, argv, 2, USBD_DRV_LOOPBACK_TIMING_VIRTUAL);
+    if ((USBD_Bench_BulkLen == 0u) ||
+        (USBD_Bench_BulkLen >  USBD_BENCH_BULK_XFER_LEN_MAX)) {
+        printf("len must be 1..%u\n", (unsigned)USBD_BENCH_BULK_XFER_LEN_MAX);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    USBD_Bench_BulkClassNbr = USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Vendor_CfgAdd(USBD_Bench_BulkClassNbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("vendor add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    ep_out = USBD_Bench_EP_AddrGet(0u, 0u, DEF_NO);
+    ep_in  = USBD_Bench_EP_AddrGet(0u, 0u, DEF_YES);
+
+    (void)pthread_create(&thread, DEF_NULL, USBD_Bench_BulkDevTask, DEF_NULL);
+    (void)pthread_detach(thread);
+
+    p_tx_buf = (CPU_INT08U *)malloc(USBD_Bench_BulkLen);
+    p_rx_buf = (CPU_INT08U *)malloc(USBD_Bench_BulkLen);
+    if ((p_tx_buf == DEF_NULL) ||
+        (p_rx_buf == DEF_NULL)) {
+        return (DEF_FAIL);
+    }
+    for (ix = 0u; ix < USBD_Bench_BulkLen; ix++) {
+        p_tx_buf[ix] = (CPU_INT08U)(ix * 7u + 3u);
+    }
+
+    USBD_DrvLoopback_TimingSet(USBD_Bench_DevNbr, timing);
+    USBD_DrvLoopback_HostAttach(USBD_Bench_DevNbr, &err);       /* Restart the bus clock.                               */
+    ok = USBD_Bench_HostEnum();
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        p_tx_buf[0] = (CPU_INT08U)iter;
+
+        xfer_len = USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, ep_out, p_tx_buf, USBD_Bench_BulkLen, DEF_NO,
+                                            USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if ((err == USBD_ERR_NONE) && (xfer_len == USBD_Bench_BulkLen)) {
+            xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, ep_in, p_rx_buf, USBD_Bench_BulkLen,
+                                               USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        }
+        if ((err      != USBD_ERR_NONE)      ||
+            (xfer_len != USBD_Bench_BulkLen) ||
+            (memcmp(p_tx_buf, p_rx_buf, USBD_Bench_BulkLen) != 0)) {
+            printf("echo %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_FAIL);
+        }
+    }
+    ts = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+
+    printf("bulk: %u x %u octets echoed: %.1f MB/s, %.2f us/xfer, bus time %.3f s, event ring %s\n",
+           (unsigned)iter_nbr,
+           (unsigned)USBD_Bench_BulkLen,
+           2.0 * iter_nbr * USBD_Bench_BulkLen * USBD_BENCH_NS_PER_SEC / ts / 1e6,
+           (double)ts / (2u * iter_nbr) / USBD_BENCH_NS_PER_uS,
+           (double)USBD_DrvLoopback_BusTimeGet(USBD_Bench_DevNbr) / USBD_BENCH_NS_PER_SEC,
+           (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED) ? "enabled" : "disabled");
+
+#if ((USBD_CFG_DBG_STATS_EN      == DEF_ENABLED) && \
+     (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED))               /* See Note #2.                                         */
+    {
+        static  const  CPU_CHAR  *stage_name_tbl[] = {"submit", "xfer", "cmpl", "total"};
+        USBD_DBG_STATS_EP_PERF    perf;
+        CPU_INT08U                ep_addr;
+        CPU_INT08U                stage;
+
+
+        for (ix = 0u; ix < 2u; ix++) {
+            ep_addr = (ix == 0u) ? ep_out : ep_in;
+            USBD_DbgStatsEP_PerfSnapshot(USBD_Bench_DevNbr, ep_addr, &perf, DEF_NO, &err);
+            if (err != USBD_ERR_NONE) {
+                continue;
+            }
+            printf("  EP 0x%02X: %u xfers, %llu octets, rate %u B/s\n",
+                   (unsigned)ep_addr,
+                   (unsigned)perf.XferNbr,
+                   (unsigned long long)perf.OctetCnt,
+                   (unsigned)USBD_DbgStatsEP_RateGet(USBD_Bench_DevNbr, ep_addr, &err));
+            for (stage = 0u; stage < 4u; stage++) {
+                printf("    %-6s p50 %6u  p90 %6u  p99 %6u  max %6u us\n",
+                       stage_name_tbl[stage],
+                       (unsigned)USBD_DbgStatsEP_LatGet(USBD_Bench_DevNbr, ep_addr, stage,  50u, &err),
+                       (unsigned)USBD_DbgStatsEP_LatGet(USBD_Bench_DevNbr, ep_addr, stage,  90u, &err),
+                       (unsigned)USBD_DbgStatsEP_LatGet(USBD_Bench_DevNbr, ep_addr, stage,  99u, &err),
+                       (unsigned)USBD_DbgStatsEP_LatGet(USBD_Bench_DevNbr, ep_addr, stage, 100u, &err));
+            }
+        }
+    }
+#endif
+
+    free(p_tx_buf);
+    free(p_rx_buf);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Bench_BulkDevTask()
+*
+* Description : Device thread echoing the 'bulk' mode transfers (see USBD_Bench_Bulk() Note #1).
+*
+* Argument(s) : p_arg       Thread argument (not used).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_Bench_BulkDevTask (void  *p_arg)
+{
+    CPU_INT32U  xfer_len;
+    USBD_ERR    err;
+
+
+    (void)p_arg;
+
+    while (USBD_Vendor_IsConn(USBD_Bench_BulkClassNbr) == DEF_NO) {
+        USBD_OS_DlyMs(1u);
+    }
+
+    for (;;) {
+        xfer_len = USBD_Vendor_Rd(USBD_Bench_BulkClassNbr,
+                                  USBD_Bench_BulkDevBuf,
+                                  USBD_Bench_BulkLen,
+                                  0u,
+                                 &err);
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_Vendor_Wr(USBD_Bench_BulkClassNbr,
+                                 USBD_Bench_BulkDevBuf,
+                                 xfer_len,
+                                 0u,
+                                 DEF_NO,
+                                &err);
+        }
+        if (err != USBD_ERR_NONE) {
+            USBD_OS_DlyMs(1u);
+        }
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Sync()
+*
+* Description : Measure the CPU cost of synchronous bulk transfers.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of calls per direction, [len] transfer length.
+*
+* Return(s)   : DEF_OK,   if every transfer completed.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) A device thread calls USBD_BulkRx() 'n' times on the bulk OUT endpoint of a vendor
+*                   interface, then USBD_BulkTx() 'n' times on its bulk IN endpoint, while the host sends
+*                   and reads the matching transfers. Each call finds its endpoint idle, which is the case
+*                   served by the embedded URB of USBD_CFG_EP_SYNC_URB_EN (see 'usbd_cfg.h  Note #3').
+*                   The CPU time of the device thread in each phase is divided by 'n'. It covers the call,
+*                   including its pend on the OS port, but neither the host side of the loopback driver
+*                   nor the core task.
+*
+*               (2) On x86 targets, the CPU time is also converted to time-stamp counter cycles. The rate
+*                   of the counter is measured against the monotonic clock before the run.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Sync (int     argc,
+                                      char  **argv)
+{
+    CPU_INT32U    iter;
+    CPU_INT32U    xfer_len;
+    CPU_INT32U    ix;
+    CPU_INT08U   *p_buf;
+    double        cycles_per_ns;
+    CPU_BOOLEAN   ok;
+    pthread_t     thread;
+    USBD_ERR      err;
+#if (USBD_BENCH_TSC_EN == DEF_ENABLED)
+    CPU_INT64U    ts;
+    CPU_INT64U    tsc;
+#endif
+
+
+    USBD_Bench_SyncIterNbr = USBD_Bench_ArgGet(argc, argv, 0, 20000u);
+    USBD_Bench_BulkLen     = USBD_Bench_ArgGet(argc, argv, 1, USBD_BENCH_EP_MAX_PKT_SIZE_HS);
+    if ((USBD_Bench_SyncIterNbr == 0u) ||
+        (USBD_Bench_BulkLen     == 0u) ||
+        (USBD_Bench_BulkLen     >  USBD_BENCH_BULK_XFER_LEN_MAX)) {
+        printf("n must be > 0 and len 1..%u\n", (unsigned)USBD_BENCH_BULK_XFER_LEN_MAX);
+        return (DEF_FAIL);
+    }
+
+    cycles_per_ns = 0.0;
+#if (USBD_BENCH_TSC_EN == DEF_ENABLED)                          /* See Note #2.                                         */
+    ts  = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    tsc = __rdtsc();
+    USBD_OS_DlyMs(50u);
+    tsc = __rdtsc() - tsc;
+    ts  = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+    cycles_per_ns = (double)tsc / ts;
+#endif
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    USBD_Bench_BulkClassNbr = USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Vendor_CfgAdd(USBD_Bench_BulkClassNbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("vendor add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    USBD_Bench_SyncEP_Out = USBD_Bench_EP_AddrGet(0u, 0u, DEF_NO);
+    USBD_Bench_SyncEP_In  = USBD_Bench_EP_AddrGet(0u, 0u, DEF_YES);
+
+    p_buf = (CPU_INT08U *)malloc(USBD_Bench_BulkLen);
+    if (p_buf == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+    for (ix = 0u; ix < USBD_Bench_BulkLen; ix++) {
+        p_buf[ix] = (CPU_INT08U)(ix * 7u + 3u);
+    }
+
+    (void)pthread_create(&thread, DEF_NULL, USBD_Bench_SyncDevTask, DEF_NULL);
+
+    for (iter = 0u; iter < USBD_Bench_SyncIterNbr; iter++) {
+        xfer_len = USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, USBD_Bench_SyncEP_Out, p_buf, USBD_Bench_BulkLen,
+                                            DEF_NO, USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if ((err != USBD_ERR_NONE) || (xfer_len != USBD_Bench_BulkLen)) {
+            printf("OUT %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_FAIL);
+        }
+    }
+    for (iter = 0u; iter < USBD_Bench_SyncIterNbr; iter++) {
+        xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, USBD_Bench_SyncEP_In, p_buf, USBD_Bench_BulkLen,
+                                           USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if ((err != USBD_ERR_NONE) || (xfer_len != USBD_Bench_BulkLen)) {
+            printf("IN %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_FAIL);
+        }
+    }
+    (void)pthread_join(thread, DEF_NULL);
+    free(p_buf);
+    if (USBD_Bench_SyncOk != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    printf("sync: %u x %u octets, embedded URB %s\n",
+           (unsigned)USBD_Bench_SyncIterNbr,
+           (unsigned)USBD_Bench_BulkLen,
+           (USBD_CFG_EP_SYNC_URB_EN == DEF_ENABLED) ? "enabled" : "disabled");
+    for (ix = 0u; ix < 2u; ix++) {
+        printf("  %s: %8.1f ns CPU/call",
+               (ix == 0u) ? "USBD_BulkRx()" : "USBD_BulkTx()",
+               (double)((ix == 0u) ? USBD_Bench_SyncRxTime : USBD_Bench_SyncTxTime) / USBD_Bench_SyncIterNbr);
+        if (cycles_per_ns != 0.0) {
+            printf(", %7.0f cycles/call",
+                   (double)((ix == 0u) ? USBD_Bench_SyncRxTime : USBD_Bench_SyncTxTime) * cycles_per_ns /
+                   USBD_Bench_SyncIterNbr);
+        }
+        printf("\n");
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Bench_SyncDevTask()
+*
+* Description : Device thread of the 'sync' mode (see USBD_Bench_Sync() Note #1).
+*
+* Argument(s) : p_arg       Thread argument (not used).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_Bench_SyncDevTask (void  *p_arg)
+{
+    CPU_INT32U  iter;
+    CPU_INT32U  xfer_len;
+    CPU_INT64U  ts;
+    USBD_ERR    err;
+
+
+    (void)p_arg;
+
+    USBD_Bench_SyncOk = DEF_FAIL;
+    ts = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID);
+    for (iter = 0u; iter < USBD_Bench_SyncIterNbr; iter++) {
+        xfer_len = USBD_BulkRx(USBD_Bench_DevNbr,
+                               USBD_Bench_SyncEP_Out,
+                               USBD_Bench_BulkDevBuf,
+                               USBD_Bench_BulkLen,
+                               USBD_BENCH_XFER_TIMEOUT_mS,
+                              &err);
+        if ((err != USBD_ERR_NONE) || (xfer_len != USBD_Bench_BulkLen)) {
+            printf("USBD_BulkRx() %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_NULL);
+        }
+    }
+    USBD_Bench_SyncRxTime = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID) - ts;
+
+    ts = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID);
+    for (iter = 0u; iter < USBD_Bench_SyncIterNbr; iter++) {
+        xfer_len = USBD_BulkTx(USBD_Bench_DevNbr,
+                               USBD_Bench_SyncEP_In,
+                               USBD_Bench_BulkDevBuf,
+                               USBD_Bench_BulkLen,
+                               USBD_BENCH_XFER_TIMEOUT_mS,
+                               DEF_NO,
+                              &err);
+        if ((err != USBD_ERR_NONE) || (xfer_len != USBD_Bench_BulkLen)) {
+            printf("USBD_BulkTx() %u failed (err %d, len %u)\n", (unsigned)iter, (int)err, (unsigned)xfer_len);
+            return (DEF_NULL);
+        }
+    }
+    USBD_Bench_SyncTxTime = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID) - ts;
+    USBD_Bench_SyncOk     = DEF_OK;
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Event()
+*
+* Description : Measure the delay and the rate at which endpoint completions signaled by the driver reach
+*               the core task.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of transfers per phase, [depth] number of reads
+*                           queued on the device side.
+*
+* Return(s)   : DEF_OK,   if every transfer completed.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) 'depth' reads of one packet are queued with USBD_BulkRxAsync() on the bulk OUT endpoint
+*                   of a vendor interface, and each completion callback queues its read again. The vendor
+*                   class itself only allows one read at a time. The host functions of the loopback driver
+*                   signal the completion in place of the device controller ISR, while the callback runs
+*                   in the core task.
+*
+*               (2) In the first phase, the host sends one packet at a time and waits for its callback.
+*                   The delay is measured from the start of the host call to the callback.
+*
+*               (3) In the second phase, the host sends its packets back to back. The rate counts the
+*                   callbacks per second, up to the last one; completions can then be coalesced when the
+*                   core event ring is enabled.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_Event (int     argc,
+                                       char  **argv)
+{
+    CPU_INT32U   iter_nbr;
+    CPU_INT32U   depth;
+    CPU_INT32U   iter;
+    CPU_INT32U   cmpl_nbr;
+    CPU_INT64U  *p_time_tbl;
+    CPU_INT64U   ts;
+    CPU_INT64U   ts_end;
+    CPU_INT08U   class_nbr;
+    CPU_INT08U   ep_out;
+    CPU_INT08U   buf[USBD_BENCH_EVENT_PKT_LEN];
+    CPU_BOOLEAN  ok;
+    USBD_ERR     err;
+
+
+    iter_nbr = USBD_Bench_ArgGet(argc, argv, 0, 10000u);
+    depth    = USBD_Bench_ArgGet(argc, argv, 1, 4u);
+    if ((depth == 0u) ||
+        (depth >  USBD_BENCH_EVENT_DEPTH_MAX)) {
+        printf("depth must be 1..%u\n", (unsigned)USBD_BENCH_EVENT_DEPTH_MAX);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    class_nbr = USBD_Vendor_Add(DEF_FALSE, 0u, DEF_NULL, &err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Vendor_CfgAdd(class_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("vendor add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    ep_out = USBD_Bench_EP_AddrGet(0u, 0u, DEF_NO);
+
+    p_time_tbl = (CPU_INT64U *)malloc(iter_nbr * sizeof(CPU_INT64U));
+    if (p_time_tbl == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    for (iter = 0u; iter < depth; iter++) {                     /* See Note #1.                                         */
+        USBD_BulkRxAsync(USBD_Bench_DevNbr,
+                         ep_out,
+                         USBD_Bench_EventDevBuf[iter],
+                         USBD_BENCH_EP_MAX_PKT_SIZE_HS,
+                         USBD_Bench_EventRxCmpl,
+                         DEF_NULL,
+                        &err);
+        if (err != USBD_ERR_NONE) {
+            printf("bulk read failed (err %d)\n", (int)err);
+            return (DEF_FAIL);
+        }
+    }
+    Mem_Clr(buf, sizeof(buf));
+
+    cmpl_nbr = 0u;                                              /* ------------------- LATENCY PHASE ------------------ */
+    for (iter = 0u; iter < iter_nbr; iter++) {                  /* See Note #2.                                         */
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, ep_out, buf, sizeof(buf), DEF_NO,
+                                       USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if (err != USBD_ERR_NONE) {
+            printf("bulk OUT %u failed (err %d)\n", (unsigned)iter, (int)err);
+            break;
+        }
+
+        ok = USBD_Bench_EventWait(iter + 1u, &ts_end);
+        if (ok != DEF_OK) {
+            printf("bulk OUT %u did not complete\n", (unsigned)iter);
+            break;
+        }
+        p_time_tbl[cmpl_nbr] = ts_end - ts;
+        cmpl_nbr++;
+    }
+
+    printf("event: %u read(s) queued, event ring %s\n",
+           (unsigned)depth,
+           (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED) ? "enabled" : "disabled");
+    USBD_Bench_StatPrint("drv to core task", p_time_tbl, cmpl_nbr);
+    free(p_time_tbl);
+    if (cmpl_nbr != iter_nbr) {
+        return (DEF_FAIL);
+    }
+
+    ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);                     /* -------------------- RATE PHASE -------------------- */
+    for (iter = 0u; iter < iter_nbr; iter++) {                  /* See Note #3.                                         */
+        (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, ep_out, buf, sizeof(buf), DEF_NO,
+                                       USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if (err != USBD_ERR_NONE) {
+            printf("bulk OUT %u failed (err %d)\n", (unsigned)iter, (int)err);
+            return (DEF_FAIL);
+        }
+    }
+    ok = USBD_Bench_EventWait(2u * iter_nbr, &ts_end);
+    if (ok != DEF_OK) {
+        printf("bulk OUT burst did not complete\n");
+        return (DEF_FAIL);
+    }
+
+    printf("  %-24s %.0f events/s, %.3f us/event\n",
+           "back-to-back cmpl",
+           (double)iter_nbr * USBD_BENCH_NS_PER_SEC / (ts_end - ts),
+           (double)(ts_end - ts) / iter_nbr / USBD_BENCH_NS_PER_uS);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_EventRxCmpl()
+*
+* Description : Count an 'event' mode completion and queue the read again (see USBD_Bench_Event() Note #1).
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to receive buffer.
+*
+*               buf_len     Buffer length, in octets.
+*
+*               xfer_len    Number of octets received.
+*
+*               p_arg       Callback argument (not used).
+*
+*               err         Transfer result.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_Bench_EventRxCmpl (CPU_INT08U   dev_nbr,
+                                      CPU_INT08U   ep_addr,
+                                      void        *p_buf,
+                                      CPU_INT32U   buf_len,
+                                      CPU_INT32U   xfer_len,
+                                      void        *p_arg,
+                                      USBD_ERR     err)
+{
+    CPU_INT64U  ts;
+
+
+    (void)xfer_len;
+    (void)p_arg;
+
+    if (err != USBD_ERR_NONE) {
+        return;
+    }
+
+    ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    (void)pthread_mutex_lock(&USBD_Bench_EventMutex);
+    USBD_Bench_EventCmplTs = ts;
+    USBD_Bench_EventCmplNbr++;
+    (void)pthread_cond_signal(&USBD_Bench_EventCond);
+    (void)pthread_mutex_unlock(&USBD_Bench_EventMutex);
+
+    USBD_BulkRxAsync(dev_nbr,
+                     ep_addr,
+                     p_buf,
+                     buf_len,
+                     USBD_Bench_EventRxCmpl,
+                     DEF_NULL,
+                    &err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_EventWait()
+*
+* Description : Wait for the 'event' mode completion counter to reach a value.
+*
+* Argument(s) : cmpl_nbr    Number of completions to wait for.
+*
+*               p_ts        Pointer to variable that will receive the time of the last completion, in
+*                           nanoseconds.
+*
+* Return(s)   : DEF_OK,   if the completions were counted in time.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_EventWait (CPU_INT32U   cmpl_nbr,
+                                           CPU_INT64U  *p_ts)
+{
+    struct  timespec  abs_time;
+    CPU_BOOLEAN       ok;
+    int               rtn;
+
+
+    (void)clock_gettime(CLOCK_REALTIME, &abs_time);
+    abs_time.tv_sec += USBD_BENCH_XFER_TIMEOUT_mS / 1000u;
+
+    rtn = 0;
+    (void)pthread_mutex_lock(&USBD_Bench_EventMutex);
+    while ((USBD_Bench_EventCmplNbr <  cmpl_nbr) &&
+           (rtn                     == 0)) {
+        rtn = pthread_cond_timedwait(&USBD_Bench_EventCond, &USBD_Bench_EventMutex, &abs_time);
+    }
+    ok  = (USBD_Bench_EventCmplNbr >= cmpl_nbr) ? DEF_OK : DEF_FAIL;
+   *p_ts = USBD_Bench_EventCmplTs;
+    (void)pthread_mutex_unlock(&USBD_Bench_EventMutex);
+
+    return (ok);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_Bench_MSC()
+*
+* Description : Measure MSC Bulk-Only Transport throughput on two class instances.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of write/read pairs per instance, [nbr_blk] blocks per
+*                           command.
+*
+* Return(s)   : DEF_OK,   if every command succeeded and the data read back matched.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) Each instance has one logical unit on its own RAMDisk unit, and is driven by its own host
+*                   thread. The throughput counts the octets transferred by the timed commands (see
+*                   USBD_Bench_MSC_Host()).
+*
+*               (2) The data stage is split in USBD_MSC_CFG_DATA_LEN chunks, pipelined over
+*                   USBD_MSC_CFG_DATA_NBR_BUF buffers. Both are set at build time with the
+*                   USBD_BENCH_CFG_MSC_DATA_LEN and USBD_BENCH_CFG_MSC_DATA_NBR_BUF macros (see 'usbd_cfg.h
+*                   Note #2'), and are printed with the results.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_MSC (int     argc,
+                                     char  **argv)
+{
+    static  CPU_CHAR     *lun_name_tbl[USBD_BENCH_MSC_NBR_CLASS] = {"ram:0:", "ram:1:"};
+    static  const  char  *op_name_tbl[]    = {"msc", "msc_rd", "msc_wr"};
+    static  const  char  *op_cmd_tbl[]     = {"(WRITE(10) + READ(10))", "READ(10)", "WRITE(10)"};
+    static  const  double op_dir_nbr_tbl[] = {2.0, 1.0, 1.0};
+            pthread_t     thread_tbl[USBD_BENCH_MSC_NBR_CLASS];
+            CPU_INT08U    class_nbr;
+            CPU_INT08U    ix;
+            CPU_BOOLEAN   ok;
+            USBD_ERR      err;
+
+
+    USBD_Bench_MSC_IterNbr = USBD_Bench_ArgGet(argc, argv, 0, 500u);
+    USBD_Bench_MSC_BlkNbr  = USBD_Bench_ArgGet(argc, argv, 1, 64u);
+    if ((USBD_Bench_MSC_BlkNbr == 0u) ||
+        (USBD_Bench_MSC_BlkNbr >= USBD_RAMDISK_CFG_NBR_BLKS) ||
+        (USBD_Bench_MSC_BlkNbr >  0xFFFFu)) {
+        printf("nbr_blk must be 1..%u\n", (unsigned)(USBD_RAMDISK_CFG_NBR_BLKS - 1u));
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    USBD_MSC_Init(&err);
+    for (ix = 0u; (ix < USBD_BENCH_MSC_NBR_CLASS) && (err == USBD_ERR_NONE); ix++) {
+        class_nbr = USBD_MSC_Add(&err);
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_MSC_CfgAdd(class_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+        }
+        if (err == USBD_ERR_NONE) {
+            USBD_MSC_LunAdd(lun_name_tbl[ix], class_nbr, "Micrium", "Loopback Bench", 0x01u, DEF_FALSE, &err);
+        }
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("MSC add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    USBD_OS_DlyMs(10u);                                         /* Let the MSC tasks see the connection.                */
+
+    for (ix = 0u; ix < USBD_BENCH_MSC_NBR_CLASS; ix++) {        /* See Note #1.                                         */
+        USBD_Bench_MSC_EP_OutTbl[ix] = USBD_Bench_EP_AddrGet(ix, 0u, DEF_NO);
+        USBD_Bench_MSC_EP_InTbl[ix]  = USBD_Bench_EP_AddrGet(ix, 0u, DEF_YES);
+        (void)pthread_create(&thread_tbl[ix], DEF_NULL, USBD_Bench_MSC_Host, (void *)&USBD_Bench_MSC_OkTbl[ix]);
+    }
+
+    ok = DEF_OK;
+    for (ix = 0u; ix < USBD_BENCH_MSC_NBR_CLASS; ix++) {
+        (void)pthread_join(thread_tbl[ix], DEF_NULL);
+        printf("%s: instance %u, %u x %s of %u blocks: %s %.1f MB/s (data bufs %u x %u octets, cache %s)\n",
+               op_name_tbl[USBD_Bench_MSC_Op],
+               (unsigned)ix,
+               (unsigned)USBD_Bench_MSC_IterNbr,
+               op_cmd_tbl[USBD_Bench_MSC_Op],
+               (unsigned)USBD_Bench_MSC_BlkNbr,
+               (USBD_Bench_MSC_OkTbl[ix] == DEF_OK) ? "ok" : "FAIL",
+               op_dir_nbr_tbl[USBD_Bench_MSC_Op] * USBD_Bench_MSC_IterNbr * USBD_Bench_MSC_BlkNbr *
+               USBD_BENCH_MSC_BLK_SIZE * USBD_BENCH_NS_PER_SEC / USBD_Bench_MSC_TimeTbl[ix] / 1e6,
+               (unsigned)USBD_MSC_CFG_DATA_NBR_BUF,
+               (unsigned)USBD_MSC_CFG_DATA_LEN,
+               (USBD_MSC_CFG_CACHE_EN == DEF_ENABLED) ? "enabled" : "disabled");
+        if (USBD_Bench_MSC_OkTbl[ix] != DEF_OK) {
+            ok = DEF_FAIL;
+        }
+    }
+
+    return (ok);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_MSC_Rd()
+*
+* Description : Measure MSC Bulk-Only Transport read throughput on two class instances.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of reads per instance, [nbr_blk] blocks per command.
+*
+* Return(s)   : DEF_OK,   if every command succeeded and the data read matched.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_MSC_Rd (int     argc,
+                                        char  **argv)
+{
+    USBD_Bench_MSC_Op = USBD_BENCH_MSC_OP_RD;
+
+    return (USBD_Bench_MSC(argc, argv));
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_MSC_Wr()
+*
+* Description : Measure MSC Bulk-Only Transport sustained write throughput on two class instances.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of writes per instance, [nbr_blk] blocks per command.
+*
+* Return(s)   : DEF_OK,   if every command succeeded and the last data written was read back unchanged.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_MSC_Wr (int     argc,
+                                        char  **argv)
+{
+    USBD_Bench_MSC_Op = USBD_BENCH_MSC_OP_WR;
+
+    return (USBD_Bench_MSC(argc, argv));
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_MSC_Host()
+*
+* Description : Host thread writing and/or reading blocks on one MSC instance, and comparing them.
+*
+* Argument(s) : p_arg       Pointer to the instance's result in USBD_Bench_MSC_OkTbl.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Only the SCSI commands are timed. The data is generated and compared outside of the
+*                   timed section.
+*
+*               (2) In the read only mode, the whole RAMDisk unit is written once before the timed reads.
+*
+*               (3) In the write only mode, no data is read back during the timed writes. The blocks of the
+*                   last write are read back and compared once the writes are done.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_Bench_MSC_Host (void  *p_arg)
+{
+    CPU_BOOLEAN  *p_ok;
+    CPU_INT08U    ix;
+    CPU_INT32U    len;
+    CPU_INT32U    lba;
+    CPU_INT32U    iter;
+    CPU_INT08U   *p_wr_buf;
+    CPU_INT08U   *p_rd_buf;
+    CPU_INT64U    ts;
+    CPU_INT64U    time;
+    CPU_BOOLEAN   ok;
+
+
+    p_ok  = (CPU_BOOLEAN *)p_arg;
+    ix    = (CPU_INT08U)(p_ok - &USBD_Bench_MSC_OkTbl[0]);
+   *p_ok  =  DEF_FAIL;
+    len   =  USBD_Bench_MSC_BlkNbr * USBD_BENCH_MSC_BLK_SIZE;
+    time  =  0u;
+
+    p_wr_buf = (CPU_INT08U *)malloc(len);
+    p_rd_buf = (CPU_INT08U *)malloc(len);
+    if ((p_wr_buf == DEF_NULL) ||
+        (p_rd_buf == DEF_NULL)) {
+        return (DEF_NULL);
+    }
+
+    ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_TEST_UNIT_READY, 0u, DEF_NULL, 0u);
+    if (ok == DEF_OK) {
+        ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_READ_CAPACITY_10, 0u, p_rd_buf, USBD_BENCH_MSC_SCSI_READ_CAP_LEN);
+    }
+
+    if (USBD_Bench_MSC_Op == USBD_BENCH_MSC_OP_RD) {            /* See Note #2.                                         */
+        for (lba = 0u; (lba < USBD_RAMDISK_CFG_NBR_BLKS) && (ok == DEF_OK); lba += USBD_Bench_MSC_BlkNbr) {
+            lba = DEF_MIN(lba, USBD_RAMDISK_CFG_NBR_BLKS - USBD_Bench_MSC_BlkNbr);
+            USBD_Bench_MSC_Fill(p_wr_buf, lba, len);
+            ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_WRITE_10, lba, p_wr_buf, len);
+        }
+    }
+
+    for (iter = 0u; (iter < USBD_Bench_MSC_IterNbr) && (ok == DEF_OK); iter++) {
+        lba = (iter * USBD_Bench_MSC_BlkNbr) % (USBD_RAMDISK_CFG_NBR_BLKS - USBD_Bench_MSC_BlkNbr);
+        USBD_Bench_MSC_Fill(p_wr_buf, lba + ix * 101u + iter, len);
+
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);                 /* See Note #1.                                         */
+        if (USBD_Bench_MSC_Op != USBD_BENCH_MSC_OP_RD) {
+            ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_WRITE_10, lba, p_wr_buf, len);
+        }
+        if ((ok                == DEF_OK) &&
+            (USBD_Bench_MSC_Op != USBD_BENCH_MSC_OP_WR)) {
+            ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_READ_10, lba, p_rd_buf, len);
+        }
+        time += USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+
+        if (USBD_Bench_MSC_Op == USBD_BENCH_MSC_OP_RD) {        /* Prefilled data does not depend on the iteration.     */
+            USBD_Bench_MSC_Fill(p_wr_buf, lba, len);
+        }
+        if ((ok                == DEF_OK)                &&
+            (USBD_Bench_MSC_Op != USBD_BENCH_MSC_OP_WR)   &&
+            (memcmp(p_wr_buf, p_rd_buf, len) != 0)) {
+            printf("msc: instance %u, data mismatch at LBA %u\n", (unsigned)ix, (unsigned)lba);
+            ok = DEF_FAIL;
+        }
+    }
+                                                                /* See Note #3.                                         */
+    if ((ok                == DEF_OK)               &&
+        (USBD_Bench_MSC_Op == USBD_BENCH_MSC_OP_WR) &&
+        (iter              >  0u)) {
+        ok = USBD_Bench_MSC_Cmd(ix, USBD_BENCH_MSC_SCSI_READ_10, lba, p_rd_buf, len);
+        if ((ok == DEF_OK) &&
+            (memcmp(p_wr_buf, p_rd_buf, len) != 0)) {
+            printf("msc: instance %u, data mismatch at LBA %u\n", (unsigned)ix, (unsigned)lba);
+            ok = DEF_FAIL;
+        }
+    }
+    USBD_Bench_MSC_TimeTbl[ix] = time;
+
+   *p_ok = ok;
+    free(p_wr_buf);
+    free(p_rd_buf);
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_MSC_Cmd()
+*
+* Description : Run one SCSI command with the Bulk-Only Transport protocol.
+*
+* Argument(s) : ix          MSC instance index.
+*
+*               op_code     SCSI operation code: TEST UNIT READY, READ CAPACITY(10), READ(10) or WRITE(10).
+*
+*               lba         Logical block address.
+*
+*               p_buf       Pointer to data buffer.
+*
+*               len         Data length, in octets.
+*
+* Return(s)   : DEF_OK,   if the command succeeded and the CSW reported a good status.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_MSC_Cmd (CPU_INT08U   ix,
+                                         CPU_INT08U   op_code,
+                                         CPU_INT32U   lba,
+                                         CPU_INT08U  *p_buf,
+                                         CPU_INT32U   len)
+{
+    CPU_INT08U   cbw[USBD_BENCH_MSC_CBW_LEN];
+    CPU_INT08U   csw[USBD_BENCH_MSC_CSW_LEN];
+    CPU_INT16U   nbr_blk;
+    CPU_INT32U   xfer_len;
+    CPU_BOOLEAN  dir_in;
+    USBD_ERR     err;
+
+
+    nbr_blk = (CPU_INT16U)(len / USBD_BENCH_MSC_BLK_SIZE);
+    dir_in  = ((op_code == USBD_BENCH_MSC_SCSI_READ_10) ||
+               (op_code == USBD_BENCH_MSC_SCSI_READ_CAPACITY_10)) ? DEF_YES : DEF_NO;
+
+    Mem_Clr(cbw, sizeof(cbw));
+    cbw[0] = 'U';                                               /* dCBWSignature.                                       */
+    cbw[1] = 'S';
+    cbw[2] = 'B';
+    cbw[3] = 'C';
+    MEM_VAL_SET_INT32U_LITTLE(&cbw[4], USBD_Bench_MSC_TagTbl[ix]);
+    MEM_VAL_SET_INT32U_LITTLE(&cbw[8], len);
+    cbw[12] = (dir_in == DEF_YES) ? 0x80u : 0x00u;              /* bmCBWFlags.                                          */
+    cbw[14] = 10u;                                              /* bCBWCBLength.                                        */
+    cbw[15] = op_code;
+    MEM_VAL_SET_INT32U_BIG(&cbw[17], lba);
+    MEM_VAL_SET_INT16U_BIG(&cbw[22], nbr_blk);
+    USBD_Bench_MSC_TagTbl[ix]++;
+
+    (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, USBD_Bench_MSC_EP_OutTbl[ix], cbw, sizeof(cbw), DEF_YES,
+                                   USBD_BENCH_XFER_TIMEOUT_mS, &err);
+    if ((err == USBD_ERR_NONE) && (len > 0u)) {
+        if (dir_in == DEF_YES) {
+            xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, USBD_Bench_MSC_EP_InTbl[ix], p_buf, len,
+                                               USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        } else {
+            xfer_len = USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, USBD_Bench_MSC_EP_OutTbl[ix], p_buf, len, DEF_NO,
+                                                USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        }
+        if ((err == USBD_ERR_NONE) && (xfer_len != len)) {
+            err = USBD_ERR_FAIL;
+        }
+    }
+    if (err == USBD_ERR_NONE) {
+        xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, USBD_Bench_MSC_EP_InTbl[ix], csw, sizeof(csw),
+                                           USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        if ((err == USBD_ERR_NONE) &&
+           ((xfer_len != sizeof(csw)) || (csw[12] != 0u))) {    /* bCSWStatus.                                          */
+            err = USBD_ERR_FAIL;
+        }
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("msc: instance %u, op 0x%02X at LBA %u failed (err %d)\n",
+               (unsigned)ix, (unsigned)op_code, (unsigned)lba, (int)err);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_MSC_Fill()
+*
+* Description : Fill a buffer with the test pattern of a range of blocks.
+*
+* Argument(s) : p_buf       Pointer to buffer.
+*
+*               lba         Logical block address of the first block, or any other seed.
+*
+*               len         Buffer length, in octets.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_Bench_MSC_Fill (CPU_INT08U  *p_buf,
+                                   CPU_INT32U   lba,
+                                   CPU_INT32U   len)
+{
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < len; i++) {
+        p_buf[i] = (CPU_INT08U)((lba + i / USBD_BENCH_MSC_BLK_SIZE) * 13u + i * 7u);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_Bench_UAS()
+*
+* Description : Measure the rate of random reads with the USB Attached SCSI protocol, at queue depth 1 and at
+*               a larger queue depth.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of READ(10) commands per queue depth, [qd] largest
+*                           queue depth, [nbr_blk] blocks per command.
+*
+* Return(s)   : DEF_OK,   if every command succeeded and the data read matched.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) One MSC instance is added. Its RAMDisk unit is written once with the Bulk-Only Transport,
+*                   then the host selects the UAS alternate setting and the reads are timed with it.
+*
+*               (2) Each queue depth reads the same sequence of LBAs. The number of data buffers, which
+*                   bounds the concurrent reads (see 'usbd_cfg.h  MASS STORAGE CLASS (MSC) CONFIGURATION
+*                   Note #7b'), and the Command IU retries of the loopback host (see 'USBD_Bench_UAS_Run()
+*                   Note #1') are printed with the results.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_UAS (int     argc,
+                                     char  **argv)
+{
+    CPU_INT32U    qd_tbl[2u];
+    CPU_INT32U    len;
+    CPU_INT32U    lba;
+    CPU_INT08U   *p_buf;
+    CPU_INT64U    time;
+    CPU_INT32U    retry_nbr;
+    CPU_INT08U    class_nbr;
+    CPU_INT08U    ix;
+    CPU_BOOLEAN   ok;
+    USBD_ERR      err;
+
+
+    USBD_Bench_UAS_IterNbr = USBD_Bench_ArgGet(argc, argv, 0, 5000u);
+    qd_tbl[0]              = 1u;
+    qd_tbl[1]              = USBD_Bench_ArgGet(argc, argv, 1, USBD_MSC_CFG_UAS_QUEUE_DEPTH);
+    USBD_Bench_UAS_BlkNbr  = USBD_Bench_ArgGet(argc, argv, 2, 8u);
+    if ((qd_tbl[1] == 0u) ||
+        (qd_tbl[1] >  USBD_MSC_CFG_UAS_QUEUE_DEPTH)) {
+        printf("qd must be 1..%u\n", (unsigned)USBD_MSC_CFG_UAS_QUEUE_DEPTH);
+        return (DEF_FAIL);
+    }
+    if ((USBD_Bench_UAS_BlkNbr == 0u) ||
+        (USBD_Bench_UAS_BlkNbr >= USBD_RAMDISK_CFG_NBR_BLKS) ||
+        (USBD_Bench_UAS_BlkNbr >  0xFFFFu)) {
+        printf("nbr_blk must be 1..%u\n", (unsigned)(USBD_RAMDISK_CFG_NBR_BLKS - 1u));
+        return (DEF_FAIL);
+    }
+    len   = USBD_Bench_UAS_BlkNbr * USBD_BENCH_MSC_BLK_SIZE;
+    p_buf = (CPU_INT08U *)malloc(len * USBD_MSC_CFG_UAS_QUEUE_DEPTH);
+    if (p_buf == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        free(p_buf);
+        return (DEF_FAIL);
+    }
+
+    USBD_MSC_Init(&err);
+    if (err == USBD_ERR_NONE) {
+        class_nbr = USBD_MSC_Add(&err);
+    }
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_MSC_CfgAdd(class_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_MSC_LunAdd("ram:0:", class_nbr, "Micrium", "Loopback Bench", 0x01u, DEF_FALSE, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("MSC add failed (err %d)\n", (int)err);
+        free(p_buf);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        free(p_buf);
+        return (DEF_FAIL);
+    }
+    USBD_OS_DlyMs(10u);                                         /* Let the MSC task see the connection.                 */
+
+                                                                /* See Note #1.                                         */
+    USBD_Bench_MSC_EP_OutTbl[0] = USBD_Bench_EP_AddrGet(0u, 0u, DEF_NO);
+    USBD_Bench_MSC_EP_InTbl[0]  = USBD_Bench_EP_AddrGet(0u, 0u, DEF_YES);
+    ok = USBD_Bench_MSC_Cmd(0u, USBD_BENCH_MSC_SCSI_TEST_UNIT_READY, 0u, DEF_NULL, 0u);
+    if (ok == DEF_OK) {
+        ok = USBD_Bench_MSC_Cmd(0u, USBD_BENCH_MSC_SCSI_READ_CAPACITY_10, 0u, p_buf, USBD_BENCH_MSC_SCSI_READ_CAP_LEN);
+    }
+    for (lba = 0u; (lba < USBD_RAMDISK_CFG_NBR_BLKS) && (ok == DEF_OK); lba += USBD_Bench_UAS_BlkNbr) {
+        lba = DEF_MIN(lba, USBD_RAMDISK_CFG_NBR_BLKS - USBD_Bench_UAS_BlkNbr);
+        USBD_Bench_MSC_Fill(p_buf, lba, len);
+        ok = USBD_Bench_MSC_Cmd(0u, USBD_BENCH_MSC_SCSI_WRITE_10, lba, p_buf, len);
+    }
+
+    if (ok == DEF_OK) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_HOST_TO_DEVICE | USBD_REQ_RECIPIENT_INTERFACE,
+                                  USBD_REQ_SET_INTERFACE,
+                                  USBD_BENCH_UAS_IF_ALT_NBR,
+                                  0u,
+                                  0u,
+                                  DEF_NULL,
+                                 &err);
+        USBD_OS_DlyMs(10u);                                     /* Let the MSC task switch to the UAS pipes.            */
+
+        USBD_Bench_UAS_EP_Cmd    = USBD_Bench_UAS_EP_Get(0u, USBD_BENCH_UAS_PIPE_ID_CMD);
+        USBD_Bench_UAS_EP_Status = USBD_Bench_UAS_EP_Get(0u, USBD_BENCH_UAS_PIPE_ID_STATUS);
+        USBD_Bench_UAS_EP_DataIn = USBD_Bench_UAS_EP_Get(0u, USBD_BENCH_UAS_PIPE_ID_DATA_IN);
+        if ((err                      != USBD_ERR_NONE)     ||
+            (USBD_Bench_UAS_EP_Cmd    == USBD_EP_ADDR_NONE) ||
+            (USBD_Bench_UAS_EP_Status == USBD_EP_ADDR_NONE) ||
+            (USBD_Bench_UAS_EP_DataIn == USBD_EP_ADDR_NONE)) {
+            printf("uas: alternate setting %u not found (err %d)\n", (unsigned)USBD_BENCH_UAS_IF_ALT_NBR, (int)err);
+            ok = DEF_FAIL;
+        }
+    }
+
+    for (ix = 0u; (ix < 2u) && (ok == DEF_OK); ix++) {          /* See Note #2.                                         */
+        time = 1u;
+        ok   = USBD_Bench_UAS_Run(qd_tbl[ix], p_buf, &time, &retry_nbr);
+        printf("uas: QD %2u, %u x READ(10) of %u blocks: %s %.0f IOPS, %.1f MB/s "
+               "(data bufs %u x %u octets, %u cmd retries)\n",
+               (unsigned)qd_tbl[ix],
+               (unsigned)USBD_Bench_UAS_IterNbr,
+               (unsigned)USBD_Bench_UAS_BlkNbr,
+               (ok == DEF_OK) ? "ok" : "FAIL",
+               (double)USBD_Bench_UAS_IterNbr * USBD_BENCH_NS_PER_SEC / time,
+               (double)USBD_Bench_UAS_IterNbr * len * USBD_BENCH_NS_PER_SEC / time / 1e6,
+               (unsigned)USBD_MSC_CFG_DATA_NBR_BUF,
+               (unsigned)USBD_MSC_CFG_DATA_LEN,
+               (unsigned)retry_nbr);
+    }
+
+    free(p_buf);
+
+    return (ok);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_UAS_Run()
+*
+* Description : Run the UAS reads at one queue depth.
+*
+* Argument(s) : qd          Queue depth: number of commands kept in flight.
+*
+*               p_buf       Pointer to 'qd' data buffers of 'nbr_blk' blocks, one per tag.
+*
+*               p_time      Pointer to variable that will receive the duration of the reads, in nanoseconds.
+*
+*               p_retry_nbr Pointer to variable that will receive the number of Command IU retries.
+*
+* Return(s)   : DEF_OK,   if every command succeeded and the data read matched.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The loopback host serves one transfer at a time, while the device sends the IUs of the
+*                   status pipe synchronously and re-arms the command pipe between them. A Command IU is
+*                   therefore only sent after a data-in stage or a Sense IU was received, at most one per IU,
+*                   which still fills the queue since each command yields two of them. With commands in
+*                   flight, the device may already wait on the status pipe: the Command IU is then given up
+*                   after USBD_BENCH_UAS_CMD_TIMEOUT_mS and sent again after the next IU.
+*
+*               (2) Tag 'n' uses the data buffer 'n - 1'. The LBAs are drawn with a linear congruential
+*                   generator, from the same seed at each queue depth.
+*
+*               (3) Only the first block of each read is compared, to keep the pattern generation out of the
+*                   measured rate. The Bulk-Only Transport modes compare every block.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_UAS_Run (CPU_INT32U   qd,
+                                         CPU_INT08U  *p_buf,
+                                         CPU_INT64U  *p_time,
+                                         CPU_INT32U  *p_retry_nbr)
+{
+    CPU_INT08U   iu[USBD_BENCH_UAS_IU_LEN_STATUS_MAX];
+    CPU_INT08U   blk[USBD_BENCH_MSC_BLK_SIZE];
+    CPU_INT32U   lba_tbl[USBD_MSC_CFG_UAS_QUEUE_DEPTH];
+    CPU_INT16U   tag_free_tbl[USBD_MSC_CFG_UAS_QUEUE_DEPTH];
+    CPU_INT08U  *p_data;
+    CPU_INT32U   len;
+    CPU_INT32U   seed;
+    CPU_INT32U   tag_free_nbr;
+    CPU_INT32U   cmd_nbr;
+    CPU_INT32U   cmpl_nbr;
+    CPU_INT32U   timeout_ms;
+    CPU_INT32U   xfer_len;
+    CPU_INT16U   tag;
+    CPU_INT16U   tag_tx;
+    CPU_INT64U   ts;
+    CPU_BOOLEAN  tx_en;
+    CPU_BOOLEAN  ok;
+    USBD_ERR     err;
+
+
+    len  = USBD_Bench_UAS_BlkNbr * USBD_BENCH_MSC_BLK_SIZE;
+    seed = 1u;
+    for (tag_free_nbr = 0u; tag_free_nbr < qd; tag_free_nbr++) {
+        tag_free_tbl[tag_free_nbr] = (CPU_INT16U)(qd - tag_free_nbr);
+    }
+
+   *p_retry_nbr = 0u;
+    cmd_nbr     = 0u;
+    cmpl_nbr    = 0u;
+    tag_tx      = 0u;
+    tx_en       = DEF_YES;
+    ok          = DEF_OK;
+    ts          = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+
+    while ((cmpl_nbr < USBD_Bench_UAS_IterNbr) &&
+           (ok       == DEF_OK)) {
+        if ((tx_en        == DEF_YES) &&                        /* Take a free tag for the next cmd (see Note #2).      */
+            (tag_tx       == 0u)      &&
+            (tag_free_nbr >  0u)      &&
+            (cmd_nbr      <  USBD_Bench_UAS_IterNbr)) {
+            tag_free_nbr--;
+            tag_tx            = tag_free_tbl[tag_free_nbr];
+            seed              = seed * 1103515245u + 12345u;
+            lba_tbl[tag_tx - 1u] = (seed >> 8) % (USBD_RAMDISK_CFG_NBR_BLKS - USBD_Bench_UAS_BlkNbr + 1u);
+        }
+
+        if ((tx_en  == DEF_YES) &&                              /* See Note #1.                                         */
+            (tag_tx != 0u)) {
+            timeout_ms = (cmd_nbr == cmpl_nbr) ? USBD_BENCH_XFER_TIMEOUT_mS : USBD_BENCH_UAS_CMD_TIMEOUT_mS;
+            USBD_Bench_UAS_CmdTx(tag_tx, lba_tbl[tag_tx - 1u], timeout_ms, &err);
+            if (err == USBD_ERR_NONE) {
+                tag_tx = 0u;
+                cmd_nbr++;
+            } else if ((err     == USBD_ERR_OS_TIMEOUT) &&
+                       (cmd_nbr != cmpl_nbr)) {
+               *p_retry_nbr += 1u;
+            } else {
+                printf("uas: QD %u, tag %u, Command IU tx failed (err %d)\n", (unsigned)qd, (unsigned)tag_tx, (int)err);
+                ok = DEF_FAIL;
+                break;
+            }
+            tx_en = DEF_NO;
+        }
+
+        xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, USBD_Bench_UAS_EP_Status, iu, sizeof(iu),
+                                           USBD_BENCH_XFER_TIMEOUT_mS, &err);
+        tag      = MEM_VAL_GET_INT16U_BIG(&iu[2]);
+        if ((err      != USBD_ERR_NONE)             ||
+            (xfer_len <  USBD_BENCH_UAS_IU_LEN_HDR) ||
+            (tag      == 0u)                        ||
+            (tag      >  qd)) {
+            printf("uas: QD %u, status pipe rx failed (err %d)\n", (unsigned)qd, (int)err);
+            ok = DEF_FAIL;
+            break;
+        }
+        p_data = &p_buf[(tag - 1u) * len];
+
+        if (iu[0] == USBD_BENCH_UAS_IU_ID_RD_RDY) {
+            xfer_len = USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr, USBD_Bench_UAS_EP_DataIn, p_data, len,
+                                               USBD_BENCH_XFER_TIMEOUT_mS, &err);
+            if ((err != USBD_ERR_NONE) || (xfer_len != len)) {
+                printf("uas: QD %u, tag %u, data-in failed (err %d)\n", (unsigned)qd, (unsigned)tag, (int)err);
+                ok = DEF_FAIL;
+            }
+            tx_en = DEF_YES;
+
+        } else if ((iu[0] == USBD_BENCH_UAS_IU_ID_SENSE) &&
+                   (iu[6] == USBD_BENCH_UAS_STATUS_GOOD)) {
+            USBD_Bench_MSC_Fill(blk, lba_tbl[tag - 1u], sizeof(blk));
+            if (memcmp(p_data, blk, sizeof(blk)) != 0) {        /* See Note #3.                                         */
+                printf("uas: QD %u, data mismatch at LBA %u\n", (unsigned)qd, (unsigned)lba_tbl[tag - 1u]);
+                ok = DEF_FAIL;
+            }
+            tag_free_tbl[tag_free_nbr] = tag;
+            tag_free_nbr++;
+            cmpl_nbr++;
+            tx_en = DEF_YES;
+
+        } else {
+            printf("uas: QD %u, tag %u, unexpected IU 0x%02X (status 0x%02X)\n",
+                   (unsigned)qd, (unsigned)tag, (unsigned)iu[0], (unsigned)iu[6]);
+            ok = DEF_FAIL;
+        }
+    }
+
+   *p_time = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+
+    return (ok);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_UAS_CmdTx()
+*
+* Description : Send the Command IU of a READ(10) command on the UAS command pipe.
+*
+* Argument(s) : tag         Tag of the command.
+*
+*               lba         Logical block address of the first block read.
+*
+*               timeout_ms  Time to wait for the device to arm the command pipe, in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code of the transfer.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  void  USBD_Bench_UAS_CmdTx (CPU_INT16U   tag,
+                                    CPU_INT32U   lba,
+                                    CPU_INT32U   timeout_ms,
+                                    USBD_ERR    *p_err)
+{
+    CPU_INT08U  iu[USBD_BENCH_UAS_IU_LEN_CMD];
+
+
+    Mem_Clr(iu, sizeof(iu));
+    iu[0] = USBD_BENCH_UAS_IU_ID_CMD;
+    MEM_VAL_SET_INT16U_BIG(&iu[2], tag);
+    iu[16] = USBD_BENCH_MSC_SCSI_READ_10;                       /* CDB.                                                 */
+    MEM_VAL_SET_INT32U_BIG(&iu[18], lba);
+    MEM_VAL_SET_INT16U_BIG(&iu[23], USBD_Bench_UAS_BlkNbr);
+
+    (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, USBD_Bench_UAS_EP_Cmd, iu, sizeof(iu), DEF_YES,
+                                   timeout_ms, p_err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_UAS_EP_Get()
+*
+* Description : Find a UAS pipe of an interface in the configuration descriptor read during enumeration.
+*
+* Argument(s) : if_nbr      Interface number.
+*
+*               pipe_id     Pipe ID of the Pipe Usage descriptor following the endpoint descriptor.
+*
+* Return(s)   : Address of the endpoint of that pipe in the UAS alternate setting,
+*
+*               USBD_EP_ADDR_NONE, if none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_MSC_CFG_UAS_EN == DEF_ENABLED)
+static  CPU_INT08U  USBD_Bench_UAS_EP_Get (CPU_INT08U  if_nbr,
+                                           CPU_INT08U  pipe_id)
+{
+    CPU_INT32U   ix;
+    CPU_INT08U  *p_desc;
+    CPU_INT08U   ep_addr;
+    CPU_BOOLEAN  in_if;
+
+
+    in_if   = DEF_NO;
+    ep_addr = USBD_EP_ADDR_NONE;
+    ix      = 0u;
+    while ((ix + 2u) < USBD_Bench_DescLen) {
+        p_desc = &USBD_Bench_DescBuf[ix];
+        if (p_desc[0] == 0u) {
+            break;
+        }
+
+        if (p_desc[1] == USBD_DESC_TYPE_INTERFACE) {
+            in_if   = ((p_desc[2] == if_nbr) && (p_desc[3] == USBD_BENCH_UAS_IF_ALT_NBR)) ? DEF_YES : DEF_NO;
+            ep_addr = USBD_EP_ADDR_NONE;
+
+        } else if ((p_desc[1] == USBD_DESC_TYPE_ENDPOINT) &&
+                   (in_if     == DEF_YES)) {
+            ep_addr = p_desc[2];
+
+        } else if ((p_desc[1] == USBD_BENCH_UAS_DESC_TYPE_PIPE_USAGE) &&
+                   (in_if     == DEF_YES)                             &&
+                   (p_desc[2] == pipe_id)) {
+            return (ep_addr);
+        }
+
+        ix += p_desc[0];
+    }
+
+    return (USBD_EP_ADDR_NONE);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_Bench_HID()
+*
+* Description : Measure HID report descriptor parsing, idle rate requests and idle report timer ticks.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [ticks] number of timer ticks, [nbr_class] number of HID
+*                           instances, [nbr_id] number of input report IDs per instance.
+*
+* Return(s)   : DEF_OK,   if every request succeeded and GET_IDLE returned the rates set.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) Each report ID is given an idle rate spread over 1..255 ticks with SET_IDLE, then read
+*                   back with GET_IDLE. Both requests run through the stack's control path.
+*
+*               (2) One host thread per instance polls its interrupt IN endpoint, so that idle reports
+*                   complete as they would on a bus. An instance sends one report at a time, so reports due
+*                   while its endpoint is busy are skipped, and fewer reports can be received than are due.
+*
+*               (3) The tick cost is the CPU time of USBD_HID_Report_TmrTaskHandler(), measured in the HID
+*                   OS port timer thread (see Note #3 at the top of this file).
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_HID (int     argc,
+                                     char  **argv)
+{
+    CPU_INT32U    tick_nbr;
+    CPU_INT32U    class_qty;
+    CPU_INT32U    id_qty;
+    CPU_INT32U    desc_len;
+    CPU_INT32U    rx_cnt;
+    CPU_INT32U    rx_expected;
+    CPU_INT32U    req_ix;
+    CPU_INT08U   *p_desc;
+    CPU_INT08U    class_ix;
+    CPU_INT08U    id;
+    CPU_INT08U    rate;
+    CPU_INT64U   *p_add_tbl;
+    CPU_INT64U   *p_set_tbl;
+    CPU_INT64U   *p_get_tbl;
+    CPU_INT64U    ts;
+    CPU_BOOLEAN   ok;
+    pthread_t     thread_tbl[USBD_HID_CFG_MAX_NBR_DEV];
+    USBD_ERR      err;
+
+
+    tick_nbr  = USBD_Bench_ArgGet(argc, argv, 0, 2500u);
+    class_qty = USBD_Bench_ArgGet(argc, argv, 1, USBD_HID_CFG_MAX_NBR_DEV);
+    id_qty    = USBD_Bench_ArgGet(argc, argv, 2, USBD_HID_CFG_MAX_NBR_REPORT_ID / USBD_HID_CFG_MAX_NBR_DEV);
+    if ((class_qty == 0u) || (class_qty > USBD_HID_CFG_MAX_NBR_DEV) ||
+        (id_qty    == 0u) || (id_qty    > USBD_BENCH_HID_NBR_ID_MAX) ||
+        (class_qty * id_qty > USBD_HID_CFG_MAX_NBR_REPORT_ID)) {
+        printf("nbr_class must be 1..%u, nbr_id 1..%u, and nbr_class x nbr_id <= %u\n",
+               (unsigned)USBD_HID_CFG_MAX_NBR_DEV,
+               (unsigned)USBD_BENCH_HID_NBR_ID_MAX,
+               (unsigned)USBD_HID_CFG_MAX_NBR_REPORT_ID);
+        return (DEF_FAIL);
+    }
+
+    p_desc    = (CPU_INT08U *)malloc(7u + id_qty * 8u);
+    p_add_tbl = (CPU_INT64U *)malloc(class_qty          * sizeof(CPU_INT64U));
+    p_set_tbl = (CPU_INT64U *)malloc(class_qty * id_qty * sizeof(CPU_INT64U));
+    p_get_tbl = (CPU_INT64U *)malloc(class_qty * id_qty * sizeof(CPU_INT64U));
+    USBD_Bench_HID_TickTbl = (CPU_INT64U *)malloc(tick_nbr * sizeof(CPU_INT64U));
+    if ((p_desc    == DEF_NULL) || (p_add_tbl == DEF_NULL) ||
+        (p_set_tbl == DEF_NULL) || (p_get_tbl == DEF_NULL) ||
+        (USBD_Bench_HID_TickTbl == DEF_NULL)) {
+        return (DEF_FAIL);
+    }
+                                                                /* ---------------- BUILD REPORT DESC ----------------- */
+    desc_len = 0u;
+    p_desc[desc_len++] = 0x05u;                                 /* Usage Page (Generic Desktop).                        */
+    p_desc[desc_len++] = 0x01u;
+    p_desc[desc_len++] = 0x09u;                                 /* Usage (Undefined).                                   */
+    p_desc[desc_len++] = 0x00u;
+    p_desc[desc_len++] = 0xA1u;                                 /* Collection (Application).                            */
+    p_desc[desc_len++] = 0x01u;
+    for (id = 1u; id <= id_qty; id++) {
+        p_desc[desc_len++] = 0x85u;                             /* Report ID.                                           */
+        p_desc[desc_len++] = id;
+        p_desc[desc_len++] = 0x75u;                             /* Report Size (8).                                     */
+        p_desc[desc_len++] = 8u;
+        p_desc[desc_len++] = 0x95u;                             /* Report Count.                                        */
+        p_desc[desc_len++] = USBD_BENCH_HID_REPORT_LEN;
+        p_desc[desc_len++] = 0x81u;                             /* Input (Data, Var, Abs).                              */
+        p_desc[desc_len++] = 0x02u;
+        if (id == 0xFFu) {
+            break;
+        }
+    }
+    p_desc[desc_len++] = 0xC0u;                                 /* End Collection.                                      */
+
+                                                                /* ------------------ ADD INSTANCES ------------------- */
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+
+    USBD_HID_Init(&err);
+    for (class_ix = 0u; (class_ix < class_qty) && (err == USBD_ERR_NONE); class_ix++) {
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        (void)USBD_HID_Add(USBD_HID_SUBCLASS_NONE,
+                           USBD_HID_PROTOCOL_NONE,
+                           USBD_HID_COUNTRY_CODE_NOT_SUPPORTED,
+                           p_desc,
+                           (CPU_INT16U)desc_len,
+                           DEF_NULL,
+                           0u,
+                           1u,
+                           1u,
+                           DEF_TRUE,
+                           DEF_NULL,
+                          &err);
+        p_add_tbl[class_ix] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_HID_CfgAdd(class_ix, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+        }
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("HID add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+                                                                /* ---------------- SET & GET IDLE RATES -------------- */
+    req_ix = 0u;                                                /* See Note #1.                                         */
+    for (class_ix = 0u; class_ix < class_qty; class_ix++) {
+        for (id = 1u; id <= id_qty; id++) {
+            rate = USBD_Bench_HID_RateGet(class_ix, id);
+            ts   = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+            (void)USBD_Bench_HostCtrl((USBD_REQ_DIR_HOST_TO_DEVICE | USBD_REQ_TYPE_CLASS | USBD_REQ_RECIPIENT_INTERFACE),
+                                       USBD_BENCH_HID_REQ_SET_IDLE,
+                                     (((CPU_INT16U)rate << 8u) | id),
+                                       class_ix,
+                                       0u,
+                                       DEF_NULL,
+                                      &err);
+            p_set_tbl[req_ix] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+            if (err != USBD_ERR_NONE) {
+                printf("SET_IDLE failed (IF %u, ID %u, err %d)\n", (unsigned)class_ix, (unsigned)id, (int)err);
+                return (DEF_FAIL);
+            }
+            req_ix++;
+        }
+    }
+
+    req_ix = 0u;
+    for (class_ix = 0u; class_ix < class_qty; class_ix++) {
+        for (id = 1u; id <= id_qty; id++) {
+            ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+            (void)USBD_Bench_HostCtrl((USBD_REQ_DIR_DEVICE_TO_HOST | USBD_REQ_TYPE_CLASS | USBD_REQ_RECIPIENT_INTERFACE),
+                                       USBD_BENCH_HID_REQ_GET_IDLE,
+                                       id,
+                                       class_ix,
+                                       1u,
+                                      &rate,
+                                      &err);
+            p_get_tbl[req_ix] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+            if ((err  != USBD_ERR_NONE) ||
+                (rate != USBD_Bench_HID_RateGet(class_ix, id))) {
+                printf("GET_IDLE failed (IF %u, ID %u, err %d, rate %u)\n",
+                       (unsigned)class_ix, (unsigned)id, (int)err, (unsigned)rate);
+                return (DEF_FAIL);
+            }
+            req_ix++;
+        }
+    }
+                                                                /* ---------------- IDLE REPORT TICKS ----------------- */
+    USBD_Bench_HID_PollEn = DEF_YES;                            /* See Note #2.                                         */
+    for (class_ix = 0u; class_ix < class_qty; class_ix++) {
+        USBD_Bench_HID_EP_InTbl[class_ix] = USBD_Bench_EP_AddrGet(class_ix, 0u, DEF_YES);
+        (void)pthread_create(&thread_tbl[class_ix], DEF_NULL, USBD_Bench_HID_Host, &USBD_Bench_HID_RxCntTbl[class_ix]);
+    }
+
+    (void)pthread_mutex_lock(&USBD_Bench_HID_TickMutex);        /* See Note #3.                                         */
+    USBD_Bench_HID_TickNbr    = 0u;
+    USBD_Bench_HID_TickNbrMax = tick_nbr;
+    USBD_Bench_HID_TickEn     = DEF_YES;
+    (void)pthread_mutex_unlock(&USBD_Bench_HID_TickMutex);
+
+    USBD_OS_DlyMs(tick_nbr * USBD_BENCH_HID_TICK_mS);
+
+    (void)pthread_mutex_lock(&USBD_Bench_HID_TickMutex);
+    USBD_Bench_HID_TickEn = DEF_NO;
+    tick_nbr              = USBD_Bench_HID_TickNbr;
+    (void)pthread_mutex_unlock(&USBD_Bench_HID_TickMutex);
+
+    USBD_Bench_HID_PollEn = DEF_NO;
+    rx_cnt      = 0u;
+    rx_expected = 0u;
+    for (class_ix = 0u; class_ix < class_qty; class_ix++) {
+        (void)pthread_join(thread_tbl[class_ix], DEF_NULL);
+        rx_cnt += USBD_Bench_HID_RxCntTbl[class_ix];
+        for (id = 1u; id <= id_qty; id++) {
+            rx_expected += tick_nbr / USBD_Bench_HID_RateGet(class_ix, id);
+        }
+    }
+
+    printf("hid: %u instances x %u input report IDs, report desc %u octets, input queue %s\n",
+           (unsigned)class_qty,
+           (unsigned)id_qty,
+           (unsigned)desc_len,
+           (USBD_HID_CFG_INPUT_Q_EN == DEF_ENABLED) ? "enabled" : "disabled");
+    USBD_Bench_StatPrint("USBD_HID_Add() (parse)", p_add_tbl,             class_qty);
+    USBD_Bench_StatPrint("SET_IDLE request",       p_set_tbl,             class_qty * id_qty);
+    USBD_Bench_StatPrint("GET_IDLE request",       p_get_tbl,             class_qty * id_qty);
+    USBD_Bench_StatPrint("timer tick (CPU)",       USBD_Bench_HID_TickTbl, tick_nbr);
+    printf("  %u ticks: %u idle reports received, %u due at the idle rates set\n",
+           (unsigned)tick_nbr,
+           (unsigned)rx_cnt,
+           (unsigned)rx_expected);
+
+    free(p_desc);
+    free(p_add_tbl);
+    free(p_set_tbl);
+    free(p_get_tbl);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_HID_Host()
+*
+* Description : Host thread polling the interrupt IN endpoint of one HID instance.
+*
+* Argument(s) : p_arg       Pointer to the instance's counter in USBD_Bench_HID_RxCntTbl.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_Bench_HID_Host (void  *p_arg)
+{
+    CPU_INT32U  *p_cnt;
+    CPU_INT08U   ix;
+    CPU_INT08U   buf[USBD_BENCH_HID_REPORT_LEN + 1u];
+    USBD_ERR     err;
+
+
+    p_cnt = (CPU_INT32U *)p_arg;
+    ix    = (CPU_INT08U)(p_cnt - &USBD_Bench_HID_RxCntTbl[0]);
+
+    while (USBD_Bench_HID_PollEn == DEF_YES) {
+        (void)USBD_DrvLoopback_HostIn(USBD_Bench_DevNbr,
+                                      USBD_Bench_HID_EP_InTbl[ix],
+                                      buf,
+                                      sizeof(buf),
+                                      USBD_BENCH_HID_POLL_TIMEOUT_mS,
+                                     &err);
+        if (err == USBD_ERR_NONE) {
+           *p_cnt += 1u;
+        }
+    }
+
+    return (DEF_NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_Bench_HID_RateGet()
+*
+* Description : Get the idle rate given to a report ID.
+*
+* Argument(s) : class_ix    HID instance index.
+*
+*               report_id   Report ID.
+*
+* Return(s)   : Idle rate, in 4 ms units, spread over 1..255.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  USBD_Bench_HID_RateGet (CPU_INT08U  class_ix,
+                                            CPU_INT08U  report_id)
+{
+    return ((CPU_INT08U)(1u + ((class_ix * 131u) + (report_id * 37u)) % 255u));
+}
+
+
+/*
+*********************************************************************************************************
+*                              __wrap_USBD_HID_Report_TmrTaskHandler()
+*
+* Description : Time the HID idle report timer tick (see Note #3 at the top of this file).
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The identifiers below are imposed by the linker's '--wrap' option.
+*********************************************************************************************************
+*/
+
+void  __real_USBD_HID_Report_TmrTaskHandler(void);
+void  __wrap_USBD_HID_Report_TmrTaskHandler(void);
+
+void  __wrap_USBD_HID_Report_TmrTaskHandler (void)
+{
+    CPU_INT64U  ts;
+
+
+    ts = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID);
+    __real_USBD_HID_Report_TmrTaskHandler();
+    ts = USBD_Bench_TsGet(CLOCK_THREAD_CPUTIME_ID) - ts;
+
+    (void)pthread_mutex_lock(&USBD_Bench_HID_TickMutex);
+    if ((USBD_Bench_HID_TickEn == DEF_YES) &&
+        (USBD_Bench_HID_TickNbr < USBD_Bench_HID_TickNbrMax)) {
+        USBD_Bench_HID_TickTbl[USBD_Bench_HID_TickNbr] = ts;
+        USBD_Bench_HID_TickNbr++;
+    }
+    (void)pthread_mutex_unlock(&USBD_Bench_HID_TickMutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Audio()
+*
+* Description : Measure an 8-channel audio playback stream at the byte rate of 192 kHz, 16-bit samples.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [ms] duration of the stream, [pkt_per_ms] isochronous packets
+*                           sent, and codec buffers played, per millisecond.
+*
+* Return(s)   : DEF_OK,   if the stream ran and the codec played the packets in order.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The Audio 1.0 class sends one packet per frame and limits the sampling frequency to
+*                   96 kHz, so that 192 kHz cannot be declared. The speaker is declared at 48 kHz, 8 ch,
+*                   16-bit (768 octets per millisecond) and the host sends 'pkt_per_ms' of these packets
+*                   per millisecond, while the codec plays one buffer per packet period. The default of 4
+*                   packets per millisecond carries the 3.072 MB/s of a 192 kHz, 8 ch, 16-bit stream.
+*
+*               (2) The codec of this file stands for the DMA of a real one (see USBD_Bench_AudioCodec()).
+*                   The host writes a sequence number in each packet, and the codec checks that the
+*                   buffers it plays come in order.
+*
+*               (3) A packet that the device does not accept within 1 ms is dropped by the host, as an
+*                   isochronous packet would be.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_Audio (int     argc,
+                                       char  **argv)
+{
+    CPU_INT32U               run_ms;
+    CPU_INT32U               pkt_per_ms;
+    CPU_INT32U               pkt_nbr;
+    CPU_INT32U               pkt;
+    CPU_INT32U               sent_nbr;
+    CPU_INT32U               drop_nbr;
+    CPU_INT64U              *p_time_tbl;
+    CPU_INT64U               ts;
+    CPU_INT64U               ts_start;
+    CPU_INT64U               run_ns;
+    CPU_INT64U               cpu_ns;
+    struct  timespec         ts_next;
+    pthread_t                thread;
+    CPU_INT08U               audio_nbr;
+    CPU_INT08U               it_id;
+    CPU_INT08U               ot_id;
+    CPU_INT08U               fu_id;
+    CPU_INT08U               ep_out;
+    USBD_AUDIO_AS_IF_HANDLE  as_if_handle;
+    CPU_INT08U               buf[USBD_BENCH_AUDIO_PKT_LEN];
+    CPU_BOOLEAN              ok;
+    USBD_ERR                 err;
+
+
+    run_ms     = USBD_Bench_ArgGet(argc, argv, 0, 2000u);
+    pkt_per_ms = USBD_Bench_ArgGet(argc, argv, 1, 4u);
+    if ((pkt_per_ms == 0u) ||
+        (pkt_per_ms >  USBD_BENCH_AUDIO_PKT_PER_mS_MAX)) {
+        printf("pkt_per_ms must be 1..%u\n", (unsigned)USBD_BENCH_AUDIO_PKT_PER_mS_MAX);
+        return (DEF_FAIL);
+    }
+    pkt_nbr                       = run_ms * pkt_per_ms;
+    USBD_Bench_AudioTickPeriod_ns = (CPU_INT32U)(USBD_BENCH_NS_PER_mS / pkt_per_ms);
+
+    ok = USBD_Bench_DevInit(DEF_NO);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+                                                                /* Speaker: IT (USB OUT) -> FU -> OT (speaker).         */
+    it_id        = 0u;
+    as_if_handle = 0u;
+    USBD_Audio_Init(USBD_BENCH_AUDIO_Q_LEN, &err);
+    if (err == USBD_ERR_NONE) {
+        audio_nbr = USBD_Audio_Add(3u, &USBD_Bench_AudioCommonAPI, &USBD_Bench_AudioEventFncts, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Audio_CfgAdd(audio_nbr, USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        it_id = USBD_Audio_IT_Add(audio_nbr, &USBD_Bench_AudioIT_Cfg, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        ot_id = USBD_Audio_OT_Add(audio_nbr, &USBD_Bench_AudioOT_Cfg, DEF_NULL, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        fu_id = USBD_Audio_FU_Add(audio_nbr, &USBD_Bench_AudioFU_Cfg, &USBD_Bench_AudioFU_API, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Audio_IT_Assoc(audio_nbr, it_id, USBD_AUDIO_TERMINAL_NO_ASSOCIATION, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Audio_OT_Assoc(audio_nbr, ot_id, fu_id, USBD_AUDIO_TERMINAL_NO_ASSOCIATION, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Audio_FU_Assoc(audio_nbr, fu_id, it_id, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        as_if_handle = USBD_Audio_AS_IF_Cfg(&USBD_Bench_AudioStreamCfg,
+                                            &USBD_Bench_AudioAS_IF_Cfg,
+                                            &USBD_Bench_AudioAS_API,
+                                             DEF_NULL,
+                                             it_id,
+                                             DEF_NULL,
+                                            &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Audio_AS_IF_Add(audio_nbr, USBD_Bench_CfgNbrHS, as_if_handle, &USBD_Bench_AudioAS_IF_Cfg,
+                             "Speaker", &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("audio add failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_DevStart(DEF_YES);
+    if (ok != DEF_OK) {
+        return (DEF_FAIL);
+    }
+    ep_out = USBD_Bench_EP_AddrGet(USBD_BENCH_AUDIO_IF_NBR, 1u, DEF_NO);
+
+    p_time_tbl              = (CPU_INT64U *)malloc(pkt_nbr * sizeof(CPU_INT64U));
+    USBD_Bench_AudioTickTbl = (CPU_INT64U *)malloc(pkt_nbr * sizeof(CPU_INT64U));
+    if ((p_time_tbl              == DEF_NULL) ||
+        (USBD_Bench_AudioTickTbl == DEF_NULL)) {
+        return (DEF_FAIL);
+    }
+                                                                /* Open the stream.                                     */
+    (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_HOST_TO_DEVICE | USBD_REQ_RECIPIENT_INTERFACE, USBD_REQ_SET_INTERFACE,
+                              1u, USBD_BENCH_AUDIO_IF_NBR, 0u, DEF_NULL, &err);
+    if (err != USBD_ERR_NONE) {
+        printf("SET_INTERFACE failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    Mem_Clr(buf, sizeof(buf));
+    sent_nbr = 0u;
+    drop_nbr = 0u;
+    ts_start = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+    cpu_ns   = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID);
+    (void)pthread_create(&thread, DEF_NULL, USBD_Bench_AudioCodec, (void *)&pkt_nbr);
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts_next);
+    for (pkt = 0u; pkt < pkt_nbr; pkt++) {
+        MEM_VAL_SET_INT32U_LITTLE(&buf[0], pkt);                /* See Note #2.                                         */
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        (void)USBD_DrvLoopback_HostOut(USBD_Bench_DevNbr, ep_out, buf, sizeof(buf), DEF_NO, 1u, &err);
+        if (err == USBD_ERR_NONE) {
+            p_time_tbl[sent_nbr] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+            sent_nbr++;
+        } else if (err == USBD_ERR_OS_TIMEOUT) {                /* See Note #3.                                         */
+            drop_nbr++;
+        } else {
+            printf("isoc OUT %u failed (err %d)\n", (unsigned)pkt, (int)err);
+            break;
+        }
+
+        ts_next.tv_nsec += (long)USBD_Bench_AudioTickPeriod_ns;
+        if (ts_next.tv_nsec >= (long)USBD_BENCH_NS_PER_SEC) {
+            ts_next.tv_nsec -= (long)USBD_BENCH_NS_PER_SEC;
+            ts_next.tv_sec++;
+        }
+        (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts_next, DEF_NULL);
+    }
+
+    (void)pthread_join(thread, DEF_NULL);
+    run_ns = USBD_Bench_TsGet(CLOCK_MONOTONIC)          - ts_start;
+    cpu_ns = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID) - cpu_ns;
+                                                                /* Close the stream.                                    */
+    (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_HOST_TO_DEVICE | USBD_REQ_RECIPIENT_INTERFACE, USBD_REQ_SET_INTERFACE,
+                              0u, USBD_BENCH_AUDIO_IF_NBR, 0u, DEF_NULL, &err);
+
+    printf("audio: 48 kHz, 8 ch, 16-bit, %u x %u-octet pkt/ms (%.3f MB/s), %u ms\n",
+           (unsigned)pkt_per_ms,
+           (unsigned)USBD_BENCH_AUDIO_PKT_LEN,
+           (double)pkt_per_ms * USBD_BENCH_AUDIO_PKT_LEN / 1000.0,
+           (unsigned)run_ms);
+    USBD_Bench_StatPrint("isoc OUT pkt (host)", p_time_tbl,              sent_nbr);
+    USBD_Bench_StatPrint("codec period",        USBD_Bench_AudioTickTbl, USBD_Bench_AudioTickNbr);
+    printf("  %-24s %u sent, %u dropped; %u played, %u silent, %u out of order\n",
+           "packets",
+           (unsigned)sent_nbr,
+           (unsigned)drop_nbr,
+           (unsigned)USBD_Bench_AudioPlayNbr,
+           (unsigned)USBD_Bench_AudioSilenceNbr,
+           (unsigned)USBD_Bench_AudioSeqErrNbr);
+    printf("  %-24s %.3f MB/s played, %.1f %% of one CPU, %.3f us CPU per pkt\n",
+           "throughput",
+           (double)USBD_Bench_AudioPlayNbr * USBD_BENCH_AUDIO_PKT_LEN * 1000.0 / run_ns,
+           (double)cpu_ns * 100.0 / run_ns,
+           (double)cpu_ns / pkt_nbr / USBD_BENCH_NS_PER_uS);
+
+    free(p_time_tbl);
+    free(USBD_Bench_AudioTickTbl);
+
+    if ((USBD_Bench_AudioSeqErrNbr != 0u) ||
+        (USBD_Bench_AudioPlayNbr   == 0u)) {
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_AudioCodec()
+*
+* Description : Codec thread of the 'audio' mode: play one buffer per packet period.
+*
+* Argument(s) : p_arg       Pointer to the number of periods to run.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Each period stands for the DMA completion interrupt of a codec : the buffer played is
+*                   copied to the DAC buffer, freed, and the playback task is signaled to queue the next
+*                   one. A period without a queued buffer plays silence.
+*
+*               (2) Time spent in each period is recorded in USBD_Bench_AudioTickTbl.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  void  *USBD_Bench_AudioCodec (void  *p_arg)
+{
+    CPU_INT32U        tick_nbr;
+    CPU_INT32U        tick;
+    CPU_INT32U        seq;
+    CPU_INT08U       *p_buf;
+    CPU_INT16U        buf_len;
+    CPU_BOOLEAN       started;
+    CPU_INT64U        ts;
+    struct  timespec  ts_next;
+
+
+    tick_nbr = *(CPU_INT32U *)p_arg;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts_next);
+    for (tick = 0u; tick < tick_nbr; tick++) {
+        ts_next.tv_nsec += (long)USBD_Bench_AudioTickPeriod_ns;
+        if (ts_next.tv_nsec >= (long)USBD_BENCH_NS_PER_SEC) {
+            ts_next.tv_nsec -= (long)USBD_BENCH_NS_PER_SEC;
+            ts_next.tv_sec++;
+        }
+        (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts_next, DEF_NULL);
+
+        ts      = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        p_buf   = DEF_NULL;
+        buf_len = 0u;
+        (void)pthread_mutex_lock(&USBD_Bench_AudioMutex);
+        started = USBD_Bench_AudioStarted;
+        if (USBD_Bench_AudioBufNbr > 0u) {                      /* Oldest buf queued to the codec.                      */
+            p_buf   = USBD_Bench_AudioBufTbl[USBD_Bench_AudioBufIxOut];
+            buf_len = USBD_Bench_AudioBufLenTbl[USBD_Bench_AudioBufIxOut];
+            USBD_Bench_AudioBufIxOut = (USBD_Bench_AudioBufIxOut + 1u) % USBD_BENCH_AUDIO_CODEC_BUF_NBR;
+            USBD_Bench_AudioBufNbr--;
+        }
+        (void)pthread_mutex_unlock(&USBD_Bench_AudioMutex);
+
+        if (started == DEF_YES) {
+            if (p_buf != DEF_NULL) {                            /* See Note #1.                                         */
+                seq = MEM_VAL_GET_INT32U_LITTLE(p_buf);
+                if ((USBD_Bench_AudioPlayNbr > 0u) &&
+                    (seq < USBD_Bench_AudioSeqNext)) {
+                    USBD_Bench_AudioSeqErrNbr++;
+                }
+                USBD_Bench_AudioSeqNext = seq + 1u;
+                Mem_Copy(USBD_Bench_AudioDAC_Buf, p_buf, DEF_MIN(buf_len, sizeof(USBD_Bench_AudioDAC_Buf)));
+                USBD_Bench_AudioPlayNbr++;
+
+                USBD_Audio_PlaybackBufFree(USBD_Bench_AudioAsHandle, DEF_NULL);
+                USBD_Audio_PlaybackTxCmpl(USBD_Bench_AudioAsHandle);
+            } else {
+                USBD_Bench_AudioSilenceNbr++;
+            }
+        }
+
+        USBD_Bench_AudioTickTbl[tick] = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+        USBD_Bench_AudioTickNbr++;
+    }
+
+    return (DEF_NULL);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_AudioInit()
+*
+* Description : Initialize the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv     Pointer to audio driver structure (not used).
+*
+*               p_err           Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  void  USBD_Bench_AudioInit (USBD_AUDIO_DRV  *p_audio_drv,
+                                    USBD_ERR        *p_err)
+{
+    (void)p_audio_drv;
+
+    USBD_Bench_AudioSamplingFreq = USBD_AUDIO_FMT_TYPE_I_SAMFREQ_48KHZ;
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_AudioMute()
+*
+* Description : Get or set the mute state of the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv     Pointer to audio driver structure (not used).
+*
+*               unit_id         Feature Unit ID (not used).
+*
+*               log_ch_nbr      Logical channel number (not used).
+*
+*               set_en          DEF_YES, to set the mute state; DEF_NO, to get it.
+*
+*               p_mute          Pointer to mute state.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : (1) The codec has a single mute and volume control, on the master channel.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_AudioMute (USBD_AUDIO_DRV  *p_audio_drv,
+                                           CPU_INT08U       unit_id,
+                                           CPU_INT08U       log_ch_nbr,
+                                           CPU_BOOLEAN      set_en,
+                                           CPU_BOOLEAN     *p_mute)
+{
+    (void)p_audio_drv;
+    (void)unit_id;
+    (void)log_ch_nbr;
+
+    if (set_en == DEF_YES) {
+        USBD_Bench_AudioMuteCur = *p_mute;
+    } else {
+       *p_mute = USBD_Bench_AudioMuteCur;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_AudioVol()
+*
+* Description : Handle a volume request to the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv     Pointer to audio driver structure (not used).
+*
+*               req             Audio class request.
+*
+*               unit_id         Feature Unit ID (not used).
+*
+*               log_ch_nbr      Logical channel number (not used).
+*
+*               p_vol           Pointer to volume.
+*
+* Return(s)   : DEF_OK,   if the request is supported.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) See USBD_Bench_AudioMute() Note #1.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_AudioVol (USBD_AUDIO_DRV  *p_audio_drv,
+                                          CPU_INT08U       req,
+                                          CPU_INT08U       unit_id,
+                                          CPU_INT08U       log_ch_nbr,
+                                          CPU_INT16U      *p_vol)
+{
+    (void)p_audio_drv;
+    (void)unit_id;
+    (void)log_ch_nbr;
+
+    switch (req) {
+        case USBD_AUDIO_REQ_GET_CUR:
+            *p_vol = USBD_Bench_AudioVolCur;
+             break;
+
+        case USBD_AUDIO_REQ_GET_MIN:
+            *p_vol = 0x8001u;                                   /* -127.9961 dB.                                        */
+             break;
+
+        case USBD_AUDIO_REQ_GET_MAX:
+            *p_vol = 0x7FFFu;                                   /* +127.9961 dB.                                        */
+             break;
+
+        case USBD_AUDIO_REQ_GET_RES:
+            *p_vol = 0x0100u;                                   /* 1 dB.                                                */
+             break;
+
+        case USBD_AUDIO_REQ_SET_CUR:
+             USBD_Bench_AudioVolCur = *p_vol;
+             break;
+
+        default:
+             return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_AudioFreq()
+*
+* Description : Get or set the sampling frequency of the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv         Pointer to audio driver structure (not used).
+*
+*               terminal_id_link    Terminal ID linked to the AudioStreaming interface (not used).
+*
+*               set_en              DEF_YES, to set the sampling frequency; DEF_NO, to get it.
+*
+*               p_sampling_freq     Pointer to sampling frequency.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_AudioFreq (USBD_AUDIO_DRV  *p_audio_drv,
+                                           CPU_INT08U       terminal_id_link,
+                                           CPU_BOOLEAN      set_en,
+                                           CPU_INT32U      *p_sampling_freq)
+{
+    (void)p_audio_drv;
+    (void)terminal_id_link;
+
+    if (set_en == DEF_YES) {
+        USBD_Bench_AudioSamplingFreq = *p_sampling_freq;
+    } else {
+       *p_sampling_freq = USBD_Bench_AudioSamplingFreq;
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_AudioStart()
+*
+* Description : Start the playback stream of the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv         Pointer to audio driver structure (not used).
+*
+*               as_handle           AudioStreaming interface handle.
+*
+*               terminal_id_link    Terminal ID linked to the AudioStreaming interface (not used).
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : (1) The playback task is signaled once per codec buffer, so that it queues the first
+*                   buffers as soon as they are ready.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_AudioStart (USBD_AUDIO_DRV        *p_audio_drv,
+                                            USBD_AUDIO_AS_HANDLE   as_handle,
+                                            CPU_INT08U             terminal_id_link)
+{
+    CPU_INT08U  ix;
+
+
+    (void)p_audio_drv;
+    (void)terminal_id_link;
+
+    (void)pthread_mutex_lock(&USBD_Bench_AudioMutex);
+    USBD_Bench_AudioAsHandle = as_handle;
+    USBD_Bench_AudioBufIxIn  = 0u;
+    USBD_Bench_AudioBufIxOut = 0u;
+    USBD_Bench_AudioBufNbr   = 0u;
+    USBD_Bench_AudioStarted  = DEF_YES;
+    (void)pthread_mutex_unlock(&USBD_Bench_AudioMutex);
+
+    for (ix = 0u; ix < USBD_BENCH_AUDIO_CODEC_BUF_NBR; ix++) {  /* See Note #1.                                         */
+        USBD_Audio_PlaybackTxCmpl(as_handle);
+    }
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_AudioStop()
+*
+* Description : Stop the playback stream of the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv         Pointer to audio driver structure (not used).
+*
+*               terminal_id_link    Terminal ID linked to the AudioStreaming interface (not used).
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_AudioStop (USBD_AUDIO_DRV  *p_audio_drv,
+                                           CPU_INT08U       terminal_id_link)
+{
+    (void)p_audio_drv;
+    (void)terminal_id_link;
+
+    (void)pthread_mutex_lock(&USBD_Bench_AudioMutex);
+    USBD_Bench_AudioStarted = DEF_NO;
+    USBD_Bench_AudioBufNbr  = 0u;                               /* Drop the bufs queued to the codec.                   */
+    (void)pthread_mutex_unlock(&USBD_Bench_AudioMutex);
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_Bench_AudioTx()
+*
+* Description : Queue a playback buffer to the 'audio' mode codec.
+*
+* Argument(s) : p_audio_drv         Pointer to audio driver structure (not used).
+*
+*               terminal_id_link    Terminal ID linked to the AudioStreaming interface (not used).
+*
+*               p_buf               Pointer to audio samples.
+*
+*               buf_len             Buffer length, in octets.
+*
+*               p_err               Pointer to variable that will receive the return error code from this function :
+*
+*                                       USBD_ERR_NONE   Buffer queued.
+*                                       USBD_ERR_TX     Codec queue full, or stream stopped.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_BENCH_CFG_AUDIO_EN == DEF_ENABLED)
+static  void  USBD_Bench_AudioTx (USBD_AUDIO_DRV  *p_audio_drv,
+                                  CPU_INT08U       terminal_id_link,
+                                  void            *p_buf,
+                                  CPU_INT16U       buf_len,
+                                  USBD_ERR        *p_err)
+{
+    (void)p_audio_drv;
+    (void)terminal_id_link;
+
+   *p_err = USBD_ERR_TX;
+    (void)pthread_mutex_lock(&USBD_Bench_AudioMutex);
+    if ((USBD_Bench_AudioStarted == DEF_YES) &&
+        (USBD_Bench_AudioBufNbr  <  USBD_BENCH_AUDIO_CODEC_BUF_NBR)) {
+        USBD_Bench_AudioBufTbl[USBD_Bench_AudioBufIxIn]    = (CPU_INT08U *)p_buf;
+        USBD_Bench_AudioBufLenTbl[USBD_Bench_AudioBufIxIn] =  buf_len;
+        USBD_Bench_AudioBufIxIn = (USBD_Bench_AudioBufIxIn + 1u) % USBD_BENCH_AUDIO_CODEC_BUF_NBR;
+        USBD_Bench_AudioBufNbr++;
+       *p_err = USBD_ERR_NONE;
+    }
+    (void)pthread_mutex_unlock(&USBD_Bench_AudioMutex);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_Bench_Trace()
+*
+* Description : Measure the cost of a debug trace event.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments: [n] number of events.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : (1) The call site cost is the time spent in USBD_DbgArg(), less the cost of reading the clock.
+*                   The CPU cost per event is the process CPU time, which also includes the debug task's
+*                   formatting in text mode.
+*
+*               (2) In text mode, events come from a pool of USBD_CFG_DBG_TRACE_NBR_EVENTS that the debug task
+*                   empties. The caller waits for the task to catch up whenever half of the pool was used, so
+*                   that no event is dropped.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_Bench_Trace (int     argc,
+                                       char  **argv)
+{
+    CPU_INT32U   iter_nbr;
+    CPU_INT32U   iter;
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED)
+    CPU_INT32U   line_cnt_start;
+    CPU_INT32U   line_cnt;
+#endif
+    CPU_INT64U  *p_time_tbl;
+    CPU_INT64U   ts;
+    CPU_INT64U   ts_ovh;
+    CPU_INT64U   ts_cpu;
+    USBD_ERR     err;
+
+
+    iter_nbr = USBD_Bench_ArgGet(argc, argv, 0, 100000u);
+
+    USBD_Init(&err);
+    if (err != USBD_ERR_NONE) {
+        printf("USBD_Init() failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    p_time_tbl = (CPU_INT64U *)malloc(iter_nbr * sizeof(CPU_INT64U));
+    if (p_time_tbl == DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    ts_ovh = USBD_BENCH_NS_PER_SEC;                             /* Min cost of reading the clock.                       */
+    for (iter = 0u; iter < 1000u; iter++) {
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+        if (ts < ts_ovh) {
+            ts_ovh = ts;
+        }
+    }
+
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED)
+    (void)pthread_mutex_lock(&USBD_Bench_TraceMutex);
+    line_cnt_start = USBD_Bench_TraceLineCnt;
+    (void)pthread_mutex_unlock(&USBD_Bench_TraceMutex);
+#endif
+
+    ts_cpu = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID);        /* See Note #1.                                         */
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC);
+        USBD_DbgArg("bench event arg: ", 0x81u, 0u, iter, USBD_ERR_NONE);
+        ts = USBD_Bench_TsGet(CLOCK_MONOTONIC) - ts;
+        p_time_tbl[iter] = (ts > ts_ovh) ? (ts - ts_ovh) : 0u;
+
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED)                 /* See Note #2.                                         */
+        if (((iter + 1u) % USBD_BENCH_TRACE_BATCH_NBR_EVENTS) == 0u) {
+            do {
+                (void)pthread_mutex_lock(&USBD_Bench_TraceMutex);
+                line_cnt = USBD_Bench_TraceLineCnt - line_cnt_start;
+                (void)pthread_mutex_unlock(&USBD_Bench_TraceMutex);
+                if (line_cnt <= iter) {
+                    USBD_OS_DlyMs(0u);
+                }
+            } while (line_cnt <= iter);
+        }
+#endif
+    }
+    ts_cpu = USBD_Bench_TsGet(CLOCK_PROCESS_CPUTIME_ID) - ts_cpu;
+
+    printf("trace: %u x USBD_DbgArg(), %s mode: %.1f ns CPU/event (clock read %u ns excluded at call site)\n",
+           (unsigned)iter_nbr,
+           (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED) ? "binary" : "text",
+           (double)ts_cpu / iter_nbr,
+           (unsigned)ts_ovh);
+    USBD_Bench_StatPrint("call site", p_time_tbl, iter_nbr);
+    free(p_time_tbl);
+
+    return (DEF_OK);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_Trace()
+*
+* Description : Output a debug trace line.
+*
+* Argument(s) : p_str       Pointer to string to output.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The trace is not printed, so that its output does not weigh on the measurements; lines
+*                   are only counted.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+void  USBD_Trace (const  CPU_CHAR  *p_str)
+{
+    if (strchr(p_str, '\n') != DEF_NULL) {
+        (void)pthread_mutex_lock(&USBD_Bench_TraceMutex);
+        USBD_Bench_TraceLineCnt++;
+        (void)pthread_mutex_unlock(&USBD_Bench_TraceMutex);
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_DevInit()
+*
+* Description : Initialize the stack and add the loopback device with its high-speed configuration.
+*
+* Argument(s) : fs_en       DEF_YES, to also add a full-speed configuration as other-speed configuration.
+*
+* Return(s)   : DEF_OK,   if the device was added.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_DevInit (CPU_BOOLEAN  fs_en)
+{
+    USBD_ERR  err;
+
+
+    USBD_Init(&err);
+    if (err == USBD_ERR_NONE) {
+        USBD_Bench_DevNbr = USBD_DevAdd(&USBD_Bench_DevCfg,
+                                        &USBD_Bench_BusFncts,
+                                        &USBD_DrvAPI_Loopback,
+                                        &USBD_Bench_DrvCfg,
+                                        &USBD_DrvBSP_Loopback,
+                                        &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        USBD_Bench_CfgNbrHS = USBD_CfgAdd(USBD_Bench_DevNbr,
+                                          USBD_DEV_ATTRIB_SELF_POWERED,
+                                          100u,
+                                          USBD_DEV_SPD_HIGH,
+                                          "HS configuration",
+                                          &err);
+    }
+    if ((err   == USBD_ERR_NONE) &&
+        (fs_en == DEF_YES)) {
+        USBD_Bench_CfgNbrFS = USBD_CfgAdd(USBD_Bench_DevNbr,
+                                          USBD_DEV_ATTRIB_SELF_POWERED,
+                                          100u,
+                                          USBD_DEV_SPD_FULL,
+                                          "FS configuration",
+                                          &err);
+        if (err == USBD_ERR_NONE) {
+            USBD_CfgOtherSpeed(USBD_Bench_DevNbr, USBD_Bench_CfgNbrHS, USBD_Bench_CfgNbrFS, &err);
+        }
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("device init failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_DevStart()
+*
+* Description : Start the device and, optionally, attach and enumerate it.
+*
+* Argument(s) : enum_en     DEF_YES, to attach and enumerate the device.
+*
+* Return(s)   : DEF_OK,   if the device was started (and enumerated).
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_DevStart (CPU_BOOLEAN  enum_en)
+{
+    CPU_BOOLEAN  ok;
+    USBD_ERR     err;
+
+
+    USBD_DevStart(USBD_Bench_DevNbr, &err);
+    if (err != USBD_ERR_NONE) {
+        printf("device start failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    if (enum_en == DEF_NO) {
+        return (DEF_OK);
+    }
+
+    USBD_DrvLoopback_HostAttach(USBD_Bench_DevNbr, &err);
+    if (err != USBD_ERR_NONE) {
+        printf("attach failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    ok = USBD_Bench_HostEnum();
+
+    return (ok);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_HostEnum()
+*
+* Description : Enumerate the device the way a host does.
+*
+* Argument(s) : none.
+*
+* Return(s)   : DEF_OK,   if the device was configured.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The configuration descriptor is kept in USBD_Bench_DescBuf, to look up the endpoint
+*                   addresses (see USBD_Bench_EP_AddrGet()).
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_Bench_HostEnum (void)
+{
+    CPU_INT08U  buf[255u];
+    CPU_INT16U  total_len;
+    CPU_INT08U  str_ix;
+    USBD_ERR    err;
+
+
+    (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST, USBD_REQ_GET_DESCRIPTOR,
+                             (USBD_DESC_TYPE_DEVICE << 8u), 0u, 64u, buf, &err);
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_HOST_TO_DEVICE, USBD_REQ_SET_ADDRESS,
+                                  USBD_BENCH_DEV_ADDR, 0u, 0u, DEF_NULL, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST, USBD_REQ_GET_DESCRIPTOR,
+                                 (USBD_DESC_TYPE_DEVICE << 8u), 0u, USBD_DESC_LEN_DEV, buf, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST, USBD_REQ_GET_DESCRIPTOR,
+                                 (USBD_DESC_TYPE_CONFIGURATION << 8u), 0u, USBD_DESC_LEN_CFG, buf, &err);
+    }
+    if (err == USBD_ERR_NONE) {                                 /* See Note #1.                                         */
+        total_len = MEM_VAL_GET_INT16U_LITTLE(&buf[2]);
+        if (total_len > USBD_BENCH_DESC_BUF_LEN) {
+            total_len = USBD_BENCH_DESC_BUF_LEN;
+        }
+        USBD_Bench_DescLen = USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST, USBD_REQ_GET_DESCRIPTOR,
+                                                (USBD_DESC_TYPE_CONFIGURATION << 8u), 0u, total_len,
+                                                 USBD_Bench_DescBuf, &err);
+    }
+    for (str_ix = 0u; (str_ix <= 3u) && (err == USBD_ERR_NONE); str_ix++) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_DEVICE_TO_HOST, USBD_REQ_GET_DESCRIPTOR,
+                                 ((USBD_DESC_TYPE_STRING << 8u) | str_ix), USBD_LANG_ID_ENGLISH_US,
+                                  sizeof(buf), buf, &err);
+    }
+    if (err == USBD_ERR_NONE) {
+        (void)USBD_Bench_HostCtrl(USBD_REQ_DIR_HOST_TO_DEVICE, USBD_REQ_SET_CONFIGURATION,
+                                  1u, 0u, 0u, DEF_NULL, &err);
+    }
+    if (err != USBD_ERR_NONE) {
+        printf("enumeration failed (err %d)\n", (int)err);
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_HostCtrl()
+*
+* Description : Perform a control transfer from the host.
+*
+* Argument(s) : req_type    bmRequestType.
+*
+*               req         bRequest.
+*
+*               val         wValue.
+*
+*               ix          wIndex.
+*
+*               len         wLength.
+*
+*               p_buf       Pointer to data stage buffer.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function.
+*
+* Return(s)   : Number of octets transferred during the data stage.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_Bench_HostCtrl (CPU_INT08U   req_type,
+                                         CPU_INT08U   req,
+                                         CPU_INT16U   val,
+                                         CPU_INT16U   ix,
+                                         CPU_INT16U   len,
+                                         CPU_INT08U  *p_buf,
+                                         USBD_ERR    *p_err)
+{
+    CPU_INT08U  setup[8u];
+    CPU_INT32U  xfer_len;
+
+
+    setup[0] = req_type;
+    setup[1] = req;
+    MEM_VAL_SET_INT16U_LITTLE(&setup[2], val);
+    MEM_VAL_SET_INT16U_LITTLE(&setup[4], ix);
+    MEM_VAL_SET_INT16U_LITTLE(&setup[6], len);
+
+    xfer_len = USBD_DrvLoopback_HostCtrlXfer(USBD_Bench_DevNbr,
+                                             setup,
+                                             p_buf,
+                                             USBD_BENCH_CTRL_TIMEOUT_mS,
+                                             p_err);
+
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_EP_AddrGet()
+*
+* Description : Find an endpoint of an interface in the configuration descriptor read during enumeration.
+*
+* Argument(s) : if_nbr      Interface number.
+*
+*               alt_nbr     Alternate setting number.
+*
+*               dir_in      DEF_YES, for an IN endpoint; DEF_NO, for an OUT endpoint.
+*
+* Return(s)   : Address of the first endpoint with that direction in the alternate setting,
+*
+*               USBD_EP_ADDR_NONE, if none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  USBD_Bench_EP_AddrGet (CPU_INT08U   if_nbr,
+                                           CPU_INT08U   alt_nbr,
+                                           CPU_BOOLEAN  dir_in)
+{
+    CPU_INT32U   ix;
+    CPU_INT08U  *p_desc;
+    CPU_BOOLEAN  in_if;
+    CPU_BOOLEAN  ep_in;
+
+
+    in_if = DEF_NO;
+    ix    = 0u;
+    while ((ix + 2u) < USBD_Bench_DescLen) {
+        p_desc = &USBD_Bench_DescBuf[ix];
+        if (p_desc[0] == 0u) {
+            break;
+        }
+
+        if (p_desc[1] == USBD_DESC_TYPE_INTERFACE) {
+            in_if = ((p_desc[2] == if_nbr) && (p_desc[3] == alt_nbr)) ? DEF_YES : DEF_NO;
+
+        } else if ((p_desc[1] == USBD_DESC_TYPE_ENDPOINT) &&
+                   (in_if     == DEF_YES)) {
+            ep_in = DEF_BIT_IS_SET(p_desc[2], USBD_EP_DIR_BIT);
+            if (ep_in == dir_in) {
+                return (p_desc[2]);
+            }
+        }
+
+        ix += p_desc[0];
+    }
+
+    return (USBD_EP_ADDR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_Bench_ArgGet()
+*
+* Description : Get a numeric mode argument.
+*
+* Argument(s) : argc        Number of mode arguments.
+*
+*               argv        Mode arguments.
+*
+*               ix          Index of the argument.
+*
+*               dflt        Value used when the argument is not given.
+*
+* Return(s)   : Argument value.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_Bench_ArgGet (int          argc,
+                                       char       **argv,
+                                       int          ix,
+                                       CPU_INT32U   dflt)
+{
+    if (ix >= argc) {
+        return (dflt);
+    }
+
+    return ((CPU_INT32U)strtoul(argv[ix], DEF_NULL, 0));
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_Bench_TsGet()
+*
+* Description : Read a clock.
+*
+* Argument(s) : clk_id      Clock to read.
+*
+* Return(s)   : Clock value, in nanoseconds.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT64U  USBD_Bench_TsGet (clockid_t  clk_id)
+{
+    struct  timespec  ts;
+
+
+    (void)clock_gettime(clk_id, &ts);
+
+    return (((CPU_INT64U)ts.tv_sec * USBD_BENCH_NS_PER_SEC) + (CPU_INT64U)ts.tv_nsec);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_Bench_StatPrint()
+*
+* Description : Print the minimum, median and maximum of a set of samples.
+*
+* Argument(s) : p_name      Pointer to name of the samples.
+*
+*               p_tbl       Pointer to table of samples, in nanoseconds. The table is sorted in place.
+*
+*               nbr         Number of samples.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_Bench_StatPrint (const  CPU_CHAR    *p_name,
+                                           CPU_INT64U  *p_tbl,
+                                           CPU_INT32U   nbr)
+{
+    if (nbr == 0u) {
+        printf("  %-24s no sample\n", p_name);
+        return;
+    }
+
+    qsort(p_tbl, nbr, sizeof(CPU_INT64U), USBD_Bench_StatCmp);
+
+    printf("  %-24s n=%-7u min %10.3f  median %10.3f  max %10.3f us\n",
+           p_name,
+           (unsigned)nbr,
+           (double)p_tbl[0]         / USBD_BENCH_NS_PER_uS,
+           (double)p_tbl[nbr / 2u]  / USBD_BENCH_NS_PER_uS,
+           (double)p_tbl[nbr - 1u]  / USBD_BENCH_NS_PER_uS);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_Bench_StatCmp()
+*
+* Description : Compare two samples, for qsort().
+*
+* Argument(s) : p_a         Pointer to first  sample.
+*
+*               p_b         Pointer to second sample.
+*
+* Return(s)   : Negative, zero or positive value, as the first sample is less than, equal to or greater
+*               than the second.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  int  USBD_Bench_StatCmp (const  void  *p_a,
+                                 const  void  *p_b)
+{
+    CPU_INT64U  a;
+    CPU_INT64U  b;
+
+
+    a = *(const CPU_INT64U *)p_a;
+    b = *(const CPU_INT64U *)p_b;
+
+    return ((a > b) - (a < b));
+}
@@ -0,0 +1,638 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                              USB AUDIO PLAYBACK STREAM CORRECTION BENCHMARK
+*
+* Filename : usbd_bench_corr.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This program measures the built-in playback stream correction on a host workstation :
+*
+*                    usbd_bench_corr [n] [period]
+*
+*                (a) Cost : 'n' pairs of corrections (one frame removed, then one frame added) are applied
+*                    to a 48-frame buffer, for several audio formats. The cost is printed per correction
+*                    and per frame of the buffer, in nanoseconds and in time-stamp counter cycles.
+*
+*                (b) Quality : a 48 kHz, 1 kHz sine is cut into 48-frame packets. A frame is removed from
+*                    or added to every 'period'-th packet, alternately, and the output stream is analyzed
+*                    with a Blackman-Harris windowed FFT. The power more than 2 kHz away from the tone,
+*                    relative to the power of the tone, is printed as THD+N. A run without correction
+*                    gives the reference floor of the test signal.
+*
+*            (2) The correction functions are local to 'usbd_audio_processing.c', which is therefore
+*                included by this file instead of being compiled on its own. The program is built like the
+*                'audio' mode of 'usbd_bench.c' (see 'usbd_bench.c  Note #2'), with this file in place of
+*                'usbd_bench.c' and 'usbd_audio_processing.c', and '-lm'. The correction algorithm is
+*                selected with USBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN (see 'usbd_cfg.h  Note #5') :
+*
+*                    -DUSBD_BENCH_CFG_AUDIO_EN=DEF_ENABLED -DUSBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN=DEF_ENABLED
+*
+*            (3) The time-stamp counter is read on x86 targets only; on other targets, only nanoseconds are
+*                printed. On most recent x86 processors, the counter runs at a constant rate, close to the
+*                nominal core frequency.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define  _POSIX_C_SOURCE                  200809L
+#include  "../../../Class/Audio/usbd_audio_processing.c"        /* See Note #2.                                         */
+#include  <math.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <time.h>
+#if (defined(__x86_64__) || defined(__i386__))                  /* See Note #3.                                         */
+#include  <x86intrin.h>
+#define  USBD_BENCH_CORR_TSC_EN                 DEF_ENABLED
+#else
+#define  USBD_BENCH_CORR_TSC_EN                 DEF_DISABLED
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_BENCH_CORR_NS_PER_SEC               1000000000uLL
+
+#define  USBD_BENCH_CORR_NBR_FRAME                        48u   /* Frames per pkt (1 ms at 48 kHz).                     */
+#define  USBD_BENCH_CORR_NBR_CH_MAX                        8u
+#define  USBD_BENCH_CORR_BUF_LEN                ((USBD_BENCH_CORR_NBR_FRAME + 1u) * USBD_BENCH_CORR_NBR_CH_MAX * 4u)
+
+#define  USBD_BENCH_CORR_SAMPLE_RATE                 48000.0
+#define  USBD_BENCH_CORR_TONE_FREQ                    1000.0
+#define  USBD_BENCH_CORR_TONE_AMPL                       0.5    /* Leaves room for the spline overshoot.                */
+#define  USBD_BENCH_CORR_BAND_FREQ                    2000.0    /* Half width of the tone band.                         */
+#define  USBD_BENCH_CORR_FFT_LEN                       65536u
+#define  USBD_BENCH_CORR_FFT_LEN_LOG2                     16u
+
+#define  USBD_BENCH_CORR_PI                3.14159265358979323846
+                                                                /* 48 kHz playback alt setting.                         */
+#define  USBD_BENCH_CORR_AS_CFG(nbr_ch, subframe_size, bit_res)  {0u, USBD_AUDIO_DATA_FMT_TYPE_I_PCM,                  \
+                                                                  (nbr_ch), (subframe_size), (bit_res), 1u,          \
+                                                                  48000u, 48000u, DEF_NULL, DEF_NO,                 \
+                                                                  USBD_EP_TYPE_SYNC_ADAPTIVE, 0u, 0u, 0u, 0u}
+
+#if (USBD_AUDIO_CFG_PLAYBACK_CORR_EN == DEF_DISABLED)           /* See Note #2.                                         */
+#error  "USBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN not #define'd on the command line [MUST be DEF_ENABLED or DEF_DISABLED]"
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+static  USBD_AUDIO_AS_ALT_CFG  USBD_BenchCorr_AS_CfgTbl[] = {  /* Fmts whose correction cost is measured.              */
+    USBD_BENCH_CORR_AS_CFG(2u, USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_2, USBD_AUDIO_FMT_TYPE_I_BIT_RESOLUTION_16),
+    USBD_BENCH_CORR_AS_CFG(2u, USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3, USBD_AUDIO_FMT_TYPE_I_BIT_RESOLUTION_24),
+    USBD_BENCH_CORR_AS_CFG(8u, USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_3, USBD_AUDIO_FMT_TYPE_I_BIT_RESOLUTION_24),
+    USBD_BENCH_CORR_AS_CFG(8u, USBD_AUDIO_FMT_TYPE_I_SUBFRAME_SIZE_4, USBD_AUDIO_FMT_TYPE_I_BIT_RESOLUTION_32),
+};
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  USBD_AUDIO_AS_IF_ALT       USBD_BenchCorr_AS_IF_Alt;
+static  USBD_AUDIO_AS_IF_SETTINGS  USBD_BenchCorr_AS_IF_Settings;
+static  USBD_AUDIO_AS_IF           USBD_BenchCorr_AS_IF;
+#if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
+static  USBD_AUDIO_STAT            USBD_BenchCorr_Stat;
+#endif
+
+static  CPU_INT08U                 USBD_BenchCorr_Buf[USBD_BENCH_CORR_BUF_LEN];
+
+static  double                     USBD_BenchCorr_Re[USBD_BENCH_CORR_FFT_LEN];
+static  double                     USBD_BenchCorr_Im[USBD_BENCH_CORR_FFT_LEN];
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void        USBD_BenchCorr_Init     (USBD_AUDIO_AS_ALT_CFG  *p_as_cfg);
+
+static  CPU_INT16U  USBD_BenchCorr_Apply    (CPU_INT16U              buf_len,
+                                             CPU_BOOLEAN             insert);
+
+static  void        USBD_BenchCorr_Cost     (USBD_AUDIO_AS_ALT_CFG  *p_as_cfg,
+                                             CPU_INT32U              iter_nbr);
+
+static  double      USBD_BenchCorr_Quality  (CPU_INT32U              period);
+
+static  void        USBD_BenchCorr_FFT      (double                 *p_re,
+                                             double                 *p_im);
+
+static  void        USBD_BenchCorr_SampleWr (CPU_INT08U             *p_subframe,
+                                             CPU_INT08U              subframe_len,
+                                             CPU_INT32S              val);
+
+static  CPU_INT32S  USBD_BenchCorr_SampleRd (const  CPU_INT08U      *p_subframe,
+                                             CPU_INT08U              subframe_len);
+
+static  CPU_INT64U  USBD_BenchCorr_TsGet    (void);
+
+static  CPU_INT64U  USBD_BenchCorr_TscGet   (void);
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+int  main (int     argc,
+           char  **argv)
+{
+    CPU_INT32U  iter_nbr;
+    CPU_INT32U  period;
+    CPU_SIZE_T  ix;
+
+
+    iter_nbr = (argc > 1) ? (CPU_INT32U)strtoul(argv[1], DEF_NULL, 0) : 100000u;
+    period   = (argc > 2) ? (CPU_INT32U)strtoul(argv[2], DEF_NULL, 0) :     10u;
+    if ((iter_nbr == 0u) ||
+        (period   == 0u)) {
+        printf("usage: %s [n] [period]\n", argv[0]);
+        return (EXIT_FAILURE);
+    }
+
+    printf("correction: %s\n",
+           (USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN == DEF_ENABLED) ? "resample" : "average");
+
+    for (ix = 0u; ix < (sizeof(USBD_BenchCorr_AS_CfgTbl) / sizeof(USBD_BenchCorr_AS_CfgTbl[0])); ix++) {
+        USBD_BenchCorr_Cost(&USBD_BenchCorr_AS_CfgTbl[ix], iter_nbr);
+    }
+
+    printf("THD+N (%u-bit, 1 kHz): no correction %.1f dB, 1 every %u pkts %.1f dB, 1 every %u pkts %.1f dB\n",
+           (unsigned)USBD_BenchCorr_AS_CfgTbl[1].BitRes,
+           USBD_BenchCorr_Quality(0u),
+           (unsigned)period,
+           USBD_BenchCorr_Quality(period),
+           (unsigned)(period * 10u),
+           USBD_BenchCorr_Quality(period * 10u));
+
+    return (EXIT_SUCCESS);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                        USBD_BenchCorr_Init()
+*
+* Description : Set up an AudioStreaming interface for the correction of a given audio format.
+*
+* Argument(s) : p_as_cfg    Pointer to AudioStreaming interface configuration.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Only the fields read by USBD_Audio_PlaybackCorrBuiltIn() are set. The buffer difference
+*                   is then selected by USBD_BenchCorr_Apply() through the ring buffer queue indexes.
+*********************************************************************************************************
+*/
+
+static  void  USBD_BenchCorr_Init (USBD_AUDIO_AS_ALT_CFG  *p_as_cfg)
+{
+    USBD_BenchCorr_AS_IF_Alt.AS_CfgPtr                  =  p_as_cfg;
+
+    USBD_BenchCorr_AS_IF_Settings.BufTotalNbr           =  8u;
+    USBD_BenchCorr_AS_IF_Settings.BufTotalLen           =  USBD_BENCH_CORR_BUF_LEN;
+    USBD_BenchCorr_AS_IF_Settings.StreamPreBufMax       =  4u;
+    USBD_BenchCorr_AS_IF_Settings.CorrBoundaryHeavyPos  =  1;
+    USBD_BenchCorr_AS_IF_Settings.CorrBoundaryHeavyNeg  = -1;
+    USBD_BenchCorr_AS_IF_Settings.CorrCallbackPtr       = (USBD_AUDIO_PLAYBACK_CORR_FNCT)0;
+#if (USBD_AUDIO_CFG_STAT_EN == DEF_ENABLED)
+    USBD_BenchCorr_AS_IF_Settings.StatPtr               = &USBD_BenchCorr_Stat;
+#endif
+
+    USBD_BenchCorr_AS_IF.AS_IF_SettingsPtr              = &USBD_BenchCorr_AS_IF_Settings;
+    USBD_BenchCorr_AS_IF.AS_IF_AltCurPtr                = &USBD_BenchCorr_AS_IF_Alt;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_BenchCorr_Apply()
+*
+* Description : Remove or add one frame to the benchmark buffer with the built-in correction.
+*
+* Argument(s) : buf_len     Length of the buffer, in octets.
+*
+*               insert      Indicates whether an audio frame is added or removed :
+*
+*                               DEF_YES     Add    an audio frame.
+*                               DEF_NO      Remove an audio frame.
+*
+* Return(s)   : New length of the buffer, in octets.
+*
+* Note(s)     : (1) A producer one buffer ahead of (or behind) the pre-buffering level gives a buffer
+*                   difference of +1 (or -1), which reaches the heavy boundaries set by USBD_BenchCorr_Init().
+*********************************************************************************************************
+*/
+
+static  CPU_INT16U  USBD_BenchCorr_Apply (CPU_INT16U   buf_len,
+                                          CPU_BOOLEAN  insert)
+{
+    USBD_AUDIO_BUF_DESC  buf_desc;
+    USBD_ERR             err;
+
+                                                                /* See Note #1.                                         */
+    USBD_BenchCorr_AS_IF_Settings.StreamRingBufQ.ConsumerEndIx = 0u;
+    USBD_BenchCorr_AS_IF_Settings.StreamRingBufQ.ProducerEndIx = (insert == DEF_YES) ? 3u : 5u;
+
+    buf_desc.BufPtr = USBD_BenchCorr_Buf;
+    buf_desc.BufLen = buf_len;
+    USBD_Audio_PlaybackCorrBuiltIn(&USBD_BenchCorr_AS_IF, &buf_desc, &err);
+    if (err != USBD_ERR_NONE) {
+        printf("correction failed: %u\n", (unsigned)err);
+        exit(EXIT_FAILURE);
+    }
+
+    return ((CPU_INT16U)buf_desc.BufLen);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_BenchCorr_Cost()
+*
+* Description : Measure and print the cost of the correction for a given audio format.
+*
+* Argument(s) : p_as_cfg    Pointer to AudioStreaming interface configuration.
+*
+*               iter_nbr    Number of correction pairs (one removal then one insertion).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_BenchCorr_Cost (USBD_AUDIO_AS_ALT_CFG  *p_as_cfg,
+                                   CPU_INT32U              iter_nbr)
+{
+    CPU_INT16U  frame_len;
+    CPU_INT16U  buf_len;
+    CPU_INT16U  ix;
+    CPU_INT32U  iter;
+    CPU_INT64U  ts;
+    CPU_INT64U  tsc;
+    double      ampl;
+    double      w;
+    double      corr_nbr;
+    double      ns_per_corr;
+
+
+    USBD_BenchCorr_Init(p_as_cfg);
+    frame_len = p_as_cfg->SubframeSize * p_as_cfg->NbrCh;
+    buf_len   = USBD_BENCH_CORR_NBR_FRAME * frame_len;
+    ampl      = 0.9 * ldexp(1.0, p_as_cfg->BitRes - 1u);
+    w         = 2.0 * USBD_BENCH_CORR_PI / USBD_BENCH_CORR_NBR_FRAME;
+                                                                /* Near full scale sine, one cycle per buf.             */
+    for (ix = 0u; ix < buf_len; ix += p_as_cfg->SubframeSize) {
+        USBD_BenchCorr_SampleWr(&USBD_BenchCorr_Buf[ix],
+                                 p_as_cfg->SubframeSize,
+                                (CPU_INT32S)(ampl * sin(w * (ix / frame_len))));
+    }
+
+    ts  = USBD_BenchCorr_TsGet();
+    tsc = USBD_BenchCorr_TscGet();
+    for (iter = 0u; iter < iter_nbr; iter++) {
+        buf_len = USBD_BenchCorr_Apply(buf_len, DEF_NO);
+        buf_len = USBD_BenchCorr_Apply(buf_len, DEF_YES);
+    }
+    tsc = USBD_BenchCorr_TscGet() - tsc;
+    ts  = USBD_BenchCorr_TsGet()  - ts;
+
+    corr_nbr    = 2.0 * iter_nbr;
+    ns_per_corr = (double)ts / corr_nbr;
+    printf("%2u-bit %u ch: %8.1f ns/corr %6.2f ns/frame",
+           (unsigned)p_as_cfg->BitRes,
+           (unsigned)p_as_cfg->NbrCh,
+           ns_per_corr,
+           ns_per_corr / USBD_BENCH_CORR_NBR_FRAME);
+#if (USBD_BENCH_CORR_TSC_EN == DEF_ENABLED)
+    printf(" %8.0f cycles/corr %6.1f cycles/frame",
+           (double)tsc / corr_nbr,
+           (double)tsc / corr_nbr / USBD_BENCH_CORR_NBR_FRAME);
+#else
+    (void)tsc;
+#endif
+    printf("\n");
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_BenchCorr_Quality()
+*
+* Description : Measure the distortion and noise added by the correction to a sine (see Note #1b).
+*
+* Argument(s) : period      Number of packets between two corrections, 0 for no correction.
+*
+* Return(s)   : THD+N, in dB relative to the tone.
+*
+* Note(s)     : (1) The stream is 24-bit stereo. Only the first channel is analyzed.
+*
+*               (2) The spectrum is summed over the positive frequencies only, which is enough for a real
+*                   signal.
+*********************************************************************************************************
+*/
+
+static  double  USBD_BenchCorr_Quality (CPU_INT32U  period)
+{
+    USBD_AUDIO_AS_ALT_CFG  *p_as_cfg = &USBD_BenchCorr_AS_CfgTbl[1];
+    CPU_INT16U              frame_len;
+    CPU_INT16U              buf_len;
+    CPU_INT16U              frame_ix;
+    CPU_INT16U              ch_ix;
+    CPU_INT32U              pkt_ix;
+    CPU_INT32U              corr_nbr;
+    CPU_INT32U              src_ix;
+    CPU_INT32U              out_ix;
+    CPU_INT32U              bin;
+    double                  ampl;
+    double                  w;
+    double                  bin_freq;
+    double                  pwr;
+    double                  pwr_tone;
+    double                  pwr_noise;
+
+
+    USBD_BenchCorr_Init(p_as_cfg);                              /* See Note #1.                                         */
+    frame_len = p_as_cfg->SubframeSize * p_as_cfg->NbrCh;
+    ampl      = USBD_BENCH_CORR_TONE_AMPL * ldexp(1.0, p_as_cfg->BitRes - 1u);
+    w         = 2.0 * USBD_BENCH_CORR_PI * USBD_BENCH_CORR_TONE_FREQ / USBD_BENCH_CORR_SAMPLE_RATE;
+    src_ix    = 0u;
+    out_ix    = 0u;
+    corr_nbr  = 0u;
+    pkt_ix    = 0u;
+
+    while (out_ix < USBD_BENCH_CORR_FFT_LEN) {
+        for (frame_ix = 0u; frame_ix < USBD_BENCH_CORR_NBR_FRAME; frame_ix++) {
+            for (ch_ix = 0u; ch_ix < p_as_cfg->NbrCh; ch_ix++) {
+                USBD_BenchCorr_SampleWr(&USBD_BenchCorr_Buf[(frame_ix * frame_len) + (ch_ix * p_as_cfg->SubframeSize)],
+                                         p_as_cfg->SubframeSize,
+                                        (CPU_INT32S)lrint(ampl * sin((w * (src_ix + frame_ix)) + ch_ix)));
+            }
+        }
+        src_ix  += USBD_BENCH_CORR_NBR_FRAME;
+        buf_len  = USBD_BENCH_CORR_NBR_FRAME * frame_len;
+        pkt_ix++;
+        if ((period  != 0u) &&
+            ((pkt_ix % period) == 0u)) {                        /* Alternately remove and add a frame.                  */
+            buf_len = USBD_BenchCorr_Apply(buf_len, ((corr_nbr % 2u) == 0u) ? DEF_NO : DEF_YES);
+            corr_nbr++;
+        }
+
+        for (frame_ix = 0u; frame_ix < (buf_len / frame_len); frame_ix++) {
+            if (out_ix >= USBD_BENCH_CORR_FFT_LEN) {
+                break;
+            }
+            USBD_BenchCorr_Re[out_ix] = USBD_BenchCorr_SampleRd(&USBD_BenchCorr_Buf[frame_ix * frame_len],
+                                                                  p_as_cfg->SubframeSize);
+            out_ix++;
+        }
+    }
+                                                                /* 4-term Blackman-Harris window.                       */
+    for (out_ix = 0u; out_ix < USBD_BENCH_CORR_FFT_LEN; out_ix++) {
+        w = 2.0 * USBD_BENCH_CORR_PI * out_ix / USBD_BENCH_CORR_FFT_LEN;
+        USBD_BenchCorr_Re[out_ix] *= 0.35875 - (0.48829 * cos(w)) + (0.14128 * cos(2.0 * w)) - (0.01168 * cos(3.0 * w));
+        USBD_BenchCorr_Im[out_ix]  = 0.0;
+    }
+    USBD_BenchCorr_FFT(USBD_BenchCorr_Re, USBD_BenchCorr_Im);
+
+    pwr_tone  = 0.0;                                            /* See Note #2.                                         */
+    pwr_noise = 0.0;
+    for (bin = 0u; bin <= (USBD_BENCH_CORR_FFT_LEN / 2u); bin++) {
+        bin_freq = bin * USBD_BENCH_CORR_SAMPLE_RATE / USBD_BENCH_CORR_FFT_LEN;
+        pwr      = (USBD_BenchCorr_Re[bin] * USBD_BenchCorr_Re[bin]) + (USBD_BenchCorr_Im[bin] * USBD_BenchCorr_Im[bin]);
+        if (fabs(bin_freq - USBD_BENCH_CORR_TONE_FREQ) <= USBD_BENCH_CORR_BAND_FREQ) {
+            pwr_tone  += pwr;
+        } else {
+            pwr_noise += pwr;
+        }
+    }
+
+    return (10.0 * log10(pwr_noise / pwr_tone));
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_BenchCorr_FFT()
+*
+* Description : Compute the discrete Fourier transform of USBD_BENCH_CORR_FFT_LEN complex points, in place.
+*
+* Argument(s) : p_re        Pointer to real      parts.
+*
+*               p_im        Pointer to imaginary parts.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Iterative radix-2 decimation in time, after a bit-reversal permutation.
+*********************************************************************************************************
+*/
+
+static  void  USBD_BenchCorr_FFT (double  *p_re,
+                                  double  *p_im)
+{
+    CPU_INT32U  i;
+    CPU_INT32U  j;
+    CPU_INT32U  k;
+    CPU_INT32U  bit;
+    CPU_INT32U  len;
+    double      ang;
+    double      w_re;
+    double      w_im;
+    double      t_re;
+    double      t_im;
+    double      tmp;
+
+
+    for (i = 0u; i < USBD_BENCH_CORR_FFT_LEN; i++) {            /* Bit-reversal permutation.                            */
+        j = 0u;
+        for (bit = 0u; bit < USBD_BENCH_CORR_FFT_LEN_LOG2; bit++) {
+            j |= ((i >> bit) & 1u) << (USBD_BENCH_CORR_FFT_LEN_LOG2 - 1u - bit);
+        }
+        if (j > i) {
+            tmp = p_re[i]; p_re[i] = p_re[j]; p_re[j] = tmp;
+            tmp = p_im[i]; p_im[i] = p_im[j]; p_im[j] = tmp;
+        }
+    }
+
+    for (len = 2u; len <= USBD_BENCH_CORR_FFT_LEN; len <<= 1u) {
+        for (k = 0u; k < (len / 2u); k++) {
+            ang  = -2.0 * USBD_BENCH_CORR_PI * k / len;
+            w_re =  cos(ang);
+            w_im =  sin(ang);
+            for (i = k; i < USBD_BENCH_CORR_FFT_LEN; i += len) {
+                j        =  i + (len / 2u);
+                t_re     = (p_re[j] * w_re) - (p_im[j] * w_im);
+                t_im     = (p_re[j] * w_im) + (p_im[j] * w_re);
+                p_re[j]  =  p_re[i] - t_re;
+                p_im[j]  =  p_im[i] - t_im;
+                p_re[i] +=  t_re;
+                p_im[i] +=  t_im;
+            }
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_BenchCorr_SampleWr()
+*
+* Description : Write a little-endian signed sample.
+*
+* Argument(s) : p_subframe      Pointer to subframe.
+*
+*               subframe_len    Subframe length, in octets.
+*
+*               val             Sample value.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_BenchCorr_SampleWr (CPU_INT08U  *p_subframe,
+                                       CPU_INT08U   subframe_len,
+                                       CPU_INT32S   val)
+{
+    CPU_INT32U  val_u = (CPU_INT32U)val;
+    CPU_INT08U  ix;
+
+
+    for (ix = 0u; ix < subframe_len; ix++) {
+        p_subframe[ix]   = (CPU_INT08U)val_u;
+        val_u          >>= 8u;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_BenchCorr_SampleRd()
+*
+* Description : Read a little-endian signed sample.
+*
+* Argument(s) : p_subframe      Pointer to subframe.
+*
+*               subframe_len    Subframe length, in octets.
+*
+* Return(s)   : Sample value.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32S  USBD_BenchCorr_SampleRd (const  CPU_INT08U  *p_subframe,
+                                             CPU_INT08U          subframe_len)
+{
+    CPU_INT32U  val_u;
+    CPU_INT08U  ix;
+
+
+    val_u = 0u;
+    for (ix = subframe_len; ix > 0u; ix--) {
+        val_u = (val_u << 8u) | p_subframe[ix - 1u];
+    }
+    if (subframe_len < 4u) {                                    /* Sign extend.                                         */
+        val_u ^= (CPU_INT32U)1u << ((subframe_len * 8u) - 1u);
+        val_u -= (CPU_INT32U)1u << ((subframe_len * 8u) - 1u);
+    }
+
+    return ((CPU_INT32S)val_u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_BenchCorr_TsGet()
+*
+* Description : Read the monotonic clock.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Clock value, in nanoseconds.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT64U  USBD_BenchCorr_TsGet (void)
+{
+    struct  timespec  ts;
+
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (((CPU_INT64U)ts.tv_sec * USBD_BENCH_CORR_NS_PER_SEC) + (CPU_INT64U)ts.tv_nsec);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_BenchCorr_TscGet()
+*
+* Description : Read the time-stamp counter.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Counter value, 0 when not available (see Note #3).
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT64U  USBD_BenchCorr_TscGet (void)
+{
+#if (USBD_BENCH_CORR_TSC_EN == DEF_ENABLED)
+    return ((CPU_INT64U)__rdtsc());
+#else
+    return (0u);
+#endif
+}
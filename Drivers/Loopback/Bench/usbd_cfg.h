@@ -0,0 +1,232 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                    USB DEVICE CONFIGURATION FILE
+*
+*                                        LOOPBACK BENCHMARK
+*
+* Filename : usbd_cfg.h
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This file starts from the template configuration ('Cfg/Template/usbd_cfg.h') and only
+*                overrides what the benchmark needs (see 'usbd_bench.c'). The template must therefore
+*                stay reachable at its place in the source tree.
+*
+*            (2) The options compared by the benchmark can be changed from the compiler command line,
+*                without editing this file, by defining the matching USBD_BENCH_CFG_xxx macro, e.g. :
+*
+*                    -DUSBD_BENCH_CFG_CORE_EVENT_RING_EN=DEF_ENABLED
+*                    -DUSBD_BENCH_CFG_MSC_DATA_NBR_BUF=4u
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                               MODULE
+*********************************************************************************************************
+*/
+
+#ifndef  USBD_BENCH_CFG_MODULE_PRESENT
+#define  USBD_BENCH_CFG_MODULE_PRESENT
+
+#include  "../../../Cfg/Template/usbd_cfg.h"                    /* See Note #1.                                         */
+
+
+/*
+*********************************************************************************************************
+*                                  USB DEVICE GENERIC CONFIGURATION
+*
+* Note(s) : (1) The endpoint counts cover the largest device built by the benchmark: 8 HID instances with
+*               one interrupt IN endpoint each, on top of the control endpoints.
+*
+*           (2) Extra URBs let the MSC data stage queue several buffers per endpoint when
+*               USBD_MSC_CFG_DATA_NBR_BUF is greater than 1.
+*********************************************************************************************************
+*/
+
+#undef   USBD_CFG_MAX_NBR_IF
+#define  USBD_CFG_MAX_NBR_IF                               8u
+
+#undef   USBD_CFG_MAX_NBR_IF_ALT
+#define  USBD_CFG_MAX_NBR_IF_ALT                           8u
+
+#undef   USBD_CFG_MAX_NBR_IF_GRP
+#define  USBD_CFG_MAX_NBR_IF_GRP                           2u
+
+#undef   USBD_CFG_MAX_NBR_EP_DESC
+#define  USBD_CFG_MAX_NBR_EP_DESC                         16u
+
+#undef   USBD_CFG_MAX_NBR_EP_OPEN                               /* See Note #1.                                         */
+#define  USBD_CFG_MAX_NBR_EP_OPEN                         12u
+
+#undef   USBD_CFG_MAX_NBR_URB_EXTRA                             /* See Note #2.                                         */
+#define  USBD_CFG_MAX_NBR_URB_EXTRA                        8u
+
+#undef   USBD_CFG_MAX_NBR_STR
+#define  USBD_CFG_MAX_NBR_STR                             20u
+
+
+/*
+*********************************************************************************************************
+*                                       CLASS CONFIGURATIONS
+*********************************************************************************************************
+*/
+
+#undef   USBD_AUDIO_CFG_RECORD_EN                               /* The 'audio' mode streams playback only.              */
+#define  USBD_AUDIO_CFG_RECORD_EN                 DEF_DISABLED
+
+#undef   USBD_HID_CFG_MAX_NBR_DEV
+#define  USBD_HID_CFG_MAX_NBR_DEV                          8u
+
+#undef   USBD_HID_CFG_MAX_NBR_CFG                               /* One configuration per instance.                      */
+#define  USBD_HID_CFG_MAX_NBR_CFG                          8u
+
+#undef   USBD_HID_CFG_MAX_NBR_REPORT_ID
+#define  USBD_HID_CFG_MAX_NBR_REPORT_ID                 1024u
+
+#undef   USBD_MSC_CFG_MAX_NBR_DEV
+#define  USBD_MSC_CFG_MAX_NBR_DEV                          2u
+
+#undef   USBD_MSC_CFG_DATA_LEN
+#define  USBD_MSC_CFG_DATA_LEN                          2048u
+
+#undef   USBD_RAMDISK_CFG_NBR_UNITS
+#define  USBD_RAMDISK_CFG_NBR_UNITS                        2u
+
+#undef   USBD_RAMDISK_CFG_NBR_BLKS                              /* 2 MiB per unit.                                      */
+#define  USBD_RAMDISK_CFG_NBR_BLKS                      4096u
+
+#undef   USBD_VENDOR_CFG_MAX_NBR_DEV
+#define  USBD_VENDOR_CFG_MAX_NBR_DEV                       4u
+
+
+/*
+*********************************************************************************************************
+*                                          OPTIONS UNDER TEST
+*
+* Note(s) : (1) See 'usbd_cfg.h  Note #2'.
+*
+*           (2) Enabling the debug trace also enables its task in the POSIX port.
+*
+*           (3) The throughput window is shortened so that a run of a few hundred milliseconds closes
+*               several windows before the endpoint statistics are read.
+*
+*           (4) The 'audio' mode is only built when USBD_BENCH_CFG_AUDIO_EN is DEF_ENABLED, since it needs the
+*               audio class sources and isochronous endpoints (see 'usbd_bench.c  Note #2').
+*
+*           (5) USBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN enables the built-in playback stream correction and
+*               selects its algorithm, for the correction benchmark (see 'usbd_bench_corr.c  Note #2').
+*
+*           (6) The 'uas' mode is only built when USBD_BENCH_CFG_MSC_UAS_EN is DEF_ENABLED. Its queue depth
+*               argument is bounded by USBD_MSC_CFG_UAS_QUEUE_DEPTH.
+*********************************************************************************************************
+*/
+
+#ifdef   USBD_BENCH_CFG_CORE_EVENT_RING_EN
+#undef   USBD_CFG_CORE_EVENT_RING_EN
+#define  USBD_CFG_CORE_EVENT_RING_EN            USBD_BENCH_CFG_CORE_EVENT_RING_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_DESC_CACHE_EN
+#undef   USBD_CFG_DESC_CACHE_EN
+#define  USBD_CFG_DESC_CACHE_EN                 USBD_BENCH_CFG_DESC_CACHE_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_DESC_STATIC_EN
+#undef   USBD_CFG_DESC_STATIC_EN
+#define  USBD_CFG_DESC_STATIC_EN                USBD_BENCH_CFG_DESC_STATIC_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_CTRL_ASYNC_EN
+#undef   USBD_CFG_CTRL_ASYNC_EN
+#define  USBD_CFG_CTRL_ASYNC_EN                 USBD_BENCH_CFG_CTRL_ASYNC_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_DBG_TRACE_EN                            /* See Note #2.                                         */
+#undef   USBD_CFG_DBG_TRACE_EN
+#define  USBD_CFG_DBG_TRACE_EN                  USBD_BENCH_CFG_DBG_TRACE_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_DBG_TRACE_BIN_EN
+#undef   USBD_CFG_DBG_TRACE_BIN_EN
+#define  USBD_CFG_DBG_TRACE_BIN_EN              USBD_BENCH_CFG_DBG_TRACE_BIN_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_DBG_STATS_PERF_EN
+#undef   USBD_CFG_DBG_STATS_EN
+#define  USBD_CFG_DBG_STATS_EN                  USBD_BENCH_CFG_DBG_STATS_PERF_EN
+#undef   USBD_CFG_DBG_STATS_PERF_EN
+#define  USBD_CFG_DBG_STATS_PERF_EN             USBD_BENCH_CFG_DBG_STATS_PERF_EN
+#undef   USBD_CFG_DBG_STATS_RATE_WIN_MS                         /* See Note #3.                                         */
+#define  USBD_CFG_DBG_STATS_RATE_WIN_MS                   10u
+#endif
+
+#ifdef   USBD_BENCH_CFG_EP_VEC_EN
+#undef   USBD_CFG_EP_VEC_EN
+#define  USBD_CFG_EP_VEC_EN                     USBD_BENCH_CFG_EP_VEC_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_EP_SYNC_URB_EN
+#undef   USBD_CFG_EP_SYNC_URB_EN
+#define  USBD_CFG_EP_SYNC_URB_EN                USBD_BENCH_CFG_EP_SYNC_URB_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_MSC_DATA_NBR_BUF
+#undef   USBD_MSC_CFG_DATA_NBR_BUF
+#define  USBD_MSC_CFG_DATA_NBR_BUF              USBD_BENCH_CFG_MSC_DATA_NBR_BUF
+#endif
+
+#ifdef   USBD_BENCH_CFG_MSC_DATA_LEN
+#undef   USBD_MSC_CFG_DATA_LEN
+#define  USBD_MSC_CFG_DATA_LEN                  USBD_BENCH_CFG_MSC_DATA_LEN
+#endif
+
+#ifdef   USBD_BENCH_CFG_AUDIO_EN                                /* See Note #4.                                         */
+#undef   USBD_CFG_EP_ISOC_EN
+#define  USBD_CFG_EP_ISOC_EN                    USBD_BENCH_CFG_AUDIO_EN
+#else
+#define  USBD_BENCH_CFG_AUDIO_EN                DEF_DISABLED
+#endif
+
+#ifdef   USBD_BENCH_CFG_MSC_CACHE_EN
+#undef   USBD_MSC_CFG_CACHE_EN
+#define  USBD_MSC_CFG_CACHE_EN                  USBD_BENCH_CFG_MSC_CACHE_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_MSC_UAS_EN                              /* See Note #6.                                         */
+#undef   USBD_MSC_CFG_UAS_EN
+#define  USBD_MSC_CFG_UAS_EN                    USBD_BENCH_CFG_MSC_UAS_EN
+#endif
+
+#ifdef   USBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN                  /* See Note #5.                                         */
+#undef   USBD_AUDIO_CFG_PLAYBACK_CORR_EN
+#define  USBD_AUDIO_CFG_PLAYBACK_CORR_EN        DEF_ENABLED
+#undef   USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN
+#define  USBD_AUDIO_CFG_PLAYBACK_CORR_RESAMPLE_EN USBD_BENCH_CFG_AUDIO_CORR_RESAMPLE_EN
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif
@@ -0,0 +1,1904 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          USB DEVICE DRIVER
+*
+*                                    IN-MEMORY LOOPBACK CONTROLLER
+*
+* Filename : usbd_drv_loopback.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This driver emulates a DMA-capable device controller in memory so that the stack and its
+*                classes can run on a host workstation (see the POSIX OS port). The host side of the bus
+*                is driven through the USBD_DrvLoopback_Host...() functions, which move data directly
+*                between the host buffers and the buffers armed by the stack, packet by packet.
+*
+*            (2) The host functions run in the caller's thread and act as the controller interrupt: they
+*                call USBD_EventSetup(), USBD_EP_RxCmpl(), USBD_EP_TxCmpl(), etc. directly. Several host
+*                threads may drive the same device: the host functions are serialized per device, so that
+*                the stack only ever sees one interrupt source at a time, as with a real controller.
+*                Each call runs alone from start to end, so the transfers of different threads are not
+*                interleaved packet by packet.
+*
+*            (3) The driver needs no board support package: USBD_DrvBSP_Loopback can be passed to
+*                USBD_DevAdd(). Of the driver configuration, only 'Spd' and 'EP_InfoTbl' are used.
+*
+*            (4) The bus clock is built on POSIX.1-2008 CLOCK_MONOTONIC and clock_nanosleep(). The feature
+*                test macro is defined before the first include so that the driver also builds in a strict
+*                ISO C compiler mode (e.g. '-std=c11').
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define  _POSIX_C_SOURCE                  200809L               /* See Note #4.                                         */
+#include  "../../Source/usbd_core.h"
+#include  "usbd_drv_loopback.h"
+#include  <pthread.h>
+#include  <errno.h>
+#include  <time.h>
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*
+* Note(s) : (1) 'Universal Serial Bus Specification Rev 2.0', section 5.8.4 gives the protocol overhead
+*               of a bulk transaction (token, data and handshake packets, SYNC, EOP and inter-packet
+*               delays) as 13 bytes at full-speed and 55 bytes at high-speed. Bit stuffing is not
+*               accounted.
+*
+*           (2) The core starts every asynchronous transfer as soon as it is queued, so an endpoint may
+*               have one buffer armed per URB the core can queue on it: its main URB, plus all the
+*               reserved and extra URBs.
+*********************************************************************************************************
+*/
+
+#define  USBD_DRV_LOOPBACK_NS_PER_SEC             1000000000uL
+#define  USBD_DRV_LOOPBACK_NS_PER_MS                 1000000uL
+
+#define  USBD_DRV_LOOPBACK_BIT_RATE_FS                    12u   /* Bus bit rate, in Mb/s.                               */
+#define  USBD_DRV_LOOPBACK_BIT_RATE_HS                   480u
+
+#define  USBD_DRV_LOOPBACK_PKT_OVERHEAD_FS                13u   /* Protocol overhead per packet (see Note #1).          */
+#define  USBD_DRV_LOOPBACK_PKT_OVERHEAD_HS                55u
+
+#define  USBD_DRV_LOOPBACK_SETUP_PKT_LEN                   8u
+
+#define  USBD_DRV_LOOPBACK_EP_ADDR_CTRL_OUT             0x00u
+#define  USBD_DRV_LOOPBACK_EP_ADDR_CTRL_IN              0x80u
+
+                                                                /* Max nbr of bufs armed on one EP (see Note #2).       */
+#define  USBD_DRV_LOOPBACK_XFER_QTY            (USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                USBD_CFG_MAX_NBR_URB_RSVD  + 1u)
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL MACROS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*
+* Note(s) : (1) An armed endpoint owns the buffer passed by the stack: the host copies OUT packets into it
+*               and IN packets out of it, the way a DMA engine would. An endpoint that is not armed NAKs.
+*
+*           (2) Armed buffers form a FIFO, like a chain of DMA descriptors. The host moves data in or out of
+*               the buffer at 'XferCurIx'. Once it completes, the host moves on to the next armed buffer,
+*               while the completed one waits at 'XferOutIx' for the stack to read its length.
+*
+*           (3) The host functions of a device run one at a time under 'HostMutex' (see 'usbd_drv_loopback.c
+*               Note #2'). 'HostMutex' is always taken before 'Mutex'.
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_drv_xfer {
+    CPU_INT08U   *BufPtr;                                       /* Armed buf.                                           */
+    CPU_INT32U    BufLen;                                       /* Armed buf len.                                       */
+    CPU_INT32U    XferLen;                                      /* Nbr of octets moved in/out of armed buf.             */
+    CPU_BOOLEAN   Overflow;                                     /* Host sent more data than the armed buf could hold.   */
+} USBD_DRV_XFER;
+
+
+typedef  struct  usbd_drv_ep {
+    CPU_BOOLEAN    Open;                                        /* EP opened by the stack.                              */
+    CPU_BOOLEAN    Stall;                                       /* EP halted.                                           */
+    CPU_INT16U     MaxPktSize;
+                                                                /* Armed bufs FIFO (see Note #2).                       */
+    USBD_DRV_XFER  XferTbl[USBD_DRV_LOOPBACK_XFER_QTY];
+    CPU_INT08U     XferInIx;                                    /* Ix of next buf to arm.                               */
+    CPU_INT08U     XferCurIx;                                   /* Ix of buf being moved by the host.                   */
+    CPU_INT08U     XferOutIx;                                   /* Ix of next completed buf to return to the stack.     */
+    CPU_INT08U     ArmedCnt;                                    /* Nbr of armed bufs not completed yet (see Note #1).   */
+    CPU_INT08U     CmplCnt;                                     /* Nbr of completed bufs not returned yet.              */
+} USBD_DRV_EP;
+
+
+typedef  struct  usbd_drv_data {
+    pthread_mutex_t   HostMutex;                                /* Serializes host fnct calls (see Note #3).            */
+    pthread_mutex_t   Mutex;                                    /* Protects EP tbl.                                     */
+    pthread_cond_t    Cond;                                     /* Signaled on any EP state change.                     */
+    USBD_DRV_EP       EP_Tbl[USBD_EP_MAX_NBR];                  /* EP tbl, indexed by physical EP nbr.                  */
+
+    CPU_INT08U        TimingMode;                               /* Bus timing mode.                                     */
+    CPU_INT32U        BitRate;                                  /* Bus bit rate, in Mb/s.                               */
+    CPU_INT32U        PktOverhead;                              /* Protocol overhead per packet, in octets.             */
+    CPU_INT64U        BusBitCnt;                                /* Virtual bus clock, in bit times.                     */
+    struct  timespec  BusStartTs;                               /* Wall clock at attach.                                */
+} USBD_DRV_DATA;
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  USBD_DRV  *USBD_DrvLoopback_DrvTbl[USBD_CFG_MAX_NBR_DEV];
+
+
+/*
+*********************************************************************************************************
+*                             USB DEVICE CONTROLLER DRIVER API PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void         USBD_DrvInit       (USBD_DRV     *p_drv,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvStart      (USBD_DRV     *p_drv,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvStop       (USBD_DRV     *p_drv);
+
+static  CPU_BOOLEAN  USBD_DrvAddrSet    (USBD_DRV     *p_drv,
+                                         CPU_INT08U    dev_addr);
+
+static  void         USBD_DrvAddrEn     (USBD_DRV     *p_drv,
+                                         CPU_INT08U    dev_addr);
+
+static  CPU_BOOLEAN  USBD_DrvCfgSet     (USBD_DRV     *p_drv,
+                                         CPU_INT08U    cfg_val);
+
+static  void         USBD_DrvCfgClr     (USBD_DRV     *p_drv,
+                                         CPU_INT08U    cfg_val);
+
+static  CPU_INT16U   USBD_DrvFrameNbrGet(USBD_DRV     *p_drv);
+
+static  void         USBD_DrvEP_Open    (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_INT08U    ep_type,
+                                         CPU_INT16U    max_pkt_size,
+                                         CPU_INT08U    transaction_frame,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvEP_Close   (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr);
+
+static  CPU_INT32U   USBD_DrvEP_RxStart (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_INT08U   *p_buf,
+                                         CPU_INT32U    buf_len,
+                                         USBD_ERR     *p_err);
+
+static  CPU_INT32U   USBD_DrvEP_Rx      (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_INT08U   *p_buf,
+                                         CPU_INT32U    buf_len,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvEP_RxZLP   (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         USBD_ERR     *p_err);
+
+static  CPU_INT32U   USBD_DrvEP_Tx      (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_INT08U   *p_buf,
+                                         CPU_INT32U    buf_len,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvEP_TxStart (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_INT08U   *p_buf,
+                                         CPU_INT32U    buf_len,
+                                         USBD_ERR     *p_err);
+
+static  void         USBD_DrvEP_TxZLP   (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         USBD_ERR     *p_err);
+
+static  CPU_BOOLEAN  USBD_DrvEP_Abort   (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr);
+
+static  CPU_BOOLEAN  USBD_DrvEP_Stall   (USBD_DRV     *p_drv,
+                                         CPU_INT08U    ep_addr,
+                                         CPU_BOOLEAN   state);
+
+static  void         USBD_DrvISR_Handler(USBD_DRV     *p_drv);
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void            USBD_DrvLoopback_EP_Reset    (USBD_DRV_EP      *p_ep);
+
+static  void            USBD_DrvLoopback_EP_Arm      (USBD_DRV         *p_drv,
+                                                      CPU_INT08U        ep_addr,
+                                                      CPU_INT08U       *p_buf,
+                                                      CPU_INT32U        buf_len,
+                                                      USBD_ERR         *p_err);
+
+static  void            USBD_DrvLoopback_EP_XferCmpl (USBD_DRV_EP      *p_ep,
+                                                      CPU_BOOLEAN       ep_dir_in);
+
+static  USBD_DRV_DATA  *USBD_DrvLoopback_DataGet     (CPU_INT08U        dev_nbr,
+                                                      USBD_DRV        **pp_drv,
+                                                      USBD_ERR         *p_err);
+
+static  void            USBD_DrvLoopback_HostWait    (USBD_DRV_DATA    *p_drv_data,
+                                                      USBD_DRV_EP      *p_ep,
+                                                      CPU_INT32U        timeout_ms,
+                                                      struct  timespec *p_ts,
+                                                      USBD_ERR         *p_err);
+
+static  void            USBD_DrvLoopback_BusPktAdd   (USBD_DRV_DATA    *p_drv_data,
+                                                      CPU_INT32U        pkt_len);
+
+static  CPU_INT64U      USBD_DrvLoopback_ClkElapsedGet(USBD_DRV_DATA   *p_drv_data);
+
+static  void            USBD_DrvLoopback_TsAdd       (struct  timespec *p_ts,
+                                                      CPU_INT64U        ns);
+
+
+/*
+*********************************************************************************************************
+*                                  USB DEVICE CONTROLLER DRIVER API
+*********************************************************************************************************
+*/
+
+USBD_DRV_API  USBD_DrvAPI_Loopback = { USBD_DrvInit,
+                                       USBD_DrvStart,
+                                       USBD_DrvStop,
+                                       USBD_DrvAddrSet,
+                                       USBD_DrvAddrEn,
+                                       USBD_DrvCfgSet,
+                                       USBD_DrvCfgClr,
+                                       USBD_DrvFrameNbrGet,
+                                       USBD_DrvEP_Open,
+                                       USBD_DrvEP_Close,
+                                       USBD_DrvEP_RxStart,
+                                       USBD_DrvEP_Rx,
+                                       USBD_DrvEP_RxZLP,
+                                       USBD_DrvEP_Tx,
+                                       USBD_DrvEP_TxStart,
+                                       USBD_DrvEP_TxZLP,
+                                       USBD_DrvEP_Abort,
+                                       USBD_DrvEP_Stall,
+                                       USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                       DEF_NULL,
+                                       DEF_NULL,
+                                       DEF_NULL,
+#endif
+};
+
+
+/*
+*********************************************************************************************************
+*                                USB DEVICE CONTROLLER BSP API (see Note #3)
+*********************************************************************************************************
+*/
+
+USBD_DRV_BSP_API  USBD_DrvBSP_Loopback = { DEF_NULL,
+                                           DEF_NULL,
+                                           DEF_NULL
+};
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     DRIVER INTERFACE FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           USBD_DrvInit()
+*
+* Description : Initialize the device.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       Device successfully initialized.
+*                               USBD_ERR_ALLOC      Memory allocation failed.
+*                               USBD_ERR_FAIL       Mutex or condition variable initialization failed.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvInit (USBD_DRV  *p_drv,
+                            USBD_ERR  *p_err)
+{
+    USBD_DRV_DATA       *p_drv_data;
+    pthread_condattr_t   attr;
+    CPU_SIZE_T           reqd_octets;
+    LIB_ERR              err_lib;
+    int                  os_err;
+
+
+    p_drv_data = (USBD_DRV_DATA *)Mem_HeapAlloc(sizeof(USBD_DRV_DATA),
+                                                sizeof(CPU_ALIGN),
+                                               &reqd_octets,
+                                               &err_lib);
+    if (p_drv_data == (void *)0) {
+       *p_err = USBD_ERR_ALLOC;
+        return;
+    }
+
+    Mem_Clr((void     *)p_drv_data,
+            (CPU_SIZE_T)sizeof(USBD_DRV_DATA));
+
+    os_err = pthread_mutex_init(&p_drv_data->HostMutex, DEF_NULL);
+    if (os_err == 0) {
+        os_err = pthread_mutex_init(&p_drv_data->Mutex, DEF_NULL);
+    }
+    if (os_err == 0) {
+        os_err = pthread_condattr_init(&attr);
+    }
+    if (os_err == 0) {
+        os_err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        if (os_err == 0) {
+            os_err = pthread_cond_init(&p_drv_data->Cond, &attr);
+        }
+        (void)pthread_condattr_destroy(&attr);
+    }
+    if (os_err != 0) {
+       *p_err = USBD_ERR_FAIL;
+        return;
+    }
+
+    if (p_drv->CfgPtr->Spd == USBD_DEV_SPD_HIGH) {
+        p_drv_data->BitRate     = USBD_DRV_LOOPBACK_BIT_RATE_HS;
+        p_drv_data->PktOverhead = USBD_DRV_LOOPBACK_PKT_OVERHEAD_HS;
+    } else {
+        p_drv_data->BitRate     = USBD_DRV_LOOPBACK_BIT_RATE_FS;
+        p_drv_data->PktOverhead = USBD_DRV_LOOPBACK_PKT_OVERHEAD_FS;
+    }
+    p_drv_data->TimingMode = USBD_DRV_LOOPBACK_TIMING_NONE;
+
+    p_drv->DataPtr                           = p_drv_data;
+    USBD_DrvLoopback_DrvTbl[p_drv->DevNbr] = p_drv;
+
+    if (p_drv->BSP_API_Ptr->Init != (void *)0) {
+        p_drv->BSP_API_Ptr->Init(p_drv);
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_DrvStart()
+*
+* Description : Start device operation.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE    Device successfully connected.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The device only sees a connection once the host calls USBD_DrvLoopback_HostAttach().
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvStart (USBD_DRV  *p_drv,
+                             USBD_ERR  *p_err)
+{
+    if (p_drv->BSP_API_Ptr->Conn != (void *)0) {
+        p_drv->BSP_API_Ptr->Conn();
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_DrvStop()
+*
+* Description : Stop device operation.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvStop (USBD_DRV  *p_drv)
+{
+    if (p_drv->BSP_API_Ptr->Disconn != (void *)0) {
+        p_drv->BSP_API_Ptr->Disconn();
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DrvAddrSet()
+*
+* Description : Assign an address to device.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               dev_addr    Device address assigned by the host.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : (1) The loopback bus has a single device: the address is not used.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_DrvAddrSet (USBD_DRV    *p_drv,
+                                      CPU_INT08U   dev_addr)
+{
+    (void)p_drv;
+    (void)dev_addr;
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DrvAddrEn()
+*
+* Description : Enable address on device.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               dev_addr    Device address assigned by the host.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See USBD_DrvAddrSet() Note #1.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvAddrEn (USBD_DRV    *p_drv,
+                              CPU_INT08U   dev_addr)
+{
+    (void)p_drv;
+    (void)dev_addr;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DrvCfgSet()
+*
+* Description : Bring device into configured state.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               cfg_val     Configuration value.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_DrvCfgSet (USBD_DRV    *p_drv,
+                                     CPU_INT08U   cfg_val)
+{
+    (void)p_drv;
+    (void)cfg_val;
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DrvCfgClr()
+*
+* Description : Bring device into de-configured state.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               cfg_val     Configuration value.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvCfgClr (USBD_DRV    *p_drv,
+                              CPU_INT08U   cfg_val)
+{
+    (void)p_drv;
+    (void)cfg_val;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_DrvFrameNbrGet()
+*
+* Description : Retrieve current frame number.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+* Return(s)   : Frame number.
+*
+* Note(s)     : (1) The frame number follows the virtual bus clock when bus time is accounted, and the
+*                   wall clock elapsed since attach otherwise.
+*********************************************************************************************************
+*/
+
+static  CPU_INT16U  USBD_DrvFrameNbrGet (USBD_DRV  *p_drv)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    CPU_INT64U      time_ns;
+    CPU_INT16U      frame_nbr;
+
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+
+    if (p_drv_data->TimingMode == USBD_DRV_LOOPBACK_TIMING_NONE) {
+        time_ns = USBD_DrvLoopback_ClkElapsedGet(p_drv_data);
+    } else {
+        time_ns = USBD_DrvLoopback_BusTimeGet(p_drv->DevNbr);
+    }
+
+    frame_nbr = (CPU_INT16U)((time_ns / USBD_DRV_LOOPBACK_NS_PER_MS) & USBD_FRAME_NBR_MASK);
+
+    return (frame_nbr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DrvEP_Open()
+*
+* Description : Open and configure a device endpoint, given its characteristics (e.g., endpoint type,
+*               endpoint address, maximum packet size, etc).
+*
+* Argument(s) : p_drv               Pointer to device driver structure.
+*
+*               ep_addr             Endpoint address.
+*
+*               ep_type             Endpoint type.
+*
+*               max_pkt_size        Maximum packet size.
+*
+*               transaction_frame   Endpoint transactions per frame.
+*
+*               p_err               Pointer to variable that will receive the return error code from this function :
+*
+*                                       USBD_ERR_NONE    Endpoint successfully opened.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvEP_Open (USBD_DRV    *p_drv,
+                               CPU_INT08U   ep_addr,
+                               CPU_INT08U   ep_type,
+                               CPU_INT16U   max_pkt_size,
+                               CPU_INT08U   transaction_frame,
+                               USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+
+
+    (void)ep_type;
+    (void)transaction_frame;
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    p_ep->Open       = DEF_YES;
+    p_ep->Stall      = DEF_NO;
+    p_ep->MaxPktSize = max_pkt_size;
+    USBD_DrvLoopback_EP_Reset(p_ep);
+    (void)pthread_cond_broadcast(&p_drv_data->Cond);
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_DrvEP_Close()
+*
+* Description : Close a device endpoint, and uninitialize/clear endpoint configuration in hardware.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvEP_Close (USBD_DRV    *p_drv,
+                                CPU_INT08U   ep_addr)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    p_ep->Open = DEF_NO;
+    USBD_DrvLoopback_EP_Reset(p_ep);
+    (void)pthread_cond_broadcast(&p_drv_data->Cond);
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_DrvEP_RxStart()
+*
+* Description : Configure endpoint with buffer to receive data.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to data buffer.
+*
+*               buf_len     Length of the buffer.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Receive successfully configured.
+*                               USBD_ERR_EP_QUEUING     Too many buffers armed on endpoint.
+*
+* Return(s)   : Maximum number of octets that will be received.
+*
+* Note(s)     : (1) The whole buffer is armed: the host fills it directly (see 'LOCAL DATA TYPES  Note #1').
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_DrvEP_RxStart (USBD_DRV    *p_drv,
+                                        CPU_INT08U   ep_addr,
+                                        CPU_INT08U  *p_buf,
+                                        CPU_INT32U   buf_len,
+                                        USBD_ERR    *p_err)
+{
+                                                                /* See Note #1.                                         */
+    USBD_DrvLoopback_EP_Arm(p_drv, ep_addr, p_buf, buf_len, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    return (buf_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_DrvEP_Rx()
+*
+* Description : Receive the specified amount of data from device endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to data buffer.
+*
+*               buf_len     Length of the buffer.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Data successfully received.
+*                               USBD_ERR_DRV_BUF_OVERFLOW   Host sent more data than 'buf_len'.
+*                               USBD_ERR_RX                 No completed buffer on endpoint.
+*
+* Return(s)   : Number of octets received, if NO error(s).
+*
+*               0,                         otherwise.
+*
+* Note(s)     : (1) Data was already copied into the armed buffer by the host. The oldest completed buffer
+*                   is returned (see 'LOCAL DATA TYPES  Note #2').
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_DrvEP_Rx (USBD_DRV    *p_drv,
+                                   CPU_INT08U   ep_addr,
+                                   CPU_INT08U  *p_buf,
+                                   CPU_INT32U   buf_len,
+                                   USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+    USBD_DRV_XFER  *p_xfer;
+    CPU_INT32U      xfer_len;
+    CPU_BOOLEAN     overflow;
+
+
+    (void)p_buf;
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    if (p_ep->CmplCnt == 0u) {
+        (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+       *p_err = USBD_ERR_RX;
+        return (0u);
+    }
+                                                                /* See Note #1.                                         */
+    p_xfer   = &p_ep->XferTbl[p_ep->XferOutIx];
+    xfer_len =  p_xfer->XferLen;
+    overflow =  p_xfer->Overflow;
+
+    p_ep->XferOutIx++;
+    if (p_ep->XferOutIx >= USBD_DRV_LOOPBACK_XFER_QTY) {
+        p_ep->XferOutIx = 0u;
+    }
+    p_ep->CmplCnt--;
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+    if (overflow == DEF_YES) {
+       *p_err = USBD_ERR_DRV_BUF_OVERFLOW;
+        return (0u);
+    }
+
+   *p_err = USBD_ERR_NONE;
+
+    return (DEF_MIN(xfer_len, buf_len));
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_DrvEP_RxZLP()
+*
+* Description : Receive zero-length packet from endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Zero-length packet successfully received.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvEP_RxZLP (USBD_DRV    *p_drv,
+                                CPU_INT08U   ep_addr,
+                                USBD_ERR    *p_err)
+{
+    (void)USBD_DrvEP_Rx(p_drv, ep_addr, (CPU_INT08U *)0, 0u, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_DrvEP_Tx()
+*
+* Description : Configure endpoint with buffer to transmit data.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to buffer of data that will be transmitted.
+*
+*               buf_len     Number of octets to transmit.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Transmit successfully configured.
+*
+* Return(s)   : Number of octets transmitted.
+*
+* Note(s)     : (1) The buffer is transmitted in place by USBD_DrvEP_TxStart(): nothing is copied.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  USBD_DrvEP_Tx (USBD_DRV    *p_drv,
+                                   CPU_INT08U   ep_addr,
+                                   CPU_INT08U  *p_buf,
+                                   CPU_INT32U   buf_len,
+                                   USBD_ERR    *p_err)
+{
+    (void)p_drv;
+    (void)ep_addr;
+    (void)p_buf;
+
+   *p_err = USBD_ERR_NONE;
+
+    return (buf_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_DrvEP_TxStart()
+*
+* Description : Transmit the specified amount of data to device endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to buffer of data that will be transmitted.
+*
+*               buf_len     Number of octets to transmit.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Data successfully transmitted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvEP_TxStart (USBD_DRV    *p_drv,
+                                  CPU_INT08U   ep_addr,
+                                  CPU_INT08U  *p_buf,
+                                  CPU_INT32U   buf_len,
+                                  USBD_ERR    *p_err)
+{
+    USBD_DrvLoopback_EP_Arm(p_drv, ep_addr, p_buf, buf_len, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_DrvEP_TxZLP()
+*
+* Description : Transmit zero-length packet from endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE   Zero-length packet successfully transmitted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvEP_TxZLP (USBD_DRV    *p_drv,
+                                CPU_INT08U   ep_addr,
+                                USBD_ERR    *p_err)
+{
+    USBD_DrvLoopback_EP_Arm(p_drv, ep_addr, (CPU_INT08U *)0, 0u, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_DrvEP_Abort()
+*
+* Description : Abort any pending transfer on endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint Address.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_DrvEP_Abort (USBD_DRV    *p_drv,
+                                       CPU_INT08U   ep_addr)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    USBD_DrvLoopback_EP_Reset(p_ep);
+    (void)pthread_cond_broadcast(&p_drv_data->Cond);
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_DrvEP_Stall()
+*
+* Description : Set or clear stall condition on endpoint.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               state       Endpoint stall state.
+*
+* Return(s)   : DEF_OK.
+*
+* Note(s)     : (1) Stalling an endpoint also disarms it.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_DrvEP_Stall (USBD_DRV     *p_drv,
+                                       CPU_INT08U    ep_addr,
+                                       CPU_BOOLEAN   state)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    p_ep->Stall = state;
+    if (state == DEF_SET) {                                     /* See Note #1.                                         */
+        USBD_DrvLoopback_EP_Reset(p_ep);
+    }
+    (void)pthread_cond_broadcast(&p_drv_data->Cond);
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_DrvISR_Handler()
+*
+* Description : USB device Interrupt Service Routine (ISR) handler.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) There is no interrupt: bus events are signaled by the host functions (see
+*                   'usbd_drv_loopback.c  Note #2').
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvISR_Handler (USBD_DRV  *p_drv)
+{
+    (void)p_drv;
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           HOST FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_HostAttach()
+*
+* Description : Attach the device to the simulated host and reset the bus.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Device successfully attached.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Attaching also restarts the virtual bus clock.
+*********************************************************************************************************
+*/
+
+void  USBD_DrvLoopback_HostAttach (CPU_INT08U   dev_nbr,
+                                   USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV       *p_drv;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_drv_data->HostMutex);
+    p_drv_data->BusBitCnt = 0u;                                 /* See Note #1.                                         */
+    (void)clock_gettime(CLOCK_MONOTONIC, &p_drv_data->BusStartTs);
+
+    USBD_EventConn(p_drv);
+    USBD_EventReset(p_drv);
+    if (p_drv_data->BitRate == USBD_DRV_LOOPBACK_BIT_RATE_HS) {
+        USBD_EventHS(p_drv);
+    }
+    (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_HostDetach()
+*
+* Description : Detach the device from the simulated host.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Device successfully detached.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_DrvLoopback_HostDetach (CPU_INT08U   dev_nbr,
+                                   USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV       *p_drv;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_drv_data->HostMutex);
+    USBD_EventDisconn(p_drv);
+    (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_HostSetup()
+*
+* Description : Send a setup packet on the default endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_setup     Pointer to 8-octet setup packet, in USB (little-endian) format.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Setup packet successfully sent.
+*                               USBD_ERR_NULL_PTR           Argument 'p_setup' passed a NULL pointer.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Like a device controller receiving a setup packet, the endpoint 0 stall condition is
+*                   cleared before the request is handed to the stack.
+*
+*               (2) The data and status stages are left to the caller, which runs them with
+*                   USBD_DrvLoopback_HostIn/Out() on the control endpoints. This lets a host delay them,
+*                   e.g. to model a slow host.
+*********************************************************************************************************
+*/
+
+void  USBD_DrvLoopback_HostSetup (CPU_INT08U   dev_nbr,
+                                  CPU_INT08U  *p_setup,
+                                  USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV       *p_drv;
+
+
+    if (p_setup == (CPU_INT08U *)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_drv_data->HostMutex);
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);               /* See Note #1.                                         */
+    p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(USBD_DRV_LOOPBACK_EP_ADDR_CTRL_OUT)].Stall = DEF_NO;
+    p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(USBD_DRV_LOOPBACK_EP_ADDR_CTRL_IN)].Stall  = DEF_NO;
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+    USBD_DrvLoopback_BusPktAdd(p_drv_data, USBD_DRV_LOOPBACK_SETUP_PKT_LEN);
+    USBD_EventSetup(p_drv, (void *)p_setup);
+    (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_DrvLoopback_HostCtrlXfer()
+*
+* Description : Perform a control transfer on the default endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_setup     Pointer to 8-octet setup packet, in USB (little-endian) format.
+*
+*               p_buf       Pointer to data stage buffer, of at least 'wLength' octets.
+*
+*               timeout_ms  Timeout in milliseconds for each stage; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Control transfer successfully completed.
+*                               USBD_ERR_NULL_PTR           Argument 'p_setup' passed a NULL pointer.
+*                               USBD_ERR_EP_STALL           Device stalled the request.
+*
+*                                                           - RETURNED BY USBD_DrvLoopback_HostSetup() -
+*                               See USBD_DrvLoopback_HostSetup() for additional return error codes.
+*
+*                                                           - RETURNED BY USBD_DrvLoopback_HostIn/Out() -
+*                               See USBD_DrvLoopback_HostIn/Out() for additional return error codes.
+*
+* Return(s)   : Number of octets transferred during the data stage.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_DrvLoopback_HostCtrlXfer (CPU_INT08U   dev_nbr,
+                                           CPU_INT08U  *p_setup,
+                                           CPU_INT08U  *p_buf,
+                                           CPU_INT32U   timeout_ms,
+                                           USBD_ERR    *p_err)
+{
+    CPU_INT16U  req_len;
+    CPU_INT32U  xfer_len;
+    USBD_ERR    err;
+
+
+    USBD_DrvLoopback_HostSetup(dev_nbr, p_setup, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    req_len  = MEM_VAL_GET_INT16U_LITTLE(p_setup + 6u);
+    xfer_len = 0u;
+                                                                /* ------------------ DATA & STATUS ------------------- */
+    if (req_len == 0u) {
+        (void)USBD_DrvLoopback_HostIn(dev_nbr, USBD_DRV_LOOPBACK_EP_ADDR_CTRL_IN, (CPU_INT08U *)0, 0u, timeout_ms, &err);
+
+    } else if (DEF_BIT_IS_SET(p_setup[0u], USBD_REQ_DIR_BIT) == DEF_YES) {
+        xfer_len = USBD_DrvLoopback_HostIn(dev_nbr, USBD_DRV_LOOPBACK_EP_ADDR_CTRL_IN, p_buf, req_len, timeout_ms, &err);
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_DrvLoopback_HostOut(dev_nbr, USBD_DRV_LOOPBACK_EP_ADDR_CTRL_OUT, (CPU_INT08U *)0, 0u, DEF_YES, timeout_ms, &err);
+        }
+
+    } else {
+        xfer_len = USBD_DrvLoopback_HostOut(dev_nbr, USBD_DRV_LOOPBACK_EP_ADDR_CTRL_OUT, p_buf, req_len, DEF_NO, timeout_ms, &err);
+        if (err == USBD_ERR_NONE) {
+            (void)USBD_DrvLoopback_HostIn(dev_nbr, USBD_DRV_LOOPBACK_EP_ADDR_CTRL_IN, (CPU_INT08U *)0, 0u, timeout_ms, &err);
+        }
+    }
+
+   *p_err = err;
+
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_DrvLoopback_HostOut()
+*
+* Description : Send data from the host to an OUT endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     OUT endpoint address.
+*
+*               p_buf       Pointer to data to send.
+*
+*               buf_len     Number of octets to send.
+*
+*               end         DEF_YES, if a zero-length packet must end a transfer whose length is a multiple
+*                                    of the maximum packet size (see Note #2),
+*                           DEF_NO,  otherwise.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Data successfully sent.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_STALL           Endpoint stalled.
+*                               USBD_ERR_OS_TIMEOUT         Device did not accept all the data in time.
+*
+* Return(s)   : Number of octets sent.
+*
+* Note(s)     : (1) Data is sent in packets of the endpoint's maximum packet size. An armed buffer completes
+*                   on a short packet or once full, after which the host NAKs until the stack arms the
+*                   next buffer.
+*
+*               (2) A zero-length transfer always sends one zero-length packet.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_DrvLoopback_HostOut (CPU_INT08U   dev_nbr,
+                                      CPU_INT08U   ep_addr,
+                                      CPU_INT08U  *p_buf,
+                                      CPU_INT32U   buf_len,
+                                      CPU_BOOLEAN  end,
+                                      CPU_INT32U   timeout_ms,
+                                      USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA     *p_drv_data;
+    USBD_DRV          *p_drv;
+    USBD_DRV_EP       *p_ep;
+    USBD_DRV_XFER     *p_xfer;
+    struct  timespec   ts;
+    CPU_INT32U         xfer_len;
+    CPU_INT32U         pkt_len;
+    CPU_INT32U         copy_len;
+    CPU_BOOLEAN        pkt_short;
+    CPU_BOOLEAN        cmpl;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    if (USBD_EP_IS_IN(ep_addr) == DEF_YES) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return (0u);
+    }
+
+    p_ep = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    if (timeout_ms != 0u) {
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        USBD_DrvLoopback_TsAdd(&ts, (CPU_INT64U)timeout_ms * USBD_DRV_LOOPBACK_NS_PER_MS);
+    }
+
+    (void)pthread_mutex_lock(&p_drv_data->HostMutex);
+
+    xfer_len  = 0u;
+    pkt_short = DEF_NO;
+    do {
+        (void)pthread_mutex_lock(&p_drv_data->Mutex);
+        USBD_DrvLoopback_HostWait(p_drv_data, p_ep, timeout_ms, &ts, p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+            (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+            return (xfer_len);
+        }
+                                                                /* See Note #1.                                         */
+        p_xfer    = &p_ep->XferTbl[p_ep->XferCurIx];
+        pkt_len   =  DEF_MIN(buf_len - xfer_len, p_ep->MaxPktSize);
+        pkt_short = (pkt_len < p_ep->MaxPktSize) ? DEF_YES : DEF_NO;
+        copy_len  =  DEF_MIN(pkt_len, p_xfer->BufLen - p_xfer->XferLen);
+        if (copy_len < pkt_len) {
+            p_xfer->Overflow = DEF_YES;
+        }
+        if (copy_len > 0u) {
+            Mem_Copy((void     *)(p_xfer->BufPtr + p_xfer->XferLen),
+                     (void     *)(p_buf          + xfer_len),
+                     (CPU_SIZE_T) copy_len);
+        }
+        p_xfer->XferLen += copy_len;
+
+        cmpl = DEF_NO;
+        if ((pkt_short       == DEF_YES) ||
+            (p_xfer->XferLen == p_xfer->BufLen)) {
+            USBD_DrvLoopback_EP_XferCmpl(p_ep, DEF_NO);
+            cmpl = DEF_YES;
+        }
+        (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+        xfer_len += pkt_len;
+        USBD_DrvLoopback_BusPktAdd(p_drv_data, pkt_len);
+
+        if (cmpl == DEF_YES) {
+            USBD_EP_RxCmpl(p_drv, USBD_EP_ADDR_TO_LOG(ep_addr));
+        }
+    } while ((xfer_len < buf_len) ||                            /* Send ZLP if needed (see Note #2).                    */
+            ((end == DEF_YES) && (pkt_short == DEF_NO)));
+
+    (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+
+   *p_err = USBD_ERR_NONE;
+
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_DrvLoopback_HostIn()
+*
+* Description : Receive data on the host from an IN endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     IN endpoint address.
+*
+*               p_buf       Pointer to buffer that will receive data.
+*
+*               buf_len     Number of octets to receive.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Data successfully received.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_STALL           Endpoint stalled.
+*                               USBD_ERR_DRV_BUF_OVERFLOW   Device sent data on a zero-length request.
+*                               USBD_ERR_OS_TIMEOUT         Device did not send the data in time.
+*
+* Return(s)   : Number of octets received.
+*
+* Note(s)     : (1) The transfer ends once 'buf_len' octets are received or on a short packet. A
+*                   zero-length request waits for one zero-length packet (e.g. a status stage).
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_DrvLoopback_HostIn (CPU_INT08U   dev_nbr,
+                                     CPU_INT08U   ep_addr,
+                                     CPU_INT08U  *p_buf,
+                                     CPU_INT32U   buf_len,
+                                     CPU_INT32U   timeout_ms,
+                                     USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA     *p_drv_data;
+    USBD_DRV          *p_drv;
+    USBD_DRV_EP       *p_ep;
+    USBD_DRV_XFER     *p_xfer;
+    struct  timespec   ts;
+    CPU_INT32U         xfer_len;
+    CPU_INT32U         pkt_len;
+    CPU_BOOLEAN        pkt_short;
+    CPU_BOOLEAN        cmpl;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    if (USBD_EP_IS_IN(ep_addr) == DEF_NO) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return (0u);
+    }
+
+    p_ep = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    if (timeout_ms != 0u) {
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        USBD_DrvLoopback_TsAdd(&ts, (CPU_INT64U)timeout_ms * USBD_DRV_LOOPBACK_NS_PER_MS);
+    }
+
+    (void)pthread_mutex_lock(&p_drv_data->HostMutex);
+
+    xfer_len = 0u;
+    do {
+        (void)pthread_mutex_lock(&p_drv_data->Mutex);
+        USBD_DrvLoopback_HostWait(p_drv_data, p_ep, timeout_ms, &ts, p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+            (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+            return (xfer_len);
+        }
+
+        p_xfer    = &p_ep->XferTbl[p_ep->XferCurIx];
+        pkt_len   =  DEF_MIN(p_xfer->BufLen - p_xfer->XferLen, p_ep->MaxPktSize);
+        pkt_short = (pkt_len < p_ep->MaxPktSize) ? DEF_YES : DEF_NO;
+        if (pkt_len > (buf_len - xfer_len)) {                   /* Babble: dev sent more than requested.                */
+            (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+            (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+           *p_err = USBD_ERR_DRV_BUF_OVERFLOW;
+            return (xfer_len);
+        }
+        if (pkt_len > 0u) {
+            Mem_Copy((void     *)(p_buf          + xfer_len),
+                     (void     *)(p_xfer->BufPtr + p_xfer->XferLen),
+                     (CPU_SIZE_T) pkt_len);
+        }
+        p_xfer->XferLen += pkt_len;
+
+        cmpl = DEF_NO;
+        if (p_xfer->XferLen == p_xfer->BufLen) {
+            USBD_DrvLoopback_EP_XferCmpl(p_ep, DEF_YES);
+            cmpl = DEF_YES;
+        }
+        (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+        xfer_len += pkt_len;
+        USBD_DrvLoopback_BusPktAdd(p_drv_data, pkt_len);
+
+        if (cmpl == DEF_YES) {
+            USBD_EP_TxCmpl(p_drv, USBD_EP_ADDR_TO_LOG(ep_addr));
+        }
+    } while ((xfer_len  < buf_len) &&                           /* See Note #1.                                         */
+             (pkt_short == DEF_NO));
+
+    (void)pthread_mutex_unlock(&p_drv_data->HostMutex);
+
+   *p_err = USBD_ERR_NONE;
+
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_TimingSet()
+*
+* Description : Set the bus timing mode of the simulated host.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               mode        Bus timing mode (see 'usbd_drv_loopback.h  DEFINES  Note #1') :
+*
+*                               USBD_DRV_LOOPBACK_TIMING_NONE
+*                               USBD_DRV_LOOPBACK_TIMING_VIRTUAL
+*                               USBD_DRV_LOOPBACK_TIMING_REAL
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Switching mode restarts the virtual bus clock.
+*********************************************************************************************************
+*/
+
+void  USBD_DrvLoopback_TimingSet (CPU_INT08U  dev_nbr,
+                                  CPU_INT08U  mode)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV       *p_drv;
+    USBD_ERR        err;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, &err);
+    if (err != USBD_ERR_NONE) {
+        return;
+    }
+
+    p_drv_data->TimingMode = mode;
+    p_drv_data->BusBitCnt  = 0u;                                /* See Note #1.                                         */
+    (void)clock_gettime(CLOCK_MONOTONIC, &p_drv_data->BusStartTs);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_BusTimeGet()
+*
+* Description : Get the virtual bus clock.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+* Return(s)   : Bus time spent on packets since attach, in nanoseconds.
+*
+* Note(s)     : (1) The bus clock only runs in USBD_DRV_LOOPBACK_TIMING_VIRTUAL and ..._REAL modes.
+*********************************************************************************************************
+*/
+
+CPU_INT64U  USBD_DrvLoopback_BusTimeGet (CPU_INT08U  dev_nbr)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV       *p_drv;
+    USBD_ERR        err;
+
+
+    p_drv_data = USBD_DrvLoopback_DataGet(dev_nbr, &p_drv, &err);
+    if (err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    return ((p_drv_data->BusBitCnt * 1000u) / p_drv_data->BitRate);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                     USBD_DrvLoopback_EP_Reset()
+*
+* Description : Disarm all the buffers of an endpoint.
+*
+* Argument(s) : p_ep        Pointer to endpoint.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Driver mutex must be held by caller.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_EP_Reset (USBD_DRV_EP  *p_ep)
+{
+    p_ep->XferInIx  = 0u;
+    p_ep->XferCurIx = 0u;
+    p_ep->XferOutIx = 0u;
+    p_ep->ArmedCnt  = 0u;
+    p_ep->CmplCnt   = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_DrvLoopback_EP_Arm()
+*
+* Description : Arm an endpoint with a buffer.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to buffer.
+*
+*               buf_len     Length of the buffer.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Buffer armed.
+*                               USBD_ERR_EP_QUEUING     Too many buffers armed on endpoint.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The buffer is appended to the endpoint's FIFO (see 'LOCAL DATA TYPES  Note #2').
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_EP_Arm (USBD_DRV    *p_drv,
+                                       CPU_INT08U   ep_addr,
+                                       CPU_INT08U  *p_buf,
+                                       CPU_INT32U   buf_len,
+                                       USBD_ERR    *p_err)
+{
+    USBD_DRV_DATA  *p_drv_data;
+    USBD_DRV_EP    *p_ep;
+    USBD_DRV_XFER  *p_xfer;
+
+
+    p_drv_data = (USBD_DRV_DATA *)p_drv->DataPtr;
+    p_ep       = &p_drv_data->EP_Tbl[USBD_EP_ADDR_TO_PHY(ep_addr)];
+
+    (void)pthread_mutex_lock(&p_drv_data->Mutex);
+    if ((p_ep->ArmedCnt + p_ep->CmplCnt) >= USBD_DRV_LOOPBACK_XFER_QTY) {
+        (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+       *p_err = USBD_ERR_EP_QUEUING;
+        return;
+    }
+                                                                /* See Note #1.                                         */
+    p_xfer           = &p_ep->XferTbl[p_ep->XferInIx];
+    p_xfer->BufPtr   =  p_buf;
+    p_xfer->BufLen   =  buf_len;
+    p_xfer->XferLen  =  0u;
+    p_xfer->Overflow =  DEF_NO;
+
+    p_ep->XferInIx++;
+    if (p_ep->XferInIx >= USBD_DRV_LOOPBACK_XFER_QTY) {
+        p_ep->XferInIx = 0u;
+    }
+    p_ep->ArmedCnt++;
+    (void)pthread_cond_broadcast(&p_drv_data->Cond);
+    (void)pthread_mutex_unlock(&p_drv_data->Mutex);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_EP_XferCmpl()
+*
+* Description : Complete the buffer being moved by the host and move on to the next armed one.
+*
+* Argument(s) : p_ep        Pointer to endpoint.
+*
+*               ep_dir_in   Endpoint direction.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Driver mutex must be held by caller.
+*
+*               (2) A completed OUT buffer waits for the stack to read its length with USBD_DrvEP_Rx(). A
+*                   completed IN buffer is released right away.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_EP_XferCmpl (USBD_DRV_EP  *p_ep,
+                                            CPU_BOOLEAN   ep_dir_in)
+{
+    p_ep->XferCurIx++;
+    if (p_ep->XferCurIx >= USBD_DRV_LOOPBACK_XFER_QTY) {
+        p_ep->XferCurIx = 0u;
+    }
+    p_ep->ArmedCnt--;
+
+    if (ep_dir_in == DEF_NO) {                                  /* See Note #2.                                         */
+        p_ep->CmplCnt++;
+    } else {
+        p_ep->XferOutIx = p_ep->XferCurIx;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_DrvLoopback_DataGet()
+*
+* Description : Get the driver of a device started with the loopback driver.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               pp_drv      Pointer to variable that will receive the device driver structure.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Driver found.
+*                               USBD_ERR_DEV_INVALID_NBR    Device not started with the loopback driver.
+*
+* Return(s)   : Pointer to driver data, if NO error(s).
+*
+*               Pointer to NULL,        otherwise.
+*********************************************************************************************************
+*/
+
+static  USBD_DRV_DATA  *USBD_DrvLoopback_DataGet (CPU_INT08U    dev_nbr,
+                                                  USBD_DRV    **pp_drv,
+                                                  USBD_ERR     *p_err)
+{
+    USBD_DRV  *p_drv;
+
+
+    if (dev_nbr >= USBD_CFG_MAX_NBR_DEV) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return ((USBD_DRV_DATA *)0);
+    }
+
+    p_drv = USBD_DrvLoopback_DrvTbl[dev_nbr];
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return ((USBD_DRV_DATA *)0);
+    }
+
+   *pp_drv = p_drv;
+   *p_err  = USBD_ERR_NONE;
+
+    return ((USBD_DRV_DATA *)p_drv->DataPtr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                     USBD_DrvLoopback_HostWait()
+*
+* Description : Wait until an endpoint is armed, i.e. until it stops NAKing.
+*
+* Argument(s) : p_drv_data  Pointer to driver data. Its mutex must be held by the caller.
+*
+*               p_ep        Pointer to endpoint.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_ts        Pointer to absolute expiry time, if 'timeout_ms' is not 0.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Endpoint armed.
+*                               USBD_ERR_EP_STALL       Endpoint stalled.
+*                               USBD_ERR_OS_TIMEOUT     Endpoint not armed in time.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_HostWait (USBD_DRV_DATA     *p_drv_data,
+                                         USBD_DRV_EP       *p_ep,
+                                         CPU_INT32U         timeout_ms,
+                                         struct  timespec  *p_ts,
+                                         USBD_ERR          *p_err)
+{
+    int  os_err;
+
+
+    os_err = 0;
+    while ((p_ep->Stall    == DEF_NO) &&
+           (p_ep->ArmedCnt == 0u)) {
+        if (os_err == ETIMEDOUT) {
+           *p_err = USBD_ERR_OS_TIMEOUT;
+            return;
+        }
+        if (timeout_ms == 0u) {
+            os_err = pthread_cond_wait(&p_drv_data->Cond, &p_drv_data->Mutex);
+        } else {
+            os_err = pthread_cond_timedwait(&p_drv_data->Cond, &p_drv_data->Mutex, p_ts);
+        }
+    }
+
+    if (p_ep->Stall == DEF_YES) {
+       *p_err = USBD_ERR_EP_STALL;
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                    USBD_DrvLoopback_BusPktAdd()
+*
+* Description : Account the bus time of one data packet.
+*
+* Argument(s) : p_drv_data  Pointer to driver data.
+*
+*               pkt_len     Packet payload length, in octets.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'usbd_drv_loopback.h  DEFINES  Note #1'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_BusPktAdd (USBD_DRV_DATA  *p_drv_data,
+                                          CPU_INT32U      pkt_len)
+{
+    struct  timespec  ts;
+    CPU_INT64U        bus_ns;
+
+
+    if (p_drv_data->TimingMode == USBD_DRV_LOOPBACK_TIMING_NONE) {
+        return;
+    }
+
+    p_drv_data->BusBitCnt += (CPU_INT64U)(pkt_len + p_drv_data->PktOverhead) * DEF_OCTET_NBR_BITS;
+
+    if (p_drv_data->TimingMode == USBD_DRV_LOOPBACK_TIMING_REAL) {
+        bus_ns = (p_drv_data->BusBitCnt * 1000u) / p_drv_data->BitRate;
+        ts     =  p_drv_data->BusStartTs;
+        USBD_DrvLoopback_TsAdd(&ts, bus_ns);
+                                                                /* Wait until wall clock reaches bus clock.             */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, DEF_NULL) == EINTR) {
+            ;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                  USBD_DrvLoopback_ClkElapsedGet()
+*
+* Description : Get the wall clock time elapsed since attach.
+*
+* Argument(s) : p_drv_data  Pointer to driver data.
+*
+* Return(s)   : Elapsed time, in nanoseconds.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT64U  USBD_DrvLoopback_ClkElapsedGet (USBD_DRV_DATA  *p_drv_data)
+{
+    struct  timespec  ts;
+    CPU_INT64U        elapsed_ns;
+
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    elapsed_ns = ((CPU_INT64U)(ts.tv_sec - p_drv_data->BusStartTs.tv_sec) * USBD_DRV_LOOPBACK_NS_PER_SEC)
+               +  (CPU_INT64U)(ts.tv_nsec - p_drv_data->BusStartTs.tv_nsec);
+
+    return (elapsed_ns);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_DrvLoopback_TsAdd()
+*
+* Description : Add a duration to a time specification.
+*
+* Argument(s) : p_ts        Pointer to time specification.
+*
+*               ns          Duration, in nanoseconds.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_DrvLoopback_TsAdd (struct  timespec  *p_ts,
+                                      CPU_INT64U         ns)
+{
+    ns           += (CPU_INT64U)p_ts->tv_nsec;
+    p_ts->tv_sec += (time_t)(ns / USBD_DRV_LOOPBACK_NS_PER_SEC);
+    p_ts->tv_nsec = (long  )(ns % USBD_DRV_LOOPBACK_NS_PER_SEC);
+}
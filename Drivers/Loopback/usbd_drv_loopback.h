@@ -0,0 +1,141 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                          USB DEVICE DRIVER
+*
+*                                    IN-MEMORY LOOPBACK CONTROLLER
+*
+* Filename : usbd_drv_loopback.h
+* Version  : V4.06.01
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                               MODULE
+*
+* Note(s) : (1) This USB device driver function header file is protected from multiple pre-processor
+*               inclusion through use of the USB device driver module present pre-processor macro
+*               definition.
+*********************************************************************************************************
+*/
+
+#ifndef  USBD_DRV_LOOPBACK_MODULE_PRESENT                       /* See Note #1.                                         */
+#define  USBD_DRV_LOOPBACK_MODULE_PRESENT
+
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  "../../Source/usbd_core.h"
+
+
+/*
+*********************************************************************************************************
+*                                               DEFINES
+*
+* Note(s) : (1) Bus timing modes of the simulated host (see USBD_DrvLoopback_TimingSet()) :
+*
+*               (a) USBD_DRV_LOOPBACK_TIMING_NONE     Packets are exchanged as fast as the stack goes and
+*                                                     no bus time is accounted.
+*
+*               (b) USBD_DRV_LOOPBACK_TIMING_VIRTUAL  Packets are exchanged as fast as the stack goes and
+*                                                     the time each packet would take on the bus is
+*                                                     accumulated in a virtual bus clock.
+*
+*               (c) USBD_DRV_LOOPBACK_TIMING_REAL     Same as (b), but the host also waits until the
+*                                                     wall clock catches up with the virtual bus clock,
+*                                                     which caps the throughput at the bus rate.
+*********************************************************************************************************
+*/
+
+#define  USBD_DRV_LOOPBACK_TIMING_NONE                    0u    /* See Note #1a.                                        */
+#define  USBD_DRV_LOOPBACK_TIMING_VIRTUAL                 1u    /* See Note #1b.                                        */
+#define  USBD_DRV_LOOPBACK_TIMING_REAL                    2u    /* See Note #1c.                                        */
+
+
+/*
+*********************************************************************************************************
+*                                          USB DEVICE DRIVER
+*********************************************************************************************************
+*/
+
+extern  USBD_DRV_API      USBD_DrvAPI_Loopback;
+extern  USBD_DRV_BSP_API  USBD_DrvBSP_Loopback;
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*
+* Note(s) : (1) The host functions below play the role of the host controller and of the device
+*               controller's interrupt: they must be called from a host thread, never from the stack's
+*               tasks nor from a class callback.
+*********************************************************************************************************
+*/
+
+                                                                /* ------------- HOST FUNCTIONS (see Note #1) --------- */
+void         USBD_DrvLoopback_HostAttach  (CPU_INT08U   dev_nbr,
+                                           USBD_ERR    *p_err);
+
+void         USBD_DrvLoopback_HostDetach  (CPU_INT08U   dev_nbr,
+                                           USBD_ERR    *p_err);
+
+void         USBD_DrvLoopback_HostSetup   (CPU_INT08U   dev_nbr,
+                                           CPU_INT08U  *p_setup,
+                                           USBD_ERR    *p_err);
+
+CPU_INT32U   USBD_DrvLoopback_HostCtrlXfer(CPU_INT08U   dev_nbr,
+                                           CPU_INT08U  *p_setup,
+                                           CPU_INT08U  *p_buf,
+                                           CPU_INT32U   timeout_ms,
+                                           USBD_ERR    *p_err);
+
+CPU_INT32U   USBD_DrvLoopback_HostOut     (CPU_INT08U   dev_nbr,
+                                           CPU_INT08U   ep_addr,
+                                           CPU_INT08U  *p_buf,
+                                           CPU_INT32U   buf_len,
+                                           CPU_BOOLEAN  end,
+                                           CPU_INT32U   timeout_ms,
+                                           USBD_ERR    *p_err);
+
+CPU_INT32U   USBD_DrvLoopback_HostIn      (CPU_INT08U   dev_nbr,
+                                           CPU_INT08U   ep_addr,
+                                           CPU_INT08U  *p_buf,
+                                           CPU_INT32U   buf_len,
+                                           CPU_INT32U   timeout_ms,
+                                           USBD_ERR    *p_err);
+
+                                                                /* ------------------ BUS TIMING FNCTS ---------------- */
+void         USBD_DrvLoopback_TimingSet   (CPU_INT08U   dev_nbr,
+                                           CPU_INT08U   mode);
+
+CPU_INT64U   USBD_DrvLoopback_BusTimeGet  (CPU_INT08U   dev_nbr);
+
+
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif
@@ -784,6 +784,11 @@ USBD_DRV_API  USBD_DrvAPI_RX600 = { USBD_DrvInitRX600,
                                     USBD_DrvEP_Abort,
                                     USBD_DrvEP_Stall,
                                     USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                    DEF_NULL,
+                                    DEF_NULL,
+                                    DEF_NULL,
+#endif
 };
 
 
@@ -806,6 +811,11 @@ USBD_DRV_API  USBD_DrvAPI_V850E2JX4L = { USBD_DrvInitJX4L,
                                          USBD_DrvEP_Abort,
                                          USBD_DrvEP_Stall,
                                          USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                         DEF_NULL,
+                                         DEF_NULL,
+                                         DEF_NULL,
+#endif
 };
 
 
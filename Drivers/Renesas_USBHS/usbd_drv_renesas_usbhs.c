@@ -795,6 +795,11 @@ USBD_DRV_API  USBD_DrvAPI_RenesasRZ_DMA = { USBD_DrvInitRZ_DMA,
                                             USBD_DrvEP_Abort,
                                             USBD_DrvEP_Stall,
                                             USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                            DEF_NULL,
+                                            DEF_NULL,
+                                            DEF_NULL,
+#endif
 };
 
                                                                 /* ----- RENESAS USBHS DRIVER FIFO IMPLEMENTATION ----- */
@@ -817,6 +822,11 @@ USBD_DRV_API  USBD_DrvAPI_RenesasRZ_FIFO = { USBD_DrvInitRZ_FIFO,
                                              USBD_DrvEP_Abort,
                                              USBD_DrvEP_Stall,
                                              USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                             DEF_NULL,
+                                             DEF_NULL,
+                                             DEF_NULL,
+#endif
 };
 
 
@@ -846,6 +856,11 @@ USBD_DRV_API  USBD_DrvAPI_RenesasRX64M_DMA = { USBD_DrvInitRX64M_DMA,
                                                USBD_DrvEP_Abort,
                                                USBD_DrvEP_Stall,
                                                USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                               DEF_NULL,
+                                               DEF_NULL,
+                                               DEF_NULL,
+#endif
 };
 
                                                                 /* ----- RENESAS USBHS DRIVER FIFO IMPLEMENTATION ----- */
@@ -868,6 +883,11 @@ USBD_DRV_API  USBD_DrvAPI_RenesasRX64M_FIFO = { USBD_DrvInitRX64M_FIFO,
                                                 USBD_DrvEP_Abort,
                                                 USBD_DrvEP_Stall,
                                                 USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                                DEF_NULL,
+                                                DEF_NULL,
+                                                DEF_NULL,
+#endif
 };
 
 /*
@@ -669,6 +669,11 @@ USBD_DRV_API  USBD_DrvAPI_STM32F_FS     = { USBD_DrvSTM32F_FS_Init,
                                             USBD_DrvEP_Abort,
                                             USBD_DrvEP_Stall,
                                             USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                            DEF_NULL,
+                                            DEF_NULL,
+                                            DEF_NULL,
+#endif
                                           };
 
 
@@ -692,6 +697,11 @@ USBD_DRV_API  USBD_DrvAPI_STM32F_OTG_FS = { USBD_DrvSTM32F_OTG_FS_Init,
                                             USBD_DrvEP_Abort,
                                             USBD_DrvEP_Stall,
                                             USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                            DEF_NULL,
+                                            DEF_NULL,
+                                            DEF_NULL,
+#endif
                                           };
 
                                                                 /* -------------- EFM32_OTG_FS DRIVER API ------------- */
@@ -714,6 +724,11 @@ USBD_DRV_API  USBD_DrvAPI_EFM32_OTG_FS  = { USBD_DrvEFM32_OTG_FS_Init,
                                             USBD_DrvEP_Abort,
                                             USBD_DrvEP_Stall,
                                             USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                            DEF_NULL,
+                                            DEF_NULL,
+                                            DEF_NULL,
+#endif
                                           };
 
                                                                 /* --------------- XMC_OTG_FS DRIVER API -------------- */
@@ -736,6 +751,11 @@ USBD_DRV_API  USBD_DrvAPI_XMC_OTG_FS    = { USBD_DrvXMC_OTG_FS_Init,
                                             USBD_DrvEP_Abort,
                                             USBD_DrvEP_Stall,
                                             USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                            DEF_NULL,
+                                            DEF_NULL,
+                                            DEF_NULL,
+#endif
                                           };
 
 
@@ -386,6 +386,11 @@ USBD_DRV_API  USBD_DrvAPI_STM32XXX = { USBD_DrvInit,
                                        USBD_DrvEP_Abort,
                                        USBD_DrvEP_Stall,
                                        USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                       DEF_NULL,
+                                       DEF_NULL,
+                                       DEF_NULL,
+#endif
                                      };
 
 
@@ -89,7 +89,10 @@
 #define  USBD_OTGHS_ALIGN_OCTECTS_BUF               ( 1u * (   1u))
 
 #define  USBD_OTGHS_MAX_NBR_EP_OPEN                 DEF_MIN(USBD_CFG_MAX_NBR_EP_OPEN, USBD_OTGHS_EP_PHY_NBR_MAX)
-#define  USBD_OTGHS_dTD_NBR                        (USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                                /* Nbr of xfers that can be queued on top of one per EP.*/
+#define  USBD_OTGHS_URB_QUEUED_NBR                 (USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                    USBD_CFG_MAX_NBR_URB_RSVD  )
+#define  USBD_OTGHS_dTD_NBR                        (USBD_OTGHS_URB_QUEUED_NBR  + \
                                                     USBD_OTGHS_MAX_NBR_EP_OPEN )
 
                                                                 /* ---------- USB DEVICE REGISTER BIT DEFINES --------- */
@@ -519,7 +522,7 @@ typedef  struct  usbd_drv_data {
     USBD_OTGHS_dQH    *dQH_Tbl;
     MEM_POOL           dTD_MemPool;
     CPU_INT08U         hw_rev;
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_OTGHS_URB_QUEUED_NBR > 0u)
     CPU_INT08U        *dTD_UsageTbl;
 #endif
     CPU_BOOLEAN        Suspend;
@@ -717,6 +720,11 @@ USBD_DRV_API  USBD_DrvAPI_Synopsys_OTG_HS = { USBD_DrvInit,
                                               USBD_DrvEP_Abort,
                                               USBD_DrvEP_Stall,
                                               USBD_DrvISR_Handler,
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                              DEF_NULL,
+                                              DEF_NULL,
+                                              DEF_NULL,
+#endif
 };
 
 
@@ -807,7 +815,7 @@ static  void  USBD_DrvInit (USBD_DRV    *p_drv,
     Mem_Clr((void  *) p_drv_data->dQH_Tbl,
                      (sizeof(USBD_OTGHS_dQH) * (ep_phy_nbr_max)));
 
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_OTGHS_URB_QUEUED_NBR > 0u)
                                                                 /* Alloc tbl tracking nbr of dTD used by ongoing... */
                                                                 /* ...xfers for all open EP.                        */
     p_drv_data->dTD_UsageTbl = (CPU_INT08U *)Mem_HeapAlloc(             (sizeof(CPU_INT08U) * ep_phy_nbr_max),
@@ -2118,7 +2126,7 @@ static  void  USBD_OTGHS_dTD_LstInsert (USBD_DRV    *p_drv,
     CPU_INT32U           ep_status;
     CPU_INT08U           ep_log_nbr;
     LIB_ERR              err_lib;
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_OTGHS_URB_QUEUED_NBR > 0u)
     CPU_INT08U           dtd_used;
     CPU_INT08U           ep_empty;
     CPU_INT08U           ep_phy_nbr_max;
@@ -2136,7 +2144,7 @@ static  void  USBD_OTGHS_dTD_LstInsert (USBD_DRV    *p_drv,
                                                                 /* next CPU read will be from RAM again.                */
     p_dtd_last = p_dqh->dTD_LstTailPtr;
 
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_OTGHS_URB_QUEUED_NBR > 0u)
                                                                 /* If EP type is bulk, intr or isoc.                    */
     if (((p_reg->ENDPTCTRLx[ep_log_nbr] & USBD_OTGHS_ENDPTCTRL_TX_TYPE_MASK) != USBD_OTGHS_ENDPTCTRL_TX_TYPE_CTRL) ||
         ((p_reg->ENDPTCTRLx[ep_log_nbr] & USBD_OTGHS_ENDPTCTRL_RX_TYPE_MASK) != USBD_OTGHS_ENDPTCTRL_RX_TYPE_CTRL)) {
@@ -2472,7 +2480,7 @@ static  CPU_BOOLEAN  USBD_OTGHS_dTD_LstRemove (USBD_DRV    *p_drv,
         p_dqh->dTD_LstNbrEntries--;
         OTGHS_DBG_STATS_INC(EP_Tbl[ep_phy_nbr].dTD_LstRemove_LstNonEmptyCnt);
     }
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_OTGHS_URB_QUEUED_NBR > 0u)
     (p_drv_data->dTD_UsageTbl[ep_phy_nbr])--;
 #endif
 
@@ -0,0 +1,1029 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                   USB DEVICE OPERATING SYSTEM LAYER
+*                                           POSIX (pthreads)
+*
+* Filename : usbd_os.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This port runs the core and trace tasks as POSIX threads. It is meant to run the stack
+*                on a host workstation, e.g. together with the loopback device controller driver, to
+*                profile the stack or test classes without target hardware.
+*
+*            (2) Signals, locks and the core event queue are built on a mutex and a condition variable
+*                waiting on CLOCK_MONOTONIC. Thread priorities are not set: the threads run under the
+*                default scheduling policy of the process.
+*
+*            (3) The port uses POSIX.1-2008 interfaces (clock_gettime(), nanosleep(), condition variable
+*                clock attributes), which a strict ISO C compiler mode (e.g. '-std=c11') hides unless the
+*                feature test macro is defined before the first system header is included.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#define    _POSIX_C_SOURCE                200809L               /* See Note #3.                                         */
+#define    MICRIUM_SOURCE
+#include  "../../Source/usbd_core.h"
+#include  "../../Source/usbd_internal.h"
+#include  <pthread.h>
+#include  <errno.h>
+#include  <time.h>
+
+
+/*
+*********************************************************************************************************
+*                                        CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  USBD_OS_NS_PER_SEC                       1000000000L
+#define  USBD_OS_NS_PER_MS                           1000000L
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*
+* Note(s) : (1) The mutex and condition variable of a semaphore are initialized once by USBD_OS_Init()
+*               and never destroyed: deleting a semaphore only invalidates it and wakes up its waiters,
+*               which then return USBD_ERR_OS_DEL.
+*
+*               (a) Deleting a semaphore also advances 'AbortCtr', which is never reset. A semaphore may
+*                   be re-created (e.g. an endpoint index reused by USBD_EP_Open()) before its waiters
+*                   get to run; they still observe the counter change and return USBD_ERR_OS_ABORT.
+*
+*           (2) Aborting a semaphore only affects the threads pending on it when the abort occurs. Each
+*               waiter records 'AbortCtr' when it starts pending and returns USBD_ERR_OS_ABORT as soon
+*               as the counter changes.
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_os_sem {
+    pthread_mutex_t   Mutex;
+    pthread_cond_t    Cond;
+    CPU_INT32U        Cnt;                                      /* Semaphore count.                                     */
+    CPU_INT32U        AbortCtr;                                 /* Abort counter (see Note #2).                         */
+    CPU_BOOLEAN       Valid;                                    /* Semaphore created and not deleted (see Note #1).     */
+} USBD_OS_SEM;
+
+
+typedef  struct  usbd_os_q {
+    pthread_mutex_t   Mutex;
+    pthread_cond_t    Cond;
+    void             *MsgTbl[USBD_CORE_EVENT_NBR_TOTAL];        /* Circular buffer of msgs.                             */
+    CPU_INT32U        InIx;                                     /* Ix of next msg to put.                               */
+    CPU_INT32U        OutIx;                                    /* Ix of next msg to get.                               */
+    CPU_INT32U        NbrEntries;                               /* Nbr of msgs in buffer.                               */
+} USBD_OS_Q;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+                                                                /* -------------- USB EVENT QUEUE OBJECTS ------------- */
+static  USBD_OS_Q     USBD_OS_EventQ;
+
+static  pthread_t     USBD_OS_CoreThread;
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+static  USBD_OS_SEM   USBD_OS_TraceSem;
+static  pthread_t     USBD_OS_TraceThread;
+#endif
+
+static  USBD_OS_SEM   USBD_OS_EP_SemTbl[USBD_CFG_MAX_NBR_DEV][USBD_CFG_MAX_NBR_EP_OPEN];
+static  USBD_OS_SEM   USBD_OS_EP_LockTbl[USBD_CFG_MAX_NBR_DEV][USBD_CFG_MAX_NBR_EP_OPEN];
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL MACRO'S
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  void         *USBD_OS_CoreTask   (void          *p_arg);
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+static  void         *USBD_OS_TraceTask  (void          *p_arg);
+#endif
+
+static  CPU_BOOLEAN   USBD_OS_CondInit   (pthread_mutex_t  *p_mutex,
+                                          pthread_cond_t   *p_cond);
+
+static  void          USBD_OS_SemCreate  (USBD_OS_SEM   *p_sem,
+                                          CPU_INT32U     cnt);
+
+static  void          USBD_OS_SemDel     (USBD_OS_SEM   *p_sem);
+
+static  void          USBD_OS_SemPend    (USBD_OS_SEM   *p_sem,
+                                          CPU_INT32U     timeout_ms,
+                                          USBD_ERR      *p_err);
+
+static  void          USBD_OS_SemAbort   (USBD_OS_SEM   *p_sem);
+
+static  void          USBD_OS_SemPost    (USBD_OS_SEM   *p_sem);
+
+static  void          USBD_OS_TimeoutGet (CPU_INT32U       timeout_ms,
+                                          struct timespec *p_ts);
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_OS_Init()
+*
+* Description : Initialize OS interface.
+*
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           OS initialization successful.
+*                               USBD_ERR_OS_INIT_FAIL   OS objects NOT successfully initialized.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_Init (USBD_ERR  *p_err)
+{
+    USBD_OS_SEM  *p_sem;
+    CPU_INT08U    dev_nbr;
+    CPU_INT08U    ep_ix;
+    CPU_BOOLEAN   valid;
+    int           os_err;
+
+
+    for (dev_nbr = 0u; dev_nbr < USBD_CFG_MAX_NBR_DEV; dev_nbr++) {
+        for (ep_ix = 0u; ep_ix < USBD_CFG_MAX_NBR_EP_OPEN; ep_ix++) {
+            p_sem        = &USBD_OS_EP_SemTbl[dev_nbr][ep_ix];
+            p_sem->Valid =  DEF_NO;
+            valid        =  USBD_OS_CondInit(&p_sem->Mutex, &p_sem->Cond);
+            if (valid != DEF_OK) {
+               *p_err = USBD_ERR_OS_INIT_FAIL;
+                return;
+            }
+
+            p_sem        = &USBD_OS_EP_LockTbl[dev_nbr][ep_ix];
+            p_sem->Valid =  DEF_NO;
+            valid        =  USBD_OS_CondInit(&p_sem->Mutex, &p_sem->Cond);
+            if (valid != DEF_OK) {
+               *p_err = USBD_ERR_OS_INIT_FAIL;
+                return;
+            }
+        }
+    }
+                                                                /* Create USB events queue.                             */
+    USBD_OS_EventQ.InIx       = 0u;
+    USBD_OS_EventQ.OutIx      = 0u;
+    USBD_OS_EventQ.NbrEntries = 0u;
+    valid = USBD_OS_CondInit(&USBD_OS_EventQ.Mutex, &USBD_OS_EventQ.Cond);
+    if (valid != DEF_OK) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+                                                                /* Create USB core task.                                */
+    os_err = pthread_create(&USBD_OS_CoreThread,
+                             DEF_NULL,
+                             USBD_OS_CoreTask,
+                             DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+    valid = USBD_OS_CondInit(&USBD_OS_TraceSem.Mutex, &USBD_OS_TraceSem.Cond);
+    if (valid != DEF_OK) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+    USBD_OS_SemCreate(&USBD_OS_TraceSem, 0u);
+
+    os_err = pthread_create(&USBD_OS_TraceThread,
+                             DEF_NULL,
+                             USBD_OS_TraceTask,
+                             DEF_NULL);
+    if (os_err != 0) {
+       *p_err = USBD_ERR_OS_INIT_FAIL;
+        return;
+    }
+#endif
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_CoreTask()
+*
+* Description : OS-dependent shell task to process USB core events.
+*
+* Argument(s) : p_arg       Pointer to task initialization argument (required by pthreads).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  *USBD_OS_CoreTask (void  *p_arg)
+{
+    (void)p_arg;
+
+    while (DEF_ON) {
+        USBD_CoreTaskHandler();
+    }
+
+    return ((void *)0);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_TraceTask()
+*
+* Description : OS-dependent shell task to process debug events.
+*
+* Argument(s) : p_arg       Pointer to task initialization argument (required by pthreads).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+static  void  *USBD_OS_TraceTask (void  *p_arg)
+{
+    (void)p_arg;
+
+    while (DEF_ON) {
+        USBD_DbgTaskHandler();
+    }
+
+    return ((void *)0);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_SignalCreate()
+*
+* Description : Create an OS signal.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               OS signal     successfully created.
+*                               USBD_ERR_OS_SIGNAL_CREATE   OS signal NOT successfully created.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_EP_SignalCreate (CPU_INT08U   dev_nbr,
+                               CPU_INT08U   ep_ix,
+                               USBD_ERR    *p_err)
+{
+    USBD_OS_SemCreate(&USBD_OS_EP_SemTbl[dev_nbr][ep_ix], 0u);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_SignalDel()
+*
+* Description : Delete an OS signal.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_EP_SignalDel (CPU_INT08U  dev_nbr,
+                            CPU_INT08U  ep_ix)
+{
+    USBD_OS_SemDel(&USBD_OS_EP_SemTbl[dev_nbr][ep_ix]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_SignalPend()
+*
+* Description : Wait for a signal to become available.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               timeout_ms  Signal wait timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           OS signal     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     OS signal NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_ABORT       OS signal aborted.
+*                               USBD_ERR_OS_DEL         OS signal deleted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_EP_SignalPend (CPU_INT08U   dev_nbr,
+                             CPU_INT08U   ep_ix,
+                             CPU_INT16U   timeout_ms,
+                             USBD_ERR    *p_err)
+{
+    USBD_OS_SemPend(&USBD_OS_EP_SemTbl[dev_nbr][ep_ix],
+                     timeout_ms,
+                     p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_SignalAbort()
+*
+* Description : Abort any wait operation on signal.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal successfully aborted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_EP_SignalAbort (CPU_INT08U   dev_nbr,
+                              CPU_INT08U   ep_ix,
+                              USBD_ERR    *p_err)
+{
+    USBD_OS_SemAbort(&USBD_OS_EP_SemTbl[dev_nbr][ep_ix]);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_SignalPost()
+*
+* Description : Make a signal available.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE       OS signal successfully readied.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_EP_SignalPost (CPU_INT08U   dev_nbr,
+                             CPU_INT08U   ep_ix,
+                             USBD_ERR    *p_err)
+{
+    USBD_OS_SemPost(&USBD_OS_EP_SemTbl[dev_nbr][ep_ix]);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_EP_LockCreate()
+*
+* Description : Create an OS resource to use as an endpoint lock.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               OS lock     successfully created.
+*                               USBD_ERR_OS_SIGNAL_CREATE   OS lock NOT successfully created.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_OS_EP_LockCreate (CPU_INT08U   dev_nbr,
+                              CPU_INT08U   ep_ix,
+                              USBD_ERR    *p_err)
+{
+    USBD_OS_SemCreate(&USBD_OS_EP_LockTbl[dev_nbr][ep_ix], 1u);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_EP_LockDel()
+*
+* Description : Delete the OS resource used as an endpoint lock.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_OS_EP_LockDel (CPU_INT08U  dev_nbr,
+                           CPU_INT08U  ep_ix)
+{
+    USBD_OS_SemDel(&USBD_OS_EP_LockTbl[dev_nbr][ep_ix]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_EP_LockAcquire()
+*
+* Description : Wait for an endpoint to become available and acquire its lock.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+*               timeout_ms  Lock wait timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           OS lock     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     OS lock NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_ABORT       OS lock aborted.
+*                               USBD_ERR_OS_DEL         OS lock deleted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_OS_EP_LockAcquire (CPU_INT08U   dev_nbr,
+                               CPU_INT08U   ep_ix,
+                               CPU_INT16U   timeout_ms,
+                               USBD_ERR    *p_err)
+{
+    USBD_OS_SemPend(&USBD_OS_EP_LockTbl[dev_nbr][ep_ix],
+                     timeout_ms,
+                     p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_OS_EP_LockRelease()
+*
+* Description : Release an endpoint lock.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument validated by the caller(s).
+*
+*               ep_ix       Endpoint index.
+*               -----       Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void   USBD_OS_EP_LockRelease (CPU_INT08U  dev_nbr,
+                               CPU_INT08U  ep_ix)
+{
+    USBD_OS_SemPost(&USBD_OS_EP_LockTbl[dev_nbr][ep_ix]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_DlyMs()
+*
+* Description : Delay a task for a certain time.
+*
+* Argument(s) : ms          Delay in milliseconds.
+*
+* Return(s)   : None.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_DlyMs (CPU_INT32U  ms)
+{
+    struct  timespec  ts;
+
+
+    ts.tv_sec  = (time_t)(ms / 1000u);
+    ts.tv_nsec = (long  )(ms % 1000u) * USBD_OS_NS_PER_MS;
+
+    while (nanosleep(&ts, &ts) != 0) {                          /* Resume sleep if interrupted by a signal.             */
+        if (errno != EINTR) {
+            break;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_CoreEventGet()
+*
+* Description : Wait until a core event is ready.
+*
+* Argument(s) : timeout_ms  Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Core event successfully obtained.
+*                               USBD_ERR_OS_TIMEOUT     Core event NOT ready and a timeout occurred.
+*
+* Return(s)   : Pointer to core event, if NO error(s).
+*
+*               Pointer to NULL,       otherwise.
+*
+* Note(s)     : (1) A timeout of 0 waits forever, as with the uC/OS ports.
+*********************************************************************************************************
+*/
+
+void  *USBD_OS_CoreEventGet (CPU_INT32U   timeout_ms,
+                             USBD_ERR    *p_err)
+{
+    USBD_OS_Q        *p_q;
+    void             *p_msg;
+    struct  timespec  ts;
+    int               os_err;
+
+
+    p_q = &USBD_OS_EventQ;
+    if (timeout_ms != 0u) {
+        USBD_OS_TimeoutGet(timeout_ms, &ts);
+    }
+
+    os_err = 0;
+    (void)pthread_mutex_lock(&p_q->Mutex);
+    while ((p_q->NbrEntries == 0u) &&
+           (os_err          == 0 )) {
+        if (timeout_ms == 0u) {                                 /* See Note #1.                                         */
+            os_err = pthread_cond_wait(&p_q->Cond, &p_q->Mutex);
+        } else {
+            os_err = pthread_cond_timedwait(&p_q->Cond, &p_q->Mutex, &ts);
+        }
+    }
+
+    if (p_q->NbrEntries == 0u) {
+        (void)pthread_mutex_unlock(&p_q->Mutex);
+       *p_err = USBD_ERR_OS_TIMEOUT;
+        return ((void *)0);
+    }
+
+    p_msg = p_q->MsgTbl[p_q->OutIx];
+    p_q->OutIx++;
+    if (p_q->OutIx >= USBD_CORE_EVENT_NBR_TOTAL) {
+        p_q->OutIx = 0u;
+    }
+    p_q->NbrEntries--;
+    (void)pthread_mutex_unlock(&p_q->Mutex);
+
+   *p_err = USBD_ERR_NONE;
+
+    return (p_msg);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_CoreEventPut()
+*
+* Description : Queues core event.
+*
+* Argument(s) : p_event     Pointer to core event.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The queue holds as many entries as there are core events. A full queue drops the event,
+*                   as OSQPost() does.
+*********************************************************************************************************
+*/
+
+void  USBD_OS_CoreEventPut (void  *p_event)
+{
+    USBD_OS_Q  *p_q;
+
+
+    p_q = &USBD_OS_EventQ;
+
+    (void)pthread_mutex_lock(&p_q->Mutex);
+    if (p_q->NbrEntries < USBD_CORE_EVENT_NBR_TOTAL) {          /* See Note #1.                                         */
+        p_q->MsgTbl[p_q->InIx] = p_event;
+        p_q->InIx++;
+        if (p_q->InIx >= USBD_CORE_EVENT_NBR_TOTAL) {
+            p_q->InIx = 0u;
+        }
+        p_q->NbrEntries++;
+        (void)pthread_cond_signal(&p_q->Cond);
+    }
+    (void)pthread_mutex_unlock(&p_q->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_DbgEventRdy()
+*
+* Description : Signals that a trace event is ready for processing.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+void  USBD_OS_DbgEventRdy (void)
+{
+    USBD_OS_SemPost(&USBD_OS_TraceSem);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_OS_DbgEventWait()
+*
+* Description : Waits until a trace event is available.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+void  USBD_OS_DbgEventWait (void)
+{
+    USBD_ERR  err;
+
+
+    USBD_OS_SemPend(&USBD_OS_TraceSem, 0u, &err);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_CondInit()
+*
+* Description : Initialize a mutex and a condition variable waiting on the monotonic clock.
+*
+* Argument(s) : p_mutex     Pointer to mutex.
+*
+*               p_cond      Pointer to condition variable.
+*
+* Return(s)   : DEF_OK,   if NO error(s).
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  USBD_OS_CondInit (pthread_mutex_t  *p_mutex,
+                                       pthread_cond_t   *p_cond)
+{
+    pthread_condattr_t  attr;
+    int                 os_err;
+
+
+    os_err = pthread_mutex_init(p_mutex, DEF_NULL);
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    os_err = pthread_condattr_init(&attr);
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    os_err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (os_err == 0) {
+        os_err = pthread_cond_init(p_cond, &attr);
+    }
+    (void)pthread_condattr_destroy(&attr);
+
+    if (os_err != 0) {
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_SemCreate()
+*
+* Description : Create a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+*               cnt         Initial count.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #1'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_SemCreate (USBD_OS_SEM  *p_sem,
+                                 CPU_INT32U    cnt)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->Cnt   = cnt;                                         /* 'AbortCtr' is kept (see Note #1a).                   */
+    p_sem->Valid = DEF_YES;
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_OS_SemDel()
+*
+* Description : Delete a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #1'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_SemDel (USBD_OS_SEM  *p_sem)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->Valid = DEF_NO;
+    p_sem->AbortCtr++;                                          /* See Note #1a.                                        */
+    (void)pthread_cond_broadcast(&p_sem->Cond);
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_OS_SemPend()
+*
+* Description : Wait for a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+*               timeout_ms  Timeout in milliseconds; 0 waits forever.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Semaphore     successfully acquired.
+*                               USBD_ERR_OS_TIMEOUT     Semaphore NOT successfully acquired in the time
+*                                                           specified by 'timeout_ms'.
+*                               USBD_ERR_OS_ABORT       Semaphore aborted.
+*                               USBD_ERR_OS_DEL         Semaphore deleted.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #2'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_SemPend (USBD_OS_SEM  *p_sem,
+                               CPU_INT32U    timeout_ms,
+                               USBD_ERR     *p_err)
+{
+    struct  timespec  ts;
+    CPU_INT32U        abort_ctr;
+    int               os_err;
+
+
+    if (timeout_ms != 0u) {
+        USBD_OS_TimeoutGet(timeout_ms, &ts);
+    }
+
+    os_err = 0;
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    abort_ctr = p_sem->AbortCtr;                                /* See Note #1.                                         */
+    while ((p_sem->Cnt      == 0u)        &&
+           (p_sem->Valid    == DEF_YES)   &&
+           (p_sem->AbortCtr == abort_ctr) &&
+           (os_err          == 0)) {
+        if (timeout_ms == 0u) {
+            os_err = pthread_cond_wait(&p_sem->Cond, &p_sem->Mutex);
+        } else {
+            os_err = pthread_cond_timedwait(&p_sem->Cond, &p_sem->Mutex, &ts);
+        }
+    }
+
+    if (p_sem->Valid != DEF_YES) {
+       *p_err = USBD_ERR_OS_DEL;
+    } else if (p_sem->AbortCtr != abort_ctr) {
+       *p_err = USBD_ERR_OS_ABORT;
+    } else if (p_sem->Cnt > 0u) {
+        p_sem->Cnt--;
+       *p_err = USBD_ERR_NONE;
+    } else {
+       *p_err = USBD_ERR_OS_TIMEOUT;
+    }
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_OS_SemAbort()
+*
+* Description : Abort any wait operation on a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) See 'LOCAL DATA TYPES  Note #2'.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_SemAbort (USBD_OS_SEM  *p_sem)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->AbortCtr++;
+    (void)pthread_cond_broadcast(&p_sem->Cond);
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_OS_SemPost()
+*
+* Description : Signal a semaphore.
+*
+* Argument(s) : p_sem       Pointer to semaphore.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_SemPost (USBD_OS_SEM  *p_sem)
+{
+    (void)pthread_mutex_lock(&p_sem->Mutex);
+    p_sem->Cnt++;
+    (void)pthread_cond_signal(&p_sem->Cond);
+    (void)pthread_mutex_unlock(&p_sem->Mutex);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_OS_TimeoutGet()
+*
+* Description : Compute the absolute monotonic time at which a timeout expires.
+*
+* Argument(s) : timeout_ms  Timeout in milliseconds.
+*
+*               p_ts        Pointer to variable that will receive the expiry time.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_OS_TimeoutGet (CPU_INT32U        timeout_ms,
+                                  struct  timespec  *p_ts)
+{
+    (void)clock_gettime(CLOCK_MONOTONIC, p_ts);
+
+    p_ts->tv_sec  += (time_t)(timeout_ms / 1000u);
+    p_ts->tv_nsec += (long  )(timeout_ms % 1000u) * USBD_OS_NS_PER_MS;
+    if (p_ts->tv_nsec >= USBD_OS_NS_PER_SEC) {
+        p_ts->tv_sec  += 1;
+        p_ts->tv_nsec -= USBD_OS_NS_PER_SEC;
+    }
+}
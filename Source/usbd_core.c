@@ -38,6 +38,16 @@
 #include  <lib_math.h>
 #include  <cpu_core.h>
 
+#if ((USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED) || \
+     (USBD_CFG_DBG_TRACE_EN       == DEF_ENABLED))
+#if ((defined(__STDC_VERSION__))           && \
+     (__STDC_VERSION__ >= 201112L)         && \
+     (!defined(__STDC_NO_ATOMICS__)))
+#include  <stdatomic.h>
+#define  USBD_CORE_C11_ATOMICS
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -75,6 +85,23 @@
 *                   D6    Self-powered
 *                   D5    Remote Wakeup
 *                   D4..0 Reserved (reset to zero)
+*
+*           (3) The core event ring indexes and counters are each written by a single context. On a
+*               C11 compiler providing <stdatomic.h>, a sequentially consistent fence orders these
+*               accesses so that the producer and the consumer may run on different cores. Otherwise,
+*               the ISR producer and the core task consumer are assumed to run on the same core, where
+*               the volatile accesses alone are sufficient.
+*
+*           (4) A binary trace record is claimed by incrementing the trace sequence counter, with an
+*               atomic operation on a C11 compiler providing <stdatomic.h> or within a short critical
+*               section otherwise. The record is then filled outside of any critical section, from ISR
+*               or task context. Fences order the record contents before its sequence number, which the
+*               reader checks before and after copying the record.
+*
+*           (5) The configuration descriptors of a device are serialized in the descriptor cache by
+*               USBD_DevStart(). Each configuration image starts on a USBD_CFG_BUF_ALIGN_OCTETS boundary
+*               so that it can be given to USBD_CtrlTx() without being copied. The functions adding an
+*               object to the device invalidate the cache, which is then rebuilt on the next request.
 *********************************************************************************************************
 */
 
@@ -102,6 +129,38 @@
 #define  USBD_MS_OS_FEATURE_COMPAT_ID                 0x0004u
 #define  USBD_MS_OS_FEATURE_EXT_PROPERTIES            0x0005u
 
+                                                                /* ---------------- CORE EVENT POOL DEFINES ----------- */
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)               /* Deferred req events are not pooled.                  */
+#define  USBD_CORE_EVENT_POOL_LEN                (USBD_CORE_EVENT_NBR_TOTAL - USBD_CORE_EVENT_CTRL_NBR_TOTAL)
+#endif
+
+                                                                /* ---------------- CORE EVENT RING DEFINES ----------- */
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+                                                                /* One slot is kept empty to tell a full ring apart.    */
+#define  USBD_CORE_EVENT_RING_LEN                (USBD_CORE_EVENT_NBR_DEV + 1u)
+#define  USBD_CORE_EVENT_CMPL_END_NONE             DEF_INT_16U_MAX_VAL
+
+#ifdef   USBD_CORE_C11_ATOMICS                                  /* See Note #3.                                         */
+#define  USBD_CORE_EVENT_MB()                     atomic_thread_fence(memory_order_seq_cst)
+#else
+#define  USBD_CORE_EVENT_MB()
+#endif
+#endif
+
+                                                                /* ---------------- DEBUG TRACE DEFINES --------------- */
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+#define  USBD_DBG_TRACE_REC_IX_MASK              (USBD_CFG_DBG_TRACE_BIN_NBR_REC - 1u)
+
+#ifdef   USBD_CORE_C11_ATOMICS                                  /* See Note #4.                                         */
+#define  USBD_DBG_TRACE_ACQUIRE()                 atomic_thread_fence(memory_order_acquire)
+#define  USBD_DBG_TRACE_RELEASE()                 atomic_thread_fence(memory_order_release)
+#else
+#define  USBD_DBG_TRACE_ACQUIRE()
+#define  USBD_DBG_TRACE_RELEASE()
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -153,10 +212,35 @@ typedef  enum  usbd_event_code {
     USBD_EVENT_BUS_DISCONN,
     USBD_EVENT_BUS_HS,
     USBD_EVENT_EP,
-    USBD_EVENT_SETUP
+    USBD_EVENT_SETUP,
+    USBD_EVENT_CTRL_CMPL
 } USBD_EVENT_CODE;
 
 
+/*
+*********************************************************************************************************
+*                                  CONTROL TRANSFER STATE DATA TYPE
+*
+* Note(s) : (1) When asynchronous control transfers are enabled, the control transfer of the current
+*               setup request goes through the following states :
+*
+*               (a) USBD_CTRL_STATE_IDLE    No control transfer in progress.
+*               (b) USBD_CTRL_STATE_DATA    Data stage started, waiting for its completion.
+*               (c) USBD_CTRL_STATE_DEFER   Request deferred by a class, waiting for USBD_CtrlReqCmpl().
+*               (d) USBD_CTRL_STATE_STATUS  Status stage started, waiting for its completion.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+typedef  enum  usbd_ctrl_state {
+    USBD_CTRL_STATE_IDLE = 0u,
+    USBD_CTRL_STATE_DATA,
+    USBD_CTRL_STATE_DEFER,
+    USBD_CTRL_STATE_STATUS
+} USBD_CTRL_STATE;
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                   ENDPOINT INFORMATION DATA TYPE
@@ -170,6 +254,9 @@ typedef  struct usbd_ep_info {
             CPU_INT16U        MaxPktSize;
             CPU_INT08U        SyncAddr;                         /* Audio Class Only: associated sync endpoint.          */
             CPU_INT08U        SyncRefresh;                      /* Audio Class Only: sync feedback rate.                */
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+            CPU_INT08U        URB_NbrRsvd;                      /* Nbr of URBs reserved for async queueing.             */
+#endif
 #if (USBD_CFG_OPTIMIZE_SPD == DEF_DISABLED)
     struct  usbd_ep_info     *NextPtr;                          /* Pointer to next interface group structure.           */
 #endif
@@ -198,6 +285,10 @@ typedef  struct  usbd_if_grp  {
 /*
 *********************************************************************************************************
 *                                INTERFACE ALTERNATE SETTING DATA TYPE
+*
+* Note(s):  (1) An alternate setting inherits the protocol code of its interface. Some classes (e.g. Mass
+*               Storage, which reports the Bulk-Only and UAS protocols on distinct alternate settings of
+*               the same interface) override it with USBD_IF_AltProtocolSet().
 *********************************************************************************************************
 */
 
@@ -205,6 +296,7 @@ typedef  struct  usbd_if_alt {
             void          *ClassArgPtr;                         /* Dev class drv arg ptr specific to alternate setting. */
             CPU_INT32U     EP_AllocMap;                         /* EP allocation bitmap.                                */
             CPU_INT08U     EP_NbrTotal;                         /* Number of EP.                                        */
+            CPU_INT08U     ClassProtocolCode;                   /* Alt setting protocol code (see Note #1).             */
     const   CPU_CHAR      *NamePtr;
 #if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)
             USBD_EP_INFO  *EP_TblPtrs[USBD_EP_MAX_NBR];
@@ -326,6 +418,12 @@ typedef struct  usbd_cfg {                                      /* -------------
             CPU_INT08U    Attrib;                               /* Configuration attributes.                            */
             CPU_INT16U    MaxPwr;                               /* Maximum bus power drawn.                             */
             CPU_INT16U    DescLen;                              /* Configuration descriptor length.                     */
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+            CPU_INT08U   *DescCachePtr;                         /* Cached cfg desc (see 'LOCAL DEFINES Note #5').       */
+#endif
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    const   CPU_INT08U   *DescStaticPtr;                        /* Const cfg desc set by USBD_CfgDescStaticSet().       */
+#endif
     const   CPU_CHAR     *NamePtr;                              /* Configuration name.                                  */
 
 #if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)                      /* Interface & group list:                              */
@@ -344,6 +442,9 @@ typedef struct  usbd_cfg {                                      /* -------------
             CPU_INT08U    IF_NbrTotal;                          /* Number of interfaces in this configuration.          */
             CPU_INT08U    IF_GrpNbrTotal;                       /* Number of interfaces group.                          */
             CPU_INT32U    EP_AllocMap;                          /* EP allocation bitmap.                                */
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+            CPU_INT16U    URB_NbrRsvdTotal;                     /* Nbr of URBs reserved by all EPs of this cfg.         */
+#endif
 
 #if (USBD_CFG_HS_EN == DEF_ENABLED)
             CPU_INT08U    CfgOtherSpd;                          /* Other-speed configuration.                           */
@@ -425,10 +526,14 @@ typedef  struct  usbd_dev {                                     /* -------------
                                                                 /* ---- CONFIGURATION AND STRING DESCRIPTOR BUFFER ---- */
            CPU_INT08U      *ActualBufPtr;                       /* Pointer to the buffer where data will be written.    */
            CPU_INT08U      *DescBufPtr;                         /* Configuration & string descriptor buffer.            */
-           CPU_INT08U       DescBufIx;                          /* Configuration & string descriptor buffer index.      */
+           CPU_INT16U       DescBufIx;                          /* Configuration & string descriptor buffer index.      */
            CPU_INT16U       DescBufReqLen;                      /* Configuration & string descriptor requested length.  */
            CPU_INT16U       DescBufMaxLen;                      /* Configuration & string descriptor maximum length.    */
            USBD_ERR        *DescBufErrPtr;                      /* Configuration & string descriptor error pointer.     */
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+           CPU_INT08U      *DescCacheBufPtr;                    /* Configuration descriptor cache.                      */
+           CPU_BOOLEAN      DescCacheValid;                     /* Configuration descriptor cache valid flag.           */
+#endif
                                                                 /* --------------- ENDPOINT INFORMATION  -------------- */
            CPU_INT16U       EP_CtrlMaxPktSize;                  /* Ctrl EP maximum packet size.                         */
            CPU_INT08U       EP_IF_Tbl[USBD_EP_MAX_NBR];         /* EP to IF number reference table.                     */
@@ -451,6 +556,13 @@ typedef  struct  usbd_dev {                                     /* -------------
            CPU_BOOLEAN      RemoteWakeup;                       /* Remote Wakeup feature.                               */
 
            CPU_INT08U      *CtrlStatusBufPtr;                   /* Buf used for ctrl status xfers.                      */
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+           USBD_CTRL_STATE  CtrlState;                          /* Ctrl xfer state (see 'CONTROL TRANSFER STATE').      */
+           CPU_INT16U       CtrlReqSeq;                         /* Seq nbr of last deferred req.                        */
+           CPU_INT16U       CtrlCmplSeq;                        /* Seq nbr of posted deferred req cmpl.                 */
+           CPU_BOOLEAN      CtrlCmplValid;                      /* Status  of posted deferred req cmpl.                 */
+           CPU_BOOLEAN      CtrlCmplPend;                       /* Deferred req cmpl event queued to core task.         */
+#endif
 } USBD_DEV;
 
 
@@ -460,24 +572,59 @@ typedef  struct  usbd_dev {                                     /* -------------
 *
 * Note(s) : (1) USB device driver queues bus and transaction events to the core task queue using
 *               the 'USBD_CORE_EVENT' structure.
+*
+*           (2) An endpoint event without error stands for all the completions on this endpoint signaled
+*               while the event is the last one queued on the device's ring. Completions are counted per
+*               endpoint: the ISR increments 'EP_CmplPostCtr' and the core task increments 'EP_CmplAckCtr'
+*               each time it processes one. Once another event is queued, the endpoint event is closed by
+*               'CmplEnd': later completions are processed by a later event, preserving the order
+*               of completions relative to other events.
 *********************************************************************************************************
 */
 
 typedef  struct  usbd_core_event {
-    USBD_EVENT_CODE   Type;                                     /* Core event type.                                     */
-    USBD_DRV         *DrvPtr;                                   /* Pointer to driver structure.                         */
-    CPU_INT08U        EP_Addr;                                  /* Endpoint address.                                    */
-    USBD_ERR          Err;                                      /* Error Code returned by Driver, if any.               */
+              USBD_EVENT_CODE   Type;                           /* Core event type.                                     */
+              USBD_DRV         *DrvPtr;                         /* Pointer to driver structure.                         */
+              CPU_INT08U        EP_Addr;                        /* Endpoint address.                                    */
+              USBD_ERR          Err;                            /* Error Code returned by Driver, if any.               */
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+    volatile  CPU_INT16U        CmplEnd;                        /* Cmpl ctr value closing EP event (see Note #2).       */
+#endif
 } USBD_CORE_EVENT;
 
 
+/*
+*********************************************************************************************************
+*                                           USB CORE EVENT RING
+*
+* Note(s) : (1) The ring is filled by the device driver and emptied by the core task. 'InIx' and 'TailPtr'
+*               are only written by USBD_CoreEventPut(), within a critical section, 'OutIx' only by the
+*               core task, which takes no lock.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+typedef  struct  usbd_core_event_ring {
+              USBD_CORE_EVENT   EventTbl[USBD_CORE_EVENT_RING_LEN];
+    volatile  CPU_DATA          InIx;                           /* Ix of next slot to fill.                             */
+    volatile  CPU_DATA          OutIx;                          /* Ix of next slot to free.                             */
+              USBD_CORE_EVENT  *TailPtr;                        /* Ptr to last queued event.                            */
+                                                                /* Nbr of cmpl signaled per EP.                         */
+    volatile  CPU_INT08U        EP_CmplPostCtr[USBD_EP_MAX_NBR];
+                                                                /* Nbr of cmpl processed per EP.                        */
+    volatile  CPU_INT08U        EP_CmplAckCtr[USBD_EP_MAX_NBR];
+} USBD_CORE_EVENT_RING;
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                         USB DEBUG DATA TYPE
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 typedef struct  usbd_dbg_event {
     const   CPU_CHAR        *MsgPtr;
             CPU_INT08U       EP_Addr;
@@ -491,6 +638,14 @@ typedef struct  usbd_dbg_event {
 } USBD_DBG_EVENT;
 #endif
 
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+typedef struct  usbd_dbg_trace {                                /* See 'usbd_core.h  DEBUG TRACE DATA TYPES  Note #2'.  */
+    USBD_DBG_TRACE_HDR  Hdr;
+    USBD_DBG_TRACE_REC  RecTbl[USBD_CFG_DBG_TRACE_BIN_NBR_REC];
+} USBD_DBG_TRACE;
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -505,6 +660,13 @@ typedef struct  usbd_dbg_event {
 *********************************************************************************************************
 */
 
+                                                                /* Invalidate desc cache (see 'LOCAL DEFINES Note #5'). */
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+#define  USBD_DESC_CACHE_INV(p_dev)              ((p_dev)->DescCacheValid = DEF_NO)
+#else
+#define  USBD_DESC_CACHE_INV(p_dev)
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -559,12 +721,29 @@ static  CPU_INT08U          USBD_EP_InfoNbrNext;
 * Note(s) : (1) USB device driver signals the core task using a core event queue.
 *               The core event queue contains core event objects. These objects are
 *               allocated from the core event pool.
+*
+*           (2) When the core event ring is enabled, core event objects are allocated from the
+*               device's ring instead.
+*
+*           (3) The completion of a deferred control request is posted by a task, with the device's own
+*               core event. This event is never taken from the ring nor from the pool, and is never
+*               returned to them.
 *********************************************************************************************************
 */
 
-static  CPU_INT32U        USBD_CoreEventPoolIx;
-static  USBD_CORE_EVENT   USBD_CoreEventPoolData[USBD_CORE_EVENT_NBR_TOTAL];
-static  USBD_CORE_EVENT  *USBD_CoreEventPoolPtrs[USBD_CORE_EVENT_NBR_TOTAL];
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
+static  CPU_INT32U             USBD_CoreEventPoolIx;
+static  USBD_CORE_EVENT        USBD_CoreEventPoolData[USBD_CORE_EVENT_POOL_LEN];
+static  USBD_CORE_EVENT       *USBD_CoreEventPoolPtrs[USBD_CORE_EVENT_POOL_LEN];
+#else
+                                                                /* Core event rings (see Note #2).                      */
+static  USBD_CORE_EVENT_RING   USBD_CoreEventRingTbl[USBD_CFG_MAX_NBR_DEV];
+#endif
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+                                                                /* Deferred req cmpl events (see Note #3).              */
+static  USBD_CORE_EVENT        USBD_CtrlCmplEventTbl[USBD_CFG_MAX_NBR_DEV];
+#endif
 
 
 /*
@@ -573,7 +752,8 @@ static  USBD_CORE_EVENT  *USBD_CoreEventPoolPtrs[USBD_CORE_EVENT_NBR_TOTAL];
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
                                                                 /* Debug event pool.                                    */
 static  USBD_DBG_EVENT   USBD_DbgEventTbl[USBD_CFG_DBG_TRACE_NBR_EVENTS];
 
@@ -584,6 +764,16 @@ static  USBD_DBG_EVENT  *USBD_DbgEventTailPtr;                  /* Debug events
 static  CPU_INT32U       USBD_DbgEventCtr;                      /* Global debug event counter.                          */
 #endif
 
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+        USBD_DBG_TRACE   USBD_DbgTrace;                         /* Binary trace hdr and ring.                           */
+#ifdef   USBD_CORE_C11_ATOMICS
+static  _Atomic  CPU_INT32U  USBD_DbgTraceSeqNext;              /* Seq nbr of next trace rec (see Note #4).             */
+#else
+static  volatile  CPU_INT32U  USBD_DbgTraceSeqNext;
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -634,7 +824,7 @@ static  CPU_BOOLEAN        USBD_StdReqDev    (       USBD_DEV         *p_dev,
 static  CPU_BOOLEAN        USBD_StdReqIF     (       USBD_DEV         *p_dev,
                                                      CPU_INT08U        request);
 
-static  CPU_BOOLEAN        USBD_StdReqEP     (const  USBD_DEV         *p_dev,
+static  CPU_BOOLEAN        USBD_StdReqEP     (       USBD_DEV         *p_dev,
                                                      CPU_INT08U        request);
 
 static  CPU_BOOLEAN        USBD_StdReqClass  (const  USBD_DEV         *p_dev);
@@ -649,6 +839,35 @@ static  CPU_BOOLEAN        USBD_StdReqIF_MS  (const  USBD_DEV         *p_dev);
 
 static  CPU_BOOLEAN        USBD_StdReqDescGet(       USBD_DEV         *p_dev);
 
+static  void               USBD_CtrlDataTx   (       USBD_DEV         *p_dev,
+                                                     void             *p_buf,
+                                                     CPU_INT32U        buf_len,
+                                                     CPU_BOOLEAN       end,
+                                                     USBD_ERR         *p_err);
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+static  void               USBD_CtrlStatusStart(     USBD_DEV         *p_dev);
+
+static  CPU_BOOLEAN        USBD_CtrlReqCmplGet(      USBD_DEV         *p_dev,
+                                                     CPU_BOOLEAN      *p_valid);
+
+static  void               USBD_CtrlDataCmpl (       CPU_INT08U        dev_nbr,
+                                                     CPU_INT08U        ep_addr,
+                                                     void             *p_buf,
+                                                     CPU_INT32U        buf_len,
+                                                     CPU_INT32U        xfer_len,
+                                                     void             *p_arg,
+                                                     USBD_ERR          err);
+
+static  void               USBD_CtrlStatusCmpl(      CPU_INT08U        dev_nbr,
+                                                     CPU_INT08U        ep_addr,
+                                                     void             *p_buf,
+                                                     CPU_INT32U        buf_len,
+                                                     CPU_INT32U        xfer_len,
+                                                     void             *p_arg,
+                                                     USBD_ERR          err);
+#endif
+
 #if 0
 static  CPU_BOOLEAN        USBD_StdReqDescSet(       USBD_DEV         *p_dev);
 #endif
@@ -670,6 +889,27 @@ static  void               USBD_CfgDescSend  (       USBD_DEV         *p_dev,
                                                      CPU_INT16U        req_len,
                                                      USBD_ERR         *p_err);
 
+static  void               USBD_CfgDescWr    (       USBD_DEV         *p_dev,
+                                                     USBD_CFG         *p_cfg,
+                                                     CPU_INT08U        cfg_nbr,
+                                                     CPU_INT08U        cfg_nbr_cur,
+                                                     CPU_BOOLEAN       other,
+                                                     CPU_INT16U        req_len,
+                                                     USBD_ERR         *p_err);
+
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+static  void               USBD_CfgDescCacheBuild(   USBD_DEV         *p_dev);
+#endif
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+static  void               USBD_CfgDescStaticSend(   USBD_DEV         *p_dev,
+                                                     USBD_CFG         *p_cfg,
+                                                     CPU_INT08U        cfg_nbr,
+                                                     CPU_BOOLEAN       other,
+                                                     CPU_INT16U        req_len,
+                                                     USBD_ERR         *p_err);
+#endif
+
 static  void               USBD_StrDescSend  (       USBD_DEV         *p_dev,
                                                      CPU_INT08U        str_ix,
                                                      CPU_INT16U        req_len,
@@ -753,11 +993,39 @@ static  CPU_BOOLEAN        USBD_EP_Alloc     (       USBD_DEV         *p_dev,
                                                      USBD_EP_INFO     *p_ep,
                                                      CPU_INT32U       *p_alloc_bit_map);
 
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+static  CPU_BOOLEAN        USBD_EP_AllocStatic(      USBD_DEV         *p_dev,
+                                              const  CPU_INT08U       *p_desc,
+                                                     CPU_INT08U        if_nbr,
+                                                     CPU_INT08U        if_alt_nbr,
+                                                     CPU_INT08U        type,
+                                                     CPU_BOOLEAN       dir_in,
+                                                     USBD_EP_INFO     *p_ep,
+                                                     CPU_INT32U       *p_alloc_bit_map);
+#endif
+
 static  void               USBD_CoreEventFree(       USBD_CORE_EVENT   *p_core_event);
 
-static  USBD_CORE_EVENT   *USBD_CoreEventGet (void);
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
+static  USBD_CORE_EVENT   *USBD_CoreEventGet (       void);
+#endif
+
+static  void               USBD_CoreEventPut (       USBD_DRV          *p_drv,
+                                                     USBD_EVENT_CODE    type,
+                                                     CPU_INT08U         ep_addr,
+                                                     USBD_ERR           err);
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+static  USBD_CORE_EVENT   *USBD_CoreEventNext(       USBD_CORE_EVENT   *p_core_event);
+
+static  CPU_BOOLEAN        USBD_CoreEventCmplPost(   CPU_INT08U         dev_nbr,
+                                                     CPU_INT08U         ep_addr);
+
+static  CPU_BOOLEAN        USBD_CoreEventCmplAck(    USBD_CORE_EVENT   *p_core_event);
+#endif
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 static  USBD_DBG_EVENT    *USBD_DbgEventGet  (void);
 
 static  void               USBD_DbgEventFree (       USBD_DBG_EVENT    *p_event);
@@ -765,6 +1033,16 @@ static  void               USBD_DbgEventFree (       USBD_DBG_EVENT    *p_event)
 static  void               USBD_DbgEventPut  (       USBD_DBG_EVENT    *p_event);
 #endif
 
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+static  void               USBD_DbgTraceWr   (const  CPU_CHAR          *p_msg,
+                                                     CPU_INT08U         ep_addr,
+                                                     CPU_INT08U         if_nbr,
+                                                     CPU_INT32U         arg,
+                                                     CPU_INT08U         flags,
+                                                     USBD_ERR           err);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -815,8 +1093,20 @@ void  USBD_Init (USBD_ERR  *p_err)
     USBD_IF_GRP     *p_if_grp;
 #endif
     USBD_EP_INFO    *p_ep;
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
     USBD_DBG_EVENT  *p_event;
+#endif
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED) && \
+     (CPU_CFG_TS_TMR_EN         == DEF_ENABLED))
+    CPU_ERR          err_cpu;
+#endif
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+    USBD_CORE_EVENT_RING  *p_ring;
+#endif
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+    USBD_CORE_EVENT *p_core_event;
 #endif
     CPU_INT16U       tbl_ix;
     LIB_ERR          err_lib;
@@ -899,6 +1189,20 @@ void  USBD_Init (USBD_ERR  *p_err)
         p_dev->DescBufMaxLen =  USBD_CFG_DESC_BUF_LEN;
         p_dev->DescBufErrPtr = (USBD_ERR *)0u;
 
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+                                                                /* Alloc cfg desc cache from heap.                      */
+        p_dev->DescCacheBufPtr = (CPU_INT08U *)Mem_HeapAlloc(              USBD_CFG_DESC_CACHE_LEN,
+                                                                           USBD_CFG_BUF_ALIGN_OCTETS,
+                                                             (CPU_SIZE_T *)DEF_NULL,
+                                                                          &err_lib);
+        if (err_lib != LIB_MEM_ERR_NONE) {
+           *p_err = USBD_ERR_ALLOC;
+            return;
+        }
+
+        p_dev->DescCacheValid = DEF_NO;
+#endif
+
 #if (USBD_CFG_MAX_NBR_STR > 0u)
         Mem_Clr((void     *)&p_dev->StrDesc_Tbl[0u],
                 (CPU_SIZE_T)USBD_CFG_MAX_NBR_STR);
@@ -925,6 +1229,19 @@ void  USBD_Init (USBD_ERR  *p_err)
 
         p_dev->SelfPwr         =  DEF_NO;
         p_dev->RemoteWakeup    =  DEF_DISABLED;
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+        p_dev->CtrlState       =  USBD_CTRL_STATE_IDLE;
+        p_dev->CtrlReqSeq      =  0u;
+        p_dev->CtrlCmplSeq     =  0u;
+        p_dev->CtrlCmplValid   =  DEF_FAIL;
+        p_dev->CtrlCmplPend    =  DEF_NO;
+
+        p_core_event           = &USBD_CtrlCmplEventTbl[tbl_ix];
+        p_core_event->Type     =  USBD_EVENT_CTRL_CMPL;
+        p_core_event->DrvPtr   = &p_dev->Drv;
+        p_core_event->EP_Addr  =  0u;
+        p_core_event->Err      =  USBD_ERR_NONE;
+#endif
         p_dev->Drv.DevNbr      =  USBD_DEV_NBR_NONE;
         p_dev->Drv.API_Ptr     = (USBD_DRV_API     *)0;
         p_dev->Drv.CfgPtr      = (USBD_DRV_CFG     *)0;
@@ -941,6 +1258,12 @@ void  USBD_Init (USBD_ERR  *p_err)
         p_cfg->MaxPwr  = 0u;
         p_cfg->NamePtr = (CPU_CHAR *)0;
         p_cfg->DescLen = 0u;
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+        p_cfg->DescCachePtr = (CPU_INT08U *)0;
+#endif
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+        p_cfg->DescStaticPtr = (const CPU_INT08U *)0;
+#endif
 #if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)                      /* Init IF list:                                        */
                                                                 /*    array implementation.                             */
         Mem_Clr((void     *)&p_cfg->IF_TblPtrs[0u],
@@ -961,6 +1284,9 @@ void  USBD_Init (USBD_ERR  *p_err)
         p_cfg->IF_NbrTotal    = 0u;
         p_cfg->IF_GrpNbrTotal = 0u;
         p_cfg->EP_AllocMap    = DEF_BIT_NONE;
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+        p_cfg->URB_NbrRsvdTotal = 0u;
+#endif
 #if (USBD_CFG_HS_EN == DEF_ENABLED)
         p_cfg->CfgOtherSpd    = USBD_CFG_NBR_NONE;
 #endif
@@ -1037,13 +1363,29 @@ void  USBD_Init (USBD_ERR  *p_err)
 #endif
     }
 
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
                                                                 /* Init pool of core events.                            */
-    for (tbl_ix = 0u; tbl_ix < USBD_CORE_EVENT_NBR_TOTAL; tbl_ix++) {
+    for (tbl_ix = 0u; tbl_ix < USBD_CORE_EVENT_POOL_LEN; tbl_ix++) {
         USBD_CoreEventPoolPtrs[tbl_ix] = &USBD_CoreEventPoolData[tbl_ix];
     }
+    USBD_CoreEventPoolIx = USBD_CORE_EVENT_POOL_LEN;
+#else
+                                                                /* Init rings of core events.                           */
+    for (tbl_ix = 0u; tbl_ix < USBD_CFG_MAX_NBR_DEV; tbl_ix++) {
+        p_ring          = &USBD_CoreEventRingTbl[tbl_ix];
+        p_ring->InIx    =  0u;
+        p_ring->OutIx   =  0u;
+        p_ring->TailPtr = (USBD_CORE_EVENT *)0;
+        Mem_Clr((void     *)&p_ring->EP_CmplPostCtr[0u],
+                (CPU_SIZE_T) sizeof(p_ring->EP_CmplPostCtr));
+        Mem_Clr((void     *)&p_ring->EP_CmplAckCtr[0u],
+                (CPU_SIZE_T) sizeof(p_ring->EP_CmplAckCtr));
+    }
+#endif
 
                                                                 /* Init pool of debug events.                           */
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
     for (tbl_ix = 0u; tbl_ix < (USBD_CFG_DBG_TRACE_NBR_EVENTS - 1u); tbl_ix++) {
         p_event          = &USBD_DbgEventTbl[tbl_ix];
         p_event->NextPtr = &USBD_DbgEventTbl[tbl_ix + 1u];
@@ -1054,6 +1396,22 @@ void  USBD_Init (USBD_ERR  *p_err)
     USBD_DbgEventCtr     = 0u;
     USBD_DbgEventFreePtr = &USBD_DbgEventTbl[0u];
 #endif
+                                                                /* Init binary trace ring.                              */
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+    Mem_Clr((void     *)&USBD_DbgTrace,
+            (CPU_SIZE_T) sizeof(USBD_DbgTrace));
+
+    USBD_DbgTrace.Hdr.Magic   =  USBD_DBG_TRACE_MAGIC;
+    USBD_DbgTrace.Hdr.Ver     =  USBD_DBG_TRACE_VER;
+    USBD_DbgTrace.Hdr.RecSize = (CPU_INT08U)sizeof(USBD_DBG_TRACE_REC);
+    USBD_DbgTrace.Hdr.PtrSize = (CPU_INT08U)sizeof(void *);
+    USBD_DbgTrace.Hdr.RecNbr  =  USBD_CFG_DBG_TRACE_BIN_NBR_REC;
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    USBD_DbgTrace.Hdr.TsFreq  = (CPU_INT32U)CPU_TS_TmrFreqGet(&err_cpu);
+#endif
+    USBD_DbgTraceSeqNext      =  0u;
+#endif
 
     USBD_DevNbrNext       = 0u;
     USBD_CfgNbrNext       = 0u;
@@ -1063,9 +1421,8 @@ void  USBD_Init (USBD_ERR  *p_err)
     USBD_IF_GrpNbrNext    = 0u;
 #endif
     USBD_EP_InfoNbrNext   = 0u;
-    USBD_CoreEventPoolIx  = USBD_CORE_EVENT_NBR_TOTAL;
 
-    USBD_EP_Init();
+    USBD_EP_Init(p_err);
 }
 
 
@@ -1354,6 +1711,10 @@ void  USBD_DevStart (CPU_INT08U   dev_nbr,
     p_drv     = &p_dev->Drv;
     p_drv_api =  p_drv->API_Ptr;
 
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+    USBD_CfgDescCacheBuild(p_dev);                              /* Serialize cfg descs (see 'LOCAL DEFINES Note #5').   */
+#endif
+
     init = DEF_NO;
 
     if (p_dev->State == USBD_DEV_STATE_NONE) {                  /* If dev not initialized ...                           */
@@ -1634,6 +1995,15 @@ CPU_INT08U  USBD_CfgAdd (       CPU_INT08U     dev_nbr,
     p_cfg->EP_AllocMap = USBD_EP_CTRL_ALLOC;                    /* Init EP alloc bitmap.                                */
     p_cfg->MaxPwr      = max_pwr;
     p_cfg->DescLen     = 0u;                                    /* Init cfg desc len.                                   */
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+    p_cfg->URB_NbrRsvdTotal = 0u;
+#endif
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+    p_cfg->DescCachePtr = (CPU_INT08U *)0;
+#endif
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    p_cfg->DescStaticPtr = (const CPU_INT08U *)0;
+#endif
 
 #if (USBD_CFG_MAX_NBR_STR > 0u)
     USBD_StrDescAdd(p_dev, p_name, p_err);                      /* Add cfg string to dev.                               */
@@ -1644,6 +2014,8 @@ CPU_INT08U  USBD_CfgAdd (       CPU_INT08U     dev_nbr,
     (void)p_name;
 #endif
 
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
     return (cfg_nbr);
 }
@@ -1733,6 +2105,126 @@ void  USBD_CfgOtherSpeed (CPU_INT08U   dev_nbr,
     p_cfg->CfgOtherSpd       = cfg_other;
     p_cfg_other->CfgOtherSpd = cfg_nbr;
 
+    USBD_DESC_CACHE_INV(p_dev);
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_CfgDescStaticSet()
+*
+* Description : Associate a constant configuration descriptor with a configuration.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               cfg_nbr     Configuration number.
+*
+*               p_desc      Pointer to the constant configuration descriptor (see Note #1).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Configuration descriptor successfully associated.
+*                               USBD_ERR_NULL_PTR           Argument 'p_desc' passed a NULL pointer.
+*                               USBD_ERR_INVALID_ARG        Invalid configuration descriptor (see Note #2).
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE  Invalid device state (see Note #3).
+*                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration number.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The descriptor is declared with the USBD_DESC_STATIC_xxx() macros (see 'usbd_core.h
+*                   STATIC DESCRIPTOR MACROS'). It is sent from ROM in response to GET_DESCRIPTOR
+*                   requests, and the class drivers' descriptor functions are not called for this
+*                   configuration.
+*
+*               (2) The descriptor must start with a configuration descriptor, and the length of its
+*                   descriptors must add up to its 'wTotalLength' field.
+*
+*               (3) The descriptor can ONLY be associated before any interface is added to the
+*                   configuration, so that the endpoints take the addresses found in the descriptor, and
+*                   when the device is in the following states:
+*
+*                   USBD_DEV_STATE_NONE    Device controller has not been initialized.
+*                   USBD_DEV_STATE_INIT    Device controller already      initialized.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+void  USBD_CfgDescStaticSet (       CPU_INT08U   dev_nbr,
+                                    CPU_INT08U   cfg_nbr,
+                             const  CPU_INT08U  *p_desc,
+                                    USBD_ERR    *p_err)
+{
+    USBD_DEV    *p_dev;
+    USBD_CFG    *p_cfg;
+    CPU_INT32U   desc_ix;
+    CPU_INT16U   desc_len;
+
+
+                                                                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+#endif
+
+    if (p_desc == (const CPU_INT08U *)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+
+    p_dev = USBD_DevRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_dev == (USBD_DEV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    if ((p_dev->State != USBD_DEV_STATE_NONE) &&                /* Chk curr dev state.                                  */
+        (p_dev->State != USBD_DEV_STATE_INIT)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    p_cfg = USBD_CfgRefGet(p_dev, cfg_nbr);                     /* Get cfg struct.                                      */
+    if (p_cfg == (USBD_CFG *)0) {
+       *p_err = USBD_ERR_CFG_INVALID_NBR;
+        return;
+    }
+
+    if (p_cfg->IF_NbrTotal != 0u) {                             /* See Note #3.                                         */
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    if ((p_desc[0u] != USBD_DESC_LEN_CFG) ||                    /* Validate desc (see Note #2).                         */
+        (p_desc[1u] != USBD_DESC_TYPE_CONFIGURATION)) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    desc_len = MEM_VAL_GET_INT16U_LITTLE(&p_desc[2u]);
+    desc_ix  = 0u;
+    while (desc_ix < desc_len) {
+        if (p_desc[desc_ix] < USBD_DESC_LEN_HDR) {
+           *p_err = USBD_ERR_INVALID_ARG;
+            return;
+        }
+        desc_ix += p_desc[desc_ix];
+    }
+
+    if (desc_ix != desc_len) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_cfg->DescStaticPtr = p_desc;
+    p_cfg->DescLen       = desc_len;
+
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
 }
 #endif
@@ -2221,9 +2713,10 @@ CPU_INT08U  USBD_IF_Add (       CPU_INT08U        dev_nbr,
     p_if->AltCurPtr         = p_if_alt;                         /* Set curr alt setting.                                */
     p_if->AltCur            = 0u;
     p_if->AltNbrTotal       = 1u;
-    p_if_alt->NamePtr       = p_name;
-    p_if_alt->EP_AllocMap   = p_if->EP_AllocMap;
-    p_if_alt->ClassArgPtr   = p_if_alt_class_arg;
+    p_if_alt->NamePtr           = p_name;
+    p_if_alt->EP_AllocMap       = p_if->EP_AllocMap;
+    p_if_alt->ClassArgPtr       = p_if_alt_class_arg;
+    p_if_alt->ClassProtocolCode = class_protocol_code;
 
 #if (USBD_CFG_MAX_NBR_STR > 0u)
     USBD_StrDescAdd(p_dev, p_name, p_err);                      /* Add IF string to dev.                                */
@@ -2234,6 +2727,8 @@ CPU_INT08U  USBD_IF_Add (       CPU_INT08U        dev_nbr,
     (void)p_name;
 #endif
 
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
     return (if_nbr);
 }
@@ -2345,9 +2840,10 @@ CPU_INT08U  USBD_IF_AltAdd (       CPU_INT08U   dev_nbr,
 #endif
 
 
-    p_if_alt->ClassArgPtr = p_class_arg;
-    p_if_alt->EP_AllocMap = USBD_EP_CTRL_ALLOC;
-    p_if_alt->NamePtr     = p_name;
+    p_if_alt->ClassArgPtr       = p_class_arg;
+    p_if_alt->EP_AllocMap       = USBD_EP_CTRL_ALLOC;
+    p_if_alt->NamePtr           = p_name;
+    p_if_alt->ClassProtocolCode = p_if->ClassProtocolCode;      /* Inherit IF protocol code.                            */
 
     DEF_BIT_CLR(p_if_alt->EP_AllocMap, p_if->EP_AllocMap);
     DEF_BIT_SET(p_if_alt->EP_AllocMap, USBD_EP_CTRL_ALLOC);
@@ -2361,6 +2857,8 @@ CPU_INT08U  USBD_IF_AltAdd (       CPU_INT08U   dev_nbr,
     (void)p_name;
 #endif
 
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
     return (if_alt_nbr);
 }
@@ -2368,63 +2866,145 @@ CPU_INT08U  USBD_IF_AltAdd (       CPU_INT08U   dev_nbr,
 
 /*
 *********************************************************************************************************
-*                                            USBD_IF_Grp()
-*
-* Description : Create a interface group.
-*
-* Argument(s) : dev_nbr             Device number
-*
-*               cfg_nbr             Configuration number.
+*                                       USBD_IF_AltProtocolSet()
 *
-*               class_code          Class code assigned by the USB-IF.
+* Description : Set the protocol code reported by a specific interface alternate setting.
 *
-*               class_sub_code      Subclass code assigned by the USB-IF.
+* Argument(s) : dev_nbr                 Device number.
 *
-*               class_protocol_code Protocol code assigned by the USB-IF.
+*               cfg_nbr                 Configuration number.
 *
-*               if_start            Interface number of the first interface that is associated with this group.
+*               if_nbr                  Interface number.
 *
-*               if_cnt              Number of consecutive interfaces that are associated with this group.
+*               if_alt_nbr              Interface alternate setting number.
 *
-*               p_name              Pointer to string describing interface group.
+*               class_protocol_code     Protocol code reported in the alternate setting's interface descriptor.
 *
 *               p_err       Pointer to variable that will receive the return error code from this function :
 *
-*                               USBD_ERR_NONE               Interface group successfully added.
-*                               USBD_ERR_DEV_INVALID_NBR    Invalid device        number.
-*                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration number.
-*                               USBD_ERR_IF_INVALID_NBR     Invalid interface     number.
-*                               USBD_ERR_IF_GRP_NBR_IN_USE  Interface is part of another group.
-*                               USBD_ERR_IF_GRP_ALLOC       Interface groups NOT available.
-*
-* Return(s)   : Interface group number, if NO error(s).
+*                               USBD_ERR_NONE                   Protocol code successfully set.
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device        number.
+*                               USBD_ERR_CFG_INVALID_NBR        Invalid configuration number.
+*                               USBD_ERR_IF_INVALID_NBR         Invalid interface     number.
+*                               USBD_ERR_IF_ALT_INVALID_NBR     Invalid interface alternate setting number.
 *
-*               USBD_IF_GRP_NBR_NONE,   otherwise.
+* Return(s)   : None.
 *
-* Note(s)     : None.
+* Note(s)     : (1) By default, an alternate setting reports the protocol code given to USBD_IF_Add() (see
+*                   'INTERFACE ALTERNATE SETTING DATA TYPE  Note #1').
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_MAX_NBR_IF_GRP > 0)
-CPU_INT08U  USBD_IF_Grp (       CPU_INT08U   dev_nbr,
-                                CPU_INT08U   cfg_nbr,
-                                CPU_INT08U   class_code,
-                                CPU_INT08U   class_sub_code,
-                                CPU_INT08U   class_protocol_code,
-                                CPU_INT08U   if_start,
-                                CPU_INT08U   if_cnt,
-                         const  CPU_CHAR    *p_name,
-                                USBD_ERR    *p_err)
+void  USBD_IF_AltProtocolSet (CPU_INT08U   dev_nbr,
+                              CPU_INT08U   cfg_nbr,
+                              CPU_INT08U   if_nbr,
+                              CPU_INT08U   if_alt_nbr,
+                              CPU_INT08U   class_protocol_code,
+                              USBD_ERR    *p_err)
 {
     USBD_DEV     *p_dev;
     USBD_CFG     *p_cfg;
     USBD_IF      *p_if;
-    USBD_IF_GRP  *p_if_grp;
-    CPU_INT08U    if_grp_tbl_ix;
-    CPU_INT08U    if_grp_nbr;
-    CPU_INT08U    if_nbr;
-    CPU_INT08U    if_end;
-    CPU_SR_ALLOC();
+    USBD_IF_ALT  *p_if_alt;
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+#endif
+                                                                /* --------------- GET OBJECT REFERENCES -------------- */
+    p_dev = USBD_DevRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_dev == (USBD_DEV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    p_cfg = USBD_CfgRefGet(p_dev, cfg_nbr);                     /* Get cfg struct.                                      */
+    if (p_cfg == (USBD_CFG *)0) {
+       *p_err = USBD_ERR_CFG_INVALID_NBR;
+        return;
+    }
+
+    p_if = USBD_IF_RefGet(p_cfg, if_nbr);                       /* Get IF struct.                                       */
+    if (p_if == (USBD_IF *)0) {
+       *p_err = USBD_ERR_IF_INVALID_NBR;
+        return;
+    }
+
+    p_if_alt = USBD_IF_AltRefGet(p_if, if_alt_nbr);             /* Get IF alt setting struct.                           */
+    if (p_if_alt == (USBD_IF_ALT *)0) {
+       *p_err = USBD_ERR_IF_ALT_INVALID_NBR;
+        return;
+    }
+
+    p_if_alt->ClassProtocolCode = class_protocol_code;
+
+    USBD_DESC_CACHE_INV(p_dev);
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_IF_Grp()
+*
+* Description : Create a interface group.
+*
+* Argument(s) : dev_nbr             Device number
+*
+*               cfg_nbr             Configuration number.
+*
+*               class_code          Class code assigned by the USB-IF.
+*
+*               class_sub_code      Subclass code assigned by the USB-IF.
+*
+*               class_protocol_code Protocol code assigned by the USB-IF.
+*
+*               if_start            Interface number of the first interface that is associated with this group.
+*
+*               if_cnt              Number of consecutive interfaces that are associated with this group.
+*
+*               p_name              Pointer to string describing interface group.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Interface group successfully added.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device        number.
+*                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration number.
+*                               USBD_ERR_IF_INVALID_NBR     Invalid interface     number.
+*                               USBD_ERR_IF_GRP_NBR_IN_USE  Interface is part of another group.
+*                               USBD_ERR_IF_GRP_ALLOC       Interface groups NOT available.
+*
+* Return(s)   : Interface group number, if NO error(s).
+*
+*               USBD_IF_GRP_NBR_NONE,   otherwise.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_MAX_NBR_IF_GRP > 0)
+CPU_INT08U  USBD_IF_Grp (       CPU_INT08U   dev_nbr,
+                                CPU_INT08U   cfg_nbr,
+                                CPU_INT08U   class_code,
+                                CPU_INT08U   class_sub_code,
+                                CPU_INT08U   class_protocol_code,
+                                CPU_INT08U   if_start,
+                                CPU_INT08U   if_cnt,
+                         const  CPU_CHAR    *p_name,
+                                USBD_ERR    *p_err)
+{
+    USBD_DEV     *p_dev;
+    USBD_CFG     *p_cfg;
+    USBD_IF      *p_if;
+    USBD_IF_GRP  *p_if_grp;
+    CPU_INT08U    if_grp_tbl_ix;
+    CPU_INT08U    if_grp_nbr;
+    CPU_INT08U    if_nbr;
+    CPU_INT08U    if_end;
+    CPU_SR_ALLOC();
 
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
@@ -2531,6 +3111,8 @@ CPU_INT08U  USBD_IF_Grp (       CPU_INT08U   dev_nbr,
     (void)p_name;
 #endif
 
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
     return (if_grp_nbr);
 }
@@ -2672,7 +3254,7 @@ CPU_INT16U  USBD_DescCfgGet (USBD_DRV    *p_drv,
                              USBD_ERR    *p_err)
 {
     USBD_DEV    *p_dev;
-    CPU_INT08U   desc_len;
+    CPU_INT16U   desc_len;
 
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
@@ -2870,6 +3452,8 @@ void  USBD_StrAdd (       CPU_INT08U   dev_nbr,
 #else
     (void)p_str;
 #endif
+
+    USBD_DESC_CACHE_INV(p_dev);
 }
 
 
@@ -3111,6 +3695,170 @@ void  USBD_DescWr (       CPU_INT08U   dev_nbr,
     }
 }
 
+/*
+*********************************************************************************************************
+*                                         USBD_CtrlReqDefer()
+*
+* Description : Defer the completion of the current control request.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                   Request successfully deferred.
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE      A data stage was already started by the core.
+*
+* Return(s)   : Sequence number of the deferred request, if NO error(s).
+*
+*               0,                                        otherwise.
+*
+* Note(s)     : (1) This function MUST be called from the class request callback processing the request,
+*                   which must then return DEF_OK. The core task no longer waits for the request to be
+*                   processed, and does not start the status stage. The class MAY perform the data stage
+*                   with USBD_CtrlTxAsync()/USBD_CtrlRxAsync() and MUST then call USBD_CtrlReqCmpl() with
+*                   the returned sequence number.
+*
+*               (2) A deferred request is abandoned if a new setup request or a bus reset is received
+*                   before USBD_CtrlReqCmpl() is called. Each deferred request gets a new sequence number,
+*                   never 0, so that the completion of an abandoned request cannot complete a later one.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+CPU_INT16U  USBD_CtrlReqDefer (CPU_INT08U   dev_nbr,
+                               USBD_ERR    *p_err)
+{
+    USBD_DEV    *p_dev;
+    CPU_INT16U   req_seq;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(0u);
+    }
+#endif
+
+    p_dev = USBD_DevRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_dev == (USBD_DEV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return (0u);
+    }
+
+    if (p_dev->CtrlState != USBD_CTRL_STATE_IDLE) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return (0u);
+    }
+
+    req_seq = p_dev->CtrlReqSeq + 1u;                           /* See Note #2.                                         */
+    if (req_seq == 0u) {
+        req_seq = 1u;
+    }
+
+    CPU_CRITICAL_ENTER();
+    p_dev->CtrlReqSeq = req_seq;
+    CPU_CRITICAL_EXIT();
+
+    p_dev->CtrlState = USBD_CTRL_STATE_DEFER;
+
+   *p_err = USBD_ERR_NONE;
+
+    return (req_seq);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlReqCmpl()
+*
+* Description : Complete a control request deferred with USBD_CtrlReqDefer().
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               req_seq     Sequence number returned by USBD_CtrlReqDefer().
+*
+*               valid       Request status :
+*
+*                               DEF_OK      Request successfully processed, the status stage is started.
+*                               DEF_FAIL    Request failed,                 the control endpoint is stalled.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE                   Completion successfully posted.
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE      Request already completed.
+*                               USBD_ERR_INVALID_ARG            Request superseded by a later deferred request.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) This function MAY be called from any task. The completion is posted to the core task,
+*                   which starts the status stage or stalls the control endpoint.
+*
+*               (2) The completion is posted with the device's own core event, directly to the core task
+*                   queue (see 'CORE EVENTS POOL  Note #3'). The event is only queued if it is not queued
+*                   already. Otherwise, the core task finds the new sequence number and status when it
+*                   processes the queued event.
+*
+*               (3) The completion of a request is dropped if its sequence number is not the one of the
+*                   last deferred request. The completion of the last deferred request is also dropped by
+*                   the core task if that request was abandoned (see USBD_CtrlReqDefer() Note #2).
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void  USBD_CtrlReqCmpl (CPU_INT08U    dev_nbr,
+                        CPU_INT16U    req_seq,
+                        CPU_BOOLEAN   valid,
+                        USBD_ERR     *p_err)
+{
+    USBD_DEV     *p_dev;
+    CPU_BOOLEAN   post;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+#endif
+
+    p_dev = USBD_DevRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_dev == (USBD_DEV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();
+    if (req_seq != p_dev->CtrlReqSeq) {                         /* See Note #3.                                         */
+        CPU_CRITICAL_EXIT();
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    if ((p_dev->CtrlCmplPend == DEF_YES) &&
+        (p_dev->CtrlCmplSeq  == req_seq)) {
+        CPU_CRITICAL_EXIT();
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    post                 = (p_dev->CtrlCmplPend == DEF_NO) ? DEF_YES : DEF_NO;
+    p_dev->CtrlCmplSeq   =  req_seq;
+    p_dev->CtrlCmplValid =  valid;
+    p_dev->CtrlCmplPend  =  DEF_YES;
+    CPU_CRITICAL_EXIT();
+
+    if (post == DEF_YES) {                                      /* See Note #2.                                         */
+        USBD_OS_CoreEventPut(&USBD_CtrlCmplEventTbl[dev_nbr]);
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
 
 /*
 *********************************************************************************************************
@@ -3711,6 +4459,7 @@ void  USBD_IsocSyncRefreshSet (CPU_INT08U   dev_nbr,
 
     CPU_CRITICAL_ENTER();
     p_ep->SyncRefresh = sync_refresh;
+    USBD_DESC_CACHE_INV(p_dev);
     CPU_CRITICAL_EXIT();
 }
 #endif
@@ -3924,6 +4673,7 @@ void  USBD_IsocSyncAddrSet (CPU_INT08U   dev_nbr,
 
     CPU_CRITICAL_ENTER();
     p_ep_isoc->SyncAddr = sync_addr;
+    USBD_DESC_CACHE_INV(p_dev);
     CPU_CRITICAL_EXIT();
 }
 #endif
@@ -3931,58 +4681,220 @@ void  USBD_IsocSyncAddrSet (CPU_INT08U   dev_nbr,
 
 /*
 *********************************************************************************************************
-*                                            USBD_EP_Add()
-*
-* Description : Add an endpoint to alternate setting interface.
+*                                        USBD_EP_URB_RsvdSet()
 *
-* Argument(s) : dev_nbr             Device number.
+* Description : Reserve USB request blocks (URB) for asynchronous transfers queued on an endpoint.
 *
-*               cfg_nbr             Configuration number.
+* Argument(s) : dev_nbr         Device number.
 *
-*               if_nbr              Interface number.
+*               cfg_nbr         Configuration number.
 *
-*               if_alt_nbr          Interface alternate setting number.
+*               if_nbr          Interface number.
 *
-*               type                Endpoint's attributes.
+*               if_alt_nbr      Interface alternate setting number.
 *
-*               dir_in              Endpoint Direction.
+*               ep_addr         Endpoint address.
 *
-*               max_pkt_len         Endpoint maximum packet size.
-*               -----------         Argument validated by the caller.
+*               urb_nbr         Number of URBs to reserve, in addition to the endpoint's main URB.
 *
-*               interval            Interval for polling data transfers.
-*               --------            Argument validated by the caller.
+*               p_err       Pointer to variable that will receive the return error code from this function :
 *
-*               class_desc          Callback to append a class-specific descriptor in the configuration
-*                                   descriptor.
+*                               USBD_ERR_NONE                   URBs successfully reserved.
+*                               USBD_ERR_DEV_INVALID_NBR        Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE      Invalid device state (see Note #1).
+*                               USBD_ERR_CFG_INVALID_NBR        Invalid configuration number.
+*                               USBD_ERR_IF_INVALID_NBR         Invalid interface number.
+*                               USBD_ERR_IF_ALT_INVALID_NBR     Invalid interface alternate setting number.
+*                               USBD_ERR_EP_INVALID_ADDR        Invalid endpoint address.
+*                               USBD_ERR_INVALID_ARG            Invalid argument(s) passed to 'urb_nbr'
+*                                                                   (see Note #3).
 *
-*               class_desc_size     Size of the class class-specific descriptor.
+* Return(s)   : none.
 *
-*               p_err       Pointer to variable that will receive the return error code from this function :
+* Note(s)     : (1) URBs can ONLY be reserved when the device is in the following states:
 *
-*                               USBD_ERR_NONE               Endpoint successfully added.
-*                               USBD_ERR_DEV_INVALID_NBR    Invalid device              number.
-*                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration       number.
-*                               USBD_ERR_IF_INVALID_NBR     Invalid           interface number.
-*                               USBD_ERR_IF_ALT_INVALID_NBR Invalid alternate interface number.
-*                               USBD_ERR_EP_NONE_AVAIL      Physical endpoint NOT available.
-*                               USBD_ERR_EP_ALLOC           Endpoints NOT available.
+*                   USBD_DEV_STATE_NONE    Device controller has not been initialized.
+*                   USBD_DEV_STATE_INIT    Device controller already      initialized.
 *
-* Return(s)   : Endpoint number,  if NO error(s).
+*                   This function is meant to be called right after the endpoint has been added with
+*                   USBD_BulkAdd(), USBD_IntrAdd() or USBD_IsocAdd().
 *
-*               USBD_EP_NBR_NONE, otherwise.
+*               (2) When a transfer is queued on an endpoint that already has a transfer in progress,
+*                   a reserved URB is used first. Once all the reserved URBs of the endpoint are in
+*                   use, an URB is taken from the shared pool of USBD_CFG_MAX_NBR_URB_EXTRA URBs, if
+*                   any is available.
 *
-* Note(s)     : none.
+*               (3) The sum of the URBs reserved by all the endpoints of a configuration, including
+*                   the ones of every alternate setting, MUST NOT exceed USBD_CFG_MAX_NBR_URB_RSVD.
+*                   Since only one configuration is active at a time, the reserved URBs are then
+*                   always available once the configuration is set.
 *********************************************************************************************************
 */
 
-static  CPU_INT08U  USBD_EP_Add (CPU_INT08U    dev_nbr,
-                                 CPU_INT08U    cfg_nbr,
-                                 CPU_INT08U    if_nbr,
-                                 CPU_INT08U    if_alt_nbr,
-                                 CPU_INT08U    attrib,
-                                 CPU_BOOLEAN   dir_in,
-                                 CPU_INT16U    max_pkt_len,
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+void  USBD_EP_URB_RsvdSet (CPU_INT08U   dev_nbr,
+                           CPU_INT08U   cfg_nbr,
+                           CPU_INT08U   if_nbr,
+                           CPU_INT08U   if_alt_nbr,
+                           CPU_INT08U   ep_addr,
+                           CPU_INT08U   urb_nbr,
+                           USBD_ERR    *p_err)
+{
+    USBD_DEV      *p_dev;
+    USBD_CFG      *p_cfg;
+    USBD_IF       *p_if;
+    USBD_IF_ALT   *p_if_alt;
+    USBD_EP_INFO  *p_ep;
+#if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)
+    CPU_INT32U     ep_alloc_map;
+#endif
+    CPU_INT08U     ep_nbr;
+    CPU_INT16U     urb_nbr_rsvd_total;
+    CPU_BOOLEAN    found;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+#endif
+                                                                /* --------------- GET OBJECT REFERENCES -------------- */
+    p_dev = USBD_DevRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_dev == (USBD_DEV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    if ((p_dev->State != USBD_DEV_STATE_NONE) &&                /* Chk curr dev state (see Note #1).                    */
+        (p_dev->State != USBD_DEV_STATE_INIT)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    p_cfg = USBD_CfgRefGet(p_dev, cfg_nbr);                     /* Get cfg struct.                                      */
+    if (p_cfg == (USBD_CFG *)0) {
+       *p_err = USBD_ERR_CFG_INVALID_NBR;
+        return;
+    }
+
+    p_if = USBD_IF_RefGet(p_cfg, if_nbr);                       /* Get IF struct.                                       */
+    if (p_if == (USBD_IF *)0) {
+       *p_err = USBD_ERR_IF_INVALID_NBR;
+        return;
+    }
+
+    p_if_alt = USBD_IF_AltRefGet(p_if, if_alt_nbr);             /* Get IF alt setting struct.                           */
+    if (p_if_alt == (USBD_IF_ALT *)0) {
+       *p_err = USBD_ERR_IF_ALT_INVALID_NBR;
+        return;
+    }
+
+    found =  DEF_NO;
+    p_ep  = (USBD_EP_INFO *)0;
+
+#if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)
+    ep_alloc_map = p_if_alt->EP_TblMap;
+    while ((ep_alloc_map != DEF_BIT_NONE) &&
+           (found        != DEF_YES)) {
+        ep_nbr = (CPU_INT08U)CPU_CntTrailZeros32(ep_alloc_map);
+        p_ep   =  p_if_alt->EP_TblPtrs[ep_nbr];
+
+        if (p_ep->Addr == ep_addr) {
+            found = DEF_YES;
+        }
+
+        DEF_BIT_CLR(ep_alloc_map, DEF_BIT32(ep_nbr));
+    }
+#else
+    p_ep = p_if_alt->EP_HeadPtr;
+
+    for (ep_nbr = 0u; ep_nbr < p_if_alt->EP_NbrTotal; ep_nbr++) {
+        if (p_ep->Addr == ep_addr) {
+            found = DEF_YES;
+            break;
+        }
+
+        p_ep = p_ep->NextPtr;
+    }
+#endif
+
+    if (found != DEF_YES) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    CPU_CRITICAL_ENTER();                                       /* Chk total nbr of rsvd URBs (see Note #3).            */
+    urb_nbr_rsvd_total = p_cfg->URB_NbrRsvdTotal - p_ep->URB_NbrRsvd + urb_nbr;
+    if (urb_nbr_rsvd_total > USBD_CFG_MAX_NBR_URB_RSVD) {
+        CPU_CRITICAL_EXIT();
+       *p_err = USBD_ERR_INVALID_ARG;
+        return;
+    }
+
+    p_cfg->URB_NbrRsvdTotal = urb_nbr_rsvd_total;
+    p_ep->URB_NbrRsvd       = urb_nbr;
+    CPU_CRITICAL_EXIT();
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_EP_Add()
+*
+* Description : Add an endpoint to alternate setting interface.
+*
+* Argument(s) : dev_nbr             Device number.
+*
+*               cfg_nbr             Configuration number.
+*
+*               if_nbr              Interface number.
+*
+*               if_alt_nbr          Interface alternate setting number.
+*
+*               type                Endpoint's attributes.
+*
+*               dir_in              Endpoint Direction.
+*
+*               max_pkt_len         Endpoint maximum packet size.
+*               -----------         Argument validated by the caller.
+*
+*               interval            Interval for polling data transfers.
+*               --------            Argument validated by the caller.
+*
+*               class_desc          Callback to append a class-specific descriptor in the configuration
+*                                   descriptor.
+*
+*               class_desc_size     Size of the class class-specific descriptor.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Endpoint successfully added.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device              number.
+*                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration       number.
+*                               USBD_ERR_IF_INVALID_NBR     Invalid           interface number.
+*                               USBD_ERR_IF_ALT_INVALID_NBR Invalid alternate interface number.
+*                               USBD_ERR_EP_NONE_AVAIL      Physical endpoint NOT available.
+*                               USBD_ERR_EP_ALLOC           Endpoints NOT available.
+*
+* Return(s)   : Endpoint number,  if NO error(s).
+*
+*               USBD_EP_NBR_NONE, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  USBD_EP_Add (CPU_INT08U    dev_nbr,
+                                 CPU_INT08U    cfg_nbr,
+                                 CPU_INT08U    if_nbr,
+                                 CPU_INT08U    if_alt_nbr,
+                                 CPU_INT08U    attrib,
+                                 CPU_BOOLEAN   dir_in,
+                                 CPU_INT16U    max_pkt_len,
                                  CPU_INT08U    interval,
                                  USBD_ERR     *p_err)
 
@@ -4058,6 +4970,9 @@ static  CPU_INT08U  USBD_EP_Add (CPU_INT08U    dev_nbr,
     p_ep->Attrib      =  attrib;
     p_ep->SyncAddr    =  0u;                                    /* Dflt sync addr is zero.                              */
     p_ep->SyncRefresh =  0u;                                    /* Dflt feedback rate exponent is zero.                 */
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+    p_ep->URB_NbrRsvd =  0u;                                    /* Dflt EP only uses main & extra URBs.                 */
+#endif
 
     CPU_CRITICAL_ENTER();
     ep_alloc_map  = p_cfg->EP_AllocMap;                         /* Get cfg EP alloc bit map.                            */
@@ -4066,14 +4981,29 @@ static  CPU_INT08U  USBD_EP_Add (CPU_INT08U    dev_nbr,
 
     ep_alloc_map_clr = ep_alloc_map;
 
-    alloc = USBD_EP_Alloc(p_dev,                                /* Alloc physical EP.                                   */
-                          dev_spd,
-                          ep_type,
-                          dir_in,
-                          max_pkt_len & 0x7FF,                  /* Mask out transactions per microframe.                */
-                          if_alt_nbr,
-                          p_ep,
-                         &ep_alloc_map);
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    if (p_cfg->DescStaticPtr != (const CPU_INT08U *)0) {        /* Take EP addr from const cfg desc.                    */
+        alloc = USBD_EP_AllocStatic(p_dev,
+                                    p_cfg->DescStaticPtr,
+                                    if_nbr,
+                                    if_alt_nbr,
+                                    ep_type,
+                                    dir_in,
+                                    p_ep,
+                                   &ep_alloc_map);
+    } else {
+#endif
+        alloc = USBD_EP_Alloc(p_dev,                            /* Alloc physical EP.                                   */
+                              dev_spd,
+                              ep_type,
+                              dir_in,
+                              max_pkt_len & 0x7FF,              /* Mask out transactions per microframe.                */
+                              if_alt_nbr,
+                              p_ep,
+                             &ep_alloc_map);
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    }
+#endif
     if (alloc != DEF_OK) {
         USBD_EP_InfoNbrNext--;
         CPU_CRITICAL_EXIT();
@@ -4112,6 +5042,8 @@ static  CPU_INT08U  USBD_EP_Add (CPU_INT08U    dev_nbr,
 #endif
     CPU_CRITICAL_EXIT();
 
+    USBD_DESC_CACHE_INV(p_dev);
+
    *p_err = USBD_ERR_NONE;
 
     return (p_ep->Addr);
@@ -4345,6 +5277,137 @@ static  CPU_BOOLEAN  USBD_EP_Alloc (USBD_DEV      *p_dev,
 }
 
 
+/*
+*********************************************************************************************************
+*                                        USBD_EP_AllocStatic()
+*
+* Description : Allocate the physical endpoint given by a constant configuration descriptor.
+*
+* Argument(s) : p_dev               Pointer to USB device.
+*               -----               Argument validated in 'USBD_EP_Add()'.
+*
+*               p_desc              Pointer to constant configuration descriptor.
+*               ------              Argument validated in 'USBD_CfgDescStaticSet()'.
+*
+*               if_nbr              Interface number.
+*
+*               if_alt_nbr          Alternate interface number containing the endpoint.
+*
+*               type                Endpoint type.
+*
+*               dir_in              Endpoint direction.
+*                                       DEF_YES  IN  endpoint.
+*                                       DEF_NO   OUT endpoint.
+*
+*               p_ep                Pointer to variable that will receive the endpoint parameters.
+*               ----                Argument validated in 'USBD_EP_Add()'.
+*
+*               p_alloc_bit_map     Pointer to allocation table bit-map.
+*               ---------------     Argument validated in 'USBD_EP_Add()'.
+*
+* Return(s)   : DEF_OK,   if endpoint successfully allocated.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) The endpoint takes the address and maximum packet size of the first endpoint descriptor
+*                   of the alternate setting with the same type and direction, for which a free entry with
+*                   this endpoint number and these capabilities is found in the driver's endpoint
+*                   information table (see 'usbd_core.h  STATIC DESCRIPTOR MACROS  Note #4').
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_EP_AllocStatic (       USBD_DEV      *p_dev,
+                                          const  CPU_INT08U    *p_desc,
+                                                 CPU_INT08U     if_nbr,
+                                                 CPU_INT08U     if_alt_nbr,
+                                                 CPU_INT08U     type,
+                                                 CPU_BOOLEAN    dir_in,
+                                                 USBD_EP_INFO  *p_ep,
+                                                 CPU_INT32U    *p_alloc_bit_map)
+{
+    const  CPU_INT08U        *p_ep_desc;
+           USBD_DRV_EP_INFO  *p_ep_tbl;
+           CPU_INT16U         desc_ix;
+           CPU_INT16U         desc_len;
+           CPU_INT16U         ep_max_pkt;
+           CPU_INT08U         ep_log_nbr;
+           CPU_INT08U         ep_tbl_ix;
+           CPU_INT08U         ep_attrib_srch;
+           CPU_BOOLEAN        if_found;
+
+
+    if (dir_in == DEF_YES) {
+        ep_attrib_srch = USBD_EP_INFO_DIR_IN;
+    } else {
+        ep_attrib_srch = USBD_EP_INFO_DIR_OUT;
+    }
+
+    switch (type) {
+        case USBD_EP_TYPE_CTRL:
+             DEF_BIT_SET(ep_attrib_srch, USBD_EP_INFO_TYPE_CTRL);
+             break;
+
+        case USBD_EP_TYPE_ISOC:
+             DEF_BIT_SET(ep_attrib_srch, USBD_EP_INFO_TYPE_ISOC);
+             break;
+
+        case USBD_EP_TYPE_BULK:
+             DEF_BIT_SET(ep_attrib_srch, USBD_EP_INFO_TYPE_BULK);
+             break;
+
+        case USBD_EP_TYPE_INTR:
+        default:
+             DEF_BIT_SET(ep_attrib_srch, USBD_EP_INFO_TYPE_INTR);
+             break;
+    }
+
+    p_ep_tbl = p_dev->Drv.CfgPtr->EP_InfoTbl;
+    desc_len = MEM_VAL_GET_INT16U_LITTLE(&p_desc[2u]);
+    desc_ix  = 0u;
+    if_found = DEF_NO;
+
+    while (desc_ix < desc_len) {                                /* Find EP desc (see Note #1).                          */
+        p_ep_desc = &p_desc[desc_ix];
+        desc_ix  +=  p_ep_desc[0u];
+
+        if (p_ep_desc[1u] == USBD_DESC_TYPE_INTERFACE) {
+            if_found = ((p_ep_desc[2u] == if_nbr    ) &&
+                        (p_ep_desc[3u] == if_alt_nbr)) ? DEF_YES : DEF_NO;
+            continue;
+        }
+
+        if ((if_found                              != DEF_YES                ) ||
+            (p_ep_desc[1u]                         != USBD_DESC_TYPE_ENDPOINT) ||
+           ((p_ep_desc[3u] & USBD_EP_TYPE_MASK)    != type                   ) ||
+            (USBD_EP_IS_IN(p_ep_desc[2u])          != dir_in                 )) {
+            continue;
+        }
+
+        ep_log_nbr = USBD_EP_ADDR_TO_LOG(p_ep_desc[2u]);
+        ep_max_pkt = MEM_VAL_GET_INT16U_LITTLE(&p_ep_desc[4u]);
+        ep_tbl_ix  = 0u;
+                                                                /* Find matching free entry in drv EP tbl.              */
+        while (p_ep_tbl[ep_tbl_ix].Attrib != DEF_BIT_NONE) {
+            if ((DEF_BIT_IS_CLR(*p_alloc_bit_map, DEF_BIT32(ep_tbl_ix))     == DEF_YES   ) &&
+                (DEF_BIT_IS_SET(p_ep_tbl[ep_tbl_ix].Attrib, ep_attrib_srch) == DEF_YES   ) &&
+                (p_ep_tbl[ep_tbl_ix].Nbr                                    == ep_log_nbr) &&
+                (p_ep_tbl[ep_tbl_ix].MaxPktSize                             >= (ep_max_pkt & 0x7FF))) {
+                DEF_BIT_SET(*p_alloc_bit_map, DEF_BIT32(ep_tbl_ix));
+                p_ep->Addr       = p_ep_desc[2u];
+                p_ep->MaxPktSize = ep_max_pkt;
+                return (DEF_OK);
+            }
+
+            ep_tbl_ix++;
+        }
+    }
+
+    return (DEF_FAIL);
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                       USBD_EP_MaxPhyNbrGet()
@@ -4462,9 +5525,8 @@ void  USBD_EventResume (USBD_DRV  *p_drv)
 void  USBD_EventSetup (USBD_DRV  *p_drv,
                        void      *p_buf)
 {
-    USBD_DEV         *p_dev;
-    USBD_CORE_EVENT  *p_core_event;
-    CPU_INT08U       *p_buf_08;
+    USBD_DEV    *p_dev;
+    CPU_INT08U  *p_buf_08;
 
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
@@ -4478,11 +5540,6 @@ void  USBD_EventSetup (USBD_DRV  *p_drv,
         return;
     }
 
-    p_core_event = USBD_CoreEventGet();                         /* Get core event struct.                                */
-    if (p_core_event == (USBD_CORE_EVENT *)0) {
-        return;
-    }
-
     USBD_DBG_CORE_STD("Setup Pkt");
 
     p_buf_08                          = (CPU_INT08U *)p_buf;
@@ -4492,11 +5549,7 @@ void  USBD_EventSetup (USBD_DRV  *p_drv,
     p_dev->SetupReqNext.wIndex        =  MEM_VAL_GET_INT16U_LITTLE(p_buf_08 + 4u);
     p_dev->SetupReqNext.wLength       =  MEM_VAL_GET_INT16U_LITTLE(p_buf_08 + 6u);
 
-    p_core_event->Type                =  USBD_EVENT_SETUP;
-    p_core_event->DrvPtr              =  p_drv;
-    p_core_event->Err                 =  USBD_ERR_NONE;
-
-    USBD_OS_CoreEventPut(p_core_event);
+    USBD_CoreEventPut(p_drv, USBD_EVENT_SETUP, 0u, USBD_ERR_NONE);
 }
 
 
@@ -4523,7 +5576,8 @@ void  USBD_EventSetup (USBD_DRV  *p_drv,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the core event ring is enabled, a completion without error may be coalesced with
+*                   the last queued event (see USBD_CoreEventPut() Note #2).
 *********************************************************************************************************
 */
 
@@ -4531,26 +5585,13 @@ void  USBD_EventEP (USBD_DRV    *p_drv,
                     CPU_INT08U   ep_addr,
                     USBD_ERR     err)
 {
-    USBD_CORE_EVENT  *p_core_event;
-
-
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
     if (p_drv == (USBD_DRV *)0) {
         return;
     }
 #endif
 
-    p_core_event = USBD_CoreEventGet();                         /* Get core event struct.                               */
-    if (p_core_event == (USBD_CORE_EVENT *)0) {
-        return;
-    }
-
-    p_core_event->Type    = USBD_EVENT_EP;
-    p_core_event->DrvPtr  = p_drv;
-    p_core_event->EP_Addr = ep_addr;
-    p_core_event->Err     = err;
-
-    USBD_OS_CoreEventPut(p_core_event);                         /* Queue core event.                                    */
+    USBD_CoreEventPut(p_drv, USBD_EVENT_EP, ep_addr, err);      /* Queue core event (see Note #1).                      */
 }
 
 
@@ -4607,7 +5648,13 @@ USBD_DRV  *USBD_DrvRefGet (CPU_INT08U  dev_nbr)
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When asynchronous control transfers are enabled, a new setup request supersedes the
+*                   control transfer in progress, if any. The transfers queued on the control endpoints
+*                   are aborted.
+*
+*               (2) When asynchronous control transfers are enabled, the status stage is started here only
+*                   if no data stage was started and the request was not deferred by a class. Otherwise,
+*                   it is started by USBD_CtrlDataCmpl() or on USBD_CtrlReqCmpl().
 *********************************************************************************************************
 */
 
@@ -4617,7 +5664,9 @@ static  void  USBD_StdReqHandler (USBD_DEV  *p_dev)
     CPU_INT08U   type;
     CPU_INT08U   request;
     CPU_BOOLEAN  valid;
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_DISABLED)
     CPU_BOOLEAN  dev_to_host;
+#endif
     USBD_ERR     err;
     CPU_SR_ALLOC();
 
@@ -4630,11 +5679,19 @@ static  void  USBD_StdReqHandler (USBD_DEV  *p_dev)
     p_dev->SetupReq.wLength       = p_dev->SetupReqNext.wLength;
     CPU_CRITICAL_EXIT();
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+    if (p_dev->CtrlState != USBD_CTRL_STATE_IDLE) {             /* See Note #1.                                         */
+        p_dev->CtrlState  = USBD_CTRL_STATE_IDLE;
+        USBD_CtrlAbort(p_dev->Nbr, &err);
+    }
+#endif
 
     recipient   = p_dev->SetupReq.bmRequestType & USBD_REQ_RECIPIENT_MASK;
     type        = p_dev->SetupReq.bmRequestType & USBD_REQ_TYPE_MASK;
     request     = p_dev->SetupReq.bRequest;
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_DISABLED)
     dev_to_host = DEF_BIT_IS_SET(p_dev->SetupReq.bmRequestType, USBD_REQ_DIR_BIT);
+#endif
     valid       = DEF_FAIL;
 
     switch (type) {
@@ -4718,10 +5775,18 @@ static  void  USBD_StdReqHandler (USBD_DEV  *p_dev)
 
     if (valid == DEF_FAIL) {
         USBD_DBG_CORE_STD("Request Error");
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+        p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+#endif
         USBD_CtrlStall(p_dev->Nbr, &err);
 
     } else {
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+        if (p_dev->CtrlState == USBD_CTRL_STATE_IDLE) {         /* See Note #2.                                         */
+            USBD_CtrlStatusStart(p_dev);
+        }
+#else
         if (dev_to_host == DEF_YES)  {
             USBD_DBG_CORE_STD("Rx Status");
             USBD_CtrlRxStatus(p_dev->Nbr, USBD_CFG_CTRL_REQ_TIMEOUT_mS, &err);
@@ -4736,6 +5801,7 @@ static  void  USBD_StdReqHandler (USBD_DEV  *p_dev)
                 p_dev->Drv.API_Ptr->AddrEn(&p_dev->Drv, p_dev->Addr);
             }
         }
+#endif
     }
 }
 
@@ -5089,12 +6155,11 @@ static  CPU_BOOLEAN  USBD_StdReqDev (USBD_DEV    *p_dev,
 
                       p_dev->CtrlStatusBufPtr[0u] = cfg_nbr;    /* Uses Ctrl status buf to follow USB mem alignment.    */
 
-                      (void)USBD_CtrlTx(         p_dev->Nbr,
-                                        (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                                 1u,
-                                                 USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                 DEF_NO,
-                                                &err);
+                      USBD_CtrlDataTx(         p_dev,
+                                      (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                               1u,
+                                               DEF_NO,
+                                              &err);
                       if (err != USBD_ERR_NONE) {
                           break;
                       }
@@ -5113,12 +6178,11 @@ static  CPU_BOOLEAN  USBD_StdReqDev (USBD_DEV    *p_dev,
 
                       p_dev->CtrlStatusBufPtr[0u] = cfg_nbr;    /* Uses Ctrl status buf to follow USB mem alignment.    */
 
-                      (void)USBD_CtrlTx(         p_dev->Nbr,
-                                        (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                                 1u,
-                                                 USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                 DEF_NO,
-                                                &err);
+                      USBD_CtrlDataTx(         p_dev,
+                                      (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                               1u,
+                                               DEF_NO,
+                                              &err);
                       if (err != USBD_ERR_NONE) {
                           break;
                       }
@@ -5163,12 +6227,11 @@ static  CPU_BOOLEAN  USBD_StdReqDev (USBD_DEV    *p_dev,
                           p_dev->CtrlStatusBufPtr[0u] |= DEF_BIT_01;
                       }
 
-                      (void)USBD_CtrlTx(         p_dev->Nbr,
-                                        (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                                 2u,
-                                                 USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                 DEF_NO,
-                                                &err);
+                      USBD_CtrlDataTx(         p_dev,
+                                      (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                               2u,
+                                               DEF_NO,
+                                              &err);
                       if (err != USBD_ERR_NONE) {
                           break;
                       }
@@ -5187,12 +6250,11 @@ static  CPU_BOOLEAN  USBD_StdReqDev (USBD_DEV    *p_dev,
                           }
                       }
 
-                      (void)USBD_CtrlTx(         p_dev->Nbr,
-                                        (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                                 2u,
-                                                 USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                 DEF_NO,
-                                                &err);
+                      USBD_CtrlDataTx(         p_dev,
+                                      (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                               2u,
+                                               DEF_NO,
+                                              &err);
                       if (err != USBD_ERR_NONE) {
                           break;
                       }
@@ -5364,12 +6426,11 @@ static  CPU_BOOLEAN  USBD_StdReqIF (USBD_DEV    *p_dev,
 
              p_dev->CtrlStatusBufPtr[0u] = DEF_BIT_NONE;
 
-             (void)USBD_CtrlTx(         p_dev->Nbr,
-                               (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                        1u,
-                                        USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                        DEF_NO,
-                                       &err);
+             USBD_CtrlDataTx(         p_dev,
+                             (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                      1u,
+                                      DEF_NO,
+                                     &err);
              if (err != USBD_ERR_NONE) {
                  break;
              }
@@ -5450,12 +6511,11 @@ static  CPU_BOOLEAN  USBD_StdReqIF (USBD_DEV    *p_dev,
 
              USBD_DBG_CORE_STD_ARG("                Alt", p_if->AltCur);
 
-             (void)USBD_CtrlTx(         p_dev->Nbr,
-                               (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                        1u,
-                                        USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                        DEF_NO,
-                                       &err);
+             USBD_CtrlDataTx(         p_dev,
+                             (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                      1u,
+                                      DEF_NO,
+                                     &err);
              if (err != USBD_ERR_NONE) {
                  break;
              }
@@ -5553,8 +6613,8 @@ static  CPU_BOOLEAN  USBD_StdReqIF (USBD_DEV    *p_dev,
 *********************************************************************************************************
 */
 
-static  CPU_BOOLEAN  USBD_StdReqEP (const  USBD_DEV    *p_dev,
-                                           CPU_INT08U   request)
+static  CPU_BOOLEAN  USBD_StdReqEP (USBD_DEV    *p_dev,
+                                    CPU_INT08U   request)
 {
     USBD_IF      *p_if;
     USBD_IF_ALT  *p_alt_if;
@@ -5689,12 +6749,11 @@ static  CPU_BOOLEAN  USBD_StdReqEP (const  USBD_DEV    *p_dev,
                               p_dev->CtrlStatusBufPtr[1u] = DEF_BIT_NONE;
                           }
 
-                          (void)USBD_CtrlTx(         p_dev->Nbr,
-                                            (void *)&p_dev->CtrlStatusBufPtr[0u],
-                                                     2u,
-                                                     USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                     DEF_NO,
-                                                    &err);
+                          USBD_CtrlDataTx(         p_dev,
+                                          (void *)&p_dev->CtrlStatusBufPtr[0u],
+                                                   2u,
+                                                   DEF_NO,
+                                                  &err);
                           if (err != USBD_ERR_NONE) {
                               break;
                           }
@@ -5712,12 +6771,11 @@ static  CPU_BOOLEAN  USBD_StdReqEP (const  USBD_DEV    *p_dev,
                           p_dev->CtrlStatusBufPtr[1u] = DEF_BIT_NONE;
                       }
 
-                      (void)USBD_CtrlTx(         p_dev->Nbr,
-                                        (void *)&p_dev->CtrlStatusBufPtr[0],
-                                                 2u,
-                                                 USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                                 DEF_NO,
-                                                &err);
+                      USBD_CtrlDataTx(         p_dev,
+                                      (void *)&p_dev->CtrlStatusBufPtr[0],
+                                               2u,
+                                               DEF_NO,
+                                              &err);
                       if (err != USBD_ERR_NONE) {
                           break;
                       }
@@ -6276,34 +7334,335 @@ static  CPU_BOOLEAN  USBD_StdReqDescGet (USBD_DEV  *p_dev)
               break;
     }
 
-    p_dev->DescBufErrPtr = (USBD_ERR *)0;
-    return (valid);
+    p_dev->DescBufErrPtr = (USBD_ERR *)0;
+    return (valid);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_StdReqDescSet()
+*
+* Description : SET_DESCRIPTOR standard request handler.
+*
+* Argument(s) : p_dev       Pointer to USB device.
+*               -----       Argument validated in 'USBD_DevSetupPkt()' before posting the event to queue.
+*
+* Return(s)   : DEF_OK,   if NO error(s) occurred and request is supported.
+*
+*               DEF_FAIL, otherwise.
+*
+* Note(s)     : (1) $$$$ SET_DESCRIPTOR MAY be implemented in future versions.
+*********************************************************************************************************
+*/
+
+#if 0
+static  CPU_BOOLEAN  USBD_StdReqDescSet (USBD_DEV  *p_dev)
+{
+    (void)p_dev;
+
+    return (DEF_FAIL);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlDataTx()
+*
+* Description : Send the last (or only) transfer of the data stage of a standard request.
+*
+* Argument(s) : p_dev       Pointer to USB device.
+*               -----       Argument validated by the caller(s).
+*
+*               p_buf       Pointer to buffer of data that will be sent (see Note #2).
+*
+*               buf_len     Number of octets to transmit.
+*
+*               end         End-of-transfer flag.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Data stage successfully started/completed.
+*
+*                               - RETURNED BY USBD_CtrlTxAsync() -
+*                               See USBD_CtrlTxAsync() for additional return error codes.
+*
+*                               - RETURNED BY USBD_CtrlTx() -
+*                               See USBD_CtrlTx() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) When asynchronous control transfers are enabled, the transfer is only started. The
+*                   status stage is started by USBD_CtrlDataCmpl() once the data stage completes, and
+*                   USBD_StdReqHandler() returns without waiting for it.
+*
+*               (2) The buffer must remain valid until the data stage completes. The control status
+*                   buffer, the descriptor buffer, the descriptor cache and the constant descriptors
+*                   all satisfy this.
+*********************************************************************************************************
+*/
+
+static  void  USBD_CtrlDataTx (USBD_DEV     *p_dev,
+                               void         *p_buf,
+                               CPU_INT32U    buf_len,
+                               CPU_BOOLEAN   end,
+                               USBD_ERR     *p_err)
+{
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+    p_dev->CtrlState = USBD_CTRL_STATE_DATA;                    /* See Note #1.                                         */
+
+    USBD_CtrlTxAsync(p_dev->Nbr,
+                     p_buf,
+                     buf_len,
+                     USBD_CtrlDataCmpl,
+           (void *)  p_dev,
+                     end,
+                     p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+    }
+#else
+    (void)USBD_CtrlTx(p_dev->Nbr,
+                      p_buf,
+                      buf_len,
+                      USBD_CFG_CTRL_REQ_TIMEOUT_mS,
+                      end,
+                      p_err);
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_CtrlStatusStart()
+*
+* Description : Start the status stage of the current control transfer.
+*
+* Argument(s) : p_dev       Pointer to USB device.
+*               -----       Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The status stage goes in the direction opposite to the data stage : a zero-length
+*                   packet is received for a control read, and sent for a control write or a no-data
+*                   control transfer.
+*
+*               (2) If the status stage cannot be started, the transfer is abandoned. The host will
+*                   time out and issue a new setup request.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+static  void  USBD_CtrlStatusStart (USBD_DEV  *p_dev)
+{
+    CPU_BOOLEAN  dev_to_host;
+    USBD_ERR     err;
+
+
+    dev_to_host      = DEF_BIT_IS_SET(p_dev->SetupReq.bmRequestType, USBD_REQ_DIR_BIT);
+    p_dev->CtrlState = USBD_CTRL_STATE_STATUS;
+
+    if (dev_to_host == DEF_YES) {                               /* See Note #1.                                         */
+        USBD_DBG_CORE_STD("Rx Status");
+        USBD_CtrlRxAsync(         p_dev->Nbr,
+                         (void *) 0,
+                                  0u,
+                                  USBD_CtrlStatusCmpl,
+                         (void *) p_dev,
+                                 &err);
+    } else {
+        USBD_DBG_CORE_STD("Tx Status");
+        USBD_CtrlTxAsync(         p_dev->Nbr,
+                         (void *) 0,
+                                  0u,
+                                  USBD_CtrlStatusCmpl,
+                         (void *) p_dev,
+                                  DEF_NO,
+                                 &err);
+    }
+
+    if (err != USBD_ERR_NONE) {                                 /* See Note #2.                                         */
+        USBD_DBG_CORE_STD_ERR("Status Stage", err);
+        p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_CtrlReqCmplGet()
+*
+* Description : Get the completion of a deferred request posted by USBD_CtrlReqCmpl().
+*
+* Argument(s) : p_dev       Pointer to device.
+*
+*               p_valid     Pointer to variable that will receive the request status.
+*
+* Return(s)   : DEF_YES, if the completion applies to the request currently deferred.
+*
+*               DEF_NO,  otherwise.
+*
+* Note(s)     : (1) The posted completion is consumed, so that USBD_CtrlReqCmpl() queues the device's core
+*                   event again for the next completion.
+*
+*               (2) The completion does not apply if a later request was deferred after it was posted, or
+*                   if the deferred request was abandoned on a new setup request or a bus reset.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_CtrlReqCmplGet (USBD_DEV     *p_dev,
+                                          CPU_BOOLEAN  *p_valid)
+{
+    CPU_INT16U  req_seq;
+    CPU_SR_ALLOC();
+
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    req_seq             =  p_dev->CtrlCmplSeq;
+   *p_valid             =  p_dev->CtrlCmplValid;
+    p_dev->CtrlCmplPend =  DEF_NO;
+    CPU_CRITICAL_EXIT();
+                                                                /* See Note #2.                                         */
+    if ((req_seq          != p_dev->CtrlReqSeq) ||
+        (p_dev->CtrlState != USBD_CTRL_STATE_DEFER)) {
+        return (DEF_NO);
+    }
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_CtrlDataCmpl()
+*
+* Description : Data stage completion callback of the standard requests.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_buf       Pointer to transmit buffer.
+*
+*               buf_len     Transmit buffer length.
+*
+*               xfer_len    Number of octets transmitted.
+*
+*               p_arg       Pointer to USB device.
+*
+*               err         Transfer status.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The completion of a data stage that was superseded by a new setup request is ignored.
+*
+*               (2) A data stage aborted by a bus reset, a disconnection or a new setup request is not
+*                   stalled.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+static  void  USBD_CtrlDataCmpl (CPU_INT08U   dev_nbr,
+                                 CPU_INT08U   ep_addr,
+                                 void        *p_buf,
+                                 CPU_INT32U   buf_len,
+                                 CPU_INT32U   xfer_len,
+                                 void        *p_arg,
+                                 USBD_ERR     err)
+{
+    USBD_DEV  *p_dev;
+    USBD_ERR   stall_err;
+
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)p_buf;
+    (void)buf_len;
+    (void)xfer_len;
+
+    p_dev = (USBD_DEV *)p_arg;
+    if (p_dev->CtrlState != USBD_CTRL_STATE_DATA) {             /* See Note #1.                                         */
+        return;
+    }
+
+    if (err == USBD_ERR_NONE) {
+        USBD_CtrlStatusStart(p_dev);
+        return;
+    }
+
+    USBD_DBG_CORE_STD_ERR("Data Stage", err);
+    p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+    if (err != USBD_ERR_EP_ABORT) {                             /* See Note #2.                                         */
+        USBD_CtrlStall(p_dev->Nbr, &stall_err);
+    }
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                        USBD_StdReqDescSet()
+*                                       USBD_CtrlStatusCmpl()
 *
-* Description : SET_DESCRIPTOR standard request handler.
+* Description : Status stage completion callback of the control transfers.
 *
-* Argument(s) : p_dev       Pointer to USB device.
-*               -----       Argument validated in 'USBD_DevSetupPkt()' before posting the event to queue.
+* Argument(s) : dev_nbr     Device number.
 *
-* Return(s)   : DEF_OK,   if NO error(s) occurred and request is supported.
+*               ep_addr     Endpoint address.
 *
-*               DEF_FAIL, otherwise.
+*               p_buf       Pointer to buffer.
 *
-* Note(s)     : (1) $$$$ SET_DESCRIPTOR MAY be implemented in future versions.
+*               buf_len     Buffer length.
+*
+*               xfer_len    Number of octets transferred.
+*
+*               p_arg       Pointer to USB device.
+*
+*               err         Transfer status.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The new device address is enabled once the status stage of the Set Address standard
+*                   request is completed.
 *********************************************************************************************************
 */
 
-#if 0
-static  CPU_BOOLEAN  USBD_StdReqDescSet (USBD_DEV  *p_dev)
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+static  void  USBD_CtrlStatusCmpl (CPU_INT08U   dev_nbr,
+                                   CPU_INT08U   ep_addr,
+                                   void        *p_buf,
+                                   CPU_INT32U   buf_len,
+                                   CPU_INT32U   xfer_len,
+                                   void        *p_arg,
+                                   USBD_ERR     err)
 {
-    (void)p_dev;
+    USBD_DEV  *p_dev;
 
-    return (DEF_FAIL);
+
+    (void)dev_nbr;
+    (void)ep_addr;
+    (void)p_buf;
+    (void)buf_len;
+    (void)xfer_len;
+
+    p_dev = (USBD_DEV *)p_arg;
+    if (p_dev->CtrlState != USBD_CTRL_STATE_STATUS) {
+        return;
+    }
+
+    p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+
+    if (( err                                                      == USBD_ERR_NONE)             &&
+        ((p_dev->SetupReq.bmRequestType & USBD_REQ_TYPE_MASK)      == USBD_REQ_TYPE_STANDARD)    &&
+        ((p_dev->SetupReq.bmRequestType & USBD_REQ_RECIPIENT_MASK) == USBD_REQ_RECIPIENT_DEVICE) &&
+        ( p_dev->SetupReq.bRequest                                 == USBD_REQ_SET_ADDRESS)      &&
+        ( p_dev->Drv.API_Ptr->AddrEn                               != (void *)0)) {
+                                                                /* See Note #1.                                         */
+        p_dev->Drv.API_Ptr->AddrEn(&p_dev->Drv, p_dev->Addr);
+    }
 }
 #endif
 
@@ -6723,12 +8082,20 @@ static  void  USBD_DevDescSend (USBD_DEV     *p_dev,
 *                               USBD_ERR_NONE               Device configuration successfully sent.
 *                               USBD_ERR_CFG_INVALID_NBR    Invalid configuration number.
 *
-*                               - RETURNED BY USBD_DescWrStop() -
-*                               See USBD_DescWrStop() for additional return error codes.
+*                               - RETURNED BY USBD_CtrlDataTx() -
+*                               See USBD_CtrlDataTx() for additional return error codes.
+*
+*                               - RETURNED BY USBD_CfgDescWr() -
+*                               See USBD_CfgDescWr() for additional return error codes.
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) A Get Descriptor standard request is answered from the configuration descriptor cache
+*                   when the configuration fits in it (see 'LOCAL DEFINES  Note #5'). The cached image is
+*                   always built as a CONFIGURATION descriptor for the configuration itself: its type and
+*                   its configuration value are patched in place before it is sent, since an other-speed
+*                   configuration descriptor has the same content as the current-speed descriptor of the
+*                   associated configuration.
 *********************************************************************************************************
 */
 
@@ -6738,24 +8105,11 @@ static  void  USBD_CfgDescSend (USBD_DEV     *p_dev,
                                 CPU_INT16U    req_len,
                                 USBD_ERR     *p_err)
 {
-    USBD_CFG        *p_cfg;
-    USBD_IF         *p_if;
-    USBD_EP_INFO    *p_ep;
-    USBD_IF_ALT     *p_if_alt;
-#if (USBD_CFG_MAX_NBR_IF_GRP > 0)
-    USBD_IF_GRP     *p_if_grp;
-#endif
-    USBD_CLASS_DRV  *p_if_drv;
-    CPU_INT08U       cfg_nbr_cur;
-    CPU_INT08U       ep_nbr;
-    CPU_INT08U       if_nbr;
-    CPU_INT08U       if_total;
-    CPU_INT08U       if_grp_cur;
-    CPU_INT08U       if_alt_nbr;
-    CPU_INT08U       str_ix;
-    CPU_INT08U       attrib;
-#if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)
-    CPU_INT32U       ep_alloc_map;
+    USBD_CFG    *p_cfg;
+    CPU_INT08U   cfg_nbr_cur;
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+    CPU_INT08U  *p_desc;
+    CPU_INT16U   desc_len;
 #endif
 
 
@@ -6794,6 +8148,121 @@ static  void  USBD_CfgDescSend (USBD_DEV     *p_dev,
     }
 #endif
 
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+    if (p_cfg->DescStaticPtr != (const CPU_INT08U *)0) {
+        USBD_CfgDescStaticSend(p_dev,
+                               p_cfg,
+                               cfg_nbr,
+                               other,
+                               req_len,
+                               p_err);
+        return;
+    }
+#endif
+
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+    if (p_dev->ActualBufPtr == p_dev->DescBufPtr) {             /* Std req: send cached desc, if any (see Note #1).     */
+        if (p_dev->DescCacheValid == DEF_NO) {
+            USBD_CfgDescCacheBuild(p_dev);
+        }
+
+        p_desc = p_cfg->DescCachePtr;
+        if (p_desc != (CPU_INT08U *)0) {
+            if (other == DEF_YES) {
+                p_desc[1u] = USBD_DESC_TYPE_OTHER_SPEED_CONFIGURATION;
+            } else {
+                p_desc[1u] = USBD_DESC_TYPE_CONFIGURATION;
+            }
+            p_desc[5u] = cfg_nbr + 1u;
+
+            desc_len = DEF_MIN(req_len, p_cfg->DescLen);
+            if (desc_len > 0u) {
+                USBD_CtrlDataTx(            p_dev,
+                                (void *)    p_desc,
+                                (CPU_INT32U)desc_len,
+                                           (req_len > p_cfg->DescLen) ? DEF_YES : DEF_NO,
+                                            p_err);
+            }
+            return;
+        }
+    }
+#endif
+
+    USBD_CfgDescWr(p_dev,
+                   p_cfg,
+                   cfg_nbr,
+                   cfg_nbr_cur,
+                   other,
+                   req_len,
+                   p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CfgDescWr()
+*
+* Description : Build configuration descriptor in the current descriptor buffer.
+*
+* Argument(s) : p_dev       Pointer to device struct.
+*               -----       Argument validated by the caller(s).
+*
+*               p_cfg       Pointer to configuration struct.
+*               -----       Argument validated by the caller(s).
+*
+*               cfg_nbr     Configuration number, as reported to the host.
+*
+*               cfg_nbr_cur Configuration number, including the speed bit.
+*
+*               other       Other speed configuration :
+*
+*                               DEF_NO      Descriptor is build for the current speed.
+*                               DEF_YES     Descriptor is build for the  other  speed.
+*
+*               req_len     Requested length by the host.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Configuration descriptor successfully built.
+*
+*                               - RETURNED BY USBD_DescWrStop() -
+*                               See USBD_DescWrStop() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  USBD_CfgDescWr (USBD_DEV     *p_dev,
+                              USBD_CFG     *p_cfg,
+                              CPU_INT08U    cfg_nbr,
+                              CPU_INT08U    cfg_nbr_cur,
+                              CPU_BOOLEAN   other,
+                              CPU_INT16U    req_len,
+                              USBD_ERR     *p_err)
+{
+    USBD_IF         *p_if;
+    USBD_EP_INFO    *p_ep;
+    USBD_IF_ALT     *p_if_alt;
+#if (USBD_CFG_MAX_NBR_IF_GRP > 0)
+    USBD_IF_GRP     *p_if_grp;
+#endif
+    USBD_CLASS_DRV  *p_if_drv;
+    CPU_INT08U       ep_nbr;
+    CPU_INT08U       if_nbr;
+    CPU_INT08U       if_total;
+    CPU_INT08U       if_grp_cur;
+    CPU_INT08U       if_alt_nbr;
+    CPU_INT08U       str_ix;
+    CPU_INT08U       attrib;
+#if (USBD_CFG_OPTIMIZE_SPD == DEF_ENABLED)
+    CPU_INT32U       ep_alloc_map;
+#endif
+
+
+   *p_err = USBD_ERR_NONE;
+
     p_cfg->DescLen = USBD_DESC_LEN_CFG;                         /* Init cfg desc len.                                   */
 
     USBD_DescWrStart(p_dev, req_len);
@@ -6941,7 +8410,7 @@ static  void  USBD_CfgDescSend (USBD_DEV     *p_dev,
             USBD_DescWrReq08(p_dev, p_if_alt->EP_NbrTotal);
             USBD_DescWrReq08(p_dev, p_if->ClassCode);
             USBD_DescWrReq08(p_dev, p_if->ClassSubCode);
-            USBD_DescWrReq08(p_dev, p_if->ClassProtocolCode);
+            USBD_DescWrReq08(p_dev, p_if_alt->ClassProtocolCode);
 
             str_ix = USBD_StrDescIxGet(p_dev, p_if_alt->NamePtr);
             USBD_DescWrReq08(p_dev, str_ix);
@@ -7047,6 +8516,245 @@ static  void  USBD_CfgDescSend (USBD_DEV     *p_dev,
 }
 
 
+/*
+*********************************************************************************************************
+*                                      USBD_CfgDescCacheBuild()
+*
+* Description : Serialize the configuration descriptors of a device in its descriptor cache.
+*
+* Argument(s) : p_dev       Pointer to device struct.
+*               -----       Argument validated by the caller(s).
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The configurations of both speeds are serialized, in the order of their numbers. A
+*                   configuration that does not fit in the remaining cache space is left out of the cache
+*                   and is built on each request (see 'LOCAL DEFINES  Note #5').
+*
+*               (2) The cached image is only kept if the length written matches the length computed from
+*                   the class drivers' 'IF_DescSizeGet()' and 'EP_DescSizeGet()' functions.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+static  void  USBD_CfgDescCacheBuild (USBD_DEV  *p_dev)
+{
+    USBD_CFG     *p_cfg;
+    CPU_INT08U   *p_buf_prev;
+    CPU_INT16U    buf_max_len_prev;
+    USBD_ERR     *p_err_prev;
+    CPU_INT32U    buf_ix;
+    CPU_INT16U    cfg_ix;
+    CPU_INT16U    cfg_nbr_total;
+    CPU_INT08U    cfg_nbr;
+    CPU_INT08U    cfg_nbr_cur;
+    USBD_ERR      err;
+
+
+    p_buf_prev       = p_dev->ActualBufPtr;                     /* Save desc buf ctx of caller.                         */
+    buf_max_len_prev = p_dev->DescBufMaxLen;
+    p_err_prev       = p_dev->DescBufErrPtr;
+
+    cfg_nbr_total = p_dev->CfgFS_TotalNbr;
+#if (USBD_CFG_HS_EN == DEF_ENABLED)
+    cfg_nbr_total += p_dev->CfgHS_TotalNbr;
+#endif
+    buf_ix               =  0u;
+    p_dev->DescBufErrPtr = &err;
+
+    for (cfg_ix = 0u; cfg_ix < cfg_nbr_total; cfg_ix++) {      /* See Note #1.                                         */
+        cfg_nbr     = (CPU_INT08U)cfg_ix;
+        cfg_nbr_cur =  cfg_nbr;
+#if (USBD_CFG_HS_EN == DEF_ENABLED)
+        if (cfg_ix >= p_dev->CfgFS_TotalNbr) {
+            cfg_nbr     = (CPU_INT08U)(cfg_ix - p_dev->CfgFS_TotalNbr);
+            cfg_nbr_cur =  cfg_nbr | USBD_CFG_NBR_SPD_BIT;
+        }
+#endif
+
+        p_cfg = USBD_CfgRefGet(p_dev, cfg_nbr_cur);
+        if (p_cfg == (USBD_CFG *)0) {
+            continue;
+        }
+
+        p_cfg->DescCachePtr = (CPU_INT08U *)0;
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+        if (p_cfg->DescStaticPtr != (const CPU_INT08U *)0) {    /* Const cfg desc is sent from ROM.                     */
+            continue;
+        }
+#endif
+                                                                /* Align each image for zero-copy xfers.                */
+        buf_ix = MATH_ROUND_INC_UP(buf_ix, USBD_CFG_BUF_ALIGN_OCTETS);
+        if (buf_ix >= USBD_CFG_DESC_CACHE_LEN) {
+            continue;
+        }
+
+        p_dev->ActualBufPtr  = &p_dev->DescCacheBufPtr[buf_ix];
+        p_dev->DescBufMaxLen = (CPU_INT16U)(USBD_CFG_DESC_CACHE_LEN - buf_ix);
+        err                  =  USBD_ERR_NONE;
+
+        USBD_CfgDescWr(p_dev,
+                       p_cfg,
+                       cfg_nbr,
+                       cfg_nbr_cur,
+                       DEF_NO,
+                       DEF_INT_16U_MAX_VAL,
+                      &err);
+
+        if ((err              == USBD_ERR_NONE ) &&             /* See Note #2.                                         */
+            (p_dev->DescBufIx == p_cfg->DescLen)) {
+            p_cfg->DescCachePtr =  p_dev->ActualBufPtr;
+            buf_ix             +=  p_cfg->DescLen;
+        }
+    }
+
+    p_dev->ActualBufPtr   = p_buf_prev;                         /* Restore desc buf ctx of caller.                      */
+    p_dev->DescBufMaxLen  = buf_max_len_prev;
+    p_dev->DescBufErrPtr  = p_err_prev;
+    p_dev->DescCacheValid = DEF_YES;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_CfgDescStaticSend()
+*
+* Description : Send a constant configuration descriptor.
+*
+* Argument(s) : p_dev       Pointer to device struct.
+*               -----       Argument validated by the caller(s).
+*
+*               p_cfg       Pointer to configuration struct.
+*               -----       Argument validated by the caller(s).
+*
+*               cfg_nbr     Configuration number, as reported to the host.
+*
+*               other       Other speed configuration :
+*
+*                               DEF_NO      Descriptor is sent for the current speed.
+*                               DEF_YES     Descriptor is sent for the  other  speed.
+*
+*               req_len     Requested length by the host.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Configuration descriptor successfully sent.
+*
+*                               - RETURNED BY USBD_CtrlTx() -
+*                               See USBD_CtrlTx() for additional return error codes.
+*
+*                               - RETURNED BY USBD_DescWrStop() -
+*                               See USBD_DescWrStop() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) When the descriptor type and the configuration value found in the constant descriptor
+*                   are the ones to send, the descriptor is sent from ROM in a single transfer.
+*
+*               (2) Otherwise (other speed configuration, or configuration value differing from the one
+*                   reported to the host), these fields cannot be set in place. For a Get Descriptor
+*                   standard request, the first USBD_CFG_DESC_BUF_LEN octets are copied in the descriptor
+*                   buffer to be set, and the rest of the descriptor is sent from ROM. USBD_CFG_DESC_BUF_LEN
+*                   is a multiple of the control endpoint maximum packet size, so the first transfer does
+*                   not end the data stage.
+*
+*               (3) The patched part is sent synchronously. Only the last transfer of the data stage is
+*                   given to USBD_CtrlDataTx(), which may complete it asynchronously.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+static  void  USBD_CfgDescStaticSend (USBD_DEV     *p_dev,
+                                      USBD_CFG     *p_cfg,
+                                      CPU_INT08U    cfg_nbr,
+                                      CPU_BOOLEAN   other,
+                                      CPU_INT16U    req_len,
+                                      USBD_ERR     *p_err)
+{
+    const  CPU_INT08U   *p_desc;
+           CPU_INT08U   *p_buf;
+           CPU_INT16U    desc_len;
+           CPU_INT16U    buf_len;
+           CPU_BOOLEAN   end;
+
+
+    p_desc   = p_cfg->DescStaticPtr;
+    desc_len = DEF_MIN(req_len, p_cfg->DescLen);
+    end      = (req_len > p_cfg->DescLen) ? DEF_YES : DEF_NO;
+
+    if ((p_dev->ActualBufPtr == p_dev->DescBufPtr) &&          /* Send desc from ROM (see Note #1).                    */
+        (desc_len            >  0u               ) &&
+        (other               == DEF_NO           ) &&
+        (p_desc[5u]          == cfg_nbr + 1u     )) {
+        USBD_CtrlDataTx(            p_dev,
+                        (void *)    p_desc,
+                        (CPU_INT32U)desc_len,
+                                    end,
+                                    p_err);
+        return;
+    }
+
+    if (p_dev->ActualBufPtr == p_dev->DescBufPtr) {             /* Std req (see Note #2).                               */
+        buf_len = DEF_MIN(desc_len, USBD_CFG_DESC_BUF_LEN);
+        if (buf_len == 0u) {
+           *p_err = USBD_ERR_NONE;
+            return;
+        }
+
+        Mem_Copy((      void *)&p_dev->DescBufPtr[0u],
+                 (const void *)&p_desc[0u],
+                                buf_len);
+    } else {                                                    /* Drv buf.                                             */
+        USBD_DescWrStart(p_dev, req_len);
+        USBD_DescWrReq(p_dev, p_desc, p_cfg->DescLen);
+
+        buf_len = p_dev->DescBufIx;
+    }
+
+    p_buf = p_dev->ActualBufPtr;                                /* Set desc type and cfg value.                         */
+    if (buf_len > 1u) {
+        if (other == DEF_YES) {
+            p_buf[1u] = USBD_DESC_TYPE_OTHER_SPEED_CONFIGURATION;
+        } else {
+            p_buf[1u] = USBD_DESC_TYPE_CONFIGURATION;
+        }
+    }
+    if (buf_len > 5u) {
+        p_buf[5u] = cfg_nbr + 1u;
+    }
+
+    if (p_dev->ActualBufPtr != p_dev->DescBufPtr) {
+        USBD_DescWrStop(p_dev, p_err);
+        return;
+    }
+
+    if (buf_len == desc_len) {
+        USBD_CtrlDataTx(            p_dev,
+                                   &p_dev->DescBufPtr[0u],
+                        (CPU_INT32U)buf_len,
+                                    end,
+                                    p_err);
+        return;
+    }
+
+    (void)USBD_CtrlTx(            p_dev->Nbr,                   /* Patched part is sent first (see Note #3).            */
+                                 &p_dev->DescBufPtr[0u],
+                      (CPU_INT32U)buf_len,
+                                  USBD_CFG_CTRL_REQ_TIMEOUT_mS,
+                                  DEF_NO,
+                                  p_err);
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_CtrlDataTx(            p_dev,
+                        (void *)   &p_desc[buf_len],
+                        (CPU_INT32U)(desc_len - buf_len),
+                                    end,
+                                    p_err);
+    }
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                         USBD_StrDescSend()
@@ -7203,12 +8911,11 @@ static  void  USBD_DescWrStop (USBD_DEV  *p_dev,
     if (*p_err == USBD_ERR_NONE) {
         if (p_dev->ActualBufPtr == p_dev->DescBufPtr) {         /* See Note #1.                                         */
             if (p_dev->DescBufIx > 0u) {
-                (void)USBD_CtrlTx(            p_dev->Nbr,
-                                             &p_dev->DescBufPtr[0u],
-                                  (CPU_INT32U)p_dev->DescBufIx,
-                                              USBD_CFG_CTRL_REQ_TIMEOUT_mS,
-                                             (p_dev->DescBufReqLen > 0u) ? DEF_YES : DEF_NO,
-                                              p_err);
+                USBD_CtrlDataTx(            p_dev,
+                                           &p_dev->DescBufPtr[0u],
+                                (CPU_INT32U)p_dev->DescBufIx,
+                                           (p_dev->DescBufReqLen > 0u) ? DEF_YES : DEF_NO,
+                                            p_err);
             } else {
                *p_err = USBD_ERR_NONE;
             }
@@ -7310,8 +9017,9 @@ static  void  USBD_DescWrReq (       USBD_DEV    *p_dev,
                                      CPU_INT16U   len)
 {
     CPU_INT08U  *p_desc;
-    CPU_INT08U   buf_cur_ix;
+    CPU_INT16U   buf_cur_ix;
     CPU_INT16U   len_req;
+    CPU_INT16U   len_copy;
     USBD_ERR     err;
     CPU_SR_ALLOC();
 
@@ -7339,12 +9047,18 @@ static  void  USBD_DescWrReq (       USBD_DEV    *p_dev,
                 len_req = 0u;
                 err     = USBD_ERR_ALLOC;
             }
-        } else {
-            p_desc[buf_cur_ix] = *p_buf;
-            p_buf++;
-            len--;
-            len_req--;
-            buf_cur_ix++;
+        } else {                                                /* Copy as much as the buf and the req len allow.       */
+            len_copy = DEF_MIN(len, len_req);
+            len_copy = DEF_MIN(len_copy, p_dev->DescBufMaxLen - buf_cur_ix);
+
+            Mem_Copy((      void *)&p_desc[buf_cur_ix],
+                     (const void *) p_buf,
+                                    len_copy);
+
+            p_buf      += len_copy;
+            len        -= len_copy;
+            len_req    -= len_copy;
+            buf_cur_ix += len_copy;
         }
     }
 
@@ -7494,25 +9208,13 @@ static  USBD_CFG  *USBD_CfgRefGet (const  USBD_DEV    *p_dev,
 static  void  USBD_EventSet (USBD_DRV         *p_drv,
                              USBD_EVENT_CODE   event)
 {
-    USBD_CORE_EVENT  *p_core_event;
-
-
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
     if (p_drv == (USBD_DRV *)0) {
         return;
     }
 #endif
 
-    p_core_event = USBD_CoreEventGet();
-    if (p_core_event == (USBD_CORE_EVENT *)0) {
-        return;
-    }
-
-    p_core_event->Type   = event;
-    p_core_event->DrvPtr = p_drv;
-    p_core_event->Err    = USBD_ERR_NONE;
-
-    USBD_OS_CoreEventPut(p_core_event);
+    USBD_CoreEventPut(p_drv, event, 0u, USBD_ERR_NONE);
 }
 
 
@@ -7526,7 +9228,19 @@ static  void  USBD_EventSet (USBD_DRV         *p_drv,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the core event ring is enabled, an endpoint event without error stands for one or
+*                   more completions on the endpoint. Each of them is processed in turn. If the event is
+*                   discarded, its completions are acknowledged without being processed.
+*
+*               (2) The completion of a deferred request is ignored if the request was superseded by a
+*                   new setup request or a bus reset in the meantime (see USBD_CtrlReqCmplGet()).
+*
+*               (3) The deferred request completion event belongs to the device and is not freed (see
+*                   'CORE EVENTS POOL  Note #3'). Its posted completion is consumed even if the device is
+*                   stopping, so that the next completion can be posted.
+*
+*               (4) When the core event ring is enabled, the events of a device are processed in ring
+*                   order rather than in posting order (see USBD_CoreEventPut() Note #4).
 *********************************************************************************************************
 */
 
@@ -7538,52 +9252,103 @@ void  USBD_CoreTaskHandler (void)
     CPU_INT08U        ep_addr;
     USBD_EVENT_CODE   event;
     USBD_ERR          err;
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+    CPU_BOOLEAN       cmpl;
+#endif
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+    CPU_BOOLEAN       valid;
+#endif
 
 
     while (DEF_TRUE) {
                                                                 /* Wait for an event.                                   */
         p_core_event = (USBD_CORE_EVENT *)USBD_OS_CoreEventGet(0u, &err);
         if (p_core_event != (USBD_CORE_EVENT *)0) {
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+            p_core_event = USBD_CoreEventNext(p_core_event);    /* See Note #4.                                         */
+#endif
             event = p_core_event->Type;
             p_drv = p_core_event->DrvPtr;
             p_dev = USBD_DevRefGet(p_drv->DevNbr);
 
-            if (p_dev != (USBD_DEV *)0) {
-                if (p_dev->State != USBD_DEV_STATE_STOPPING) {
-
-                    switch (event) {                            /* Decode event.                                        */
-                        case USBD_EVENT_BUS_RESET:              /* -------------------- BUS EVENTS -------------------- */
-                        case USBD_EVENT_BUS_RESUME:
-                        case USBD_EVENT_BUS_CONN:
-                        case USBD_EVENT_BUS_HS:
-                        case USBD_EVENT_BUS_SUSPEND:
-                        case USBD_EVENT_BUS_DISCONN:
-                             USBD_EventProcess(p_dev, event);
-                             break;
+            if ((p_dev        != (USBD_DEV *)0) &&
+                (p_dev->State != USBD_DEV_STATE_STOPPING)) {
+
+                switch (event) {                                /* Decode event.                                        */
+                    case USBD_EVENT_BUS_RESET:                  /* -------------------- BUS EVENTS -------------------- */
+                    case USBD_EVENT_BUS_RESUME:
+                    case USBD_EVENT_BUS_CONN:
+                    case USBD_EVENT_BUS_HS:
+                    case USBD_EVENT_BUS_SUSPEND:
+                    case USBD_EVENT_BUS_DISCONN:
+                         USBD_EventProcess(p_dev, event);
+                         break;
 
-                        case USBD_EVENT_EP:                     /* ------------------ ENDPOINT EVENTS ----------------- */
-                             if (p_dev->State == USBD_DEV_STATE_SUSPENDED) {
-                                 p_dev->State = p_dev->StatePrev;
+                    case USBD_EVENT_EP:                         /* ------------------ ENDPOINT EVENTS ----------------- */
+                         if (p_dev->State == USBD_DEV_STATE_SUSPENDED) {
+                             p_dev->State = p_dev->StatePrev;
+                         }
+                         ep_addr = p_core_event->EP_Addr;
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+                         if (p_core_event->Err == USBD_ERR_NONE) {
+                             cmpl = USBD_CoreEventCmplAck(p_core_event);
+                             while (cmpl == DEF_YES) {          /* Process every coalesced cmpl (see Note #1).          */
+                                 USBD_EP_XferAsyncProcess(p_drv, ep_addr, USBD_ERR_NONE);
+                                 cmpl = USBD_CoreEventCmplAck(p_core_event);
                              }
-                             ep_addr = p_core_event->EP_Addr;
-                             USBD_EP_XferAsyncProcess(p_drv, ep_addr, p_core_event->Err);
                              break;
+                         }
+#endif
+                         USBD_EP_XferAsyncProcess(p_drv, ep_addr, p_core_event->Err);
+                         break;
+
+                    case USBD_EVENT_SETUP:                      /* ------------------- SETUP EVENTS ------------------- */
+                         USBD_DBG_STATS_DEV_INC(p_dev->Nbr, DevSetupEventNbr);
+                         if (p_dev->State == USBD_DEV_STATE_SUSPENDED) {
+                             p_dev->State = p_dev->StatePrev;
+                         }
+                         USBD_StdReqHandler(p_dev);
+                         break;
 
-                        case USBD_EVENT_SETUP:                  /* ------------------- SETUP EVENTS ------------------- */
-                             USBD_DBG_STATS_DEV_INC(p_dev->Nbr, DevSetupEventNbr);
-                             if (p_dev->State == USBD_DEV_STATE_SUSPENDED) {
-                                 p_dev->State = p_dev->StatePrev;
-                             }
-                             USBD_StdReqHandler(p_dev);
-                             break;
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+                    case USBD_EVENT_CTRL_CMPL:                  /* ------------ DEFERRED REQUEST COMPLETION ----------- */
+                         if (USBD_CtrlReqCmplGet(p_dev, &valid) != DEF_YES) {
+                             break;                             /* See Note #2.                                         */
+                         }
+                         if (valid == DEF_OK) {
+                             USBD_CtrlStatusStart(p_dev);
+                         } else {
+                             p_dev->CtrlState = USBD_CTRL_STATE_IDLE;
+                             USBD_CtrlStall(p_dev->Nbr, &err);
+                         }
+                         break;
+#endif
 
-                        default:
-                             break;
-                    }
+                    default:
+                         break;
                 }
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+            } else if ((event             == USBD_EVENT_EP) &&
+                       (p_core_event->Err == USBD_ERR_NONE)) {
+                cmpl = USBD_CoreEventCmplAck(p_core_event);
+                while (cmpl == DEF_YES) {                       /* Discard coalesced cmpl (see Note #1).                */
+                    cmpl = USBD_CoreEventCmplAck(p_core_event);
+                }
+#endif
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+            } else if ((p_dev != (USBD_DEV *)0) &&
+                       (event == USBD_EVENT_CTRL_CMPL)) {
+                (void)USBD_CtrlReqCmplGet(p_dev, &valid);       /* See Note #3.                                         */
+#endif
             }
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+            if (event != USBD_EVENT_CTRL_CMPL) {                /* See Note #3.                                         */
+                USBD_CoreEventFree(p_core_event);               /* Return event to free pool.                           */
+            }
+#else
             USBD_CoreEventFree(p_core_event);                   /* Return event to free pool.                           */
+#endif
         }
     }
 }
@@ -7649,6 +9414,9 @@ static  void  USBD_EventProcess (USBD_DEV         *p_dev,
                  CPU_CRITICAL_EXIT();
              }
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+             p_dev->CtrlState = USBD_CTRL_STATE_IDLE;           /* Abandon ctrl xfer in progress.                       */
+#endif
              USBD_CtrlClose(p_dev->Nbr, &err);                  /* Close ctrl EP.                                       */
 
              if (p_dev->CfgCurNbr != USBD_CFG_NBR_NONE) {
@@ -7721,6 +9489,9 @@ static  void  USBD_EventProcess (USBD_DEV         *p_dev,
              USBD_DBG_STATS_DEV_INC(p_dev->Nbr, DevDisconnEventNbr);
              USBD_DBG_CORE_BUS("Bus Disconnect");
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+             p_dev->CtrlState = USBD_CTRL_STATE_IDLE;           /* Abandon ctrl xfer in progress.                       */
+#endif
              USBD_CtrlClose(p_dev->Nbr, &err);                  /* Close ctrl EP.                                       */
 
              if (p_dev->CfgCurNbr != USBD_CFG_NBR_NONE) {
@@ -7754,6 +9525,7 @@ static  void  USBD_EventProcess (USBD_DEV         *p_dev,
 
         case USBD_EVENT_EP:
         case USBD_EVENT_SETUP:
+        case USBD_EVENT_CTRL_CMPL:
         default:
              break;
     }
@@ -7776,6 +9548,7 @@ static  void  USBD_EventProcess (USBD_DEV         *p_dev,
 *********************************************************************************************************
 */
 
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
 static  USBD_CORE_EVENT  *USBD_CoreEventGet (void)
 {
     USBD_CORE_EVENT  *p_core_event;
@@ -7794,6 +9567,121 @@ static  USBD_CORE_EVENT  *USBD_CoreEventGet (void)
 
     return (p_core_event);
 }
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_CoreEventPut()
+*
+* Description : Queue a core event to the core task.
+*
+* Argument(s) : p_drv       Pointer to device driver.
+*
+*               type        Core event type.
+*
+*               ep_addr     Endpoint address, for endpoint events.
+*
+*               err         Error code returned by the driver, if any.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) When the core event ring is enabled, the slot is claimed, filled and linked to the
+*                   previously queued event within a single short critical section. Events can thus be
+*                   signaled from the device controller ISR and from task level: some drivers complete
+*                   a transfer from the function that starts it, and the ISR can preempt them.
+*
+*               (2) A completion without error is coalesced with the last queued event if it is an
+*                   endpoint event for the same endpoint that has not been fully processed yet. No slot
+*                   is used then.
+*
+*               (3) Queueing a new event closes the previously queued endpoint event, if any. Completions
+*                   signaled afterwards on that endpoint are no longer processed by the previous event.
+*                   The closing counter value MUST be visible before the completion counter is
+*                   incremented again.
+*
+*               (4) The slot is posted after the critical section. A caller at task level can be
+*                   preempted in between by the ISR, whose event is then posted first. The core task
+*                   therefore takes the events of a device in ring order, and only uses the posted
+*                   pointer to find the device (see USBD_CoreEventNext()).
+*********************************************************************************************************
+*/
+
+static  void  USBD_CoreEventPut (USBD_DRV         *p_drv,
+                                 USBD_EVENT_CODE   type,
+                                 CPU_INT08U        ep_addr,
+                                 USBD_ERR          err)
+{
+    USBD_CORE_EVENT       *p_core_event;
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+    USBD_CORE_EVENT_RING  *p_ring;
+    USBD_CORE_EVENT       *p_tail;
+    CPU_DATA               in_ix;
+    CPU_DATA               in_ix_next;
+    CPU_INT08U             ep_phy_nbr;
+    CPU_BOOLEAN            queue;
+    CPU_SR_ALLOC();
+#endif
+
+
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
+    p_core_event = USBD_CoreEventGet();                         /* Get core event struct.                               */
+    if (p_core_event == (USBD_CORE_EVENT *)0) {
+        return;
+    }
+
+    p_core_event->Type    = type;
+    p_core_event->DrvPtr  = p_drv;
+    p_core_event->EP_Addr = ep_addr;
+    p_core_event->Err     = err;
+#else
+    p_ring = &USBD_CoreEventRingTbl[p_drv->DevNbr];
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    in_ix      = p_ring->InIx;
+    in_ix_next = in_ix + 1u;
+    if (in_ix_next >= USBD_CORE_EVENT_RING_LEN) {
+        in_ix_next = 0u;
+    }
+
+    if (in_ix_next == p_ring->OutIx) {                          /* Chk if ring is full.                                 */
+        CPU_CRITICAL_EXIT();
+        return;
+    }
+    USBD_CORE_EVENT_MB();                                       /* Slot is freed before being reused.                   */
+
+    if ((type == USBD_EVENT_EP) &&
+        (err  == USBD_ERR_NONE)) {
+        queue = USBD_CoreEventCmplPost(p_drv->DevNbr, ep_addr);
+        if (queue == DEF_NO) {                                  /* Cmpl coalesced with last queued event (see Note #2). */
+            CPU_CRITICAL_EXIT();
+            return;
+        }
+    }
+
+    p_core_event          = &p_ring->EventTbl[in_ix];
+    p_core_event->Type    =  type;
+    p_core_event->DrvPtr  =  p_drv;
+    p_core_event->EP_Addr =  ep_addr;
+    p_core_event->Err     =  err;
+    p_core_event->CmplEnd =  USBD_CORE_EVENT_CMPL_END_NONE;
+
+    p_tail = p_ring->TailPtr;                                   /* Close last queued EP event (see Note #3).            */
+    if ((p_tail       != (USBD_CORE_EVENT *)0) &&
+        (p_tail->Type == USBD_EVENT_EP)        &&
+        (p_tail->Err  == USBD_ERR_NONE)) {
+        ep_phy_nbr      = USBD_EP_ADDR_TO_PHY(p_tail->EP_Addr);
+        p_tail->CmplEnd = p_ring->EP_CmplPostCtr[ep_phy_nbr];
+    }
+    USBD_CORE_EVENT_MB();                                       /* Slot is filled before being published.               */
+
+    p_ring->TailPtr = p_core_event;
+    p_ring->InIx    = in_ix_next;
+    CPU_CRITICAL_EXIT();
+#endif
+
+    USBD_OS_CoreEventPut(p_core_event);                         /* See Note #4.                                         */
+}
 
 
 /*
@@ -7806,17 +9694,19 @@ static  USBD_CORE_EVENT  *USBD_CoreEventGet (void)
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) When the core event ring is enabled, core events are freed in ring order, in which the
+*                   core task takes them (see USBD_CoreEventNext()).
 *********************************************************************************************************
 */
 
 static  void  USBD_CoreEventFree (USBD_CORE_EVENT  *p_core_event)
 {
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_DISABLED)
     CPU_SR_ALLOC();
 
 
     CPU_CRITICAL_ENTER();
-    if (USBD_CoreEventPoolIx == USBD_CORE_EVENT_NBR_TOTAL) {
+    if (USBD_CoreEventPoolIx == USBD_CORE_EVENT_POOL_LEN) {
         CPU_CRITICAL_EXIT();
         return;
     }
@@ -7824,7 +9714,162 @@ static  void  USBD_CoreEventFree (USBD_CORE_EVENT  *p_core_event)
     USBD_CoreEventPoolPtrs[USBD_CoreEventPoolIx] = p_core_event;
     USBD_CoreEventPoolIx++;
     CPU_CRITICAL_EXIT();
+#else
+    USBD_CORE_EVENT_RING  *p_ring;
+    CPU_DATA               out_ix_next;
+
+
+    p_ring      = &USBD_CoreEventRingTbl[p_core_event->DrvPtr->DevNbr];
+    out_ix_next = (p_ring->OutIx + 1u);
+    if (out_ix_next >= USBD_CORE_EVENT_RING_LEN) {
+        out_ix_next = 0u;
+    }
+
+    USBD_CORE_EVENT_MB();                                       /* Event is read before its slot is released.           */
+    p_ring->OutIx = out_ix_next;                                /* See Note #1.                                         */
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_CoreEventNext()
+*
+* Description : Get the next core event to process from a device's ring.
+*
+* Argument(s) : p_core_event    Pointer to core event received by the core task.
+*
+* Return(s)   : Pointer to the oldest queued event of the device's ring, or 'p_core_event' if it is not
+*               taken from a ring.
+*
+* Note(s)     : (1) Each posted pointer matches a slot published beforehand, so the ring holds at least one
+*                   event here (see USBD_CoreEventPut() Note #4).
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+static  USBD_CORE_EVENT  *USBD_CoreEventNext (USBD_CORE_EVENT  *p_core_event)
+{
+    USBD_CORE_EVENT_RING  *p_ring;
+    CPU_INT08U             dev_nbr;
+
+
+    dev_nbr = p_core_event->DrvPtr->DevNbr;                     /* Same drv for every slot of the dev's ring.           */
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+    if (p_core_event == &USBD_CtrlCmplEventTbl[dev_nbr]) {      /* Deferred req cmpl is not a ring event.               */
+        return (p_core_event);
+    }
+#endif
+
+    p_ring = &USBD_CoreEventRingTbl[dev_nbr];
+    USBD_CORE_EVENT_MB();                                       /* See Note #1.                                         */
+
+    return (&p_ring->EventTbl[p_ring->OutIx]);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_CoreEventCmplPost()
+*
+* Description : Signal an endpoint completion and check whether a new endpoint event must be queued.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+* Return(s)   : DEF_YES, if a new endpoint event must be queued.
+*
+*               DEF_NO,  if the completion is coalesced with the last queued event.
+*
+* Note(s)     : (1) The completion is coalesced only if the last queued event is an endpoint event for the
+*                   same endpoint and the core task has not yet acknowledged all the completions signaled
+*                   before this one. The completion counter is incremented BEFORE the acknowledge counter
+*                   is read, while USBD_CoreEventCmplAck() increments the acknowledge counter BEFORE
+*                   reading the completion counter. Hence, either the core task sees the new completion or
+*                   a new event is queued. A queued event may then find no completion left to process.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_CoreEventCmplPost (CPU_INT08U  dev_nbr,
+                                             CPU_INT08U  ep_addr)
+{
+    USBD_CORE_EVENT_RING  *p_ring;
+    USBD_CORE_EVENT       *p_tail;
+    CPU_INT08U             ep_phy_nbr;
+    CPU_INT08U             post_ctr;
+
+
+    p_ring     = &USBD_CoreEventRingTbl[dev_nbr];
+    ep_phy_nbr =  USBD_EP_ADDR_TO_PHY(ep_addr);
+    post_ctr   =  p_ring->EP_CmplPostCtr[ep_phy_nbr];
+
+    p_ring->EP_CmplPostCtr[ep_phy_nbr] = post_ctr + 1u;
+
+    p_tail = p_ring->TailPtr;
+    if ((p_tail          != (USBD_CORE_EVENT *)0) &&
+        (p_tail->Type    == USBD_EVENT_EP)        &&
+        (p_tail->Err     == USBD_ERR_NONE)        &&
+        (p_tail->EP_Addr == ep_addr)) {
+        USBD_CORE_EVENT_MB();                                   /* See Note #1.                                         */
+        if (p_ring->EP_CmplAckCtr[ep_phy_nbr] != post_ctr) {
+            return (DEF_NO);
+        }
+    }
+
+    return (DEF_YES);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       USBD_CoreEventCmplAck()
+*
+* Description : Acknowledge the next endpoint completion covered by an endpoint event.
+*
+* Argument(s) : p_core_event    Pointer to endpoint core event.
+*
+* Return(s)   : DEF_YES, if a completion has been acknowledged and must be processed.
+*
+*               DEF_NO,  if the event covers no more completions.
+*
+* Note(s)     : (1) The completion counter is read BEFORE the closing counter value of the event, which
+*                   is written by USBD_CoreEventPut() before any later completion is signaled.
+*
+*               (2) See USBD_CoreEventCmplPost() Note #1.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CORE_EVENT_RING_EN == DEF_ENABLED)
+static  CPU_BOOLEAN  USBD_CoreEventCmplAck (USBD_CORE_EVENT  *p_core_event)
+{
+    USBD_CORE_EVENT_RING  *p_ring;
+    CPU_INT08U             ep_phy_nbr;
+    CPU_INT08U             ack_ctr;
+
+
+    p_ring     = &USBD_CoreEventRingTbl[p_core_event->DrvPtr->DevNbr];
+    ep_phy_nbr =  USBD_EP_ADDR_TO_PHY(p_core_event->EP_Addr);
+    ack_ctr    =  p_ring->EP_CmplAckCtr[ep_phy_nbr];
+
+    if (ack_ctr == p_ring->EP_CmplPostCtr[ep_phy_nbr]) {        /* Chk if any cmpl is pending.                          */
+        return (DEF_NO);
+    }
+    USBD_CORE_EVENT_MB();                                       /* See Note #1.                                         */
+
+    if (p_core_event->CmplEnd == ack_ctr) {                     /* Chk if next cmpl belongs to a later event.           */
+        return (DEF_NO);
+    }
+
+    p_ring->EP_CmplAckCtr[ep_phy_nbr] = ack_ctr + 1u;
+    USBD_CORE_EVENT_MB();                                       /* See Note #2.                                         */
+
+    return (DEF_YES);
 }
+#endif
 
 
 /*
@@ -7974,6 +10019,11 @@ static  void  USBD_IF_AltOpen (       USBD_DEV     *p_dev,
                       p_ep->MaxPktSize,
                       p_ep->Attrib,
                       p_ep->Interval,
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+                      p_ep->URB_NbrRsvd,
+#else
+                      0u,
+#endif
                       p_err);
         if (*p_err != USBD_ERR_NONE) {
                 valid = DEF_FAIL;
@@ -7997,6 +10047,11 @@ static  void  USBD_IF_AltOpen (       USBD_DEV     *p_dev,
                       p_ep->MaxPktSize,
                       p_ep->Attrib,
                       p_ep->Interval,
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+                      p_ep->URB_NbrRsvd,
+#else
+                      0u,
+#endif
                       p_err);
         if (*p_err != USBD_ERR_NONE) {
              valid = DEF_FAIL;
@@ -8296,7 +10351,8 @@ static  CPU_INT08U  USBD_StrDescIxGet (const  USBD_DEV  *p_dev,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) In binary trace mode, the event is written to the trace ring and the debug task is
+*                   not signaled. See 'usbd_cfg.h  USB DEVICE DEBUG CONFIGURATION  Note #1'.
 *********************************************************************************************************
 */
 
@@ -8306,13 +10362,23 @@ void  USBD_Dbg (const  CPU_CHAR    *p_msg,
                        CPU_INT08U   if_nbr,
                        USBD_ERR     err)
 {
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED)
     USBD_DBG_EVENT  *p_event;
+#endif
 
 
     if (p_msg == (const CPU_CHAR *)0) {
         return;
     }
 
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED)
+    USBD_DbgTraceWr(p_msg,                                      /* See Note #1.                                         */
+                    ep_addr,
+                    if_nbr,
+                    0u,
+                    DEF_BIT_NONE,
+                    err);
+#else
     p_event = USBD_DbgEventGet();
     if (p_event != (USBD_DBG_EVENT *)0) {
         p_event->MsgPtr  = p_msg;
@@ -8323,6 +10389,7 @@ void  USBD_Dbg (const  CPU_CHAR    *p_msg,
         USBD_DbgEventPut(p_event);
         USBD_OS_DbgEventRdy();
     }
+#endif
 }
 #endif
 
@@ -8356,13 +10423,23 @@ void  USBD_DbgArg (const  CPU_CHAR    *p_msg,
                           CPU_INT32U   arg,
                           USBD_ERR     err)
 {
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED)
     USBD_DBG_EVENT  *p_event;
+#endif
 
 
     if (p_msg == (const CPU_CHAR *)0) {
         return;
     }
 
+#if (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED)
+    USBD_DbgTraceWr(p_msg,                                      /* See 'USBD_Dbg()  Note #1'.                           */
+                    ep_addr,
+                    if_nbr,
+                    arg,
+                    USBD_DBG_TRACE_REC_FLAG_ARG,
+                    err);
+#else
     p_event = USBD_DbgEventGet();
     if (p_event != (USBD_DBG_EVENT *)0) {
         p_event->MsgPtr  = p_msg;
@@ -8374,6 +10451,7 @@ void  USBD_DbgArg (const  CPU_CHAR    *p_msg,
         USBD_DbgEventPut(p_event);
         USBD_OS_DbgEventRdy();
     }
+#endif
 }
 #endif
 
@@ -8389,10 +10467,23 @@ void  USBD_DbgArg (const  CPU_CHAR    *p_msg,
 * Return(s)   : none.
 *
 * Note(s)     : (1) This task processes all the debug events queued by the device stack.
+*
+*               (2) In binary trace mode, no event is queued to the debug task, which stays blocked.
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+void  USBD_DbgTaskHandler (void)
+{
+    while (DEF_TRUE) {
+        USBD_OS_DbgEventWait();                                 /* See Note #2.                                         */
+    }
+}
+#endif
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 void  USBD_DbgTaskHandler (void)
 {
     USBD_DBG_EVENT   *p_event;
@@ -8566,7 +10657,8 @@ void  USBD_DbgTaskHandler (void)
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 static  USBD_DBG_EVENT  *USBD_DbgEventGet (void)
 {
     USBD_DBG_EVENT  *p_event;
@@ -8612,7 +10704,8 @@ static  USBD_DBG_EVENT  *USBD_DbgEventGet (void)
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 static  void  USBD_DbgEventPut (USBD_DBG_EVENT  *p_event)
 {
     CPU_SR_ALLOC();
@@ -8644,7 +10737,8 @@ static  void  USBD_DbgEventPut (USBD_DBG_EVENT  *p_event)
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_DBG_TRACE_EN == DEF_ENABLED)
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_DISABLED))
 static  void  USBD_DbgEventFree (USBD_DBG_EVENT  *p_event)
 {
     CPU_SR_ALLOC();
@@ -8660,3 +10754,193 @@ static  void  USBD_DbgEventFree (USBD_DBG_EVENT  *p_event)
     CPU_CRITICAL_EXIT();
 }
 #endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DbgTraceRd()
+*
+* Description : Read records from the binary trace ring.
+*
+* Argument(s) : p_seq       Pointer to variable that holds the sequence number of the next record to read.
+*                           It is updated past the last record read. Set it to 0 before the first call.
+*
+*               p_rec_tbl   Pointer to table that will receive the records.
+*
+*               rec_nbr     Number of records the table can hold.
+*
+* Return(s)   : Number of records copied to the table.
+*
+* Note(s)     : (1) Records are copied in sequence order. A gap in the 'Seq' fields of the records read
+*                   means that records were overwritten before being read :
+*
+*                   (a) If the writers lapped the reader, reading resumes at the oldest record still in
+*                       the ring.
+*
+*                   (b) A record overwritten while being copied is discarded.
+*
+*               (2) Reading stops at a record claimed by a writer but not written yet, whether it is marked
+*                   as being written or still holds the record it replaces. The next call reads it.
+*
+*               (3) This function must NOT be called from an ISR. Several readers must each use their own
+*                   sequence number variable.
+*********************************************************************************************************
+*/
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+CPU_INT32U  USBD_DbgTraceRd (CPU_INT32U          *p_seq,
+                             USBD_DBG_TRACE_REC  *p_rec_tbl,
+                             CPU_INT32U           rec_nbr)
+{
+    USBD_DBG_TRACE_REC  *p_rec;
+    CPU_INT32U           seq;
+    CPU_INT32U           seq_next;
+    CPU_INT32U           rec_seq;
+    CPU_INT32U           rec_cnt;
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
+    if ((p_seq     == (CPU_INT32U         *)0) ||
+        (p_rec_tbl == (USBD_DBG_TRACE_REC *)0)) {
+        return (0u);
+    }
+#endif
+
+    seq_next = USBD_DbgTraceSeqNext;
+    seq      = *p_seq;
+                                                                /* See Note #1a.                                        */
+    if ((CPU_INT32U)(seq_next - seq) > USBD_CFG_DBG_TRACE_BIN_NBR_REC) {
+        seq = seq_next - USBD_CFG_DBG_TRACE_BIN_NBR_REC;
+    }
+
+    rec_cnt = 0u;
+    while ((seq     != seq_next) &&
+           (rec_cnt <  rec_nbr)) {
+        p_rec   = &USBD_DbgTrace.RecTbl[seq & USBD_DBG_TRACE_REC_IX_MASK];
+        rec_seq =  p_rec->Seq;
+        if ((rec_seq == 0u) ||                                  /* See Note #2.                                         */
+            ((CPU_INT32S)(rec_seq - (seq + 1u)) < 0)) {
+            break;
+        }
+
+        if (rec_seq == (seq + 1u)) {
+            USBD_DBG_TRACE_ACQUIRE();                           /* Rd rec content after its seq nbr.                    */
+            Mem_Copy((void     *)&p_rec_tbl[rec_cnt],
+                     (void     *) p_rec,
+                     (CPU_SIZE_T) sizeof(USBD_DBG_TRACE_REC));
+            USBD_DBG_TRACE_ACQUIRE();
+            if (p_rec->Seq == rec_seq) {                        /* Discard rec overwritten during copy (see Note #1b).  */
+                p_rec_tbl[rec_cnt].Seq = rec_seq;
+                rec_cnt++;
+            }
+        }
+        seq++;
+    }
+
+   *p_seq = seq;
+
+    return (rec_cnt);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_DbgTraceHdrGet()
+*
+* Description : Get the binary trace header.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Pointer to the binary trace header.
+*
+* Note(s)     : (1) A host decoder reading records streamed with USBD_DbgTraceRd() needs the header
+*                   first, to know the record layout and the timestamp frequency.
+*********************************************************************************************************
+*/
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+const  USBD_DBG_TRACE_HDR  *USBD_DbgTraceHdrGet (void)
+{
+    return (&USBD_DbgTrace.Hdr);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_DbgTraceWr()
+*
+* Description : Write a debug event to the binary trace ring.
+*
+* Argument(s) : p_msg       Debug message.
+*
+*               ep_addr     Endpoint address.
+*
+*               if_nbr      Interface number.
+*
+*               arg         Argument associated with the debug message.
+*
+*               flags       Record flags :
+*
+*                               USBD_DBG_TRACE_REC_FLAG_ARG     Argument is valid.
+*
+*               err         Error code associated with the debug message.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) This function may be called from ISR and task contexts. The oldest record is
+*                   overwritten when the ring is full (see 'LOCAL DEFINES  Note #4').
+*
+*               (2) The sequence number wraps to 0 after 2^32 events, which marks the record as empty.
+*                   Such a record is ignored by the reader and the decoder.
+*********************************************************************************************************
+*/
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+static  void  USBD_DbgTraceWr (const  CPU_CHAR    *p_msg,
+                                      CPU_INT08U   ep_addr,
+                                      CPU_INT08U   if_nbr,
+                                      CPU_INT32U   arg,
+                                      CPU_INT08U   flags,
+                                      USBD_ERR     err)
+{
+    USBD_DBG_TRACE_REC  *p_rec;
+    CPU_INT32U           seq;
+#ifndef  USBD_CORE_C11_ATOMICS
+    CPU_SR_ALLOC();
+#endif
+
+                                                                /* Claim rec (see Note #1).                             */
+#ifdef   USBD_CORE_C11_ATOMICS
+    seq = atomic_fetch_add_explicit(&USBD_DbgTraceSeqNext, 1u, memory_order_relaxed);
+#else
+    CPU_CRITICAL_ENTER();
+    seq = USBD_DbgTraceSeqNext;
+    USBD_DbgTraceSeqNext = seq + 1u;
+    CPU_CRITICAL_EXIT();
+#endif
+
+    p_rec      = &USBD_DbgTrace.RecTbl[seq & USBD_DBG_TRACE_REC_IX_MASK];
+    p_rec->Seq =  0u;                                           /* Mark rec as being wr.                                */
+    USBD_DBG_TRACE_RELEASE();
+
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+    p_rec->Ts      =  CPU_TS_Get32();
+#else
+    p_rec->Ts      =  0u;
+#endif
+    p_rec->MsgPtr  =  p_msg;
+    p_rec->Arg     =  arg;
+    p_rec->Err     = (CPU_INT16U)err;
+    p_rec->EP_Addr =  ep_addr;
+    p_rec->IF_Nbr  =  if_nbr;
+    p_rec->Flags   =  flags;
+
+    USBD_DBG_TRACE_RELEASE();                                   /* Publish rec content before its seq nbr.              */
+    p_rec->Seq     =  seq + 1u;                                 /* See Note #2.                                         */
+}
+#endif
@@ -479,6 +479,7 @@ typedef  enum  usbd_err {                                       /* Device error
     USBD_ERR_HID_REPORT_INVALID          = 1303u,
     USBD_ERR_HID_REPORT_ALLOC            = 1304u,
     USBD_ERR_HID_REPORT_PUSH_POP_ALLOC   = 1305u,
+    USBD_ERR_HID_INPUT_Q_FULL            = 1306u,               /* Input report dropped, input q full.                  */
                                                                 /* --------------- MSC CLASS ERROR CODES -------------- */
     USBD_ERR_MSC_INSTANCE_ALLOC          = 1400u,
     USBD_ERR_MSC_INVALID_CBW             = 1401u,               /* Invalid Command Block Wrapper.                       */
@@ -498,6 +499,7 @@ typedef  enum  usbd_err {                                       /* Device error
     USBD_ERR_SCSI_LOCK                   = 1415u,               /* Medium lock failed.                                  */
     USBD_ERR_SCSI_LOCK_TIMEOUT           = 1416u,               /* Medium lock timed out.                               */
     USBD_ERR_SCSI_UNLOCK                 = 1417u,               /* Medium successfully unlocked.                        */
+    USBD_ERR_SCSI_SPACE_ALLOC            = 1418u,               /* No space left to map written blocks.                 */
                                                                 /* -------------- PHDC CLASS ERROR CODES -------------- */
     USBD_ERR_PHDC_INSTANCE_ALLOC         = 1500u,
                                                                 /* ------------- VENDOR CLASS ERROR CODES ------------- */
@@ -563,6 +565,10 @@ typedef  enum  usbd_err {                                       /* Device error
 *                   USBD_EventConn(),
 *                   USBD_EventDisconn(),
 *                   USBD_EventHS().
+*
+*           (2) When asynchronous control transfers are enabled, each device also owns one core event
+*               used to post the completion of a deferred request (see USBD_CtrlReqCmpl()). It is not
+*               allocated from the core event pool, but the core task queue must have room for it.
 *********************************************************************************************************
 */
 
@@ -572,10 +578,26 @@ typedef  enum  usbd_err {                                       /* Device error
 #define  USBD_CORE_EVENT_BUS_NBR_TOTAL        (USBD_CFG_MAX_NBR_DEV * USBD_CORE_EVENT_BUS_NBR)
 
                                                                 /* Total number of USB request blocks (URB).            */
-#define  USBD_CORE_EVENT_URB_NBR_TOTAL        (USBD_CFG_MAX_NBR_DEV * (USBD_CFG_MAX_NBR_EP_OPEN + USBD_CFG_MAX_NBR_URB_EXTRA))
+#define  USBD_CORE_EVENT_URB_NBR_TOTAL        (USBD_CFG_MAX_NBR_DEV * (USBD_CFG_MAX_NBR_EP_OPEN   + \
+                                                                       USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                                       USBD_CFG_MAX_NBR_URB_RSVD))
+
+                                                                /* Total number of deferred req events (see Note #2).   */
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+#define  USBD_CORE_EVENT_CTRL_NBR_TOTAL        USBD_CFG_MAX_NBR_DEV
+#else
+#define  USBD_CORE_EVENT_CTRL_NBR_TOTAL                   0u
+#endif
 
 #define  USBD_CORE_EVENT_NBR_TOTAL            (USBD_CORE_EVENT_BUS_NBR_TOTAL + \
-                                               USBD_CORE_EVENT_URB_NBR_TOTAL)
+                                               USBD_CORE_EVENT_URB_NBR_TOTAL + \
+                                               USBD_CORE_EVENT_CTRL_NBR_TOTAL)
+
+                                                                /* Number of core events per controller.                */
+#define  USBD_CORE_EVENT_NBR_DEV              (USBD_CORE_EVENT_BUS_NBR    + \
+                                               USBD_CFG_MAX_NBR_EP_OPEN   + \
+                                               USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                               USBD_CFG_MAX_NBR_URB_RSVD)
 
 
 /*
@@ -915,9 +937,77 @@ typedef  void  (*USBD_ASYNC_FNCT)(CPU_INT08U   dev_nbr,         /* Device number
                                   USBD_ERR     err);            /* Error status.                                        */
 
 
+/*
+*********************************************************************************************************
+*                                      BUFFER SEGMENT DATA TYPE
+*
+* Note(s) : (1) A table of buffer segments describes a single transfer whose data is scattered across
+*               several buffers (e.g. protocol header, payload and trailer). See USBD_BulkTxVec() and
+*               USBD_BulkRxVec().
+*********************************************************************************************************
+*/
+
+typedef  struct  usbd_buf_seg {
+    void        *BufPtr;                                        /* Pointer to segment buffer.                           */
+    CPU_INT32U   BufLen;                                        /* Segment length.                                      */
+} USBD_BUF_SEG;
+
+
+/*
+*********************************************************************************************************
+*                                       DEBUG TRACE DATA TYPES
+*
+* Note(s) : (1) In binary trace mode, each debug event is stored as a fixed-size record :
+*
+*               (a) 'Seq' holds the event sequence number plus one. It is zero while the record has never
+*                   been written or is being written, and is written last.
+*
+*               (b) The message pointer identifies the event. The device never reads the message string :
+*                   the host decoder looks the string up in the firmware image.
+*
+*           (2) The trace header describes the record layout for the host decoder. It is followed in
+*               memory by the record table, so that a RAM dump of 'USBD_DbgTrace' is self-describing.
+*********************************************************************************************************
+*/
+
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+#define  USBD_DBG_TRACE_MAGIC                     0x54425355u   /* 'USBT' in little-endian byte order.                  */
+#define  USBD_DBG_TRACE_VER                                1u
+
+#define  USBD_DBG_TRACE_REC_FLAG_ARG              DEF_BIT_00    /* Rec arg is valid.                                    */
+
+typedef  struct  usbd_dbg_trace_rec {
+           CPU_INT32U   Seq;                                    /* Sequence nbr + 1 (see Note #1a).                     */
+           CPU_INT32U   Ts;                                     /* Timestamp, in CPU TS tmr ticks.                      */
+    const  CPU_CHAR    *MsgPtr;                                 /* Ptr to dbg msg (see Note #1b).                       */
+           CPU_INT32U   Arg;                                    /* Arg associated with dbg msg.                         */
+           CPU_INT16U   Err;                                    /* Err code associated with dbg msg.                    */
+           CPU_INT08U   EP_Addr;                                /* EP addr, or USBD_EP_ADDR_NONE.                       */
+           CPU_INT08U   IF_Nbr;                                 /* IF nbr, or USBD_IF_NBR_NONE.                         */
+           CPU_INT08U   Flags;                                  /* Rec flags.                                           */
+} USBD_DBG_TRACE_REC;
+
+typedef  struct  usbd_dbg_trace_hdr {                           /* See Note #2.                                         */
+           CPU_INT32U   Magic;                                  /* USBD_DBG_TRACE_MAGIC.                                */
+           CPU_INT16U   Ver;                                    /* USBD_DBG_TRACE_VER.                                  */
+           CPU_INT08U   RecSize;                                /* Size of a rec, in octets.                            */
+           CPU_INT08U   PtrSize;                                /* Size of a ptr, in octets.                            */
+           CPU_INT32U   RecNbr;                                 /* Nbr of recs in tbl.                                  */
+           CPU_INT32U   TsFreq;                                 /* Timestamp freq, in Hz (0 if unknown).                */
+} USBD_DBG_TRACE_HDR;
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                        USB DEVICE DRIVER API
+*
+* Note(s) : (1) The vectored endpoint functions are optional and are meant for controllers able to chain
+*               DMA descriptors over several buffers. Drivers that do not provide them leave the fields
+*               null and the core splits the segment table into contiguous transfers. A driver may
+*               accept only part of the table, in which case the returned length MUST be a multiple of
+*               the endpoint maximum packet size; the core transfers the remainder itself.
 *********************************************************************************************************
 */
 
@@ -994,6 +1084,26 @@ struct  usbd_drv_api {
                                 CPU_BOOLEAN   state);
 
     void         (*ISR_Handler)(USBD_DRV     *p_drv);           /* ISR handler.                                         */
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)                         /* ------- OPTIONAL VECTORED XFERS (see Note #1) ------ */
+    CPU_INT32U   (*EP_RxVecStart)(USBD_DRV      *p_drv,         /* EP receive start on segment table.                   */
+                                  CPU_INT08U     ep_addr,
+                                  USBD_BUF_SEG  *p_seg_tbl,
+                                  CPU_INT08U     seg_nbr,
+                                  USBD_ERR      *p_err);
+
+    CPU_INT32U   (*EP_RxVec)     (USBD_DRV      *p_drv,         /* EP receive/read data into segment table.             */
+                                  CPU_INT08U     ep_addr,
+                                  USBD_BUF_SEG  *p_seg_tbl,
+                                  CPU_INT08U     seg_nbr,
+                                  USBD_ERR      *p_err);
+
+    CPU_INT32U   (*EP_TxVec)     (USBD_DRV      *p_drv,         /* EP transmit/start data from segment table.           */
+                                  CPU_INT08U     ep_addr,
+                                  USBD_BUF_SEG  *p_seg_tbl,
+                                  CPU_INT08U     seg_nbr,
+                                  USBD_ERR      *p_err);
+#endif
 };
 
 
@@ -1053,6 +1163,85 @@ struct  usbd_drv_api {
 #define  USBD_EP_IS_IN(ep_addr)                          ((((ep_addr) & USBD_EP_DIR_MASK) != 0u) ? DEF_YES: DEF_NO)
 
 
+/*
+*********************************************************************************************************
+*                                       STATIC DESCRIPTOR MACROS
+*
+* Note(s) : (1) These macros expand to the octets of a standard descriptor. They are used to declare a
+*               configuration descriptor as a constant array, given to USBD_CfgDescStaticSet(). The
+*               class-specific descriptors are inserted as octets where the class driver would write them.
+*
+*           (2) 'total_len' is the length of the whole array. It is usually computed from the
+*               USBD_DESC_LEN_xxx defines. 'cfg_nbr' is the configuration number returned by USBD_CfgAdd().
+*
+*           (3) 'str_ix' is the index of a string added to the device, or 0 if none.
+*
+*           (4) The interfaces and alternate settings must be listed in the order the class drivers add
+*               them. Each endpoint added to an alternate setting takes the address and maximum packet
+*               size of the first free endpoint descriptor of the same type and direction found in this
+*               alternate setting.
+*********************************************************************************************************
+*/
+
+#define  USBD_DESC_STATIC_16(val)                        (CPU_INT08U)( (val)        & DEF_INT_08_MASK),              \
+                                                         (CPU_INT08U)(((val) >> 8u) & DEF_INT_08_MASK)
+
+                                                                /* See Note #2.                                         */
+#define  USBD_DESC_STATIC_CFG(total_len, nbr_if, cfg_nbr, attrib, max_pwr, str_ix)                                   \
+                                                          USBD_DESC_LEN_CFG,                                         \
+                                                          USBD_DESC_TYPE_CONFIGURATION,                              \
+                                                          USBD_DESC_STATIC_16(total_len),                            \
+                                                         (CPU_INT08U)(nbr_if),                                       \
+                                                         (CPU_INT08U)((cfg_nbr) + 1u),                               \
+                                                         (CPU_INT08U)(str_ix),                                       \
+                                                         (CPU_INT08U)(DEF_BIT_07                                   | \
+                                                        ((((attrib) & USBD_DEV_ATTRIB_SELF_POWERED ) != 0u) ?        \
+                                                           DEF_BIT_06 : DEF_BIT_NONE)                              | \
+                                                        ((((attrib) & USBD_DEV_ATTRIB_REMOTE_WAKEUP) != 0u) ?        \
+                                                           DEF_BIT_05 : DEF_BIT_NONE)),                              \
+                                                         (CPU_INT08U)(((max_pwr) + 1u) / 2u)
+
+#define  USBD_DESC_STATIC_IAD(if_start, if_cnt, class_code, class_sub_code, class_protocol_code, str_ix)             \
+                                                          USBD_DESC_LEN_IF_ASSOCIATION,                              \
+                                                          USBD_DESC_TYPE_IAD,                                        \
+                                                         (CPU_INT08U)(if_start),                                     \
+                                                         (CPU_INT08U)(if_cnt),                                       \
+                                                         (CPU_INT08U)(class_code),                                   \
+                                                         (CPU_INT08U)(class_sub_code),                               \
+                                                         (CPU_INT08U)(class_protocol_code),                          \
+                                                         (CPU_INT08U)(str_ix)
+
+#define  USBD_DESC_STATIC_IF(if_nbr, if_alt_nbr, nbr_ep, class_code, class_sub_code, class_protocol_code, str_ix)    \
+                                                          USBD_DESC_LEN_IF,                                          \
+                                                          USBD_DESC_TYPE_INTERFACE,                                  \
+                                                         (CPU_INT08U)(if_nbr),                                       \
+                                                         (CPU_INT08U)(if_alt_nbr),                                   \
+                                                         (CPU_INT08U)(nbr_ep),                                       \
+                                                         (CPU_INT08U)(class_code),                                   \
+                                                         (CPU_INT08U)(class_sub_code),                               \
+                                                         (CPU_INT08U)(class_protocol_code),                          \
+                                                         (CPU_INT08U)(str_ix)
+
+#define  USBD_DESC_STATIC_EP(ep_addr, attrib, max_pkt_size, interval)                                                \
+                                                          USBD_DESC_LEN_EP,                                          \
+                                                          USBD_DESC_TYPE_ENDPOINT,                                   \
+                                                         (CPU_INT08U)(ep_addr),                                      \
+                                                         (CPU_INT08U)(attrib),                                       \
+                                                          USBD_DESC_STATIC_16(max_pkt_size),                         \
+                                                         (CPU_INT08U)(interval)
+
+                                                                /* EP desc on audio class v1.0 has 2 additional fields. */
+#define  USBD_DESC_STATIC_EP_AUDIO(ep_addr, attrib, max_pkt_size, interval, sync_refresh, sync_addr)                 \
+                                                         (CPU_INT08U)(USBD_DESC_LEN_EP + 2u),                        \
+                                                          USBD_DESC_TYPE_ENDPOINT,                                   \
+                                                         (CPU_INT08U)(ep_addr),                                      \
+                                                         (CPU_INT08U)(attrib),                                       \
+                                                          USBD_DESC_STATIC_16(max_pkt_size),                         \
+                                                         (CPU_INT08U)(interval),                                     \
+                                                         (CPU_INT08U)(sync_refresh),                                 \
+                                                         (CPU_INT08U)(sync_addr)
+
+
 /*
 *********************************************************************************************************
 *                                         DEBUG TRACE MACROS
@@ -1092,12 +1281,54 @@ struct  usbd_drv_api {
 /*
 *********************************************************************************************************
 *                                              DEBUG STATS
+*
+* Note(s) : (1) Each transfer completed without error on an endpoint is split in the following stages,
+*               each measured in CPU timestamp ticks :
+*
+*               (a) USBD_DBG_STATS_LAT_SUBMIT   From the transfer submission to the core, to the first call
+*                                               to the driver to start the transfer.
+*
+*               (b) USBD_DBG_STATS_LAT_XFER     From the first call to the driver to start the transfer, to
+*                                               the last completion notification from the driver.
+*
+*               (c) USBD_DBG_STATS_LAT_CMPL     From the last completion notification from the driver, to
+*                                               the call of the asynchronous callback or to the return of
+*                                               the synchronous transfer function.
+*
+*               (d) USBD_DBG_STATS_LAT_TOTAL    Sum of the three stages above.
+*
+*           (2) The throughput meter counts the octets transferred over a window of
+*               USBD_CFG_DBG_STATS_RATE_WIN_MS milliseconds. The rate reported is the one of the last
+*               window completed, or of the current window if it is already longer than that.
+*
+*           (3) The statistics counters wrap around according to USBD_CFG_DBG_STATS_CNT_TYPE. The latency
+*               and throughput statistics do not use this type, so that they can be accumulated over
+*               long periods.
 *********************************************************************************************************
 */
 
 #if (USBD_CFG_DBG_STATS_EN == DEF_ENABLED)
 typedef  USBD_CFG_DBG_STATS_CNT_TYPE  USBD_DBG_STATS_CNT;       /* Adjust size of the stats cntrs.                      */
 
+#if (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED)
+#define  USBD_DBG_STATS_LAT_SUBMIT                         0u   /* Latency stages (see Note #1).                        */
+#define  USBD_DBG_STATS_LAT_XFER                           1u
+#define  USBD_DBG_STATS_LAT_CMPL                           2u
+#define  USBD_DBG_STATS_LAT_TOTAL                          3u
+#define  USBD_DBG_STATS_LAT_NBR_STAGE                      4u
+
+
+typedef  struct  usbd_dbg_stats_ep_perf {                       /* ------------- EP LATENCY & THROUGHPUT -------------- */
+    CPU_INT32U          LatHist[USBD_DBG_STATS_LAT_NBR_STAGE][USBD_CFG_DBG_STATS_LAT_NBR_BUCKET];
+    CPU_INT32U          LatMax[USBD_DBG_STATS_LAT_NBR_STAGE];   /* Max latency per stage, in TS ticks.                  */
+    CPU_INT32U          XferNbr;                                /* Nbr of xfers measured.                               */
+    CPU_INT64U          OctetCnt;                               /* Nbr of octets xfer'd.                                */
+    CPU_TS              RateWinStartTs;                         /* Start of curr throughput window (see Note #2).       */
+    CPU_INT32U          RateWinOctetCnt;                        /* Nbr of octets xfer'd in curr throughput window.      */
+    CPU_INT32U          Rate;                                   /* Throughput of last window, in octets per sec.        */
+} USBD_DBG_STATS_EP_PERF;
+#endif
+
 
 typedef  struct  usbd_dev_stats {                               /* ------------------- DEVICE STATS ------------------- */
     CPU_INT08U          DevNbr;                                 /* Dev nbr associated with stat struct.                 */
@@ -1125,6 +1356,10 @@ typedef  struct  usbd_dev_stats {                               /* -------------
     USBD_DBG_STATS_CNT  CtrlRxSyncSuccessNbr;                   /* Nbr of sync ctrl rx exec'd successfully.             */
     USBD_DBG_STATS_CNT  CtrlTxSyncExecNbr;                      /* Nbr of sync ctrl tx exec'd.                          */
     USBD_DBG_STATS_CNT  CtrlTxSyncSuccessNbr;                   /* Nbr of sync ctrl tx exec'd successfully.             */
+    USBD_DBG_STATS_CNT  CtrlRxAsyncExecNbr;                     /* Nbr of async ctrl rx exec'd.                         */
+    USBD_DBG_STATS_CNT  CtrlRxAsyncSuccessNbr;                  /* Nbr of async ctrl rx exec'd successfully.            */
+    USBD_DBG_STATS_CNT  CtrlTxAsyncExecNbr;                     /* Nbr of async ctrl tx exec'd.                         */
+    USBD_DBG_STATS_CNT  CtrlTxAsyncSuccessNbr;                  /* Nbr of async ctrl tx exec'd successfully.            */
     USBD_DBG_STATS_CNT  CtrlRxStatusExecNbr;                    /* Nbr of sync ctrl rx status exec'd.                   */
     USBD_DBG_STATS_CNT  CtrlRxStatusSuccessNbr;                 /* Nbr of sync ctrl rx status exec'd successfully.      */
     USBD_DBG_STATS_CNT  CtrlTxStatusExecNbr;                    /* Nbr of sync ctrl tx status exec'd.                   */
@@ -1199,6 +1434,14 @@ typedef  struct  usbd_ep_stats {                                /* -------------
     USBD_DBG_STATS_CNT  DrvTxZLP_SuccessNbr;                    /* Nbr of successful call to drv's TxZLP().             */
     USBD_DBG_STATS_CNT  TxCmplNbr;                              /* Nbr of            call to TxCmpl().                  */
     USBD_DBG_STATS_CNT  TxCmplErrNbr;                           /* Nbr of successful call to TxCmpl().                  */
+
+    USBD_DBG_STATS_CNT  URB_RsvdGetNbr;                         /* Nbr of xfers queued using a reserved URB.            */
+    USBD_DBG_STATS_CNT  URB_ExtraGetNbr;                        /* Nbr of xfers queued using a shared extra URB.        */
+    USBD_DBG_STATS_CNT  URB_QueuingErrNbr;                      /* Nbr of xfers denied because no URB was avail.        */
+
+#if (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED)
+    USBD_DBG_STATS_EP_PERF  Perf;                               /* Latency hist and throughput (see Note #1).           */
+#endif
 } USBD_DBG_STATS_EP;
 
 extern  USBD_DBG_STATS_DEV  USBD_DbgStatsDevTbl[USBD_CFG_MAX_NBR_DEV];
@@ -1340,6 +1583,13 @@ void             USBD_CfgOtherSpeed      (       CPU_INT08U         dev_nbr,
                                                  USBD_ERR          *p_err);
 #endif
 
+#if (USBD_CFG_DESC_STATIC_EN == DEF_ENABLED)
+void             USBD_CfgDescStaticSet   (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         cfg_nbr,
+                                          const  CPU_INT08U        *p_desc,
+                                                 USBD_ERR          *p_err);
+#endif
+
                                                                 /* --------------- INTERFACE OPERATIONS --------------- */
 CPU_INT08U       USBD_IF_Add             (       CPU_INT08U         dev_nbr,
                                                  CPU_INT08U         cfg_nbr,
@@ -1359,6 +1609,13 @@ CPU_INT08U       USBD_IF_AltAdd          (       CPU_INT08U         dev_nbr,
                                           const  CPU_CHAR          *p_name,
                                                  USBD_ERR          *p_err);
 
+void             USBD_IF_AltProtocolSet  (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         cfg_nbr,
+                                                 CPU_INT08U         if_nbr,
+                                                 CPU_INT08U         if_alt_nbr,
+                                                 CPU_INT08U         class_protocol_code,
+                                                 USBD_ERR          *p_err);
+
 #if (USBD_CFG_MAX_NBR_IF_GRP > 0)
 CPU_INT08U       USBD_IF_Grp             (       CPU_INT08U         dev_nbr,
                                                  CPU_INT08U         cfg_nbr,
@@ -1412,6 +1669,16 @@ void             USBD_DescWr             (       CPU_INT08U         dev_nbr,
                                           const  CPU_INT08U        *p_buf,
                                                  CPU_INT16U         len);
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+CPU_INT16U       USBD_CtrlReqDefer       (       CPU_INT08U         dev_nbr,
+                                                 USBD_ERR          *p_err);
+
+void             USBD_CtrlReqCmpl        (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT16U         req_seq,
+                                                 CPU_BOOLEAN        valid,
+                                                 USBD_ERR          *p_err);
+#endif
+
                                                                 /* ---------------- ENDPOINT OPERATIONS --------------- */
 CPU_INT32U       USBD_CtrlTx             (       CPU_INT08U         dev_nbr,
                                                  void              *p_buf,
@@ -1426,6 +1693,23 @@ CPU_INT32U       USBD_CtrlRx             (       CPU_INT08U         dev_nbr,
                                                  CPU_INT16U         timeout_ms,
                                                  USBD_ERR          *p_err);
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void             USBD_CtrlTxAsync        (       CPU_INT08U         dev_nbr,
+                                                 void              *p_buf,
+                                                 CPU_INT32U         buf_len,
+                                                 USBD_ASYNC_FNCT    async_fnct,
+                                                 void              *p_async_arg,
+                                                 CPU_BOOLEAN        end,
+                                                 USBD_ERR          *p_err);
+
+void             USBD_CtrlRxAsync        (       CPU_INT08U         dev_nbr,
+                                                 void              *p_buf,
+                                                 CPU_INT32U         buf_len,
+                                                 USBD_ASYNC_FNCT    async_fnct,
+                                                 void              *p_async_arg,
+                                                 USBD_ERR          *p_err);
+#endif
+
                                                                 /* -------------- BULK TRANFER FUNCTIONS -------------- */
 CPU_INT08U       USBD_BulkAdd            (       CPU_INT08U         dev_nbr,
                                                  CPU_INT08U         cfg_nbr,
@@ -1467,6 +1751,40 @@ void             USBD_BulkTxAsync        (       CPU_INT08U         dev_nbr,
                                                  CPU_BOOLEAN        end,
                                                  USBD_ERR          *p_err);
 
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+CPU_INT32U       USBD_BulkRxVec          (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_BUF_SEG      *p_seg_tbl,
+                                                 CPU_INT08U         seg_nbr,
+                                                 CPU_INT16U         timeout_ms,
+                                                 USBD_ERR          *p_err);
+
+void             USBD_BulkRxVecAsync     (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_BUF_SEG      *p_seg_tbl,
+                                                 CPU_INT08U         seg_nbr,
+                                                 USBD_ASYNC_FNCT    async_fnct,
+                                                 void              *p_async_arg,
+                                                 USBD_ERR          *p_err);
+
+CPU_INT32U       USBD_BulkTxVec          (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_BUF_SEG      *p_seg_tbl,
+                                                 CPU_INT08U         seg_nbr,
+                                                 CPU_INT16U         timeout_ms,
+                                                 CPU_BOOLEAN        end,
+                                                 USBD_ERR          *p_err);
+
+void             USBD_BulkTxVecAsync     (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_BUF_SEG      *p_seg_tbl,
+                                                 CPU_INT08U         seg_nbr,
+                                                 USBD_ASYNC_FNCT    async_fnct,
+                                                 void              *p_async_arg,
+                                                 CPU_BOOLEAN        end,
+                                                 USBD_ERR          *p_err);
+#endif
+
                                                                 /* ------------ INTERRUPT TRANFER FUNCTIONS ----------- */
 CPU_INT08U       USBD_IntrAdd            (       CPU_INT08U         dev_nbr,
                                                  CPU_INT08U         cfg_nbr,
@@ -1597,6 +1915,16 @@ CPU_INT08U       USBD_EP_MaxPhyNbrGet    (       CPU_INT08U         dev_nbr);
 
 CPU_INT08U       USBD_EP_MaxNbrOpenGet   (       CPU_INT08U         dev_nbr);
 
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+void             USBD_EP_URB_RsvdSet     (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         cfg_nbr,
+                                                 CPU_INT08U         if_nbr,
+                                                 CPU_INT08U         if_alt_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 CPU_INT08U         urb_nbr,
+                                                 USBD_ERR          *p_err);
+#endif
+
                                                                 /* -------------- DEVICE DRIVER CALLBACKS ------------- */
 void             USBD_EventConn          (       USBD_DRV          *p_drv);
 
@@ -1631,6 +1959,34 @@ void             USBD_DbgArg             (const  CPU_CHAR          *p_msg,
 void             USBD_Trace              (const  CPU_CHAR          *p_str);
 #endif
 
+#if ((USBD_CFG_DBG_TRACE_EN     == DEF_ENABLED) && \
+     (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED))
+CPU_INT32U       USBD_DbgTraceRd         (       CPU_INT32U        *p_seq,
+                                                 USBD_DBG_TRACE_REC *p_rec_tbl,
+                                                 CPU_INT32U         rec_nbr);
+
+const  USBD_DBG_TRACE_HDR  *USBD_DbgTraceHdrGet(       void                    );
+#endif
+
+#if ((USBD_CFG_DBG_STATS_EN      == DEF_ENABLED) && \
+     (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED))
+void             USBD_DbgStatsEP_PerfSnapshot(   CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_DBG_STATS_EP_PERF  *p_perf,
+                                                 CPU_BOOLEAN        reset,
+                                                 USBD_ERR          *p_err);
+
+CPU_INT32U       USBD_DbgStatsEP_LatGet  (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 CPU_INT08U         stage,
+                                                 CPU_INT08U         pct,
+                                                 USBD_ERR          *p_err);
+
+CPU_INT32U       USBD_DbgStatsEP_RateGet (       CPU_INT08U         dev_nbr,
+                                                 CPU_INT08U         ep_addr,
+                                                 USBD_ERR          *p_err);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -1705,6 +2061,67 @@ void             USBD_Trace              (const  CPU_CHAR          *p_str);
 #error  "USBD_CFG_MAX_NBR_URB_EXTRA not #define'd in 'usbd_cfg.h' [MUST be >= 0]"
 #endif
 
+#ifndef  USBD_CFG_MAX_NBR_URB_RSVD
+#error  "USBD_CFG_MAX_NBR_URB_RSVD not #define'd in 'usbd_cfg.h' [MUST be >= 0]"
+#endif
+
+#ifndef  USBD_CFG_EP_VEC_EN
+#error  "USBD_CFG_EP_VEC_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_EP_VEC_EN != DEF_DISABLED) && \
+        (USBD_CFG_EP_VEC_EN != DEF_ENABLED ))
+#error  "USBD_CFG_EP_VEC_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+#endif
+
+#ifndef  USBD_CFG_EP_SYNC_URB_EN
+#error  "USBD_CFG_EP_SYNC_URB_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_EP_SYNC_URB_EN != DEF_DISABLED) && \
+        (USBD_CFG_EP_SYNC_URB_EN != DEF_ENABLED ))
+#error  "USBD_CFG_EP_SYNC_URB_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+#endif
+
+#ifndef  USBD_CFG_DESC_CACHE_EN
+#error  "USBD_CFG_DESC_CACHE_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_DESC_CACHE_EN != DEF_DISABLED) && \
+        (USBD_CFG_DESC_CACHE_EN != DEF_ENABLED ))
+#error  "USBD_CFG_DESC_CACHE_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif   (USBD_CFG_DESC_CACHE_EN == DEF_ENABLED)
+#ifndef  USBD_CFG_DESC_CACHE_LEN
+#error  "USBD_CFG_DESC_CACHE_LEN not #define'd in 'usbd_cfg.h' [MUST be >= 9 && <= 65535]"
+
+#elif  ((USBD_CFG_DESC_CACHE_LEN <     9u) || \
+        (USBD_CFG_DESC_CACHE_LEN > 65535u))
+#error  "USBD_CFG_DESC_CACHE_LEN illegally #define'd in 'usbd_cfg.h' [MUST be >= 9 && <= 65535]"
+#endif
+#endif
+
+#ifndef  USBD_CFG_DESC_STATIC_EN
+#error  "USBD_CFG_DESC_STATIC_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_DESC_STATIC_EN != DEF_DISABLED) && \
+        (USBD_CFG_DESC_STATIC_EN != DEF_ENABLED ))
+#error  "USBD_CFG_DESC_STATIC_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+#endif
+
+#ifndef  USBD_CFG_CTRL_ASYNC_EN
+#error  "USBD_CFG_CTRL_ASYNC_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_CTRL_ASYNC_EN != DEF_DISABLED) && \
+        (USBD_CFG_CTRL_ASYNC_EN != DEF_ENABLED ))
+#error  "USBD_CFG_CTRL_ASYNC_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+#endif
+
+#ifndef  USBD_CFG_CORE_EVENT_RING_EN
+#error  "USBD_CFG_CORE_EVENT_RING_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_CORE_EVENT_RING_EN != DEF_DISABLED) && \
+        (USBD_CFG_CORE_EVENT_RING_EN != DEF_ENABLED ))
+#error  "USBD_CFG_CORE_EVENT_RING_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+#endif
+
 #ifndef  USBD_CFG_MAX_NBR_STR
 #error  "USBD_CFG_MAX_NBR_STR not #define'd in 'usbd_cfg.h' [MUST be >= 0]"
 
@@ -1746,6 +2163,49 @@ void             USBD_Trace              (const  CPU_CHAR          *p_str);
 #elif   (USBD_CFG_DBG_TRACE_NBR_EVENTS  < 1u)
 #error  "USBD_CFG_DBG_TRACE_NBR_EVENTS not #define'd in 'usbd_cfg.h' [MUST be > 0]"
 #endif
+
+#ifndef  USBD_CFG_DBG_TRACE_BIN_EN
+#error  "USBD_CFG_DBG_TRACE_BIN_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_DBG_TRACE_BIN_EN != DEF_DISABLED) && \
+        (USBD_CFG_DBG_TRACE_BIN_EN != DEF_ENABLED ))
+#error  "USBD_CFG_DBG_TRACE_BIN_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif   (USBD_CFG_DBG_TRACE_BIN_EN == DEF_ENABLED)
+#ifndef  USBD_CFG_DBG_TRACE_BIN_NBR_REC
+#error  "USBD_CFG_DBG_TRACE_BIN_NBR_REC not #define'd in 'usbd_cfg.h' [MUST be a power of 2]"
+
+#elif  ((USBD_CFG_DBG_TRACE_BIN_NBR_REC < 1u) || \
+       ((USBD_CFG_DBG_TRACE_BIN_NBR_REC & (USBD_CFG_DBG_TRACE_BIN_NBR_REC - 1u)) != 0u))
+#error  "USBD_CFG_DBG_TRACE_BIN_NBR_REC illegally #define'd in 'usbd_cfg.h' [MUST be a power of 2]"
+#endif
+#endif
+#endif
+
+#if     (USBD_CFG_DBG_STATS_EN == DEF_ENABLED)
+#ifndef  USBD_CFG_DBG_STATS_PERF_EN
+#error  "USBD_CFG_DBG_STATS_PERF_EN not #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif  ((USBD_CFG_DBG_STATS_PERF_EN != DEF_DISABLED) && \
+        (USBD_CFG_DBG_STATS_PERF_EN != DEF_ENABLED ))
+#error  "USBD_CFG_DBG_STATS_PERF_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED || DEF_ENABLED]"
+
+#elif   (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED)
+#ifndef  USBD_CFG_DBG_STATS_LAT_NBR_BUCKET
+#error  "USBD_CFG_DBG_STATS_LAT_NBR_BUCKET not #define'd in 'usbd_cfg.h' [MUST be >= 2 && <= 33]"
+
+#elif  ((USBD_CFG_DBG_STATS_LAT_NBR_BUCKET <  2u) || \
+        (USBD_CFG_DBG_STATS_LAT_NBR_BUCKET > 33u))
+#error  "USBD_CFG_DBG_STATS_LAT_NBR_BUCKET illegally #define'd in 'usbd_cfg.h' [MUST be >= 2 && <= 33]"
+#endif
+
+#ifndef  USBD_CFG_DBG_STATS_RATE_WIN_MS
+#error  "USBD_CFG_DBG_STATS_RATE_WIN_MS not #define'd in 'usbd_cfg.h' [MUST be > 0]"
+
+#elif   (USBD_CFG_DBG_STATS_RATE_WIN_MS < 1u)
+#error  "USBD_CFG_DBG_STATS_RATE_WIN_MS illegally #define'd in 'usbd_cfg.h' [MUST be > 0]"
+#endif
+#endif
 #endif
 
 
@@ -38,6 +38,7 @@
 
 #define    MICRIUM_SOURCE
 #include  "usbd_core.h"
+#include  <cpu_core.h>
 #include  "usbd_internal.h"
 
 
@@ -50,11 +51,40 @@
 #define  USBD_EP_ADDR_CTRL_OUT                          0x00u
 #define  USBD_EP_ADDR_CTRL_IN                           0x80u
 
-#define  USBD_URB_MAX_NBR                      (USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                                /* Nbr of URBs that can be queued on top of main URBs.  */
+#define  USBD_URB_QUEUED_MAX_NBR               (USBD_CFG_MAX_NBR_URB_EXTRA + \
+                                                USBD_CFG_MAX_NBR_URB_RSVD)
+
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)                              /* One spare URB per EP to lend (see USBD_URB_Get()).   */
+#define  USBD_URB_LENT_MAX_NBR                  USBD_CFG_MAX_NBR_EP_OPEN
+#else
+#define  USBD_URB_LENT_MAX_NBR                            0u
+#endif
+
+#define  USBD_URB_MAX_NBR                      (USBD_URB_QUEUED_MAX_NBR  + \
+                                                USBD_URB_LENT_MAX_NBR    + \
                                                 USBD_CFG_MAX_NBR_EP_OPEN)
 
 #define  USBD_URB_FLAG_XFER_END                 DEF_BIT_00      /* Flag indicating if xfer requires a ZLP to complete.  */
 #define  USBD_URB_FLAG_EXTRA_URB                DEF_BIT_01      /* Flag indicating if the URB is an 'extra' URB.        */
+#define  USBD_URB_FLAG_RSVD_URB                 DEF_BIT_02      /* Flag indicating if the URB is a 'reserved' URB.      */
+#define  USBD_URB_FLAG_VEC                      DEF_BIT_03      /* Flag indicating if the URB describes a seg tbl.      */
+#define  USBD_URB_FLAG_VEC_DRV                  DEF_BIT_04      /* Flag indicating if drv handles the seg tbl itself.   */
+
+#if ((USBD_CFG_DBG_STATS_EN      == DEF_ENABLED) && \
+     (USBD_CFG_DBG_STATS_PERF_EN == DEF_ENABLED))
+#define  USBD_EP_DBG_STATS_PERF_EN              DEF_ENABLED
+#else
+#define  USBD_EP_DBG_STATS_PERF_EN              DEF_DISABLED
+#endif
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)                         /* Len of bounce buf used by vectored xfers.            */
+#if (USBD_CFG_HS_EN == DEF_ENABLED)
+#define  USBD_EP_VEC_BUF_LEN                    512u            /* Bulk max pkt size at high-speed.                     */
+#else
+#define  USBD_EP_VEC_BUF_LEN                     64u            /* Bulk max pkt size at full-speed.                     */
+#endif
+#endif
 
 
 /*
@@ -125,7 +155,15 @@ typedef  enum  usbd_urb_state {
 *
 * Note(s): (1) The 'Flags' field is used as a bitmap. The following bits are used:
 *
-*                   D7..2 Reserved (reset to zero)
+*                   D7..5 Reserved (reset to zero)
+*                   D4    Driver vectored transfer:
+*                               If this bit is set, the driver has been given the whole segment table
+*                               through its vectored functions.
+*                   D3    Vectored transfer:
+*                               If this bit is set, the URB describes a table of buffer segments rather
+*                               than a single buffer (see Note #2).
+*                   D2    Reserved URB:
+*                               If this bit is set, this URB was taken from the endpoint's reservation.
 *                   D1    End-of-transfer:
 *                               If this bit is set and transfer length is multiple of maximum packet
 *                               size, a zero-length packet is transferred to indicate a short transfer to
@@ -136,6 +174,10 @@ typedef  enum  usbd_urb_state {
 *                               indicates that this URB is 'reserved' to allow every endpoint to have at
 *                               least one URB available at any time.
 *
+*               (2) For a vectored transfer, 'BufPtr' points to the segment table, which is what the
+*                   asynchronous callback receives, and 'BufLen' is the total length of all segments.
+*                   'SegIx' and 'SegBaseLen' cache the segment holding octet 'XferLen' so that the
+*                   table is walked only once over the whole transfer.
 *********************************************************************************************************
 */
 
@@ -149,6 +191,16 @@ typedef  struct  usbd_urb {
     USBD_ASYNC_FNCT    AsyncFnct;                               /* Asynchronous notification function.                  */
     void              *AsyncFnctArg;                            /* Asynchronous function argument.                      */
     USBD_ERR           Err;                                     /* Error passed to callback, if any.                    */
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    USBD_BUF_SEG      *SegTblPtr;                               /* Pointer to segment table (see Note #2).              */
+    CPU_INT08U         SegNbr;                                  /* Number of segments in table.                         */
+    CPU_INT08U         SegIx;                                   /* Index of current segment.                            */
+    CPU_INT32U         SegBaseLen;                              /* Xfer len at start of current segment.                */
+#endif
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_TS             StatsSubmitTs;                           /* TS of xfer submission.                               */
+    CPU_TS             StatsStartTs;                            /* TS of first drv xfer start.                          */
+#endif
     struct  usbd_urb  *NextPtr;                                 /* Pointer to next     URB in list.                     */
 } USBD_URB;
 
@@ -156,6 +208,16 @@ typedef  struct  usbd_urb {
 /*
 *********************************************************************************************************
 *                                         ENDPOINT DATA TYPE
+*
+* Note(s): (1) A synchronous transfer requires the endpoint to be idle and holds the endpoint until it
+*              completes, so at most one synchronous URB is ever in use per endpoint. When
+*              USBD_CFG_EP_SYNC_URB_EN is DEF_ENABLED, that URB is embedded in the endpoint and is never
+*              taken from the URB pool nor queued on the endpoint (see USBD_URB_SyncGet()).
+*
+*          (2) 'URB_MainLent' is set when an URB is given to the endpoint in place of its main URB, while
+*              the main URB is still held by a completion being processed (see USBD_URB_Get() Note #2).
+*              The first of the two URBs freed then returns to the pool without making the main URB
+*              available again.
 *********************************************************************************************************
 */
 
@@ -168,11 +230,25 @@ typedef  struct  usbd_ep {
     CPU_INT08U        Interval;                                 /* Interval.                                            */
     CPU_INT08U        TransPerFrame;                            /* Transaction per microframe (HS only).                */
     CPU_INT08U        Ix;                                       /* Allocation index.                                    */
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)
     CPU_BOOLEAN       URB_MainAvail;                            /* Flag indicating if main URB associated to EP avail.  */
+    CPU_BOOLEAN       URB_MainLent;                             /* Flag indicating if main URB was lent (see Note #2).  */
+#endif
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+    CPU_INT08U        URB_RsvdNbr;                              /* Nbr of URBs reserved for EP.                         */
+    CPU_INT08U        URB_RsvdUsedCtr;                          /* Nbr of reserved URBs currently used by EP.           */
 #endif
     USBD_URB         *URB_HeadPtr;                              /* USB request block head of the list.                  */
     USBD_URB         *URB_TailPtr;                              /* USB request block tail of the list.                  */
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    CPU_INT08U       *VecBufPtr;                                /* Bounce buf for pkts straddling two segments.         */
+#endif
+#if (USBD_CFG_EP_SYNC_URB_EN == DEF_ENABLED)
+    USBD_URB          URB_Sync;                                 /* URB used by sync xfers (see Note #1).                */
+#endif
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_TS            StatsCmplTs;                              /* TS of last drv xfer cmpl notification.               */
+#endif
 } USBD_EP;
 
 
@@ -234,6 +310,10 @@ static  CPU_INT08U          USBD_URB_ExtraCtr[USBD_CFG_MAX_NBR_DEV];   /* Nbr of
 #if (USBD_CFG_DBG_STATS_EN == DEF_ENABLED)
         USBD_DBG_STATS_EP   USBD_DbgStatsEP_Tbl[USBD_CFG_MAX_NBR_DEV][USBD_CFG_MAX_NBR_EP_OPEN];
 #endif
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+static  CPU_INT32U          USBD_EP_DbgStatsTsFreq;             /* CPU TS freq, in Hz.                                  */
+static  CPU_INT32U          USBD_EP_DbgStatsRateWinTs;          /* Throughput window len, in TS ticks.                  */
+#endif
 
 
 /*
@@ -245,21 +325,34 @@ static  CPU_INT08U          USBD_URB_ExtraCtr[USBD_CFG_MAX_NBR_DEV];   /* Nbr of
 static  void          USBD_EP_RxStartAsyncProcess(USBD_DRV         *p_drv,
                                                   USBD_EP          *p_ep,
                                                   USBD_URB         *p_urb,
-                                                  CPU_INT08U       *p_buf_cur,
-                                                  CPU_INT32U        len,
                                                   USBD_ERR         *p_err);
 
 static  void          USBD_EP_TxAsyncProcess     (USBD_DRV         *p_drv,
                                                   USBD_EP          *p_ep,
                                                   USBD_URB         *p_urb,
-                                                  CPU_INT08U       *p_buf_cur,
-                                                  CPU_INT32U        len,
+                                                  USBD_ERR         *p_err);
+
+static  CPU_BOOLEAN   USBD_EP_RxXferStart        (USBD_DRV         *p_drv,
+                                                  USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb,
+                                                  USBD_ERR         *p_err);
+
+static  CPU_INT32U    USBD_EP_RxXferRd           (USBD_DRV         *p_drv,
+                                                  USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb,
+                                                  USBD_ERR         *p_err);
+
+static  CPU_BOOLEAN   USBD_EP_TxXferStart        (USBD_DRV         *p_drv,
+                                                  USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb,
                                                   USBD_ERR         *p_err);
 
 static  CPU_INT32U    USBD_EP_Rx                 (USBD_DRV         *p_drv,
                                                   USBD_EP          *p_ep,
                                                   void             *p_buf,
                                                   CPU_INT32U        buf_len,
+                                                  USBD_BUF_SEG     *p_seg_tbl,
+                                                  CPU_INT08U        seg_nbr,
                                                   USBD_ASYNC_FNCT   async_fnct,
                                                   void             *p_async_arg,
                                                   CPU_INT16U        timeout_ms,
@@ -269,6 +362,8 @@ static  CPU_INT32U    USBD_EP_Tx                 (USBD_DRV         *p_drv,
                                                   USBD_EP          *p_ep,
                                                   void             *p_buf,
                                                   CPU_INT32U        buf_len,
+                                                  USBD_BUF_SEG     *p_seg_tbl,
+                                                  CPU_INT08U        seg_nbr,
                                                   USBD_ASYNC_FNCT   async_fnct,
                                                   void             *p_async_arg,
                                                   CPU_INT16U        timeout_ms,
@@ -286,6 +381,14 @@ static  void          USBD_URB_AsyncEnd          (CPU_INT08U        dev_nbr,
                                                   USBD_EP          *p_ep,
                                                   USBD_URB         *p_urb_head);
 
+static  USBD_URB     *USBD_URB_SyncGet           (CPU_INT08U        dev_nbr,
+                                                  USBD_EP          *p_ep,
+                                                  USBD_ERR         *p_err);
+
+static  void          USBD_URB_SyncFree          (CPU_INT08U        dev_nbr,
+                                                  USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb);
+
 static  void          USBD_URB_Free              (CPU_INT08U        dev_nbr,
                                                   USBD_EP          *p_ep,
                                                   USBD_URB         *p_urb);
@@ -299,6 +402,31 @@ static  void          USBD_URB_Queue             (USBD_EP          *p_ep,
 
 static  void          USBD_URB_Dequeue           (USBD_EP          *p_ep);
 
+static  CPU_INT08U   *USBD_URB_BufCurGet         (USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb,
+                                                  CPU_BOOLEAN       gather,
+                                                  CPU_INT32U       *p_len);
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+static  CPU_INT32U    USBD_URB_VecLenGet         (USBD_BUF_SEG     *p_seg_tbl,
+                                                  CPU_INT08U        seg_nbr,
+                                                  USBD_ERR         *p_err);
+
+static  void          USBD_URB_VecBufScatter     (USBD_EP          *p_ep,
+                                                  USBD_URB         *p_urb,
+                                                  CPU_INT32U        len);
+#endif
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+static  void          USBD_EP_DbgStatsPerfRec    (CPU_INT08U        dev_nbr,
+                                                  USBD_EP          *p_ep,
+                                                  CPU_TS            submit_ts,
+                                                  CPU_TS            start_ts,
+                                                  CPU_INT32U        xfer_len);
+
+static  CPU_INT32U    USBD_EP_DbgStatsTsToUs     (CPU_INT32U        ts);
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -306,6 +434,13 @@ static  void          USBD_URB_Dequeue           (USBD_EP          *p_ep);
 *********************************************************************************************************
 */
 
+#if  (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+#if ((!defined(CPU_CFG_TS_TMR_EN)) || \
+      (CPU_CFG_TS_TMR_EN != DEF_ENABLED))
+#error  "USBD_CFG_DBG_STATS_PERF_EN illegally #define'd in 'usbd_cfg.h' [MUST be DEF_DISABLED when CPU_CFG_TS_TMR_EN is DEF_DISABLED]"
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -426,6 +561,8 @@ CPU_INT32U  USBD_BulkRx (CPU_INT08U   dev_nbr,
                                            p_ep,
                                            p_buf,
                                            buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
                           (USBD_ASYNC_FNCT)0,
                           (void          *)0,
                                            timeout_ms,
@@ -556,6 +693,8 @@ void  USBD_BulkRxAsync (CPU_INT08U        dev_nbr,
                      p_ep,
                      p_buf,
                      buf_len,
+                     (USBD_BUF_SEG *)0,
+                     0u,
                      async_fnct,
                      p_async_arg,
                      0u,
@@ -685,6 +824,8 @@ CPU_INT32U  USBD_BulkTx (CPU_INT08U    dev_nbr,
                                            p_ep,
                                            p_buf,
                                            buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
                           (USBD_ASYNC_FNCT)0,
                           (void          *)0,
                                            timeout_ms,
@@ -822,6 +963,8 @@ void  USBD_BulkTxAsync (CPU_INT08U        dev_nbr,
                     p_ep,
                     p_buf,
                     buf_len,
+                    (USBD_BUF_SEG *)0,
+                    0u,
                     async_fnct,
                     p_async_arg,
                     0u,
@@ -837,25 +980,17 @@ void  USBD_BulkTxAsync (CPU_INT08U        dev_nbr,
 
 /*
 *********************************************************************************************************
-*********************************************************************************************************
-*                                    INTERRUPT TRANSFER FUNCTIONS
-*********************************************************************************************************
-*********************************************************************************************************
-*/
-
-/*
-*********************************************************************************************************
-*                                            USBD_IntrRx()
+*                                          USBD_BulkRxVec()
 *
-* Description : Receive data on Interrupt OUT endpoint.
+* Description : Receive data on Bulk OUT endpoint into a table of buffer segments.
 *
 * Argument(s) : dev_nbr     Device number.
 *
 *               ep_addr     Endpoint address.
 *
-*               p_buf       Pointer to destination buffer to receive data (see Note #2).
+*               p_seg_tbl   Pointer to table of destination buffer segments (see Note #1).
 *
-*               buf_len     Number of octets to receive.
+*               seg_nbr     Number of segments in table.
 *
 *               timeout_ms  Timeout in milliseconds.
 *
@@ -879,18 +1014,20 @@ void  USBD_BulkTxAsync (CPU_INT08U        dev_nbr,
 *
 *               0,                         otherwise.
 *
-* Note(s)     : (1) This function SHOULD NOT be called from interrupt service routine (ISR).
-*
-*               (2) Receive buffer must be at least aligned on a word.
+* Note(s)     : (1) Each segment buffer must be at least aligned on a word. Segments are transferred in
+*                   place, except for a packet that straddles two segments, which is copied through the
+*                   endpoint bounce buffer. Segments whose length is a multiple of the maximum packet
+*                   size therefore never require a copy.
 *********************************************************************************************************
 */
 
-CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
-                         CPU_INT08U   ep_addr,
-                         void        *p_buf,
-                         CPU_INT32U   buf_len,
-                         CPU_INT16U   timeout_ms,
-                         USBD_ERR    *p_err)
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+CPU_INT32U  USBD_BulkRxVec (CPU_INT08U     dev_nbr,
+                            CPU_INT08U     ep_addr,
+                            USBD_BUF_SEG  *p_seg_tbl,
+                            CPU_INT08U     seg_nbr,
+                            CPU_INT16U     timeout_ms,
+                            USBD_ERR      *p_err)
 {
     USBD_EP         *p_ep;
     USBD_DRV        *p_drv;
@@ -899,7 +1036,7 @@ CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
     CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrRxSyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, BulkRxSyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -941,8 +1078,9 @@ CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
        *p_err = USBD_ERR_EP_INVALID_STATE;
         return (0u);
     }
+
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_BULK) ||
         ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_OUT)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
@@ -950,10 +1088,12 @@ CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
         return (0u);
     }
 
-    xfer_len = USBD_EP_Rx(                 p_drv,
+    xfer_len = USBD_EP_Rx(                 p_drv,               /* Call generic EP rx fnct.                             */
                                            p_ep,
-                                           p_buf,
-                                           buf_len,
+                          (void          *)0,
+                                           0u,
+                                           p_seg_tbl,
+                                           seg_nbr,
                           (USBD_ASYNC_FNCT)0,
                           (void          *)0,
                                            timeout_ms,
@@ -962,25 +1102,26 @@ CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrRxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, BulkRxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
     return (xfer_len);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_IntrRxAsync()
+*                                       USBD_BulkRxVecAsync()
 *
-* Description : Receive data on Interrupt OUT endpoint asynchronously.
+* Description : Receive data on Bulk OUT endpoint into a table of buffer segments asynchronously.
 *
 * Argument(s) : dev_nbr         Device number.
 *
 *               ep_addr         Endpoint address.
 *
-*               p_buf           Pointer to destination buffer to receive data (see Note #1).
+*               p_seg_tbl       Pointer to table of destination buffer segments (see Note #1).
 *
-*               buf_len         Number of octets to receive.
+*               seg_nbr         Number of segments in table.
 *
 *               async_fnct      Function that will be invoked upon completion of receive operation.
 *
@@ -1005,25 +1146,33 @@ CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Receive buffer must be at least aligned on a word.
+* Note(s)     : (1) Each segment buffer must be at least aligned on a word. Segments are transferred in
+*                   place, except for a packet that straddles two segments, which is copied through the
+*                   endpoint bounce buffer. Segments whose length is a multiple of the maximum packet
+*                   size therefore never require a copy.
+*
+*               (2) The segment table and the buffers it points to MUST remain valid until 'async_fnct' is
+*                   called. The callback receives the segment table as buffer and the total length of
+*                   the segments as buffer length.
 *********************************************************************************************************
 */
 
-void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
-                        CPU_INT08U        ep_addr,
-                        void             *p_buf,
-                        CPU_INT32U        buf_len,
-                        USBD_ASYNC_FNCT   async_fnct,
-                        void             *p_async_arg,
-                        USBD_ERR         *p_err)
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+void  USBD_BulkRxVecAsync (CPU_INT08U        dev_nbr,
+                           CPU_INT08U        ep_addr,
+                           USBD_BUF_SEG     *p_seg_tbl,
+                           CPU_INT08U        seg_nbr,
+                           USBD_ASYNC_FNCT   async_fnct,
+                           void             *p_async_arg,
+                           USBD_ERR         *p_err)
 {
     USBD_EP         *p_ep;
     USBD_DRV        *p_drv;
-    CPU_INT08U       ep_phy_nbr;
     USBD_DEV_STATE   state;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrRxAsyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, BulkRxAsyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -1070,8 +1219,9 @@ void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
        *p_err = USBD_ERR_EP_INVALID_STATE;
         return;
     }
+
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_BULK) ||
         ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_OUT)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
@@ -1081,8 +1231,10 @@ void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
 
     (void)USBD_EP_Rx(p_drv,                                     /* Call generic EP rx fnct.                             */
                      p_ep,
-                     p_buf,
-                     buf_len,
+                     (void *)0,
+                     0u,
+                     p_seg_tbl,
+                     seg_nbr,
                      async_fnct,
                      p_async_arg,
                      0u,
@@ -1091,23 +1243,24 @@ void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, BulkRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          USBD_EP_IntrTx()
+*                                          USBD_BulkTxVec()
 *
-* Description : Send data on Interrupt IN endpoint.
+* Description : Send data from a table of buffer segments on Bulk IN endpoint.
 *
 * Argument(s) : dev_nbr     Device number.
 *
 *               ep_addr     Endpoint address.
 *
-*               p_buf       Pointer to buffer of data that will be transmitted (see Note #2).
+*               p_seg_tbl   Pointer to table of source buffer segments (see Note #2).
 *
-*               buf_len     Number of octets to transmit.
+*               seg_nbr     Number of segments in table.
 *
 *               timeout_ms  Timeout in milliseconds.
 *
@@ -1135,29 +1288,33 @@ void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
 *
 * Note(s)     : (1) This function SHOULD NOT be called from interrupt service routine (ISR).
 *
-*               (2) Transmit buffer must be at least aligned on a word.
+*               (2) Each segment buffer must be at least aligned on a word. Segments are transferred in
+*                   place, except for a packet that straddles two segments, which is copied through the
+*                   endpoint bounce buffer. Segments whose length is a multiple of the maximum packet
+*                   size therefore never require a copy.
 *
 *               (3) If end-of-transfer is set and transfer length is multiple of maximum packet size,
 *                   a zero-length packet is transferred to indicate a short transfer to the host.
 *********************************************************************************************************
 */
 
-CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
-                         CPU_INT08U    ep_addr,
-                         void         *p_buf,
-                         CPU_INT32U    buf_len,
-                         CPU_INT16U    timeout_ms,
-                         CPU_BOOLEAN   end,
-                         USBD_ERR     *p_err)
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+CPU_INT32U  USBD_BulkTxVec (CPU_INT08U     dev_nbr,
+                            CPU_INT08U     ep_addr,
+                            USBD_BUF_SEG  *p_seg_tbl,
+                            CPU_INT08U     seg_nbr,
+                            CPU_INT16U     timeout_ms,
+                            CPU_BOOLEAN    end,
+                            USBD_ERR      *p_err)
 {
     USBD_EP         *p_ep;
     USBD_DRV        *p_drv;
-    CPU_INT08U       ep_phy_nbr;
-    CPU_INT32U       xfer_len;
     USBD_DEV_STATE   state;
+    CPU_INT32U       xfer_len;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrTxSyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, BulkTxSyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -1200,7 +1357,7 @@ CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
         return (0u);
     }
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_BULK) ||
         ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
@@ -1208,10 +1365,12 @@ CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
         return (0u);
     }
 
-    xfer_len = USBD_EP_Tx(                 p_drv,
+    xfer_len = USBD_EP_Tx(                 p_drv,               /* Call generic EP tx fnct.                             */
                                            p_ep,
-                                           p_buf,
-                                           buf_len,
+                          (void          *)0,
+                                           0u,
+                                           p_seg_tbl,
+                                           seg_nbr,
                           (USBD_ASYNC_FNCT)0,
                           (void          *)0,
                                            timeout_ms,
@@ -1221,25 +1380,26 @@ CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrTxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, BulkTxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
     return (xfer_len);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_IntrTxAsync()
+*                                       USBD_BulkTxVecAsync()
 *
-* Description : Send data on Interrupt IN endpoint asynchronously.
+* Description : Send data from a table of buffer segments on Bulk IN endpoint asynchronously.
 *
 * Argument(s) : dev_nbr         Device number.
 *
 *               ep_addr         Endpoint address.
 *
-*               p_buf           Pointer to buffer of data that will be transmitted (see Note #1).
+*               p_seg_tbl       Pointer to table of source buffer segments (see Note #1).
 *
-*               buf_len         Number of octets to transmit.
+*               seg_nbr         Number of segments in table.
 *
 *               async_fnct      Function that will be invoked upon completion of transmit operation.
 *
@@ -1266,29 +1426,37 @@ CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Transmit buffer must be at least aligned on a word.
+* Note(s)     : (1) Each segment buffer must be at least aligned on a word. Segments are transferred in
+*                   place, except for a packet that straddles two segments, which is copied through the
+*                   endpoint bounce buffer. Segments whose length is a multiple of the maximum packet
+*                   size therefore never require a copy.
 *
 *               (2) If end-of-transfer is set and transfer length is multiple of maximum packet size,
 *                   a zero-length packet is transferred to indicate a short transfer to the host.
+*
+*               (3) The segment table and the buffers it points to MUST remain valid until 'async_fnct' is
+*                   called. The callback receives the segment table as buffer and the total length of
+*                   the segments as buffer length.
 *********************************************************************************************************
 */
 
-void  USBD_IntrTxAsync (CPU_INT08U        dev_nbr,
-                        CPU_INT08U        ep_addr,
-                        void             *p_buf,
-                        CPU_INT32U        buf_len,
-                        USBD_ASYNC_FNCT   async_fnct,
-                        void             *p_async_arg,
-                        CPU_BOOLEAN       end,
-                        USBD_ERR         *p_err)
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+void  USBD_BulkTxVecAsync (CPU_INT08U        dev_nbr,
+                           CPU_INT08U        ep_addr,
+                           USBD_BUF_SEG     *p_seg_tbl,
+                           CPU_INT08U        seg_nbr,
+                           USBD_ASYNC_FNCT   async_fnct,
+                           void             *p_async_arg,
+                           CPU_BOOLEAN       end,
+                           USBD_ERR         *p_err)
 {
     USBD_EP         *p_ep;
     USBD_DRV        *p_drv;
-    CPU_INT08U       ep_phy_nbr;
     USBD_DEV_STATE   state;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrTxAsyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, BulkTxAsyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -1335,8 +1503,9 @@ void  USBD_IntrTxAsync (CPU_INT08U        dev_nbr,
        *p_err = USBD_ERR_EP_INVALID_STATE;
         return;
     }
+
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_BULK) ||
         ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
@@ -1344,102 +1513,108 @@ void  USBD_IntrTxAsync (CPU_INT08U        dev_nbr,
         return;
     }
 
-    (void)USBD_EP_Tx(p_drv,
-                     p_ep,
-                     p_buf,
-                     buf_len,
-                     async_fnct,
-                     p_async_arg,
-                     0u,
-                     end,
-                     p_err);
+   (void)USBD_EP_Tx(p_drv,
+                    p_ep,
+                    (void *)0,
+                    0u,
+                    p_seg_tbl,
+                    seg_nbr,
+                    async_fnct,
+                    p_async_arg,
+                    0u,
+                    end,
+                    p_err);
 
-    USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                           p_ep->Ix);
+   USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                          p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+   USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, BulkTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_IsocRxAsync()
+*********************************************************************************************************
+*                                    INTERRUPT TRANSFER FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            USBD_IntrRx()
 *
-* Description : Receive data on isochronous OUT endpoint asynchronously.
+* Description : Receive data on Interrupt OUT endpoint.
 *
-* Argument(s) : dev_nbr         Device number.
+* Argument(s) : dev_nbr     Device number.
 *
-*               ep_addr         Endpoint address.
+*               ep_addr     Endpoint address.
 *
-*               p_buf           Pointer to destination buffer to receive data (see Note #1).
+*               p_buf       Pointer to destination buffer to receive data (see Note #2).
 *
-*               buf_len         Number of octets to receive.
+*               buf_len     Number of octets to receive.
 *
-*               async_fnct      Function that will be invoked upon completion of receive operation.
+*               timeout_ms  Timeout in milliseconds.
 *
-*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
+*               p_err       Pointer to variable that will receive return error code from this function :
 *
-*               p_err           Pointer to variable that will receive return error code from this function :
+*                               USBD_ERR_NONE               Data successfully received.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                           configured state.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
 *
-*                                   USBD_ERR_NONE               Data successfully received.
-*                                   USBD_ERR_NULL_PTR           Parameter 'async_fnct' is a null pointer.
-*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
-*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
-*                                                               configured state.
-*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
-*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
-*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
 *
-*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
-*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
+*                               - RETURNED BY USBD_EP_Rx() -
+*                               See USBD_EP_Rx() for additional return error codes.
 *
-*                                   - RETURNED BY USBD_EP_Rx() -
-*                                   See USBD_EP_Rx() for additional return error codes.
+* Return(s)   : Number of octets received, if NO error(s).
 *
-* Return(s)   : none.
+*               0,                         otherwise.
 *
-* Note(s)     : (1) Receive buffer must be at least aligned on a word.
+* Note(s)     : (1) This function SHOULD NOT be called from interrupt service routine (ISR).
+*
+*               (2) Receive buffer must be at least aligned on a word.
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_EP_ISOC_EN == DEF_ENABLED)
-void  USBD_IsocRxAsync (CPU_INT08U        dev_nbr,
-                        CPU_INT08U        ep_addr,
-                        void             *p_buf,
-                        CPU_INT32U        buf_len,
-                        USBD_ASYNC_FNCT   async_fnct,
-                        void             *p_async_arg,
-                        USBD_ERR         *p_err)
-{
-    USBD_EP         *p_ep;
-    USBD_DRV        *p_drv;
-    USBD_DEV_STATE   state;
-    CPU_INT08U       ep_phy_nbr;
+CPU_INT32U  USBD_IntrRx (CPU_INT08U   dev_nbr,
+                         CPU_INT08U   ep_addr,
+                         void        *p_buf,
+                         CPU_INT32U   buf_len,
+                         CPU_INT16U   timeout_ms,
+                         USBD_ERR    *p_err)
+{
+    USBD_EP         *p_ep;
+    USBD_DRV        *p_drv;
+    USBD_DEV_STATE   state;
+    CPU_INT32U       xfer_len;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IsocRxAsyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrRxSyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
-        CPU_SW_EXCEPTION(;);
-    }
-
-    if (async_fnct == (USBD_ASYNC_FNCT)0) {
-       *p_err = USBD_ERR_NULL_PTR;
-        return;
+        CPU_SW_EXCEPTION(0);
     }
 #endif
 
     p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
     if (p_drv == (USBD_DRV *)0) {
        *p_err = USBD_ERR_DEV_INVALID_NBR;
-        return;
+        return (0u);
     }
 
     state = USBD_DevStateGet(dev_nbr, p_err);
     if (state != USBD_DEV_STATE_CONFIGURED) {                   /* EP transfers are ONLY allowed in cfg'd state.        */
        *p_err = USBD_ERR_DEV_INVALID_STATE;
-        return;
+        return (0u);
     }
 
     ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
@@ -1447,7 +1622,7 @@ void  USBD_IsocRxAsync (CPU_INT08U        dev_nbr,
 
     if (p_ep == (USBD_EP *)0) {
        *p_err = USBD_ERR_EP_INVALID_ADDR;
-        return;
+        return (0u);
     }
 
     USBD_OS_EP_LockAcquire(p_drv->DevNbr,
@@ -1455,62 +1630,65 @@ void  USBD_IsocRxAsync (CPU_INT08U        dev_nbr,
                            0u,
                            p_err);
     if (*p_err != USBD_ERR_NONE) {
-        return;
+        return (0u);
     }
 
     if (p_ep->State != USBD_EP_STATE_OPEN) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_STATE;
-        return;
+        return (0u);
     }
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_ISOC) ||
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
         ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_OUT)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_TYPE;
-        return;
+        return (0u);
     }
 
-    (void)USBD_EP_Rx(p_drv,                                     /* Call generic EP rx fnct.                             */
-                     p_ep,
-                     p_buf,
-                     buf_len,
-                     async_fnct,
-                     p_async_arg,
-                     0u,
-                     p_err);
+    xfer_len = USBD_EP_Rx(                 p_drv,
+                                           p_ep,
+                                           p_buf,
+                                           buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
+                          (USBD_ASYNC_FNCT)0,
+                          (void          *)0,
+                                           timeout_ms,
+                                           p_err);
 
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IsocRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrRxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+
+    return (xfer_len);
 }
-#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_IsocTxAsync()
+*                                         USBD_IntrRxAsync()
 *
-* Description : Send data on isochronous IN endpoint asynchronously.
+* Description : Receive data on Interrupt OUT endpoint asynchronously.
 *
 * Argument(s) : dev_nbr         Device number.
 *
 *               ep_addr         Endpoint address.
 *
-*               p_buf           Pointer to buffer of data that will be transmitted (see Note #1).
+*               p_buf           Pointer to destination buffer to receive data (see Note #1).
 *
-*               buf_len         Number of octets to transmit.
+*               buf_len         Number of octets to receive.
 *
-*               async_fnct      Function that will be invoked upon completion of transmit operation.
+*               async_fnct      Function that will be invoked upon completion of receive operation.
 *
 *               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
-**
+*
 *               p_err           Pointer to variable that will receive return error code from this function :
 *
-*                                   USBD_ERR_NONE               Data successfully transmitted.
+*                                   USBD_ERR_NONE               Data successfully received.
 *                                   USBD_ERR_NULL_PTR           Parameter 'async_fnct' is a null pointer.
 *                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
 *                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
@@ -1522,17 +1700,16 @@ void  USBD_IsocRxAsync (CPU_INT08U        dev_nbr,
 *                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
 *                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
 *
-*                                   - RETURNED BY USBD_EP_Tx() -
-*                                   See USBD_EP_Tx() for additional return error codes.
+*                                   - RETURNED BY USBD_EP_Rx() -
+*                                   See USBD_EP_Rx() for additional return error codes.
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Transmit buffer must be at least aligned on a word.
+* Note(s)     : (1) Receive buffer must be at least aligned on a word.
 *********************************************************************************************************
 */
 
-#if (USBD_CFG_EP_ISOC_EN == DEF_ENABLED)
-void  USBD_IsocTxAsync (CPU_INT08U        dev_nbr,
+void  USBD_IntrRxAsync (CPU_INT08U        dev_nbr,
                         CPU_INT08U        ep_addr,
                         void             *p_buf,
                         CPU_INT32U        buf_len,
@@ -1542,11 +1719,11 @@ void  USBD_IsocTxAsync (CPU_INT08U        dev_nbr,
 {
     USBD_EP         *p_ep;
     USBD_DRV        *p_drv;
-    USBD_DEV_STATE   state;
     CPU_INT08U       ep_phy_nbr;
+    USBD_DEV_STATE   state;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, IsocTxAsyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrRxAsyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -1594,109 +1771,56 @@ void  USBD_IsocTxAsync (CPU_INT08U        dev_nbr,
         return;
     }
                                                                 /* Chk EP attrib.                                       */
-    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_ISOC) ||
-        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_OUT)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_TYPE;
         return;
     }
 
-    (void)USBD_EP_Tx(p_drv,
+    (void)USBD_EP_Rx(p_drv,                                     /* Call generic EP rx fnct.                             */
                      p_ep,
                      p_buf,
                      buf_len,
+                     (USBD_BUF_SEG *)0,
+                     0u,
                      async_fnct,
                      p_async_arg,
                      0u,
-                     DEF_NO,
                      p_err);
 
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IsocTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
-#endif
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_CtrlTxStatus()
+*                                          USBD_EP_IntrTx()
 *
-* Description : Handle status stage from host on control (EP0) IN endpoint.
+* Description : Send data on Interrupt IN endpoint.
 *
 * Argument(s) : dev_nbr     Device number.
 *
-*               timeout_ms  Timeout in milliseconds.
-*
-*               p_err       Pointer to variable that will receive return error code from this function :
-*
-*                               USBD_ERR_NONE               Status stage successfully completed.
-*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
-*                                                           default/addressed/configured state.
-*
-*                               - RETURNED BY USBD_DevStateGet() -
-*                               See USBD_DevStateGet() for additional return error codes.
-*
-*                               - RETURNED BY USBD_EP_TxZLP() -
-*                               See USBD_EP_TxZLP() for additional return error codes.
-*
-* Return(s)   : none.
-*
-* Note(s)     : none.
-*********************************************************************************************************
-*/
-
-void  USBD_CtrlTxStatus (CPU_INT08U   dev_nbr,
-                         CPU_INT16U   timeout_ms,
-                         USBD_ERR    *p_err)
-{
-    USBD_DEV_STATE  state;
-
-
-    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlTxStatusExecNbr);
-
-    state = USBD_DevStateGet(dev_nbr, p_err);
-    if (*p_err != USBD_ERR_NONE) {
-        return;
-    }
-
-    if ((state != USBD_DEV_STATE_DEFAULT)    &&
-        (state != USBD_DEV_STATE_ADDRESSED)  &&
-        (state != USBD_DEV_STATE_CONFIGURED)) {
-       *p_err  = USBD_ERR_DEV_INVALID_STATE;
-        return;
-    }
-
-    USBD_EP_TxZLP(dev_nbr,
-                  USBD_EP_ADDR_CTRL_IN,
-                  timeout_ms,
-                  p_err);
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlTxStatusSuccessNbr, (*p_err == USBD_ERR_NONE));
-}
-
-
-/*
-*********************************************************************************************************
-*                                            USBD_CtrlRx()
-*
-* Description : Receive data on Control OUT endpoint.
-*
-* Argument(s) : dev_nbr     Device number.
+*               ep_addr     Endpoint address.
 *
-*               p_buf       Pointer to destination buffer to receive data.
+*               p_buf       Pointer to buffer of data that will be transmitted (see Note #2).
 *
-*               buf_len     Number of octets to receive.
+*               buf_len     Number of octets to transmit.
 *
 *               timeout_ms  Timeout in milliseconds.
 *
+*               end         End-of-transfer flag (see Note #3).
+*
 *               p_err       Pointer to variable that will receive return error code from this function :
 *
-*                               USBD_ERR_NONE               Data successfully received.
+*                               USBD_ERR_NONE               Data successfully transmitted.
 *                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
 *                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
-*                                                           default/addressed/configured state.
+*                                                           configured state.
 *                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
 *                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
 *                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
@@ -1704,31 +1828,38 @@ void  USBD_CtrlTxStatus (CPU_INT08U   dev_nbr,
 *                               - RETURNED BY USBD_OS_EP_LockAcquire() -
 *                               See USBD_OS_EP_LockAcquire() for additional return error codes.
 *
-*                               - RETURNED BY USBD_EP_Rx() -
-*                               See USBD_EP_Rx() for additional return error codes.
+*                               - RETURNED BY USBD_EP_Tx() -
+*                               See USBD_EP_Tx() for additional return error codes.
 *
-* Return(s)   : Number of octets received, if NO error(s).
+* Return(s)   : Number of octets transmitted, if NO error(s).
 *
-*               0,                         otherwise.
+*               0,                            otherwise.
 *
-* Note(s)     : none.
+* Note(s)     : (1) This function SHOULD NOT be called from interrupt service routine (ISR).
+*
+*               (2) Transmit buffer must be at least aligned on a word.
+*
+*               (3) If end-of-transfer is set and transfer length is multiple of maximum packet size,
+*                   a zero-length packet is transferred to indicate a short transfer to the host.
 *********************************************************************************************************
 */
 
-CPU_INT32U  USBD_CtrlRx (CPU_INT08U    dev_nbr,
+CPU_INT32U  USBD_IntrTx (CPU_INT08U    dev_nbr,
+                         CPU_INT08U    ep_addr,
                          void         *p_buf,
                          CPU_INT32U    buf_len,
                          CPU_INT16U    timeout_ms,
+                         CPU_BOOLEAN   end,
                          USBD_ERR     *p_err)
 {
-    USBD_DRV        *p_drv;
     USBD_EP         *p_ep;
+    USBD_DRV        *p_drv;
     CPU_INT08U       ep_phy_nbr;
-    USBD_DEV_STATE   state;
     CPU_INT32U       xfer_len;
+    USBD_DEV_STATE   state;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlRxSyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrTxSyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
@@ -1743,14 +1874,12 @@ CPU_INT32U  USBD_CtrlRx (CPU_INT08U    dev_nbr,
     }
 
     state = USBD_DevStateGet(dev_nbr, p_err);
-    if ((state != USBD_DEV_STATE_DEFAULT)   &&
-        (state != USBD_DEV_STATE_ADDRESSED) &&
-        (state != USBD_DEV_STATE_CONFIGURED)) {
+    if (state != USBD_DEV_STATE_CONFIGURED) {                   /* EP transfers are ONLY allowed in cfg'd state.        */
        *p_err = USBD_ERR_DEV_INVALID_STATE;
         return (0u);
     }
 
-    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_OUT);
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
     p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
 
     if (p_ep == (USBD_EP *)0) {
@@ -1773,26 +1902,30 @@ CPU_INT32U  USBD_CtrlRx (CPU_INT08U    dev_nbr,
         return (0u);
     }
                                                                 /* Chk EP attrib.                                       */
-    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_TYPE;
         return (0u);
     }
 
-    xfer_len = USBD_EP_Rx(                 p_drv,
+    xfer_len = USBD_EP_Tx(                 p_drv,
                                            p_ep,
                                            p_buf,
                                            buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
                           (USBD_ASYNC_FNCT)0,
                           (void          *)0,
                                            timeout_ms,
+                                           end,
                                            p_err);
 
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlRxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrTxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
     return (xfer_len);
 }
@@ -1800,93 +1933,96 @@ CPU_INT32U  USBD_CtrlRx (CPU_INT08U    dev_nbr,
 
 /*
 *********************************************************************************************************
-*                                            USBD_CtrlTx()
+*                                         USBD_IntrTxAsync()
 *
-* Description : Send data on Control IN endpoint.
+* Description : Send data on Interrupt IN endpoint asynchronously.
 *
-* Argument(s) : dev_nbr     Device number.
+* Argument(s) : dev_nbr         Device number.
 *
-*               p_buf       Pointer to buffer of data that will be sent.
+*               ep_addr         Endpoint address.
 *
-*               buf_len     Number of octets to transmit.
+*               p_buf           Pointer to buffer of data that will be transmitted (see Note #1).
 *
-*               timeout_ms  Timeout in milliseconds.
+*               buf_len         Number of octets to transmit.
 *
-*               end         End-of-transfer flag (see Note #1).
+*               async_fnct      Function that will be invoked upon completion of transmit operation.
 *
-*               p_err       Pointer to variable that will receive return error code from this function :
+*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
 *
-*                               USBD_ERR_NONE               Data successfully transmitted.
-*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
-*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
-*                                                           configured state.
-*                               USBD_ERR_INVALID_ARG        Invalid argument(s): 'buf_len'.
-*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
-*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
-*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*               end             End-of-transfer flag (see Note #2).
 *
-*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
-*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
+*               p_err           Pointer to variable that will receive return error code from this function :
 *
-*                               - RETURNED BY USBD_EP_Tx() -
-*                               See USBD_EP_Tx() for additional return error codes.
+*                                   USBD_ERR_NONE               Data successfully transmitted.
+*                                   USBD_ERR_NULL_PTR           Parameter 'async_fnct' is a null pointer.
+*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                               configured state.
+*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
 *
-* Return(s)   : Number of octets transmitted, if NO error(s).
+*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
 *
-*               0,                            otherwise.
+*                                   - RETURNED BY USBD_EP_Tx() -
+*                                   See USBD_EP_Tx() for additional return error codes.
 *
-* Note(s)     : (1) If end-of-transfer is set and transfer length is multiple of maximum packet size,
+* Return(s)   : none.
+*
+* Note(s)     : (1) Transmit buffer must be at least aligned on a word.
+*
+*               (2) If end-of-transfer is set and transfer length is multiple of maximum packet size,
 *                   a zero-length packet is transferred to indicate a short transfer to the host.
 *********************************************************************************************************
 */
 
-CPU_INT32U  USBD_CtrlTx (CPU_INT08U    dev_nbr,
-                         void         *p_buf,
-                         CPU_INT32U    buf_len,
-                         CPU_INT16U    timeout_ms,
-                         CPU_BOOLEAN   end,
-                         USBD_ERR     *p_err)
+void  USBD_IntrTxAsync (CPU_INT08U        dev_nbr,
+                        CPU_INT08U        ep_addr,
+                        void             *p_buf,
+                        CPU_INT32U        buf_len,
+                        USBD_ASYNC_FNCT   async_fnct,
+                        void             *p_async_arg,
+                        CPU_BOOLEAN       end,
+                        USBD_ERR         *p_err)
 {
-    USBD_DRV        *p_drv;
     USBD_EP         *p_ep;
+    USBD_DRV        *p_drv;
     CPU_INT08U       ep_phy_nbr;
     USBD_DEV_STATE   state;
-    CPU_INT32U       xfer_len;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlTxSyncExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IntrTxAsyncExecNbr);
 
 #if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
     if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
-        CPU_SW_EXCEPTION(0);
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
     }
 #endif
 
     p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
     if (p_drv == (USBD_DRV *)0) {
        *p_err = USBD_ERR_DEV_INVALID_NBR;
-        return (0u);
+        return;
     }
 
     state = USBD_DevStateGet(dev_nbr, p_err);
-    if ((state != USBD_DEV_STATE_DEFAULT)   &&
-        (state != USBD_DEV_STATE_ADDRESSED) &&
-        (state != USBD_DEV_STATE_CONFIGURED)) {
+    if (state != USBD_DEV_STATE_CONFIGURED) {                   /* EP transfers are ONLY allowed in cfg'd state.        */
        *p_err = USBD_ERR_DEV_INVALID_STATE;
-        return (0u);
-    }
-
-    if (buf_len == 0u) {
-       *p_err = USBD_ERR_INVALID_ARG;
-        return (0u);
+        return;
     }
 
-    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_IN);
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
     p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
 
     if (p_ep == (USBD_EP *)0) {
        *p_err = USBD_ERR_EP_INVALID_ADDR;
-        return (0u);
+        return;
     }
 
     USBD_OS_EP_LockAcquire(p_drv->DevNbr,
@@ -1894,186 +2030,327 @@ CPU_INT32U  USBD_CtrlTx (CPU_INT08U    dev_nbr,
                            0u,
                            p_err);
     if (*p_err != USBD_ERR_NONE) {
-        return (0u);
+        return;
     }
 
     if (p_ep->State != USBD_EP_STATE_OPEN) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_STATE;
-        return (0u);
+        return;
     }
                                                                 /* Chk EP attrib.                                       */
-    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_INTR) ||
+        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
                                p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_TYPE;
-        return (0u);
+        return;
     }
 
-    xfer_len = USBD_EP_Tx(                 p_drv,
-                                           p_ep,
-                                           p_buf,
-                                           buf_len,
-                          (USBD_ASYNC_FNCT)0,
-                          (void          *)0,
-                                           timeout_ms,
-                                           end,
-                                           p_err);
+    (void)USBD_EP_Tx(p_drv,
+                     p_ep,
+                     p_buf,
+                     buf_len,
+                     (USBD_BUF_SEG *)0,
+                     0u,
+                     async_fnct,
+                     p_async_arg,
+                     0u,
+                     end,
+                     p_err);
 
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
                            p_ep->Ix);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlTxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
-
-    return (xfer_len);
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IntrTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
 
 
 /*
 *********************************************************************************************************
-*                                         USBD_CtrlRxStatus()
+*                                         USBD_IsocRxAsync()
 *
-* Description : Handle status stage from host on control (EP0) OUT endpoint.
+* Description : Receive data on isochronous OUT endpoint asynchronously.
 *
-* Argument(s) : dev_nbr     Device number.
+* Argument(s) : dev_nbr         Device number.
 *
-*               timeout_ms  Timeout in milliseconds.
+*               ep_addr         Endpoint address.
 *
-*               p_err       Pointer to variable that will receive return error code from this function :
+*               p_buf           Pointer to destination buffer to receive data (see Note #1).
 *
-*                               USBD_ERR_NONE               Status stage successfully completed.
-*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
-*                                                           default/addressed/configured state.
+*               buf_len         Number of octets to receive.
 *
-*                               - RETURNED BY USBD_DevStateGet() -
-*                               See USBD_DevStateGet() for additional return error codes.
+*               async_fnct      Function that will be invoked upon completion of receive operation.
 *
-*                               - RETURNED BY USBD_EP_RxZLP() -
-*                               See USBD_EP_RxZLP() for additional return error codes.
+*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
+*
+*               p_err           Pointer to variable that will receive return error code from this function :
+*
+*                                   USBD_ERR_NONE               Data successfully received.
+*                                   USBD_ERR_NULL_PTR           Parameter 'async_fnct' is a null pointer.
+*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                               configured state.
+*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*
+*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                                   - RETURNED BY USBD_EP_Rx() -
+*                                   See USBD_EP_Rx() for additional return error codes.
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Receive buffer must be at least aligned on a word.
 *********************************************************************************************************
 */
 
-void  USBD_CtrlRxStatus (CPU_INT08U   dev_nbr,
-                         CPU_INT16U   timeout_ms,
-                         USBD_ERR    *p_err)
+#if (USBD_CFG_EP_ISOC_EN == DEF_ENABLED)
+void  USBD_IsocRxAsync (CPU_INT08U        dev_nbr,
+                        CPU_INT08U        ep_addr,
+                        void             *p_buf,
+                        CPU_INT32U        buf_len,
+                        USBD_ASYNC_FNCT   async_fnct,
+                        void             *p_async_arg,
+                        USBD_ERR         *p_err)
 {
-    USBD_DEV_STATE  state;
+    USBD_EP         *p_ep;
+    USBD_DRV        *p_drv;
+    USBD_DEV_STATE   state;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlRxStatusExecNbr);
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IsocRxAsyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
 
     state = USBD_DevStateGet(dev_nbr, p_err);
+    if (state != USBD_DEV_STATE_CONFIGURED) {                   /* EP transfers are ONLY allowed in cfg'd state.        */
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
     if (*p_err != USBD_ERR_NONE) {
         return;
     }
 
-    if ((state != USBD_DEV_STATE_DEFAULT)   &&
-        (state != USBD_DEV_STATE_ADDRESSED) &&
-        (state != USBD_DEV_STATE_CONFIGURED)) {
-       *p_err  = USBD_ERR_DEV_INVALID_STATE;
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        return;
+    }
+                                                                /* Chk EP attrib.                                       */
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_ISOC) ||
+        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_OUT)) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
         return;
     }
 
-    USBD_EP_RxZLP(dev_nbr,
-                  USBD_EP_ADDR_CTRL_OUT,
-                  timeout_ms,
-                  p_err);
+    (void)USBD_EP_Rx(p_drv,                                     /* Call generic EP rx fnct.                             */
+                     p_ep,
+                     p_buf,
+                     buf_len,
+                     (USBD_BUF_SEG *)0,
+                     0u,
+                     async_fnct,
+                     p_async_arg,
+                     0u,
+                     p_err);
 
-    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlRxStatusSuccessNbr, (*p_err == USBD_ERR_NONE));
-}
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
 
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IsocRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+}
+#endif
 
-/*
-*********************************************************************************************************
-*********************************************************************************************************
-*                                     CONTROL ENDPOINT FUNCTIONS
-*********************************************************************************************************
-*********************************************************************************************************
-*/
 
 /*
 *********************************************************************************************************
-*                                           USBD_CtrlOpen()
+*                                         USBD_IsocTxAsync()
 *
-* Description : Open control endpoints.
+* Description : Send data on isochronous IN endpoint asynchronously.
 *
 * Argument(s) : dev_nbr         Device number.
 *
-*               max_pkt_size    Maximum packet size.
+*               ep_addr         Endpoint address.
+*
+*               p_buf           Pointer to buffer of data that will be transmitted (see Note #1).
+*
+*               buf_len         Number of octets to transmit.
+*
+*               async_fnct      Function that will be invoked upon completion of transmit operation.
 *
+*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
+**
 *               p_err           Pointer to variable that will receive return error code from this function :
 *
-*                                   USBD_ERR_NONE               Control endpoint successfully opened.
+*                                   USBD_ERR_NONE               Data successfully transmitted.
+*                                   USBD_ERR_NULL_PTR           Parameter 'async_fnct' is a null pointer.
 *                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                               configured state.
+*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
 *
-*                                   - RETURNED BY USBD_EP_Open() -
-*                                   See USBD_EP_Open() for additional return error codes.
+*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                                   - RETURNED BY USBD_EP_Tx() -
+*                                   See USBD_EP_Tx() for additional return error codes.
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Transmit buffer must be at least aligned on a word.
 *********************************************************************************************************
 */
 
-void  USBD_CtrlOpen (CPU_INT08U   dev_nbr,
-                     CPU_INT16U   max_pkt_size,
-                     USBD_ERR    *p_err)
+#if (USBD_CFG_EP_ISOC_EN == DEF_ENABLED)
+void  USBD_IsocTxAsync (CPU_INT08U        dev_nbr,
+                        CPU_INT08U        ep_addr,
+                        void             *p_buf,
+                        CPU_INT32U        buf_len,
+                        USBD_ASYNC_FNCT   async_fnct,
+                        void             *p_async_arg,
+                        USBD_ERR         *p_err)
 {
-    USBD_DRV  *p_drv;
-    USBD_ERR   local_err;
+    USBD_EP         *p_ep;
+    USBD_DRV        *p_drv;
+    USBD_DEV_STATE   state;
+    CPU_INT08U       ep_phy_nbr;
 
 
-    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    USBD_DBG_STATS_DEV_INC(dev_nbr, IsocTxAsyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
     if (p_drv == (USBD_DRV *)0) {
        *p_err = USBD_ERR_DEV_INVALID_NBR;
         return;
     }
 
-    USBD_EP_Open(p_drv,
-                 USBD_EP_ADDR_CTRL_IN,
-                 max_pkt_size,
-                 USBD_EP_TYPE_CTRL,
-                 0u,
-                 p_err);
-    if (*p_err != USBD_ERR_NONE) {
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if (state != USBD_DEV_STATE_CONFIGURED) {                   /* EP transfers are ONLY allowed in cfg'd state.        */
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
         return;
     }
 
-    USBD_EP_Open(p_drv,
-                 USBD_EP_ADDR_CTRL_OUT,
-                 max_pkt_size,
-                 USBD_EP_TYPE_CTRL,
-                 0u,
-                 p_err);
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
     if (*p_err != USBD_ERR_NONE) {
-        USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_IN,  &local_err);
         return;
     }
 
-   *p_err = USBD_ERR_NONE;
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        return;
+    }
+                                                                /* Chk EP attrib.                                       */
+    if (((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_ISOC) ||
+        ((ep_addr      & USBD_EP_DIR_MASK)  != USBD_EP_DIR_IN)) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        return;
+    }
+
+    (void)USBD_EP_Tx(p_drv,
+                     p_ep,
+                     p_buf,
+                     buf_len,
+                     (USBD_BUF_SEG *)0,
+                     0u,
+                     async_fnct,
+                     p_async_arg,
+                     0u,
+                     DEF_NO,
+                     p_err);
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
+
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, IsocTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                          USBD_CtrlClose()
+*                                         USBD_CtrlTxStatus()
 *
-* Description : Close control endpoint.
+* Description : Handle status stage from host on control (EP0) IN endpoint.
 *
 * Argument(s) : dev_nbr     Device number.
 *
+*               timeout_ms  Timeout in milliseconds.
+*
 *               p_err       Pointer to variable that will receive return error code from this function :
 *
-*                               USBD_ERR_NONE               Control endpoint successfully closed.
-*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_NONE               Status stage successfully completed.
+*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                           default/addressed/configured state.
 *
-*                               - RETURNED BY USBD_EP_Close() -
-*                               See USBD_EP_Close() for additional return error codes.
+*                               - RETURNED BY USBD_DevStateGet() -
+*                               See USBD_DevStateGet() for additional return error codes.
+*
+*                               - RETURNED BY USBD_EP_TxZLP() -
+*                               See USBD_EP_TxZLP() for additional return error codes.
 *
 * Return(s)   : none.
 *
@@ -2081,135 +2358,890 @@ void  USBD_CtrlOpen (CPU_INT08U   dev_nbr,
 *********************************************************************************************************
 */
 
-void  USBD_CtrlClose (CPU_INT08U   dev_nbr,
-                      USBD_ERR    *p_err)
+void  USBD_CtrlTxStatus (CPU_INT08U   dev_nbr,
+                         CPU_INT16U   timeout_ms,
+                         USBD_ERR    *p_err)
 {
-    USBD_DRV  *p_drv;
-    USBD_ERR   err_in;
-    USBD_ERR   err_out;
+    USBD_DEV_STATE  state;
 
 
-    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
-    if (p_drv == (USBD_DRV *)0) {
-       *p_err = USBD_ERR_DEV_INVALID_NBR;
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlTxStatusExecNbr);
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if (*p_err != USBD_ERR_NONE) {
         return;
     }
 
-    USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_IN,  &err_in);
-    USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_OUT, &err_out);
-
-    if (err_in != USBD_ERR_NONE) {
-       *p_err = err_in;
-    } else {
-       *p_err = err_out;
+    if ((state != USBD_DEV_STATE_DEFAULT)    &&
+        (state != USBD_DEV_STATE_ADDRESSED)  &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err  = USBD_ERR_DEV_INVALID_STATE;
+        return;
     }
+
+    USBD_EP_TxZLP(dev_nbr,
+                  USBD_EP_ADDR_CTRL_IN,
+                  timeout_ms,
+                  p_err);
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlTxStatusSuccessNbr, (*p_err == USBD_ERR_NONE));
 }
 
 
 /*
 *********************************************************************************************************
-*                                          USBD_CtrlStall()
+*                                            USBD_CtrlRx()
 *
-* Description : Stall control endpoint.
+* Description : Receive data on Control OUT endpoint.
 *
 * Argument(s) : dev_nbr     Device number.
 *
+*               p_buf       Pointer to destination buffer to receive data.
+*
+*               buf_len     Number of octets to receive.
+*
+*               timeout_ms  Timeout in milliseconds.
+*
 *               p_err       Pointer to variable that will receive return error code from this function :
 *
-*                               USBD_ERR_NONE               Control endpoint successfully stalled.
+*                               USBD_ERR_NONE               Data successfully received.
 *                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                           default/addressed/configured state.
 *                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
 *                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
-*                               USBD_ERR_EP_STALL           Device driver stall endpoint failed.
+*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
 *
 *                               - RETURNED BY USBD_OS_EP_LockAcquire() -
 *                               See USBD_OS_EP_LockAcquire() for additional return error codes.
 *
-* Return(s)   : none.
+*                               - RETURNED BY USBD_EP_Rx() -
+*                               See USBD_EP_Rx() for additional return error codes.
 *
-* Note(s)     : None.
+* Return(s)   : Number of octets received, if NO error(s).
+*
+*               0,                         otherwise.
+*
+* Note(s)     : none.
 *********************************************************************************************************
 */
 
-void  USBD_CtrlStall (CPU_INT08U   dev_nbr,
-                      USBD_ERR    *p_err)
+CPU_INT32U  USBD_CtrlRx (CPU_INT08U    dev_nbr,
+                         void         *p_buf,
+                         CPU_INT32U    buf_len,
+                         CPU_INT16U    timeout_ms,
+                         USBD_ERR     *p_err)
 {
-    USBD_EP       *p_ep_out;
-    USBD_EP       *p_ep_in;
-    USBD_DRV      *p_drv;
-    USBD_DRV_API  *p_drv_api;
-    CPU_INT08U     ep_phy_nbr;
-    CPU_BOOLEAN    stall_in;
-    CPU_BOOLEAN    stall_out;
+    USBD_DRV        *p_drv;
+    USBD_EP         *p_ep;
+    CPU_INT08U       ep_phy_nbr;
+    USBD_DEV_STATE   state;
+    CPU_INT32U       xfer_len;
+
 
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlRxSyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(0);
+    }
+#endif
 
     p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
     if (p_drv == (USBD_DRV *)0) {
        *p_err = USBD_ERR_DEV_INVALID_NBR;
-        return;
+        return (0u);
+    }
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if ((state != USBD_DEV_STATE_DEFAULT)   &&
+        (state != USBD_DEV_STATE_ADDRESSED) &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return (0u);
     }
 
     ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_OUT);
-    p_ep_out   = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
-    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_IN);
-    p_ep_in    = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
 
-    if ((p_ep_out == (USBD_EP *)0) ||
-        (p_ep_in  == (USBD_EP *)0)) {
+    if (p_ep == (USBD_EP *)0) {
        *p_err = USBD_ERR_EP_INVALID_ADDR;
-        return;
+        return (0u);
     }
 
     USBD_OS_EP_LockAcquire(p_drv->DevNbr,
-                           p_ep_out->Ix,
+                           p_ep->Ix,
                            0u,
                            p_err);
     if (*p_err != USBD_ERR_NONE) {
-        return;
+        return (0u);
     }
 
-    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
-                           p_ep_in->Ix,
-                           0u,
-                           p_err);
-    if (*p_err != USBD_ERR_NONE) {
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
         USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                               p_ep_out->Ix);
-        return;
-    }
-
-    if ((p_ep_out->State == USBD_EP_STATE_OPEN) &&
-        (p_ep_in->State  == USBD_EP_STATE_OPEN)) {
-
-        p_drv_api = p_drv->API_Ptr;                             /* Get dev drv API struct.                              */
-        stall_in = p_drv_api->EP_Stall(p_drv,
-                                       USBD_EP_ADDR_CTRL_IN,
-                                       DEF_SET);
-
-        stall_out = p_drv_api->EP_Stall(p_drv,
-                                        USBD_EP_ADDR_CTRL_OUT,
-                                        DEF_SET);
-
-        if ((stall_in  == DEF_FAIL) ||
-            (stall_out == DEF_FAIL)) {
-           *p_err = USBD_ERR_EP_STALL;
-        } else {
-           *p_err = USBD_ERR_NONE;
-        }
-
-    } else {
+                               p_ep->Ix);
        *p_err = USBD_ERR_EP_INVALID_STATE;
+        return (0u);
+    }
+                                                                /* Chk EP attrib.                                       */
+    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        return (0u);
     }
 
-    USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                           p_ep_in->Ix);
+    xfer_len = USBD_EP_Rx(                 p_drv,
+                                           p_ep,
+                                           p_buf,
+                                           buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
+                          (USBD_ASYNC_FNCT)0,
+                          (void          *)0,
+                                           timeout_ms,
+                                           p_err);
 
     USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                           p_ep_out->Ix);
-}
+                           p_ep->Ix);
 
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlRxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
-/*
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlRxAsync()
+*
+* Description : Receive data on Control OUT endpoint asynchronously.
+*
+* Argument(s) : dev_nbr         Device number.
+*
+*               p_buf           Pointer to destination buffer to receive data (see Note #1).
+*
+*               buf_len         Number of octets to receive (see Note #2).
+*
+*               async_fnct      Function that will be invoked upon completion of receive operation.
+*
+*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
+*
+*               p_err           Pointer to variable that will receive return error code from this function :
+*
+*                                   USBD_ERR_NONE               Transfer successfully queued.
+*                                   USBD_ERR_NULL_PTR           Argument 'async_fnct' passed a NULL pointer.
+*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                               default/addressed/configured state.
+*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*
+*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                                   - RETURNED BY USBD_EP_Rx() -
+*                                   See USBD_EP_Rx() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Receive buffer must be at least aligned on a word.
+*
+*               (2) A zero-length receive waits for the zero-length packet of the status stage of a
+*                   control read transfer.
+*
+*               (3) This function is used by the core for the data and status stages of the standard
+*                   requests, and by the class drivers that defer a request with USBD_CtrlReqDefer().
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void  USBD_CtrlRxAsync (CPU_INT08U        dev_nbr,
+                        void             *p_buf,
+                        CPU_INT32U        buf_len,
+                        USBD_ASYNC_FNCT   async_fnct,
+                        void             *p_async_arg,
+                        USBD_ERR         *p_err)
+{
+    USBD_DRV        *p_drv;
+    USBD_EP         *p_ep;
+    CPU_INT08U       ep_phy_nbr;
+    USBD_DEV_STATE   state;
+
+
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlRxAsyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if ((state != USBD_DEV_STATE_DEFAULT)   &&
+        (state != USBD_DEV_STATE_ADDRESSED) &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_OUT);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        return;
+    }
+                                                                /* Chk EP attrib.                                       */
+    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        return;
+    }
+
+    (void)USBD_EP_Rx(                 p_drv,
+                                      p_ep,
+                                      p_buf,
+                                      buf_len,
+                     (USBD_BUF_SEG *)0,
+                                      0u,
+                                      async_fnct,
+                                      p_async_arg,
+                                      0u,
+                                      p_err);
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
+
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlRxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            USBD_CtrlTx()
+*
+* Description : Send data on Control IN endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_buf       Pointer to buffer of data that will be sent.
+*
+*               buf_len     Number of octets to transmit.
+*
+*               timeout_ms  Timeout in milliseconds.
+*
+*               end         End-of-transfer flag (see Note #1).
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Data successfully transmitted.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                           configured state.
+*                               USBD_ERR_INVALID_ARG        Invalid argument(s): 'buf_len'.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*
+*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                               - RETURNED BY USBD_EP_Tx() -
+*                               See USBD_EP_Tx() for additional return error codes.
+*
+* Return(s)   : Number of octets transmitted, if NO error(s).
+*
+*               0,                            otherwise.
+*
+* Note(s)     : (1) If end-of-transfer is set and transfer length is multiple of maximum packet size,
+*                   a zero-length packet is transferred to indicate a short transfer to the host.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  USBD_CtrlTx (CPU_INT08U    dev_nbr,
+                         void         *p_buf,
+                         CPU_INT32U    buf_len,
+                         CPU_INT16U    timeout_ms,
+                         CPU_BOOLEAN   end,
+                         USBD_ERR     *p_err)
+{
+    USBD_DRV        *p_drv;
+    USBD_EP         *p_ep;
+    CPU_INT08U       ep_phy_nbr;
+    USBD_DEV_STATE   state;
+    CPU_INT32U       xfer_len;
+
+
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlTxSyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(0);
+    }
+#endif
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return (0u);
+    }
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if ((state != USBD_DEV_STATE_DEFAULT)   &&
+        (state != USBD_DEV_STATE_ADDRESSED) &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return (0u);
+    }
+
+    if (buf_len == 0u) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return (0u);
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_IN);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return (0u);
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (0u);
+    }
+
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        return (0u);
+    }
+                                                                /* Chk EP attrib.                                       */
+    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        return (0u);
+    }
+
+    xfer_len = USBD_EP_Tx(                 p_drv,
+                                           p_ep,
+                                           p_buf,
+                                           buf_len,
+                          (USBD_BUF_SEG  *)0,
+                                           0u,
+                          (USBD_ASYNC_FNCT)0,
+                          (void          *)0,
+                                           timeout_ms,
+                                           end,
+                                           p_err);
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
+
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlTxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+
+    return (xfer_len);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlTxAsync()
+*
+* Description : Send data on Control IN endpoint asynchronously.
+*
+* Argument(s) : dev_nbr         Device number.
+*
+*               p_buf           Pointer to buffer of data that will be sent (see Note #1).
+*
+*               buf_len         Number of octets to transmit (see Note #2).
+*
+*               async_fnct      Function that will be invoked upon completion of transmit operation.
+*
+*               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
+*
+*               end             End-of-transfer flag (see Note #3).
+*
+*               p_err           Pointer to variable that will receive return error code from this function :
+*
+*                                   USBD_ERR_NONE               Transfer successfully queued.
+*                                   USBD_ERR_NULL_PTR           Argument 'async_fnct' passed a NULL pointer.
+*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                                   USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                               default/addressed/configured state.
+*                                   USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                                   USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                                   USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*
+*                                   - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                                   See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                                   - RETURNED BY USBD_EP_Tx() -
+*                                   See USBD_EP_Tx() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Transmit buffer must be at least aligned on a word, and must remain valid until
+*                   'async_fnct' is called.
+*
+*               (2) A zero-length transmit sends the zero-length packet of the status stage of a
+*                   control write or no-data transfer.
+*
+*               (3) If end-of-transfer is set and transfer length is multiple of maximum packet size,
+*                   a zero-length packet is transferred to indicate a short transfer to the host.
+*
+*               (4) This function is used by the core for the data and status stages of the standard
+*                   requests, and by the class drivers that defer a request with USBD_CtrlReqDefer().
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void  USBD_CtrlTxAsync (CPU_INT08U        dev_nbr,
+                        void             *p_buf,
+                        CPU_INT32U        buf_len,
+                        USBD_ASYNC_FNCT   async_fnct,
+                        void             *p_async_arg,
+                        CPU_BOOLEAN       end,
+                        USBD_ERR         *p_err)
+{
+    USBD_DRV        *p_drv;
+    USBD_EP         *p_ep;
+    CPU_INT08U       ep_phy_nbr;
+    USBD_DEV_STATE   state;
+
+
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlTxAsyncExecNbr);
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if ((state != USBD_DEV_STATE_DEFAULT)   &&
+        (state != USBD_DEV_STATE_ADDRESSED) &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_IN);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        return;
+    }
+                                                                /* Chk EP attrib.                                       */
+    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_CTRL) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep->Ix);
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        return;
+    }
+
+    (void)USBD_EP_Tx(                 p_drv,
+                                      p_ep,
+                                      p_buf,
+                                      buf_len,
+                     (USBD_BUF_SEG *)0,
+                                      0u,
+                                      async_fnct,
+                                      p_async_arg,
+                                      0u,
+                                      end,
+                                      p_err);
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
+
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlTxAsyncSuccessNbr, (*p_err == USBD_ERR_NONE));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_CtrlRxStatus()
+*
+* Description : Handle status stage from host on control (EP0) OUT endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               timeout_ms  Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Status stage successfully completed.
+*                               USBD_ERR_DEV_INVALID_STATE  Transfer type only available if device is in
+*                                                           default/addressed/configured state.
+*
+*                               - RETURNED BY USBD_DevStateGet() -
+*                               See USBD_DevStateGet() for additional return error codes.
+*
+*                               - RETURNED BY USBD_EP_RxZLP() -
+*                               See USBD_EP_RxZLP() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_CtrlRxStatus (CPU_INT08U   dev_nbr,
+                         CPU_INT16U   timeout_ms,
+                         USBD_ERR    *p_err)
+{
+    USBD_DEV_STATE  state;
+
+
+    USBD_DBG_STATS_DEV_INC(dev_nbr, CtrlRxStatusExecNbr);
+
+    state = USBD_DevStateGet(dev_nbr, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    if ((state != USBD_DEV_STATE_DEFAULT)   &&
+        (state != USBD_DEV_STATE_ADDRESSED) &&
+        (state != USBD_DEV_STATE_CONFIGURED)) {
+       *p_err  = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+
+    USBD_EP_RxZLP(dev_nbr,
+                  USBD_EP_ADDR_CTRL_OUT,
+                  timeout_ms,
+                  p_err);
+
+    USBD_DBG_STATS_DEV_INC_IF_TRUE(dev_nbr, CtrlRxStatusSuccessNbr, (*p_err == USBD_ERR_NONE));
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                     CONTROL ENDPOINT FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                           USBD_CtrlOpen()
+*
+* Description : Open control endpoints.
+*
+* Argument(s) : dev_nbr         Device number.
+*
+*               max_pkt_size    Maximum packet size.
+*
+*               p_err           Pointer to variable that will receive return error code from this function :
+*
+*                                   USBD_ERR_NONE               Control endpoint successfully opened.
+*                                   USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*
+*                                   - RETURNED BY USBD_EP_Open() -
+*                                   See USBD_EP_Open() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_CtrlOpen (CPU_INT08U   dev_nbr,
+                     CPU_INT16U   max_pkt_size,
+                     USBD_ERR    *p_err)
+{
+    USBD_DRV  *p_drv;
+    USBD_ERR   local_err;
+
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    USBD_EP_Open(p_drv,
+                 USBD_EP_ADDR_CTRL_IN,
+                 max_pkt_size,
+                 USBD_EP_TYPE_CTRL,
+                 0u,
+                 0u,
+                 p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    USBD_EP_Open(p_drv,
+                 USBD_EP_ADDR_CTRL_OUT,
+                 max_pkt_size,
+                 USBD_EP_TYPE_CTRL,
+                 0u,
+                 0u,
+                 p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_IN,  &local_err);
+        return;
+    }
+
+   *p_err = USBD_ERR_NONE;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlClose()
+*
+* Description : Close control endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Control endpoint successfully closed.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*
+*                               - RETURNED BY USBD_EP_Close() -
+*                               See USBD_EP_Close() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  USBD_CtrlClose (CPU_INT08U   dev_nbr,
+                      USBD_ERR    *p_err)
+{
+    USBD_DRV  *p_drv;
+    USBD_ERR   err_in;
+    USBD_ERR   err_out;
+
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_IN,  &err_in);
+    USBD_EP_Close(p_drv, USBD_EP_ADDR_CTRL_OUT, &err_out);
+
+    if (err_in != USBD_ERR_NONE) {
+       *p_err = err_in;
+    } else {
+       *p_err = err_out;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlStall()
+*
+* Description : Stall control endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Control endpoint successfully stalled.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                               USBD_ERR_EP_STALL           Device driver stall endpoint failed.
+*
+*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : None.
+*********************************************************************************************************
+*/
+
+void  USBD_CtrlStall (CPU_INT08U   dev_nbr,
+                      USBD_ERR    *p_err)
+{
+    USBD_EP       *p_ep_out;
+    USBD_EP       *p_ep_in;
+    USBD_DRV      *p_drv;
+    USBD_DRV_API  *p_drv_api;
+    CPU_INT08U     ep_phy_nbr;
+    CPU_BOOLEAN    stall_in;
+    CPU_BOOLEAN    stall_out;
+
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_OUT);
+    p_ep_out   = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_ADDR_CTRL_IN);
+    p_ep_in    = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if ((p_ep_out == (USBD_EP *)0) ||
+        (p_ep_in  == (USBD_EP *)0)) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep_out->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep_in->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                               p_ep_out->Ix);
+        return;
+    }
+
+    if ((p_ep_out->State == USBD_EP_STATE_OPEN) &&
+        (p_ep_in->State  == USBD_EP_STATE_OPEN)) {
+
+        p_drv_api = p_drv->API_Ptr;                             /* Get dev drv API struct.                              */
+        stall_in = p_drv_api->EP_Stall(p_drv,
+                                       USBD_EP_ADDR_CTRL_IN,
+                                       DEF_SET);
+
+        stall_out = p_drv_api->EP_Stall(p_drv,
+                                        USBD_EP_ADDR_CTRL_OUT,
+                                        DEF_SET);
+
+        if ((stall_in  == DEF_FAIL) ||
+            (stall_out == DEF_FAIL)) {
+           *p_err = USBD_ERR_EP_STALL;
+        } else {
+           *p_err = USBD_ERR_NONE;
+        }
+
+    } else {
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+    }
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep_in->Ix);
+
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep_out->Ix);
+}
+
+/*
+*********************************************************************************************************
+*                                          USBD_CtrlAbort()
+*
+* Description : Abort the transfers queued on the control endpoints.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Control endpoints successfully aborted.
+*
+*                               - RETURNED BY USBD_EP_Abort() -
+*                               See USBD_EP_Abort() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The callbacks of the aborted asynchronous transfers are called with the error
+*                   USBD_ERR_EP_ABORT before this function returns.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void  USBD_CtrlAbort (CPU_INT08U   dev_nbr,
+                      USBD_ERR    *p_err)
+{
+    USBD_ERR  err_in;
+
+
+    USBD_EP_Abort(dev_nbr, USBD_EP_ADDR_CTRL_IN,  &err_in);
+    USBD_EP_Abort(dev_nbr, USBD_EP_ADDR_CTRL_OUT,  p_err);
+    if (*p_err == USBD_ERR_NONE) {
+       *p_err = err_in;
+    }
+}
+#endif
+
+
+
+/*
 *********************************************************************************************************
 *********************************************************************************************************
 *                                     GENERAL ENDPOINT FUNCTIONS
@@ -2223,7 +3255,10 @@ void  USBD_CtrlStall (CPU_INT08U   dev_nbr,
 *
 * Description : Initialize endpoint structures.
 *
-* Argument(s) : none.
+* Argument(s) : p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE           Endpoint structures successfully initialized.
+*                               USBD_ERR_ALLOC          Endpoint bounce buffer allocation failed.
 *
 * Return(s)   : none.
 *
@@ -2231,15 +3266,34 @@ void  USBD_CtrlStall (CPU_INT08U   dev_nbr,
 *********************************************************************************************************
 */
 
-void  USBD_EP_Init (void)
+void  USBD_EP_Init (USBD_ERR  *p_err)
 {
     USBD_EP     *p_ep;
     USBD_URB    *p_urb;
     CPU_INT08U   ep_ix;
     CPU_INT08U   dev_nbr;
     CPU_INT16U   urb_ix;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    LIB_ERR      err_lib;
+#endif
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_INT64U   win_ts;
+    CPU_ERR      err_cpu;
+#endif
 
 
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    USBD_EP_DbgStatsTsFreq = (CPU_INT32U)CPU_TS_TmrFreqGet(&err_cpu);
+    if (USBD_EP_DbgStatsTsFreq == 0u) {
+        USBD_EP_DbgStatsTsFreq = 1u;
+    }
+                                                                /* Win len must fit in a signed TS diff.                */
+    win_ts = ((CPU_INT64U)USBD_EP_DbgStatsTsFreq * USBD_CFG_DBG_STATS_RATE_WIN_MS) / 1000u;
+    win_ts = DEF_MIN(win_ts, DEF_INT_32S_MAX_VAL);
+    win_ts = DEF_MAX(win_ts, 1u);
+    USBD_EP_DbgStatsRateWinTs = (CPU_INT32U)win_ts;
+#endif
+
     for (dev_nbr = 0u; dev_nbr < USBD_CFG_MAX_NBR_DEV; dev_nbr++) {
         for (ep_ix = 0u; ep_ix < USBD_EP_MAX_NBR; ep_ix++) {
             if (ep_ix < USBD_CFG_MAX_NBR_EP_OPEN) {
@@ -2249,11 +3303,30 @@ void  USBD_EP_Init (void)
                 p_ep->MaxPktSize    =  0u;
                 p_ep->Interval      =  0u;
                 p_ep->Ix            =  0u;
-#if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)
                 p_ep->URB_MainAvail =  DEF_YES;
+                p_ep->URB_MainLent  =  DEF_NO;
+#endif
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+                p_ep->URB_RsvdNbr     =  0u;
+                p_ep->URB_RsvdUsedCtr =  0u;
 #endif
                 p_ep->URB_HeadPtr   = (USBD_URB *)0;
                 p_ep->URB_TailPtr   = (USBD_URB *)0;
+#if (USBD_CFG_EP_SYNC_URB_EN == DEF_ENABLED)
+                p_ep->URB_Sync.State = USBD_URB_STATE_IDLE;
+#endif
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+                                                                /* Alloc bounce buf for vectored xfers from heap.       */
+                p_ep->VecBufPtr     = (CPU_INT08U *)Mem_HeapAlloc(              USBD_EP_VEC_BUF_LEN,
+                                                                                USBD_CFG_BUF_ALIGN_OCTETS,
+                                                                  (CPU_SIZE_T *)DEF_NULL,
+                                                                               &err_lib);
+                if (err_lib != LIB_MEM_ERR_NONE) {
+                   *p_err = USBD_ERR_ALLOC;
+                    return;
+                }
+#endif
 
                 USBD_DBG_STATS_EP_RESET(dev_nbr, ep_ix);
             }
@@ -2273,6 +3346,12 @@ void  USBD_EP_Init (void)
             p_urb->AsyncFnct    = (USBD_ASYNC_FNCT)0;
             p_urb->AsyncFnctArg = (void          *)0;
             p_urb->Err          =  USBD_ERR_NONE;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+            p_urb->SegTblPtr    = (USBD_BUF_SEG  *)0;
+            p_urb->SegNbr       =  0u;
+            p_urb->SegIx        =  0u;
+            p_urb->SegBaseLen   =  0u;
+#endif
             if (urb_ix < (USBD_URB_MAX_NBR - 1)) {
                 p_urb->NextPtr  = &USBD_URB_Tbl[dev_nbr][urb_ix + 1];
             } else {
@@ -2286,6 +3365,8 @@ void  USBD_EP_Init (void)
         USBD_URB_ExtraCtr[dev_nbr]  = 0u;
 #endif
     }
+
+   *p_err = USBD_ERR_NONE;
 }
 
 
@@ -2314,6 +3395,9 @@ void  USBD_EP_Init (void)
 *               (2) This condition covers also the case where the transfer length is multiple of the
 *                   maximum packet size. In that case, host sends a zero-length packet considered as
 *                   a short packet for the condition.
+*
+*               (3) A zero-length receive, such as the status stage of a control read transfer, is
+*                   completed with the driver's EP_RxZLP() function, as done by USBD_EP_RxZLP().
 *********************************************************************************************************
 */
 
@@ -2328,7 +3412,6 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
     USBD_ERR       local_err;
     USBD_URB      *p_urb;
     USBD_URB      *p_urb_cmpl;
-    CPU_INT08U    *p_buf_cur;
     CPU_INT32U     xfer_len;
     CPU_INT32U     xfer_rem;
 
@@ -2374,16 +3457,13 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
 
     p_urb_cmpl = (USBD_URB *)0;
     if (xfer_err == USBD_ERR_NONE) {                            /* See Note #1.                                         */
-        xfer_rem   =  p_urb->BufLen - p_urb->XferLen;
-        p_buf_cur  = &p_urb->BufPtr[p_urb->XferLen];
+        xfer_rem = p_urb->BufLen - p_urb->XferLen;
 
         if (ep_dir_in == DEF_YES) {                             /* ------------------- IN TRANSFER -------------------- */
             if (xfer_rem > 0u) {                                /* Another transaction must be done.                    */
                 USBD_EP_TxAsyncProcess(p_drv,
                                        p_ep,
                                        p_urb,
-                                       p_buf_cur,
-                                       xfer_rem,
                                       &local_err);
                 if (local_err != USBD_ERR_NONE) {
                     p_urb_cmpl = USBD_URB_AsyncCmpl(p_ep, local_err);
@@ -2408,11 +3488,17 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
         } else {                                                /* ------------------- OUT TRANSFER ------------------- */
             USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxNbr);
 
-            xfer_len = p_drv_api->EP_Rx(p_drv,
-                                        p_ep->Addr,
-                                        p_buf_cur,
-                                        p_urb->NextXferLen,
-                                       &local_err);
+            if (p_urb->BufLen == 0u) {                          /* Rx'd a ZLP (see Note #3).                            */
+                xfer_len = 0u;
+                p_drv_api->EP_RxZLP(p_drv,
+                                    p_ep->Addr,
+                                   &local_err);
+            } else {
+                xfer_len = USBD_EP_RxXferRd(p_drv,
+                                            p_ep,
+                                            p_urb,
+                                           &local_err);
+            }
             if (local_err != USBD_ERR_NONE) {
                 p_urb_cmpl = USBD_URB_AsyncCmpl(p_ep, local_err);
             } else {
@@ -2425,15 +3511,10 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
                     (p_urb->XferLen == p_urb->BufLen)) {        /* All bytes rx'd.                                      */
                                                                 /* Xfer finished.                                       */
                     p_urb_cmpl = USBD_URB_AsyncCmpl(p_ep, USBD_ERR_NONE);
-                } else {
-                    p_buf_cur = &p_urb->BufPtr[p_urb->XferLen]; /* Xfer not finished.                                   */
-                    xfer_len  =  p_urb->BufLen - p_urb->XferLen;
-
+                } else {                                        /* Xfer not finished.                                   */
                     USBD_EP_RxStartAsyncProcess(p_drv,
                                                 p_ep,
                                                 p_urb,
-                                                p_buf_cur,
-                                                xfer_len,
                                                &local_err);
                     if (local_err != USBD_ERR_NONE) {
                         p_urb_cmpl = USBD_URB_AsyncCmpl(p_ep, local_err);
@@ -2470,6 +3551,8 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
 *
 *               interval        Endpoint polling interval.
 *
+*               urb_nbr_rsvd    Number of URBs reserved for the endpoint (see Note #1).
+*
 *               p_err           Pointer to variable that will receive return error code from this function :
 *
 *                                   USBD_ERR_NONE               Endpoint successfully opened.
@@ -2488,7 +3571,8 @@ void  USBD_EP_XferAsyncProcess (USBD_DRV    *p_drv,
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The total number of reserved URBs is validated by USBD_EP_URB_RsvdSet() against
+*                   USBD_CFG_MAX_NBR_URB_RSVD.
 *********************************************************************************************************
 */
 
@@ -2497,6 +3581,7 @@ void  USBD_EP_Open (USBD_DRV    *p_drv,
                     CPU_INT16U   max_pkt_size,
                     CPU_INT08U   attrib,
                     CPU_INT08U   interval,
+                    CPU_INT08U   urb_nbr_rsvd,
                     USBD_ERR    *p_err)
 {
     USBD_DRV_API  *p_drv_api;
@@ -2573,6 +3658,11 @@ void  USBD_EP_Open (USBD_DRV    *p_drv,
     p_ep->State      = USBD_EP_STATE_OPEN;
     p_ep->XferState  = USBD_XFER_STATE_NONE;
     p_ep->Ix         = ep_ix;
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+    p_ep->URB_RsvdNbr = urb_nbr_rsvd;
+#else
+    (void)urb_nbr_rsvd;
+#endif
 
     USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr] = p_ep;
     CPU_CRITICAL_EXIT();
@@ -3124,6 +4214,9 @@ void  USBD_EP_RxCmpl (USBD_DRV    *p_drv,
     }
 
     USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, RxCmplNbr);
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_ep->StatsCmplTs = CPU_TS_Get32();
+#endif
 
     if (p_ep->XferState == USBD_XFER_STATE_SYNC) {
         USBD_OS_EP_SignalPost(p_drv->DevNbr, p_ep->Ix, &err);
@@ -3176,6 +4269,9 @@ void  USBD_EP_TxCmpl (USBD_DRV    *p_drv,
     }
 
     USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplNbr);
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_ep->StatsCmplTs = CPU_TS_Get32();
+#endif
 
     if (p_ep->XferState == USBD_XFER_STATE_SYNC) {
         USBD_OS_EP_SignalPost(p_drv->DevNbr, p_ep->Ix, &err);
@@ -3217,42 +4313,177 @@ void  USBD_EP_TxCmplExt (USBD_DRV    *p_drv,
     USBD_ERR     local_err;
 
 
-#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
-    if (p_drv == (USBD_DRV *)0) {
-        return;
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)
+    if (p_drv == (USBD_DRV *)0) {
+        return;
+    }
+#endif
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_LOG_TO_ADDR_IN(ep_log_nbr));
+    p_ep       = USBD_EP_TblPtrs[p_drv->DevNbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplErrNbr);
+        return;
+    }
+
+    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplNbr);
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_ep->StatsCmplTs = CPU_TS_Get32();
+#endif
+
+    if (p_ep->XferState == USBD_XFER_STATE_SYNC) {
+        USBD_OS_EP_SignalAbort(p_drv->DevNbr, p_ep->Ix, &local_err);
+        if (local_err != USBD_ERR_NONE) {
+            USBD_DBG_EP_ERR("USBD_EP_TxCmplExt()", p_ep->Addr, local_err);
+        }
+    } else if ((p_ep->XferState == USBD_XFER_STATE_ASYNC) ||
+               (p_ep->XferState == USBD_XFER_STATE_ASYNC_PARTIAL)) {
+        USBD_EventEP(p_drv, p_ep->Addr, xfer_err);
+    } else {
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplErrNbr);
+        USBD_DBG_EP("USBD_EP_TxCmplExt(): incorrect XferState", p_ep->Addr);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           USBD_EP_TxZLP()
+*
+* Description : Send zero-length packet to the host.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               timeout_ms  Timeout in milliseconds.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Data successfully transferred.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
+*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
+*                               USBD_ERR_EP_IO_PENDING      Data already queued on this endpoint.
+*
+*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
+*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
+*
+*                               - RETURNED BY USBD_URB_Get() -
+*                               See USBD_URB_Get() for additional return error codes.
+*
+*                               - RETURNED BY 'p_drv_api->EP_TxZLP()' -
+*                               See specific driver(s) 'p_drv_api->EP_TxZLP()' for additional return error codes.
+*
+*                               - RETURNED BY USBD_OS_EP_SignalPend() -
+*                               See USBD_OS_EP_SignalPend() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) This function should only be called during a synchronous transfer.
+*********************************************************************************************************
+*/
+
+void  USBD_EP_TxZLP (CPU_INT08U   dev_nbr,
+                     CPU_INT08U   ep_addr,
+                     CPU_INT16U   timeout_ms,
+                     USBD_ERR    *p_err)
+{
+    USBD_EP       *p_ep;
+    USBD_URB      *p_urb;
+    USBD_DRV      *p_drv;
+    USBD_DRV_API  *p_drv_api;
+    CPU_INT08U     ep_phy_nbr;
+    USBD_ERR       local_err;
+
+
+    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
+    if (p_drv == (USBD_DRV *)0) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
+    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
+
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
+                           p_ep->Ix,
+                           0u,
+                           p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return;
+    }
+
+    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, TxZLP_ExecNbr);
+
+    if (p_ep->State != USBD_EP_STATE_OPEN) {
+       *p_err = USBD_ERR_EP_INVALID_STATE;
+        goto lock_release;
+    }
+                                                                /* Chk EP attrib.                                       */
+    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) == USBD_EP_TYPE_ISOC) {
+       *p_err = USBD_ERR_EP_INVALID_TYPE;
+        goto lock_release;
+    }
+
+    if (p_ep->XferState != USBD_XFER_STATE_NONE) {
+       *p_err = USBD_ERR_EP_IO_PENDING;
+        goto lock_release;
+    }
+
+    p_urb = USBD_URB_SyncGet(dev_nbr, p_ep, p_err);             /* Set XferState before submitting xfer.                */
+    if (*p_err != USBD_ERR_NONE) {
+        goto lock_release;
     }
-#endif
 
-    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(USBD_EP_LOG_TO_ADDR_IN(ep_log_nbr));
-    p_ep       = USBD_EP_TblPtrs[p_drv->DevNbr][ep_phy_nbr];
+    p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
 
-    if (p_ep == (USBD_EP *)0) {
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplErrNbr);
-        return;
-    }
+    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxZLP_Nbr);
 
-    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplNbr);
+    p_drv_api->EP_TxZLP(p_drv, ep_addr, p_err);
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxZLP_SuccessNbr);
 
-    if (p_ep->XferState == USBD_XFER_STATE_SYNC) {
-        USBD_OS_EP_SignalAbort(p_drv->DevNbr, p_ep->Ix, &local_err);
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion.                 */
+                               p_ep->Ix);
+
+        USBD_OS_EP_SignalPend(dev_nbr, p_ep->Ix, timeout_ms, p_err);
+
+        USBD_OS_EP_LockAcquire(p_drv->DevNbr,                   /* Re-lock EP after xfer completion.                    */
+                               p_ep->Ix,
+                               0u,
+                              &local_err);
         if (local_err != USBD_ERR_NONE) {
-            USBD_DBG_EP_ERR("USBD_EP_TxCmplExt()", p_ep->Addr, local_err);
+           *p_err = USBD_ERR_OS_FAIL;
+
+        } else if (*p_err == USBD_ERR_OS_TIMEOUT) {
+            p_drv_api->EP_Abort(p_drv, ep_addr);
+            USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxSyncTimeoutErrNbr);
         }
-    } else if ((p_ep->XferState == USBD_XFER_STATE_ASYNC) ||
-               (p_ep->XferState == USBD_XFER_STATE_ASYNC_PARTIAL)) {
-        USBD_EventEP(p_drv, p_ep->Addr, xfer_err);
-    } else {
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxCmplErrNbr);
-        USBD_DBG_EP("USBD_EP_TxCmplExt(): incorrect XferState", p_ep->Addr);
     }
+
+    USBD_URB_SyncFree(dev_nbr, p_ep, p_urb);
+
+    USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, TxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
+
+lock_release:
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
 }
 
 
 /*
 *********************************************************************************************************
-*                                           USBD_EP_TxZLP()
+*                                           USBD_EP_RxZLP()
 *
-* Description : Send zero-length packet to the host.
+* Description : Receive zero-length packet from the host.
 *
 * Argument(s) : dev_nbr     Device number.
 *
@@ -3275,19 +4506,22 @@ void  USBD_EP_TxCmplExt (USBD_DRV    *p_drv,
 *                               - RETURNED BY USBD_URB_Get() -
 *                               See USBD_URB_Get() for additional return error codes.
 *
-*                               - RETURNED BY 'p_drv_api->EP_TxZLP()' -
-*                               See specific driver(s) 'p_drv_api->EP_TxZLP()' for additional return error codes.
-*
 *                               - RETURNED BY USBD_OS_EP_SignalPend() -
 *                               See USBD_OS_EP_SignalPend() for additional return error codes.
 *
+*                               - RETURNED BY 'p_drv_api->EP_RxStart()' -
+*                               See specific driver(s) 'p_drv_api->EP_RxStart()' for additional return error codes.
+*
+*                               - RETURNED BY 'p_drv_api->EP_RxZLP()' -
+*                               See specific driver(s) 'p_drv_api->EP_RxZLP()' for additional return error codes.
+*
 * Return(s)   : none.
 *
 * Note(s)     : (1) This function should only be called during a synchronous transfer.
 *********************************************************************************************************
 */
 
-void  USBD_EP_TxZLP (CPU_INT08U   dev_nbr,
+void  USBD_EP_RxZLP (CPU_INT08U   dev_nbr,
                      CPU_INT08U   ep_addr,
                      CPU_INT16U   timeout_ms,
                      USBD_ERR    *p_err)
@@ -3322,13 +4556,13 @@ void  USBD_EP_TxZLP (CPU_INT08U   dev_nbr,
         return;
     }
 
-    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, TxZLP_ExecNbr);
+    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, RxZLP_ExecNbr);
 
     if (p_ep->State != USBD_EP_STATE_OPEN) {
        *p_err = USBD_ERR_EP_INVALID_STATE;
         goto lock_release;
     }
-                                                                /* Chk EP attrib.                                       */
+
     if ((p_ep->Attrib & USBD_EP_TYPE_MASK) == USBD_EP_TYPE_ISOC) {
        *p_err = USBD_ERR_EP_INVALID_TYPE;
         goto lock_release;
@@ -3339,283 +4573,634 @@ void  USBD_EP_TxZLP (CPU_INT08U   dev_nbr,
         goto lock_release;
     }
 
-    p_urb = USBD_URB_Get(dev_nbr, p_ep, p_err);
+    p_urb = USBD_URB_SyncGet(dev_nbr, p_ep, p_err);             /* Set XferState before submitting xfer.                */
     if (*p_err != USBD_ERR_NONE) {
         goto lock_release;
     }
 
-    p_urb->State    = USBD_URB_STATE_XFER_SYNC;                 /* Only State needs to be set to indicate sync xfer.    */
-    p_ep->XferState = USBD_XFER_STATE_SYNC;                     /* Set XferState before submitting xfer.                */
+    p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
+    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxStartNbr);
+    (void)p_drv_api->EP_RxStart(              p_drv,
+                                              ep_addr,
+                                (CPU_INT08U *)0u,
+                                              0u,
+                                              p_err);
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxStartSuccessNbr);
 
-    USBD_URB_Queue(p_ep, p_urb);
+        USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion.                 */
+                               p_ep->Ix);
 
-    p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
+        USBD_OS_EP_SignalPend(dev_nbr, p_ep->Ix, timeout_ms, p_err);
 
-    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxZLP_Nbr);
+        USBD_OS_EP_LockAcquire(p_drv->DevNbr,                   /* Re-lock EP after xfer completion.                    */
+                               p_ep->Ix,
+                               0u,
+                              &local_err);
+        if ((*p_err    == USBD_ERR_NONE) &&
+            (local_err == USBD_ERR_NONE)) {
+            USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxZLP_Nbr);
 
-    p_drv_api->EP_TxZLP(p_drv, ep_addr, p_err);
-    if (*p_err == USBD_ERR_NONE) {
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxZLP_SuccessNbr);
+            p_drv_api->EP_RxZLP(p_drv,
+                                ep_addr,
+                                p_err);
+            USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, DrvRxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
+
+        } else if (*p_err == USBD_ERR_OS_TIMEOUT) {
+
+            p_drv_api->EP_Abort(p_drv, ep_addr);
+            USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, RxSyncTimeoutErrNbr);
+
+        } else if (local_err != USBD_ERR_NONE) {
+           *p_err = USBD_ERR_OS_FAIL;
+        }
+    }
+
+    USBD_URB_SyncFree(dev_nbr, p_ep, p_urb);
+
+    USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, RxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
+
+lock_release:
+    USBD_OS_EP_LockRelease(p_drv->DevNbr,
+                           p_ep->Ix);
+}
+
+
+/*
+*********************************************************************************************************
+*                                   USBD_DbgStatsEP_PerfSnapshot()
+*
+* Description : Copy the latency and throughput statistics of an endpoint and optionally reset them.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_perf      Pointer to variable that will receive the statistics.
+*
+*               reset       Flag indicating whether to reset the statistics once copied :
+*
+*                               DEF_YES     Reset statistics.
+*                               DEF_NO      Keep    statistics.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Statistics successfully copied.
+*                               USBD_ERR_NULL_PTR           Null pointer passed to 'p_perf'.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The copy and the reset are done in a single critical section, so no transfer is
+*                   counted twice or lost between two consecutive snapshots.
+*
+*               (2) The statistics of an endpoint are also reset when the endpoint is opened.
+*********************************************************************************************************
+*/
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+void  USBD_DbgStatsEP_PerfSnapshot (CPU_INT08U               dev_nbr,
+                                    CPU_INT08U               ep_addr,
+                                    USBD_DBG_STATS_EP_PERF  *p_perf,
+                                    CPU_BOOLEAN              reset,
+                                    USBD_ERR                *p_err)
+{
+    USBD_EP                 *p_ep;
+    USBD_DBG_STATS_EP_PERF  *p_perf_ep;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(;);
+    }
+
+    if (p_perf == (USBD_DBG_STATS_EP_PERF *)0) {
+       *p_err = USBD_ERR_NULL_PTR;
+        return;
+    }
+#endif
+
+    if (dev_nbr >= USBD_CFG_MAX_NBR_DEV) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return;
+    }
+
+    p_ep = USBD_EP_TblPtrs[dev_nbr][USBD_EP_ADDR_TO_PHY(ep_addr)];
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return;
+    }
+
+    p_perf_ep = &USBD_DbgStatsEP_Tbl[dev_nbr][p_ep->Ix].Perf;
+
+    CPU_CRITICAL_ENTER();                                       /* See Note #1.                                         */
+    Mem_Copy((void     *)p_perf,
+             (void     *)p_perf_ep,
+             (CPU_SIZE_T)sizeof(USBD_DBG_STATS_EP_PERF));
+    if (reset == DEF_YES) {
+        Mem_Clr((void     *)p_perf_ep,
+                (CPU_SIZE_T)sizeof(USBD_DBG_STATS_EP_PERF));
+    }
+    CPU_CRITICAL_EXIT();
+
+   *p_err = USBD_ERR_NONE;
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_DbgStatsEP_LatGet()
+*
+* Description : Get a percentile of the latency of a transfer stage on an endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               stage       Transfer stage :
+*
+*                               USBD_DBG_STATS_LAT_SUBMIT   Submission to driver start.
+*                               USBD_DBG_STATS_LAT_XFER     Driver start to driver completion.
+*                               USBD_DBG_STATS_LAT_CMPL     Driver completion to callback.
+*                               USBD_DBG_STATS_LAT_TOTAL    Submission to callback.
+*
+*               pct         Percentile, between 0 and 100 (see Note #1).
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Latency successfully returned.
+*                               USBD_ERR_INVALID_ARG        Invalid stage or percentile.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*
+* Return(s)   : Latency in microseconds, if NO error(s).
+*
+*               0,                       otherwise.
+*
+* Note(s)     : (1) The latency returned is the upper bound of the histogram bucket holding the
+*                   requested percentile, capped to the maximum latency measured. A percentile of 100
+*                   thus returns the maximum latency, and a percentile of 0 the upper bound of the
+*                   first non-empty bucket.
+*********************************************************************************************************
+*/
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+CPU_INT32U  USBD_DbgStatsEP_LatGet (CPU_INT08U   dev_nbr,
+                                    CPU_INT08U   ep_addr,
+                                    CPU_INT08U   stage,
+                                    CPU_INT08U   pct,
+                                    USBD_ERR    *p_err)
+{
+    USBD_EP                 *p_ep;
+    USBD_DBG_STATS_EP_PERF  *p_perf;
+    CPU_INT32U               hist[USBD_CFG_DBG_STATS_LAT_NBR_BUCKET];
+    CPU_INT32U               lat_max;
+    CPU_INT32U               lat;
+    CPU_INT64U               cnt_tot;
+    CPU_INT64U               cnt_target;
+    CPU_INT64U               cnt;
+    CPU_INT08U               bucket;
+    CPU_SR_ALLOC();
+
+
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(0u);
+    }
+#endif
+
+    if ((stage >= USBD_DBG_STATS_LAT_NBR_STAGE) ||
+        (pct   >  100u)) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return (0u);
+    }
+
+    if (dev_nbr >= USBD_CFG_MAX_NBR_DEV) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return (0u);
+    }
+
+    p_ep = USBD_EP_TblPtrs[dev_nbr][USBD_EP_ADDR_TO_PHY(ep_addr)];
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return (0u);
+    }
+
+    p_perf = &USBD_DbgStatsEP_Tbl[dev_nbr][p_ep->Ix].Perf;
+
+    CPU_CRITICAL_ENTER();
+    Mem_Copy((void     *)&hist[0u],
+             (void     *)&p_perf->LatHist[stage][0u],
+             (CPU_SIZE_T) sizeof(hist));
+    lat_max = p_perf->LatMax[stage];
+    CPU_CRITICAL_EXIT();
+
+   *p_err = USBD_ERR_NONE;
+
+    cnt_tot = 0u;
+    for (bucket = 0u; bucket < USBD_CFG_DBG_STATS_LAT_NBR_BUCKET; bucket++) {
+        cnt_tot += hist[bucket];
+    }
+    if (cnt_tot == 0u) {                                        /* No xfer measured.                                    */
+        return (0u);
+    }
+                                                                /* Rank of percentile, rounded up.                      */
+    cnt_target = ((cnt_tot * pct) + 99u) / 100u;
+    cnt_target = DEF_MAX(cnt_target, 1u);
+
+    cnt = 0u;
+    for (bucket = 0u; bucket < (USBD_CFG_DBG_STATS_LAT_NBR_BUCKET - 1u); bucket++) {
+        cnt += hist[bucket];
+        if (cnt >= cnt_target) {
+            break;
+        }
+    }
+
+    if (bucket == (USBD_CFG_DBG_STATS_LAT_NBR_BUCKET - 1u)) {   /* Last bucket is unbounded.                            */
+        lat = lat_max;
+    } else {                                                    /* Upper bound of bucket (see 'usbd_cfg.h').            */
+        lat = (CPU_INT32U)(((CPU_INT64U)1u << bucket) - 1u);
+        lat = DEF_MIN(lat, lat_max);
+    }
+
+    return (USBD_EP_DbgStatsTsToUs(lat));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_DbgStatsEP_RateGet()
+*
+* Description : Get the throughput of an endpoint.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               ep_addr     Endpoint address.
+*
+*               p_err       Pointer to variable that will receive the return error code from this function :
+*
+*                               USBD_ERR_NONE               Throughput successfully returned.
+*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
+*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
+*
+* Return(s)   : Throughput in octets per second, if NO error(s).
+*
+*               0,                                otherwise.
+*
+* Note(s)     : (1) The throughput window is only closed when a transfer completes. If the current
+*                   window is already longer than USBD_CFG_DBG_STATS_RATE_WIN_MS, the throughput is
+*                   computed over it instead, so that the throughput of an idle endpoint decays to 0.
+*********************************************************************************************************
+*/
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+CPU_INT32U  USBD_DbgStatsEP_RateGet (CPU_INT08U   dev_nbr,
+                                     CPU_INT08U   ep_addr,
+                                     USBD_ERR    *p_err)
+{
+    USBD_EP                 *p_ep;
+    USBD_DBG_STATS_EP_PERF  *p_perf;
+    CPU_INT32U               rate;
+    CPU_INT32U               win_octet_cnt;
+    CPU_INT32U               win_elapsed;
+    CPU_INT32U               xfer_nbr;
+    CPU_SR_ALLOC();
 
-        USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion.                 */
-                               p_ep->Ix);
 
-        USBD_OS_EP_SignalPend(dev_nbr, p_ep->Ix, timeout_ms, p_err);
+#if (USBD_CFG_ERR_ARG_CHK_EXT_EN == DEF_ENABLED)                /* ---------------- VALIDATE ARGUMENTS ---------------- */
+    if (p_err == (USBD_ERR *)0) {                               /* Validate error ptr.                                  */
+        CPU_SW_EXCEPTION(0u);
+    }
+#endif
 
-        USBD_OS_EP_LockAcquire(p_drv->DevNbr,                   /* Re-lock EP after xfer completion.                    */
-                               p_ep->Ix,
-                               0u,
-                              &local_err);
-        if (local_err != USBD_ERR_NONE) {
-           *p_err = USBD_ERR_OS_FAIL;
+    if (dev_nbr >= USBD_CFG_MAX_NBR_DEV) {
+       *p_err = USBD_ERR_DEV_INVALID_NBR;
+        return (0u);
+    }
 
-        } else if (*p_err == USBD_ERR_OS_TIMEOUT) {
-            p_drv_api->EP_Abort(p_drv, ep_addr);
-            USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, TxSyncTimeoutErrNbr);
-        }
+    p_ep = USBD_EP_TblPtrs[dev_nbr][USBD_EP_ADDR_TO_PHY(ep_addr)];
+    if (p_ep == (USBD_EP *)0) {
+       *p_err = USBD_ERR_EP_INVALID_ADDR;
+        return (0u);
     }
 
-    USBD_URB_Dequeue(p_ep);
+    p_perf = &USBD_DbgStatsEP_Tbl[dev_nbr][p_ep->Ix].Perf;
 
-    USBD_URB_Free(dev_nbr, p_ep, p_urb);
+    CPU_CRITICAL_ENTER();
+    rate          = p_perf->Rate;
+    win_octet_cnt = p_perf->RateWinOctetCnt;
+    win_elapsed   = CPU_TS_Get32() - p_perf->RateWinStartTs;
+    xfer_nbr      = p_perf->XferNbr;
+    CPU_CRITICAL_EXIT();
 
-    USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, TxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
+   *p_err = USBD_ERR_NONE;
 
-lock_release:
-    USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                           p_ep->Ix);
+    if ((xfer_nbr    != 0u) &&                                  /* See Note #1.                                         */
+        (win_elapsed >= USBD_EP_DbgStatsRateWinTs)) {
+        rate = (CPU_INT32U)(((CPU_INT64U)win_octet_cnt * USBD_EP_DbgStatsTsFreq) / win_elapsed);
+    }
+
+    return (rate);
 }
+#endif
 
 
 /*
 *********************************************************************************************************
-*                                           USBD_EP_RxZLP()
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                     USBD_EP_RxStartAsyncProcess()
 *
-* Description : Receive zero-length packet from the host.
+* Description : Process driver's asynchronous RxStart operation.
 *
-* Argument(s) : dev_nbr     Device number.
+* Argument(s) : p_drv       Pointer to device driver structure.
 *
-*               ep_addr     Endpoint address.
+*               p_ep        Pointer to endpoint on which data will be received.
 *
-*               timeout_ms  Timeout in milliseconds.
+*               p_urb       Pointer to USB request block.
 *
 *               p_err       Pointer to variable that will receive return error code from this function :
 *
-*                               USBD_ERR_NONE               Data successfully transferred.
-*                               USBD_ERR_DEV_INVALID_NBR    Invalid device number.
-*                               USBD_ERR_EP_INVALID_ADDR    Invalid endpoint address.
-*                               USBD_ERR_EP_INVALID_STATE   Invalid endpoint state.
-*                               USBD_ERR_EP_INVALID_TYPE    Invalid endpoint type.
-*                               USBD_ERR_EP_IO_PENDING      Data already queued on this endpoint.
-*
-*                               - RETURNED BY USBD_OS_EP_LockAcquire() -
-*                               See USBD_OS_EP_LockAcquire() for additional return error codes.
-*
-*                               - RETURNED BY USBD_URB_Get() -
-*                               See USBD_URB_Get() for additional return error codes.
-*
-*                               - RETURNED BY USBD_OS_EP_SignalPend() -
-*                               See USBD_OS_EP_SignalPend() for additional return error codes.
-*
-*                               - RETURNED BY 'p_drv_api->EP_RxStart()' -
-*                               See specific driver(s) 'p_drv_api->EP_RxStart()' for additional return error codes.
+*                               USBD_ERR_NONE               Receive successfully configured.
 *
-*                               - RETURNED BY 'p_drv_api->EP_RxZLP()' -
-*                               See specific driver(s) 'p_drv_api->EP_RxZLP()' for additional return error codes.
+*                               - RETURNED BY USBD_EP_RxXferStart() -
+*                               See USBD_EP_RxXferStart() for additional return error codes.
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) This function should only be called during a synchronous transfer.
+* Note(s)     : (1) Endpoint must be locked when calling this function.
 *********************************************************************************************************
 */
 
-void  USBD_EP_RxZLP (CPU_INT08U   dev_nbr,
-                     CPU_INT08U   ep_addr,
-                     CPU_INT16U   timeout_ms,
-                     USBD_ERR    *p_err)
+static  void  USBD_EP_RxStartAsyncProcess (USBD_DRV    *p_drv,
+                                           USBD_EP     *p_ep,
+                                           USBD_URB    *p_urb,
+                                           USBD_ERR    *p_err)
 {
-    USBD_EP       *p_ep;
-    USBD_URB      *p_urb;
-    USBD_DRV      *p_drv;
-    USBD_DRV_API  *p_drv_api;
-    CPU_INT08U     ep_phy_nbr;
-    USBD_ERR       local_err;
-
-
-    p_drv = USBD_DrvRefGet(dev_nbr);                            /* Get dev struct.                                      */
-    if (p_drv == (USBD_DRV *)0) {
-       *p_err = USBD_ERR_DEV_INVALID_NBR;
-        return;
-    }
+    CPU_BOOLEAN  xfer_whole;
+    CPU_SR_ALLOC();
 
-    ep_phy_nbr = USBD_EP_ADDR_TO_PHY(ep_addr);
-    p_ep       = USBD_EP_TblPtrs[dev_nbr][ep_phy_nbr];
 
-    if (p_ep == (USBD_EP *)0) {
-       *p_err = USBD_ERR_EP_INVALID_ADDR;
+    xfer_whole = USBD_EP_RxXferStart(p_drv,
+                                     p_ep,
+                                     p_urb,
+                                     p_err);
+    if (*p_err != USBD_ERR_NONE) {
         return;
     }
 
-    USBD_OS_EP_LockAcquire(p_drv->DevNbr,
-                           p_ep->Ix,
-                           0u,
-                           p_err);
-    if (*p_err != USBD_ERR_NONE) {
-        return;
+    if (xfer_whole == DEF_NO) {
+        CPU_CRITICAL_ENTER();
+        p_ep->XferState = USBD_XFER_STATE_ASYNC_PARTIAL;        /* Xfer will have to be done in many transactions.      */
+        CPU_CRITICAL_EXIT();
     }
+}
 
-    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, RxZLP_ExecNbr);
 
-    if (p_ep->State != USBD_EP_STATE_OPEN) {
-       *p_err = USBD_ERR_EP_INVALID_STATE;
-        goto lock_release;
-    }
+/*
+*********************************************************************************************************
+*                                       USBD_EP_TxAsyncProcess()
+*
+* Description : Process driver's asynchronous Tx operation.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               p_ep        Pointer to endpoint on which data will be transmitted.
+*
+*               p_urb       Pointer to USB request block.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Transmit successfully configured.
+*
+*                               - RETURNED BY USBD_EP_TxXferStart() -
+*                               See USBD_EP_TxXferStart() for additional return error codes.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Endpoint must be locked when calling this function.
+*********************************************************************************************************
+*/
 
-    if ((p_ep->Attrib & USBD_EP_TYPE_MASK) == USBD_EP_TYPE_ISOC) {
-       *p_err = USBD_ERR_EP_INVALID_TYPE;
-        goto lock_release;
-    }
+static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
+                                      USBD_EP     *p_ep,
+                                      USBD_URB    *p_urb,
+                                      USBD_ERR    *p_err)
+{
+    CPU_BOOLEAN  xfer_whole;
 
-    if (p_ep->XferState != USBD_XFER_STATE_NONE) {
-       *p_err = USBD_ERR_EP_IO_PENDING;
-        goto lock_release;
-    }
 
-    p_urb = USBD_URB_Get(dev_nbr, p_ep, p_err);
+    xfer_whole = USBD_EP_TxXferStart(p_drv,
+                                     p_ep,
+                                     p_urb,
+                                     p_err);
     if (*p_err != USBD_ERR_NONE) {
-        goto lock_release;
+        return;
     }
 
-    p_urb->State    = USBD_URB_STATE_XFER_SYNC;                 /* Only State needs to be set to indicate sync xfer.    */
-    p_ep->XferState = USBD_XFER_STATE_SYNC;                     /* Set XferState before submitting xfer.                */
+    if (xfer_whole == DEF_YES) {                                /* Xfer can be done is a single transaction.            */
+        p_ep->XferState = USBD_XFER_STATE_ASYNC;
+    } else {
+        p_ep->XferState = USBD_XFER_STATE_ASYNC_PARTIAL;        /* Xfer will have to be done in many transactions.      */
+    }
 
-    USBD_URB_Queue(p_ep, p_urb);
+    p_urb->XferLen     += p_urb->NextXferLen;                   /* Error not accounted on total xfer len.               */
+    p_urb->NextXferLen  = 0u;
 
-    p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
-    USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxStartNbr);
-    (void)p_drv_api->EP_RxStart(              p_drv,
-                                              ep_addr,
-                                (CPU_INT08U *)0u,
-                                              0u,
-                                              p_err);
-    if (*p_err == USBD_ERR_NONE) {
-        USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxStartSuccessNbr);
+    return;
+}
 
-        USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion.                 */
-                               p_ep->Ix);
 
-        USBD_OS_EP_SignalPend(dev_nbr, p_ep->Ix, timeout_ms, p_err);
+/*
+*********************************************************************************************************
+*                                        USBD_EP_RxXferStart()
+*
+* Description : Start the reception of the next part of a transfer.
+*
+* Argument(s) : p_drv       Pointer to device driver structure.
+*
+*               p_ep        Pointer to endpoint on which data will be received.
+*
+*               p_urb       Pointer to USB request block.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Receive successfully configured.
+*
+*                               - RETURNED BY 'p_drv_api->EP_RxStart()' -
+*                               See specific driver(s) 'p_drv_api->EP_RxStart()' for additional return error codes.
+*
+*                               - RETURNED BY 'p_drv_api->EP_RxVecStart()' -
+*                               See specific driver(s) 'p_drv_api->EP_RxVecStart()' for additional return error codes.
+*
+* Return(s)   : DEF_YES, if the remaining of the transfer has been entirely submitted to the driver,
+*
+*               DEF_NO,  otherwise (see Note #3).
+*
+* Note(s)     : (1) Endpoint must be locked when calling this function.
+*
+*               (2) The number of octets submitted to the driver is stored in 'p_urb->NextXferLen'.
+*
+*               (3) A transaction that goes through the endpoint bounce buffer is never reported as a
+*                   whole transfer, so that no other transfer gets submitted while the bounce buffer is
+*                   in use.
+*********************************************************************************************************
+*/
 
-        USBD_OS_EP_LockAcquire(p_drv->DevNbr,                   /* Re-lock EP after xfer completion.                    */
-                               p_ep->Ix,
-                               0u,
-                              &local_err);
-        if ((*p_err    == USBD_ERR_NONE) &&
-            (local_err == USBD_ERR_NONE)) {
-            USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, DrvRxZLP_Nbr);
+static  CPU_BOOLEAN  USBD_EP_RxXferStart (USBD_DRV  *p_drv,
+                                          USBD_EP   *p_ep,
+                                          USBD_URB  *p_urb,
+                                          USBD_ERR  *p_err)
+{
+    USBD_DRV_API  *p_drv_api;
+    CPU_INT08U    *p_buf_cur;
+    CPU_INT32U     xfer_rem;
+    CPU_INT32U     len;
 
-            p_drv_api->EP_RxZLP(p_drv,
-                                ep_addr,
-                                p_err);
-            USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, DrvRxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
 
-        } else if (*p_err == USBD_ERR_OS_TIMEOUT) {
+    p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
+    xfer_rem  = p_urb->BufLen - p_urb->XferLen;
 
-            p_drv_api->EP_Abort(p_drv, ep_addr);
-            USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, RxSyncTimeoutErrNbr);
+    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartNbr);
 
-        } else if (local_err != USBD_ERR_NONE) {
-           *p_err = USBD_ERR_OS_FAIL;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if ((DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_VEC) == DEF_YES) &&
+        (p_urb->XferLen                                  == 0u)      &&
+        (p_drv_api->EP_RxVecStart                        != (void *)0)) {
+                                                                /* Let drv chain its descriptors over the seg tbl.      */
+        p_urb->NextXferLen = p_drv_api->EP_RxVecStart(p_drv,
+                                                      p_ep->Addr,
+                                                      p_urb->SegTblPtr,
+                                                      p_urb->SegNbr,
+                                                      p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return (DEF_NO);
         }
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartSuccessNbr);
+
+        DEF_BIT_SET(p_urb->Flags, USBD_URB_FLAG_VEC_DRV);
+
+        return ((p_urb->NextXferLen == xfer_rem) ? DEF_YES : DEF_NO);
     }
+#endif
 
-    USBD_URB_Dequeue(p_ep);
+    p_buf_cur = USBD_URB_BufCurGet(p_ep, p_urb, DEF_NO, &len);
 
-    USBD_URB_Free(dev_nbr, p_ep, p_urb);
+    p_urb->NextXferLen = p_drv_api->EP_RxStart(p_drv,
+                                               p_ep->Addr,
+                                               p_buf_cur,
+                                               len,
+                                               p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
+    }
+    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartSuccessNbr);
 
-    USBD_DBG_STATS_EP_INC_IF_TRUE(dev_nbr, p_ep->Ix, RxZLP_SuccessNbr, (*p_err == USBD_ERR_NONE));
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (p_buf_cur == p_ep->VecBufPtr) {                         /* See Note #3.                                         */
+        return (DEF_NO);
+    }
+#endif
 
-lock_release:
-    USBD_OS_EP_LockRelease(p_drv->DevNbr,
-                           p_ep->Ix);
+    return ((p_urb->NextXferLen == xfer_rem) ? DEF_YES : DEF_NO);
 }
 
 
 /*
 *********************************************************************************************************
-*********************************************************************************************************
-*                                           LOCAL FUNCTIONS
-*********************************************************************************************************
-*********************************************************************************************************
-*/
-
-/*
-*********************************************************************************************************
-*                                     USBD_EP_RxStartAsyncProcess()
+*                                         USBD_EP_RxXferRd()
 *
-* Description : Process driver's asynchronous RxStart operation.
+* Description : Read the data received by the last transaction started with USBD_EP_RxXferStart().
 *
 * Argument(s) : p_drv       Pointer to device driver structure.
 *
-*               p_ep        Pointer to endpoint on which data will be received.
+*               p_ep        Pointer to endpoint on which data was received.
 *
 *               p_urb       Pointer to USB request block.
 *
-*               p_buf_cur   Pointer to source buffer to receive data.
+*               p_err       Pointer to variable that will receive return error code from this function :
 *
-*               len         Number of octets to receive.
+*                               USBD_ERR_NONE               Data successfully read.
 *
-*               p_err       Pointer to variable that will receive return error code from this function :
+*                               - RETURNED BY 'p_drv_api->EP_Rx()' -
+*                               See specific driver(s) 'p_drv_api->EP_Rx()' for additional return error codes.
 *
-*                               USBD_ERR_NONE               Receive successfully configured.
+*                               - RETURNED BY 'p_drv_api->EP_RxVec()' -
+*                               See specific driver(s) 'p_drv_api->EP_RxVec()' for additional return error codes.
 *
-*                               - RETURNED BY 'p_drv_api->EP_RxStart()' -
-*                               See specific driver(s) 'p_drv_api->EP_RxStart()' for additional return error codes.
+* Return(s)   : Number of octets received, if NO error(s).
 *
-* Return(s)   : none.
+*               0,                         otherwise.
 *
 * Note(s)     : (1) Endpoint must be locked when calling this function.
+*
+*               (2) When the transaction was received in the endpoint bounce buffer, the data is copied
+*                   back to the segments it belongs to.
 *********************************************************************************************************
 */
 
-static  void  USBD_EP_RxStartAsyncProcess (USBD_DRV    *p_drv,
-                                           USBD_EP     *p_ep,
-                                           USBD_URB    *p_urb,
-                                           CPU_INT08U  *p_buf_cur,
-                                           CPU_INT32U   len,
-                                           USBD_ERR    *p_err)
+static  CPU_INT32U  USBD_EP_RxXferRd (USBD_DRV  *p_drv,
+                                      USBD_EP   *p_ep,
+                                      USBD_URB  *p_urb,
+                                      USBD_ERR  *p_err)
 {
     USBD_DRV_API  *p_drv_api;
-    CPU_SR_ALLOC();
+    CPU_INT08U    *p_buf_cur;
+    CPU_INT32U     xfer_len;
+    CPU_INT32U     len;
 
 
     p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
 
-    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartNbr);
-    p_urb->NextXferLen = p_drv_api->EP_RxStart(p_drv,
-                                               p_ep->Addr,
-                                               p_buf_cur,
-                                               len,
-                                               p_err);
-    if (*p_err != USBD_ERR_NONE) {
-        return;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_VEC_DRV) == DEF_YES) {
+        DEF_BIT_CLR(p_urb->Flags, USBD_URB_FLAG_VEC_DRV);
+
+        xfer_len = p_drv_api->EP_RxVec(p_drv,
+                                       p_ep->Addr,
+                                       p_urb->SegTblPtr,
+                                       p_urb->SegNbr,
+                                       p_err);
+        return (xfer_len);
     }
+#endif
 
-    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartSuccessNbr);
+    p_buf_cur = USBD_URB_BufCurGet(p_ep, p_urb, DEF_NO, &len);
 
-    if (p_urb->NextXferLen != len) {
-        CPU_CRITICAL_ENTER();
-        p_ep->XferState = USBD_XFER_STATE_ASYNC_PARTIAL;        /* Xfer will have to be done in many transactions.      */
-        CPU_CRITICAL_EXIT();
+    xfer_len = p_drv_api->EP_Rx(p_drv,
+                                p_ep->Addr,
+                                p_buf_cur,
+                                p_urb->NextXferLen,
+                                p_err);
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if ((*p_err    == USBD_ERR_NONE) &&
+        (p_buf_cur == p_ep->VecBufPtr)) {                       /* See Note #2.                                         */
+        USBD_URB_VecBufScatter(p_ep,
+                               p_urb,
+                               DEF_MIN(xfer_len, p_urb->NextXferLen));
     }
+#endif
+
+    return (xfer_len);
 }
 
 
 /*
 *********************************************************************************************************
-*                                       USBD_EP_TxAsyncProcess()
+*                                        USBD_EP_TxXferStart()
 *
-* Description : Process driver's asynchronous Tx operation.
+* Description : Start the transmission of the next part of a transfer.
 *
 * Argument(s) : p_drv       Pointer to device driver structure.
 *
@@ -3623,13 +5208,9 @@ static  void  USBD_EP_RxStartAsyncProcess (USBD_DRV    *p_drv,
 *
 *               p_urb       Pointer to USB request block.
 *
-*               p_buf_cur   Pointer to source buffer to transmit data.
-*
-*               len         Number of octets to transmit.
-*
 *               p_err       Pointer to variable that will receive return error code from this function :
 *
-*                               USBD_ERR_NONE               Transmit successfully configured.
+*                               USBD_ERR_NONE               Transmit successfully started.
 *                               USBD_ERR_TX                 Generic Tx error.
 *
 *                               - RETURNED BY 'p_drv_api->EP_Tx()' -
@@ -3638,23 +5219,55 @@ static  void  USBD_EP_RxStartAsyncProcess (USBD_DRV    *p_drv,
 *                               - RETURNED BY 'p_drv_api->EP_TxStart()' -
 *                               See specific driver(s) 'p_drv_api->EP_TxStart()' for additional return error codes.
 *
-* Return(s)   : none.
+*                               - RETURNED BY 'p_drv_api->EP_TxVec()' -
+*                               See specific driver(s) 'p_drv_api->EP_TxVec()' for additional return error codes.
+*
+* Return(s)   : DEF_YES, if the remaining of the transfer has been entirely submitted to the driver,
+*
+*               DEF_NO,  otherwise (see USBD_EP_RxXferStart() Note #3).
 *
 * Note(s)     : (1) Endpoint must be locked when calling this function.
+*
+*               (2) The number of octets submitted to the driver is stored in 'p_urb->NextXferLen'.
 *********************************************************************************************************
 */
 
-static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
-                                      USBD_EP     *p_ep,
-                                      USBD_URB    *p_urb,
-                                      CPU_INT08U  *p_buf_cur,
-                                      CPU_INT32U   len,
-                                      USBD_ERR    *p_err)
+static  CPU_BOOLEAN  USBD_EP_TxXferStart (USBD_DRV  *p_drv,
+                                          USBD_EP   *p_ep,
+                                          USBD_URB  *p_urb,
+                                          USBD_ERR  *p_err)
 {
     USBD_DRV_API  *p_drv_api;
+    CPU_INT08U    *p_buf_cur;
+    CPU_INT32U     xfer_rem;
+    CPU_INT32U     len;
 
 
     p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
+    xfer_rem  = p_urb->BufLen - p_urb->XferLen;
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if ((DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_VEC) == DEF_YES) &&
+        (p_urb->XferLen                                  == 0u)      &&
+        (p_drv_api->EP_TxVec                             != (void *)0)) {
+                                                                /* Let drv chain its descriptors over the seg tbl.      */
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartNbr);
+
+        p_urb->NextXferLen = p_drv_api->EP_TxVec(p_drv,
+                                                 p_ep->Addr,
+                                                 p_urb->SegTblPtr,
+                                                 p_urb->SegNbr,
+                                                 p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return (DEF_NO);
+        }
+        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartSuccessNbr);
+
+        return ((p_urb->NextXferLen == xfer_rem) ? DEF_YES : DEF_NO);
+    }
+#endif
+
+    p_buf_cur = USBD_URB_BufCurGet(p_ep, p_urb, DEF_YES, &len);
 
     USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxNbr);
 
@@ -3664,16 +5277,13 @@ static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
                                           len,
                                           p_err);
     if (*p_err != USBD_ERR_NONE) {
-        return;
+        return (DEF_NO);
     }
 
-    if (p_urb->NextXferLen == len) {                            /* Xfer can be done is a single transaction.            */
-        p_ep->XferState = USBD_XFER_STATE_ASYNC;
-    } else if ((p_ep->Attrib & USBD_EP_TYPE_MASK) != USBD_EP_TYPE_ISOC) {
-        p_ep->XferState = USBD_XFER_STATE_ASYNC_PARTIAL;        /* Xfer will have to be done in many transactions.      */
-    } else {
+    if ((p_urb->NextXferLen                   != xfer_rem) &&
+        ((p_ep->Attrib & USBD_EP_TYPE_MASK) == USBD_EP_TYPE_ISOC)) {
        *p_err = USBD_ERR_TX;                                    /* Cannot split xfer on isoc EP.                        */
-        return;
+        return (DEF_NO);
     }
 
     USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxSuccessNbr);
@@ -3684,13 +5294,18 @@ static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
                           p_buf_cur,
                           p_urb->NextXferLen,
                           p_err);
-    if (*p_err == USBD_ERR_NONE) {
-        p_urb->XferLen     += p_urb->NextXferLen;               /* Error not accounted on total xfer len.               */
-        p_urb->NextXferLen  = 0u;
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartSuccessNbr);
+    if (*p_err != USBD_ERR_NONE) {
+        return (DEF_NO);
     }
+    USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartSuccessNbr);
 
-    return;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (p_buf_cur == p_ep->VecBufPtr) {                         /* See USBD_EP_RxXferStart() Note #3.                   */
+        return (DEF_NO);
+    }
+#endif
+
+    return ((p_urb->NextXferLen == xfer_rem) ? DEF_YES : DEF_NO);
 }
 
 
@@ -3710,6 +5325,10 @@ static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
 *
 *               buf_len         Number of octets to receive.
 *
+*               p_seg_tbl       Pointer to table of destination buffer segments (see Note #5).
+*
+*               seg_nbr         Number of segments in table.
+*
 *               async_fnct      Function that will be invoked upon completion of receive operation.
 *
 *               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
@@ -3734,11 +5353,14 @@ static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
 *                                   - RETURNED BY USBD_OS_EP_SignalPend() -
 *                                   See USBD_OS_EP_SignalPend() for additional return error codes.
 *
-*                                   - RETURNED BY 'p_drv_api->EP_RxStart()' -
-*                                   See specific driver(s) 'p_drv_api->EP_RxStart()' for additional return error codes.
+*                                   - RETURNED BY USBD_URB_VecLenGet() -
+*                                   See USBD_URB_VecLenGet() for additional return error codes.
 *
-*                                   - RETURNED BY 'p_drv_api->EP_Rx()' -
-*                                   See specific driver(s) 'p_drv_api->EP_Rx()' for additional return error codes.
+*                                   - RETURNED BY USBD_EP_RxXferStart() -
+*                                   See USBD_EP_RxXferStart() for additional return error codes.
+*
+*                                   - RETURNED BY USBD_EP_RxXferRd() -
+*                                   See USBD_EP_RxXferRd() for additional return error codes.
 *
 * Return(s)   : Number of octets received, if NO error(s).
 *
@@ -3756,6 +5378,10 @@ static  void  USBD_EP_TxAsyncProcess (USBD_DRV    *p_drv,
 *               (4) This condition covers also the case where the transfer length is multiple of the
 *                   maximum packet size. In that case, host sends a zero-length packet considered as
 *                   a short packet for the condition.
+*
+*               (5) When 'p_seg_tbl' is not null, 'p_buf' and 'buf_len' are ignored and the transfer
+*                   is scattered over the segments, in order. The asynchronous callback then receives
+*                   the segment table as its buffer and the total length of the segments.
 *********************************************************************************************************
 */
 
@@ -3763,6 +5389,8 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
                                 USBD_EP          *p_ep,
                                 void             *p_buf,
                                 CPU_INT32U        buf_len,
+                                USBD_BUF_SEG     *p_seg_tbl,
+                                CPU_INT08U        seg_nbr,
                                 USBD_ASYNC_FNCT   async_fnct,
                                 void             *p_async_arg,
                                 CPU_INT16U        timeout_ms,
@@ -3771,12 +5399,31 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
     USBD_URB         *p_urb;
     USBD_DRV_API     *p_drv_api;
     USBD_XFER_STATE   prev_xfer_state;
-    CPU_INT08U       *p_buf_cur;
     CPU_INT32U        xfer_len;
     CPU_INT32U        xfer_tot;
     CPU_INT32U        prev_xfer_len;
     USBD_ERR          local_err;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_TS            submit_ts;
+#endif
+
 
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    submit_ts = CPU_TS_Get32();
+#endif
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (p_seg_tbl != (USBD_BUF_SEG *)0) {                       /* See Note #5.                                         */
+        buf_len = USBD_URB_VecLenGet(p_seg_tbl, seg_nbr, p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return (0u);
+        }
+        p_buf = (void *)p_seg_tbl;
+    }
+#else
+    (void)p_seg_tbl;
+    (void)seg_nbr;
+#endif
 
     if ((buf_len !=         0u) &&
         (p_buf   == (void *)0)) {
@@ -3799,7 +5446,11 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
         }
     }
 
-    p_urb = USBD_URB_Get(p_drv->DevNbr, p_ep, p_err);
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {                     /* See 'ENDPOINT DATA TYPE  Note #1'.                   */
+        p_urb = USBD_URB_SyncGet(p_drv->DevNbr, p_ep, p_err);
+    } else {
+        p_urb = USBD_URB_Get(p_drv->DevNbr, p_ep, p_err);
+    }
     if (*p_err != USBD_ERR_NONE) {
         return (0u);
     }
@@ -3812,17 +5463,30 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
     p_urb->AsyncFnctArg =  p_async_arg;
     p_urb->Err          =  USBD_ERR_NONE;
     p_urb->NextPtr      = (USBD_URB *)0;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_urb->StatsSubmitTs = submit_ts;
+#endif
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    p_urb->SegTblPtr    =  p_seg_tbl;
+    p_urb->SegNbr       =  seg_nbr;
+    p_urb->SegIx        =  0u;
+    p_urb->SegBaseLen   =  0u;
+    if (p_seg_tbl != (USBD_BUF_SEG *)0) {
+        DEF_BIT_SET(p_urb->Flags, USBD_URB_FLAG_VEC);
+    }
+#endif
 
     if (async_fnct != (USBD_ASYNC_FNCT)0) {                     /* -------------------- ASYNC XFER -------------------- */
         p_urb->State    = USBD_URB_STATE_XFER_ASYNC;
         prev_xfer_state = p_ep->XferState;                      /* Keep prev XferState, to restore in case of err.      */
         p_ep->XferState = USBD_XFER_STATE_ASYNC;                /* Set XferState before submitting the xfer.            */
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+        p_urb->StatsStartTs = CPU_TS_Get32();
+#endif
 
         USBD_EP_RxStartAsyncProcess(p_drv,
                                     p_ep,
                                     p_urb,
-                                    p_urb->BufPtr,
-                                    p_urb->BufLen,
                                     p_err);
         if (*p_err == USBD_ERR_NONE) {
             USBD_URB_Queue(p_ep, p_urb);                        /* If no err, queue URB.                                */
@@ -3835,30 +5499,24 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
         return (0u);
     }
 
-    p_ep->XferState = USBD_XFER_STATE_SYNC;                     /* -------------------- SYNC XFER --------------------- */
-    p_urb->State    = USBD_URB_STATE_XFER_SYNC;
-
-    USBD_URB_Queue(p_ep, p_urb);
-
+                                                                /* -------------------- SYNC XFER --------------------- */
     p_drv_api          = p_drv->API_Ptr;                        /* Get dev drv API struct.                              */
     p_urb->NextXferLen = p_urb->BufLen;
    *p_err              = USBD_ERR_NONE;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_urb->StatsStartTs = CPU_TS_Get32();
+#endif
 
     while ((*p_err              == USBD_ERR_NONE) &&
            ( p_urb->NextXferLen >  0u)) {
 
-        p_buf_cur = &p_urb->BufPtr[p_urb->XferLen];
-
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartNbr);
-        p_urb->NextXferLen = p_drv_api->EP_RxStart(p_drv,
-                                                   p_ep->Addr,
-                                                   p_buf_cur,
-                                                   p_urb->NextXferLen,
-                                                   p_err);
+       (void)USBD_EP_RxXferStart(p_drv,
+                                 p_ep,
+                                 p_urb,
+                                 p_err);
         if (*p_err != USBD_ERR_NONE) {
             break;
         }
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxStartSuccessNbr);
 
         USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion. See Note #3.    */
                                p_ep->Ix);
@@ -3882,10 +5540,9 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
         }
 
         USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvRxNbr);
-        xfer_len = p_drv_api->EP_Rx(p_drv,
-                                    p_ep->Addr,
-                                    p_buf_cur,
-                                    p_urb->NextXferLen,
+        xfer_len = USBD_EP_RxXferRd(p_drv,
+                                    p_ep,
+                                    p_urb,
                                     p_err);
         if (*p_err != USBD_ERR_NONE) {
             break;
@@ -3908,9 +5565,13 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
 
     xfer_tot = p_urb->XferLen;
 
-    USBD_URB_Dequeue(p_ep);
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_EP_DbgStatsPerfRec(p_drv->DevNbr, p_ep, p_urb->StatsSubmitTs, p_urb->StatsStartTs, xfer_tot);
+    }
+#endif
 
-    USBD_URB_Free(p_drv->DevNbr, p_ep, p_urb);
+    USBD_URB_SyncFree(p_drv->DevNbr, p_ep, p_urb);
 
     USBD_DBG_STATS_EP_INC_IF_TRUE(p_drv->DevNbr, p_ep->Ix, RxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
@@ -3934,6 +5595,10 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
 *
 *               buf_len         Number of octets to transmit.
 *
+*               p_seg_tbl       Pointer to table of source buffer segments (see Note #5).
+*
+*               seg_nbr         Number of segments in table.
+*
 *               async_fnct      Function that will be invoked upon completion of transmit operation.
 *
 *               p_async_arg     Pointer to argument that will be passed as parameter of 'async_fnct'.
@@ -3959,11 +5624,11 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
 *                                   - RETURNED BY USBD_OS_EP_SignalPend() -
 *                                   See USBD_OS_EP_SignalPend() for additional return error codes.
 *
-*                                   - RETURNED BY 'p_drv_api->EP_Tx()' -
-*                                   See specific driver(s) 'p_drv_api->EP_Tx()' for additional return error codes.
+*                                   - RETURNED BY USBD_URB_VecLenGet() -
+*                                   See USBD_URB_VecLenGet() for additional return error codes.
 *
-*                                   - RETURNED BY 'p_drv_api->EP_TxStart()' -
-*                                   See specific driver(s) 'p_drv_api->EP_TxStart()' for additional return error codes.
+*                                   - RETURNED BY USBD_EP_TxXferStart() -
+*                                   See USBD_EP_TxXferStart() for additional return error codes.
 *
 *                                   - RETURNED BY 'p_drv_api->EP_TxZLP()' -
 *                                   See specific driver(s) 'p_drv_api->EP_TxZLP()' for additional return error codes.
@@ -3983,6 +5648,10 @@ static  CPU_INT32U  USBD_EP_Rx (USBD_DRV         *p_drv,
 *                   completion to be able to abort. Since the endpoint is already locked when this
 *                   function is called (see callers functions), it releases the lock before pending and
 *                   re-locks once the transfer completes.
+*
+*               (5) When 'p_seg_tbl' is not null, 'p_buf' and 'buf_len' are ignored and the transfer
+*                   is gathered from the segments, in order. The asynchronous callback then receives
+*                   the segment table as its buffer and the total length of the segments.
 *********************************************************************************************************
 */
 
@@ -3990,6 +5659,8 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
                                 USBD_EP          *p_ep,
                                 void             *p_buf,
                                 CPU_INT32U        buf_len,
+                                USBD_BUF_SEG     *p_seg_tbl,
+                                CPU_INT08U        seg_nbr,
                                 USBD_ASYNC_FNCT   async_fnct,
                                 void             *p_async_arg,
                                 CPU_INT16U        timeout_ms,
@@ -3999,12 +5670,31 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
     USBD_URB         *p_urb;
     USBD_DRV_API     *p_drv_api;
     USBD_XFER_STATE   prev_xfer_state;
-    CPU_INT08U       *p_buf_cur;
     CPU_INT32U        xfer_rem;
     CPU_INT32U        xfer_tot;
     USBD_ERR          local_err;
     CPU_BOOLEAN       zlp_flag = DEF_NO;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_TS            submit_ts;
+#endif
+
 
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    submit_ts = CPU_TS_Get32();
+#endif
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (p_seg_tbl != (USBD_BUF_SEG *)0) {                       /* See Note #5.                                         */
+        buf_len = USBD_URB_VecLenGet(p_seg_tbl, seg_nbr, p_err);
+        if (*p_err != USBD_ERR_NONE) {
+            return (0u);
+        }
+        p_buf = (void *)p_seg_tbl;
+    }
+#else
+    (void)p_seg_tbl;
+    (void)seg_nbr;
+#endif
 
     if ((buf_len !=         0u) &&
         (p_buf   == (void *)0)) {
@@ -4031,7 +5721,11 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
         zlp_flag = DEF_YES;
     }
 
-    p_urb = USBD_URB_Get(p_drv->DevNbr, p_ep, p_err);
+    if (async_fnct == (USBD_ASYNC_FNCT)0) {                     /* See 'ENDPOINT DATA TYPE  Note #1'.                   */
+        p_urb = USBD_URB_SyncGet(p_drv->DevNbr, p_ep, p_err);
+    } else {
+        p_urb = USBD_URB_Get(p_drv->DevNbr, p_ep, p_err);
+    }
     if (*p_err != USBD_ERR_NONE) {
         return (0u);
     }
@@ -4044,6 +5738,18 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
     p_urb->AsyncFnctArg =  p_async_arg;
     p_urb->Err          =  USBD_ERR_NONE;
     p_urb->NextPtr      = (USBD_URB *)0;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_urb->StatsSubmitTs = submit_ts;
+#endif
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    p_urb->SegTblPtr    =  p_seg_tbl;
+    p_urb->SegNbr       =  seg_nbr;
+    p_urb->SegIx        =  0u;
+    p_urb->SegBaseLen   =  0u;
+    if (p_seg_tbl != (USBD_BUF_SEG *)0) {
+        DEF_BIT_SET(p_urb->Flags, USBD_URB_FLAG_VEC);
+    }
+#endif
     if (end == DEF_YES) {
         DEF_BIT_SET(p_urb->Flags, USBD_URB_FLAG_XFER_END);
     }
@@ -4052,12 +5758,13 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
         p_urb->State    = USBD_URB_STATE_XFER_ASYNC;
         prev_xfer_state = p_ep->XferState;                      /* Keep prev XferState, to restore in case of err.      */
         p_ep->XferState = USBD_XFER_STATE_ASYNC;                /* Set XferState before submitting the xfer.            */
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+        p_urb->StatsStartTs = CPU_TS_Get32();
+#endif
 
         USBD_EP_TxAsyncProcess(p_drv,
                                p_ep,
                                p_urb,
-                               p_urb->BufPtr,
-                               p_urb->BufLen,
                                p_err);
         if (*p_err == USBD_ERR_NONE) {
             USBD_URB_Queue(p_ep, p_urb);                        /* If no err, queue URB.                                */
@@ -4070,48 +5777,27 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
         return (0u);
     }
 
-    p_ep->XferState = USBD_XFER_STATE_SYNC;                     /* -------------------- SYNC XFER --------------------- */
-    p_urb->State    = USBD_URB_STATE_XFER_SYNC;
-
-    USBD_URB_Queue(p_ep, p_urb);
-
+                                                                /* -------------------- SYNC XFER --------------------- */
     p_drv_api = p_drv->API_Ptr;                                 /* Get dev drv API struct.                              */
     xfer_rem  = p_urb->BufLen;
    *p_err     = USBD_ERR_NONE;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    p_urb->StatsStartTs = CPU_TS_Get32();
+#endif
 
     while ((*p_err     == USBD_ERR_NONE) &&
            ((xfer_rem  >  0u)            ||
             (zlp_flag  == DEF_YES))) {
 
-        if (zlp_flag == DEF_NO) {
-            p_buf_cur = &p_urb->BufPtr[p_urb->XferLen];
-        } else {
-            p_buf_cur = (CPU_INT08U *)0;
-            zlp_flag  = DEF_NO;                                 /* If Tx ZLP, loop done only once.                      */
-        }
-
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxNbr);
-        p_urb->NextXferLen = p_drv_api->EP_Tx(p_drv,
-                                              p_ep->Addr,
-                                              p_buf_cur,
-                                              xfer_rem,
-                                              p_err);
-        if (*p_err != USBD_ERR_NONE) {
-            break;
-        }
-
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxSuccessNbr);
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartNbr);
+        zlp_flag = DEF_NO;                                      /* If Tx ZLP, loop done only once.                      */
 
-        p_drv_api->EP_TxStart(p_drv,
-                              p_ep->Addr,
-                              p_buf_cur,
-                              p_urb->NextXferLen,
-                              p_err);
+       (void)USBD_EP_TxXferStart(p_drv,
+                                 p_ep,
+                                 p_urb,
+                                 p_err);
         if (*p_err != USBD_ERR_NONE) {
             break;
         }
-        USBD_DBG_STATS_EP_INC(p_drv->DevNbr, p_ep->Ix, DrvTxStartSuccessNbr);
 
         USBD_OS_EP_LockRelease(p_drv->DevNbr,                   /* Unlock before pending on completion. See Note #4.    */
                                p_ep->Ix);
@@ -4167,9 +5853,13 @@ static  CPU_INT32U  USBD_EP_Tx (USBD_DRV         *p_drv,
         }
     }
 
-    USBD_URB_Dequeue(p_ep);
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    if (*p_err == USBD_ERR_NONE) {
+        USBD_EP_DbgStatsPerfRec(p_drv->DevNbr, p_ep, p_urb->StatsSubmitTs, p_urb->StatsStartTs, xfer_tot);
+    }
+#endif
 
-    USBD_URB_Free(p_drv->DevNbr, p_ep, p_urb);
+    USBD_URB_SyncFree(p_drv->DevNbr, p_ep, p_urb);
 
     USBD_DBG_STATS_EP_INC_IF_TRUE(p_drv->DevNbr, p_ep->Ix, TxSyncSuccessNbr, (*p_err == USBD_ERR_NONE));
 
@@ -4298,15 +5988,152 @@ static  USBD_URB  *USBD_URB_AsyncCmpl (USBD_EP   *p_ep,
     USBD_URB  *p_urb;
 
 
-    p_urb = p_ep->URB_HeadPtr;                                  /* Get head URB for EP.                                 */
-    if (p_urb == (USBD_URB *)0) {
-        return (p_urb);
+    p_urb = p_ep->URB_HeadPtr;                                  /* Get head URB for EP.                                 */
+    if (p_urb == (USBD_URB *)0) {
+        return (p_urb);
+    }
+
+    USBD_URB_Dequeue(p_ep);                                     /* Dequeue first URB from EP.                           */
+
+    p_urb->Err     =  err;                                      /* Set err for curr URB.                                */
+    p_urb->NextPtr = (USBD_URB *)0;                             /* Remove links with 'p_ep' URB linked list.            */
+
+    return (p_urb);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          USBD_URB_AsyncEnd()
+*
+* Description : Execute callback associated with each USB request block in the linked list and free them.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument checked by caller.
+*
+*               p_ep        Pointer to endpoint structure.
+*               ----        Argument checked by caller.
+*
+*               p_urb_head  Pointer to head of USB request block linked list.
+*               -----       Argument checked by caller.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Endpoint must NOT be locked when calling this function.
+*********************************************************************************************************
+*/
+
+static  void  USBD_URB_AsyncEnd (CPU_INT08U   dev_nbr,
+                                 USBD_EP     *p_ep,
+                                 USBD_URB    *p_urb_head)
+{
+    USBD_URB         *p_urb_cur;
+    USBD_URB         *p_urb_next;
+    void             *p_buf;
+    CPU_INT32U        buf_len;
+    CPU_INT32U        xfer_len;
+    USBD_ASYNC_FNCT   async_fnct;
+    void             *p_async_arg;
+    USBD_ERR          err;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+    CPU_TS            submit_ts;
+    CPU_TS            start_ts;
+#endif
+
+
+    p_urb_cur = p_urb_head;
+    while (p_urb_cur != (USBD_URB *)0) {                        /* Iterate through linked list.                         */
+        p_buf       = (void *)p_urb_cur->BufPtr;
+        buf_len     =  p_urb_cur->BufLen;
+        xfer_len    =  p_urb_cur->XferLen;
+        async_fnct  =  p_urb_cur->AsyncFnct;
+        p_async_arg =  p_urb_cur->AsyncFnctArg;
+        err         =  p_urb_cur->Err;
+        p_urb_next  =  p_urb_cur->NextPtr;
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+        submit_ts   =  p_urb_cur->StatsSubmitTs;
+        start_ts    =  p_urb_cur->StatsStartTs;
+#endif
+
+        USBD_URB_Free(dev_nbr, p_ep, p_urb_cur);                /* Free URB to pool.                                    */
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+        if (err == USBD_ERR_NONE) {
+            USBD_EP_DbgStatsPerfRec(dev_nbr, p_ep, submit_ts, start_ts, xfer_len);
+        }
+#endif
+
+        async_fnct(dev_nbr,                                     /* Execute callback fnct.                               */
+                   p_ep->Addr,
+                   p_buf,
+                   buf_len,
+                   xfer_len,
+                   p_async_arg,
+                   err);
+
+        p_urb_cur = p_urb_next;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         USBD_URB_SyncGet()
+*
+* Description : Get URB for a synchronous transfer and mark endpoint as busy.
+*
+* Argument(s) : dev_nbr     Device number.
+*               -------     Argument checked by caller.
+*
+*               p_ep        Pointer to endpoint structure.
+*               ----        Argument checked by caller.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*               ----        Argument checked by caller.
+*
+*                               USBD_ERR_NONE               URB successfully returned.
+*
+*                               - RETURNED BY USBD_URB_Get() -
+*                               See USBD_URB_Get() for additional return error codes.
+*
+* Return(s)   : Pointer to USB request block, if NO error(s).
+*
+*               Pointer to NULL,              otherwise.
+*
+* Note(s)     : (1) Endpoint must be locked and idle when calling this function.
+*
+*               (2) The embedded URB is neither taken from the pool nor queued on the endpoint (see
+*                   'ENDPOINT DATA TYPE  Note #1'). Nothing else looks at the queue of an endpoint while
+*                   a synchronous transfer is in progress.
+*********************************************************************************************************
+*/
+
+static  USBD_URB  *USBD_URB_SyncGet (CPU_INT08U   dev_nbr,
+                                     USBD_EP     *p_ep,
+                                     USBD_ERR    *p_err)
+{
+    USBD_URB  *p_urb;
+
+
+#if (USBD_CFG_EP_SYNC_URB_EN == DEF_ENABLED)                    /* See Note #2.                                         */
+    (void)dev_nbr;
+
+    p_urb          = &p_ep->URB_Sync;
+    p_urb->Flags   =  DEF_BIT_NONE;
+    p_urb->NextPtr = (USBD_URB *)0;
+#else
+    p_urb = USBD_URB_Get(dev_nbr, p_ep, p_err);
+    if (*p_err != USBD_ERR_NONE) {
+        return ((USBD_URB *)0);
     }
 
-    USBD_URB_Dequeue(p_ep);                                     /* Dequeue first URB from EP.                           */
+    USBD_URB_Queue(p_ep, p_urb);
+#endif
 
-    p_urb->Err     =  err;                                      /* Set err for curr URB.                                */
-    p_urb->NextPtr = (USBD_URB *)0;                             /* Remove links with 'p_ep' URB linked list.            */
+    p_urb->State    = USBD_URB_STATE_XFER_SYNC;
+    p_ep->XferState = USBD_XFER_STATE_SYNC;
+
+   *p_err = USBD_ERR_NONE;
 
     return (p_urb);
 }
@@ -4314,9 +6141,9 @@ static  USBD_URB  *USBD_URB_AsyncCmpl (USBD_EP   *p_ep,
 
 /*
 *********************************************************************************************************
-*                                          USBD_URB_AsyncEnd()
+*                                         USBD_URB_SyncFree()
 *
-* Description : Execute callback associated with each USB request block in the linked list and free them.
+* Description : Release URB of a synchronous transfer and mark endpoint as idle.
 *
 * Argument(s) : dev_nbr     Device number.
 *               -------     Argument checked by caller.
@@ -4324,51 +6151,29 @@ static  USBD_URB  *USBD_URB_AsyncCmpl (USBD_EP   *p_ep,
 *               p_ep        Pointer to endpoint structure.
 *               ----        Argument checked by caller.
 *
-*               p_urb_head  Pointer to head of USB request block linked list.
+*               p_urb       Pointer to USB request block returned by USBD_URB_SyncGet().
 *               -----       Argument checked by caller.
 *
 * Return(s)   : none.
 *
-* Note(s)     : (1) Endpoint must NOT be locked when calling this function.
+* Note(s)     : (1) Endpoint must be locked when calling this function.
 *********************************************************************************************************
 */
 
-static  void  USBD_URB_AsyncEnd (CPU_INT08U   dev_nbr,
+static  void  USBD_URB_SyncFree (CPU_INT08U   dev_nbr,
                                  USBD_EP     *p_ep,
-                                 USBD_URB    *p_urb_head)
+                                 USBD_URB    *p_urb)
 {
-    USBD_URB         *p_urb_cur;
-    USBD_URB         *p_urb_next;
-    void             *p_buf;
-    CPU_INT32U        buf_len;
-    CPU_INT32U        xfer_len;
-    USBD_ASYNC_FNCT   async_fnct;
-    void             *p_async_arg;
-    USBD_ERR          err;
+#if (USBD_CFG_EP_SYNC_URB_EN == DEF_ENABLED)
+    (void)dev_nbr;
 
+    p_urb->State    = USBD_URB_STATE_IDLE;
+    p_ep->XferState = USBD_XFER_STATE_NONE;
+#else
+    USBD_URB_Dequeue(p_ep);                                     /* Sets XferState to none.                              */
 
-    p_urb_cur = p_urb_head;
-    while (p_urb_cur != (USBD_URB *)0) {                        /* Iterate through linked list.                         */
-        p_buf       = (void *)p_urb_cur->BufPtr;
-        buf_len     =  p_urb_cur->BufLen;
-        xfer_len    =  p_urb_cur->XferLen;
-        async_fnct  =  p_urb_cur->AsyncFnct;
-        p_async_arg =  p_urb_cur->AsyncFnctArg;
-        err         =  p_urb_cur->Err;
-        p_urb_next  =  p_urb_cur->NextPtr;
-
-        USBD_URB_Free(dev_nbr, p_ep, p_urb_cur);                /* Free URB to pool.                                    */
-
-        async_fnct(dev_nbr,                                     /* Execute callback fnct.                               */
-                   p_ep->Addr,
-                   p_buf,
-                   buf_len,
-                   xfer_len,
-                   p_async_arg,
-                   err);
-
-        p_urb_cur = p_urb_next;
-    }
+    USBD_URB_Free(dev_nbr, p_ep, p_urb);
+#endif
 }
 
 
@@ -4405,10 +6210,19 @@ static  void  USBD_URB_Free (CPU_INT08U   dev_nbr,
     p_urb->NextPtr           = USBD_URB_TblPtr[dev_nbr];
     USBD_URB_TblPtr[dev_nbr] = p_urb;
 
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)
+    if (DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_RSVD_URB)) {
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+                                                                /* If the URB freed is a 'reserved' URB, dec EP ctr.    */
+        p_ep->URB_RsvdUsedCtr--;
+#endif
+    } else if (DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_EXTRA_URB)) {
 #if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
-    if (DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_EXTRA_URB)) {
                                                                 /* If the URB freed is an 'extra' URB, dec ctr.         */
         USBD_URB_ExtraCtr[dev_nbr]--;
+#endif
+    } else if (p_ep->URB_MainLent == DEF_YES) {                 /* See 'ENDPOINT DATA TYPE  Note #2'.                   */
+        p_ep->URB_MainLent  = DEF_NO;
     } else {
         p_ep->URB_MainAvail = DEF_YES;
     }
@@ -4441,7 +6255,21 @@ static  void  USBD_URB_Free (CPU_INT08U   dev_nbr,
 *
 *               Pointer to NULL,              otherwise.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The URB is accounted to the first of the following that is available:
+*
+*                   (a) The endpoint's main URB.
+*                   (b) One of the URBs reserved for the endpoint with USBD_EP_URB_RsvdSet().
+*                   (c) One of the USBD_CFG_MAX_NBR_URB_EXTRA URBs shared by all the endpoints.
+*
+*                   The URB pool holds one URB per opened endpoint plus all the reserved and extra
+*                   URBs, so a free URB is always available when one of these conditions is met.
+*
+*               (2) An endpoint without queued transfer may still have its main URB in use, while the
+*                   callbacks of a list of completed or aborted URBs are executed. An URB is then lent
+*                   to the endpoint from the pool and becomes its main URB. The URB freed first
+*                   afterwards is not accounted as the main URB again. As an endpoint holds at most one
+*                   lent URB at a time, the pool also holds one spare URB per opened endpoint : a lent
+*                   URB never uses up the reserved URBs of another endpoint nor the extra URBs.
 *********************************************************************************************************
 */
 
@@ -4450,48 +6278,70 @@ static  USBD_URB  *USBD_URB_Get (CPU_INT08U   dev_nbr,
                                  USBD_ERR    *p_err)
 {
     CPU_BOOLEAN  ep_empty;
-    USBD_URB  *p_urb;
+    CPU_BOOLEAN  urb_avail;
+    CPU_INT08U   urb_flags;
+    USBD_URB    *p_urb;
     CPU_SR_ALLOC();
 
 
+    urb_flags = DEF_BIT_NONE;
+
     CPU_CRITICAL_ENTER();
     ep_empty = ((p_ep->URB_HeadPtr == (USBD_URB *)0) && (p_ep->URB_TailPtr == (USBD_URB *)0)) ? DEF_YES : DEF_NO;
 
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)
+    if (p_ep->URB_MainAvail == DEF_YES) {                       /* See Note #1a.                                        */
+        urb_avail = DEF_YES;
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+    } else if (p_ep->URB_RsvdUsedCtr < p_ep->URB_RsvdNbr) {     /* See Note #1b.                                        */
+        urb_avail = DEF_YES;
+        DEF_BIT_SET(urb_flags, USBD_URB_FLAG_RSVD_URB);
+#endif
 #if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
-                                                                /* Check if EP is empty, if enough URB rem or if main...*/
-                                                                /* ...URB avail.                                        */
-    if ((ep_empty                   == DEF_YES) ||
-        (USBD_URB_ExtraCtr[dev_nbr] <  USBD_CFG_MAX_NBR_URB_EXTRA) ||
-        (p_ep->URB_MainAvail        == DEF_YES)) {
+    } else if (USBD_URB_ExtraCtr[dev_nbr] < USBD_CFG_MAX_NBR_URB_EXTRA) {
+        urb_avail = DEF_YES;                                    /* See Note #1c.                                        */
+        DEF_BIT_SET(urb_flags, USBD_URB_FLAG_EXTRA_URB);
+#endif
+    } else if (p_ep->URB_MainLent == DEF_NO) {
+        urb_avail = ep_empty;                                   /* See Note #2.                                         */
+    } else {
+        urb_avail = DEF_NO;
+    }
 #else
-    if (ep_empty == DEF_YES) {                                  /* Check if EP is empty.                                */
+    urb_avail = ep_empty;                                       /* Chk if EP is empty.                                  */
 #endif
 
+    p_urb = (USBD_URB *)0;
+    if (urb_avail == DEF_YES) {
         p_urb = USBD_URB_TblPtr[dev_nbr];
-        if (p_urb != (USBD_URB *)0) {
-            USBD_URB_TblPtr[dev_nbr] = p_urb->NextPtr;
+    }
 
-            p_urb->NextPtr = (USBD_URB *)0;
-            p_urb->Flags   =  0u;
+    if (p_urb != (USBD_URB *)0) {
+        USBD_URB_TblPtr[dev_nbr] = p_urb->NextPtr;
+
+        p_urb->NextPtr = (USBD_URB *)0;
+        p_urb->Flags   =  urb_flags;
+#if (USBD_URB_QUEUED_MAX_NBR > 0u)
+        if (DEF_BIT_IS_SET(urb_flags, USBD_URB_FLAG_RSVD_URB)) {
+#if (USBD_CFG_MAX_NBR_URB_RSVD > 0u)
+            p_ep->URB_RsvdUsedCtr++;
+#endif
+            USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, URB_RsvdGetNbr);
+        } else if (DEF_BIT_IS_SET(urb_flags, USBD_URB_FLAG_EXTRA_URB)) {
 #if (USBD_CFG_MAX_NBR_URB_EXTRA > 0u)
-            if ((ep_empty            == DEF_NO) &&
-                (p_ep->URB_MainAvail == DEF_NO)) {
-                                                                /* If the EP already has an URB in progress, inc ...    */
-                USBD_URB_ExtraCtr[dev_nbr]++;                   /* ... ctr and mark the URB as an 'extra' URB.          */
-                DEF_BIT_SET(p_urb->Flags, USBD_URB_FLAG_EXTRA_URB);
-            } else if (p_ep->URB_MainAvail == DEF_YES) {
-                p_ep->URB_MainAvail = DEF_NO;
-            }
+            USBD_URB_ExtraCtr[dev_nbr]++;
 #endif
-           *p_err = USBD_ERR_NONE;
+            USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, URB_ExtraGetNbr);
+        } else if (p_ep->URB_MainAvail == DEF_YES) {
+            p_ep->URB_MainAvail = DEF_NO;
         } else {
-           *p_err =  USBD_ERR_EP_QUEUING;
-            p_urb = (USBD_URB *)0;
+            p_ep->URB_MainLent  = DEF_YES;                      /* See Note #2.                                         */
         }
+#endif
+       *p_err = USBD_ERR_NONE;
     } else {
-
-       *p_err =  USBD_ERR_EP_QUEUING;
-        p_urb = (USBD_URB *)0;
+        USBD_DBG_STATS_EP_INC(dev_nbr, p_ep->Ix, URB_QueuingErrNbr);
+       *p_err = USBD_ERR_EP_QUEUING;
     }
     CPU_CRITICAL_EXIT();
 
@@ -4570,3 +6420,357 @@ static  void  USBD_URB_Dequeue (USBD_EP  *p_ep)
 }
 
 
+/*
+*********************************************************************************************************
+*                                        USBD_URB_BufCurGet()
+*
+* Description : Get the contiguous buffer for the next transaction of a transfer.
+*
+* Argument(s) : p_ep        Pointer to endpoint structure.
+*               ----        Argument checked by caller.
+*
+*               p_urb       Pointer to USB request block.
+*               -----       Argument checked by caller.
+*
+*               gather      Flag indicating if data must be copied to the bounce buffer (see Note #3) :
+*
+*                               DEF_YES     Data is copied from the segments (IN  transfers).
+*                               DEF_NO      Data is not copied               (OUT transfers).
+*
+*               p_len       Pointer to variable that will receive the length of the contiguous buffer.
+*               -----       Argument checked by caller.
+*
+* Return(s)   : Pointer to contiguous buffer, if any data remains to be transferred.
+*
+*               Pointer to NULL,              otherwise.
+*
+* Note(s)     : (1) Endpoint must be locked when calling this function.
+*
+*               (2) For a vectored transfer, the buffer returned stops at the end of the current
+*                   segment, on a maximum packet size boundary, so that no short packet is sent or
+*                   expected before the end of the transfer.
+*
+*               (3) When less than a maximum packet remains in a segment that is not the last one, the
+*                   packet straddles two or more segments. The endpoint bounce buffer is then used for
+*                   this single packet.
+*********************************************************************************************************
+*/
+
+static  CPU_INT08U  *USBD_URB_BufCurGet (USBD_EP      *p_ep,
+                                         USBD_URB     *p_urb,
+                                         CPU_BOOLEAN   gather,
+                                         CPU_INT32U   *p_len)
+{
+    CPU_INT32U     xfer_rem;
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    USBD_BUF_SEG  *p_seg;
+    CPU_INT08U    *p_buf_cur;
+    CPU_INT32U     seg_rem;
+    CPU_INT32U     copy_len;
+    CPU_INT32U     buf_len;
+#endif
+
+
+    xfer_rem = p_urb->BufLen - p_urb->XferLen;
+    if (xfer_rem == 0u) {                                       /* Zero-length transaction.                             */
+       *p_len = 0u;
+        return ((CPU_INT08U *)0);
+    }
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+    if (DEF_BIT_IS_SET(p_urb->Flags, USBD_URB_FLAG_VEC) == DEF_NO) {
+       *p_len = xfer_rem;
+        return (&p_urb->BufPtr[p_urb->XferLen]);
+    }
+                                                                /* Advance to seg holding octet 'XferLen'.              */
+    p_seg = &p_urb->SegTblPtr[p_urb->SegIx];
+    while ((p_urb->XferLen - p_urb->SegBaseLen) >= p_seg->BufLen) {
+        p_urb->SegBaseLen += p_seg->BufLen;
+        p_urb->SegIx++;
+        p_seg++;
+    }
+
+    seg_rem   =  p_seg->BufLen - (p_urb->XferLen - p_urb->SegBaseLen);
+    p_buf_cur = &((CPU_INT08U *)p_seg->BufPtr)[p_urb->XferLen - p_urb->SegBaseLen];
+
+    if (seg_rem == xfer_rem) {                                  /* Rest of xfer is in this seg.                         */
+       *p_len = seg_rem;
+        return (p_buf_cur);
+    }
+
+    if (seg_rem >= p_ep->MaxPktSize) {                          /* See Note #2.                                         */
+       *p_len = seg_rem - (seg_rem % p_ep->MaxPktSize);
+        return (p_buf_cur);
+    }
+
+   *p_len = DEF_MIN(xfer_rem, p_ep->MaxPktSize);                /* See Note #3.                                         */
+
+    if (gather == DEF_YES) {
+        buf_len = 0u;
+        while (buf_len < *p_len) {
+            copy_len = DEF_MIN(seg_rem, *p_len - buf_len);
+
+            Mem_Copy((void *)&p_ep->VecBufPtr[buf_len],
+                     (void *) p_buf_cur,
+                              copy_len);
+
+            buf_len += copy_len;
+            if (buf_len < *p_len) {                             /* Pkt continues in next seg.                           */
+                p_seg++;
+                p_buf_cur = (CPU_INT08U *)p_seg->BufPtr;
+                seg_rem   =               p_seg->BufLen;
+            }
+        }
+    }
+
+    return (p_ep->VecBufPtr);
+#else
+    (void)p_ep;
+    (void)gather;
+
+   *p_len = xfer_rem;
+    return (&p_urb->BufPtr[p_urb->XferLen]);
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                        USBD_URB_VecLenGet()
+*
+* Description : Validate a table of buffer segments and compute its total length.
+*
+* Argument(s) : p_seg_tbl   Pointer to table of buffer segments.
+*
+*               seg_nbr     Number of segments in table.
+*
+*               p_err       Pointer to variable that will receive return error code from this function :
+*
+*                               USBD_ERR_NONE               Segment table is valid.
+*                               USBD_ERR_NULL_PTR           Null buffer pointer in non-empty segment.
+*                               USBD_ERR_INVALID_ARG        Empty table or total length overflow.
+*
+* Return(s)   : Total length of the segments, if NO error(s).
+*
+*               0,                                otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+static  CPU_INT32U  USBD_URB_VecLenGet (USBD_BUF_SEG  *p_seg_tbl,
+                                        CPU_INT08U     seg_nbr,
+                                        USBD_ERR      *p_err)
+{
+    CPU_INT32U  len_tot;
+    CPU_INT08U  seg_ix;
+
+
+    if (seg_nbr == 0u) {
+       *p_err = USBD_ERR_INVALID_ARG;
+        return (0u);
+    }
+
+    len_tot = 0u;
+    for (seg_ix = 0u; seg_ix < seg_nbr; seg_ix++) {
+        if ((p_seg_tbl[seg_ix].BufLen != 0u) &&
+            (p_seg_tbl[seg_ix].BufPtr == (void *)0)) {
+           *p_err = USBD_ERR_NULL_PTR;
+            return (0u);
+        }
+
+        if (p_seg_tbl[seg_ix].BufLen > (DEF_INT_32U_MAX_VAL - len_tot)) {
+           *p_err = USBD_ERR_INVALID_ARG;                       /* Total len would overflow.                            */
+            return (0u);
+        }
+
+        len_tot += p_seg_tbl[seg_ix].BufLen;
+    }
+
+   *p_err = USBD_ERR_NONE;
+
+    return (len_tot);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_URB_VecBufScatter()
+*
+* Description : Copy a packet received in the endpoint bounce buffer to the segments it belongs to.
+*
+* Argument(s) : p_ep        Pointer to endpoint structure.
+*               ----        Argument checked by caller.
+*
+*               p_urb       Pointer to USB request block.
+*               -----       Argument checked by caller.
+*
+*               len         Number of octets received in the bounce buffer.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Endpoint must be locked when calling this function.
+*
+*               (2) The URB segment cursor has been positioned on octet 'XferLen' by the call to
+*                   USBD_URB_BufCurGet() that returned the bounce buffer.
+*********************************************************************************************************
+*/
+
+#if (USBD_CFG_EP_VEC_EN == DEF_ENABLED)
+static  void  USBD_URB_VecBufScatter (USBD_EP     *p_ep,
+                                      USBD_URB    *p_urb,
+                                      CPU_INT32U   len)
+{
+    USBD_BUF_SEG  *p_seg;
+    CPU_INT32U     seg_off;
+    CPU_INT32U     copy_len;
+    CPU_INT32U     buf_len;
+
+
+    p_seg   = &p_urb->SegTblPtr[p_urb->SegIx];                  /* See Note #2.                                         */
+    seg_off =  p_urb->XferLen - p_urb->SegBaseLen;
+    buf_len =  0u;
+
+    while (buf_len < len) {
+        copy_len = DEF_MIN(p_seg->BufLen - seg_off, len - buf_len);
+
+        Mem_Copy((void *)&((CPU_INT08U *)p_seg->BufPtr)[seg_off],
+                 (void *)&p_ep->VecBufPtr[buf_len],
+                          copy_len);
+
+        buf_len += copy_len;
+        if (buf_len < len) {                                    /* Pkt continues in next seg.                           */
+            p_seg++;
+            seg_off = 0u;
+        }
+    }
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_EP_DbgStatsPerfRec()
+*
+* Description : Record the latency of each stage of a completed transfer and update throughput meter.
+*
+* Argument(s) : dev_nbr     Device number.
+*
+*               p_ep        Pointer to endpoint on which transfer has completed.
+*
+*               submit_ts   Timestamp of the transfer submission.
+*
+*               start_ts    Timestamp of the first driver transfer start.
+*
+*               xfer_len    Number of octets transferred.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The last driver completion timestamp of the endpoint may belong to a previous
+*                   transfer if the driver completed this one without notifying the core, or to the
+*                   next one if it was already started. It is then clamped between the start of the
+*                   transfer and now, so the stages always add up to the total latency.
+*
+*               (2) See 'usbd_cfg.h  DEBUG CONFIGURATION  Note #3' for the bucket index of a latency.
+*
+*               (3) The throughput window is closed when it is longer than its configured length at
+*                   the completion of a transfer. The rate is then computed over the real window
+*                   length. The window of the first transfer measured starts at its submission.
+*********************************************************************************************************
+*/
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+static  void  USBD_EP_DbgStatsPerfRec (CPU_INT08U   dev_nbr,
+                                       USBD_EP     *p_ep,
+                                       CPU_TS       submit_ts,
+                                       CPU_TS       start_ts,
+                                       CPU_INT32U   xfer_len)
+{
+    USBD_DBG_STATS_EP_PERF  *p_perf;
+    CPU_INT32U               lat[USBD_DBG_STATS_LAT_NBR_STAGE];
+    CPU_TS                   cmpl_ts;
+    CPU_TS                   end_ts;
+    CPU_INT32U               win_elapsed;
+    CPU_INT08U               stage;
+    CPU_INT08U               bucket;
+    CPU_SR_ALLOC();
+
+
+    end_ts  = CPU_TS_Get32();
+    cmpl_ts = p_ep->StatsCmplTs;
+    if ((CPU_INT32S)(cmpl_ts - start_ts) < 0) {                 /* See Note #1.                                         */
+        cmpl_ts = start_ts;
+    }
+    if ((CPU_INT32S)(end_ts - cmpl_ts) < 0) {
+        cmpl_ts = end_ts;
+    }
+
+    lat[USBD_DBG_STATS_LAT_SUBMIT] = start_ts - submit_ts;
+    lat[USBD_DBG_STATS_LAT_XFER]   = cmpl_ts  - start_ts;
+    lat[USBD_DBG_STATS_LAT_CMPL]   = end_ts   - cmpl_ts;
+    lat[USBD_DBG_STATS_LAT_TOTAL]  = end_ts   - submit_ts;
+
+    p_perf = &USBD_DbgStatsEP_Tbl[dev_nbr][p_ep->Ix].Perf;
+
+    CPU_CRITICAL_ENTER();
+    for (stage = 0u; stage < USBD_DBG_STATS_LAT_NBR_STAGE; stage++) {
+        if (lat[stage] == 0u) {                                 /* See Note #2.                                         */
+            bucket = 0u;
+        } else {
+            bucket = (CPU_INT08U)(32u - CPU_CntLeadZeros32(lat[stage]));
+            bucket = DEF_MIN(bucket, USBD_CFG_DBG_STATS_LAT_NBR_BUCKET - 1u);
+        }
+        p_perf->LatHist[stage][bucket]++;
+
+        if (lat[stage] > p_perf->LatMax[stage]) {
+            p_perf->LatMax[stage] = lat[stage];
+        }
+    }
+
+    if (p_perf->XferNbr == 0u) {                                /* See Note #3.                                         */
+        p_perf->RateWinStartTs  = submit_ts;
+        p_perf->RateWinOctetCnt = 0u;
+    }
+    p_perf->XferNbr++;
+    p_perf->OctetCnt        += xfer_len;
+    p_perf->RateWinOctetCnt += xfer_len;
+
+    win_elapsed = end_ts - p_perf->RateWinStartTs;
+    if (win_elapsed >= USBD_EP_DbgStatsRateWinTs) {
+        p_perf->Rate            = (CPU_INT32U)(((CPU_INT64U)p_perf->RateWinOctetCnt * USBD_EP_DbgStatsTsFreq) / win_elapsed);
+        p_perf->RateWinStartTs  = end_ts;
+        p_perf->RateWinOctetCnt = 0u;
+    }
+    CPU_CRITICAL_EXIT();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      USBD_EP_DbgStatsTsToUs()
+*
+* Description : Convert a number of CPU timestamp ticks to microseconds.
+*
+* Argument(s) : ts          Number of timestamp ticks.
+*
+* Return(s)   : Number of microseconds, saturated to DEF_INT_32U_MAX_VAL.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+#if (USBD_EP_DBG_STATS_PERF_EN == DEF_ENABLED)
+static  CPU_INT32U  USBD_EP_DbgStatsTsToUs (CPU_INT32U  ts)
+{
+    CPU_INT64U  us;
+
+
+    us = ((CPU_INT64U)ts * 1000000u) / USBD_EP_DbgStatsTsFreq;
+    us = DEF_MIN(us, DEF_INT_32U_MAX_VAL);
+
+    return ((CPU_INT32U)us);
+}
+#endif
@@ -90,7 +90,7 @@ void       USBD_CoreTaskHandler    (void);
 void       USBD_DbgTaskHandler     (void);
 
                                                                 /* ------------ ENDPOINT INTERNAL FUNCTIONS ----------- */
-void       USBD_EP_Init            (void);
+void       USBD_EP_Init            (USBD_ERR    *p_err);
 
 void       USBD_EventEP            (USBD_DRV    *p_drv,
                                     CPU_INT08U   ep_addr,
@@ -106,6 +106,11 @@ void       USBD_CtrlClose          (CPU_INT08U   dev_nbr,
 void       USBD_CtrlStall          (CPU_INT08U   dev_nbr,
                                     USBD_ERR    *p_err);
 
+#if (USBD_CFG_CTRL_ASYNC_EN == DEF_ENABLED)
+void       USBD_CtrlAbort          (CPU_INT08U   dev_nbr,
+                                    USBD_ERR    *p_err);
+#endif
+
 void       USBD_CtrlRxStatus       (CPU_INT08U   dev_nbr,
                                     CPU_INT16U   timeout_ms,
                                     USBD_ERR    *p_err);
@@ -119,6 +124,7 @@ void       USBD_EP_Open            (USBD_DRV    *p_drv,
                                     CPU_INT16U   max_pkt_size,
                                     CPU_INT08U   attrib,
                                     CPU_INT08U   interval,
+                                    CPU_INT08U   urb_nbr_rsvd,
                                     USBD_ERR    *p_err);
 
 void       USBD_EP_Close           (USBD_DRV    *p_drv,
@@ -0,0 +1,802 @@
+/*
+*********************************************************************************************************
+*                                            uC/USB-Device
+*                                    The Embedded USB Device Stack
+*
+*                    Copyright 2004-2021 Silicon Laboratories Inc. www.silabs.com
+*
+*                                 SPDX-License-Identifier: APACHE-2.0
+*
+*               This software is subject to an open source license and is distributed by
+*                Silicon Laboratories Inc. pursuant to the terms of the Apache License,
+*                    Version 2.0 available at www.apache.org/licenses/LICENSE-2.0.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                 USB DEVICE BINARY DEBUG TRACE DECODER
+*
+* Filename : usbd_trace_dec.c
+* Version  : V4.06.01
+*********************************************************************************************************
+* Note(s)  : (1) This is a host program. It decodes the binary debug trace recorded by the device stack
+*                when USBD_CFG_DBG_TRACE_BIN_EN is enabled, and does not depend on the stack headers :
+*
+*                    cc -O2 -o usbd_trace_dec usbd_trace_dec.c
+*
+*                    usbd_trace_dec [-j] [-s] [-e firmware.elf] trace.bin
+*
+*                (a) 'trace.bin' is either a RAM dump of 'USBD_DbgTrace' or, with '-s', the header
+*                    returned by USBD_DbgTraceHdrGet() followed by the records read with USBD_DbgTraceRd().
+*                    The header is searched in the file, so a dump of a larger RAM region can be given.
+*
+*                (b) The message of a record is read from the firmware ELF image given with '-e', at the
+*                    address stored in the record. Without an image, the address is printed.
+*
+*                (c) Without '-j', events are printed in the format of the debug task in text mode. With
+*                    '-j', events are printed in the Chrome trace event JSON format, which is opened by
+*                    'chrome://tracing' and 'ui.perfetto.dev'. Each endpoint is shown as a thread.
+*
+*            (2) Records are sorted by sequence number. Missing sequence numbers are reported as skipped
+*                events, as the debug task does in text mode.
+*
+*            (3) Timestamps are 32-bit counter values. They are extended to 64 bits assuming less than
+*                2^31 ticks between two consecutive records read. A record may hold a slightly earlier
+*                timestamp than the previous one when an interrupt preempted the writer.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <stdint.h>
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  TRACE_MAGIC                              0x54425355u   /* Must match USBD_DBG_TRACE_MAGIC.                     */
+#define  TRACE_VER                                         1u   /* Must match USBD_DBG_TRACE_VER.                       */
+#define  TRACE_HDR_LEN                                    16u
+
+#define  TRACE_REC_FLAG_ARG                             0x01u
+
+#define  TRACE_EP_ADDR_NONE                             0xFFu
+#define  TRACE_IF_NBR_NONE                              0xFFu
+#define  TRACE_TID_DEV                                   256u   /* JSON thread of events without EP.                    */
+
+#define  ELF_SHF_ALLOC                                  0x02u
+#define  ELF_SHT_NOBITS                                    8u
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  trace_hdr {
+    int       BigEndian;
+    uint16_t  Ver;
+    uint8_t   RecSize;
+    uint8_t   PtrSize;
+    uint32_t  RecNbr;
+    uint32_t  TsFreq;
+} TRACE_HDR;
+
+typedef  struct  trace_rec {
+    uint32_t  Seq;
+    uint32_t  Ts;
+    uint64_t  MsgAddr;
+    uint32_t  Arg;
+    uint16_t  Err;
+    uint8_t   EP_Addr;
+    uint8_t   IF_Nbr;
+    uint8_t   Flags;
+} TRACE_REC;
+
+typedef  struct  elf_img {
+    unsigned char  *BufPtr;
+    size_t          Len;
+    int             Is64;
+    int             BigEndian;
+} ELF_IMG;
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  unsigned char  *FileRd      (const char           *p_name,
+                                            size_t         *p_len);
+
+static  uint64_t        ValRd       (const unsigned char  *p_buf,
+                                            unsigned        len,
+                                            int             big_endian);
+
+static  long            HdrFind     (const unsigned char  *p_buf,
+                                            size_t          len,
+                                            TRACE_HDR      *p_hdr);
+
+static  size_t          RecParse    (const unsigned char  *p_buf,
+                                            size_t          len,
+                                     const  TRACE_HDR      *p_hdr,
+                                            size_t          rec_nbr_max,
+                                            TRACE_REC      *p_rec_tbl);
+
+static  int             RecCmp      (const void           *p_a,
+                                     const void           *p_b);
+
+static  int             ELF_Open    (const char           *p_name,
+                                            ELF_IMG        *p_elf);
+
+static  const char     *ELF_StrGet  (const  ELF_IMG        *p_elf,
+                                            uint64_t        addr,
+                                            size_t         *p_len);
+
+static  void            MsgPrint    (const  ELF_IMG        *p_elf,
+                                            uint64_t        addr,
+                                            int             json);
+
+
+/*
+*********************************************************************************************************
+*                                               main()
+*
+* Description : Decode a binary debug trace file (see 'usbd_trace_dec.c  Note #1').
+*
+* Argument(s) : argc        Number of command line arguments.
+*
+*               argv        Command line arguments.
+*
+* Return(s)   : 0, if NO error(s).
+*
+*               1, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+int  main (int    argc,
+           char  *argv[])
+{
+    const  char           *p_trace_name;
+    const  char           *p_elf_name;
+    unsigned  char        *p_buf;
+    size_t                 len;
+    long                   hdr_off;
+    size_t                 rec_nbr_max;
+    size_t                 rec_nbr;
+    size_t                 rec_ix;
+    TRACE_HDR              hdr;
+    TRACE_REC             *p_rec_tbl;
+    TRACE_REC             *p_rec;
+    ELF_IMG                elf;
+    int                    json;
+    int                    stream;
+    int                    arg_ix;
+    int                    first;
+    uint32_t               seq_prev;
+    uint32_t               ts_prev;
+    uint64_t               ts;
+    uint64_t               ts_us;
+    unsigned  long         tid_seen[257u / (8u * sizeof(unsigned long)) + 1u];
+    unsigned               tid;
+
+
+    json         = 0;
+    stream       = 0;
+    p_elf_name   = NULL;
+    p_trace_name = NULL;
+    for (arg_ix = 1; arg_ix < argc; arg_ix++) {
+        if (strcmp(argv[arg_ix], "-j") == 0) {
+            json = 1;
+        } else if (strcmp(argv[arg_ix], "-s") == 0) {
+            stream = 1;
+        } else if ((strcmp(argv[arg_ix], "-e") == 0) &&
+                   (arg_ix + 1 < argc)) {
+            p_elf_name = argv[++arg_ix];
+        } else if (p_trace_name == NULL) {
+            p_trace_name = argv[arg_ix];
+        } else {
+            p_trace_name = NULL;
+            break;
+        }
+    }
+    if (p_trace_name == NULL) {
+        fprintf(stderr, "usage: %s [-j] [-s] [-e firmware.elf] trace.bin\n", argv[0]);
+        return (1);
+    }
+
+    memset(&elf, 0, sizeof(elf));
+    if ((p_elf_name != NULL) &&
+        (ELF_Open(p_elf_name, &elf) != 0)) {
+        return (1);
+    }
+
+    p_buf = FileRd(p_trace_name, &len);
+    if (p_buf == NULL) {
+        return (1);
+    }
+
+    hdr_off = HdrFind(p_buf, len, &hdr);
+    if (hdr_off < 0) {
+        fprintf(stderr, "%s: no trace header found\n", p_trace_name);
+        return (1);
+    }
+    if ((elf.BufPtr != NULL) &&
+        (elf.BigEndian != hdr.BigEndian)) {
+        fprintf(stderr, "%s: byte order differs from trace\n", p_elf_name);
+        return (1);
+    }
+
+    rec_nbr_max = (len - (size_t)hdr_off - TRACE_HDR_LEN) / hdr.RecSize;
+    if ((stream      == 0) &&                                   /* A RAM dump holds exactly one rec tbl.                */
+        (rec_nbr_max >  hdr.RecNbr)) {
+        rec_nbr_max = hdr.RecNbr;
+    }
+
+    p_rec_tbl = (TRACE_REC *)malloc((rec_nbr_max + 1u) * sizeof(TRACE_REC));
+    if (p_rec_tbl == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return (1);
+    }
+    rec_nbr = RecParse(p_buf + hdr_off + TRACE_HDR_LEN,
+                       len   - (size_t)hdr_off - TRACE_HDR_LEN,
+                      &hdr,
+                       rec_nbr_max,
+                       p_rec_tbl);
+
+    qsort(p_rec_tbl, rec_nbr, sizeof(TRACE_REC), RecCmp);      /* See Note #2.                                         */
+
+    if (json != 0) {
+        printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"USB device\"}}");
+        memset(tid_seen, 0, sizeof(tid_seen));
+    }
+
+    first    = 1;
+    seq_prev = 0u;
+    ts_prev  = 0u;
+    ts       = 0u;
+    for (rec_ix = 0u; rec_ix < rec_nbr; rec_ix++) {
+        p_rec = &p_rec_tbl[rec_ix];
+        if ((first    == 0) &&
+            (p_rec->Seq == seq_prev)) {                         /* Drop duplicate of a rec read twice.                  */
+            continue;
+        }
+                                                                /* Extend TS to 64 bits (see Note #3).                  */
+        if (first != 0) {
+            ts  = p_rec->Ts;
+        } else {
+            ts += (uint64_t)(int64_t)(int32_t)(p_rec->Ts - ts_prev);
+        }
+        ts_prev = p_rec->Ts;
+
+        if (json == 0) {
+            if ((first      == 0) &&
+                (p_rec->Seq != seq_prev + 1u)) {
+                printf("USB  %lu  Skipped event(s) \n", (unsigned long)(p_rec->Seq - seq_prev - 1u));
+            }
+            if (hdr.TsFreq != 0u) {
+                ts_us = (uint64_t)((double)ts * 1000000.0 / (double)hdr.TsFreq);
+            } else {
+                ts_us = ts;
+            }
+            printf("USB  %10llu  ", (unsigned long long)ts_us);
+            if (p_rec->EP_Addr != TRACE_EP_ADDR_NONE) {
+                printf("%2X  ", (unsigned)p_rec->EP_Addr);
+            } else {
+                printf("    ");
+            }
+            if (p_rec->IF_Nbr != TRACE_IF_NBR_NONE) {
+                printf("%u  ", (unsigned)p_rec->IF_Nbr);
+            } else {
+                printf("     ");
+            }
+            MsgPrint(&elf, p_rec->MsgAddr, 0);
+            if (p_rec->Err != 0u) {
+                printf("%u  ", (unsigned)p_rec->Err);
+            }
+            if ((p_rec->Flags & TRACE_REC_FLAG_ARG) != 0u) {
+                printf("  %lu  ", (unsigned long)p_rec->Arg);
+            }
+            printf("\n");
+
+        } else {
+            tid = (p_rec->EP_Addr != TRACE_EP_ADDR_NONE) ? p_rec->EP_Addr : TRACE_TID_DEV;
+            if ((tid_seen[tid / (8u * sizeof(unsigned long))] & (1ul << (tid % (8u * sizeof(unsigned long))))) == 0u) {
+                tid_seen[tid / (8u * sizeof(unsigned long))] |= 1ul << (tid % (8u * sizeof(unsigned long)));
+                if (tid == TRACE_TID_DEV) {
+                    printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Device\"}}", tid);
+                } else {
+                    printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"EP 0x%02X\"}}", tid, tid);
+                }
+            }
+
+            printf(",\n{\"name\":\"");
+            MsgPrint(&elf, p_rec->MsgAddr, 1);
+            if (hdr.TsFreq != 0u) {
+                printf("\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", (double)ts * 1000000.0 / (double)hdr.TsFreq);
+            } else {
+                printf("\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu", (unsigned long long)ts);
+            }
+            printf(",\"pid\":0,\"tid\":%u,\"args\":{\"seq\":%lu", tid, (unsigned long)(p_rec->Seq - 1u));
+            if (p_rec->IF_Nbr != TRACE_IF_NBR_NONE) {
+                printf(",\"if\":%u", (unsigned)p_rec->IF_Nbr);
+            }
+            if (p_rec->Err != 0u) {
+                printf(",\"err\":%u", (unsigned)p_rec->Err);
+            }
+            if ((p_rec->Flags & TRACE_REC_FLAG_ARG) != 0u) {
+                printf(",\"arg\":%lu", (unsigned long)p_rec->Arg);
+            }
+            if ((first      == 0) &&
+                (p_rec->Seq != seq_prev + 1u)) {
+                printf(",\"skipped\":%lu", (unsigned long)(p_rec->Seq - seq_prev - 1u));
+            }
+            printf("}}");
+        }
+
+        seq_prev = p_rec->Seq;
+        first    = 0;
+    }
+
+    if (json != 0) {
+        printf("\n]}\n");
+    }
+
+    free(p_rec_tbl);
+    free(p_buf);
+    free(elf.BufPtr);
+
+    return (0);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              FileRd()
+*
+* Description : Read a whole file into memory.
+*
+* Argument(s) : p_name      File name.
+*
+*               p_len       Pointer to variable that will receive the file length.
+*
+* Return(s)   : Pointer to allocated buffer holding the file, if NO error(s).
+*
+*               NULL,                                        otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  unsigned  char  *FileRd (const  char    *p_name,
+                                        size_t  *p_len)
+{
+    FILE            *p_file;
+    unsigned  char  *p_buf;
+    long             len;
+
+
+    p_file = fopen(p_name, "rb");
+    if (p_file == NULL) {
+        perror(p_name);
+        return (NULL);
+    }
+
+    p_buf = NULL;
+    if ((fseek(p_file, 0L, SEEK_END) == 0) &&
+        ((len = ftell(p_file))       >= 0) &&
+        (fseek(p_file, 0L, SEEK_SET) == 0)) {
+        p_buf = (unsigned char *)malloc((size_t)len + 1u);
+        if ((p_buf != NULL) &&
+            (fread(p_buf, 1u, (size_t)len, p_file) == (size_t)len)) {
+           *p_len = (size_t)len;
+        } else {
+            free(p_buf);
+            p_buf = NULL;
+        }
+    }
+    if (p_buf == NULL) {
+        fprintf(stderr, "%s: read error\n", p_name);
+    }
+
+    fclose(p_file);
+
+    return (p_buf);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               ValRd()
+*
+* Description : Read an unsigned integer of the target byte order.
+*
+* Argument(s) : p_buf       Pointer to integer.
+*
+*               len         Integer size, in octets (1 to 8).
+*
+*               big_endian  Non-zero if the target is big-endian.
+*
+* Return(s)   : Integer value.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  uint64_t  ValRd (const  unsigned  char  *p_buf,
+                                unsigned         len,
+                                int              big_endian)
+{
+    uint64_t  val;
+    unsigned  ix;
+
+
+    val = 0u;
+    for (ix = 0u; ix < len; ix++) {
+        if (big_endian != 0) {
+            val = (val << 8u) | p_buf[ix];
+        } else {
+            val = (val << 8u) | p_buf[len - 1u - ix];
+        }
+    }
+
+    return (val);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              HdrFind()
+*
+* Description : Find and parse the trace header.
+*
+* Argument(s) : p_buf       Pointer to trace file contents.
+*
+*               len         Trace file length, in octets.
+*
+*               p_hdr       Pointer to variable that will receive the parsed header.
+*
+* Return(s)   : Offset of the header in the file, if found.
+*
+*               -1,                               otherwise.
+*
+* Note(s)     : (1) The magic number gives the byte order of the target. The header is only accepted if
+*                   its version and record layout are consistent.
+*********************************************************************************************************
+*/
+
+static  long  HdrFind (const  unsigned  char  *p_buf,
+                              size_t           len,
+                              TRACE_HDR       *p_hdr)
+{
+    size_t  off;
+    int     big_endian;
+
+
+    for (off = 0u; off + TRACE_HDR_LEN <= len; off += 4u) {
+        for (big_endian = 0; big_endian <= 1; big_endian++) {
+            if (ValRd(&p_buf[off], 4u, big_endian) != TRACE_MAGIC) {
+                continue;
+            }
+            p_hdr->BigEndian = big_endian;
+            p_hdr->Ver       = (uint16_t)ValRd(&p_buf[off +  4u], 2u, big_endian);
+            p_hdr->RecSize   =                 p_buf[off +  6u];
+            p_hdr->PtrSize   =                 p_buf[off +  7u];
+            p_hdr->RecNbr    = (uint32_t)ValRd(&p_buf[off +  8u], 4u, big_endian);
+            p_hdr->TsFreq    = (uint32_t)ValRd(&p_buf[off + 12u], 4u, big_endian);
+                                                                /* See Note #1.                                         */
+            if ((p_hdr->Ver      == TRACE_VER)                     &&
+                ((p_hdr->PtrSize == 4u) || (p_hdr->PtrSize == 8u))  &&
+                (p_hdr->RecSize  >= 17u + p_hdr->PtrSize)          &&
+                (p_hdr->RecNbr   != 0u)) {
+                return ((long)off);
+            }
+        }
+    }
+
+    return (-1);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             RecParse()
+*
+* Description : Parse the trace records, dropping the records never written or being written.
+*
+* Argument(s) : p_buf       Pointer to first record.
+*
+*               len         Number of octets available from first record.
+*
+*               p_hdr       Pointer to trace header.
+*
+*               rec_nbr_max Maximum number of records to parse.
+*
+*               p_rec_tbl   Pointer to table that will receive the parsed records.
+*
+* Return(s)   : Number of records parsed.
+*
+* Note(s)     : (1) The record layout follows USBD_DBG_TRACE_REC : the message pointer follows the two
+*                   32-bit fields, and the fields following it need no padding with 32- or 64-bit pointers.
+*********************************************************************************************************
+*/
+
+static  size_t  RecParse (const  unsigned  char  *p_buf,
+                                 size_t           len,
+                          const  TRACE_HDR       *p_hdr,
+                                 size_t           rec_nbr_max,
+                                 TRACE_REC       *p_rec_tbl)
+{
+    const  unsigned  char  *p_src;
+    TRACE_REC              *p_rec;
+    size_t                  rec_nbr;
+    size_t                  ix;
+    unsigned                msg_off;
+    int                     be;
+
+
+    be      = p_hdr->BigEndian;
+    msg_off = 8u;                                               /* See Note #1.                                         */
+    rec_nbr = 0u;
+    for (ix = 0u; (ix < rec_nbr_max) && ((ix + 1u) * p_hdr->RecSize <= len); ix++) {
+        p_src        = &p_buf[ix * p_hdr->RecSize];
+        p_rec        = &p_rec_tbl[rec_nbr];
+        p_rec->Seq   = (uint32_t)ValRd(p_src, 4u, be);
+        if (p_rec->Seq == 0u) {
+            continue;
+        }
+        p_rec->Ts      = (uint32_t)ValRd(&p_src[4u], 4u, be);
+        p_rec->MsgAddr =           ValRd(&p_src[msg_off], p_hdr->PtrSize, be);
+        p_rec->Arg     = (uint32_t)ValRd(&p_src[msg_off + p_hdr->PtrSize], 4u, be);
+        p_rec->Err     = (uint16_t)ValRd(&p_src[msg_off + p_hdr->PtrSize + 4u], 2u, be);
+        p_rec->EP_Addr =                  p_src[msg_off + p_hdr->PtrSize + 6u];
+        p_rec->IF_Nbr  =                  p_src[msg_off + p_hdr->PtrSize + 7u];
+        p_rec->Flags   =                  p_src[msg_off + p_hdr->PtrSize + 8u];
+        rec_nbr++;
+    }
+
+    return (rec_nbr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              RecCmp()
+*
+* Description : Compare two records by sequence number.
+*
+* Argument(s) : p_a         Pointer to first  record.
+*
+*               p_b         Pointer to second record.
+*
+* Return(s)   : Negative, zero or positive value, as expected by qsort().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  int  RecCmp (const  void  *p_a,
+                     const  void  *p_b)
+{
+    uint32_t  seq_a;
+    uint32_t  seq_b;
+
+
+    seq_a = ((const TRACE_REC *)p_a)->Seq;
+    seq_b = ((const TRACE_REC *)p_b)->Seq;
+
+    return ((seq_a > seq_b) - (seq_a < seq_b));
+}
+
+
+/*
+*********************************************************************************************************
+*                                             ELF_Open()
+*
+* Description : Load a firmware ELF image.
+*
+* Argument(s) : p_name      ELF file name.
+*
+*               p_elf       Pointer to variable that will receive the image.
+*
+* Return(s)   : 0, if NO error(s).
+*
+*               1, otherwise.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  int  ELF_Open (const  char     *p_name,
+                              ELF_IMG  *p_elf)
+{
+    p_elf->BufPtr = FileRd(p_name, &p_elf->Len);
+    if (p_elf->BufPtr == NULL) {
+        return (1);
+    }
+
+    if ((p_elf->Len < 64u) ||
+        (memcmp(p_elf->BufPtr, "\177ELF", 4u) != 0) ||
+        ((p_elf->BufPtr[4] != 1u) && (p_elf->BufPtr[4] != 2u)) ||
+        ((p_elf->BufPtr[5] != 1u) && (p_elf->BufPtr[5] != 2u))) {
+        fprintf(stderr, "%s: not an ELF file\n", p_name);
+        free(p_elf->BufPtr);
+        p_elf->BufPtr = NULL;
+        return (1);
+    }
+
+    p_elf->Is64      = (p_elf->BufPtr[4] == 2u);
+    p_elf->BigEndian = (p_elf->BufPtr[5] == 2u);
+
+    return (0);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            ELF_StrGet()
+*
+* Description : Get the string located at a target address in the ELF image.
+*
+* Argument(s) : p_elf       Pointer to ELF image.
+*
+*               addr        Target address of string.
+*
+*               p_len       Pointer to variable that will receive the string length.
+*
+* Return(s)   : Pointer to string in ELF image, if found.
+*
+*               NULL,                           otherwise.
+*
+* Note(s)     : (1) The address is looked up in the allocated sections holding file contents. The string
+*                   is bounded by the end of its section.
+*********************************************************************************************************
+*/
+
+static  const  char  *ELF_StrGet (const  ELF_IMG   *p_elf,
+                                         uint64_t   addr,
+                                         size_t    *p_len)
+{
+    const  unsigned  char  *p_buf;
+    const  unsigned  char  *p_sh;
+    uint64_t                sh_off;
+    uint64_t                sh_ent_size;
+    uint64_t                sh_nbr;
+    uint64_t                sh_ix;
+    uint64_t                sec_flags;
+    uint64_t                sec_addr;
+    uint64_t                sec_off;
+    uint64_t                sec_size;
+    uint32_t                sec_type;
+    size_t                  len;
+    int                     be;
+
+
+    if (p_elf->BufPtr == NULL) {
+        return (NULL);
+    }
+
+    p_buf = p_elf->BufPtr;
+    be    = p_elf->BigEndian;
+    if (p_elf->Is64 != 0) {
+        sh_off      = ValRd(&p_buf[0x28u], 8u, be);
+        sh_ent_size = ValRd(&p_buf[0x3Au], 2u, be);
+        sh_nbr      = ValRd(&p_buf[0x3Cu], 2u, be);
+    } else {
+        sh_off      = ValRd(&p_buf[0x20u], 4u, be);
+        sh_ent_size = ValRd(&p_buf[0x2Eu], 2u, be);
+        sh_nbr      = ValRd(&p_buf[0x30u], 2u, be);
+    }
+
+    for (sh_ix = 0u; sh_ix < sh_nbr; sh_ix++) {                 /* See Note #1.                                         */
+        if (sh_off + (sh_ix + 1u) * sh_ent_size > p_elf->Len) {
+            break;
+        }
+        p_sh     = &p_buf[sh_off + sh_ix * sh_ent_size];
+        sec_type = (uint32_t)ValRd(&p_sh[4u], 4u, be);
+        if (p_elf->Is64 != 0) {
+            sec_flags = ValRd(&p_sh[0x08u], 8u, be);
+            sec_addr  = ValRd(&p_sh[0x10u], 8u, be);
+            sec_off   = ValRd(&p_sh[0x18u], 8u, be);
+            sec_size  = ValRd(&p_sh[0x20u], 8u, be);
+        } else {
+            sec_flags = ValRd(&p_sh[0x08u], 4u, be);
+            sec_addr  = ValRd(&p_sh[0x0Cu], 4u, be);
+            sec_off   = ValRd(&p_sh[0x10u], 4u, be);
+            sec_size  = ValRd(&p_sh[0x14u], 4u, be);
+        }
+
+        if (((sec_flags & ELF_SHF_ALLOC) == 0u)   ||
+             (sec_type == ELF_SHT_NOBITS)         ||
+             (addr     <  sec_addr)               ||
+             (addr     >= sec_addr + sec_size)    ||
+             (sec_off + sec_size > p_elf->Len)) {
+            continue;
+        }
+
+        sec_off += addr - sec_addr;
+        sec_size = sec_size - (addr - sec_addr);
+        for (len = 0u; (len < sec_size) && (p_buf[sec_off + len] != '\0'); len++) {
+            ;
+        }
+       *p_len = len;
+        return ((const char *)&p_buf[sec_off]);
+    }
+
+    return (NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             MsgPrint()
+*
+* Description : Print the message of a record.
+*
+* Argument(s) : p_elf       Pointer to ELF image.
+*
+*               addr        Target address of message.
+*
+*               json        Non-zero to escape the message as a JSON string.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) Trailing spaces are kept in text mode, where the error code follows the message, and
+*                   removed from the JSON event name.
+*********************************************************************************************************
+*/
+
+static  void  MsgPrint (const  ELF_IMG   *p_elf,
+                               uint64_t   addr,
+                               int        json)
+{
+    const  char  *p_str;
+    size_t        len;
+    size_t        ix;
+    char          c;
+
+
+    p_str = ELF_StrGet(p_elf, addr, &len);
+    if (p_str == NULL) {
+        printf("msg@0x%llX", (unsigned long long)addr);
+        return;
+    }
+
+    if (json == 0) {
+        fwrite(p_str, 1u, len, stdout);
+        return;
+    }
+
+    while ((len > 0u) &&                                        /* See Note #1.                                         */
+           ((p_str[len - 1u] == ' ') || (p_str[len - 1u] == ':'))) {
+        len--;
+    }
+    for (ix = 0u; ix < len; ix++) {
+        c = p_str[ix];
+        if ((c == '"') || (c == '\\')) {
+            printf("\\%c", c);
+        } else if ((unsigned char)c < 0x20u) {
+            printf("\\u%04X", (unsigned)(unsigned char)c);
+        } else {
+            putchar(c);
+        }
+    }
+}